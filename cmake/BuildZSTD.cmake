@@ -25,6 +25,10 @@ macro(zstd_build)
         third_party/zstd/lib/compress/zstd_compress_superblock.c
         third_party/zstd/lib/compress/zstd_compress_sequences.c
         third_party/zstd/lib/compress/zstd_compress_literals.c
+        third_party/zstd/lib/dictBuilder/cover.c
+        third_party/zstd/lib/dictBuilder/divsufsort.c
+        third_party/zstd/lib/dictBuilder/fastcover.c
+        third_party/zstd/lib/dictBuilder/zdict.c
     )
     set(zstd_cflags "${DEPENDENCY_CFLAGS} -O3 -ffast-math")
     if (CC_HAS_WNO_IMPLICIT_FALLTHROUGH)
@@ -42,7 +46,8 @@ macro(zstd_build)
     set(ZSTD_LIBRARIES zstd)
     set(ZSTD_INCLUDE_DIRS
             ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib
-            ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib/common)
+            ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib/common
+            ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib/dictBuilder)
     include_directories(${ZSTD_INCLUDE_DIRS})
     find_package_message(ZSTD "Using bundled ZSTD"
         "${ZSTD_LIBRARIES}:${ZSTD_INCLUDE_DIRS}")
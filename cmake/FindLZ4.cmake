@@ -0,0 +1,22 @@
+find_path(LZ4_INCLUDE_DIR
+  NAMES lz4.h
+)
+
+if(BUILD_STATIC)
+    set(LZ4_LIB_NAME liblz4.a)
+else()
+    set(LZ4_LIB_NAME lz4)
+endif()
+find_library(LZ4_LIBRARY
+    NAMES ${LZ4_LIB_NAME}
+)
+
+set(LZ4_INCLUDE_DIRS "${LZ4_INCLUDE_DIR}")
+set(LZ4_LIBRARIES "${LZ4_LIBRARY}")
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(LZ4 REQUIRED_VARS
+    LZ4_LIBRARIES LZ4_INCLUDE_DIRS)
+
+mark_as_advanced(LZ4_LIBRARY LZ4_LIBRARIES
+    LZ4_INCLUDE_DIR LZ4_INCLUDE_DIRS)
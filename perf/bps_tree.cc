@@ -84,6 +84,31 @@
 #undef bps_tree_key_t
 #undef BPS_INNER_CARD
 
+/* Tree without software prefetching of blocks. */
+
+#define BPS_BLOCK_NO_PREFETCH
+#define treenp_i64_EXTENT_SIZE 8192
+#define treenp_i64_elem_t int64_t
+#define treenp_i64_key_t int64_t
+#define BPS_TREE_NAME treenp_i64_t
+#define BPS_TREE_BLOCK_SIZE 512
+#define BPS_TREE_EXTENT_SIZE treenp_i64_EXTENT_SIZE
+#define BPS_TREE_IS_IDENTICAL(a, b) ((a) == (b))
+#define BPS_TREE_COMPARE(a, b, arg) ((a) - (b))
+#define BPS_TREE_COMPARE_KEY(a, b, arg) ((a) - (b))
+#define bps_tree_elem_t treenp_i64_elem_t
+#define bps_tree_key_t treenp_i64_key_t
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_IS_IDENTICAL
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef BPS_BLOCK_NO_PREFETCH
+
 /**
  * Generate the benchmark variations required.
  */
@@ -223,6 +248,7 @@ public: \
 	static constexpr auto build = ::tree##_t_build; \
 	static constexpr auto destroy = ::tree##_t_destroy; \
 	static constexpr auto find = ::tree##_t_find; \
+	static constexpr auto find_many = ::tree##_t_find_many; \
 	static constexpr auto insert = ::tree##_t_insert; \
 	static constexpr auto delete_ = ::tree##_t_delete; \
 }
@@ -231,6 +257,7 @@ public: \
 CREATE_TREE_CLASS(tree_i64);
 CREATE_TREE_CLASS(treecc_i64);
 CREATE_TREE_CLASS(treeic_i64);
+CREATE_TREE_CLASS(treenp_i64);
 
 /**
  * Value generators to make key-independent benchmarks.
@@ -424,6 +451,94 @@ generate_benchmarks_height(find_rand, 2);
 generate_benchmarks_height(find_rand, 3);
 generate_benchmarks_height(find_rand, 4);
 
+/*
+ * A tree that doesn't fit in the CPU cache, so every lookup misses on
+ * each level. Compare with the tree built without block prefetching.
+ */
+generate_benchmarks_size(find_rand, 10000000);
+generate_benchmark_size(treenp_i64, find_rand, 10000000);
+
+/*
+ * Batched lookups: each iteration looks up a batch of keys one by one
+ * or with a single find_many call.
+ */
+
+enum {
+	FIND_BATCH_SIZE = 64,
+	FIND_BATCH_COUNT = 1024,
+};
+
+/* Generate FIND_BATCH_COUNT batches of keys in advance. */
+template<class tree, class KeyGen>
+static std::unique_ptr<typename tree::key_t[]>
+batch_keys(KeyGen kg)
+{
+	size_t size = FIND_BATCH_SIZE * FIND_BATCH_COUNT;
+	auto arr = std::unique_ptr<typename tree::key_t[]>(
+		new typename tree::key_t[size]);
+	for (size_t i = 0; i < size; i++)
+		arr[i] = kg();
+	return arr;
+}
+
+template<class tree, class KeyGen>
+static void
+test_find_batch(benchmark::State &state, size_t count, KeyGen kg)
+{
+	typename tree::tree_t t;
+	typename tree::Allocator allocator(count);
+	auto keys = batch_keys<tree>(kg);
+	create<tree>(t, count, allocator);
+	size_t batch = 0;
+	for (auto _ : state) {
+		typename tree::key_t *k = &keys[batch * FIND_BATCH_SIZE];
+		for (size_t i = 0; i < FIND_BATCH_SIZE; i++)
+			benchmark::DoNotOptimize(tree::find(&t, k[i]));
+		batch = (batch + 1) % FIND_BATCH_COUNT;
+	}
+	tree::destroy(&t);
+}
+
+template<class tree, class KeyGen>
+static void
+test_find_many(benchmark::State &state, size_t count, KeyGen kg)
+{
+	typename tree::tree_t t;
+	typename tree::Allocator allocator(count);
+	typename tree::elem_t *result[FIND_BATCH_SIZE];
+	auto keys = batch_keys<tree>(kg);
+	create<tree>(t, count, allocator);
+	size_t batch = 0;
+	for (auto _ : state) {
+		typename tree::key_t *k = &keys[batch * FIND_BATCH_SIZE];
+		tree::find_many(&t, k, FIND_BATCH_SIZE, result);
+		benchmark::DoNotOptimize(result);
+		batch = (batch + 1) % FIND_BATCH_COUNT;
+	}
+	tree::destroy(&t);
+}
+
+template<class tree>
+static void
+test_find_batch_rand(benchmark::State &state, size_t count)
+{
+	test_find_batch<tree>(state, count, RandomKey(count));
+}
+
+template<class tree>
+static void
+test_find_many_rand(benchmark::State &state, size_t count)
+{
+	test_find_many<tree>(state, count, RandomKey(count));
+}
+
+generate_benchmark_size(tree_i64, find_batch_rand, 1000000);
+generate_benchmark_size(tree_i64, find_batch_rand, 10000000);
+generate_benchmark_size(treenp_i64, find_batch_rand, 10000000);
+generate_benchmark_size(tree_i64, find_many_rand, 1000000);
+generate_benchmark_size(tree_i64, find_many_rand, 10000000);
+generate_benchmark_size(treenp_i64, find_many_rand, 10000000);
+
 /*
  * The following functions test performance of insertion and deletion without
  * reballancing. This is done by performing the two opposite operations in a
@@ -24,6 +24,10 @@
 //  - Search after erase;
 //  - Deletes.
 //
+// All the scenarios are run for Light storing 32-bit hashes (the default)
+// and 64-bit hashes (LIGHT_HASH_TYPE = uint64_t) to measure the cost of
+// the wider records.
+//
 // To compare numbers given by this benchmark we also run a few tests with
 // std::unordered_map at the end.
 
@@ -43,6 +47,7 @@ constexpr static std::size_t TUPLE_COUNT_MULTIPLIER = 10;
 
 using Key_t   = uint32_t;
 using Hash_t  = uint32_t;
+using Hash64_t = uint64_t;
 
 // 'size' can be skipped in fact (since it is the same for all tuples).
 // Let's keep it just in case (and to make benchmark look a bit closer
@@ -85,6 +90,20 @@ namespace Hash {
 		}
 		return hash;
 	}
+
+	static constexpr std::uint64_t offset_basis64 = 0xcbf29ce484222325;
+	static constexpr std::uint64_t prime64 = 0x100000001b3;
+
+	Hash64_t
+	FNV_hash64(const char *ptr, std::size_t len)
+	{
+		std::uint64_t hash = offset_basis64;
+		for (std::size_t i = 0; i < len; ++i) {
+			hash ^= ptr[i];
+			hash *= prime64;
+		}
+		return hash;
+	}
 };
 
 // Wrapper to move hash calculation to setup stage (in order to make
@@ -93,10 +112,12 @@ namespace Hash {
 // here. Note that the hash table must not use this key, it is only
 // for benchmarks.
 struct TupleRef {
-	TupleRef(const TupleRaw *t) : tuple(t), hash(Hash::FNV_hash(t->data, t->size)), key(t->key()) { }
+	TupleRef(const TupleRaw *t) : tuple(t), key(t->key()), hash(Hash::FNV_hash(t->data, t->size)),
+		hash64(Hash::FNV_hash64(t->data, t->size)) { }
 	const TupleRaw *tuple;
 	Key_t key;
 	Hash_t hash;
+	Hash64_t hash64;
 };
 
 namespace Hash {
@@ -220,7 +241,35 @@ namespace {
 #define LIGHT_EQUAL(a, b, arg) tuple_equals(a, b)
 #define LIGHT_EQUAL_KEY(a, b, arg) key_equals(a, b)
 
+#define LIGHT_NAMESPACE LightHash32
+#include "salad/light.h"
+#undef LIGHT_NAMESPACE
+
+#define LIGHT_NAMESPACE LightHash64
+#define LIGHT_HASH_TYPE uint64_t
 #include "salad/light.h"
+#undef LIGHT_NAMESPACE
+#undef LIGHT_HASH_TYPE
+
+// Light types and the hash value used with them, selected by hash width.
+template<bool USE_HASH64>
+struct LightTraits;
+
+template<>
+struct LightTraits<false> {
+	using core = LightHash32::light_core;
+	using iterator = LightHash32::light_iterator;
+	static constexpr uint32_t end = LightHash32::light_end;
+	static Hash_t hash(const TupleRef &tuple) { return tuple.hash; }
+};
+
+template<>
+struct LightTraits<true> {
+	using core = LightHash64::light_core;
+	using iterator = LightHash64::light_iterator;
+	static constexpr uint32_t end = LightHash64::light_end;
+	static Hash64_t hash(const TupleRef &tuple) { return tuple.hash64; }
+};
 
 ////////////////////////////// Fixture /////////////////////////////////////////////////////////////////////////////////
 
@@ -469,15 +518,18 @@ class HTBench : public ::benchmark::Fixture {
 	T hash_table;
 };
 
-class Light {
+// Light functions are found by argument-dependent lookup.
+template<bool USE_HASH64>
+class LightImpl {
+	using Traits = LightTraits<USE_HASH64>;
 public:
-	Light()
+	LightImpl()
 	{
 		matras_allocator_create(&allocator, light_extent_size,
 					light_malloc_extend, light_free_extend);
 		light_create(&ht, 0, &allocator, nullptr);
 	}
-	~Light()
+	~LightImpl()
 	{
 		light_destroy(&ht);
 		matras_allocator_destroy(&allocator);
@@ -487,14 +539,14 @@ class Light {
 	int
 	erase(const TupleRef &tuple)
 	{
-		light_delete_value(&ht, tuple.hash, tuple.tuple);
+		light_delete_value(&ht, Traits::hash(tuple), tuple.tuple);
 		return 0;
 	}
 
 	int
 	insert(const TupleRef &tuple)
 	{
-		light_insert(&ht, tuple.hash, tuple.tuple);
+		light_insert(&ht, Traits::hash(tuple), tuple.tuple);
 		return 0;
 	}
 
@@ -502,8 +554,8 @@ class Light {
 	find(const TupleRef &tuple)
 	{
 		static TupleRaw DUMMY{0};
-		uint32_t slot = light_find(&ht, tuple.hash, tuple.tuple);
-		if (slot != light_end)
+		uint32_t slot = light_find(&ht, Traits::hash(tuple), tuple.tuple);
+		if (slot != Traits::end)
 			return light_get(&ht, slot);
 		return &DUMMY;
 	}
@@ -511,7 +563,7 @@ class Light {
 	uint32_t
 	find_key(const TupleRef &tuple)
 	{
-		return light_find_key(&ht, tuple.hash, tuple.key);
+		return light_find_key(&ht, Traits::hash(tuple), tuple.key);
 	}
 
 	void
@@ -528,7 +580,7 @@ class Light {
 	iter_all()
 	{
 		std::size_t processed = 0;
-		struct light_iterator iter;
+		typename Traits::iterator iter;
 		light_iterator_begin(&ht, &iter);
 		const TupleRaw **p = nullptr;
 		while ((p = light_iterator_get_and_next(&ht, &iter)) != nullptr) {
@@ -538,10 +590,13 @@ class Light {
 		return processed;
 	}
 private:
-	struct light_core ht;
+	typename Traits::core ht;
 	struct matras_allocator allocator;
 };
 
+using Light = LightImpl<false>;
+using Light64 = LightImpl<true>;
+
 using USet = std::unordered_set<TupleRef, Hash::TupleHash, TupleEqual>;
 
 class STL {
@@ -578,11 +633,15 @@ class STL {
 #define BENCHMARK_TEMPLATE_REGISTER_LIGHT(METHOD_NAME) \
 	BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, Light)
 
+#define BENCHMARK_TEMPLATE_REGISTER_LIGHT64(METHOD_NAME) \
+	BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, Light64)
+
 #define BENCHMARK_TEMPLATE_REGISTER_STL(METHOD_NAME) \
 	BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, STL)
 
 #define BENCHMARK_TEMPLATE_REGISTER_FOR_ALL_IMPLS(METHOD_NAME) \
 	BENCHMARK_TEMPLATE_REGISTER_LIGHT(METHOD_NAME); \
+	BENCHMARK_TEMPLATE_REGISTER_LIGHT64(METHOD_NAME); \
 	BENCHMARK_TEMPLATE_REGISTER_STL(METHOD_NAME)
 
 BENCHMARK_TEMPLATE_REGISTER_FOR_ALL_IMPLS(InsertRandValue);
@@ -526,6 +526,38 @@ tuple_access_unindexed_field(benchmark::State& state)
 
 BENCHMARK_TEMPLATE(tuple_access_unindexed_field, FORMAT_BASIC);
 
+// benchmark of access of a non-indexed field far from the tuple start.
+template<data_format F>
+static void
+tuple_access_unindexed_field_wide(benchmark::State& state)
+{
+	struct key_part_def kdp = key_part_def_default;
+	kdp.fieldno = 0;
+	kdp.type = FIELD_TYPE_UNSIGNED;
+	kdp.is_nullable = true;
+	kdp.nullable_action = ON_CONFLICT_ACTION_NONE;
+	struct key_def *kd = key_def_new(&kdp, 1, 0);
+	struct tuple_format *format = TupleFormat<F>::make(kd);
+	TestTuples<F> tuples(format);
+	uint32_t fieldno = state.range(0);
+	size_t i = 0;
+	size_t total_count = 0;
+	for (auto _ : state) {
+		if (i == NUM_TEST_TUPLES) {
+			total_count += i;
+			i = 0;
+		}
+		benchmark::DoNotOptimize(tuple_field(tuples[i++], fieldno));
+	}
+	total_count += i;
+	state.SetItemsProcessed(total_count);
+	tuple_format_unref(format);
+	key_def_delete(kd);
+}
+
+BENCHMARK_TEMPLATE(tuple_access_unindexed_field_wide, FORMAT_SPARSE)
+	->Arg(10)->Arg(100)->Arg(999);
+
 // benchmark of access of indexed field.
 template<data_format F>
 static void
@@ -577,6 +609,7 @@ tuple_tuple_compare(benchmark::State& state)
 
 BENCHMARK_TEMPLATE(tuple_tuple_compare, FORMAT_BASIC);
 
+template <bool IS_HASH64>
 static void
 tuple_tuple_hash_impl(benchmark::State &state, struct key_def *kd)
 {
@@ -589,7 +622,10 @@ tuple_tuple_hash_impl(benchmark::State &state, struct key_def *kd)
 			total_count += i;
 			i = 0;
 		}
-		benchmark::DoNotOptimize(tuple_hash(tuples[i], kd));
+		if (IS_HASH64)
+			benchmark::DoNotOptimize(tuple_hash64(tuples[i], kd));
+		else
+			benchmark::DoNotOptimize(tuple_hash(tuples[i], kd));
 		++i;
 	}
 	total_count += i;
@@ -597,6 +633,7 @@ tuple_tuple_hash_impl(benchmark::State &state, struct key_def *kd)
 	tuple_format_unref(format);
 }
 
+template <bool IS_HASH64>
 static void
 tuple_tuple_hash_fast_one_uint(benchmark::State &state)
 {
@@ -604,12 +641,14 @@ tuple_tuple_hash_fast_one_uint(benchmark::State &state)
 	kdp.fieldno = 0;
 	kdp.type = FIELD_TYPE_UNSIGNED;
 	struct key_def *kd = key_def_new(&kdp, 1, 0);
-	tuple_tuple_hash_impl(state, kd);
+	tuple_tuple_hash_impl<IS_HASH64>(state, kd);
 	key_def_delete(kd);
 }
 
-BENCHMARK(tuple_tuple_hash_fast_one_uint);
+BENCHMARK_TEMPLATE(tuple_tuple_hash_fast_one_uint, false);
+BENCHMARK_TEMPLATE(tuple_tuple_hash_fast_one_uint, true);
 
+template <bool IS_HASH64>
 static void
 tuple_tuple_hash_fast_multiple_fields(benchmark::State &state)
 {
@@ -621,12 +660,14 @@ tuple_tuple_hash_fast_multiple_fields(benchmark::State &state)
 	kdp[1].fieldno = 1;
 	kdp[1].type = FIELD_TYPE_STRING;
 	struct key_def *kd = key_def_new(kdp, 2, 0);
-	tuple_tuple_hash_impl(state, kd);
+	tuple_tuple_hash_impl<IS_HASH64>(state, kd);
 	key_def_delete(kd);
 }
 
-BENCHMARK(tuple_tuple_hash_fast_multiple_fields);
+BENCHMARK_TEMPLATE(tuple_tuple_hash_fast_multiple_fields, false);
+BENCHMARK_TEMPLATE(tuple_tuple_hash_fast_multiple_fields, true);
 
+template <bool IS_HASH64>
 static void
 tuple_tuple_hash_slow(benchmark::State &state)
 {
@@ -645,11 +686,12 @@ tuple_tuple_hash_slow(benchmark::State &state)
 	kdp[1].nullable_action = ON_CONFLICT_ACTION_NONE;
 
 	struct key_def *kd = key_def_new(kdp, 2, 0);
-	tuple_tuple_hash_impl(state, kd);
+	tuple_tuple_hash_impl<IS_HASH64>(state, kd);
 	key_def_delete(kd);
 }
 
-BENCHMARK(tuple_tuple_hash_slow);
+BENCHMARK_TEMPLATE(tuple_tuple_hash_slow, false);
+BENCHMARK_TEMPLATE(tuple_tuple_hash_slow, true);
 
 // benchmark of tuple hints compare.
 template<data_format F>
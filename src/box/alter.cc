@@ -64,6 +64,7 @@
 #include "relay.h"
 #include "gc.h"
 #include "memtx_tx.h"
+#include "iproto_read_view.h"
 
 /* {{{ Auxiliary functions and methods. */
 
@@ -4097,6 +4098,8 @@ grant_or_revoke(struct priv_def *priv, struct txn_stmt *rolled_back_stmt)
 		if (priv_grant(grantee, priv, rolled_back_stmt) != 0)
 			return -1;
 	}
+	/* Access rights cached in the iproto read view are stale now. */
+	iproto_read_view_invalidate();
 	return 0;
 }
 
@@ -62,9 +62,18 @@
 #include "tt_static.h"
 #include "memory.h"
 #include "ssl_error.h"
+#include "rmean.h"
+#include "space.h"
+#include "index.h"
 
 STRS(applier_state, applier_STATE);
 
+static const char *applier_stat_strs[APPLIER_STAT_MAX] = {
+	"TX",
+	"TX_PARALLEL",
+	"TX_CONFLICT",
+};
+
 enum {
 	/**
 	 * How often to log received row count. Used during join and register.
@@ -72,6 +81,11 @@ enum {
 	ROWS_PER_LOG = 100000,
 	/** A maximal batch size carried between applier thread and tx. */
 	APPLIER_THREAD_TX_MAX = 100,
+	/**
+	 * Max number of keys tracked for a transaction applied by a worker
+	 * fiber. Bigger transactions are applied serially.
+	 */
+	APPLIER_TX_KEYS_MAX = 16,
 };
 
 static inline void
@@ -1393,8 +1407,13 @@ applier_handle_raft_request(struct applier *applier, struct raft_request *req)
 	return box_raft_process(req, applier->instance_id);
 }
 
-static int
-apply_plain_tx(uint32_t replica_id, struct stailq *rows)
+/**
+ * Begin a transaction and apply its rows. Returns the transaction ready to
+ * be committed with apply_plain_tx_commit() or NULL on error, in which case
+ * the transaction is rolled back.
+ */
+static struct txn *
+apply_plain_tx_rows(struct stailq *rows)
 {
 	/*
 	 * Explicitly begin the transaction so that we can
@@ -1405,7 +1424,7 @@ apply_plain_tx(uint32_t replica_id, struct stailq *rows)
 	struct txn *txn = txn_begin();
 	struct applier_tx_row *item;
 	if (txn == NULL)
-		 return -1;
+		 return NULL;
 	txn->isolation = TXN_ISOLATION_READ_COMMITTED;
 
 	stailq_foreach_entry(item, rows, next) {
@@ -1448,7 +1467,21 @@ apply_plain_tx(uint32_t replica_id, struct stailq *rows)
 			 "distributed transactions");
 		goto fail;
 	}
+	return txn;
+fail:
+	txn_abort(txn);
+	return NULL;
+}
 
+/**
+ * Submit a transaction applied by apply_plain_tx_rows() to WAL.
+ * The transaction is rolled back on error.
+ */
+static int
+apply_plain_tx_commit(struct txn *txn, uint32_t replica_id,
+		      struct stailq *rows)
+{
+	struct applier_tx_row *item;
 	item = stailq_last_entry(rows, struct applier_tx_row, next);
 
 	/*
@@ -1496,6 +1529,15 @@ apply_plain_tx(uint32_t replica_id, struct stailq *rows)
 	return -1;
 }
 
+static int
+apply_plain_tx(uint32_t replica_id, struct stailq *rows)
+{
+	struct txn *txn = apply_plain_tx_rows(rows);
+	if (txn == NULL)
+		return -1;
+	return apply_plain_tx_commit(txn, replica_id, rows);
+}
+
 /**
  * We must filter out synchronous rows coming from an instance that fell behind
  * the current synchro queue owner. This includes both synchronous tx rows and
@@ -1615,6 +1657,43 @@ applier_process_heartbeat(struct applier *applier, struct applier_tx_row *txr)
 	return 0;
 }
 
+/**
+ * Skip rows of a transaction that have already been applied. Returns false
+ * if the whole transaction has already been applied.
+ */
+static bool
+applier_skip_applied_rows(struct stailq *rows)
+{
+	struct xrow_header *first_row, *last_row;
+	first_row = &stailq_first_entry(rows, struct applier_tx_row,
+					next)->row;
+	last_row = &stailq_last_entry(rows, struct applier_tx_row, next)->row;
+	if (vclock_get(&replicaset.applier.vclock,
+		       last_row->replica_id) >= last_row->lsn) {
+		return false;
+	} else if (vclock_get(&replicaset.applier.vclock,
+			      first_row->replica_id) >= first_row->lsn) {
+		/*
+		 * We've received part of the tx from an old
+		 * instance not knowing of tx boundaries.
+		 * Skip the already applied part.
+		 */
+		struct xrow_header *tmp;
+		while (true) {
+			tmp = &stailq_first_entry(rows,
+						  struct applier_tx_row,
+						  next)->row;
+			if (tmp->lsn <= vclock_get(&replicaset.applier.vclock,
+						   tmp->replica_id)) {
+				stailq_shift(rows);
+			} else {
+				break;
+			}
+		}
+	}
+	return true;
+}
+
 static int
 applier_apply_tx(struct applier *applier, struct stailq *rows)
 {
@@ -1656,29 +1735,8 @@ applier_apply_tx(struct applier *applier, struct stailq *rows)
 		rc = -1;
 		goto finish;
 	}
-	if (vclock_get(&replicaset.applier.vclock,
-		       last_row->replica_id) >= last_row->lsn) {
+	if (!applier_skip_applied_rows(rows))
 		goto finish;
-	} else if (vclock_get(&replicaset.applier.vclock,
-			      first_row->replica_id) >= first_row->lsn) {
-		/*
-		 * We've received part of the tx from an old
-		 * instance not knowing of tx boundaries.
-		 * Skip the already applied part.
-		 */
-		struct xrow_header *tmp;
-		while (true) {
-			tmp = &stailq_first_entry(rows,
-						  struct applier_tx_row,
-						  next)->row;
-			if (tmp->lsn <= vclock_get(&replicaset.applier.vclock,
-						   tmp->replica_id)) {
-				stailq_shift(rows);
-			} else {
-				break;
-			}
-		}
-	}
 	rc = applier_synchro_filter_tx(rows);
 	if (rc != 0)
 		goto finish;
@@ -1700,11 +1758,335 @@ applier_apply_tx(struct applier *applier, struct stailq *rows)
 
 	vclock_follow(&replicaset.applier.vclock, last_row->replica_id,
 		      last_row->lsn);
+	rmean_collect(applier->stat, APPLIER_STAT_TX, 1);
 finish:
 	latch_unlock(latch);
 	return rc;
 }
 
+/**
+ * A key a transaction applied by a worker fiber may conflict on with other
+ * concurrently applied transactions.
+ */
+struct applier_tx_key {
+	/** Space ID. */
+	uint32_t space_id;
+	/** Hash of the primary key. Unused if is_space is set. */
+	uint32_t hash;
+	/** Set if the transaction may conflict on any key of the space. */
+	bool is_space;
+};
+
+/** A transaction applied by a worker fiber. */
+struct applier_worker {
+	/** The applier the transaction was received by. */
+	struct applier *applier;
+	/** Rows of the transaction. */
+	struct stailq *rows;
+	/** Order of the transaction, see applier_parallel::commit_seq. */
+	int64_t seq;
+	/** Link in applier_parallel::workers. */
+	struct rlist in_parallel;
+	/** Keys modified by the transaction. */
+	struct applier_tx_key keys[APPLIER_TX_KEYS_MAX];
+	/** Number of keys. */
+	int key_count;
+};
+
+/** Check if two transaction keys may refer to the same tuple. */
+static inline bool
+applier_tx_key_conflicts(const struct applier_tx_key *a,
+			 const struct applier_tx_key *b)
+{
+	return a->space_id == b->space_id &&
+	       (a->is_space || b->is_space || a->hash == b->hash);
+}
+
+/**
+ * Compute the key a DML request may conflict on with other transactions.
+ * Requests on a space with more than one unique index or by a secondary
+ * key conflict with all requests on the space, because they may affect
+ * tuples with a different primary key.
+ */
+static void
+applier_tx_key_create(struct applier_tx_key *key, struct space *space,
+		      struct request *request)
+{
+	key->space_id = space->def->id;
+	key->hash = 0;
+	key->is_space = true;
+	for (uint32_t i = 1; i < space->index_count; i++) {
+		if (space->index[i]->def->opts.is_unique)
+			return;
+	}
+	struct key_def *pk_def = space->index[0]->def->key_def;
+	if (pk_def->has_json_paths || pk_def->has_optional_parts)
+		return;
+	const char *data;
+	switch (request->type) {
+	case IPROTO_INSERT:
+	case IPROTO_REPLACE:
+	case IPROTO_UPSERT: {
+		data = request->tuple;
+		if (data == NULL)
+			return;
+		uint32_t field_count = mp_decode_array(&data);
+		for (uint32_t i = 0; i < pk_def->part_count; i++) {
+			if (pk_def->parts[i].fieldno >= field_count)
+				return;
+		}
+		uint32_t size;
+		size_t region_svp = region_used(&fiber()->gc);
+		const char *pk = tuple_extract_key_raw(
+			request->tuple, request->tuple_end, pk_def,
+			MULTIKEY_NONE, &size);
+		if (pk == NULL) {
+			diag_clear(diag_get());
+			region_truncate(&fiber()->gc, region_svp);
+			return;
+		}
+		mp_decode_array(&pk);
+		key->hash = key_hash(pk, pk_def);
+		region_truncate(&fiber()->gc, region_svp);
+		break;
+	}
+	case IPROTO_DELETE:
+	case IPROTO_UPDATE:
+		data = request->key;
+		if (request->index_id != 0 || data == NULL ||
+		    mp_decode_array(&data) != pk_def->part_count)
+			return;
+		key->hash = key_hash(data, pk_def);
+		break;
+	default:
+		return;
+	}
+	key->is_space = false;
+}
+
+/**
+ * Collect keys a transaction may conflict on with other transactions.
+ * Returns false if the transaction must be applied serially: it modifies
+ * a system space or a space that has triggers or foreign keys, it is
+ * synchronous, or it is too big.
+ */
+static bool
+applier_tx_collect_keys(struct stailq *rows, struct applier_worker *worker)
+{
+	worker->key_count = 0;
+	struct applier_tx_row *item;
+	item = stailq_last_entry(rows, struct applier_tx_row, next);
+	if ((item->row.flags & IPROTO_FLAG_WAIT_ACK) != 0)
+		return false;
+	stailq_foreach_entry(item, rows, next) {
+		struct request *request = &item->req.dml;
+		if (item->row.type == IPROTO_NOP)
+			continue;
+		if (!iproto_type_is_dml(item->row.type) ||
+		    request->space_id < BOX_SYSTEM_ID_MAX)
+			return false;
+		struct space *space = space_by_id(request->space_id);
+		if (space == NULL || space->index_count == 0 ||
+		    space_has_before_replace_triggers(space) ||
+		    space_has_on_replace_triggers(space) ||
+		    space->has_foreign_keys ||
+		    !rlist_empty(&space->space_cache_pin_list))
+			return false;
+		if (worker->key_count == APPLIER_TX_KEYS_MAX)
+			return false;
+		applier_tx_key_create(&worker->keys[worker->key_count++],
+				      space, request);
+	}
+	return true;
+}
+
+/**
+ * Check if a transaction may conflict with any of the transactions being
+ * applied by worker fibers.
+ */
+static bool
+applier_parallel_has_conflict(struct applier_parallel *p,
+			      struct applier_worker *worker)
+{
+	struct applier_worker *other;
+	rlist_foreach_entry(other, &p->workers, in_parallel) {
+		for (int i = 0; i < worker->key_count; i++) {
+			for (int j = 0; j < other->key_count; j++) {
+				if (applier_tx_key_conflicts(&worker->keys[i],
+							     &other->keys[j]))
+					return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * Wait until all transactions dispatched to worker fibers are done and
+ * unlock the order latches. Returns -1 and sets diag if any of the
+ * transactions failed.
+ */
+static int
+applier_parallel_drain(struct applier *applier)
+{
+	struct applier_parallel *p = &applier->parallel;
+	while (p->worker_count > 0)
+		fiber_cond_wait(&p->cond);
+	for (int i = 0; i < p->latch_count; i++)
+		latch_unlock(p->latches[i]);
+	p->latch_count = 0;
+	if (p->is_failed) {
+		p->is_failed = false;
+		diag_move(&p->diag, diag_get());
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Lock an order latch for a dispatched transaction unless it's already
+ * locked by the applier. The latch stays locked until the applier drains
+ * the dispatched transactions.
+ */
+static int
+applier_parallel_lock(struct applier *applier, struct latch *latch)
+{
+	struct applier_parallel *p = &applier->parallel;
+	for (int i = 0; i < p->latch_count; i++) {
+		if (p->latches[i] == latch)
+			return 0;
+	}
+	if (latch_trylock(latch) != 0) {
+		/*
+		 * The latch is locked by another applier, which may be
+		 * waiting for a latch we hold. Unlock our latches before
+		 * waiting to avoid a deadlock.
+		 */
+		if (applier_parallel_drain(applier) != 0)
+			return -1;
+		latch_lock(latch);
+	}
+	assert(p->latch_count < (int)lengthof(p->latches));
+	p->latches[p->latch_count++] = latch;
+	return 0;
+}
+
+/** Fiber function applying a transaction dispatched to a worker. */
+static int
+applier_worker_f(va_list ap)
+{
+	struct applier_worker worker = *va_arg(ap, struct applier_worker *);
+	struct applier *applier = worker.applier;
+	struct applier_parallel *p = &applier->parallel;
+	rlist_add_tail_entry(&p->workers, &worker, in_parallel);
+	p->worker_count++;
+	struct xrow_header *last_row;
+	last_row = &stailq_last_entry(worker.rows, struct applier_tx_row,
+				      next)->row;
+	struct txn *txn = apply_plain_tx_rows(worker.rows);
+	/* The transaction may yield while waiting for its turn to commit. */
+	if (txn != NULL)
+		txn_can_yield(txn, true);
+	while (p->commit_seq != worker.seq)
+		fiber_cond_wait(&p->cond);
+	int rc = 0;
+	if (txn == NULL) {
+		rc = -1;
+	} else if (p->is_failed) {
+		/* A preceding transaction failed. */
+		txn_abort(txn);
+	} else {
+		rc = apply_plain_tx_commit(txn, applier->instance_id,
+					   worker.rows);
+	}
+	if (rc == 0 && !p->is_failed) {
+		vclock_follow(&replicaset.applier.vclock, last_row->replica_id,
+			      last_row->lsn);
+		rmean_collect(applier->stat, APPLIER_STAT_TX, 1);
+	} else if (rc != 0 && !p->is_failed) {
+		diag_move(diag_get(), &p->diag);
+		p->is_failed = true;
+	}
+	p->commit_seq++;
+	rlist_del_entry(&worker, in_parallel);
+	p->worker_count--;
+	fiber_cond_broadcast(&p->cond);
+	return 0;
+}
+
+/**
+ * Apply a transaction concurrently with other transactions if it doesn't
+ * conflict with them, otherwise wait for the conflicting transactions to
+ * commit first. Transactions that can't be applied concurrently are applied
+ * serially after all the dispatched transactions are committed.
+ *
+ * On error, all the dispatched transactions are drained.
+ */
+static int
+applier_apply_tx_parallel(struct applier *applier, struct stailq *rows)
+{
+	struct applier_parallel *p = &applier->parallel;
+	struct applier_worker worker;
+	if (replication_apply_concurrency == 1 ||
+	    (applier->state != APPLIER_SYNC &&
+	     applier->state != APPLIER_FOLLOW) ||
+	    !applier_tx_collect_keys(rows, &worker)) {
+		if (applier_parallel_drain(applier) != 0)
+			return -1;
+		return applier_apply_tx(applier, rows);
+	}
+	struct xrow_header *first_row;
+	first_row = &stailq_first_entry(rows, struct applier_tx_row,
+					next)->row;
+	/* See applier_apply_tx(). */
+	struct replica *replica = replica_by_id(first_row->replica_id);
+	struct latch *latch = (replica ? &replica->order_latch :
+			       &replicaset.applier.order_latch);
+	if (applier_parallel_lock(applier, latch) != 0)
+		return -1;
+	if (fiber_is_cancelled()) {
+		diag_set(FiberIsCancelled);
+		goto fail;
+	}
+	if (!applier_skip_applied_rows(rows))
+		return 0;
+	if (applier_synchro_filter_tx(rows) != 0)
+		goto fail;
+	if (applier_parallel_has_conflict(p, &worker))
+		rmean_collect(applier->stat, APPLIER_STAT_TX_CONFLICT, 1);
+	while (!p->is_failed &&
+	       (p->worker_count >= replication_apply_concurrency ||
+		applier_parallel_has_conflict(p, &worker)))
+		fiber_cond_wait(&p->cond);
+	if (p->is_failed)
+		return applier_parallel_drain(applier);
+	worker.applier = applier;
+	worker.rows = rows;
+	worker.seq = p->next_seq++;
+	struct fiber *f;
+	try {
+		f = applier_fiber_new(applier, "applierw", applier_worker_f,
+				      false);
+	} catch (Exception *) {
+		p->next_seq--;
+		goto fail;
+	}
+	fiber_set_session(f, current_session());
+	fiber_set_user(f, &current_session()->credentials);
+	rmean_collect(applier->stat, APPLIER_STAT_TX_PARALLEL, 1);
+	fiber_start(f, &worker);
+	return 0;
+fail:
+	/* Keep the error if the drain succeeds. */
+	struct diag diag;
+	diag_create(&diag);
+	diag_move(diag_get(), &diag);
+	if (applier_parallel_drain(applier) == 0)
+		diag_move(&diag, diag_get());
+	diag_destroy(&diag);
+	return -1;
+}
+
 /**
  * Notify the applier's write fiber that there are more ACKs to
  * send to master.
@@ -1891,13 +2273,16 @@ applier_process_batch(struct cmsg *base)
 					       applier->instance_id);
 		}
 		if (last_txr->row.lsn == 0) {
+			if (applier_parallel_drain(applier) != 0)
+				diag_raise();
 			if (applier_process_heartbeat(applier, last_txr) != 0)
 				diag_raise();
 			if (applier_handle_raft(applier, last_txr) != 0)
 				diag_raise();
 			applier_signal_ack(applier);
 			applier_check_sync(applier);
-		} else if (applier_apply_tx(applier, &tx->rows) != 0) {
+		} else if (applier_apply_tx_parallel(applier,
+						     &tx->rows) != 0) {
 			diag_raise();
 		}
 		if (applier->state == APPLIER_FINAL_JOIN &&
@@ -1908,6 +2293,8 @@ applier_process_batch(struct cmsg *base)
 			applier_set_state(applier, APPLIER_FOLLOW);
 		}
 	}
+	if (applier_parallel_drain(applier) != 0)
+		diag_raise();
 
 	/* Return the message to applier thread. */
 	cmsg_init(&msg->base.base, return_route);
@@ -2783,6 +3170,10 @@ applier_new(const struct uri *uri)
 	rlist_create(&applier->on_state);
 	fiber_cond_create(&applier->resume_cond);
 	diag_create(&applier->diag);
+	applier->stat = rmean_new(applier_stat_strs, APPLIER_STAT_MAX);
+	rlist_create(&applier->parallel.workers);
+	fiber_cond_create(&applier->parallel.cond);
+	diag_create(&applier->parallel.diag);
 
 	return applier;
 }
@@ -2797,6 +3188,10 @@ applier_delete(struct applier *applier)
 	uri_destroy(&applier->uri);
 	trigger_destroy(&applier->on_state);
 	diag_destroy(&applier->diag);
+	rmean_delete(applier->stat);
+	assert(applier->parallel.worker_count == 0);
+	fiber_cond_destroy(&applier->parallel.cond);
+	diag_destroy(&applier->parallel.diag);
 	free(applier);
 }
 
@@ -52,6 +52,9 @@
 extern "C" {
 #endif /* defined(__cplusplus) */
 
+struct latch;
+struct rmean;
+
 enum { APPLIER_SOURCE_MAXLEN = 1024 }; /* enough to fit URI with passwords */
 
 #define applier_STATE(_)                                             \
@@ -136,6 +139,49 @@ struct applier_thread {
 	struct cpipe thread_pipe;
 };
 
+/** Applier statistics, see applier::stat. */
+enum applier_stat {
+	/** Applied transactions. */
+	APPLIER_STAT_TX,
+	/** Transactions applied by worker fibers. */
+	APPLIER_STAT_TX_PARALLEL,
+	/** Transactions that had to wait for a conflicting transaction. */
+	APPLIER_STAT_TX_CONFLICT,
+	APPLIER_STAT_MAX,
+};
+
+/**
+ * State of concurrent transaction apply, see replication_apply_concurrency.
+ * Independent transactions are applied by worker fibers and committed in
+ * the order they were received.
+ */
+struct applier_parallel {
+	/** Running workers, linked by applier_worker::in_parallel. */
+	struct rlist workers;
+	/** Number of running workers. */
+	int worker_count;
+	/** Sequence number assigned to the next dispatched transaction. */
+	int64_t next_seq;
+	/** Sequence number of the next transaction to commit. */
+	int64_t commit_seq;
+	/** Signalled when a worker is done with its transaction. */
+	struct fiber_cond cond;
+	/**
+	 * Set if a worker failed to apply its transaction. All transactions
+	 * following the failed one are rolled back.
+	 */
+	bool is_failed;
+	/** Error of the first failed transaction. */
+	struct diag diag;
+	/**
+	 * Order latches locked for the dispatched transactions. They are
+	 * unlocked when all the transactions are committed.
+	 */
+	struct latch *latches[VCLOCK_MAX + 1];
+	/** Number of locked order latches. */
+	int latch_count;
+};
+
 /**
  * State of a replication connection to the master
  */
@@ -190,6 +236,10 @@ struct applier {
 	struct fiber_cond resume_cond;
 	/* Diag to raise an error. */
 	struct diag diag;
+	/** Apply statistics, see enum applier_stat. */
+	struct rmean *stat;
+	/** Transactions being applied concurrently. */
+	struct applier_parallel parallel;
 	/* Master's vclock at the time of SUBSCRIBE. */
 	struct vclock remote_vclock_at_subscribe;
 	/** A pointer to the thread handling this applier's data stream. */
@@ -0,0 +1,370 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2025, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "arrow_insert.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <msgpuck.h>
+
+#include "arrow/abi.h"
+#include "diag.h"
+#include "engine.h"
+#include "errcode.h"
+#include "fiber.h"
+#include "iproto_constants.h"
+#include "small/region.h"
+#include "space.h"
+#include "trivia/util.h"
+#include "tuple_dictionary.h"
+#include "tuple_format.h"
+#include "txn.h"
+#include "xrow.h"
+
+/** Type of an Arrow column that can be converted to tuple fields. */
+enum arrow_insert_type {
+	ARROW_INSERT_NULL,
+	ARROW_INSERT_BOOL,
+	ARROW_INSERT_INT8,
+	ARROW_INSERT_INT16,
+	ARROW_INSERT_INT32,
+	ARROW_INSERT_INT64,
+	ARROW_INSERT_UINT8,
+	ARROW_INSERT_UINT16,
+	ARROW_INSERT_UINT32,
+	ARROW_INSERT_UINT64,
+	ARROW_INSERT_FLOAT,
+	ARROW_INSERT_DOUBLE,
+	ARROW_INSERT_STRING,
+	ARROW_INSERT_BINARY,
+	ARROW_INSERT_LARGE_STRING,
+	ARROW_INSERT_LARGE_BINARY,
+	ARROW_INSERT_TYPE_MAX,
+};
+
+/** Arrow format strings, indexed by enum arrow_insert_type. */
+static const char *const arrow_insert_formats[ARROW_INSERT_TYPE_MAX] = {
+	"n", "b", "c", "s", "i", "l", "C", "S", "I", "L", "f", "g",
+	"u", "z", "U", "Z",
+};
+
+/** Number of buffers of a column array, by enum arrow_insert_type. */
+static const int64_t arrow_insert_n_buffers[ARROW_INSERT_TYPE_MAX] = {
+	0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3,
+};
+
+/** A column of a record batch being inserted. */
+struct arrow_insert_column {
+	/** Type of the column. */
+	enum arrow_insert_type type;
+	/** Number of the tuple field the column is inserted into. */
+	uint32_t fieldno;
+	/** Validity bitmap or NULL if all values are valid. */
+	const uint8_t *validity;
+	/** Values, a bitmap of values or offsets into data. */
+	const void *values;
+	/** Data of variable-size values. */
+	const char *data;
+	/** Index of the first row of the batch in the buffers. */
+	int64_t offset;
+};
+
+static inline bool
+arrow_insert_bit_get(const uint8_t *bitmap, int64_t i)
+{
+	return (bitmap[i / 8] & (1 << (i % 8))) != 0;
+}
+
+/**
+ * Set up a column from a child of the record batch. The column is
+ * mapped to the space field with the same name.
+ */
+static int
+arrow_insert_column_create(struct arrow_insert_column *column,
+			   const struct ArrowArray *array,
+			   const struct ArrowSchema *schema,
+			   const struct ArrowArray *parent,
+			   struct space *space)
+{
+	const char *name = schema->name != NULL ? schema->name : "";
+	uint32_t name_len = strlen(name);
+	uint32_t fieldno;
+	if (tuple_fieldno_by_name(space->def->dict, name, name_len,
+				  field_name_hash(name, name_len),
+				  &fieldno) != 0) {
+		diag_set(ClientError, ER_NO_SUCH_FIELD_NAME_IN_SPACE, name,
+			 space_name(space));
+		return -1;
+	}
+	int type = 0;
+	while (type < ARROW_INSERT_TYPE_MAX &&
+	       strcmp(schema->format, arrow_insert_formats[type]) != 0)
+		type++;
+	if (type == ARROW_INSERT_TYPE_MAX || schema->dictionary != NULL) {
+		diag_set(IllegalParams,
+			 "box_insert_arrow: field %u has unsupported type",
+			 fieldno + 1);
+		return -1;
+	}
+	if (array->n_buffers < arrow_insert_n_buffers[type] ||
+	    array->length < parent->offset + parent->length) {
+		diag_set(IllegalParams,
+			 "box_insert_arrow: field %u has invalid array",
+			 fieldno + 1);
+		return -1;
+	}
+	column->type = type;
+	column->fieldno = fieldno;
+	column->offset = array->offset + parent->offset;
+	column->validity = NULL;
+	column->values = NULL;
+	column->data = NULL;
+	if (type == ARROW_INSERT_NULL)
+		return 0;
+	if (array->null_count != 0)
+		column->validity = array->buffers[0];
+	column->values = array->buffers[1];
+	if (arrow_insert_n_buffers[type] > 2)
+		column->data = array->buffers[2];
+	return 0;
+}
+
+/** Max size of a column value encoded in MsgPack. */
+static size_t
+arrow_insert_column_sizeof(const struct arrow_insert_column *column,
+			   int64_t row)
+{
+	int64_t i = column->offset + row;
+	switch (column->type) {
+	case ARROW_INSERT_STRING: {
+		const int32_t *offsets = column->values;
+		return mp_sizeof_str(offsets[i + 1] - offsets[i]);
+	}
+	case ARROW_INSERT_BINARY: {
+		const int32_t *offsets = column->values;
+		return mp_sizeof_bin(offsets[i + 1] - offsets[i]);
+	}
+	case ARROW_INSERT_LARGE_STRING: {
+		const int64_t *offsets = column->values;
+		return mp_sizeof_str(offsets[i + 1] - offsets[i]);
+	}
+	case ARROW_INSERT_LARGE_BINARY: {
+		const int64_t *offsets = column->values;
+		return mp_sizeof_bin(offsets[i + 1] - offsets[i]);
+	}
+	default:
+		return mp_sizeof_uint(UINT64_MAX);
+	}
+}
+
+/** Encode a string or binary value stored at [begin, end) in MsgPack. */
+static char *
+arrow_insert_encode_str(const struct arrow_insert_column *column,
+			int64_t begin, int64_t end, char *data)
+{
+	if (column->type == ARROW_INSERT_STRING ||
+	    column->type == ARROW_INSERT_LARGE_STRING)
+		return mp_encode_str(data, column->data + begin, end - begin);
+	return mp_encode_bin(data, column->data + begin, end - begin);
+}
+
+/** Encode a column value in MsgPack. */
+static char *
+arrow_insert_column_encode(const struct arrow_insert_column *column,
+			   int64_t row, char *data)
+{
+	int64_t i = column->offset + row;
+	if (column->type == ARROW_INSERT_NULL ||
+	    (column->validity != NULL &&
+	     !arrow_insert_bit_get(column->validity, i)))
+		return mp_encode_nil(data);
+	int64_t ival;
+	switch (column->type) {
+	case ARROW_INSERT_BOOL:
+		return mp_encode_bool(data,
+				      arrow_insert_bit_get(column->values, i));
+	case ARROW_INSERT_INT8:
+		ival = ((const int8_t *)column->values)[i];
+		break;
+	case ARROW_INSERT_INT16:
+		ival = ((const int16_t *)column->values)[i];
+		break;
+	case ARROW_INSERT_INT32:
+		ival = ((const int32_t *)column->values)[i];
+		break;
+	case ARROW_INSERT_INT64:
+		ival = ((const int64_t *)column->values)[i];
+		break;
+	case ARROW_INSERT_UINT8:
+		return mp_encode_uint(data,
+				      ((const uint8_t *)column->values)[i]);
+	case ARROW_INSERT_UINT16:
+		return mp_encode_uint(data,
+				      ((const uint16_t *)column->values)[i]);
+	case ARROW_INSERT_UINT32:
+		return mp_encode_uint(data,
+				      ((const uint32_t *)column->values)[i]);
+	case ARROW_INSERT_UINT64:
+		return mp_encode_uint(data,
+				      ((const uint64_t *)column->values)[i]);
+	case ARROW_INSERT_FLOAT:
+		return mp_encode_float(data,
+				       ((const float *)column->values)[i]);
+	case ARROW_INSERT_DOUBLE:
+		return mp_encode_double(data,
+					((const double *)column->values)[i]);
+	case ARROW_INSERT_STRING:
+	case ARROW_INSERT_BINARY: {
+		const int32_t *offsets = column->values;
+		return arrow_insert_encode_str(column, offsets[i],
+					       offsets[i + 1], data);
+	}
+	case ARROW_INSERT_LARGE_STRING:
+	case ARROW_INSERT_LARGE_BINARY: {
+		const int64_t *offsets = column->values;
+		return arrow_insert_encode_str(column, offsets[i],
+					       offsets[i + 1], data);
+	}
+	default:
+		unreachable();
+	}
+	return ival >= 0 ? mp_encode_uint(data, ival) :
+			   mp_encode_int(data, ival);
+}
+
+/**
+ * Check if the request was already logged and is being replayed by
+ * recovery or the applier.
+ */
+static bool
+arrow_insert_is_replay(const struct request *request)
+{
+	return recovery_state != FINISHED_RECOVERY ||
+	       (request->header != NULL && request->header->replica_id != 0);
+}
+
+/** Check that rows of the space may be inserted by arrow_insert_rows(). */
+static int
+arrow_insert_check_space(struct space *space)
+{
+	const char *what = NULL;
+	if (space->run_triggers && space_has_before_replace_triggers(space))
+		what = "spaces with before_replace triggers";
+	else if (space->sequence != NULL)
+		what = "spaces with sequences";
+	else if (tuple_format_has_defaults(space->format))
+		what = "spaces with field defaults";
+	if (what != NULL) {
+		diag_set(ClientError, ER_UNSUPPORTED, "box_insert_arrow", what);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Insert a row in a sub-statement of the current statement. @a parent
+ * is the batch insert request.
+ */
+static int
+arrow_insert_row(struct space *space, struct txn *txn,
+		 const struct request *parent,
+		 const char *tuple, const char *tuple_end)
+{
+	struct request request;
+	memset(&request, 0, sizeof(request));
+	request.type = IPROTO_INSERT;
+	request.space_id = space_id(space);
+	request.tuple = tuple;
+	request.tuple_end = tuple_end;
+	if (txn_begin_stmt(txn, space, request.type) != 0)
+		return -1;
+	/* The sub-statement is logged as a part of the parent request. */
+	txn_current_stmt(txn)->parent_row = parent->header;
+	struct tuple *result;
+	if (space->vtab->execute_replace(space, txn, &request, &result) != 0) {
+		txn_rollback_stmt(txn);
+		return -1;
+	}
+	return txn_commit_stmt(txn, NULL);
+}
+
+int
+arrow_insert_rows(struct space *space, struct txn *txn,
+		  struct request *request, struct ArrowArray *array,
+		  struct ArrowSchema *schema)
+{
+	if (!arrow_insert_is_replay(request) &&
+	    arrow_insert_check_space(space) != 0)
+		return -1;
+	if (strcmp(schema->format, "+s") != 0 ||
+	    array->n_children != schema->n_children) {
+		diag_set(IllegalParams,
+			 "box_insert_arrow: a struct array expected");
+		return -1;
+	}
+	if (array->null_count != 0) {
+		diag_set(ClientError, ER_UNSUPPORTED, "box_insert_arrow",
+			 "null rows");
+		return -1;
+	}
+	struct region *gc = &fiber()->gc;
+	size_t gc_svp = region_used(gc);
+	uint32_t column_count = array->n_children;
+	struct arrow_insert_column *columns = xregion_alloc_array(
+		gc, struct arrow_insert_column, column_count);
+	/* Number of fields in an inserted tuple. */
+	uint32_t field_count = 0;
+	for (uint32_t i = 0; i < column_count; i++) {
+		if (arrow_insert_column_create(&columns[i], array->children[i],
+					       schema->children[i], array,
+					       space) != 0)
+			goto fail;
+		field_count = MAX(field_count, columns[i].fieldno + 1);
+	}
+	/* Columns indexed by field number, NULL for omitted fields. */
+	struct arrow_insert_column **fields = xregion_alloc_array(
+		gc, struct arrow_insert_column *, field_count);
+	memset(fields, 0, field_count * sizeof(fields[0]));
+	for (uint32_t i = 0; i < column_count; i++) {
+		struct arrow_insert_column *column = &columns[i];
+		if (fields[column->fieldno] != NULL) {
+			diag_set(IllegalParams,
+				 "box_insert_arrow: duplicate field '%s'",
+				 schema->children[i]->name);
+			goto fail;
+		}
+		fields[column->fieldno] = column;
+	}
+	size_t row_svp = region_used(gc);
+	for (int64_t row = 0; row < array->length; row++) {
+		size_t size = mp_sizeof_array(field_count);
+		for (uint32_t i = 0; i < column_count; i++)
+			size += arrow_insert_column_sizeof(&columns[i], row);
+		size += field_count - column_count;
+		char *tuple = xregion_alloc(gc, size);
+		char *tuple_end = mp_encode_array(tuple, field_count);
+		for (uint32_t i = 0; i < field_count; i++) {
+			if (fields[i] == NULL) {
+				tuple_end = mp_encode_nil(tuple_end);
+				continue;
+			}
+			tuple_end = arrow_insert_column_encode(fields[i], row,
+							       tuple_end);
+		}
+		assert(tuple_end <= tuple + size);
+		if (arrow_insert_row(space, txn, request, tuple,
+				     tuple_end) != 0)
+			goto fail;
+		region_truncate(gc, row_svp);
+	}
+	region_truncate(gc, gc_svp);
+	return 0;
+fail:
+	region_truncate(gc, gc_svp);
+	return -1;
+}
@@ -0,0 +1,51 @@
+#pragma once
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2025, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct space;
+struct txn;
+struct request;
+struct ArrowArray;
+struct ArrowSchema;
+
+/**
+ * Execute a batch insert request in a space that stores tuples in
+ * MsgPack (memtx, vinyl).
+ *
+ * The record batch must be a struct array. Each child is a column of
+ * values of the space field with the same name as the column. Fields
+ * that don't have a column in the batch are set to nil. Supported
+ * column types are null, boolean, signed and unsigned integers, float,
+ * double, string and binary (including the large variants). A null
+ * value is stored as nil. Values are validated against the space
+ * format as for regular inserts.
+ *
+ * Each row is converted to a tuple and inserted with execute_replace
+ * in a sub-statement of the current statement so that on_replace
+ * triggers and statement rollback work as usual. The sub-statements
+ * aren't logged: the request is written to WAL as a whole by the
+ * parent statement and is re-executed on recovery. For this reason
+ * spaces with before_replace triggers, sequences or field defaults,
+ * which could make the result differ on recovery, aren't supported.
+ * The check is done for the original request only: a request that
+ * was already logged is replayed on recovery and by the applier
+ * unconditionally, like any other DML request. The log row of such
+ * a request is passed to recovery triggers of the sub-statements.
+ *
+ * Returns 0 on success. On failure returns -1 and sets diag.
+ */
+int
+arrow_insert_rows(struct space *space, struct txn *txn,
+		  struct request *request, struct ArrowArray *array,
+		  struct ArrowSchema *schema);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -0,0 +1,72 @@
+#pragma once
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2025, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+enum {
+	/** Default max number of rows in an Arrow record batch. */
+	ARROW_OPTIONS_BATCH_ROW_COUNT_DEFAULT = 4096,
+};
+
+/** A condition on a field a row must satisfy to be returned. */
+struct arrow_predicate {
+	/** Zero-based number of the field. */
+	uint32_t fieldno;
+	/** Comparison operator, see enum box_arrow_predicate_op. */
+	int op;
+	/** MsgPack value the field is compared with. */
+	char *value;
+	/** Size of the value. */
+	uint32_t value_size;
+};
+
+/** Options of an index Arrow stream. */
+struct arrow_options {
+	/** Max number of rows in a record batch returned by the stream. */
+	uint32_t batch_row_count;
+	/**
+	 * If set, the stream is created over a read view of the index
+	 * so that it may be used in any thread that runs a fiber.
+	 */
+	bool use_read_view;
+	/** If set, string fields are returned as dictionary columns. */
+	bool use_dictionary;
+	/** Predicates a row must satisfy to be returned, allocated. */
+	struct arrow_predicate *predicates;
+	/** Number of predicates. */
+	uint32_t predicate_count;
+};
+
+/** Initialize Arrow stream options with default values. */
+static inline void
+arrow_options_create(struct arrow_options *options)
+{
+	options->batch_row_count = ARROW_OPTIONS_BATCH_ROW_COUNT_DEFAULT;
+	options->use_read_view = false;
+	options->use_dictionary = false;
+	options->predicates = NULL;
+	options->predicate_count = 0;
+}
+
+/** Free memory allocated for Arrow stream options. */
+static inline void
+arrow_options_destroy(struct arrow_options *options)
+{
+	for (uint32_t i = 0; i < options->predicate_count; i++)
+		free(options->predicates[i].value);
+	free(options->predicates);
+}
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -43,8 +43,10 @@
 #include "identifier.h"
 #include "iproto.h"
 #include "iproto_constants.h"
+#include "iproto_read_view.h"
 #include "recovery.h"
 #include "wal.h"
+#include "wal_tail.h"
 #include "relay.h"
 #include "applier.h"
 #include <rmean.h>
@@ -1353,6 +1355,20 @@ box_check_replication_threads(void)
 	return 0;
 }
 
+static int
+box_check_replication_apply_concurrency(void)
+{
+	int count = cfg_geti("replication_apply_concurrency");
+	if (count <= 0 || count > REPLICATION_APPLY_CONCURRENCY_MAX) {
+		diag_set(ClientError, ER_CFG, "replication_apply_concurrency",
+			 tt_sprintf("must be greater than 0, less than or "
+				    "equal to %d",
+				    REPLICATION_APPLY_CONCURRENCY_MAX));
+		return -1;
+	}
+	return count;
+}
+
 /** Check bootstrap_strategy option validity. */
 static enum bootstrap_strategy
 box_check_bootstrap_strategy(void)
@@ -1751,6 +1767,64 @@ box_check_wal_queue_max_size(void)
 	return size;
 }
 
+static int64_t
+box_check_wal_tail_size(void)
+{
+	int64_t size = cfg_geti64("wal_tail_size");
+	if (size < 0) {
+		diag_set(ClientError, ER_CFG, "wal_tail_size",
+			 "the value must be >= 0");
+		return -1;
+	}
+	return size;
+}
+
+/**
+ * Check validity of a zstd compression level option
+ * (wal_compression_level, snap_compression_level,
+ * vinyl_log_compression_level).
+ */
+static int
+box_check_compression_level(const char *option)
+{
+	int64_t level = cfg_geti64(option);
+	if (level < 0 || level > XLOG_COMPRESSION_LEVEL_MAX) {
+		diag_set(ClientError, ER_CFG, option,
+			 tt_sprintf("the value must be >= 0 and <= %d",
+				    XLOG_COMPRESSION_LEVEL_MAX));
+		return -1;
+	}
+	return level;
+}
+
+/** Check snap_delta_max option validity. */
+static int
+box_check_snap_delta_max(void)
+{
+	int64_t value = cfg_geti64("snap_delta_max");
+	if (value < 0 || value > INT32_MAX) {
+		diag_set(ClientError, ER_CFG, "snap_delta_max",
+			 tt_sprintf("the value must be >= 0 and <= %d",
+				    INT32_MAX));
+		return -1;
+	}
+	return value;
+}
+
+/** Check wal_compression_threads option validity. */
+static int
+box_check_wal_compression_threads(void)
+{
+	int64_t threads = cfg_geti64("wal_compression_threads");
+	if (threads < 0 || threads > WAL_COMPRESSION_THREADS_MAX) {
+		diag_set(ClientError, ER_CFG, "wal_compression_threads",
+			 tt_sprintf("the value must be >= 0 and <= %d",
+				    WAL_COMPRESSION_THREADS_MAX));
+		return -1;
+	}
+	return threads;
+}
+
 /** Check replication_synchro_queue_max_size option validity. */
 static int64_t
 box_check_replication_synchro_queue_max_size(void)
@@ -1846,6 +1920,36 @@ box_check_memory_quota(const char *quota_name)
 	return -1;
 }
 
+/** Check vinyl_max_subcompactions option validity. */
+static int
+box_check_vinyl_max_subcompactions(void)
+{
+	int count = cfg_geti("vinyl_max_subcompactions");
+	if (count <= 0 || count > VINYL_MAX_SUBCOMPACTIONS_MAX) {
+		diag_set(ClientError, ER_CFG, "vinyl_max_subcompactions",
+			 tt_sprintf("must be greater than 0, less than or "
+				    "equal to %d",
+				    VINYL_MAX_SUBCOMPACTIONS_MAX));
+		return -1;
+	}
+	return count;
+}
+
+/** Check vinyl_readahead option validity. */
+static int
+box_check_vinyl_readahead(void)
+{
+	int page_count = cfg_geti("vinyl_readahead");
+	if (page_count < 0 || page_count > VINYL_READAHEAD_MAX) {
+		diag_set(ClientError, ER_CFG, "vinyl_readahead",
+			 tt_sprintf("must be greater than or equal to 0, "
+				    "less than or equal to %d",
+				    VINYL_READAHEAD_MAX));
+		return -1;
+	}
+	return page_count;
+}
+
 static void
 box_check_vinyl_options(void)
 {
@@ -1885,6 +1989,10 @@ box_check_vinyl_options(void)
 		tnt_raise(ClientError, ER_CFG, "vinyl_bloom_fpr",
 			  "must be greater than 0 and less than or equal to 1");
 	}
+	if (box_check_vinyl_max_subcompactions() < 0)
+		diag_raise();
+	if (box_check_vinyl_readahead() < 0)
+		diag_raise();
 }
 
 static int
@@ -1961,6 +2069,18 @@ box_check_txn_timeout(void)
 	return timeout;
 }
 
+static double
+box_check_iproto_read_view_period(void)
+{
+	double period = cfg_getd("iproto_read_view_period");
+	if (period < 0) {
+		diag_set(ClientError, ER_CFG, "iproto_read_view_period",
+			 "the value must be greater than or equal to 0");
+		return -1;
+	}
+	return period;
+}
+
 static double
 box_check_txn_synchro_timeout(void)
 {
@@ -2099,6 +2219,8 @@ box_check_config(void)
 		diag_raise();
 	if (box_check_replication_threads() < 0)
 		diag_raise();
+	if (box_check_replication_apply_concurrency() < 0)
+		diag_raise();
 	box_check_replication_sync_timeout();
 	if (box_check_replication_anon_ttl() < 0)
 		diag_raise();
@@ -2114,6 +2236,18 @@ box_check_config(void)
 	box_check_wal_mode(cfg_gets("wal_mode"));
 	if (box_check_wal_queue_max_size() < 0)
 		diag_raise();
+	if (box_check_wal_tail_size() < 0)
+		diag_raise();
+	if (box_check_compression_level("wal_compression_level") < 0)
+		diag_raise();
+	if (box_check_compression_level("snap_compression_level") < 0)
+		diag_raise();
+	if (box_check_compression_level("vinyl_log_compression_level") < 0)
+		diag_raise();
+	if (box_check_wal_compression_threads() < 0)
+		diag_raise();
+	if (box_check_snap_delta_max() < 0)
+		diag_raise();
 	if (box_check_replication_synchro_queue_max_size() < 0)
 		diag_raise();
 	if (box_check_wal_cleanup_delay() < 0)
@@ -2133,6 +2267,8 @@ box_check_config(void)
 		diag_raise();
 	if (box_check_txn_timeout() < 0)
 		diag_raise();
+	if (box_check_iproto_read_view_period() < 0)
+		diag_raise();
 	if (box_check_txn_synchro_timeout() < 0)
 		diag_raise();
 	if (box_check_txn_isolation() == txn_isolation_level_MAX)
@@ -2481,6 +2617,16 @@ box_set_replication_skip_conflict(void)
 	replication_skip_conflict = cfg_geti("replication_skip_conflict");
 }
 
+int
+box_set_replication_apply_concurrency(void)
+{
+	int count = box_check_replication_apply_concurrency();
+	if (count < 0)
+		return -1;
+	replication_apply_concurrency = count;
+	return 0;
+}
+
 /** Register on the master instance. Could be initial join or a name change. */
 static void
 box_register_on_master(void)
@@ -3396,6 +3542,42 @@ box_set_snap_io_rate_limit(void)
 			cfg_getd("snap_io_rate_limit"));
 }
 
+int
+box_set_snap_compression_level(void)
+{
+	int level = box_check_compression_level("snap_compression_level");
+	if (level < 0)
+		return -1;
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_snap_compression_level(memtx, level);
+	return 0;
+}
+
+void
+box_set_snap_compression_dict(void)
+{
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_snap_compression_dict(
+		memtx, cfg_geti("snap_compression_dict"));
+}
+
+int
+box_set_snap_delta_max(void)
+{
+	int delta_max = box_check_snap_delta_max();
+	if (delta_max < 0)
+		return -1;
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_snap_delta_max(memtx, delta_max);
+	return 0;
+}
+
 void
 box_set_memtx_memory(void)
 {
@@ -3468,6 +3650,31 @@ box_set_wal_queue_max_size(void)
 	return 0;
 }
 
+int
+box_set_wal_tail_size(void)
+{
+	int64_t size = box_check_wal_tail_size();
+	if (size < 0)
+		return -1;
+	return wal_tail_set_size(size);
+}
+
+int
+box_set_wal_compression_level(void)
+{
+	int level = box_check_compression_level("wal_compression_level");
+	if (level < 0)
+		return -1;
+	wal_set_compression_level(level);
+	return 0;
+}
+
+void
+box_set_wal_compression_dict(void)
+{
+	wal_set_compression_dict(cfg_geti("wal_compression_dict"));
+}
+
 int
 box_set_replication_synchro_queue_max_size(void)
 {
@@ -3539,6 +3746,51 @@ box_set_vinyl_cache(void)
 	vinyl_engine_set_cache(vinyl, cfg_geti64("vinyl_cache"));
 }
 
+void
+box_set_vinyl_page_cache(void)
+{
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_page_cache(vinyl, cfg_geti64("vinyl_page_cache"));
+}
+
+int
+box_set_vinyl_max_subcompactions(void)
+{
+	int count = box_check_vinyl_max_subcompactions();
+	if (count < 0)
+		return -1;
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_max_subcompactions(vinyl, count);
+	return 0;
+}
+
+int
+box_set_vinyl_readahead(void)
+{
+	int page_count = box_check_vinyl_readahead();
+	if (page_count < 0)
+		return -1;
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_readahead(vinyl, page_count);
+	return 0;
+}
+
+int
+box_set_vinyl_log_compression_level(void)
+{
+	int level = box_check_compression_level(
+		"vinyl_log_compression_level");
+	if (level < 0)
+		return -1;
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_log_compression_level(vinyl, level);
+	return 0;
+}
+
 void
 box_set_vinyl_timeout(void)
 {
@@ -3564,6 +3816,16 @@ box_set_net_msg_max(void)
 				IPROTO_FIBER_POOL_SIZE_FACTOR);
 }
 
+int
+box_set_iproto_read_view_period(void)
+{
+	double period = box_check_iproto_read_view_period();
+	if (period < 0)
+		return -1;
+	iproto_read_view_set_period(period);
+	return 0;
+}
+
 int
 box_set_prepared_stmt_cache_size(void)
 {
@@ -5363,6 +5625,13 @@ engine_init()
 	engine_register(vinyl);
 	box_set_vinyl_max_tuple_size();
 	box_set_vinyl_cache();
+	box_set_vinyl_page_cache();
+	if (box_set_vinyl_max_subcompactions() != 0)
+		diag_raise();
+	if (box_set_vinyl_readahead() != 0)
+		diag_raise();
+	if (box_set_vinyl_log_compression_level() != 0)
+		diag_raise();
 	box_set_vinyl_timeout();
 
 	quiver_engine_register();
@@ -5997,6 +6266,8 @@ box_cfg_xc(void)
 	if (box_set_prepared_stmt_cache_size() != 0)
 		diag_raise();
 	box_set_net_msg_max();
+	if (box_set_iproto_read_view_period() != 0)
+		diag_raise();
 	box_set_readahead();
 	box_set_too_long_threshold();
 	box_set_replication_timeout();
@@ -6018,10 +6289,14 @@ box_cfg_xc(void)
 	if (box_set_replication_synchro_queue_max_size() != 0)
 		diag_raise();
 	box_set_replication_sync_timeout();
+	if (box_set_replication_apply_concurrency() != 0)
+		diag_raise();
 	if (box_check_instance_name(cfg_instance_name) != 0)
 		diag_raise();
 	if (box_set_wal_queue_max_size() != 0)
 		diag_raise();
+	if (box_set_wal_tail_size() != 0)
+		diag_raise();
 	cfg_replication_anon = box_check_replication_anon();
 	box_broadcast_ballot();
 	/*
@@ -6286,6 +6561,7 @@ box_reset_stat(void)
 	rmean_cleanup(rmean_box);
 	rmean_cleanup(rmean_error);
 	engine_reset_stat();
+	wal_reset_stat();
 	space_foreach(box_reset_space_stat, NULL);
 }
 
@@ -6514,12 +6790,16 @@ box_storage_init(void)
 		cfg_geti64("wal_max_size"));
 	enum wal_mode wal_mode = box_check_wal_mode(cfg_gets("wal_mode"));
 	double wal_retention_period = box_check_wal_retention_period_xc();
+	int wal_compression_threads = box_check_wal_compression_threads();
+	if (wal_compression_threads < 0)
+		diag_raise();
 	struct vclock *checkpoint_vclock = NULL;
 	struct gc_checkpoint *last_checkpoint = gc_last_checkpoint();
 	if (last_checkpoint != NULL)
 		checkpoint_vclock = &last_checkpoint->vclock;
 	if (wal_init(wal_mode, cfg_gets("wal_dir"), wal_max_size,
-		     wal_retention_period, &INSTANCE_UUID,
+		     wal_retention_period, wal_compression_threads,
+		     &INSTANCE_UUID,
 		     &instance_vclock_storage, checkpoint_vclock,
 		     on_wal_garbage_collection,
 		     on_wal_checkpoint_threshold) != 0) {
@@ -357,12 +357,18 @@ int box_listen(void);
 void box_set_replication(void);
 void box_set_io_collect_interval(void);
 void box_set_snap_io_rate_limit(void);
+int box_set_snap_compression_level(void);
+void box_set_snap_compression_dict(void);
+int box_set_snap_delta_max(void);
 void box_set_too_long_threshold(void);
 void box_set_readahead(void);
 void box_set_checkpoint_count(void);
 void box_set_checkpoint_interval(void);
 void box_set_checkpoint_wal_threshold(void);
 int box_set_wal_queue_max_size(void);
+int box_set_wal_tail_size(void);
+int box_set_wal_compression_level(void);
+void box_set_wal_compression_dict(void);
 int box_set_replication_synchro_queue_max_size(void);
 int box_set_wal_cleanup_delay(void);
 void box_set_memtx_memory(void);
@@ -370,6 +376,10 @@ void box_set_memtx_max_tuple_size(void);
 void box_set_vinyl_memory(void);
 void box_set_vinyl_max_tuple_size(void);
 void box_set_vinyl_cache(void);
+void box_set_vinyl_page_cache(void);
+int box_set_vinyl_max_subcompactions(void);
+int box_set_vinyl_readahead(void);
+int box_set_vinyl_log_compression_level(void);
 void box_set_vinyl_timeout(void);
 void box_set_force_recovery(void);
 int box_set_election_mode(void);
@@ -385,12 +395,14 @@ int box_set_replication_synchro_quorum(void);
 int box_set_replication_synchro_timeout(void);
 void box_set_replication_sync_timeout(void);
 void box_set_replication_skip_conflict(void);
+int box_set_replication_apply_concurrency(void);
 void box_set_replication_anon(void);
 int box_set_replication_anon_ttl(void);
 void box_set_instance_name(void);
 void box_set_replicaset_name(void);
 void box_set_cluster_name(void);
 void box_set_net_msg_max(void);
+int box_set_iproto_read_view_period(void);
 int box_set_prepared_stmt_cache_size(void);
 int box_set_feedback(void);
 int box_set_txn_timeout(void);
@@ -739,7 +739,9 @@ field_def_decode(struct field_def *field, const char **data,
 				"'string', 'scalar', and 'any' fields");
 		return -1;
 	}
-	if (field->compression_type == compression_type_MAX) {
+	if (field->compression_type == compression_type_MAX ||
+	    (field->compression_type != COMPRESSION_TYPE_NONE &&
+	     !tt_compression_is_supported(field->compression_type))) {
 		field_def_error(fieldno, "unknown compression type");
 		return -1;
 	}
@@ -216,8 +216,14 @@ field_mp_type_is_compatible(enum field_type type, const char *data,
 	} else {
 		int8_t ext_type;
 		mp_decode_extl(&data, &ext_type);
-		if (ext_type >= 0) {
-			assert(ext_type != MP_COMPRESSION);
+		if (ext_type == MP_COMPRESSION) {
+			/*
+			 * Compressed values are only created by memtx
+			 * and are never validated, so this one came
+			 * from the user.
+			 */
+			return false;
+		} else if (ext_type >= 0) {
 			mask = field_ext_type[type];
 			return (mask & (1U << ext_type)) != 0;
 		} else {
@@ -29,6 +29,9 @@
  * SUCH DAMAGE.
  */
 #include "index.h"
+#include "arrow_options.h"
+#include "arrow/abi.h"
+#include "port.h"
 #include "tuple.h"
 #include "say.h"
 #include "schema.h"
@@ -39,6 +42,7 @@
 #include "rmean.h"
 #include "info/info.h"
 #include "memtx_tx.h"
+#include "read_view.h"
 #include "box.h"
 #include "base64.h"
 #include "scoped_guard.h"
@@ -530,6 +534,54 @@ box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 	return 0;
 }
 
+int
+box_index_get_many(uint32_t space_id, uint32_t index_id, const char *keys,
+		   const char *keys_end, struct port *port)
+{
+	assert(keys != NULL && keys_end != NULL);
+	(void)keys_end;
+	if (box_check_slice() != 0)
+		return -1;
+	struct space *space;
+	struct index *index;
+	if (check_index(space_id, index_id, &space, &index) != 0)
+		return -1;
+	assert(mp_typeof(*keys) == MP_ARRAY); /* checked by Lua */
+	uint32_t key_count = mp_decode_array(&keys);
+	RegionGuard region_guard(&fiber()->gc);
+	const char **key_parts = xregion_alloc_array(&fiber()->gc,
+						     const char *, key_count);
+	for (uint32_t i = 0; i < key_count; i++) {
+		const char *key_array = keys;
+		if (mp_typeof(*keys) != MP_ARRAY) {
+			diag_set(IllegalParams, "key must be an array");
+			return -1;
+		}
+		uint32_t part_count = mp_decode_array(&keys);
+		if (exact_key_validate(index->def, keys, part_count) != 0)
+			return -1;
+		box_run_on_select(space, index, ITER_EQ, key_array);
+		key_parts[i] = keys;
+		keys = key_array;
+		mp_next(&keys);
+	}
+	/* Start transaction in the engine. */
+	struct txn *txn;
+	struct txn_ro_savepoint svp;
+	if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
+		return -1;
+	port_c_create(port);
+	int rc = index_get_many(index, key_parts, key_count, port);
+	txn_end_ro_stmt(txn, &svp);
+	if (rc != 0) {
+		port_destroy(port);
+		return -1;
+	}
+	/* Count statistics. */
+	rmean_collect(rmean_box, IPROTO_SELECT, 1);
+	return 0;
+}
+
 int
 box_index_min(uint32_t space_id, uint32_t index_id, const char *key,
 	      const char *key_end, box_tuple_t **result)
@@ -628,6 +680,229 @@ box_index_count(uint32_t space_id, uint32_t index_id, int type,
 	return count;
 }
 
+box_arrow_options_t *
+box_arrow_options_new(void)
+{
+	struct arrow_options *options =
+		(struct arrow_options *)xmalloc(sizeof(*options));
+	arrow_options_create(options);
+	return options;
+}
+
+void
+box_arrow_options_delete(box_arrow_options_t *options)
+{
+	arrow_options_destroy(options);
+	free(options);
+}
+
+void
+box_arrow_options_set_batch_row_count(box_arrow_options_t *options,
+				      uint32_t batch_row_count)
+{
+	options->batch_row_count = batch_row_count;
+}
+
+void
+box_arrow_options_set_use_read_view(box_arrow_options_t *options,
+				    bool use_read_view)
+{
+	options->use_read_view = use_read_view;
+}
+
+void
+box_arrow_options_set_use_dictionary(box_arrow_options_t *options,
+				     bool use_dictionary)
+{
+	options->use_dictionary = use_dictionary;
+}
+
+void
+box_arrow_options_add_predicate(box_arrow_options_t *options,
+				uint32_t fieldno, int op,
+				const char *value, const char *value_end)
+{
+	assert(value != NULL && value_end > value);
+	uint32_t count = options->predicate_count + 1;
+	options->predicates = (struct arrow_predicate *)
+		xrealloc(options->predicates,
+			 count * sizeof(options->predicates[0]));
+	struct arrow_predicate *predicate = &options->predicates[count - 1];
+	predicate->fieldno = fieldno;
+	predicate->op = op;
+	predicate->value_size = value_end - value;
+	predicate->value = (char *)xmalloc(predicate->value_size);
+	memcpy(predicate->value, value, predicate->value_size);
+	options->predicate_count = count;
+}
+
+/** Arrow stream over an index read view that owns the read view. */
+struct index_read_view_arrow_stream {
+	/** Read view of the index. */
+	struct read_view rv;
+	/** Stream over the index read view. */
+	struct ArrowArrayStream stream;
+};
+
+static int
+index_read_view_arrow_stream_get_schema(struct ArrowArrayStream *base,
+					struct ArrowSchema *out)
+{
+	struct index_read_view_arrow_stream *s =
+		(struct index_read_view_arrow_stream *)base->private_data;
+	return s->stream.get_schema(&s->stream, out);
+}
+
+static int
+index_read_view_arrow_stream_get_next(struct ArrowArrayStream *base,
+				      struct ArrowArray *out)
+{
+	struct index_read_view_arrow_stream *s =
+		(struct index_read_view_arrow_stream *)base->private_data;
+	return s->stream.get_next(&s->stream, out);
+}
+
+static const char *
+index_read_view_arrow_stream_get_last_error(struct ArrowArrayStream *base)
+{
+	struct index_read_view_arrow_stream *s =
+		(struct index_read_view_arrow_stream *)base->private_data;
+	return s->stream.get_last_error(&s->stream);
+}
+
+static void
+index_read_view_arrow_stream_release(struct ArrowArrayStream *base)
+{
+	struct index_read_view_arrow_stream *s =
+		(struct index_read_view_arrow_stream *)base->private_data;
+	s->stream.release(&s->stream);
+	read_view_close(&s->rv);
+	free(s);
+	base->release = NULL;
+}
+
+static bool
+index_read_view_arrow_stream_filter_space(struct space *space, void *arg)
+{
+	struct index *index = (struct index *)arg;
+	/* See the space upgrade check in box_index_arrow_stream(). */
+	return space_id(space) == index->def->space_id &&
+	       space->upgrade == NULL;
+}
+
+static bool
+index_read_view_arrow_stream_filter_index(struct space *space,
+					  struct index *index, void *arg)
+{
+	(void)space;
+	return index == (struct index *)arg;
+}
+
+/**
+ * Create an Arrow stream over a read view of the given index. The read
+ * view is closed when the stream is released.
+ */
+static int
+index_create_read_view_arrow_stream(struct index *index,
+				    uint32_t field_count,
+				    const uint32_t *fields,
+				    const char *key, uint32_t part_count,
+				    const struct arrow_options *options,
+				    struct ArrowArrayStream *stream)
+{
+	struct index_read_view_arrow_stream *s =
+		(struct index_read_view_arrow_stream *)xmalloc(sizeof(*s));
+	struct read_view_opts opts;
+	read_view_opts_create(&opts);
+	opts.name = "arrow_stream";
+	opts.filter_space = index_read_view_arrow_stream_filter_space;
+	opts.filter_index = index_read_view_arrow_stream_filter_index;
+	opts.filter_arg = index;
+	opts.enable_field_names = true;
+	opts.enable_data_temporary_spaces = true;
+	if (read_view_open(&s->rv, &opts) != 0) {
+		free(s);
+		return -1;
+	}
+	struct index_read_view *index_rv = NULL;
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &s->rv)
+		index_rv = space_read_view_index(space_rv, index->def->iid);
+	if (index_rv == NULL) {
+		/* The engine doesn't support read views. */
+		diag_set(UnsupportedIndexFeature, index->def,
+			 "arrow stream in read view");
+		goto fail;
+	}
+	if (index_read_view_create_arrow_stream(index_rv, field_count, fields,
+						key, part_count, options,
+						&s->stream) != 0)
+		goto fail;
+	memset(stream, 0, sizeof(*stream));
+	stream->get_schema = index_read_view_arrow_stream_get_schema;
+	stream->get_next = index_read_view_arrow_stream_get_next;
+	stream->get_last_error = index_read_view_arrow_stream_get_last_error;
+	stream->release = index_read_view_arrow_stream_release;
+	stream->private_data = s;
+	return 0;
+fail:
+	read_view_close(&s->rv);
+	free(s);
+	return -1;
+}
+
+int
+box_index_arrow_stream(uint32_t space_id, uint32_t index_id,
+		       uint32_t field_count, const uint32_t *fields,
+		       const char *key, const char *key_end,
+		       const box_arrow_options_t *options,
+		       struct ArrowArrayStream *stream)
+{
+	assert(key != NULL && key_end != NULL);
+	assert(options != NULL && stream != NULL);
+	mp_tuple_assert(key, key_end);
+	struct space *space;
+	struct index *index;
+	if (check_index(space_id, index_id, &space, &index) != 0)
+		return -1;
+	const char *key_array = key;
+	uint32_t part_count = mp_decode_array(&key);
+	enum iterator_type type = part_count == 0 ? ITER_ALL : ITER_EQ;
+	if (iterator_validate(index->def, type, key, part_count))
+		return -1;
+	box_run_on_select(space, index, type, key_array);
+	int rc;
+	if (options->use_read_view) {
+		/*
+		 * Tuples fetched from a read view wouldn't be upgraded,
+		 * because read views with space upgrade aren't supported
+		 * in this build, see space_upgrade_read_view_new().
+		 */
+		if (space->upgrade != NULL) {
+			diag_set(ClientError, ER_UNSUPPORTED,
+				 "Arrow stream in read view", "space upgrade");
+			return -1;
+		}
+		rc = index_create_read_view_arrow_stream(index, field_count,
+							 fields, key,
+							 part_count, options,
+							 stream);
+	} else {
+		/* Start transaction in the engine. */
+		struct txn *txn;
+		struct txn_ro_savepoint svp;
+		if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
+			return -1;
+		rc = index_create_arrow_stream(index, field_count, fields, key,
+					       part_count, options, stream);
+		txn_end_ro_stmt(txn, &svp);
+	}
+	if (rc != 0)
+		return -1;
+	rmean_collect(rmean_box, IPROTO_SELECT, 1);
+	return 0;
+}
+
 /* }}} */
 
 /* {{{ Iterators ************************************************/
@@ -1153,6 +1428,21 @@ generic_index_get(struct index *index, const char *key,
 	return -1;
 }
 
+int
+generic_index_get_many(struct index *index, const char **keys,
+		       uint32_t key_count, struct port *port)
+{
+	uint32_t part_count = index->def->key_def->part_count;
+	for (uint32_t i = 0; i < key_count; i++) {
+		struct tuple *tuple;
+		if (index_get(index, keys[i], part_count, &tuple) != 0)
+			return -1;
+		if (tuple != NULL)
+			port_c_add_tuple(port, tuple);
+	}
+	return 0;
+}
+
 int
 generic_index_replace(struct index *index, struct tuple *old_tuple,
 		      struct tuple *new_tuple, enum dup_replace_mode mode,
@@ -52,6 +52,7 @@ struct index_read_view_iterator;
 struct index_def;
 struct key_def;
 struct info_handler;
+struct port;
 struct arrow_options;
 struct ArrowArrayStream;
 
@@ -271,6 +272,126 @@ ssize_t
 box_index_count(uint32_t space_id, uint32_t index_id, int type,
 		const char *key, const char *key_end);
 
+struct ArrowArrayStream;
+
+/** Options of an index Arrow stream. */
+typedef struct arrow_options box_arrow_options_t;
+
+/**
+ * Allocate Arrow stream options initialized with default values.
+ * The options must be freed with box_arrow_options_delete().
+ */
+box_arrow_options_t *
+box_arrow_options_new(void);
+
+/** Free Arrow stream options. */
+void
+box_arrow_options_delete(box_arrow_options_t *options);
+
+/**
+ * Set the max number of rows in a record batch returned by an Arrow
+ * stream. The default is 4096.
+ */
+void
+box_arrow_options_set_batch_row_count(box_arrow_options_t *options,
+				      uint32_t batch_row_count);
+
+/**
+ * Create the Arrow stream over a read view of the index. Such a stream
+ * may be used in any thread that runs a fiber (a cord created with
+ * cord_start() or the like) and returns the data as it was when the
+ * stream was created. Only full scans of memtx TREE and HASH indexes
+ * are supported. The default is false.
+ */
+void
+box_arrow_options_set_use_read_view(box_arrow_options_t *options,
+				    bool use_read_view);
+
+/**
+ * Return string fields as dictionary-encoded columns: int32 indexes
+ * into a dictionary of the distinct values of the record batch. This
+ * reduces the size of batches and speeds up grouping by fields with
+ * few distinct values. The default is false.
+ */
+void
+box_arrow_options_set_use_dictionary(box_arrow_options_t *options,
+				     bool use_dictionary);
+
+/** Comparison operators of Arrow stream predicates. */
+enum box_arrow_predicate_op {
+	/** field == value */
+	BOX_ARROW_PREDICATE_EQ = 0,
+	/** field != value */
+	BOX_ARROW_PREDICATE_NE = 1,
+	/** field < value */
+	BOX_ARROW_PREDICATE_LT = 2,
+	/** field <= value */
+	BOX_ARROW_PREDICATE_LE = 3,
+	/** field > value */
+	BOX_ARROW_PREDICATE_GT = 4,
+	/** field >= value */
+	BOX_ARROW_PREDICATE_GE = 5,
+	box_arrow_predicate_op_MAX
+};
+
+/**
+ * Add a predicate to the options. An Arrow stream only returns rows
+ * that satisfy all the predicates. The predicates are evaluated on
+ * column vectors of a whole batch of rows before the returned fields
+ * are decoded so the fields of rows that don't match are never
+ * decoded. Because of that, a record batch may contain fewer rows
+ * than the batch row count.
+ *
+ * Predicates are supported for integer, floating point and string
+ * fields. Strings are compared with the collation of the field, if
+ * any, otherwise byte-wise. A null or missing field never satisfies
+ * a predicate.
+ *
+ * \param options stream options
+ * \param fieldno zero-based number of the field
+ * \param op comparison operator, enum box_arrow_predicate_op
+ * \param value value the field is compared with, encoded in MsgPack
+ * \param value_end the end of encoded \a value
+ */
+void
+box_arrow_options_add_predicate(box_arrow_options_t *options,
+				uint32_t fieldno, int op,
+				const char *value, const char *value_end);
+
+/**
+ * Create an Arrow stream over the index for a column scan.
+ *
+ * The stream returns record batches of struct arrays with a child
+ * column array per field in @a fields, in the index order. Only tuples
+ * matching @a key with the EQ iterator semantics are returned, pass an
+ * empty key to scan the whole index.
+ *
+ * The stream must be used in the tx thread and released with its
+ * release callback. It ends if the index is dropped or altered.
+ *
+ * A stream created with the use_read_view option may be used in any
+ * thread that runs a fiber, because record batches are built on the
+ * fiber region and errors are reported through the fiber diag, but
+ * it must still be released in the tx thread.
+ *
+ * \param space_id space identifier
+ * \param index_id index identifier
+ * \param field_count number of fields in @a fields
+ * \param fields zero-based numbers of the fields to return
+ * \param key encoded key in MsgPack Array format ([part1, part2, ...])
+ * \param key_end the end of encoded \a key
+ * \param options stream options
+ * \param[out] stream the stream
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ */
+int
+box_index_arrow_stream(uint32_t space_id, uint32_t index_id,
+		       uint32_t field_count, const uint32_t *fields,
+		       const char *key, const char *key_end,
+		       const box_arrow_options_t *options,
+		       struct ArrowArrayStream *stream);
+
 /**
  * Extract key from tuple according to key definition of given
  * index. Returned buffer is allocated on box_txn_alloc() with
@@ -321,6 +442,24 @@ box_index_tuple_position(uint32_t space_id, uint32_t index_id,
 			 const char *tuple, const char *tuple_end,
 			 const char **packed_pos, const char **packed_pos_end);
 
+/**
+ * Look up tuples by a batch of exact keys (index:get_many()).
+ * Found tuples are appended to @a port in the order of the keys,
+ * keys without a matching tuple are skipped.
+ *
+ * \param space_id space identifier
+ * \param index_id index identifier
+ * \param keys MsgPack array of keys, each in MsgPack Array format
+ * \param keys_end the end of encoded \a keys
+ * \param[out] port port with the found tuples, must be destroyed by
+ *             the caller on success
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ */
+int
+box_index_get_many(uint32_t space_id, uint32_t index_id, const char *keys,
+		   const char *keys_end, struct port *port);
+
 /**
  * Index statistics (index:stat())
  *
@@ -629,6 +768,16 @@ struct index_vtab {
 			    uint32_t part_count, struct tuple **result);
 	int (*get)(struct index *index, const char *key,
 		   uint32_t part_count, struct tuple **result);
+	/**
+	 * Look up tuples by a batch of exact keys, like get() called for
+	 * each key in turn, and append the found tuples to @a port in the
+	 * order of the keys. Every key has all the parts of the index key
+	 * definition and is passed without the MsgPack array header.
+	 * Implementations may reorder or interleave the lookups to hide
+	 * the latency of cache misses or disk reads.
+	 */
+	int (*get_many)(struct index *index, const char **keys,
+			uint32_t key_count, struct port *port);
 	/**
 	 * Main entrance point for changing data in index. Once built and
 	 * before deletion this is the only way to insert, replace and delete
@@ -1028,6 +1177,13 @@ index_get(struct index *index, const char *key,
 	return index->vtab->get(index, key, part_count, result);
 }
 
+static inline int
+index_get_many(struct index *index, const char **keys, uint32_t key_count,
+	       struct port *port)
+{
+	return index->vtab->get_many(index, keys, key_count, port);
+}
+
 static inline int
 index_replace(struct index *index, struct tuple *old_tuple,
 	      struct tuple *new_tuple, enum dup_replace_mode mode,
@@ -1264,6 +1420,8 @@ int
 generic_index_get_internal(struct index *index, const char *key,
 			   uint32_t part_count, struct tuple **result);
 int generic_index_get(struct index *, const char *, uint32_t, struct tuple **);
+int generic_index_get_many(struct index *, const char **, uint32_t,
+			   struct port *);
 int generic_index_replace(struct index *, struct tuple *, struct tuple *,
 			  enum dup_replace_mode,
 			  struct tuple **, struct tuple **);
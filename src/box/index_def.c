@@ -52,6 +52,7 @@ const struct index_opts index_opts_default = {
 	/* .lsn                 = */ 0,
 	/* .func                = */ 0,
 	/* .hint                = */ INDEX_HINT_DEFAULT,
+	/* .hash_bits           = */ 32,
 	/* .covered_fields      = */ NULL,
 	/* .covered_field_count = */ 0,
 	/* .layout              = */ NULL,
@@ -78,6 +79,29 @@ index_opts_parse_hint(const char **data, void *opts, struct region *region)
 	return 0;
 }
 
+/**
+ * Parse index hash_bits option from msgpack.
+ * Return 0 on success or -1 on error (diag is set to IllegalParams).
+ */
+static int
+index_opts_parse_hash_bits(const char **data, void *opts,
+			   struct region *region)
+{
+	(void)region;
+	struct index_opts *index_opts = (struct index_opts *)opts;
+	if (mp_typeof(**data) != MP_UINT) {
+		diag_set(IllegalParams, "'hash_bits' must be 32 or 64");
+		return -1;
+	}
+	uint64_t hash_bits = mp_decode_uint(data);
+	if (hash_bits != 32 && hash_bits != 64) {
+		diag_set(IllegalParams, "'hash_bits' must be 32 or 64");
+		return -1;
+	}
+	index_opts->hash_bits = hash_bits;
+	return 0;
+}
+
 /**
  * Parse index covers options given as MsgPack in `data' into `opts'. Covered
  * fields array is allocated on `region'.
@@ -147,6 +171,7 @@ const struct opt_def index_opts_reg[] = {
 	OPT_DEF("func", OPT_UINT32, struct index_opts, func_id),
 	OPT_DEF_LEGACY("sql"),
 	OPT_DEF_CUSTOM("hint", index_opts_parse_hint),
+	OPT_DEF_CUSTOM("hash_bits", index_opts_parse_hash_bits),
 	OPT_DEF_CUSTOM("covers", index_opts_parse_covered_fields),
 	OPT_DEF_CUSTOM("layout", index_opts_parse_layout),
 	OPT_END,
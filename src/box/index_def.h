@@ -109,6 +109,10 @@ struct index_opts {
 	 * Use hint optimization for tree index.
 	 */
 	enum index_hint_cfg hint;
+	/**
+	 * Width of hash values stored in memtx hash index: 32 or 64.
+	 */
+	uint32_t hash_bits;
 	/**
 	 * Engine dependent. For engines supporting covering indexes means
 	 * explicitly covered fields. That is fields other then fields of
@@ -173,6 +177,8 @@ index_opts_is_equal(const struct index_opts *o1, const struct index_opts *o2)
 		return false;
 	if (o1->hint != o2->hint)
 		return false;
+	if (o1->hash_bits != o2->hash_bits)
+		return false;
 	if (o1->covered_field_count != o2->covered_field_count)
 		return false;
 	for (uint32_t i = 0; i < o1->covered_field_count; i++) {
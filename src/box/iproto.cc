@@ -65,6 +65,7 @@
 #include "replication.h" /* instance_uuid */
 #include "iproto_constants.h"
 #include "iproto_features.h"
+#include "iproto_read_view.h"
 #include "rmean.h"
 #include "execute.h"
 #include "errinj.h"
@@ -134,6 +135,29 @@ iproto_wpos_create(struct iproto_wpos *wpos, struct obuf *out)
 	wpos->svp = obuf_create_svp(out);
 }
 
+/**
+ * Session state needed to serve requests in the iproto thread from
+ * the read view (see iproto_read_view.h). Sampled in the tx thread
+ * when a request is complete and carried back to the iproto thread
+ * with the reply.
+ */
+struct iproto_session_snapshot {
+	/** Auth token of the session user, BOX_USER_MAX if unknown. */
+	uint8_t auth_token;
+	/** Id of the session user. */
+	uint32_t uid;
+	/** Set if IPROTO_FEATURE_DML_TUPLE_EXTENSION is enabled. */
+	bool tuple_as_ext;
+};
+
+static inline void
+iproto_session_snapshot_create_unknown(struct iproto_session_snapshot *snap)
+{
+	snap->auth_token = BOX_USER_MAX;
+	snap->uid = BOX_USER_MAX;
+	snap->tuple_as_ext = false;
+}
+
 /**
  * Message sent when iproto thread dropped all connections that requested
  * to be dropped.
@@ -612,6 +636,11 @@ struct iproto_msg
 	struct rlist in_inprogress;
 	/** TX thread fiber that processing this message. */
 	struct fiber *fiber;
+	/**
+	 * Session state at the time when the request was complete.
+	 * Set by the tx thread, see iproto_connection::session_snapshot.
+	 */
+	struct iproto_session_snapshot session_snapshot;
 };
 
 /**
@@ -628,6 +657,10 @@ static void
 iproto_msg_prepare(struct iproto_msg *msg, const char **pos,
 		   const char *reqend);
 
+/** Account msg data in connection input buffer as processed. */
+static void
+iproto_msg_finish_input(iproto_msg *msg);
+
 enum rmean_net_name {
 	IPROTO_SENT,
 	IPROTO_RECEIVED,
@@ -635,6 +668,7 @@ enum rmean_net_name {
 	IPROTO_REQUESTS,
 	IPROTO_STREAMS,
 	REQUESTS_IN_STREAM_QUEUE,
+	READ_VIEW_REQUESTS,
 	RMEAN_NET_LAST,
 };
 
@@ -645,6 +679,7 @@ const char *rmean_net_strings[RMEAN_NET_LAST] = {
 	"REQUESTS",
 	"STREAMS",
 	"REQUESTS_IN_STREAM_QUEUE",
+	"READ_VIEW_REQUESTS",
 };
 
 enum rmean_tx_name {
@@ -922,6 +957,26 @@ struct iproto_connection
 	bool is_established;
 	/** Number of iproto requests in flight. */
 	size_t request_count;
+	/**
+	 * Output buffer for replies to requests served in the iproto
+	 * thread from the read view. Unlike obuf[2], it is allocated
+	 * and written by the iproto thread.
+	 */
+	struct obuf net_obuf;
+	/** Position in net_obuf up to which the output was flushed. */
+	struct obuf_svp net_wpos;
+	/** Session state as of the last reply received from tx. */
+	struct iproto_session_snapshot session_snapshot;
+	/**
+	 * Read views with a lower id may miss the writes done by this
+	 * connection, see iproto_read_view_last_id().
+	 */
+	uint64_t min_read_view_id;
+	/**
+	 * Number of AUTH and ID requests in flight. Requests aren't
+	 * served from the read view while the session may change.
+	 */
+	int session_update_count;
 };
 
 /** Returns a string suitable for logging. */
@@ -1012,6 +1067,7 @@ iproto_msg_new(struct iproto_connection *con)
 	msg->connection = con;
 	msg->stream = NULL;
 	msg->fiber = NULL;
+	iproto_session_snapshot_create_unknown(&msg->session_snapshot);
 	rmean_collect(con->iproto_thread->rmean, IPROTO_REQUESTS, 1);
 	con->request_count++;
 	return msg;
@@ -1297,6 +1353,92 @@ iproto_is_flushed(struct iproto_connection *con)
 		   con->wpos.svp.used == con->wend.svp.used;
 }
 
+/** Returns true if a request of the given type can't change data. */
+static inline bool
+iproto_type_is_read_only(uint32_t type)
+{
+	switch (type) {
+	case IPROTO_SELECT:
+	case IPROTO_PING:
+	case IPROTO_ID:
+	case IPROTO_WATCH:
+	case IPROTO_UNWATCH:
+	case IPROTO_WATCH_ONCE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/** Returns true if all replies written by the iproto thread are flushed. */
+static inline bool
+iproto_net_output_is_flushed(struct iproto_connection *con)
+{
+	return con->net_wpos.used == obuf_size(&con->net_obuf);
+}
+
+/**
+ * Try to serve a request in the iproto thread from the read view
+ * (see iproto_read_view.h). Only SELECT requests by a full primary
+ * key that aren't overridden and don't belong to a stream are
+ * considered. Returns true if the reply was written to net_obuf.
+ *
+ * To let the connection read its own writes, the read view isn't
+ * used while the connection has requests in tx, which may write,
+ * or if the read view was opened before its last request to tx was
+ * complete. Besides, the output written by tx must be flushed so
+ * that all replies in net_obuf precede those in obuf[2], see
+ * iproto_flush().
+ */
+static bool
+iproto_msg_process_in_net_thread(struct iproto_msg *msg)
+{
+	struct iproto_connection *con = msg->connection;
+	struct iproto_thread *iproto_thread = con->iproto_thread;
+	struct iproto_session_snapshot *session = &con->session_snapshot;
+	struct request *req = &msg->dml;
+	if (msg->base.route != iproto_thread->dml_route[IPROTO_SELECT] ||
+	    msg->header.stream_id != 0 || !con->is_established ||
+	    con->session_update_count != 0 ||
+	    session->auth_token >= BOX_USER_MAX || session->tuple_as_ext)
+		return false;
+	/* The only request in progress is this one. */
+	if (con->request_count > 1 || !iproto_is_flushed(con))
+		return false;
+	if (req->space_name != NULL || req->index_name != NULL ||
+	    req->index_id != 0 || req->iterator != ITER_EQ ||
+	    req->offset != 0 || req->limit == 0 || req->key == NULL ||
+	    req->after_position != NULL || req->after_tuple != NULL ||
+	    req->fetch_position)
+		return false;
+	/* Don't let replies pile up if the client doesn't read them. */
+	if (obuf_size(&con->net_obuf) - con->net_wpos.used >=
+	    iproto_max_input_size())
+		return false;
+	struct iproto_read_view *view =
+		iproto_read_view_enter(iproto_thread->id);
+	struct read_view_tuple tuple;
+	bool is_served = view != NULL &&
+		iproto_read_view_id(view) >= con->min_read_view_id &&
+		iproto_read_view_get(view, req->space_id,
+				     msg->header.schema_version,
+				     session->auth_token, session->uid,
+				     req->key, &tuple);
+	if (is_served) {
+		struct obuf *out = &con->net_obuf;
+		struct obuf_svp svp;
+		iproto_prepare_select(out, &svp);
+		if (tuple.data != NULL)
+			xobuf_dup(out, tuple.data, tuple.size);
+		/* Dirty read, see iproto_write_error(). */
+		iproto_reply_select(out, &svp, msg->header.sync,
+				    ::schema_version, tuple.data != NULL ? 1 : 0,
+				    false);
+	}
+	iproto_read_view_leave(iproto_thread->id);
+	return is_served;
+}
+
 /**
  * Check if message belongs to stream (stream_id != 0), and if it
  * is so create new stream or get stream from connection streams
@@ -1391,15 +1533,33 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 		con->input_msg_count[msg->p_ibuf == &con->ibuf[1]]++;
 
 		iproto_msg_prepare(msg, &pos, reqend);
-		if (iproto_msg_start_processing_in_stream(msg)) {
-			cpipe_push(&con->iproto_thread->tx_pipe, &msg->base);
-			n_requests++;
-		}
 
 		/* Request is parsed */
 		assert(reqend > reqstart);
 		assert(con->parse_size >= (size_t) (reqend - reqstart));
 		con->parse_size -= reqend - reqstart;
+
+		if (iproto_msg_process_in_net_thread(msg)) {
+			rmean_collect(con->iproto_thread->rmean,
+				      READ_VIEW_REQUESTS, 1);
+			iproto_msg_finish_input(msg);
+			/*
+			 * Don't resume other connections from here, the
+			 * message was allocated only for parsing.
+			 */
+			con->request_count--;
+			mempool_free(&con->iproto_thread->iproto_msg_pool, msg);
+			iproto_connection_feed_output(con);
+			n_requests++;
+			continue;
+		}
+		if (msg->header.type == IPROTO_AUTH ||
+		    msg->header.type == IPROTO_ID)
+			con->session_update_count++;
+		if (iproto_msg_start_processing_in_stream(msg)) {
+			cpipe_push(&con->iproto_thread->tx_pipe, &msg->base);
+			n_requests++;
+		}
 	}
 	if (con->is_in_replication) {
 		/**
@@ -1547,26 +1707,14 @@ error:;
 	iproto_connection_close(con);
 }
 
-/** writev() to the socket and handle the result. */
+/**
+ * writev() the given range of an output buffer to the socket and
+ * handle the result. Advances @a begin.
+ */
 static int
-iproto_flush(struct iproto_connection *con)
+iproto_flush_range(struct iproto_connection *con, struct obuf *obuf,
+		   struct obuf_svp *begin, struct obuf_svp *end)
 {
-	struct obuf *obuf = con->wpos.obuf;
-	struct obuf_svp obuf_end = obuf_create_svp(obuf);
-	struct obuf_svp *begin = &con->wpos.svp;
-	struct obuf_svp *end = &con->wend.svp;
-	if (con->wend.obuf != obuf) {
-		/*
-		 * Flush the current buffer before
-		 * advancing to the next one.
-		 */
-		if (begin->used == obuf_end.used) {
-			obuf = con->wpos.obuf = con->wend.obuf;
-			obuf_svp_reset(begin);
-		} else {
-			end = &obuf_end;
-		}
-	}
 	if (begin->used == end->used) {
 		/* Nothing to do. */
 		return 1;
@@ -1625,6 +1773,58 @@ iproto_flush(struct iproto_connection *con)
 	return nwr;
 }
 
+/** Flush the output written by the tx thread. */
+static int
+iproto_flush_tx(struct iproto_connection *con)
+{
+	struct obuf *obuf = con->wpos.obuf;
+	struct obuf_svp obuf_end = obuf_create_svp(obuf);
+	struct obuf_svp *begin = &con->wpos.svp;
+	struct obuf_svp *end = &con->wend.svp;
+	if (con->wend.obuf != obuf) {
+		/*
+		 * Flush the current buffer before
+		 * advancing to the next one.
+		 */
+		if (begin->used == obuf_end.used) {
+			obuf = con->wpos.obuf = con->wend.obuf;
+			obuf_svp_reset(begin);
+		} else {
+			end = &obuf_end;
+		}
+	}
+	return iproto_flush_range(con, obuf, begin, end);
+}
+
+/** Flush the output written by the iproto thread. */
+static int
+iproto_flush_net(struct iproto_connection *con)
+{
+	struct obuf *obuf = &con->net_obuf;
+	struct obuf_svp end = obuf_create_svp(obuf);
+	int rc = iproto_flush_range(con, obuf, &con->net_wpos, &end);
+	if (rc == 0) {
+		/* Everything is flushed, recycle the buffer. */
+		obuf_reset(obuf);
+		obuf_svp_reset(&con->net_wpos);
+	}
+	return rc;
+}
+
+/**
+ * Flush the connection output. Replies are taken from both the buffers
+ * written by the tx thread and the buffer written by the iproto thread.
+ * A reply is written to net_obuf only if the output written by tx is
+ * flushed, so net_obuf replies always precede those in obuf[2].
+ */
+static int
+iproto_flush(struct iproto_connection *con)
+{
+	if (!iproto_net_output_is_flushed(con))
+		return iproto_flush_net(con);
+	return iproto_flush_tx(con);
+}
+
 static void
 iproto_connection_on_output(ev_loop *loop, struct ev_io *watcher,
 			    int /* revents */)
@@ -1697,6 +1897,11 @@ iproto_connection_new(struct iproto_thread *iproto_thread)
 	con->tx.is_push_sent = false;
 	rmean_collect(iproto_thread->rmean, IPROTO_CONNECTIONS, 1);
 	con->request_count = 0;
+	obuf_create(&con->net_obuf, cord_slab_cache(), iproto_readahead);
+	con->net_wpos = obuf_create_svp(&con->net_obuf);
+	iproto_session_snapshot_create_unknown(&con->session_snapshot);
+	con->min_read_view_id = 0;
+	con->session_update_count = 0;
 	return con;
 }
 
@@ -1741,6 +1946,7 @@ iproto_connection_delete(struct iproto_connection *con)
 	ibuf_destroy(&con->ibuf[1]);
 	assert(!obuf_is_initialized(&con->obuf[0]));
 	assert(!obuf_is_initialized(&con->obuf[1]));
+	obuf_destroy(&con->net_obuf);
 
 	assert(mh_size(con->streams) == 0);
 	mh_i64ptr_delete(con->streams);
@@ -1853,7 +2059,8 @@ iproto_msg_prepare(struct iproto_msg *msg, const char **pos, const char *reqend)
 		 * Before processing a replication request, ensure that all
 		 * writing requests have been completely flushed to obuf.
 		 */
-		if (con->request_count > 1 || !iproto_is_flushed(con)) {
+		if (con->request_count > 1 || !iproto_is_flushed(con) ||
+		    !iproto_net_output_is_flushed(con)) {
 			diag_set(ClientError, ER_PROTOCOL, "Can't process "
 				 "join/subscribe while there are pending requests");
 			goto error;
@@ -2277,9 +2484,22 @@ tx_check_msg(struct iproto_msg *msg)
 	return 0;
 }
 
+/** Sample the session state needed to serve requests in iproto threads. */
+static inline void
+tx_session_snapshot(struct session *session,
+		    struct iproto_session_snapshot *snap)
+{
+	snap->auth_token = session->credentials.auth_token;
+	snap->uid = session->credentials.uid;
+	snap->tuple_as_ext =
+		iproto_features_test(&session->meta.features,
+				     IPROTO_FEATURE_DML_TUPLE_EXTENSION);
+}
+
 static inline void
 tx_end_msg(struct iproto_msg *msg, struct obuf_svp *svp)
 {
+	tx_session_snapshot(msg->connection->session, &msg->session_snapshot);
 	if (msg->stream != NULL) {
 		assert(msg->stream->txn == NULL);
 		msg->stream->txn = txn_detach();
@@ -3258,6 +3478,17 @@ net_send_msg(struct cmsg *m)
 		con->long_poll_count--;
 	}
 	con->wend = msg->wpos;
+	con->session_snapshot = msg->session_snapshot;
+	/*
+	 * The request may have written something, which is visible
+	 * only in read views opened after it is complete.
+	 */
+	if (!iproto_type_is_read_only(msg->header.type))
+		con->min_read_view_id = iproto_read_view_last_id() + 1;
+	if (msg->header.type == IPROTO_AUTH || msg->header.type == IPROTO_ID) {
+		assert(con->session_update_count > 0);
+		con->session_update_count--;
+	}
 
 	if (con->state == IPROTO_CONNECTION_ALIVE) {
 		iproto_connection_feed_output(con);
@@ -3350,6 +3581,7 @@ tx_process_connect(struct cmsg *m)
 	xobuf_dup(out, greeting, IPROTO_GREETING_SIZE);
 	if (session_run_on_connect_triggers(con->session) != 0)
 		goto error;
+	tx_session_snapshot(con->session, &msg->session_snapshot);
 	iproto_wpos_create(&msg->wpos, out);
 	return;
 error:
@@ -3389,6 +3621,7 @@ net_send_greeting(struct cmsg *m)
 	}
 	con->is_established = true;
 	con->wend = msg->wpos;
+	con->session_snapshot = msg->session_snapshot;
 	/*
 	 * Connect is synchronous, so no one could have been
 	 * messing up with the connection while it was in
@@ -3909,6 +4142,7 @@ iproto_init(int threads_count)
 	 */
 	tx_req_handlers = mh_i32ptr_new();
 	event_foreach(iproto_override_event_init, NULL);
+	iproto_read_view_init(threads_count);
 
 	for (int i = 0; i < threads_count; i++) {
 		struct iproto_thread *iproto_thread = &iproto_threads[i];
@@ -4341,6 +4575,8 @@ iproto_shutdown(double timeout)
 		if (cord_join(&iproto_threads[i].net_cord) != 0)
 			panic_syserror("iproto cord join failed");
 	}
+	/* There are no readers left so the read views can be freed. */
+	iproto_read_view_shutdown();
 	return 0;
 }
 
@@ -124,3 +124,10 @@ const char *vy_page_info_key_strs[vy_page_info_key_MAX] = {
 const char *vy_row_index_key_strs[vy_row_index_key_MAX] = {
 	VY_ROW_INDEX_KEYS(VY_ROW_INDEX_KEY_STRS_MEMBER)
 };
+
+#define VY_COLUMN_KEY_STRS_MEMBER(s, ...) \
+	[VY_COLUMN_ ## s] = #s,
+
+const char *vy_column_key_strs[vy_column_key_MAX] = {
+	VY_COLUMN_KEYS(VY_COLUMN_KEY_STRS_MEMBER)
+};
@@ -412,11 +412,12 @@ iproto_key_bit(unsigned char key)
 	_(WATCH_ONCE, 77)						\
 									\
 	/**
-	 * The following three requests are reserved for vinyl types.
+	 * The following four requests are reserved for vinyl types.
 	 *
 	 * VY_INDEX_RUN_INFO = 100
 	 * VY_INDEX_PAGE_INFO = 101
 	 * VY_RUN_ROW_INDEX = 102
+	 * VY_RUN_COLUMN = 103
 	 */								\
 									\
 	/** Non-final response type. */					\
@@ -443,6 +444,8 @@ enum iproto_type {
 	VY_INDEX_PAGE_INFO = 101,
 	/** Vinyl row index stored in .run file */
 	VY_RUN_ROW_INDEX = 102,
+	/** Vinyl columnar page chunk stored in .run file */
+	VY_RUN_COLUMN = 103,
 };
 
 /** IPROTO type name by code */
@@ -486,6 +489,8 @@ iproto_type_name(uint16_t type)
 		return "PAGEINFO";
 	case VY_RUN_ROW_INDEX:
 		return "ROWINDEX";
+	case VY_RUN_COLUMN:
+		return "COLUMN";
 	default:
 		return NULL;
 	}
@@ -617,8 +622,10 @@ request_replace_body_create(struct request_replace_body *body,
 	_(BLOOM_FILTER_LEGACY_V2, 7)					\
 	/** Number of statements of each type (map). */			\
 	_(STMT_STAT, 8)							\
-	/** Bloom filter for keys. */					\
-	_(BLOOM_FILTER, 9)						\
+	/** Legacy bloom filter implementation. */			\
+	_(BLOOM_FILTER_LEGACY_V3, 9)					\
+	/** Ribbon filter for keys. */					\
+	_(BLOOM_FILTER, 10)						\
 
 #define VY_RUN_INFO_KEY_MEMBER(s, v) VY_RUN_INFO_ ## s = v,
 
@@ -657,6 +664,8 @@ vy_run_info_key_name(enum vy_run_info_key key)
 	_(MIN_KEY, 5)							\
 	/** Offset of the row index in the page. */			\
 	_(ROW_INDEX_OFFSET, 6)						\
+	/** Chunks of a columnar page (array). */			\
+	_(CHUNKS, 7)							\
 
 #define VY_PAGE_INFO_KEY_MEMBER(s, v) VY_PAGE_INFO_ ## s = v,
 
@@ -706,6 +715,38 @@ vy_row_index_key_name(enum vy_row_index_key key)
 	return vy_row_index_key_strs[key];
 }
 
+/**
+ * Xrow keys for Vinyl columnar page chunks.
+ * @sa struct vy_page_chunk.
+ */
+#define VY_COLUMN_KEYS(_)						\
+	/** Array of statement headers or field values. */		\
+	_(DATA, 1)							\
+	/** Number of field chunks following the header chunk. */	\
+	_(FIELD_COUNT, 2)						\
+	/** Number of the field stored in the chunk. */			\
+	_(FIELD_NO, 3)							\
+
+#define VY_COLUMN_KEY_MEMBER(s, v) VY_COLUMN_ ## s = v,
+
+enum vy_column_key {
+	VY_COLUMN_KEYS(VY_COLUMN_KEY_MEMBER)
+	vy_column_key_MAX
+};
+
+/**
+ * Return vy_column key name by @a key code.
+ * @param key key
+ */
+static inline const char *
+vy_column_key_name(enum vy_column_key key)
+{
+	if (key <= 0 || key >= vy_column_key_MAX)
+		return NULL;
+	extern const char *vy_column_key_strs[];
+	return vy_column_key_strs[key];
+}
+
 /** Initialize the "IPROTO constants" subsystem. */
 static inline void
 iproto_constants_init(void)
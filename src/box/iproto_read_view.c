@@ -0,0 +1,453 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2025, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "iproto_read_view.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "assoc.h"
+#include "box.h"
+#include "diag.h"
+#include "fiber.h"
+#include "index.h"
+#include "msgpuck.h"
+#include "read_view.h"
+#include "schema.h"
+#include "small/rlist.h"
+#include "space.h"
+#include "trivia/util.h"
+#include "tuple_format.h"
+#include "user.h"
+
+static_assert(BOX_USER_MAX <= 64, "auth tokens must fit in uint64_t");
+
+enum {
+	/**
+	 * How often the tx thread checks if retired read views can be
+	 * freed, in milliseconds.
+	 */
+	IPROTO_READ_VIEW_GC_INTERVAL_MS = 10,
+};
+
+/** A space included into an iproto read view. */
+struct iproto_read_view_space {
+	/** Primary index read view. Owned by iproto_read_view::rv. */
+	struct index_read_view *pk;
+	/** Bit i is set if the user with auth token i may read the space. */
+	uint64_t read_access;
+};
+
+struct iproto_read_view {
+	/** Unique id, greater than the ids of read views opened before. */
+	uint64_t id;
+	/** Database read view. */
+	struct read_view rv;
+	/** Space id -> struct iproto_read_view_space. */
+	struct mh_i32ptr_t *spaces;
+	/**
+	 * Id of the user that owned each auth token at the time when
+	 * the read view was opened, BOX_ID_NIL for unused tokens.
+	 */
+	uint32_t token_uid[BOX_USER_MAX];
+	/** Schema version at the time when the read view was opened. */
+	uint64_t schema_version;
+	/**
+	 * The epoch started when the read view was retired. It may be
+	 * freed once no reader is in an older epoch.
+	 */
+	uint64_t retire_epoch;
+	/** Link in iproto_read_view_state::retired. */
+	struct rlist in_retired;
+};
+
+/** Per-thread reader slot. */
+struct iproto_read_view_reader {
+	/**
+	 * Epoch at which the reader entered the critical section or 0
+	 * if the reader is outside of it.
+	 */
+	alignas(CACHELINE_SIZE) uint64_t epoch;
+};
+
+static struct iproto_read_view_state {
+	/** Read view currently used by readers or NULL. */
+	struct iproto_read_view *current;
+	/** Global epoch, incremented each time a read view is retired. */
+	uint64_t epoch;
+	/** Id of the last opened read view. */
+	uint64_t last_id;
+	/** Reader slots, one per iproto thread. */
+	struct iproto_read_view_reader *readers;
+	/** Number of entries in the readers array. */
+	int reader_count;
+	/** Read views waiting for readers to leave, oldest first. */
+	struct rlist retired;
+	/** Fiber that refreshes the read view and frees retired ones. */
+	struct fiber *fiber;
+	/** Refresh period, in seconds. Zero if disabled. */
+	double period;
+	/** Set if the current read view must be reopened. */
+	bool is_stale;
+} iproto_read_view_state;
+
+/** Argument of the read view space filter. */
+struct iproto_read_view_filter_arg {
+	/** Read view being opened. */
+	struct iproto_read_view *view;
+	/** Credentials of all users, indexed by auth token. */
+	struct credentials *credentials;
+	/** Bit i is set if credentials[i] is valid. */
+	uint64_t token_mask;
+};
+
+static bool
+iproto_read_view_filter_space(struct space *space, void *arg_raw)
+{
+	struct iproto_read_view_filter_arg *arg = arg_raw;
+	struct index *pk = space_index(space, 0);
+	if (!space_is_memtx(space) || pk == NULL || pk->def->type != HASH ||
+	    space->upgrade != NULL || space->format->is_compressed)
+		return false;
+	uint64_t read_access = 0;
+	for (int token = 0; token < BOX_USER_MAX; token++) {
+		if ((arg->token_mask & (1ULL << token)) != 0 &&
+		    space_has_access(space, &arg->credentials[token], PRIV_R))
+			read_access |= 1ULL << token;
+	}
+	if (read_access == 0)
+		return false;
+	struct iproto_read_view_space *view_space = xmalloc(
+		sizeof(*view_space));
+	view_space->pk = NULL;
+	view_space->read_access = read_access;
+	struct mh_i32ptr_node_t node = { space_id(space), view_space };
+	mh_i32ptr_put(arg->view->spaces, &node, NULL, NULL);
+	return true;
+}
+
+static bool
+iproto_read_view_filter_index(struct space *space, struct index *index,
+			      void *arg)
+{
+	(void)space;
+	(void)arg;
+	return index->def->iid == 0;
+}
+
+static void
+iproto_read_view_delete(struct iproto_read_view *view)
+{
+	read_view_close(&view->rv);
+	mh_int_t i;
+	mh_foreach(view->spaces, i)
+		free(mh_i32ptr_node(view->spaces, i)->val);
+	mh_i32ptr_delete(view->spaces);
+	TRASH(view);
+	free(view);
+}
+
+/** Open a new read view. Returns NULL and sets diag on failure. */
+static struct iproto_read_view *
+iproto_read_view_new(void)
+{
+	struct iproto_read_view *view = xmalloc(sizeof(*view));
+	/*
+	 * The id is assigned before the read view is opened so that
+	 * a connection that saw it after a write is complete never
+	 * uses this read view, which may not contain the write.
+	 */
+	struct iproto_read_view_state *state = &iproto_read_view_state;
+	view->id = state->last_id + 1;
+	__atomic_store_n(&state->last_id, view->id, __ATOMIC_SEQ_CST);
+	view->spaces = mh_i32ptr_new();
+	view->schema_version = schema_version;
+	view->retire_epoch = 0;
+	rlist_create(&view->in_retired);
+
+	struct credentials credentials[BOX_USER_MAX];
+	struct iproto_read_view_filter_arg arg = {
+		.view = view,
+		.credentials = credentials,
+		.token_mask = 0,
+	};
+	for (int token = 0; token < BOX_USER_MAX; token++) {
+		struct user *user = user_find_by_token(token);
+		if (user->def == NULL) {
+			view->token_uid[token] = BOX_ID_NIL;
+			continue;
+		}
+		view->token_uid[token] = user->def->uid;
+		credentials_create(&credentials[token], user);
+		arg.token_mask |= 1ULL << token;
+	}
+	struct read_view_opts opts;
+	read_view_opts_create(&opts);
+	opts.name = "iproto";
+	opts.is_system = true;
+	opts.filter_space = iproto_read_view_filter_space;
+	opts.filter_index = iproto_read_view_filter_index;
+	opts.filter_arg = &arg;
+	opts.enable_data_temporary_spaces = true;
+	opts.disable_decompression = true;
+	int rc = read_view_open(&view->rv, &opts);
+	for (int token = 0; token < BOX_USER_MAX; token++) {
+		if ((arg.token_mask & (1ULL << token)) != 0)
+			credentials_destroy(&credentials[token]);
+	}
+	if (rc != 0) {
+		mh_int_t i;
+		mh_foreach(view->spaces, i)
+			free(mh_i32ptr_node(view->spaces, i)->val);
+		mh_i32ptr_delete(view->spaces);
+		free(view);
+		return NULL;
+	}
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &view->rv) {
+		mh_int_t i = mh_i32ptr_find(view->spaces, space_rv->id, NULL);
+		assert(i != mh_end(view->spaces));
+		struct iproto_read_view_space *view_space =
+			mh_i32ptr_node(view->spaces, i)->val;
+		view_space->pk = space_read_view_index(space_rv, 0);
+		assert(view_space->pk != NULL);
+	}
+	return view;
+}
+
+/**
+ * Replace the current read view with the given one (may be NULL) and
+ * retire the old one.
+ */
+static void
+iproto_read_view_publish(struct iproto_read_view *view)
+{
+	struct iproto_read_view_state *state = &iproto_read_view_state;
+	struct iproto_read_view *old = __atomic_exchange_n(
+		&state->current, view, __ATOMIC_SEQ_CST);
+	if (old == NULL)
+		return;
+	/*
+	 * Readers that entered before the epoch is advanced could have
+	 * seen the old read view. Readers that enter after will see the
+	 * new one, because the exchange above precedes the increment.
+	 */
+	old->retire_epoch = __atomic_add_fetch(&state->epoch, 1,
+					       __ATOMIC_SEQ_CST);
+	rlist_add_tail_entry(&state->retired, old, in_retired);
+}
+
+/** Returns the oldest epoch some reader is in, or UINT64_MAX. */
+static uint64_t
+iproto_read_view_min_reader_epoch(void)
+{
+	struct iproto_read_view_state *state = &iproto_read_view_state;
+	uint64_t min_epoch = UINT64_MAX;
+	for (int i = 0; i < state->reader_count; i++) {
+		uint64_t epoch = __atomic_load_n(&state->readers[i].epoch,
+						 __ATOMIC_SEQ_CST);
+		if (epoch != 0)
+			min_epoch = MIN(min_epoch, epoch);
+	}
+	return min_epoch;
+}
+
+/** Free retired read views that can't be accessed by readers anymore. */
+static void
+iproto_read_view_gc(void)
+{
+	struct iproto_read_view_state *state = &iproto_read_view_state;
+	if (rlist_empty(&state->retired))
+		return;
+	uint64_t min_epoch = iproto_read_view_min_reader_epoch();
+	struct iproto_read_view *view, *tmp;
+	rlist_foreach_entry_safe(view, &state->retired, in_retired, tmp) {
+		if (view->retire_epoch > min_epoch)
+			break;
+		rlist_del_entry(view, in_retired);
+		iproto_read_view_delete(view);
+	}
+}
+
+/** Reopen the read view if it's time to. */
+static void
+iproto_read_view_refresh(void)
+{
+	struct iproto_read_view_state *state = &iproto_read_view_state;
+	if (state->period == 0 || !box_is_configured() ||
+	    !rlist_empty(&box_on_select)) {
+		/*
+		 * The read view is disabled or there are on_select
+		 * triggers that must be run for each request in tx.
+		 */
+		iproto_read_view_publish(NULL);
+		return;
+	}
+	struct iproto_read_view *view = iproto_read_view_new();
+	if (view == NULL) {
+		diag_log();
+		iproto_read_view_publish(NULL);
+		return;
+	}
+	iproto_read_view_publish(view);
+}
+
+static int
+iproto_read_view_fiber_f(va_list ap)
+{
+	(void)ap;
+	struct iproto_read_view_state *state = &iproto_read_view_state;
+	double deadline = 0;
+	while (!fiber_is_cancelled()) {
+		double now = ev_monotonic_now(loop());
+		if (state->is_stale || now >= deadline) {
+			state->is_stale = false;
+			iproto_read_view_refresh();
+			deadline = state->period > 0 ? now + state->period :
+				   TIMEOUT_INFINITY;
+		}
+		iproto_read_view_gc();
+		double timeout = deadline - now;
+		if (!rlist_empty(&state->retired)) {
+			timeout = MIN(timeout,
+				      IPROTO_READ_VIEW_GC_INTERVAL_MS / 1000.0);
+		}
+		fiber_yield_timeout(timeout);
+	}
+	return 0;
+}
+
+void
+iproto_read_view_init(int reader_count)
+{
+	struct iproto_read_view_state *state = &iproto_read_view_state;
+	state->current = NULL;
+	state->epoch = 1;
+	state->last_id = 0;
+	state->readers = xalloc_array(struct iproto_read_view_reader,
+				      reader_count);
+	for (int i = 0; i < reader_count; i++)
+		state->readers[i].epoch = 0;
+	state->reader_count = reader_count;
+	rlist_create(&state->retired);
+	state->period = 0;
+	state->is_stale = false;
+	state->fiber = fiber_new_system("iproto_read_view",
+					iproto_read_view_fiber_f);
+	if (state->fiber == NULL)
+		panic("failed to start iproto read view fiber");
+	fiber_set_joinable(state->fiber, true);
+	fiber_start(state->fiber);
+}
+
+void
+iproto_read_view_shutdown(void)
+{
+	struct iproto_read_view_state *state = &iproto_read_view_state;
+	if (state->fiber == NULL)
+		return;
+	fiber_cancel(state->fiber);
+	fiber_join(state->fiber);
+	state->fiber = NULL;
+	iproto_read_view_publish(NULL);
+	/* All readers are stopped so retired read views can be freed. */
+	struct iproto_read_view *view, *tmp;
+	rlist_foreach_entry_safe(view, &state->retired, in_retired, tmp)
+		iproto_read_view_delete(view);
+	rlist_create(&state->retired);
+	free(state->readers);
+	state->readers = NULL;
+	state->reader_count = 0;
+}
+
+void
+iproto_read_view_set_period(double period)
+{
+	struct iproto_read_view_state *state = &iproto_read_view_state;
+	state->period = period;
+	state->is_stale = true;
+	if (state->fiber != NULL)
+		fiber_wakeup(state->fiber);
+}
+
+void
+iproto_read_view_invalidate(void)
+{
+	struct iproto_read_view_state *state = &iproto_read_view_state;
+	if (state->current == NULL)
+		return;
+	iproto_read_view_publish(NULL);
+	state->is_stale = true;
+	if (state->fiber != NULL)
+		fiber_wakeup(state->fiber);
+}
+
+struct iproto_read_view *
+iproto_read_view_enter(int reader_id)
+{
+	struct iproto_read_view_state *state = &iproto_read_view_state;
+	assert(reader_id >= 0 && reader_id < state->reader_count);
+	uint64_t epoch = __atomic_load_n(&state->epoch, __ATOMIC_SEQ_CST);
+	__atomic_store_n(&state->readers[reader_id].epoch, epoch,
+			 __ATOMIC_SEQ_CST);
+	return __atomic_load_n(&state->current, __ATOMIC_SEQ_CST);
+}
+
+void
+iproto_read_view_leave(int reader_id)
+{
+	struct iproto_read_view_state *state = &iproto_read_view_state;
+	assert(reader_id >= 0 && reader_id < state->reader_count);
+	__atomic_store_n(&state->readers[reader_id].epoch, 0,
+			 __ATOMIC_RELEASE);
+}
+
+uint64_t
+iproto_read_view_last_id(void)
+{
+	return __atomic_load_n(&iproto_read_view_state.last_id,
+			       __ATOMIC_SEQ_CST);
+}
+
+uint64_t
+iproto_read_view_id(const struct iproto_read_view *view)
+{
+	return view->id;
+}
+
+bool
+iproto_read_view_get(struct iproto_read_view *view, uint32_t space_id,
+		     uint64_t request_schema_version, uint8_t auth_token,
+		     uint32_t uid, const char *key,
+		     struct read_view_tuple *result)
+{
+	/* Dirty read of the schema version, see iproto_write_error(). */
+	if (view->schema_version != schema_version ||
+	    (request_schema_version != 0 &&
+	     request_schema_version != view->schema_version))
+		return false;
+	if (auth_token >= BOX_USER_MAX || view->token_uid[auth_token] != uid)
+		return false;
+	mh_int_t i = mh_i32ptr_find(view->spaces, space_id, NULL);
+	if (i == mh_end(view->spaces))
+		return false;
+	struct iproto_read_view_space *view_space =
+		mh_i32ptr_node(view->spaces, i)->val;
+	if ((view_space->read_access & (1ULL << auth_token)) == 0)
+		return false;
+	struct index_read_view *pk = view_space->pk;
+	uint32_t part_count = mp_decode_array(&key);
+	if (exact_key_validate(pk->def, key, part_count) != 0) {
+		/* Let tx report the error. */
+		diag_clear(diag_get());
+		return false;
+	}
+	if (index_read_view_get_raw(pk, key, part_count, result) != 0) {
+		diag_clear(diag_get());
+		return false;
+	}
+	return true;
+}
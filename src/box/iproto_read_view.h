@@ -0,0 +1,110 @@
+#pragma once
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2025, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct read_view_tuple;
+
+/**
+ * A database read view published by the tx thread to iproto threads
+ * so that they can serve simple primary key lookups without a round
+ * trip to tx.
+ *
+ * Only memtx spaces with a HASH primary index are included. The read
+ * view is reopened every iproto_read_view_period seconds, which
+ * bounds the staleness of the data returned from it. Access rights
+ * are evaluated in tx when the read view is opened. The read view is
+ * dropped as soon as privileges change and isn't used if the schema
+ * version changed after it was opened.
+ *
+ * Since the read view may be older than the data, a connection must
+ * not use it after writing something until a newer read view is
+ * opened, otherwise it wouldn't read its own writes. To check that,
+ * read views are numbered in the order they are opened.
+ *
+ * Read views are freed in the tx thread using epoch-based reclamation:
+ * a reader announces the epoch it entered at in its own slot so that
+ * a replaced read view is closed only after all readers that could
+ * have seen it have left.
+ */
+struct iproto_read_view;
+
+/**
+ * Initialize the subsystem for the given number of reader threads.
+ * Must be called in tx.
+ */
+void
+iproto_read_view_init(int reader_count);
+
+/**
+ * Stop refreshing the read view and free all read views. Must be
+ * called in tx after all reader threads have been stopped.
+ */
+void
+iproto_read_view_shutdown(void);
+
+/**
+ * Set the period at which the read view is reopened. Zero disables
+ * the read view. Must be called in tx.
+ */
+void
+iproto_read_view_set_period(double period);
+
+/**
+ * Drop the current read view until the next refresh. Called in tx
+ * when privileges change.
+ */
+void
+iproto_read_view_invalidate(void);
+
+/**
+ * Enter a read-side critical section in the reader thread with the
+ * given id. Returns the current read view or NULL if there's none.
+ * The returned read view, as well as tuple data fetched from it, may
+ * be used until iproto_read_view_leave() is called.
+ */
+struct iproto_read_view *
+iproto_read_view_enter(int reader_id);
+
+/** Leave a read-side critical section. */
+void
+iproto_read_view_leave(int reader_id);
+
+/**
+ * Return the id of the last opened read view, 0 if none has been
+ * opened yet. May be called from any thread.
+ */
+uint64_t
+iproto_read_view_last_id(void);
+
+/** Return the id of a read view. Read view ids grow monotonically. */
+uint64_t
+iproto_read_view_id(const struct iproto_read_view *view);
+
+/**
+ * Look up a tuple by a full primary key in a read view.
+ *
+ * Returns false if the request can't be served from the read view:
+ * the space isn't in it, the user may not read the space, the schema
+ * has changed (@a request_schema_version is the version sent by the
+ * client, may be 0) or the key is invalid. In this case the request should
+ * be processed in tx as usual. Otherwise, returns true and sets
+ * @a result; the result data is NULL if the tuple isn't found.
+ */
+bool
+iproto_read_view_get(struct iproto_read_view *view, uint32_t space_id,
+		     uint64_t request_schema_version, uint8_t auth_token, uint32_t uid,
+		     const char *key, struct read_view_tuple *result);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
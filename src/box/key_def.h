@@ -168,6 +168,9 @@ typedef char *(*tuple_extract_key_raw_t)(const char *data,
 /** @copydoc tuple_hash() */
 typedef uint32_t (*tuple_hash_t)(struct tuple *tuple,
 				 struct key_def *key_def);
+/** @copydoc tuple_hash64() */
+typedef uint64_t (*tuple_hash64_t)(struct tuple *tuple,
+				   struct key_def *key_def);
 /** @copydoc tuple_hint() */
 typedef hint_t (*tuple_hint_t)(struct tuple *tuple,
 			       struct key_def *key_def);
@@ -187,6 +190,8 @@ struct key_def {
 	tuple_extract_key_raw_t tuple_extract_key_raw;
 	/** @see tuple_hash() */
 	tuple_hash_t tuple_hash;
+	/** @see tuple_hash64() */
+	tuple_hash64_t tuple_hash64;
 	/** @see tuple_hint() */
 	tuple_hint_t tuple_hint;
 	/** @see key_hint() */
@@ -1159,6 +1164,29 @@ tuple_hash(struct tuple *tuple, struct key_def *key_def)
 uint32_t
 key_hash(const char *key, struct key_def *key_def);
 
+/**
+ * Calculate a 64-bit hash value for a tuple. Unlike tuple_hash(),
+ * the value isn't compatible with the 32-bit hash stored on disk
+ * (e.g. in vinyl bloom filters) and must only be used in memory.
+ * @param tuple - a tuple
+ * @param key_def - key_def for field description
+ * @return - hash value
+ */
+static inline uint64_t
+tuple_hash64(struct tuple *tuple, struct key_def *key_def)
+{
+	return key_def->tuple_hash64(tuple, key_def);
+}
+
+/**
+ * Calculate a 64-bit hash value for a key, see tuple_hash64().
+ * @param key - full key (msgpack fields w/o array marker)
+ * @param key_def - key_def for field description
+ * @return - hash value
+ */
+uint64_t
+key_hash64(const char *key, struct key_def *key_def);
+
  /*
  * Get comparison hint for a tuple.
  * @param tuple - tuple to compute the hint for
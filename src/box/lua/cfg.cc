@@ -185,6 +185,54 @@ lbox_cfg_set_wal_queue_max_size(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_wal_tail_size(struct lua_State *L)
+{
+	if (box_set_wal_tail_size() != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_cfg_set_wal_compression_level(struct lua_State *L)
+{
+	if (box_set_wal_compression_level() != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_cfg_set_wal_compression_dict(struct lua_State *L)
+{
+	(void)L;
+	box_set_wal_compression_dict();
+	return 0;
+}
+
+static int
+lbox_cfg_set_snap_compression_level(struct lua_State *L)
+{
+	if (box_set_snap_compression_level() != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_cfg_set_snap_compression_dict(struct lua_State *L)
+{
+	(void)L;
+	box_set_snap_compression_dict();
+	return 0;
+}
+
+static int
+lbox_cfg_set_snap_delta_max(struct lua_State *L)
+{
+	if (box_set_snap_delta_max() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_cfg_set_replication_synchro_queue_max_size(struct lua_State *L)
 {
@@ -267,6 +315,41 @@ lbox_cfg_set_vinyl_cache(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_vinyl_page_cache(struct lua_State *L)
+{
+	try {
+		box_set_vinyl_page_cache();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_vinyl_max_subcompactions(struct lua_State *L)
+{
+	if (box_set_vinyl_max_subcompactions() != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_cfg_set_vinyl_readahead(struct lua_State *L)
+{
+	if (box_set_vinyl_readahead() != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_cfg_set_vinyl_log_compression_level(struct lua_State *L)
+{
+	if (box_set_vinyl_log_compression_level() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_cfg_set_vinyl_timeout(struct lua_State *L)
 {
@@ -297,6 +380,14 @@ lbox_cfg_set_net_msg_max(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_iproto_read_view_period(struct lua_State *L)
+{
+	if (box_set_iproto_read_view_period() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_set_prepared_stmt_cache_size(struct lua_State *L)
 {
@@ -483,6 +574,14 @@ lbox_cfg_set_replication_skip_conflict(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_replication_apply_concurrency(struct lua_State *L)
+{
+	if (box_set_replication_apply_concurrency() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_cfg_set_feedback(struct lua_State *L)
 {
@@ -549,6 +648,12 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_checkpoint_interval", lbox_cfg_set_checkpoint_interval},
 		{"cfg_set_checkpoint_wal_threshold", lbox_cfg_set_checkpoint_wal_threshold},
 		{"cfg_set_wal_queue_max_size", lbox_cfg_set_wal_queue_max_size},
+		{"cfg_set_wal_tail_size", lbox_cfg_set_wal_tail_size},
+		{"cfg_set_wal_compression_level", lbox_cfg_set_wal_compression_level},
+		{"cfg_set_wal_compression_dict", lbox_cfg_set_wal_compression_dict},
+		{"cfg_set_snap_compression_level", lbox_cfg_set_snap_compression_level},
+		{"cfg_set_snap_compression_dict", lbox_cfg_set_snap_compression_dict},
+		{"cfg_set_snap_delta_max", lbox_cfg_set_snap_delta_max},
 		{"cfg_set_replication_synchro_queue_max_size", lbox_cfg_set_replication_synchro_queue_max_size},
 		{"cfg_set_wal_cleanup_delay", lbox_cfg_set_wal_cleanup_delay},
 		{"cfg_set_read_only", lbox_cfg_set_read_only},
@@ -557,6 +662,10 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_vinyl_memory", lbox_cfg_set_vinyl_memory},
 		{"cfg_set_vinyl_max_tuple_size", lbox_cfg_set_vinyl_max_tuple_size},
 		{"cfg_set_vinyl_cache", lbox_cfg_set_vinyl_cache},
+		{"cfg_set_vinyl_page_cache", lbox_cfg_set_vinyl_page_cache},
+		{"cfg_set_vinyl_max_subcompactions", lbox_cfg_set_vinyl_max_subcompactions},
+		{"cfg_set_vinyl_readahead", lbox_cfg_set_vinyl_readahead},
+		{"cfg_set_vinyl_log_compression_level", lbox_cfg_set_vinyl_log_compression_level},
 		{"cfg_set_vinyl_timeout", lbox_cfg_set_vinyl_timeout},
 		{"cfg_set_force_recovery", lbox_cfg_set_force_recovery},
 		{"cfg_set_election_mode", lbox_cfg_set_election_mode},
@@ -571,12 +680,15 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_replication_synchro_timeout", lbox_cfg_set_replication_synchro_timeout},
 		{"cfg_set_replication_sync_timeout", lbox_cfg_set_replication_sync_timeout},
 		{"cfg_set_replication_skip_conflict", lbox_cfg_set_replication_skip_conflict},
+		{"cfg_set_replication_apply_concurrency", lbox_cfg_set_replication_apply_concurrency},
 		{"cfg_set_replication_anon", lbox_cfg_set_replication_anon},
 		{"cfg_set_replication_anon_ttl", lbox_cfg_set_replication_anon_ttl},
 		{"cfg_set_replicaset_name", lbox_cfg_set_replicaset_name},
 		{"cfg_set_instance_name", lbox_cfg_set_instance_name},
 		{"cfg_set_cluster_name", lbox_cfg_set_cluster_name},
 		{"cfg_set_net_msg_max", lbox_cfg_set_net_msg_max},
+		{"cfg_set_iproto_read_view_period",
+		 lbox_cfg_set_iproto_read_view_period},
 		{"cfg_set_sql_cache_size", lbox_set_prepared_stmt_cache_size},
 		{"cfg_set_feedback", lbox_cfg_set_feedback},
 		{"cfg_set_txn_timeout", lbox_cfg_set_txn_timeout},
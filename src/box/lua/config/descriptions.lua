@@ -1366,6 +1366,17 @@ I['iproto.net_msg_max'] = format_text([[
     network messages.
 ]])
 
+I['iproto.read_view_period'] = format_text([[
+    The period, in seconds, at which iproto threads get a fresh read view
+    of memtx spaces with a HASH primary index. If it is set, simple
+    primary key lookups (`select` by a full key with the `EQ` iterator)
+    are served by iproto threads from this read view without involving
+    the transaction processor thread. Data returned by such requests may
+    be stale by up to this period: writes done by other connections after
+    the read view was opened aren't visible. A connection always reads its
+    own writes. Zero (default) disables the feature.
+]])
+
 I['iproto.readahead'] = format_text([[
     The size of the read-ahead buffer associated with a client connection. The
     larger the buffer, the more memory an active connection consumes, and the
@@ -1755,6 +1766,17 @@ I['replication.anon_ttl'] = format_text([[
     removed from the instance.
 ]])
 
+I['replication.apply_concurrency'] = format_text([[
+    The maximum number of transactions received from a master that a replica
+    may apply concurrently. Transactions that modify different keys of user
+    spaces are applied in parallel, but committed in the order they were
+    received. Transactions that touch the same keys, system spaces, or spaces
+    with triggers or foreign keys are applied one by one.
+
+    Possible values range from 1 to 1000. The default value 1 means that all
+    transactions are applied one by one.
+]])
+
 I['replication.autoexpel'] = format_text([[
     Automatically expel instances.
 
@@ -2316,6 +2338,21 @@ I['snapshot.by.wal_size'] = format_text([[
     snapshot and delete old WAL files.
 ]])
 
+I['snapshot.compression_dict'] = format_text([[
+    Compress snapshot files with a zstd dictionary. The dictionary is trained
+    on a sample of tuples taken from user spaces at the start of each
+    checkpoint and stored in the snapshot file header. It makes compression
+    of small tuples noticeably more effective. Snapshots written with a
+    dictionary can't be read by Tarantool versions that don't support it.
+]])
+
+I['snapshot.compression_level'] = format_text([[
+    The zstd compression level used for snapshot files. Higher levels produce
+    smaller snapshots at the cost of more CPU time spent on checkpointing.
+    Set to 0 to disable compression. The new value is used starting from the
+    next checkpoint.
+]])
+
 I['snapshot.count'] = format_text([[
     The maximum number of snapshots that are stored in the `snapshot.dir`
     directory. If the number of snapshots after creating a new one exceeds
@@ -2324,6 +2361,14 @@ I['snapshot.count'] = format_text([[
     old snapshots.
 ]])
 
+I['snapshot.delta_max'] = format_text([[
+    The maximum number of delta snapshots that may follow a full snapshot.
+    A delta snapshot contains only the spaces that changed since the previous
+    snapshot and refers to it as to its base. Once the chain reaches this
+    length, a full snapshot is written. Set to 0 to always write full
+    snapshots. The first snapshot after the instance start is always full.
+]])
+
 I['snapshot.dir'] = format_text([[
     A directory where memtx stores snapshot (`.snap`) files. A relative path
     in this option is interpreted as relative to `process.work_dir`.
@@ -2423,15 +2468,32 @@ I['vinyl.dir'] = format_text([[
     relative to `process.work_dir`.
 ]])
 
+I['vinyl.max_subcompactions'] = format_text([[
+    The maximum number of parts compaction of a big range can be split
+    into. The parts are compacted in parallel by idle vinyl write threads
+    and become separate ranges. The value of 1 disables splitting.
+]])
+
 I['vinyl.max_tuple_size'] = format_text([[
     The size of the largest allocation unit, for the vinyl storage engine.
     It can be increased if it is necessary to store large tuples.
 ]])
 
+I['vinyl.log_compression_level'] = format_text([[
+    The zstd compression level used for vinyl metadata log (`.vylog`) files.
+    Set to 0 to disable compression. The new value is used starting from the
+    next vylog file, which is created on checkpoint.
+]])
+
 I['vinyl.memory'] = format_text([[
     The maximum number of in-memory bytes that vinyl uses.
 ]])
 
+I['vinyl.page_cache'] = format_text([[
+    The size of the cache of decompressed run pages shared by all vinyl
+    indexes. Zero disables the cache. The cache can be resized dynamically.
+]])
+
 I['vinyl.page_size'] = format_text([[
     The page size. A page is a read/write unit for vinyl disk operations.
     The `vinyl.page_size` setting is a default value for the page_size option
@@ -2457,6 +2519,12 @@ I['vinyl.read_threads'] = format_text([[
     operations, such as I/O and compression.
 ]])
 
+I['vinyl.readahead'] = format_text([[
+    The maximum number of run pages an index iterator may read ahead in
+    the background when it detects a range scan. Pages stored one after
+    another are read from disk with a single call. Zero disables readahead.
+]])
+
 I['vinyl.run_count_per_level'] = format_text([[
     The maximum number of runs per level in the vinyl LSM tree. If this
     number is exceeded, a new level is created. The `vinyl.run_count_per_level`
@@ -2504,6 +2572,31 @@ I['wal.cleanup_delay'] = format_text([[
     `wal.cleanup_delay` has not expired.
 ]])
 
+I['wal.compression_dict'] = format_text([[
+    Compress write-ahead log files with a zstd dictionary. The dictionary is
+    trained on a sample of recently written rows when a new WAL file is
+    created and stored in the WAL file header, so the first WAL file is
+    written without it. It makes compression of small rows noticeably more
+    effective. WAL files written with a dictionary can't be read by Tarantool
+    versions that don't support it.
+]])
+
+I['wal.compression_level'] = format_text([[
+    The zstd compression level used for write-ahead log files. Only blocks of
+    rows larger than 2 KB are compressed. Higher levels produce smaller WAL
+    files at the cost of more CPU time spent in the WAL thread. Set to 0 to
+    disable compression. The new value is applied to the current WAL file
+    immediately.
+]])
+
+I['wal.compression_threads'] = format_text([[
+    The number of threads that compress write-ahead log blocks. When set to a
+    positive value, the WAL thread encodes rows into blocks, hands them over to
+    the compression threads and writes the compressed blocks to disk in order,
+    grouping all the transactions that have been queued while the previous
+    write was in progress. Set to 0 to compress blocks in the WAL thread.
+]])
+
 I['wal.dir'] = format_text([[
     A directory where write-ahead log (`.xlog`) files are stored. A relative
     path in this option is interpreted as relative to `process.work_dir`.
@@ -2579,6 +2672,14 @@ I['wal.queue_max_size'] = format_text([[
     transactions faster than writing them to the WAL.
 ]])
 
+I['wal.tail_size'] = format_text([[
+    The size of the in-memory buffer in bytes that keeps the most recently
+    written WAL rows. Replication relays that keep up with the WAL read new
+    rows from this buffer instead of reading and decoding WAL files. A relay
+    that lags behind the buffer falls back to reading WAL files. Set to 0 to
+    disable the buffer.
+]])
+
 I['wal.retention_period'] = format_text([[
     The delay in seconds used to prevent the Tarantool garbage collector from
     removing a write-ahead log file after it has been closed. If a node is
@@ -876,6 +876,11 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'net_msg_max',
             default = 768,
         }),
+        read_view_period = schema.scalar({
+            type = 'number',
+            box_cfg = 'iproto_read_view_period',
+            default = 0,
+        }),
         readahead = schema.scalar({
             type = 'integer',
             box_cfg = 'readahead',
@@ -1017,6 +1022,11 @@ return schema.new('instance_config', schema.record({
             mkdir = true,
             default = 'var/lib/{{ instance_name }}',
         }),
+        max_subcompactions = schema.scalar({
+            type = 'integer',
+            box_cfg = 'vinyl_max_subcompactions',
+            default = 1,
+        }),
         max_tuple_size = schema.scalar({
             type = 'integer',
             box_cfg = 'vinyl_max_tuple_size',
@@ -1027,6 +1037,16 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'vinyl_memory',
             default = 128 * 1024 * 1024,
         }),
+        log_compression_level = schema.scalar({
+            type = 'integer',
+            box_cfg = 'vinyl_log_compression_level',
+            default = 3,
+        }),
+        page_cache = schema.scalar({
+            type = 'integer',
+            box_cfg = 'vinyl_page_cache',
+            default = 0,
+        }),
         page_size = schema.scalar({
             type = 'integer',
             box_cfg = 'vinyl_page_size',
@@ -1045,6 +1065,11 @@ return schema.new('instance_config', schema.record({
             box_cfg_nondynamic = true,
             default = 1,
         }),
+        readahead = schema.scalar({
+            type = 'integer',
+            box_cfg = 'vinyl_readahead',
+            default = 0,
+        }),
         run_count_per_level = schema.scalar({
             type = 'integer',
             box_cfg = 'vinyl_run_count_per_level',
@@ -1102,6 +1127,27 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'wal_queue_max_size',
             default = 16 * 1024 * 1024,
         }),
+        tail_size = schema.scalar({
+            type = 'integer',
+            box_cfg = 'wal_tail_size',
+            default = 16 * 1024 * 1024,
+        }),
+        compression_level = schema.scalar({
+            type = 'integer',
+            box_cfg = 'wal_compression_level',
+            default = 3,
+        }),
+        compression_dict = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'wal_compression_dict',
+            default = false,
+        }),
+        compression_threads = schema.scalar({
+            type = 'integer',
+            box_cfg = 'wal_compression_threads',
+            box_cfg_nondynamic = true,
+            default = 0,
+        }),
         cleanup_delay = schema.scalar({
             type = 'number',
             box_cfg = 'wal_cleanup_delay',
@@ -1178,11 +1224,26 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'checkpoint_count',
             default = 2,
         }),
+        compression_level = schema.scalar({
+            type = 'integer',
+            box_cfg = 'snap_compression_level',
+            default = 3,
+        }),
+        compression_dict = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'snap_compression_dict',
+            default = false,
+        }),
         snap_io_rate_limit = schema.scalar({
             type = 'number',
             box_cfg = 'snap_io_rate_limit',
             default = box.NULL,
         }),
+        delta_max = schema.scalar({
+            type = 'integer',
+            box_cfg = 'snap_delta_max',
+            default = 0,
+        }),
     }),
     replication = schema.record({
         failover = schema.enum({
@@ -1308,6 +1369,11 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'replication_skip_conflict',
             default = false,
         }),
+        apply_concurrency = schema.scalar({
+            type = 'integer',
+            box_cfg = 'replication_apply_concurrency',
+            default = 1,
+        }),
         election_mode = schema.enum({
             'off',
             'voter',
@@ -36,6 +36,7 @@
 #include "box/index.h"
 #include "box/lua/tuple.h"
 #include "box/lua/misc.h"
+#include "box/port.h"
 #include "small/region.h"
 #include "arrow_ipc.h"
 #include "fiber.h"
@@ -214,6 +215,35 @@ lbox_index_get(lua_State *L)
 	return rc == 0 ? luaT_pushtupleornil(L, tuple) : luaT_error(L);
 }
 
+static int
+lbox_index_get_many(lua_State *L)
+{
+	if (lua_gettop(L) != 3 || !lua_isnumber(L, 1) || !lua_isnumber(L, 2) ||
+	    !lua_istable(L, 3)) {
+		diag_set(IllegalParams,
+			 "Usage: index.get_many(space_id, index_id, keys)");
+		return luaT_error(L);
+	}
+
+	uint32_t space_id = lua_tonumber(L, 1);
+	uint32_t index_id = lua_tonumber(L, 2);
+	size_t keys_len;
+	size_t region_svp = region_used(&fiber()->gc);
+	const char *keys = lbox_encode_tuple_on_gc(L, 3, &keys_len);
+	if (keys == NULL)
+		return luaT_error(L);
+
+	struct port port;
+	int rc = box_index_get_many(space_id, index_id, keys, keys + keys_len,
+				    &port);
+	region_truncate(&fiber()->gc, region_svp);
+	if (rc != 0)
+		return luaT_error(L);
+	port_dump_lua(&port, L, PORT_DUMP_LUA_MODE_TABLE);
+	port_destroy(&port);
+	return 1;
+}
+
 static int
 lbox_index_min(lua_State *L)
 {
@@ -442,6 +472,125 @@ lbox_insert_arrow(lua_State *L)
 	return 0;
 }
 
+/**
+ * Fill Arrow stream options from the predicate table at @a idx:
+ * {{fieldno, op, value}, ...}, where fieldno is zero-based and value
+ * is encoded in MsgPack.
+ */
+static int
+lbox_index_select_arrow_predicates(struct lua_State *L, int idx,
+				   box_arrow_options_t *options)
+{
+	uint32_t count = lua_objlen(L, idx);
+	uint32_t i;
+	for (i = 1; i <= count; i++) {
+		lua_rawgeti(L, idx, i);
+		if (lua_type(L, -1) != LUA_TTABLE)
+			goto error;
+		lua_rawgeti(L, -1, 1);
+		lua_rawgeti(L, -2, 2);
+		lua_rawgeti(L, -3, 3);
+		if (!lua_isnumber(L, -3) || !lua_isnumber(L, -2) ||
+		    lua_type(L, -1) != LUA_TSTRING)
+			goto error;
+		size_t size;
+		const char *value = lua_tolstring(L, -1, &size);
+		box_arrow_options_add_predicate(options, lua_tonumber(L, -3),
+						lua_tonumber(L, -2),
+						value, value + size);
+		lua_pop(L, 4);
+	}
+	return 0;
+error:
+	diag_set(IllegalParams, "Invalid predicate #%u", (unsigned)i);
+	return -1;
+}
+
+/**
+ * Select fields of the tuples matching the key and the predicates in
+ * the column format. Pushes a table of record batches, each encoded in
+ * Arrow IPC format.
+ */
+static int
+lbox_index_select_arrow(struct lua_State *L)
+{
+	if (lua_gettop(L) != 6 || !lua_isnumber(L, 1) ||
+	    !lua_isnumber(L, 2) || lua_type(L, 4) != LUA_TTABLE ||
+	    !lua_isnumber(L, 5) || lua_type(L, 6) != LUA_TTABLE) {
+		diag_set(IllegalParams, "Usage: index:select_arrow(key, opts)");
+		return luaT_error(L);
+	}
+	uint32_t space_id = lua_tonumber(L, 1);
+	uint32_t index_id = lua_tonumber(L, 2);
+	uint32_t batch_row_count = lua_tonumber(L, 5);
+
+	struct region *gc = &fiber()->gc;
+	size_t region_svp = region_used(gc);
+	uint32_t field_count = lua_objlen(L, 4);
+	uint32_t *fields = xregion_alloc_array(gc, uint32_t, field_count);
+	for (uint32_t i = 0; i < field_count; i++) {
+		lua_rawgeti(L, 4, i + 1);
+		fields[i] = lua_tonumber(L, -1);
+		lua_pop(L, 1);
+	}
+	size_t key_len;
+	const char *key = lbox_encode_tuple_on_gc(L, 3, &key_len);
+
+	box_arrow_options_t *options = box_arrow_options_new();
+	box_arrow_options_set_batch_row_count(options, batch_row_count);
+	struct ArrowArrayStream stream;
+	struct ArrowSchema schema;
+	struct ArrowArray array;
+	if (lbox_index_select_arrow_predicates(L, 6, options) != 0 ||
+	    box_index_arrow_stream(space_id, index_id, field_count, fields,
+				   key, key + key_len, options,
+				   &stream) != 0)
+		goto error;
+	box_arrow_options_delete(options);
+	options = NULL;
+	/*
+	 * The index iterator of the stream refers to the key so the key
+	 * must live until the stream is released. Batches are encoded on
+	 * the region above it.
+	 */
+	size_t batch_svp = region_used(gc);
+
+	if (stream.get_schema(&stream, &schema) != 0) {
+		stream.release(&stream);
+		goto error;
+	}
+	lua_newtable(L);
+	for (int i = 1; ; i++) {
+		if (stream.get_next(&stream, &array) != 0)
+			goto error_schema;
+		if (array.release == NULL)
+			break;
+		const char *data, *data_end;
+		int rc = arrow_ipc_encode(&array, &schema, gc, &data,
+					  &data_end);
+		array.release(&array);
+		if (rc != 0)
+			goto error_schema;
+		lua_pushlstring(L, data, data_end - data);
+		lua_rawseti(L, -2, i);
+		region_truncate(gc, batch_svp);
+	}
+	schema.release(&schema);
+	stream.release(&stream);
+	region_truncate(gc, region_svp);
+	return 1;
+error_schema:
+	schema.release(&schema);
+	stream.release(&stream);
+	region_truncate(gc, region_svp);
+	return luaT_error(L);
+error:
+	region_truncate(gc, region_svp);
+	if (options != NULL)
+		box_arrow_options_delete(options);
+	return luaT_error(L);
+}
+
 /* }}} */
 
 void
@@ -467,6 +616,7 @@ box_lua_index_init(struct lua_State *L)
 		{"delete",  lbox_index_delete},
 		{"random", lbox_index_random},
 		{"get",  lbox_index_get},
+		{"get_many", lbox_index_get_many},
 		{"min", lbox_index_min},
 		{"max", lbox_index_max},
 		{"count", lbox_index_count},
@@ -476,6 +626,7 @@ box_lua_index_init(struct lua_State *L)
 		{"stat", lbox_index_stat},
 		{"compact", lbox_index_compact},
 		{"insert_arrow", lbox_insert_arrow},
+		{"select_arrow", lbox_index_select_arrow},
 		{NULL, NULL}
 	};
 
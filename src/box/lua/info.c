@@ -41,6 +41,7 @@
 #include "box/relay.h"
 #include "box/iproto.h"
 #include "box/wal.h"
+#include "box/wal_tail.h"
 #include "box/replication.h"
 #include "info/info.h"
 #include "box/gc.h"
@@ -57,6 +58,7 @@
 #include "lua/utils.h"
 #include "lua/serializer.h" /* luaL_setmaphint */
 #include "fiber.h"
+#include "rmean.h"
 #include "sio.h"
 #include "tt_strerror.h"
 #include "tweaks.h"
@@ -96,6 +98,27 @@ lbox_push_replication_error_message(struct lua_State *L, struct error *e,
 	lua_settable(L, idx - 2);
 }
 
+static void
+lbox_pushapplier_stat(lua_State *L, struct applier *applier)
+{
+	int64_t txs = rmean_total(applier->stat, APPLIER_STAT_TX);
+	int64_t parallel = rmean_total(applier->stat,
+				       APPLIER_STAT_TX_PARALLEL);
+	int64_t conflicts = rmean_total(applier->stat,
+					APPLIER_STAT_TX_CONFLICT);
+	lua_createtable(L, 0, 5);
+	luaL_pushint64(L, txs);
+	lua_setfield(L, -2, "txs");
+	lua_pushnumber(L, rmean_mean(applier->stat, APPLIER_STAT_TX));
+	lua_setfield(L, -2, "rps");
+	luaL_pushint64(L, parallel);
+	lua_setfield(L, -2, "parallel");
+	luaL_pushint64(L, conflicts);
+	lua_setfield(L, -2, "conflicts");
+	lua_pushnumber(L, parallel > 0 ? (double)conflicts / parallel : 0);
+	lua_setfield(L, -2, "conflict_ratio");
+}
+
 static void
 lbox_pushapplier(lua_State *L, struct applier *applier)
 {
@@ -133,6 +156,9 @@ lbox_pushapplier(lua_State *L, struct applier *applier)
 		lua_pushlstring(L, name, total);
 		lua_settable(L, -3);
 
+		lbox_pushapplier_stat(L, applier);
+		lua_setfield(L, -2, "apply");
+
 		struct error *e = diag_last_error(&applier->diag);
 		if (e != NULL)
 			lbox_push_replication_error_message(L, e, -1);
@@ -159,6 +185,18 @@ lbox_pushrelay(lua_State *L, struct relay *relay)
 		lua_pushstring(L, "lag");
 		lua_pushnumber(L, relay_txn_lag(relay));
 		lua_settable(L, -3);
+		lua_pushstring(L, "wal_tail");
+		lua_createtable(L, 0, 3);
+		lua_pushstring(L, "size");
+		luaL_pushuint64(L, wal_tail_size());
+		lua_settable(L, -3);
+		lua_pushstring(L, "hits");
+		luaL_pushint64(L, relay_wal_tail_hits(relay));
+		lua_settable(L, -3);
+		lua_pushstring(L, "misses");
+		luaL_pushint64(L, relay_wal_tail_misses(relay));
+		lua_settable(L, -3);
+		lua_settable(L, -3);
 		break;
 	case RELAY_STOPPED:
 	{
@@ -101,10 +101,14 @@ local default_cfg = {
     vinyl_dir           = '.',
     vinyl_memory        = 128 * 1024 * 1024,
     vinyl_cache         = 128 * 1024 * 1024,
+    vinyl_page_cache    = 0,
     vinyl_max_tuple_size = 1024 * 1024,
     vinyl_read_threads  = 1,
     vinyl_write_threads = 4,
+    vinyl_max_subcompactions = 1,
+    vinyl_readahead     = 0,
     vinyl_timeout       = 60,
+    vinyl_log_compression_level = 3,
     vinyl_defer_deletes = false,
     vinyl_run_count_per_level = 2,
     vinyl_run_size_ratio      = 3.5,
@@ -151,11 +155,18 @@ local default_cfg = {
     io_collect_interval = nil,
     readahead           = 16320,
     snap_io_rate_limit  = nil, -- no limit
+    snap_compression_level = 3,
+    snap_compression_dict = false,
+    snap_delta_max      = 0,
     too_long_threshold  = 0.5,
     wal_mode            = "write",
     wal_max_size        = 256 * 1024 * 1024,
     wal_dir_rescan_delay= 2,
     wal_queue_max_size  = 16 * 1024 * 1024,
+    wal_tail_size       = 16 * 1024 * 1024,
+    wal_compression_level = 3,
+    wal_compression_dict = false,
+    wal_compression_threads = 0,
     wal_cleanup_delay   = nil,
     wal_retention_period = ifdef_wal_retention_period(0),
     wal_ext             = ifdef_wal_ext(nil),
@@ -191,6 +202,7 @@ local default_cfg = {
     replication_connect_timeout = 30,
     replication_connect_quorum = nil, -- connect all
     replication_skip_conflict = false,
+    replication_apply_concurrency = 1,
     replication_anon      = false,
     replication_anon_ttl  = 60 * 60,
     replication_threads   = 1,
@@ -204,6 +216,7 @@ local default_cfg = {
     feedback_metrics_collect_interval = ifdef_feedback(60),
     feedback_metrics_limit = ifdef_feedback(1024 * 1024),
     net_msg_max           = 768,
+    iproto_read_view_period = 0,
     sql_cache_size        = 5 * 1024 * 1024,
     txn_timeout           = 365 * 100 * 86400,
     txn_synchro_timeout   = 5,
@@ -305,10 +318,14 @@ local template_cfg = {
     vinyl_dir           = 'string',
     vinyl_memory        = 'number',
     vinyl_cache               = 'number',
+    vinyl_page_cache          = 'number',
     vinyl_max_tuple_size      = 'number',
     vinyl_read_threads        = 'number',
     vinyl_write_threads       = 'number',
+    vinyl_max_subcompactions  = 'number',
+    vinyl_readahead           = 'number',
     vinyl_timeout             = 'number',
+    vinyl_log_compression_level = 'number',
     vinyl_defer_deletes       = 'boolean',
     vinyl_run_count_per_level = 'number',
     vinyl_run_size_ratio      = 'number',
@@ -355,6 +372,9 @@ local template_cfg = {
     io_collect_interval = 'number',
     readahead           = 'number',
     snap_io_rate_limit  = 'number',
+    snap_compression_level = 'number',
+    snap_compression_dict = 'boolean',
+    snap_delta_max      = 'number',
     too_long_threshold  = 'number',
     wal_mode            = 'string',
     wal_max_size        = 'number',
@@ -377,6 +397,10 @@ local template_cfg = {
     checkpoint_interval = 'number',
     checkpoint_wal_threshold = 'number',
     wal_queue_max_size  = 'number',
+    wal_tail_size       = 'number',
+    wal_compression_level = 'number',
+    wal_compression_dict = 'boolean',
+    wal_compression_threads = 'number',
     checkpoint_count    = 'number',
     read_only           = 'boolean',
     hot_standby         = 'boolean',
@@ -396,6 +420,7 @@ local template_cfg = {
     replication_connect_timeout = 'number',
     replication_connect_quorum = 'number',
     replication_skip_conflict = 'boolean',
+    replication_apply_concurrency = 'number',
     replication_anon      = 'boolean',
     replication_anon_ttl  = 'number',
     replication_threads   = 'number',
@@ -409,6 +434,7 @@ local template_cfg = {
     feedback_metrics_collect_interval = ifdef_feedback('number'),
     feedback_metrics_limit = ifdef_feedback('number'),
     net_msg_max           = 'number',
+    iproto_read_view_period = 'number',
     sql_cache_size        = 'number',
     txn_timeout           = 'number',
     txn_synchro_timeout   = 'number',
@@ -511,18 +537,28 @@ local dynamic_cfg = {
     readahead               = private.cfg_set_readahead,
     too_long_threshold      = private.cfg_set_too_long_threshold,
     snap_io_rate_limit      = private.cfg_set_snap_io_rate_limit,
+    snap_compression_level  = private.cfg_set_snap_compression_level,
+    snap_compression_dict   = private.cfg_set_snap_compression_dict,
+    snap_delta_max          = private.cfg_set_snap_delta_max,
     read_only               = private.cfg_set_read_only,
     memtx_memory            = private.cfg_set_memtx_memory,
     memtx_max_tuple_size    = private.cfg_set_memtx_max_tuple_size,
     vinyl_memory            = private.cfg_set_vinyl_memory,
     vinyl_max_tuple_size    = private.cfg_set_vinyl_max_tuple_size,
     vinyl_cache             = private.cfg_set_vinyl_cache,
+    vinyl_page_cache        = private.cfg_set_vinyl_page_cache,
+    vinyl_max_subcompactions = private.cfg_set_vinyl_max_subcompactions,
+    vinyl_readahead         = private.cfg_set_vinyl_readahead,
     vinyl_timeout           = private.cfg_set_vinyl_timeout,
+    vinyl_log_compression_level = private.cfg_set_vinyl_log_compression_level,
     vinyl_defer_deletes     = nop,
     checkpoint_count        = private.cfg_set_checkpoint_count,
     checkpoint_interval     = private.cfg_set_checkpoint_interval,
     checkpoint_wal_threshold = private.cfg_set_checkpoint_wal_threshold,
     wal_queue_max_size      = private.cfg_set_wal_queue_max_size,
+    wal_tail_size           = private.cfg_set_wal_tail_size,
+    wal_compression_level   = private.cfg_set_wal_compression_level,
+    wal_compression_dict    = private.cfg_set_wal_compression_dict,
     worker_pool_threads     = private.cfg_set_worker_pool_threads,
     -- do nothing, affects new replicas, which query this value on start
     wal_dir_rescan_delay    = nop,
@@ -554,6 +590,8 @@ local dynamic_cfg = {
     replication_synchro_queue_max_size =
         private.cfg_set_replication_synchro_queue_max_size,
     replication_skip_conflict = private.cfg_set_replication_skip_conflict,
+    replication_apply_concurrency =
+        private.cfg_set_replication_apply_concurrency,
     replication_anon        = private.cfg_set_replication_anon,
     replication_anon_ttl    = private.cfg_set_replication_anon_ttl,
     bootstrap_strategy      = private.cfg_set_bootstrap_strategy,
@@ -564,6 +602,7 @@ local dynamic_cfg = {
     replicaset_name         = private.cfg_set_replicaset_name,
     cluster_name            = private.cfg_set_cluster_name,
     net_msg_max             = private.cfg_set_net_msg_max,
+    iproto_read_view_period = private.cfg_set_iproto_read_view_period,
     sql_cache_size          = private.cfg_set_sql_cache_size,
     txn_timeout             = private.cfg_set_txn_timeout,
     txn_synchro_timeout     = private.cfg_set_txn_synchro_timeout,
@@ -709,7 +748,11 @@ local dynamic_cfg_skip_at_load = {
     vinyl_memory            = true,
     vinyl_max_tuple_size    = true,
     vinyl_cache             = true,
+    vinyl_page_cache        = true,
+    vinyl_max_subcompactions = true,
+    vinyl_readahead         = true,
     vinyl_timeout           = true,
+    vinyl_log_compression_level = true,
     too_long_threshold      = true,
     election_mode           = true,
     election_timeout        = true,
@@ -725,12 +768,14 @@ local dynamic_cfg_skip_at_load = {
     replication_synchro_timeout = true,
     replication_synchro_queue_max_size = true,
     replication_skip_conflict = true,
+    replication_apply_concurrency = true,
     replication_anon        = true,
     txn_synchro_timeout     = true,
     bootstrap_strategy      = true,
     bootstrap_leader        = true,
     wal_dir_rescan_delay    = true,
     wal_queue_max_size      = true,
+    wal_tail_size           = true,
     custom_proc_title       = true,
     force_recovery          = true,
     instance_uuid           = true,
@@ -739,6 +784,7 @@ local dynamic_cfg_skip_at_load = {
     replicaset_name         = true,
     cluster_name            = true,
     net_msg_max             = true,
+    iproto_read_view_period = true,
     readahead               = true,
     auth_type               = true,
     auth_delay              = ifdef_security(true),
@@ -936,9 +936,55 @@ function box.schema.space.format(id, format)
     end
 end
 
-function box.schema.space.upgrade(id)
+-- Online space upgrade: converts tuples stored in a space to a new format
+-- with the given function. Without options returns the upgrade status.
+function box.schema.space.upgrade(id, opts)
+    utils.box_check_configured(2)
+    local _space = box.space._space
     check_param(id, 'id', 'number', 2)
-    box.error(box.error.UNSUPPORTED, "Community edition", "space upgrade", 2)
+    local tuple = _space:get(id)
+    if tuple == nil then
+        box.error(box.error.NO_SUCH_SPACE, '#' .. tostring(id), 2)
+    end
+    if opts == nil then
+        return box.internal.space.upgrade_info(id)
+    end
+    check_param_table(opts, {
+        func = 'string, number',
+        arg = 'any',
+        format = 'table',
+        rate = 'number',
+        is_async = 'boolean',
+    }, 2)
+    local upgrade = setmap({
+        arg = opts.arg,
+        owner = box.info.uuid,
+        rate = opts.rate,
+    })
+    if type(opts.func) == 'string' then
+        upgrade.func = box.internal.func_id_by_name(opts.func, 2)
+    else
+        upgrade.func = opts.func
+    end
+    local format = tuple.format
+    if opts.format ~= nil then
+        format = normalize_format(id, tuple.name, opts.format, 2)
+    end
+    call_at(2, _space.update, _space, id,
+            {{'=', 'flags.upgrade', upgrade}, {'=', 7, format}})
+    if opts.is_async then
+        return
+    end
+    while true do
+        local info = box.internal.space.upgrade_info(id)
+        if info == nil then
+            return
+        end
+        if info.status == 'error' then
+            box.error(info.error)
+        end
+        fiber.sleep(0.01)
+    end
 end
 
 box.schema.create_space = box.schema.space.create
@@ -1559,6 +1605,7 @@ local index_options = {
     bloom_fpr = 'number',
     func = 'number, string',
     hint = 'boolean',
+    hash_bits = 'number',
     covers = 'table',
     layout = 'string',
 }
@@ -1735,6 +1782,7 @@ box.schema.index.create = atomic_wrapper(function(space_id, name, options)
             bloom_fpr = options.bloom_fpr,
             func = options.func,
             hint = options.hint,
+            hash_bits = options.hash_bits,
             covers = options.covers,
             layout = options.layout,
     }
@@ -2644,6 +2692,100 @@ base_index_mt.get_luac = function(index, key)
     return internal.get(index.space_id, index.id, key)
 end
 
+base_index_mt.get_many = function(index, keys)
+    check_index_arg(index, 'get_many', 2)
+    if type(keys) ~= 'table' then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "Usage: index:get_many({key1, key2, ...})", 2)
+    end
+    local normalized = {}
+    for i, key in ipairs(keys) do
+        normalized[i] = keify(key)
+    end
+    return internal.get_many(index.space_id, index.id, normalized)
+end
+
+local arrow_predicate_ops = {
+    EQ = 0, NE = 1, LT = 2, LE = 3, GT = 4, GE = 5,
+}
+
+-- Convert a field name or a one-based field number to a zero-based
+-- field number.
+local function arrow_fieldno(format, field)
+    if type(field) == 'number' and field >= 1 then
+        return field - 1
+    end
+    for i, f in ipairs(format) do
+        if f.name == field then
+            return i - 1
+        end
+    end
+    return nil
+end
+
+base_index_mt.select_arrow = function(index, key, opts)
+    check_index_arg(index, 'select_arrow', 2)
+    local usage = "Usage: index:select_arrow(key, " ..
+                  "{fields = {...}, batch_row_count = n, where = {...}})"
+    if opts ~= nil and type(opts) ~= 'table' then
+        box.error(box.error.ILLEGAL_PARAMS, usage, 2)
+    end
+    opts = opts or {}
+    local space = box.space[index.space_id]
+    local format = space ~= nil and space:format() or {}
+    local fields = {}
+    if opts.fields ~= nil then
+        if type(opts.fields) ~= 'table' then
+            box.error(box.error.ILLEGAL_PARAMS, usage, 2)
+        end
+        for i, field in ipairs(opts.fields) do
+            fields[i] = arrow_fieldno(format, field)
+            if fields[i] == nil then
+                box.error(box.error.ILLEGAL_PARAMS,
+                          "Unknown field '" .. tostring(field) .. "'", 2)
+            end
+        end
+    else
+        for i = 1, #format do
+            fields[i] = i - 1
+        end
+    end
+    if #fields == 0 then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "select_arrow requires fields or a space format", 2)
+    end
+    local batch_row_count = opts.batch_row_count or 4096
+    if type(batch_row_count) ~= 'number' or batch_row_count < 1 then
+        box.error(box.error.ILLEGAL_PARAMS, usage, 2)
+    end
+    local where = {}
+    if opts.where ~= nil then
+        if type(opts.where) ~= 'table' then
+            box.error(box.error.ILLEGAL_PARAMS, usage, 2)
+        end
+        for i, predicate in ipairs(opts.where) do
+            if type(predicate) ~= 'table' then
+                box.error(box.error.ILLEGAL_PARAMS, usage, 2)
+            end
+            local fieldno = arrow_fieldno(format, predicate[1])
+            if fieldno == nil then
+                box.error(box.error.ILLEGAL_PARAMS,
+                          "Unknown field '" .. tostring(predicate[1]) ..
+                          "'", 2)
+            end
+            local op = arrow_predicate_ops[predicate[2]]
+            if op == nil then
+                box.error(box.error.ILLEGAL_PARAMS,
+                          "Unknown predicate operator '" ..
+                          tostring(predicate[2]) .. "'", 2)
+            end
+            where[i] = {fieldno, op, msgpack.encode(predicate[3])}
+        end
+    end
+    return internal.select_arrow(index.space_id, index.id, keify(key),
+                                 fields, batch_row_count, where)
+end
+
 local function check_select_opts(opts, key_is_nil, level)
     local offset = 0
     local limit = 4294967295
@@ -2827,6 +2969,10 @@ space_mt.get = function(space, key)
     check_space_arg(space, 'get', 2)
     return check_primary_index(space, 2):get(key)
 end
+space_mt.get_many = function(space, keys)
+    check_space_arg(space, 'get_many', 2)
+    return check_primary_index(space, 2):get_many(keys)
+end
 space_mt.select = function(space, key, opts)
     check_space_arg(space, 'select', 2)
     return check_primary_index(space, 2):select(key, opts)
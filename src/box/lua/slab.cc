@@ -55,6 +55,7 @@
 #include "box/box.h"
 #include "box/engine.h"
 #include "box/memtx_engine.h"
+#include "box/memtx_tuple_compression.h"
 #include "box/allocator.h"
 #include "box/tuple.h"
 
@@ -217,6 +218,20 @@ lbox_slab_info(struct lua_State *L)
 	lua_pushstring(L, ratio_buf);
 	lua_settable(L, -3);
 
+	/*
+	 * How much memory compressed tuple fields take and how
+	 * much they would take if they were stored uncompressed.
+	 */
+	struct memtx_tuple_compression_stat compression;
+	memtx_tuple_compression_stat(&compression);
+	lua_pushstring(L, "compressed_size");
+	luaL_pushuint64(L, compression.compressed_size);
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "uncompressed_size");
+	luaL_pushuint64(L, compression.raw_size);
+	lua_settable(L, -3);
+
 	return 1;
 }
 
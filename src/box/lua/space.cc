@@ -36,6 +36,7 @@
 #include "box/lua/key_def.h"
 #include "box/sql/sqlLimit.h"
 #include "lua/utils.h"
+#include "lua/error.h"
 #include "lua/trigger.h"
 #include "box/box.h"
 
@@ -48,6 +49,7 @@ extern "C" {
 #include "box/func.h"
 #include "box/func_def.h"
 #include "box/space.h"
+#include "box/space_upgrade.h"
 #include "box/memtx_space.h"
 #include "box/schema.h"
 #include "box/user_def.h"
@@ -606,6 +608,13 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 			lua_pushnil(L);
 			lua_setfield(L, -2, "hint");
 		}
+		if (space_is_memtx(space) && index_def->type == HASH) {
+			lua_pushnumber(L, index_opts->hash_bits);
+			lua_setfield(L, -2, "hash_bits");
+		} else {
+			lua_pushnil(L);
+			lua_setfield(L, -2, "hash_bits");
+		}
 
 		if (index_opts->func_id > 0) {
 			lua_pushstring(L, "func");
@@ -957,6 +966,59 @@ lbox_space_stat(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * Push to Lua stack a table with the status of the space upgrade or nil
+ * if the space isn't being upgraded.
+ */
+static int
+lbox_space_upgrade_info(struct lua_State *L)
+{
+	if (lua_gettop(L) != 1 || !lua_isnumber(L, 1))
+		return luaL_error(L, "Usage: upgrade_info(space_id)");
+	uint32_t id = lua_tointeger(L, 1);
+	struct space *space = space_by_id(id);
+	if (space == NULL || space->upgrade == NULL) {
+		lua_pushnil(L);
+		return 1;
+	}
+	struct space_upgrade *upgrade = space->upgrade;
+	lua_newtable(L);
+
+	lua_pushstring(L, space_upgrade_status_strs[upgrade->status]);
+	lua_setfield(L, -2, "status");
+
+	uint32_t func_id = space_upgrade_def_func_id(upgrade->def);
+	struct func *func = func_id != 0 ? func_by_id(func_id) : NULL;
+	if (func != NULL) {
+		lua_pushstring(L, func->def->name);
+		lua_setfield(L, -2, "func");
+	}
+
+	const struct tt_uuid *owner = space_upgrade_def_owner(upgrade->def);
+	if (!tt_uuid_is_nil(owner)) {
+		luaT_pushuuidstr(L, owner);
+		lua_setfield(L, -2, "owner");
+	}
+
+	double rate = space_upgrade_def_rate(upgrade->def);
+	if (rate > 0) {
+		lua_pushnumber(L, rate);
+		lua_setfield(L, -2, "rate");
+	}
+
+	lua_pushnumber(L, upgrade->processed);
+	lua_setfield(L, -2, "processed");
+
+	lua_pushnumber(L, upgrade->total);
+	lua_setfield(L, -2, "total");
+
+	if (upgrade->error != NULL) {
+		luaT_pusherror(L, upgrade->error);
+		lua_setfield(L, -2, "error");
+	}
+	return 1;
+}
+
 void
 box_lua_space_init(struct lua_State *L)
 {
@@ -1063,6 +1125,7 @@ box_lua_space_init(struct lua_State *L)
 	static const struct luaL_Reg space_internal_lib[] = {
 		{"frommap", lbox_space_frommap},
 		{"stat", lbox_space_stat},
+		{"upgrade_info", lbox_space_upgrade_info},
 		{NULL, NULL}
 	};
 	luaL_findtable(L, LUA_GLOBALSINDEX, "box.internal.space", 0);
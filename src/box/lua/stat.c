@@ -44,6 +44,7 @@
 #include "box/vinyl.h"
 #include "box/sql.h"
 #include "box/memtx_engine.h"
+#include "box/wal.h"
 #include "info/info.h"
 #include "lua/info.h"
 #include "lua/utils.h"
@@ -191,6 +192,16 @@ lbox_stat_memtx(struct lua_State *L)
 	return 1;
 }
 
+/* box.stat.wal() */
+static int
+lbox_stat_wal(struct lua_State *L)
+{
+	struct info_handler h;
+	luaT_info_handler_create(&h, L);
+	wal_stat(&h);
+	return 1;
+}
+
 /* box.stat.memtx.tx() */
 static int
 lbox_stat_memtx_tx(struct lua_State *L)
@@ -261,7 +272,8 @@ lbox_stat_net_index(struct lua_State *L)
  * - STREAMS: total, rps, current;
  * - REQUESTS: total, rps, current;
  * - REQUESTS_IN_PROGRESS: total, rps, current;
- * - REQUESTS_IN_STREAM_QUEUE: total, rps, current.
+ * - REQUESTS_IN_STREAM_QUEUE: total, rps, current;
+ * - READ_VIEW_REQUESTS: total, rps.
  *
  * These fields have the following meaning:
  *
@@ -367,6 +379,7 @@ box_lua_stat_init(struct lua_State *L)
 		{"vinyl", lbox_stat_vinyl},
 		{"reset", lbox_stat_reset},
 		{"sql", lbox_stat_sql},
+		{"wal", lbox_stat_wal},
 		{NULL, NULL}
 	};
 
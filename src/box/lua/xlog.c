@@ -116,6 +116,8 @@ lbox_xlog_parse_body_kv(struct lua_State *L, int type, const char **beg)
 		lbox_xlog_pushkey(L, vy_page_info_key_name(v));
 	} else if (type == VY_RUN_ROW_INDEX && vy_row_index_key_name(v)) {
 		lbox_xlog_pushkey(L, vy_row_index_key_name(v));
+	} else if (type == VY_RUN_COLUMN && vy_column_key_name(v)) {
+		lbox_xlog_pushkey(L, vy_column_key_name(v));
 	} else {
 		lua_pushinteger(L, v); /* unknown key */
 	}
@@ -400,6 +402,10 @@ lbox_xlog_parser_open_meta(struct lua_State *L)
 	luaT_pushvclock(L, &cur->meta.prev_vclock);
 	lua_settable(L, -3);
 
+	lua_pushstring(L, "base_vclock");
+	luaT_pushvclock(L, &cur->meta.base_vclock);
+	lua_settable(L, -3);
+
 	xlog_cursor_close(cur, false);
 	free(cur);
 	return 1;
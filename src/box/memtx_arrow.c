@@ -0,0 +1,1518 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2025, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "memtx_arrow.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <msgpuck.h>
+
+#include "arrow/abi.h"
+#include "arrow_options.h"
+#include "assoc.h"
+#include "coll/coll.h"
+#include "coll_id.h"
+#include "coll_id_cache.h"
+#include "datetime.h"
+#include "decimal.h"
+#include "diag.h"
+#include "errcode.h"
+#include "fiber.h"
+#include "field_def.h"
+#include "index.h"
+#include "key_def.h"
+#include "memtx_engine.h"
+#include "memtx_tuple_compression.h"
+#include "mp_datetime.h"
+#include "mp_decimal.h"
+#include "mp_extension_types.h"
+#include "read_view.h"
+#include "schema.h"
+#include "small/region.h"
+#include "space.h"
+#include "tuple.h"
+#include "tuple_format.h"
+#include "trivia/util.h"
+#include "tt_static.h"
+
+/** Physical layout of an Arrow column. */
+enum memtx_arrow_layout {
+	/** Fixed-size values: validity bitmap and values buffers. */
+	MEMTX_ARROW_LAYOUT_FIXED,
+	/** Bit-packed booleans: validity bitmap and values buffers. */
+	MEMTX_ARROW_LAYOUT_BOOL,
+	/** Variable-size values: validity, int32 offsets and data buffers. */
+	MEMTX_ARROW_LAYOUT_BINARY,
+};
+
+/** Arrow representation of a field type. */
+struct memtx_arrow_type {
+	/** Column layout. */
+	enum memtx_arrow_layout layout;
+	/**
+	 * Arrow format string or NULL if it depends on the field type
+	 * parameters (fixed point decimals).
+	 */
+	const char *format;
+	/** Size of a value in bytes, for the fixed-size layout only. */
+	size_t value_size;
+};
+
+/**
+ * Field types that don't have an Arrow counterpart (any, number, scalar,
+ * interval, array, map) are returned as binary columns of raw MsgPack
+ * values. Arbitrary precision decimals are returned as strings.
+ */
+static const struct memtx_arrow_type memtx_arrow_types[field_type_MAX] = {
+	[FIELD_TYPE_ANY] = {MEMTX_ARROW_LAYOUT_BINARY, "z", 0},
+	[FIELD_TYPE_UNSIGNED] = {MEMTX_ARROW_LAYOUT_FIXED, "L", 8},
+	[FIELD_TYPE_STRING] = {MEMTX_ARROW_LAYOUT_BINARY, "u", 0},
+	[FIELD_TYPE_NUMBER] = {MEMTX_ARROW_LAYOUT_BINARY, "z", 0},
+	[FIELD_TYPE_DOUBLE] = {MEMTX_ARROW_LAYOUT_FIXED, "g", 8},
+	[FIELD_TYPE_INTEGER] = {MEMTX_ARROW_LAYOUT_FIXED, "l", 8},
+	[FIELD_TYPE_BOOLEAN] = {MEMTX_ARROW_LAYOUT_BOOL, "b", 0},
+	[FIELD_TYPE_VARBINARY] = {MEMTX_ARROW_LAYOUT_BINARY, "z", 0},
+	[FIELD_TYPE_SCALAR] = {MEMTX_ARROW_LAYOUT_BINARY, "z", 0},
+	[FIELD_TYPE_DECIMAL] = {MEMTX_ARROW_LAYOUT_BINARY, "u", 0},
+	[FIELD_TYPE_UUID] = {MEMTX_ARROW_LAYOUT_FIXED, "w:16", 16},
+	[FIELD_TYPE_DATETIME] = {MEMTX_ARROW_LAYOUT_FIXED, "tsn:UTC", 8},
+	[FIELD_TYPE_INTERVAL] = {MEMTX_ARROW_LAYOUT_BINARY, "z", 0},
+	[FIELD_TYPE_ARRAY] = {MEMTX_ARROW_LAYOUT_BINARY, "z", 0},
+	[FIELD_TYPE_MAP] = {MEMTX_ARROW_LAYOUT_BINARY, "z", 0},
+	[FIELD_TYPE_INT8] = {MEMTX_ARROW_LAYOUT_FIXED, "c", 1},
+	[FIELD_TYPE_UINT8] = {MEMTX_ARROW_LAYOUT_FIXED, "C", 1},
+	[FIELD_TYPE_INT16] = {MEMTX_ARROW_LAYOUT_FIXED, "s", 2},
+	[FIELD_TYPE_UINT16] = {MEMTX_ARROW_LAYOUT_FIXED, "S", 2},
+	[FIELD_TYPE_INT32] = {MEMTX_ARROW_LAYOUT_FIXED, "i", 4},
+	[FIELD_TYPE_UINT32] = {MEMTX_ARROW_LAYOUT_FIXED, "I", 4},
+	[FIELD_TYPE_INT64] = {MEMTX_ARROW_LAYOUT_FIXED, "l", 8},
+	[FIELD_TYPE_UINT64] = {MEMTX_ARROW_LAYOUT_FIXED, "L", 8},
+	[FIELD_TYPE_FLOAT32] = {MEMTX_ARROW_LAYOUT_FIXED, "f", 4},
+	[FIELD_TYPE_FLOAT64] = {MEMTX_ARROW_LAYOUT_FIXED, "g", 8},
+	[FIELD_TYPE_DECIMAL32] = {MEMTX_ARROW_LAYOUT_FIXED, NULL, 16},
+	[FIELD_TYPE_DECIMAL64] = {MEMTX_ARROW_LAYOUT_FIXED, NULL, 16},
+	[FIELD_TYPE_DECIMAL128] = {MEMTX_ARROW_LAYOUT_FIXED, NULL, 16},
+	[FIELD_TYPE_DECIMAL256] = {MEMTX_ARROW_LAYOUT_FIXED, NULL, 32},
+};
+
+/** A column returned by the stream. */
+struct memtx_arrow_column {
+	/** Number of the tuple field the column is built from. */
+	uint32_t fieldno;
+	/** Type of the field. */
+	enum field_type type;
+	/** Set if the field is nullable. */
+	bool is_nullable;
+	/** Scale of a fixed point decimal field. */
+	int64_t scale;
+	/**
+	 * Set if the column is dictionary-encoded: its values are int32
+	 * indexes into a dictionary of the distinct values of a record
+	 * batch. Only string columns may be dictionary-encoded.
+	 */
+	bool use_dictionary;
+	/** Slot of the field in memtx_arrow_stream::fields. */
+	uint32_t slot;
+	/** Name of the field or an empty string if it has no name. */
+	char *name;
+	/** Arrow format string of the column. */
+	char *format;
+};
+
+/** Representation of the field values a predicate is evaluated on. */
+enum memtx_arrow_predicate_kind {
+	/** Integers, decoded into a vector of int64_t. */
+	MEMTX_ARROW_PREDICATE_INT,
+	/** Floating point numbers, decoded into a vector of double. */
+	MEMTX_ARROW_PREDICATE_DOUBLE,
+	/**
+	 * Strings, compared with the predicate value in place. The
+	 * results of comparison are stored in a vector of int64_t.
+	 */
+	MEMTX_ARROW_PREDICATE_STR,
+};
+
+/** A predicate filtering rows returned by the stream. */
+struct memtx_arrow_predicate {
+	/** Field the predicate is evaluated on. */
+	struct memtx_arrow_column column;
+	/** Comparison operator. */
+	enum box_arrow_predicate_op op;
+	/** Representation of the field values. */
+	enum memtx_arrow_predicate_kind kind;
+	/** Value of an integer predicate. */
+	int64_t ival;
+	/** Value of a floating point predicate. */
+	double dval;
+	/** Value of a string predicate, allocated. */
+	char *str;
+	/** Length of the string value. */
+	uint32_t str_len;
+	/** Collation of a string field, referenced, or NULL. */
+	struct coll *coll;
+};
+
+/** Private data of a memtx index Arrow stream. */
+struct memtx_arrow_stream {
+	/** Iterator over the index, NULL for a stream over a read view. */
+	struct iterator *it;
+	/** Index read view, NULL for a stream over an index. */
+	struct index_read_view *rv;
+	/** Iterator over the index read view. */
+	struct index_read_view_iterator rv_it;
+	/** Number of tuples in the index read view. */
+	size_t rv_size;
+	/** Max number of rows in a record batch. */
+	uint32_t batch_row_count;
+	/** Error of the last failed stream operation or NULL. */
+	struct error *last_error;
+	/**
+	 * Fields of the fetched rows. Every field returned or tested by
+	 * the stream has a slot, and the field in the slot @a s of the
+	 * row @a r is stored at r * slot_count + s. A field is NULL if
+	 * the tuple doesn't have it.
+	 */
+	const char **fields;
+	/** Number of fields accessed by the stream. */
+	uint32_t slot_count;
+	/** Field number of each slot. */
+	uint32_t *slot_fieldnos;
+	/** Slot of each field or UINT32_MAX, indexed by field number. */
+	uint32_t *field_slots;
+	/** Max accessed field number + 1. */
+	uint32_t field_count;
+	/**
+	 * Referenced tuples of the fetched rows, for a stream over an
+	 * index only. The fields point to the tuple data so the tuples
+	 * must live until the record batch is built.
+	 */
+	struct tuple **tuples;
+	/** Number of referenced tuples. */
+	uint32_t tuple_count;
+	/** Flags of the fetched rows satisfying all the predicates. */
+	uint8_t *selected;
+	/** Values of a predicate field of the fetched rows. */
+	void *values;
+	/** Number of rows the buffers above are allocated for. */
+	uint32_t row_capacity;
+	/** Index of the distinct values of a dictionary column. */
+	struct mh_strnu32_t *dict_hash;
+	/** Number of predicates. */
+	uint32_t predicate_count;
+	/** Predicates a row must satisfy to be returned. */
+	struct memtx_arrow_predicate *predicates;
+	/** Number of columns in a record batch. */
+	uint32_t column_count;
+	/** Columns of a record batch. */
+	struct memtx_arrow_column columns[];
+};
+
+/** Private data of a column array of a record batch. */
+struct memtx_arrow_column_data {
+	/** Validity bitmap, values or offsets and data buffers. */
+	void *buffers[3];
+	/** Size of the data buffer, for the binary layout only. */
+	size_t data_size;
+	/** Allocated size of the data buffer. */
+	size_t data_capacity;
+	/** Dictionary of a dictionary-encoded column or NULL. */
+	struct ArrowArray *dictionary;
+};
+
+/** Private data of the struct array of a record batch. */
+struct memtx_arrow_batch {
+	/** Buffers of the struct array: no validity bitmap. */
+	const void *buffers[1];
+	/** Pointers to column arrays. */
+	struct ArrowArray **children;
+	/** Column arrays. */
+	struct ArrowArray *columns;
+};
+
+static inline void
+memtx_arrow_bit_set(uint8_t *bitmap, uint32_t i)
+{
+	bitmap[i / 8] |= 1 << (i % 8);
+}
+
+/**
+ * Initialize a column built from a field of the given type. The column
+ * is dictionary-encoded if @a use_dictionary is set and the field is
+ * a string.
+ */
+static void
+memtx_arrow_column_create(struct memtx_arrow_column *column,
+			  uint32_t fieldno, enum field_type type,
+			  int64_t scale, bool is_nullable, const char *name,
+			  bool use_dictionary)
+{
+	column->fieldno = fieldno;
+	column->type = type;
+	/* A field of type any may store nil even if it isn't nullable. */
+	column->is_nullable = is_nullable || type == FIELD_TYPE_ANY;
+	column->scale = scale;
+	column->use_dictionary = use_dictionary && type == FIELD_TYPE_STRING;
+	column->slot = 0;
+	column->name = xstrdup(name != NULL ? name : "");
+	const char *format = memtx_arrow_types[type].format;
+	if (column->use_dictionary) {
+		/* Indexes, the dictionary is described by the schema. */
+		format = "i";
+	} else if (format == NULL) {
+		assert(field_type_is_fixed_decimal[type]);
+		format = tt_sprintf("d:%d,%lld%s",
+				    field_type_decimal_precision[type],
+				    (long long)scale,
+				    type == FIELD_TYPE_DECIMAL256 ? ",256" : "");
+	}
+	column->format = xstrdup(format);
+}
+
+static void
+memtx_arrow_column_destroy(struct memtx_arrow_column *column)
+{
+	free(column->name);
+	free(column->format);
+}
+
+static void
+memtx_arrow_column_array_release(struct ArrowArray *array)
+{
+	struct memtx_arrow_column_data *data = array->private_data;
+	for (int i = 0; i < (int)lengthof(data->buffers); i++)
+		free(data->buffers[i]);
+	if (data->dictionary != NULL) {
+		/* The consumer may have moved the dictionary. */
+		if (data->dictionary->release != NULL)
+			data->dictionary->release(data->dictionary);
+		free(data->dictionary);
+	}
+	free(data);
+	array->release = NULL;
+}
+
+/**
+ * Allocate an array of the given layout for at most @a capacity rows.
+ * @a value_size is the size of a value of the fixed-size layout.
+ */
+static void
+memtx_arrow_array_create(struct ArrowArray *array,
+			 enum memtx_arrow_layout layout, size_t value_size,
+			 uint32_t capacity)
+{
+	struct memtx_arrow_column_data *data = xcalloc(1, sizeof(*data));
+	size_t bitmap_size = DIV_ROUND_UP(capacity, 8);
+	data->buffers[0] = xcalloc(bitmap_size, 1);
+	switch (layout) {
+	case MEMTX_ARROW_LAYOUT_FIXED:
+		data->buffers[1] = xcalloc(capacity, value_size);
+		break;
+	case MEMTX_ARROW_LAYOUT_BOOL:
+		data->buffers[1] = xcalloc(bitmap_size, 1);
+		break;
+	case MEMTX_ARROW_LAYOUT_BINARY:
+		data->buffers[1] = xcalloc(capacity + 1, sizeof(int32_t));
+		data->data_capacity = 16 * (size_t)capacity;
+		data->buffers[2] = xmalloc(data->data_capacity);
+		break;
+	default:
+		unreachable();
+	}
+	memset(array, 0, sizeof(*array));
+	array->n_buffers = layout == MEMTX_ARROW_LAYOUT_BINARY ? 3 : 2;
+	array->buffers = (const void **)data->buffers;
+	array->release = memtx_arrow_column_array_release;
+	array->private_data = data;
+}
+
+/** Allocate a column array for at most @a capacity rows. */
+static void
+memtx_arrow_column_array_create(struct ArrowArray *array,
+				const struct memtx_arrow_column *column,
+				uint32_t capacity)
+{
+	if (!column->use_dictionary) {
+		const struct memtx_arrow_type *type =
+			&memtx_arrow_types[column->type];
+		memtx_arrow_array_create(array, type->layout,
+					 type->value_size, capacity);
+		return;
+	}
+	memtx_arrow_array_create(array, MEMTX_ARROW_LAYOUT_FIXED,
+				 sizeof(int32_t), capacity);
+	struct memtx_arrow_column_data *data = array->private_data;
+	/* There may be as many distinct values as there are rows. */
+	data->dictionary = xmalloc(sizeof(*data->dictionary));
+	memtx_arrow_array_create(data->dictionary, MEMTX_ARROW_LAYOUT_BINARY,
+				 0, capacity);
+	array->dictionary = data->dictionary;
+}
+
+/** Append a variable-size value to a column array as the row @a row. */
+static int
+memtx_arrow_column_append_data(struct memtx_arrow_column_data *data,
+			       uint32_t row, const char *str, uint32_t len)
+{
+	int32_t *offsets = data->buffers[1];
+	if (data->data_size + len > INT32_MAX) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Arrow stream",
+			 "record batches with more than 2GB of data "
+			 "in a column");
+		return -1;
+	}
+	if (data->data_size + len > data->data_capacity) {
+		size_t capacity = data->data_capacity * 2;
+		if (capacity < data->data_size + len)
+			capacity = data->data_size + len;
+		data->buffers[2] = xrealloc(data->buffers[2], capacity);
+		data->data_capacity = capacity;
+	}
+	memcpy((char *)data->buffers[2] + data->data_size, str, len);
+	data->data_size += len;
+	offsets[row + 1] = data->data_size;
+	return 0;
+}
+
+/**
+ * Append a string to a dictionary column array as the row @a row.
+ * @a dict_hash maps the strings already stored in the dictionary to
+ * their indexes. It references the appended strings so they must
+ * live until the column is built.
+ */
+static int
+memtx_arrow_column_append_dict(struct memtx_arrow_column_data *data,
+			       struct mh_strnu32_t *dict_hash, uint32_t row,
+			       const char *str, uint32_t len)
+{
+	struct ArrowArray *dictionary = data->dictionary;
+	uint32_t hash = mh_strn_hash(str, len);
+	struct mh_strnu32_key_t key = {str, len, hash};
+	mh_int_t k = mh_strnu32_find(dict_hash, &key, NULL);
+	uint32_t index;
+	if (k != mh_end(dict_hash)) {
+		index = mh_strnu32_node(dict_hash, k)->val;
+	} else {
+		index = dictionary->length;
+		if (memtx_arrow_column_append_data(dictionary->private_data,
+						   index, str, len) != 0)
+			return -1;
+		dictionary->length++;
+		struct mh_strnu32_node_t node = {str, len, hash, index};
+		mh_strnu32_put(dict_hash, &node, NULL, NULL);
+	}
+	((int32_t *)data->buffers[1])[row] = index;
+	return 0;
+}
+
+/**
+ * Store a decimal as an Arrow fixed point decimal of @a size bytes:
+ * a two's complement integer equal to the value multiplied by
+ * 10^@a scale. The value must fit the field type, which is checked
+ * when a tuple is inserted.
+ */
+static void
+memtx_arrow_decimal_store(const decimal_t *dec, int64_t scale,
+			  char *out, size_t size)
+{
+	/* The integer is built in 32-bit limbs, least significant first. */
+	uint32_t limbs[8];
+	uint32_t limb_count = size / sizeof(limbs[0]);
+	assert(limb_count <= lengthof(limbs));
+	memset(limbs, 0, sizeof(limbs));
+	uint8_t digits[DECIMAL_MAX_DIGITS];
+	assert(dec->digits <= DECIMAL_MAX_DIGITS);
+	decNumberGetBCD(dec, digits);
+	/*
+	 * The value is the coefficient multiplied by 10^exponent. Digits
+	 * below the scale are zero in values that fit the field type.
+	 */
+	int64_t digit_count = dec->digits;
+	int64_t shift = dec->exponent + scale;
+	if (shift < 0) {
+		digit_count = MAX(digit_count + shift, 0);
+		shift = 0;
+	}
+	for (int64_t i = 0; i < digit_count + shift; i++) {
+		uint64_t carry = i < digit_count ? digits[i] : 0;
+		for (uint32_t j = 0; j < limb_count; j++) {
+			carry += (uint64_t)limbs[j] * 10;
+			limbs[j] = carry;
+			carry >>= 32;
+		}
+	}
+	if (decNumberIsNegative(dec)) {
+		uint64_t carry = 1;
+		for (uint32_t j = 0; j < limb_count; j++) {
+			carry += (uint32_t)~limbs[j];
+			limbs[j] = carry;
+			carry >>= 32;
+		}
+	}
+	/* Arrow decimals are stored in the native (little-endian) order. */
+	memcpy(out, limbs, size);
+}
+
+/** Field path used in error messages, allocated on the static buffer. */
+static const char *
+memtx_arrow_column_path(const struct memtx_arrow_column *column)
+{
+	uint32_t fieldno = column->fieldno + TUPLE_INDEX_BASE;
+	if (*column->name == '\0')
+		return int2str(fieldno);
+	return tt_sprintf("%u (%s)", fieldno, column->name);
+}
+
+/**
+ * Check that a non-null field value can be stored in a column. Values
+ * fetched from a read view aren't necessarily validated against the
+ * space format the columns were built from, so they must be checked
+ * before decoding. Returns 0 on success, -1 and sets diag on error.
+ */
+static int
+memtx_arrow_column_check(const struct memtx_arrow_column *column,
+			 const char *field)
+{
+	if (!field_mp_type_is_compatible(column->type, field, false)) {
+		diag_set(ClientError, ER_FIELD_TYPE,
+			 memtx_arrow_column_path(column),
+			 field_type_strs[column->type],
+			 mp_type_strs[mp_typeof(*field)]);
+		return -1;
+	}
+	if (field_type_is_fixed_int(column->type)) {
+		const char *details;
+		char mp_min[16], mp_max[16];
+		if (!field_mp_is_in_fixed_int_range(column->type, field,
+						    mp_min, mp_max,
+						    &details)) {
+			diag_set(ClientError, ER_FIELD_VALUE_OUT_OF_RANGE,
+				 memtx_arrow_column_path(column),
+				 field_type_strs[column->type], details,
+				 field, mp_min, mp_max);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Append a field value to a column array as the row @a row.
+ * @a field is NULL if the tuple has no such field. @a dict_hash
+ * is used for dictionary-encoded columns only, see
+ * memtx_arrow_column_append_dict().
+ */
+static int
+memtx_arrow_column_append(struct ArrowArray *array,
+			  const struct memtx_arrow_column *column,
+			  struct mh_strnu32_t *dict_hash,
+			  uint32_t row, const char *field)
+{
+	struct memtx_arrow_column_data *data = array->private_data;
+	const struct memtx_arrow_type *type = &memtx_arrow_types[column->type];
+	if (field == NULL || mp_typeof(*field) == MP_NIL) {
+		array->null_count++;
+		if (type->layout == MEMTX_ARROW_LAYOUT_BINARY &&
+		    !column->use_dictionary) {
+			int32_t *offsets = data->buffers[1];
+			offsets[row + 1] = offsets[row];
+		}
+		return 0;
+	}
+	if (memtx_arrow_column_check(column, field) != 0)
+		return -1;
+	memtx_arrow_bit_set(data->buffers[0], row);
+	void *values = data->buffers[1];
+	int64_t ival;
+	double dval;
+	const char *str;
+	uint32_t len;
+	switch (column->type) {
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_UINT64:
+		((uint64_t *)values)[row] = mp_decode_uint(&field);
+		break;
+	case FIELD_TYPE_UINT32:
+		((uint32_t *)values)[row] = mp_decode_uint(&field);
+		break;
+	case FIELD_TYPE_UINT16:
+		((uint16_t *)values)[row] = mp_decode_uint(&field);
+		break;
+	case FIELD_TYPE_UINT8:
+		((uint8_t *)values)[row] = mp_decode_uint(&field);
+		break;
+	case FIELD_TYPE_INTEGER:
+	case FIELD_TYPE_INT64:
+	case FIELD_TYPE_INT32:
+	case FIELD_TYPE_INT16:
+	case FIELD_TYPE_INT8:
+		if (mp_read_int64(&field, &ival) != 0) {
+			diag_set(ClientError, ER_UNSUPPORTED, "Arrow stream",
+				 "integer values greater than INT64_MAX");
+			return -1;
+		}
+		if (type->value_size == 8)
+			((int64_t *)values)[row] = ival;
+		else if (type->value_size == 4)
+			((int32_t *)values)[row] = ival;
+		else if (type->value_size == 2)
+			((int16_t *)values)[row] = ival;
+		else
+			((int8_t *)values)[row] = ival;
+		break;
+	case FIELD_TYPE_DOUBLE:
+	case FIELD_TYPE_FLOAT64:
+		VERIFY(mp_read_double_lossy(&field, &dval) == 0);
+		((double *)values)[row] = dval;
+		break;
+	case FIELD_TYPE_FLOAT32:
+		VERIFY(mp_read_double_lossy(&field, &dval) == 0);
+		((float *)values)[row] = dval;
+		break;
+	case FIELD_TYPE_BOOLEAN:
+		if (mp_decode_bool(&field))
+			memtx_arrow_bit_set(values, row);
+		break;
+	case FIELD_TYPE_STRING:
+		str = mp_decode_str(&field, &len);
+		if (column->use_dictionary)
+			return memtx_arrow_column_append_dict(data, dict_hash,
+							      row, str, len);
+		return memtx_arrow_column_append_data(data, row, str, len);
+	case FIELD_TYPE_VARBINARY:
+		str = mp_decode_bin(&field, &len);
+		return memtx_arrow_column_append_data(data, row, str, len);
+	case FIELD_TYPE_DECIMAL: {
+		decimal_t dec;
+		char buf[DECIMAL_MAX_STR_LEN + 1];
+		VERIFY(mp_decode_decimal(&field, &dec) != NULL);
+		decimal_to_string(&dec, buf);
+		return memtx_arrow_column_append_data(data, row, buf,
+						      strlen(buf));
+	}
+	case FIELD_TYPE_UUID: {
+		int8_t ext_type;
+		len = mp_decode_extl(&field, &ext_type);
+		assert(ext_type == MP_UUID && len == type->value_size);
+		(void)ext_type;
+		/* MsgPack stores UUIDs in the RFC 4122 byte order. */
+		memcpy((char *)values + row * type->value_size, field, len);
+		break;
+	}
+	case FIELD_TYPE_DATETIME: {
+		struct datetime date;
+		VERIFY(mp_decode_datetime(&field, &date) != NULL);
+		/* Nanoseconds since Epoch, the timezone is dropped. */
+		const int64_t ns_per_sec = 1000000000;
+		if (date.epoch < INT64_MIN / ns_per_sec + 1 ||
+		    date.epoch > INT64_MAX / ns_per_sec - 1) {
+			diag_set(ClientError, ER_UNSUPPORTED, "Arrow stream",
+				 "datetime values out of the range of "
+				 "nanosecond timestamps");
+			return -1;
+		}
+		((int64_t *)values)[row] =
+			(int64_t)date.epoch * ns_per_sec + date.nsec;
+		break;
+	}
+	case FIELD_TYPE_DECIMAL32:
+	case FIELD_TYPE_DECIMAL64:
+	case FIELD_TYPE_DECIMAL128:
+	case FIELD_TYPE_DECIMAL256: {
+		decimal_t dec;
+		VERIFY(mp_decode_decimal(&field, &dec) != NULL);
+		memtx_arrow_decimal_store(
+			&dec, column->scale,
+			(char *)values + row * type->value_size,
+			type->value_size);
+		break;
+	}
+	case FIELD_TYPE_ANY:
+	case FIELD_TYPE_NUMBER:
+	case FIELD_TYPE_SCALAR:
+	case FIELD_TYPE_INTERVAL:
+	case FIELD_TYPE_ARRAY:
+	case FIELD_TYPE_MAP:
+		str = field;
+		mp_next(&field);
+		return memtx_arrow_column_append_data(data, row, str,
+						      field - str);
+	default:
+		unreachable();
+	}
+	return 0;
+}
+
+/** Finalize a column array after the last row was appended. */
+static void
+memtx_arrow_column_finish(struct ArrowArray *array, uint32_t row_count)
+{
+	struct memtx_arrow_column_data *data = array->private_data;
+	array->length = row_count;
+	if (array->null_count == 0) {
+		free(data->buffers[0]);
+		data->buffers[0] = NULL;
+	}
+	if (data->dictionary != NULL) {
+		memtx_arrow_column_finish(data->dictionary,
+					  data->dictionary->length);
+	}
+}
+
+static void
+memtx_arrow_batch_release(struct ArrowArray *array)
+{
+	struct memtx_arrow_batch *batch = array->private_data;
+	for (int64_t i = 0; i < array->n_children; i++) {
+		struct ArrowArray *child = batch->children[i];
+		if (child->release != NULL)
+			child->release(child);
+	}
+	free(batch);
+	array->release = NULL;
+}
+
+/** Allocate a record batch for at most @a capacity rows. */
+static void
+memtx_arrow_batch_create(struct ArrowArray *array,
+			 struct memtx_arrow_stream *stream, uint32_t capacity)
+{
+	uint32_t n = stream->column_count;
+	struct memtx_arrow_batch *batch =
+		xmalloc(sizeof(*batch) + n * sizeof(batch->children[0]) +
+			n * sizeof(batch->columns[0]));
+	batch->buffers[0] = NULL;
+	batch->children = (struct ArrowArray **)(batch + 1);
+	batch->columns = (struct ArrowArray *)(batch->children + n);
+	for (uint32_t i = 0; i < n; i++) {
+		batch->children[i] = &batch->columns[i];
+		memtx_arrow_column_array_create(&batch->columns[i],
+						&stream->columns[i], capacity);
+	}
+	memset(array, 0, sizeof(*array));
+	array->n_buffers = 1;
+	array->n_children = n;
+	array->buffers = batch->buffers;
+	array->children = batch->children;
+	array->release = memtx_arrow_batch_release;
+	array->private_data = batch;
+}
+
+/** Remember the current diag error as the last error of the stream. */
+static int
+memtx_arrow_stream_set_error(struct memtx_arrow_stream *stream)
+{
+	struct error *e = diag_last_error(diag_get());
+	assert(e != NULL);
+	error_ref(e);
+	if (stream->last_error != NULL)
+		error_unref(stream->last_error);
+	stream->last_error = e;
+	return EIO;
+}
+
+static void
+memtx_arrow_schema_release(struct ArrowSchema *schema)
+{
+	for (int64_t i = 0; i < schema->n_children; i++) {
+		struct ArrowSchema *child = schema->children[i];
+		free((char *)child->format);
+		free((char *)child->name);
+	}
+	free(schema->private_data);
+	schema->release = NULL;
+}
+
+static void
+memtx_arrow_schema_release_child(struct ArrowSchema *schema)
+{
+	/* Children are freed by the parent. */
+	schema->release = NULL;
+}
+
+static int
+memtx_arrow_stream_get_schema(struct ArrowArrayStream *base,
+			      struct ArrowSchema *out)
+{
+	struct memtx_arrow_stream *stream = base->private_data;
+	uint32_t n = stream->column_count;
+	/*
+	 * Children pointers, schemas and schemas of dictionaries are
+	 * allocated in one chunk.
+	 */
+	struct ArrowSchema **children =
+		xmalloc(n * (sizeof(children[0]) + 2 * sizeof(*children[0])));
+	struct ArrowSchema *columns = (struct ArrowSchema *)(children + n);
+	struct ArrowSchema *dictionaries = columns + n;
+	for (uint32_t i = 0; i < n; i++) {
+		const struct memtx_arrow_column *column = &stream->columns[i];
+		struct ArrowSchema *child = &columns[i];
+		memset(child, 0, sizeof(*child));
+		child->format = xstrdup(column->format);
+		child->name = xstrdup(column->name);
+		child->flags = column->is_nullable ? ARROW_FLAG_NULLABLE : 0;
+		child->release = memtx_arrow_schema_release_child;
+		if (column->use_dictionary) {
+			struct ArrowSchema *dictionary = &dictionaries[i];
+			memset(dictionary, 0, sizeof(*dictionary));
+			dictionary->format = "u";
+			dictionary->name = "";
+			dictionary->release = memtx_arrow_schema_release_child;
+			child->dictionary = dictionary;
+		}
+		children[i] = child;
+	}
+	memset(out, 0, sizeof(*out));
+	out->format = "+s";
+	out->name = "";
+	out->n_children = n;
+	out->children = children;
+	out->release = memtx_arrow_schema_release;
+	out->private_data = children;
+	return 0;
+}
+
+/**
+ * Return the number of tuples in the index the stream iterates over
+ * or -1 if the index was dropped or altered.
+ */
+static ssize_t
+memtx_arrow_stream_size(struct memtx_arrow_stream *stream)
+{
+	if (stream->rv != NULL)
+		return stream->rv_size;
+	struct index *index = index_weak_ref_get_index(&stream->it->index_ref);
+	if (index == NULL)
+		return -1;
+	return index_size(index);
+}
+
+/** Allocate the buffers of fetched rows for at least @a capacity rows. */
+static void
+memtx_arrow_stream_reserve(struct memtx_arrow_stream *stream,
+			   uint32_t capacity)
+{
+	if (capacity <= stream->row_capacity)
+		return;
+	assert(stream->tuple_count == 0);
+	free(stream->fields);
+	free(stream->tuples);
+	free(stream->selected);
+	free(stream->values);
+	stream->fields = xmalloc((size_t)capacity *
+				 MAX(stream->slot_count, 1) *
+				 sizeof(stream->fields[0]));
+	stream->tuples = xmalloc(capacity * sizeof(stream->tuples[0]));
+	stream->selected = xmalloc(capacity);
+	/* Integer and floating point values are both 8 bytes long. */
+	static_assert(sizeof(int64_t) == sizeof(double),
+		      "predicate values must be of the same size");
+	stream->values = xmalloc(capacity * sizeof(int64_t));
+	stream->row_capacity = capacity;
+}
+
+/** Unreference the tuples of the fetched rows. */
+static void
+memtx_arrow_stream_release_rows(struct memtx_arrow_stream *stream)
+{
+	for (uint32_t i = 0; i < stream->tuple_count; i++)
+		tuple_unref(stream->tuples[i]);
+	stream->tuple_count = 0;
+}
+
+/**
+ * Fetch the next tuple and set pointers to its fields accessed by
+ * the stream in the row @a row of stream->fields. Sets @a eof if
+ * there are no more tuples.
+ */
+static int
+memtx_arrow_stream_next(struct memtx_arrow_stream *stream, uint32_t row,
+			bool *eof)
+{
+	const char **fields = stream->fields + (size_t)row * stream->slot_count;
+	if (stream->rv == NULL) {
+		struct tuple *tuple;
+		if (iterator_next_internal(stream->it, &tuple) != 0)
+			return -1;
+		*eof = tuple == NULL;
+		if (*eof)
+			return 0;
+		struct space *space =
+			index_weak_ref_get_space_checked(&stream->it->index_ref);
+		if (space->upgrade != NULL) {
+			/* The upgrade function needs the whole tuple. */
+			if (memtx_prepare_result_tuple(space, &tuple) != 0)
+				return -1;
+		}
+		tuple_ref(tuple);
+		stream->tuples[stream->tuple_count++] = tuple;
+		/* Decompress only the fields accessed by the stream. */
+		struct tuple_format *format = tuple_format(tuple);
+		for (uint32_t slot = 0; slot < stream->slot_count; slot++) {
+			uint32_t fieldno = stream->slot_fieldnos[slot];
+			fields[slot] = tuple_field(tuple, fieldno);
+			if (memtx_tuple_field_decompress(format, fieldno,
+							 &fields[slot]) != 0)
+				return -1;
+		}
+		return 0;
+	}
+	struct read_view_tuple tuple;
+	if (index_read_view_iterator_next_raw(&stream->rv_it, &tuple) != 0)
+		return -1;
+	*eof = tuple.data == NULL;
+	if (*eof)
+		return 0;
+	if (tuple.needs_upgrade) {
+		/* Streams over read views of upgraded spaces are rejected. */
+		diag_set(ClientError, ER_UNSUPPORTED, "Arrow stream in read view",
+			 "space upgrade");
+		return -1;
+	}
+	/* Read view tuples don't have a field map, decode fields in turn. */
+	for (uint32_t slot = 0; slot < stream->slot_count; slot++)
+		fields[slot] = NULL;
+	const char *data = tuple.data;
+	uint32_t count = mp_decode_array(&data);
+	count = MIN(count, stream->field_count);
+	for (uint32_t fieldno = 0; fieldno < count; fieldno++) {
+		uint32_t slot = stream->field_slots[fieldno];
+		if (slot != UINT32_MAX)
+			fields[slot] = data;
+		mp_next(&data);
+	}
+	return 0;
+}
+
+/**
+ * Fetch at most @a capacity rows. The number of fetched rows is
+ * returned in @a row_count, it's 0 at the end of the stream.
+ */
+static int
+memtx_arrow_stream_fetch(struct memtx_arrow_stream *stream,
+			 uint32_t capacity, uint32_t *row_count)
+{
+	memtx_arrow_stream_reserve(stream, capacity);
+	uint32_t count = 0;
+	while (count < capacity) {
+		bool eof;
+		if (memtx_arrow_stream_next(stream, count, &eof) != 0)
+			return -1;
+		if (eof)
+			break;
+		count++;
+	}
+	*row_count = count;
+	return 0;
+}
+
+/**
+ * Clear the flags in @a selected of the rows whose values in
+ * @a values don't satisfy the comparison with @a value. The loops
+ * have no branches so the compiler vectorizes them.
+ */
+#define MEMTX_ARROW_FILTER(op, values, value, selected, count) do {	\
+	switch (op) {							\
+	case BOX_ARROW_PREDICATE_EQ:					\
+		for (uint32_t i = 0; i < (count); i++)			\
+			(selected)[i] &= (values)[i] == (value);	\
+		break;							\
+	case BOX_ARROW_PREDICATE_NE:					\
+		for (uint32_t i = 0; i < (count); i++)			\
+			(selected)[i] &= (values)[i] != (value);	\
+		break;							\
+	case BOX_ARROW_PREDICATE_LT:					\
+		for (uint32_t i = 0; i < (count); i++)			\
+			(selected)[i] &= (values)[i] < (value);		\
+		break;							\
+	case BOX_ARROW_PREDICATE_LE:					\
+		for (uint32_t i = 0; i < (count); i++)			\
+			(selected)[i] &= (values)[i] <= (value);	\
+		break;							\
+	case BOX_ARROW_PREDICATE_GT:					\
+		for (uint32_t i = 0; i < (count); i++)			\
+			(selected)[i] &= (values)[i] > (value);		\
+		break;							\
+	case BOX_ARROW_PREDICATE_GE:					\
+		for (uint32_t i = 0; i < (count); i++)			\
+			(selected)[i] &= (values)[i] >= (value);	\
+		break;							\
+	default:							\
+		unreachable();						\
+	}								\
+} while (0)
+
+/**
+ * Clear the selected flags of the fetched rows that don't satisfy
+ * the predicate. The field values of the rows are decoded into a
+ * vector first, then the whole vector is compared with the predicate
+ * value. Rows that were filtered out by other predicates aren't
+ * decoded.
+ */
+static int
+memtx_arrow_predicate_eval(struct memtx_arrow_stream *stream,
+			   const struct memtx_arrow_predicate *predicate,
+			   uint32_t row_count)
+{
+	const struct memtx_arrow_column *column = &predicate->column;
+	uint8_t *selected = stream->selected;
+	int64_t *ivals = stream->values;
+	double *dvals = stream->values;
+	for (uint32_t row = 0; row < row_count; row++) {
+		const char *field = stream->fields[
+			(size_t)row * stream->slot_count + column->slot];
+		if (!selected[row] || field == NULL ||
+		    mp_typeof(*field) == MP_NIL) {
+			/* Nulls never satisfy a predicate. */
+			selected[row] = 0;
+			ivals[row] = 0;
+			continue;
+		}
+		if (memtx_arrow_column_check(column, field) != 0)
+			return -1;
+		switch (predicate->kind) {
+		case MEMTX_ARROW_PREDICATE_INT:
+			if (mp_read_int64(&field, &ivals[row]) != 0) {
+				diag_set(ClientError, ER_UNSUPPORTED,
+					 "Arrow stream",
+					 "integer values greater than "
+					 "INT64_MAX");
+				return -1;
+			}
+			break;
+		case MEMTX_ARROW_PREDICATE_DOUBLE:
+			VERIFY(mp_read_double_lossy(&field, &dvals[row]) == 0);
+			break;
+		case MEMTX_ARROW_PREDICATE_STR: {
+			uint32_t len;
+			const char *str = mp_decode_str(&field, &len);
+			int cmp;
+			if (predicate->coll != NULL) {
+				/* Compare the way the index would. */
+				cmp = predicate->coll->cmp(
+					str, len, predicate->str,
+					predicate->str_len, predicate->coll);
+				cmp = COMPARE_RESULT(cmp, 0);
+			} else {
+				cmp = memcmp(str, predicate->str,
+					     MIN(len, predicate->str_len));
+				if (cmp == 0) {
+					cmp = COMPARE_RESULT(
+						len, predicate->str_len);
+				}
+			}
+			ivals[row] = cmp;
+			break;
+		}
+		default:
+			unreachable();
+		}
+	}
+	switch (predicate->kind) {
+	case MEMTX_ARROW_PREDICATE_INT:
+		MEMTX_ARROW_FILTER(predicate->op, ivals, predicate->ival,
+				   selected, row_count);
+		break;
+	case MEMTX_ARROW_PREDICATE_DOUBLE:
+		MEMTX_ARROW_FILTER(predicate->op, dvals, predicate->dval,
+				   selected, row_count);
+		break;
+	case MEMTX_ARROW_PREDICATE_STR:
+		/* The values are the results of comparison. */
+		MEMTX_ARROW_FILTER(predicate->op, ivals, 0,
+				   selected, row_count);
+		break;
+	default:
+		unreachable();
+	}
+	return 0;
+}
+
+#undef MEMTX_ARROW_FILTER
+
+/**
+ * Select the fetched rows that satisfy all the predicates. The number
+ * of the selected rows is returned in @a selected_count.
+ */
+static int
+memtx_arrow_stream_filter(struct memtx_arrow_stream *stream,
+			  uint32_t row_count, uint32_t *selected_count)
+{
+	memset(stream->selected, 1, row_count);
+	if (stream->predicate_count == 0) {
+		*selected_count = row_count;
+		return 0;
+	}
+	for (uint32_t i = 0; i < stream->predicate_count; i++) {
+		if (memtx_arrow_predicate_eval(stream, &stream->predicates[i],
+					       row_count) != 0)
+			return -1;
+	}
+	uint32_t count = 0;
+	for (uint32_t row = 0; row < row_count; row++)
+		count += stream->selected[row];
+	*selected_count = count;
+	return 0;
+}
+
+/**
+ * Build a record batch of @a selected_count rows from the selected
+ * fetched rows. The batch is built column by column.
+ */
+static int
+memtx_arrow_stream_build_batch(struct memtx_arrow_stream *stream,
+			       uint32_t row_count, uint32_t selected_count,
+			       struct ArrowArray *out)
+{
+	struct ArrowArray batch;
+	memtx_arrow_batch_create(&batch, stream, selected_count);
+	for (uint32_t i = 0; i < stream->column_count; i++) {
+		const struct memtx_arrow_column *column = &stream->columns[i];
+		struct ArrowArray *array = batch.children[i];
+		if (column->use_dictionary)
+			mh_strnu32_clear(stream->dict_hash);
+		uint32_t batch_row = 0;
+		for (uint32_t row = 0; row < row_count; row++) {
+			if (!stream->selected[row])
+				continue;
+			const char *field = stream->fields[
+				(size_t)row * stream->slot_count + column->slot];
+			if (memtx_arrow_column_append(array, column,
+						      stream->dict_hash,
+						      batch_row, field) != 0) {
+				batch.release(&batch);
+				return -1;
+			}
+			batch_row++;
+		}
+		assert(batch_row == selected_count);
+		memtx_arrow_column_finish(array, selected_count);
+	}
+	batch.length = selected_count;
+	*out = batch;
+	return 0;
+}
+
+static int
+memtx_arrow_stream_get_next(struct ArrowArrayStream *base,
+			    struct ArrowArray *out)
+{
+	struct memtx_arrow_stream *stream = base->private_data;
+	ssize_t size = memtx_arrow_stream_size(stream);
+	if (size < 0) {
+		/* The index was dropped or altered. */
+		memset(out, 0, sizeof(*out));
+		return 0;
+	}
+	/*
+	 * Don't allocate more than the index may return so that a huge
+	 * batch row count doesn't waste memory on small spaces.
+	 */
+	uint32_t capacity = stream->batch_row_count;
+	if (size < (ssize_t)capacity)
+		capacity = MAX(size, 1);
+	/*
+	 * Tuples fetched from a read view and decompressed fields may be
+	 * allocated on the region. They must live until the batch is built.
+	 */
+	struct region *gc = &fiber()->gc;
+	size_t gc_svp = region_used(gc);
+	uint32_t row_count;
+	uint32_t selected_count;
+	do {
+		memtx_arrow_stream_release_rows(stream);
+		region_truncate(gc, gc_svp);
+		if (memtx_arrow_stream_fetch(stream, capacity,
+					     &row_count) != 0)
+			goto fail;
+		if (row_count == 0) {
+			/* End of stream. */
+			region_truncate(gc, gc_svp);
+			memset(out, 0, sizeof(*out));
+			return 0;
+		}
+		if (memtx_arrow_stream_filter(stream, row_count,
+					      &selected_count) != 0)
+			goto fail;
+		/* Don't return empty batches if no row matched. */
+	} while (selected_count == 0);
+	if (memtx_arrow_stream_build_batch(stream, row_count, selected_count,
+					   out) != 0)
+		goto fail;
+	memtx_arrow_stream_release_rows(stream);
+	region_truncate(gc, gc_svp);
+	return 0;
+fail:
+	memtx_arrow_stream_release_rows(stream);
+	region_truncate(gc, gc_svp);
+	return memtx_arrow_stream_set_error(stream);
+}
+
+static const char *
+memtx_arrow_stream_get_last_error(struct ArrowArrayStream *base)
+{
+	struct memtx_arrow_stream *stream = base->private_data;
+	return stream->last_error != NULL ? stream->last_error->errmsg : NULL;
+}
+
+static void
+memtx_arrow_predicate_destroy(struct memtx_arrow_predicate *predicate)
+{
+	memtx_arrow_column_destroy(&predicate->column);
+	free(predicate->str);
+	if (predicate->coll != NULL)
+		coll_unref(predicate->coll);
+}
+
+/** Free a stream and the iterator it uses. */
+static void
+memtx_arrow_stream_delete(struct memtx_arrow_stream *stream)
+{
+	assert(stream->tuple_count == 0);
+	if (stream->rv != NULL)
+		index_read_view_iterator_destroy(&stream->rv_it);
+	else
+		iterator_delete(stream->it);
+	if (stream->last_error != NULL)
+		error_unref(stream->last_error);
+	for (uint32_t i = 0; i < stream->column_count; i++)
+		memtx_arrow_column_destroy(&stream->columns[i]);
+	for (uint32_t i = 0; i < stream->predicate_count; i++)
+		memtx_arrow_predicate_destroy(&stream->predicates[i]);
+	free(stream->predicates);
+	if (stream->dict_hash != NULL)
+		mh_strnu32_delete(stream->dict_hash);
+	free(stream->fields);
+	free(stream->slot_fieldnos);
+	free(stream->field_slots);
+	free(stream->tuples);
+	free(stream->selected);
+	free(stream->values);
+	free(stream);
+}
+
+static void
+memtx_arrow_stream_release(struct ArrowArrayStream *base)
+{
+	memtx_arrow_stream_delete(base->private_data);
+	base->release = NULL;
+}
+
+/**
+ * Initialize a predicate from its definition. The column of the
+ * predicate must be initialized by the caller. String fields are
+ * compared with @a coll if it isn't NULL. Returns -1 and sets diag
+ * if the predicate isn't supported for the field or the value
+ * doesn't match the field type.
+ */
+static int
+memtx_arrow_predicate_create(struct memtx_arrow_predicate *predicate,
+			     const struct arrow_predicate *def,
+			     struct coll *coll)
+{
+	const struct memtx_arrow_column *column = &predicate->column;
+	predicate->str = NULL;
+	predicate->str_len = 0;
+	predicate->coll = NULL;
+	predicate->ival = 0;
+	predicate->dval = 0;
+	if (def->op < 0 || def->op >= box_arrow_predicate_op_MAX) {
+		diag_set(IllegalParams, "Invalid predicate operator %d",
+			 def->op);
+		return -1;
+	}
+	predicate->op = def->op;
+	const char *value = def->value;
+	enum mp_type mp_type = mp_typeof(*value);
+	enum field_type type = column->type;
+	if (type == FIELD_TYPE_UNSIGNED || type == FIELD_TYPE_INTEGER ||
+	    field_type_is_fixed_int(type)) {
+		predicate->kind = MEMTX_ARROW_PREDICATE_INT;
+		if (mp_type != MP_UINT && mp_type != MP_INT)
+			goto mismatch;
+		if (mp_read_int64(&value, &predicate->ival) != 0) {
+			diag_set(ClientError, ER_UNSUPPORTED, "Arrow stream",
+				 "integer values greater than INT64_MAX");
+			return -1;
+		}
+	} else if (type == FIELD_TYPE_DOUBLE || type == FIELD_TYPE_FLOAT32 ||
+		   type == FIELD_TYPE_FLOAT64) {
+		predicate->kind = MEMTX_ARROW_PREDICATE_DOUBLE;
+		if (mp_read_double_lossy(&value, &predicate->dval) != 0)
+			goto mismatch;
+	} else if (type == FIELD_TYPE_STRING) {
+		predicate->kind = MEMTX_ARROW_PREDICATE_STR;
+		if (mp_type != MP_STR)
+			goto mismatch;
+		const char *str = mp_decode_str(&value, &predicate->str_len);
+		predicate->str = xmalloc(MAX(predicate->str_len, 1));
+		memcpy(predicate->str, str, predicate->str_len);
+		if (coll != NULL) {
+			coll_ref(coll);
+			predicate->coll = coll;
+		}
+	} else {
+		diag_set(ClientError, ER_UNSUPPORTED, "Arrow stream predicate",
+			 tt_sprintf("fields of type %s",
+				    field_type_strs[type]));
+		return -1;
+	}
+	return 0;
+mismatch:
+	diag_set(IllegalParams,
+		 "Invalid predicate value for field %s: expected %s, got %s",
+		 memtx_arrow_column_path(column), field_type_strs[type],
+		 mp_type_strs[mp_type]);
+	return -1;
+}
+
+/**
+ * Allocate a stream with @a column_count columns. The caller must set
+ * the row source, initialize the columns and the predicates, then call
+ * memtx_arrow_stream_create().
+ */
+static struct memtx_arrow_stream *
+memtx_arrow_stream_new(uint32_t column_count,
+		       const struct arrow_options *options)
+{
+	struct memtx_arrow_stream *s =
+		xcalloc(1, sizeof(*s) + column_count * sizeof(s->columns[0]));
+	s->batch_row_count = options->batch_row_count;
+	if (options->predicate_count > 0) {
+		s->predicates = xcalloc(options->predicate_count,
+					sizeof(s->predicates[0]));
+	}
+	s->column_count = column_count;
+	return s;
+}
+
+/** Assign a slot in the fetched rows to a field. */
+static uint32_t
+memtx_arrow_stream_slot(struct memtx_arrow_stream *s, uint32_t fieldno)
+{
+	if (s->field_slots[fieldno] == UINT32_MAX) {
+		s->field_slots[fieldno] = s->slot_count;
+		s->slot_fieldnos[s->slot_count++] = fieldno;
+	}
+	return s->field_slots[fieldno];
+}
+
+/** Set up the stream callbacks after the columns were initialized. */
+static void
+memtx_arrow_stream_create(struct memtx_arrow_stream *s,
+			  struct ArrowArrayStream *stream)
+{
+	bool use_dictionary = false;
+	for (uint32_t i = 0; i < s->column_count; i++) {
+		s->field_count = MAX(s->field_count, s->columns[i].fieldno + 1);
+		use_dictionary |= s->columns[i].use_dictionary;
+	}
+	for (uint32_t i = 0; i < s->predicate_count; i++) {
+		s->field_count = MAX(s->field_count,
+				     s->predicates[i].column.fieldno + 1);
+	}
+	s->field_slots = xmalloc(MAX(s->field_count, 1) *
+				 sizeof(s->field_slots[0]));
+	for (uint32_t i = 0; i < s->field_count; i++)
+		s->field_slots[i] = UINT32_MAX;
+	s->slot_fieldnos = xmalloc(MAX(s->column_count + s->predicate_count,
+				       1) * sizeof(s->slot_fieldnos[0]));
+	for (uint32_t i = 0; i < s->column_count; i++) {
+		struct memtx_arrow_column *column = &s->columns[i];
+		column->slot = memtx_arrow_stream_slot(s, column->fieldno);
+	}
+	for (uint32_t i = 0; i < s->predicate_count; i++) {
+		struct memtx_arrow_column *column = &s->predicates[i].column;
+		column->slot = memtx_arrow_stream_slot(s, column->fieldno);
+	}
+	if (use_dictionary)
+		s->dict_hash = mh_strnu32_new();
+	memset(stream, 0, sizeof(*stream));
+	stream->get_schema = memtx_arrow_stream_get_schema;
+	stream->get_next = memtx_arrow_stream_get_next;
+	stream->get_last_error = memtx_arrow_stream_get_last_error;
+	stream->release = memtx_arrow_stream_release;
+	stream->private_data = s;
+}
+
+/** Initialize a column built from a field of a space. */
+static void
+memtx_arrow_space_column_create(struct memtx_arrow_column *column,
+				struct space *space, uint32_t fieldno,
+				bool use_dictionary)
+{
+	struct tuple_field *field = tuple_format_field(space->format, fieldno);
+	const char *name = fieldno < space->def->field_count ?
+			   space->def->fields[fieldno].name : "";
+	if (field == NULL) {
+		memtx_arrow_column_create(column, fieldno, FIELD_TYPE_ANY, 0,
+					  true, name, use_dictionary);
+		return;
+	}
+	memtx_arrow_column_create(column, fieldno, field->type,
+				  field->type_params.scale,
+				  tuple_field_is_nullable(field), name,
+				  use_dictionary);
+}
+
+int
+memtx_index_create_arrow_stream(struct index *index,
+				uint32_t field_count, const uint32_t *fields,
+				const char *key, uint32_t part_count,
+				const struct arrow_options *options,
+				struct ArrowArrayStream *stream)
+{
+	struct space *space = space_by_id(index->def->space_id);
+	assert(space != NULL);
+	if (options->batch_row_count == 0) {
+		diag_set(IllegalParams, "batch row count must be positive");
+		return -1;
+	}
+	enum iterator_type type = part_count == 0 ? ITER_ALL : ITER_EQ;
+	struct iterator *it = index_create_iterator(index, type, key,
+						    part_count);
+	if (it == NULL)
+		return -1;
+	struct memtx_arrow_stream *s = memtx_arrow_stream_new(field_count,
+							      options);
+	s->it = it;
+	for (uint32_t i = 0; i < field_count; i++) {
+		memtx_arrow_space_column_create(&s->columns[i], space,
+						fields[i],
+						options->use_dictionary);
+	}
+	for (uint32_t i = 0; i < options->predicate_count; i++) {
+		const struct arrow_predicate *def = &options->predicates[i];
+		struct memtx_arrow_predicate *predicate = &s->predicates[i];
+		memtx_arrow_space_column_create(&predicate->column, space,
+						def->fieldno, false);
+		struct tuple_field *field =
+			tuple_format_field(space->format, def->fieldno);
+		struct coll *coll = field != NULL ? field->coll : NULL;
+		s->predicate_count++;
+		if (memtx_arrow_predicate_create(predicate, def, coll) != 0) {
+			memtx_arrow_stream_delete(s);
+			return -1;
+		}
+	}
+	memtx_arrow_stream_create(s, stream);
+	return 0;
+}
+
+/**
+ * Initialize a column built from a field of an index read view. The
+ * field type is taken from the space format. If the field isn't in
+ * the format, the type of the index key part is used, if any.
+ */
+static void
+memtx_arrow_read_view_column_create(struct memtx_arrow_column *column,
+				    struct index_read_view *rv,
+				    uint32_t fieldno, bool use_dictionary)
+{
+	struct space_read_view *space_rv = rv->space;
+	if (fieldno < space_rv->field_count) {
+		const struct field_def *def = &space_rv->fields[fieldno];
+		memtx_arrow_column_create(column, fieldno, def->type,
+					  def->type_params.scale,
+					  def->is_nullable, def->name,
+					  use_dictionary);
+		return;
+	}
+	enum field_type type = FIELD_TYPE_ANY;
+	bool is_nullable = true;
+	const struct key_def *key_def = rv->def->key_def;
+	for (uint32_t i = 0; i < key_def->part_count; i++) {
+		const struct key_part *part = &key_def->parts[i];
+		if (part->fieldno == fieldno && part->path == NULL &&
+		    !field_type_is_fixed_decimal[part->type]) {
+			type = part->type;
+			is_nullable = key_part_is_nullable(part);
+			break;
+		}
+	}
+	memtx_arrow_column_create(column, fieldno, type, 0, is_nullable, "",
+				  use_dictionary);
+}
+
+/**
+ * Return the collation of a field of an index read view or NULL.
+ * The collation is looked up the same way as the field type, see
+ * memtx_arrow_read_view_column_create().
+ */
+static struct coll *
+memtx_arrow_read_view_field_coll(struct index_read_view *rv,
+				 uint32_t fieldno)
+{
+	struct space_read_view *space_rv = rv->space;
+	if (fieldno < space_rv->field_count) {
+		uint32_t coll_id = space_rv->fields[fieldno].coll_id;
+		if (coll_id == COLL_NONE)
+			return NULL;
+		struct coll_id *id = coll_by_id(coll_id);
+		return id != NULL ? id->coll : NULL;
+	}
+	const struct key_def *key_def = rv->def->key_def;
+	for (uint32_t i = 0; i < key_def->part_count; i++) {
+		const struct key_part *part = &key_def->parts[i];
+		if (part->fieldno == fieldno && part->path == NULL)
+			return part->coll;
+	}
+	return NULL;
+}
+
+int
+memtx_index_read_view_create_arrow_stream(struct index_read_view *rv,
+					  size_t size, uint32_t field_count,
+					  const uint32_t *fields,
+					  const char *key, uint32_t part_count,
+					  const struct arrow_options *options,
+					  struct ArrowArrayStream *stream)
+{
+	(void)key;
+	if (options->batch_row_count == 0) {
+		diag_set(IllegalParams, "batch row count must be positive");
+		return -1;
+	}
+	if (part_count != 0) {
+		diag_set(ClientError, ER_UNSUPPORTED,
+			 "Arrow stream in read view", "keys");
+		return -1;
+	}
+	struct memtx_arrow_stream *s = memtx_arrow_stream_new(field_count,
+							      options);
+	if (index_read_view_create_iterator(rv, ITER_ALL, NULL, 0,
+					    &s->rv_it) != 0) {
+		free(s->predicates);
+		free(s);
+		return -1;
+	}
+	s->rv = rv;
+	s->rv_size = size;
+	for (uint32_t i = 0; i < field_count; i++) {
+		memtx_arrow_read_view_column_create(&s->columns[i], rv,
+						    fields[i],
+						    options->use_dictionary);
+	}
+	for (uint32_t i = 0; i < options->predicate_count; i++) {
+		const struct arrow_predicate *def = &options->predicates[i];
+		struct memtx_arrow_predicate *predicate = &s->predicates[i];
+		memtx_arrow_read_view_column_create(&predicate->column, rv,
+						    def->fieldno, false);
+		struct coll *coll = memtx_arrow_read_view_field_coll(
+			rv, def->fieldno);
+		s->predicate_count++;
+		if (memtx_arrow_predicate_create(predicate, def, coll) != 0) {
+			memtx_arrow_stream_delete(s);
+			return -1;
+		}
+	}
+	memtx_arrow_stream_create(s, stream);
+	return 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2025, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct index;
+struct index_read_view;
+struct arrow_options;
+struct ArrowArrayStream;
+
+/**
+ * Create an Arrow stream over a memtx index.
+ *
+ * The stream returns record batches of at most batch_row_count rows
+ * each. A batch is a struct array with a child per requested field,
+ * and every child is a plain column array built from the field values
+ * of the tuples in the index order. Only tuples matching the key with
+ * the EQ iterator semantics (all tuples if the key is empty) are
+ * returned.
+ *
+ * All field types are supported. Integer, floating point and boolean
+ * fields are returned as columns of the corresponding Arrow types,
+ * string and varbinary fields as string and binary columns, uuid as
+ * a fixed-size binary of 16 bytes, datetime as a nanosecond timestamp
+ * in UTC (the timezone is dropped), fixed point decimals as Arrow
+ * decimals of the same precision and scale and arbitrary precision
+ * decimals as strings. Fields of other types (any, number, scalar,
+ * interval, array, map) are returned as binary columns of raw MsgPack
+ * values. A nullable field may be absent from a tuple or set to nil,
+ * in which case the value is null in the column. If the use_dictionary
+ * option is set, string fields are returned as dictionary-encoded
+ * columns: int32 indexes into a dictionary of the distinct values of
+ * the record batch.
+ *
+ * If predicates are set in the options, rows are fetched by batches,
+ * the predicate fields of a batch are decoded into vectors and then
+ * compared with the predicate values, and only the rows that satisfy
+ * all the predicates are added to the record batch. So a record batch
+ * may contain fewer than batch_row_count rows, but it's never empty.
+ *
+ * The stream uses a regular index iterator, so it must be used in
+ * the tx thread. It ends if the index is dropped or altered. On
+ * failure a stream callback returns a non-zero errno-like code and
+ * sets diag.
+ */
+int
+memtx_index_create_arrow_stream(struct index *index,
+				uint32_t field_count, const uint32_t *fields,
+				const char *key, uint32_t part_count,
+				const struct arrow_options *options,
+				struct ArrowArrayStream *stream);
+
+/**
+ * Create an Arrow stream over a memtx index read view.
+ *
+ * The stream returns the same record batches as a stream created with
+ * memtx_index_create_arrow_stream() but may be used in any thread that
+ * runs a fiber: get_next() uses the fiber region and diag.
+ * Only full scans are supported, so @a part_count must be 0, but the
+ * rows may be filtered with predicates. Field types are taken from the
+ * space read view format so the read view should be opened with
+ * read_view_opts::enable_field_names, otherwise fields that aren't
+ * indexed are returned as raw MsgPack values.
+ * @a size is the number of tuples in the read view, it's used to
+ * limit the size of record batches.
+ *
+ * The stream must be released before the read view is closed.
+ */
+int
+memtx_index_read_view_create_arrow_stream(struct index_read_view *rv,
+					  size_t size, uint32_t field_count,
+					  const uint32_t *fields,
+					  const char *key, uint32_t part_count,
+					  const struct arrow_options *options,
+					  struct ArrowArrayStream *stream);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -35,6 +35,9 @@
 #include <small/mempool.h>
 
 #include "fiber.h"
+#include "fiber_cond.h"
+#include "cbus.h"
+#include "clock.h"
 #include "errinj.h"
 #include "coio_task.h"
 #include "info/info.h"
@@ -202,6 +205,21 @@ memtx_build_secondary_keys(struct space *space, void *param)
 	return 0;
 }
 
+/**
+ * Builds secondary keys of all memtx spaces after recovery and runs
+ * the on_indexes_built callback.
+ */
+static int
+memtx_engine_build_secondary_keys(struct memtx_engine *memtx)
+{
+	double start = clock_monotonic();
+	if (space_foreach(memtx_build_secondary_keys, memtx) != 0)
+		return -1;
+	memtx->recovery_stat.build_time += clock_monotonic() - start;
+	memtx->on_indexes_built_cb();
+	return 0;
+}
+
 /**
  * Memtx shutdown. Shutdown stops all internal fiber. Yields.
  */
@@ -249,10 +267,26 @@ memtx_engine_free(struct engine *engine)
 	tuple_arena_destroy(&memtx->arena);
 
 	xdir_destroy(&memtx->snap_dir);
+	mh_i64ptr_delete(memtx->delta_snaps);
+	if (memtx->last_checkpoint_space_ids != NULL)
+		mh_i32_delete(memtx->last_checkpoint_space_ids);
 	tuple_format_unref(memtx->func_key_format);
 	free(memtx);
 }
 
+/**
+ * Returns the signature of the base of a delta snapshot or -1 if
+ * the snapshot with the given signature isn't a delta.
+ */
+static int64_t
+memtx_engine_snap_base(struct memtx_engine *memtx, int64_t signature)
+{
+	mh_int_t k = mh_i64ptr_find(memtx->delta_snaps, signature, NULL);
+	if (k == mh_end(memtx->delta_snaps))
+		return -1;
+	return (intptr_t)mh_i64ptr_node(memtx->delta_snaps, k)->val;
+}
+
 /**
  * State of memtx engine snapshot recovery.
  */
@@ -269,39 +303,452 @@ enum snapshot_recovery_state {
 };
 
 /**
- * Recovers one xrow from snapshot.
+ * Filter of rows recovered from a chain of delta snapshots. The
+ * newest snapshot of the chain is recovered as usual. Older ones are
+ * recovered only for user spaces that weren't found in newer ones.
+ */
+struct snapshot_recovery_filter {
+	/**
+	 * Maps ids of recovered user spaces to the number of the snapshot
+	 * in the chain they were recovered from.
+	 */
+	struct mh_i32ptr_t *space_ids;
+	/** Number of the snapshot being recovered, 0 for the newest one. */
+	int snap_no;
+	/** Space id of the last filtered row. */
+	uint32_t last_space_id;
+	/** Whether the last filtered row was skipped. */
+	bool last_skip;
+};
+
+/** Returns true if a row of the given space must be skipped. */
+static bool
+snapshot_recovery_filter_skip(struct snapshot_recovery_filter *filter,
+			      uint32_t space_id)
+{
+	if (space_id_is_system(space_id))
+		return filter->snap_no > 0;
+	/* Rows of the same space go in a row. */
+	if (space_id == filter->last_space_id)
+		return filter->last_skip;
+	bool skip;
+	mh_int_t k = mh_i32ptr_find(filter->space_ids, space_id, NULL);
+	if (k == mh_end(filter->space_ids)) {
+		struct mh_i32ptr_node_t node = {
+			space_id, (void *)(intptr_t)filter->snap_no
+		};
+		mh_i32ptr_put(filter->space_ids, &node, NULL, NULL);
+		skip = false;
+	} else {
+		skip = (intptr_t)mh_i32ptr_node(filter->space_ids, k)->val !=
+		       filter->snap_no;
+	}
+	filter->last_space_id = space_id;
+	filter->last_skip = skip;
+	return skip;
+}
+
+/**
+ * Recovers one xrow from snapshot. @a filter is set when recovering
+ * from a chain of delta snapshots.
  *
  * @retval -1 error, diagnostic set
  * @retval 0 success
  */
 static int
 memtx_engine_recover_snapshot_row(struct xrow_header *row,
-				  enum snapshot_recovery_state *state);
+				  enum snapshot_recovery_state *state,
+				  struct snapshot_recovery_filter *filter);
 
-int
-memtx_engine_recover_snapshot(struct memtx_engine *memtx,
-			      const struct vclock *vclock)
+/**
+ * Size of a batch of snapshot rows read by the snapshot reader thread
+ * in one go, in bytes.
+ */
+enum { MEMTX_SNAP_READ_BATCH_SIZE = 1024 * 1024 };
+
+/**
+ * Number of batches the snapshot reader thread may have in flight.
+ * Two batches are enough to overlap reading of the next batch with
+ * applying of the current one in the tx thread.
+ */
+enum { MEMTX_SNAP_READ_BATCH_COUNT = 2 };
+
+struct memtx_snap_reader;
+
+/**
+ * A batch of snapshot rows read and decoded by the snapshot reader
+ * thread. Batches are allocated with malloc so that they can be
+ * filled in the reader thread and consumed in the tx thread.
+ */
+struct memtx_snap_batch {
+	/** Message used to pass the batch between threads. */
+	struct cmsg base;
+	/** Reader this batch belongs to. */
+	struct memtx_snap_reader *reader;
+	/** Link in memtx_snap_reader::ready. */
+	struct stailq_entry in_ready;
+	/** Decoded row headers. Row bodies point to @data. */
+	struct xrow_header *rows;
+	/** Number of rows stored in the batch. */
+	int row_count;
+	/** Number of rows allocated for @rows. */
+	int row_capacity;
+	/** Row bodies, stored one after another. */
+	char *data;
+	/** Size of row bodies stored in @data. */
+	size_t data_size;
+	/** Size of memory allocated for @data. */
+	size_t data_capacity;
+	/** Time spent reading and decoding the batch, in seconds. */
+	double read_time;
+	/** Set if this is the last batch, no more rows to read. */
+	bool is_last;
+	/** Set if the snapshot EOF marker was read. */
+	bool is_eof;
+	/** Set if the batch couldn't be read, see @diag. */
+	bool is_error;
+	/** Error that occurred while reading the batch. */
+	struct diag diag;
+};
+
+/**
+ * Snapshot reader thread. It reads the snapshot file, decompresses and
+ * decodes xlog transactions and passes the decoded rows to the tx thread
+ * in batches so that the tx thread only has to apply them.
+ */
+struct memtx_snap_reader {
+	/** Reader thread. */
+	struct cord cord;
+	/** Pipe from the tx thread to the reader thread. */
+	struct cpipe reader_pipe;
+	/** Pipe from the reader thread to the tx thread. */
+	struct cpipe tx_pipe;
+	/** Route of a batch: read in the reader, consume in tx. */
+	struct cmsg_hop route[2];
+	/** Name of the snapshot file. Accessed by the reader thread. */
+	const char *filename;
+	/** Snapshot cursor. Accessed only by the reader thread. */
+	struct xlog_cursor cursor;
+	/** Set if @cursor was opened. Accessed only by the reader thread. */
+	bool is_open;
+	/**
+	 * Set when the reader reaches the end of the snapshot or fails.
+	 * Accessed only by the reader thread.
+	 */
+	bool is_done;
+	/** Batches that were read but not applied yet, tx thread. */
+	struct stailq ready;
+	/** Signaled when a batch is added to @ready, tx thread. */
+	struct fiber_cond ready_cond;
+	/** Batches allocated by the reader, tx thread. */
+	struct memtx_snap_batch batches[MEMTX_SNAP_READ_BATCH_COUNT];
+};
+
+/** Appends a row read from the snapshot to a batch. */
+static int
+memtx_snap_batch_append(struct memtx_snap_batch *batch,
+			const struct xrow_header *row)
+{
+	if (batch->row_count == batch->row_capacity) {
+		int capacity = MAX(batch->row_capacity * 2, 256);
+		struct xrow_header *rows = (struct xrow_header *)
+			realloc(batch->rows, capacity * sizeof(*rows));
+		if (rows == NULL) {
+			diag_set(OutOfMemory, capacity * sizeof(*rows),
+				 "realloc", "snapshot rows");
+			return -1;
+		}
+		batch->rows = rows;
+		batch->row_capacity = capacity;
+	}
+	size_t size = 0;
+	for (int i = 0; i < row->bodycnt; i++)
+		size += row->body[i].iov_len;
+	if (batch->data_size + size > batch->data_capacity) {
+		size_t capacity = MAX(batch->data_capacity * 2,
+				      batch->data_size + size);
+		char *data = (char *)realloc(batch->data, capacity);
+		if (data == NULL) {
+			diag_set(OutOfMemory, capacity, "realloc",
+				 "snapshot row bodies");
+			return -1;
+		}
+		batch->data = data;
+		batch->data_capacity = capacity;
+	}
+	for (int i = 0; i < row->bodycnt; i++) {
+		memcpy(batch->data + batch->data_size, row->body[i].iov_base,
+		       row->body[i].iov_len);
+		batch->data_size += row->body[i].iov_len;
+	}
+	struct xrow_header *copy = &batch->rows[batch->row_count++];
+	*copy = *row;
+	/* The header points to the cursor buffer, which is reused. */
+	copy->header = NULL;
+	copy->header_end = NULL;
+	return 0;
+}
+
+/**
+ * Makes row bodies point to the batch data. Since the data buffer may
+ * be reallocated while the batch is filled, it's done in the end.
+ */
+static void
+memtx_snap_batch_fix_bodies(struct memtx_snap_batch *batch)
+{
+	char *pos = batch->data;
+	for (int i = 0; i < batch->row_count; i++) {
+		struct xrow_header *row = &batch->rows[i];
+		for (int j = 0; j < row->bodycnt; j++) {
+			row->body[j].iov_base = pos;
+			pos += row->body[j].iov_len;
+		}
+	}
+	assert(pos == batch->data + batch->data_size);
+}
+
+/** Reads the next batch of rows from the snapshot, reader thread. */
+static int
+memtx_snap_batch_read(struct memtx_snap_batch *batch)
 {
-	/* Process existing snapshot */
-	say_info("recovery start");
-	int64_t signature = vclock_sum(vclock);
-	const char *filename = xdir_format_filename(&memtx->snap_dir,
-						    signature);
+	struct memtx_snap_reader *reader = batch->reader;
+	if (!reader->is_open) {
+		if (xlog_cursor_open(&reader->cursor, reader->filename) != 0)
+			return -1;
+		reader->is_open = true;
+	}
+	int rc = 0;
+	struct xrow_header row;
+	while (batch->data_size < MEMTX_SNAP_READ_BATCH_SIZE &&
+	       (rc = xlog_cursor_next(&reader->cursor, &row, false)) == 0) {
+		if (memtx_snap_batch_append(batch, &row) != 0)
+			return -1;
+	}
+	if (rc < 0)
+		return -1;
+	if (rc > 0) {
+		batch->is_last = true;
+		batch->is_eof = xlog_cursor_is_eof(&reader->cursor);
+	}
+	memtx_snap_batch_fix_bodies(batch);
+	return 0;
+}
 
-	say_info("recovering from `%s'", filename);
+/** Reads a batch of rows, called in the reader thread. */
+static void
+memtx_snap_batch_read_f(struct cmsg *msg)
+{
+	struct memtx_snap_batch *batch = (struct memtx_snap_batch *)msg;
+	struct memtx_snap_reader *reader = batch->reader;
+	double start = clock_monotonic();
+	if (reader->is_done) {
+		batch->is_last = true;
+	} else if (memtx_snap_batch_read(batch) != 0) {
+		batch->is_error = true;
+		diag_move(diag_get(), &batch->diag);
+	}
+	if (batch->is_last || batch->is_error)
+		reader->is_done = true;
+	batch->read_time = clock_monotonic() - start;
+}
+
+/** Queues a batch that was read for applying, called in tx. */
+static void
+memtx_snap_batch_ready_f(struct cmsg *msg)
+{
+	struct memtx_snap_batch *batch = (struct memtx_snap_batch *)msg;
+	struct memtx_snap_reader *reader = batch->reader;
+	stailq_add_tail_entry(&reader->ready, batch, in_ready);
+	fiber_cond_signal(&reader->ready_cond);
+}
+
+/** Sends a batch to the reader thread to be filled. */
+static void
+memtx_snap_reader_submit(struct memtx_snap_reader *reader,
+			 struct memtx_snap_batch *batch)
+{
+	batch->row_count = 0;
+	batch->data_size = 0;
+	batch->read_time = 0;
+	assert(!batch->is_last && !batch->is_error);
+	cmsg_init(&batch->base, reader->route);
+	cpipe_push(&reader->reader_pipe, &batch->base);
+}
+
+/**
+ * Waits for the next batch to be read by the reader thread.
+ * Batches are returned in the order they were submitted.
+ */
+static struct memtx_snap_batch *
+memtx_snap_reader_next(struct memtx_snap_reader *reader)
+{
+	while (stailq_empty(&reader->ready))
+		fiber_cond_wait(&reader->ready_cond);
+	return stailq_shift_entry(&reader->ready, struct memtx_snap_batch,
+				  in_ready);
+}
+
+/** Snapshot reader thread function. */
+static int
+memtx_snap_reader_f(va_list ap)
+{
+	struct memtx_snap_reader *reader =
+		va_arg(ap, struct memtx_snap_reader *);
+	struct cbus_endpoint endpoint;
+
+	cpipe_create(&reader->tx_pipe, "tx_prio");
+	cbus_endpoint_create(&endpoint, cord_name(cord()),
+			     fiber_schedule_cb, fiber());
+	cbus_loop(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	cpipe_destroy(&reader->tx_pipe);
+	if (reader->is_open)
+		xlog_cursor_close(&reader->cursor, false);
+	return 0;
+}
+
+/** Frees the batches and the condition variable of a snapshot reader. */
+static void
+memtx_snap_reader_destroy(struct memtx_snap_reader *reader)
+{
+	for (int i = 0; i < MEMTX_SNAP_READ_BATCH_COUNT; i++) {
+		struct memtx_snap_batch *batch = &reader->batches[i];
+		diag_destroy(&batch->diag);
+		free(batch->rows);
+		free(batch->data);
+	}
+	fiber_cond_destroy(&reader->ready_cond);
+}
+
+/**
+ * Starts a snapshot reader thread and submits the first batches
+ * for reading.
+ */
+static int
+memtx_snap_reader_start(struct memtx_snap_reader *reader,
+			const char *filename)
+{
+	memset(reader, 0, sizeof(*reader));
+	reader->filename = filename;
+	reader->route[0].f = memtx_snap_batch_read_f;
+	reader->route[0].pipe = &reader->tx_pipe;
+	reader->route[1].f = memtx_snap_batch_ready_f;
+	reader->route[1].pipe = NULL;
+	stailq_create(&reader->ready);
+	fiber_cond_create(&reader->ready_cond);
+	for (int i = 0; i < MEMTX_SNAP_READ_BATCH_COUNT; i++) {
+		reader->batches[i].reader = reader;
+		diag_create(&reader->batches[i].diag);
+	}
+	if (cord_costart(&reader->cord, "snap_reader",
+			 memtx_snap_reader_f, reader) != 0) {
+		memtx_snap_reader_destroy(reader);
+		return -1;
+	}
+	cpipe_create(&reader->reader_pipe, "snap_reader");
+	for (int i = 0; i < MEMTX_SNAP_READ_BATCH_COUNT; i++)
+		memtx_snap_reader_submit(reader, &reader->batches[i]);
+	return 0;
+}
+
+/**
+ * Waits for all submitted batches, stops the reader thread and frees
+ * the batches.
+ */
+static void
+memtx_snap_reader_stop(struct memtx_snap_reader *reader, int in_flight)
+{
+	for (int i = 0; i < in_flight; i++)
+		memtx_snap_reader_next(reader);
+	cbus_stop_loop(&reader->reader_pipe);
+	cpipe_destroy(&reader->reader_pipe);
+	if (cord_join(&reader->cord) != 0)
+		panic_syserror("failed to join snapshot reader thread");
+	memtx_snap_reader_destroy(reader);
+}
+
+/**
+ * Recovers the snapshot with the help of a reader thread, which does
+ * file reads, decompression and row decoding while the tx thread
+ * applies rows read previously. Not used in the force recovery mode,
+ * because in this mode broken rows are skipped depending on the
+ * recovery state, which is known only in tx.
+ */
+static int
+memtx_engine_recover_snapshot_threaded(struct memtx_engine *memtx,
+				       const char *filename,
+				       int64_t signature,
+				       enum snapshot_recovery_state *state,
+				       struct snapshot_recovery_filter *filter,
+				       bool *is_eof)
+{
+	struct memtx_snap_reader reader;
+	if (memtx_snap_reader_start(&reader, filename) != 0)
+		return -1;
+	struct memtx_recovery_stat *stat = &memtx->recovery_stat;
+	int in_flight = MEMTX_SNAP_READ_BATCH_COUNT;
+	int rc = 0;
+	while (true) {
+		struct memtx_snap_batch *batch =
+			memtx_snap_reader_next(&reader);
+		in_flight--;
+		if (batch->is_error) {
+			diag_move(&batch->diag, diag_get());
+			batch->is_error = false;
+			rc = -1;
+			break;
+		}
+		stat->read_time += batch->read_time;
+		double start = clock_monotonic();
+		for (int i = 0; i < batch->row_count; i++) {
+			struct xrow_header *row = &batch->rows[i];
+			row->lsn = signature;
+			rc = memtx_engine_recover_snapshot_row(row, state,
+							       filter);
+			if (rc != 0)
+				break;
+			stat->rows++;
+			if (stat->rows % 100000 == 0) {
+				say_info_ratelimited("%.1fM rows processed",
+						     stat->rows / 1e6);
+				fiber_yield_timeout(0);
+			}
+		}
+		stat->bytes += batch->data_size;
+		stat->apply_time += clock_monotonic() - start;
+		if (rc != 0 || batch->is_last) {
+			*is_eof = batch->is_eof;
+			break;
+		}
+		memtx_snap_reader_submit(&reader, batch);
+		in_flight++;
+	}
+	memtx_snap_reader_stop(&reader, in_flight);
+	return rc;
+}
+
+/**
+ * Recovers the snapshot in the force recovery mode, skipping rows that
+ * can't be read or applied once all system spaces are recovered.
+ */
+static int
+memtx_engine_recover_snapshot_forced(struct memtx_engine *memtx,
+				     const char *filename, int64_t signature,
+				     enum snapshot_recovery_state *state,
+				     struct snapshot_recovery_filter *filter,
+				     bool *is_eof)
+{
 	struct xlog_cursor cursor;
 	if (xlog_cursor_open(&cursor, filename) < 0)
 		return -1;
 
 	int rc;
 	struct xrow_header row;
-	uint64_t row_count = 0;
 	bool force_recovery = false;
-	enum snapshot_recovery_state state = SNAPSHOT_RECOVERY_NOT_STARTED;
 	while ((rc = xlog_cursor_next(&cursor, &row, force_recovery)) == 0) {
 		row.lsn = signature;
-		rc = memtx_engine_recover_snapshot_row(&row, &state);
-		if (state == DONE_RECOVERING_SYSTEM_SPACES)
+		rc = memtx_engine_recover_snapshot_row(&row, state, filter);
+		if (*state == DONE_RECOVERING_SYSTEM_SPACES)
 			force_recovery = memtx->force_recovery;
 		if (rc < 0) {
 			if (!force_recovery)
@@ -309,14 +756,45 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 			say_error("can't apply row: ");
 			diag_log();
 		}
-		++row_count;
-		if (row_count % 100000 == 0) {
+		memtx->recovery_stat.rows++;
+		if (memtx->recovery_stat.rows % 100000 == 0) {
 			say_info_ratelimited("%.1fM rows processed",
-					     row_count / 1e6);
+					     memtx->recovery_stat.rows / 1e6);
 			fiber_yield_timeout(0);
 		}
 	}
+	*is_eof = xlog_cursor_is_eof(&cursor);
 	xlog_cursor_close(&cursor, false);
+	return rc < 0 ? -1 : 0;
+}
+
+/** Recovers one snapshot file of a chain of delta snapshots. */
+static int
+memtx_engine_recover_snapshot_file(struct memtx_engine *memtx,
+				   int64_t signature,
+				   enum snapshot_recovery_state *state,
+				   struct snapshot_recovery_filter *filter)
+{
+	/*
+	 * The name is copied, because the static buffer may be reused
+	 * while the snapshot reader thread still accesses it.
+	 */
+	char filename[PATH_MAX];
+	strlcpy(filename, xdir_format_filename(&memtx->snap_dir, signature),
+		sizeof(filename));
+
+	say_info("recovering from `%s'", filename);
+	int rc;
+	bool is_eof = false;
+	if (memtx->force_recovery) {
+		rc = memtx_engine_recover_snapshot_forced(memtx, filename,
+							  signature, state,
+							  filter, &is_eof);
+	} else {
+		rc = memtx_engine_recover_snapshot_threaded(memtx, filename,
+							    signature, state,
+							    filter, &is_eof);
+	}
 	if (rc < 0)
 		return -1;
 
@@ -325,12 +803,50 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 	 * marker - such snapshots are very likely corrupted and
 	 * should not be trusted.
 	 */
-	if (!xlog_cursor_is_eof(&cursor)) {
+	if (!is_eof) {
 		if (!memtx->force_recovery)
-			panic("snapshot `%s' has no EOF marker", cursor.name);
+			panic("snapshot `%s' has no EOF marker", filename);
 		else
-			say_error("snapshot `%s' has no EOF marker", cursor.name);
+			say_error("snapshot `%s' has no EOF marker", filename);
 	}
+	return 0;
+}
+
+int
+memtx_engine_recover_snapshot(struct memtx_engine *memtx,
+			      const struct vclock *vclock)
+{
+	/* Process existing snapshot */
+	say_info("recovery start");
+	int64_t signature = vclock_sum(vclock);
+	int64_t base = memtx_engine_snap_base(memtx, signature);
+	bool is_delta = base >= 0;
+	enum snapshot_recovery_state state = SNAPSHOT_RECOVERY_NOT_STARTED;
+	struct snapshot_recovery_filter filter;
+	if (is_delta) {
+		filter.space_ids = mh_i32ptr_new();
+		filter.snap_no = 0;
+		filter.last_space_id = BOX_ID_NIL;
+		filter.last_skip = false;
+	}
+	/*
+	 * The newest snapshot of a delta chain goes first: it contains
+	 * all system spaces, and user spaces found in it override their
+	 * versions stored in older snapshots.
+	 */
+	int rc = memtx_engine_recover_snapshot_file(
+		memtx, signature, &state, is_delta ? &filter : NULL);
+	while (rc == 0 && base >= 0) {
+		filter.snap_no++;
+		filter.last_space_id = BOX_ID_NIL;
+		rc = memtx_engine_recover_snapshot_file(memtx, base, &state,
+							&filter);
+		base = memtx_engine_snap_base(memtx, base);
+	}
+	if (is_delta)
+		mh_i32ptr_delete(filter.space_ids);
+	if (rc != 0)
+		return -1;
 
 	/*
 	 * Snapshot entries are ordered by the space id, it means that if there
@@ -397,10 +913,14 @@ snapshot_recovery_state_update(enum snapshot_recovery_state *state,
 
 static int
 memtx_engine_recover_snapshot_row(struct xrow_header *row,
-				  enum snapshot_recovery_state *state)
+				  enum snapshot_recovery_state *state,
+				  struct snapshot_recovery_filter *filter)
 {
 	assert(row->bodycnt == 1); /* always 1 for read */
 	if (row->type != IPROTO_INSERT) {
+		/* Raft and synchro states are taken from the newest file. */
+		if (filter != NULL && filter->snap_no > 0)
+			return 0;
 		if (snapshot_recovery_state_update(state, false) != 0)
 			return -1;
 		if (row->type == IPROTO_RAFT)
@@ -415,6 +935,9 @@ memtx_engine_recover_snapshot_row(struct xrow_header *row,
 	RegionGuard region_guard(&fiber()->gc);
 	if (xrow_decode_dml(row, &request, dml_request_key_map(row->type)) != 0)
 		return -1;
+	if (filter != NULL &&
+	    snapshot_recovery_filter_skip(filter, request.space_id))
+		return 0;
 	bool is_system_space_request = space_id_is_system(request.space_id);
 	if (snapshot_recovery_state_update(state, is_system_space_request) != 0)
 		return -1;
@@ -510,9 +1033,8 @@ memtx_engine_begin_final_recovery(struct engine *engine)
 		 * unique keys.
 		 */
 		memtx->state = MEMTX_OK;
-		if (space_foreach(memtx_build_secondary_keys, memtx) != 0)
+		if (memtx_engine_build_secondary_keys(memtx) != 0)
 			return -1;
-		memtx->on_indexes_built_cb();
 	}
 	return 0;
 }
@@ -529,9 +1051,8 @@ memtx_engine_begin_hot_standby(struct engine *engine)
 	if (memtx->state != MEMTX_OK) {
 		assert(memtx->state == MEMTX_FINAL_RECOVERY);
 		memtx->state = MEMTX_OK;
-		if (space_foreach(memtx_build_secondary_keys, memtx) != 0)
+		if (memtx_engine_build_secondary_keys(memtx) != 0)
 			return -1;
-		memtx->on_indexes_built_cb();
 	}
 	return 0;
 }
@@ -549,9 +1070,8 @@ memtx_engine_end_recovery(struct engine *engine)
 	if (memtx->state != MEMTX_OK) {
 		assert(memtx->state == MEMTX_FINAL_RECOVERY);
 		memtx->state = MEMTX_OK;
-		if (space_foreach(memtx_build_secondary_keys, memtx) != 0)
+		if (memtx_engine_build_secondary_keys(memtx) != 0)
 			return -1;
-		memtx->on_indexes_built_cb();
 	}
 	xdir_remove_temporary_files(&memtx->snap_dir);
 
@@ -643,10 +1163,11 @@ memtx_engine_commit(struct engine *engine, struct txn *txn)
 		}
 		if (stmt->engine_savepoint != NULL) {
 			struct space *space = stmt->space;
-			struct tuple *old_tuple = stmt->rollback_info.old_tuple;
-			if (space->upgrade != NULL && old_tuple != NULL)
-				memtx_space_upgrade_untrack_tuple(
-						space->upgrade, old_tuple);
+			/*
+			 * With MVCC, a change becomes visible to checkpoint
+			 * read views only on commit.
+			 */
+			memtx_space_touch(space);
 		}
 	}
 }
@@ -673,8 +1194,7 @@ memtx_engine_rollback_statement(struct engine *engine, struct txn *txn,
 	if (stmt->engine_savepoint == NULL)
 		return;
 
-	if (space->upgrade != NULL && new_tuple != NULL)
-		memtx_space_upgrade_untrack_tuple(space->upgrade, new_tuple);
+	memtx_space_touch(space);
 
 	if (memtx_tx_manager_use_mvcc_engine)
 		return memtx_tx_history_rollback_stmt(stmt);
@@ -741,7 +1261,7 @@ memtx_engine_bootstrap(struct engine *engine)
 	struct xrow_header row;
 	enum snapshot_recovery_state state = SNAPSHOT_RECOVERY_NOT_STARTED;
 	while ((rc = xlog_cursor_next(&cursor, &row, true)) == 0) {
-		rc = memtx_engine_recover_snapshot_row(&row, &state);
+		rc = memtx_engine_recover_snapshot_row(&row, &state, NULL);
 		if (rc < 0)
 			break;
 	}
@@ -835,6 +1355,30 @@ struct checkpoint {
 	 * checkpoint already exists.
 	 */
 	bool touch;
+	/**
+	 * Train a zstd dictionary on the read view and store it
+	 * in the snapshot file, see checkpoint_train_dict().
+	 */
+	bool compression_dict;
+	/** Generation of the checkpoint, see memtx_engine::checkpoint_gen. */
+	uint64_t gen;
+	/**
+	 * Set if the snapshot file is written as a delta to the last
+	 * checkpoint, i.e. user spaces that haven't changed since the
+	 * last checkpoint are omitted.
+	 */
+	bool is_delta;
+	/** Vclock of the last checkpoint, the base of the delta. */
+	struct vclock base_vclock;
+	/** Ids of user spaces included in the read view. */
+	struct mh_i32_t *space_ids;
+	/** Ids of user spaces that haven't changed since the last checkpoint. */
+	struct mh_i32_t *clean_space_ids;
+	/**
+	 * Ids of user spaces written to the last checkpoint. Owned by
+	 * the engine, isn't modified while the checkpoint is in progress.
+	 */
+	struct mh_i32_t *base_space_ids;
 };
 
 /** Space filter for checkpoint. */
@@ -900,7 +1444,8 @@ is_tuple_temporary(const char *data, uint32_t space_id,
 }
 
 static struct checkpoint *
-checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
+checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit,
+	       int snap_compression_level, bool snap_compression_dict)
 {
 	struct checkpoint *ckpt = (struct checkpoint *)malloc(sizeof(*ckpt));
 	if (ckpt == NULL) {
@@ -920,6 +1465,7 @@ checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
 	}
 	struct xlog_opts opts = xlog_opts_default;
 	opts.rate_limit = snap_io_rate_limit;
+	opts.compression_level = snap_compression_level;
 	opts.sync_interval = SNAP_SYNC_INTERVAL;
 	opts.free_cache = true;
 	xdir_create(&ckpt->dir, snap_dirname, "SNAP", &INSTANCE_UUID, &opts);
@@ -929,17 +1475,194 @@ checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
 	txn_limbo_checkpoint(&txn_limbo, &ckpt->synchro_state,
 			     &ckpt->synchro_vclock);
 	ckpt->touch = false;
+	ckpt->compression_dict = snap_compression_dict &&
+				 snap_compression_level > 0;
+	ckpt->gen = 0;
+	ckpt->is_delta = false;
+	vclock_create(&ckpt->base_vclock);
+	ckpt->space_ids = mh_i32_new();
+	ckpt->clean_space_ids = mh_i32_new();
+	ckpt->base_space_ids = NULL;
 	return ckpt;
 }
 
 static void
 checkpoint_delete(struct checkpoint *ckpt)
 {
+	if (ckpt->space_ids != NULL)
+		mh_i32_delete(ckpt->space_ids);
+	mh_i32_delete(ckpt->clean_space_ids);
 	read_view_close(&ckpt->rv);
 	xdir_destroy(&ckpt->dir);
 	free(ckpt);
 }
 
+/** Returns the number of delta snapshots in the chain of a snapshot. */
+static int
+memtx_engine_snap_delta_count(struct memtx_engine *memtx, int64_t signature)
+{
+	int count = 0;
+	while ((signature = memtx_engine_snap_base(memtx, signature)) >= 0)
+		count++;
+	return count;
+}
+
+/**
+ * Collects ids of user spaces included in the checkpoint read view and
+ * decides if the snapshot may be written as a delta to the last one.
+ * Must be called right after the read view is opened.
+ */
+static void
+checkpoint_prepare_delta(struct checkpoint *ckpt, struct memtx_engine *memtx)
+{
+	ckpt->gen = memtx->checkpoint_gen++;
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &ckpt->rv) {
+		uint32_t id = space_rv->id;
+		if (space_id_is_system(id))
+			continue;
+		mh_i32_put(ckpt->space_ids, &id, NULL, NULL);
+		struct memtx_space *space =
+			(struct memtx_space *)space_by_id(id);
+		assert(space != NULL);
+		if (space->checkpoint_gen <= memtx->last_checkpoint_gen)
+			mh_i32_put(ckpt->clean_space_ids, &id, NULL, NULL);
+	}
+	if (memtx->snap_delta_max == 0 || memtx->last_checkpoint_gen == 0 ||
+	    mh_size(ckpt->clean_space_ids) == 0)
+		return;
+	int64_t base = vclock_sum(&memtx->last_checkpoint_vclock);
+	if (memtx_engine_snap_delta_count(memtx, base) >=
+	    memtx->snap_delta_max)
+		return;
+	/*
+	 * Rows of a dropped space would be recovered from the base
+	 * snapshot so a space drop can't be expressed in a delta.
+	 */
+	struct mh_i32_t *base_space_ids = memtx->last_checkpoint_space_ids;
+	mh_int_t i;
+	mh_foreach(base_space_ids, i) {
+		uint32_t id = *mh_i32_node(base_space_ids, i);
+		if (mh_i32_find(ckpt->space_ids, id, NULL) ==
+		    mh_end(ckpt->space_ids))
+			return;
+	}
+	ckpt->is_delta = true;
+	ckpt->base_space_ids = base_space_ids;
+	vclock_copy(&ckpt->base_vclock, &memtx->last_checkpoint_vclock);
+}
+
+/**
+ * Checks that the checkpoint may still be written as a delta. A space
+ * present in the base snapshot that became empty would be recovered
+ * from the base, so the snapshot must be full in this case. Called in
+ * the snapshot thread, because the read view may differ from the tx
+ * state.
+ */
+static bool
+checkpoint_check_delta(struct checkpoint *ckpt)
+{
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &ckpt->rv) {
+		uint32_t id = space_rv->id;
+		if (space_id_is_system(id) ||
+		    mh_i32_find(ckpt->clean_space_ids, id, NULL) !=
+		    mh_end(ckpt->clean_space_ids) ||
+		    mh_i32_find(ckpt->base_space_ids, id, NULL) ==
+		    mh_end(ckpt->base_space_ids))
+			continue;
+		RegionGuard region_guard(&fiber()->gc);
+		struct index_read_view_iterator it;
+		if (index_read_view_create_iterator(
+				space_read_view_index(space_rv, 0), ITER_ALL,
+				NULL, 0, &it) != 0)
+			return false;
+		struct read_view_tuple result;
+		int rc = index_read_view_iterator_next_raw(&it, &result);
+		index_read_view_iterator_destroy(&it);
+		if (rc != 0 || result.data == NULL) {
+			say_info("space %u became empty, "
+				 "writing a full snapshot", id);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Collect samples of tuples stored in user spaces of the checkpoint
+ * read view. The samples are taken from the beginning of primary
+ * indexes, evenly from all spaces.
+ */
+static int
+checkpoint_sample_tuples(struct checkpoint *ckpt,
+			 struct xlog_dict_builder *builder)
+{
+	int space_count = 0;
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &ckpt->rv) {
+		if (!space_id_is_system(space_rv->id))
+			space_count++;
+	}
+	if (space_count == 0)
+		return 0;
+	size_t space_quota = XLOG_DICT_SAMPLES_SIZE_MAX / space_count;
+	read_view_foreach_space(space_rv, &ckpt->rv) {
+		if (space_id_is_system(space_rv->id))
+			continue;
+		struct index_read_view_iterator it;
+		if (index_read_view_create_iterator(
+				space_read_view_index(space_rv, 0), ITER_ALL,
+				NULL, 0, &it) != 0)
+			return -1;
+		size_t limit = builder->samples_size + space_quota;
+		int rc = 0;
+		while (builder->samples_size < limit) {
+			RegionGuard region_guard(&fiber()->gc);
+			struct read_view_tuple result;
+			rc = index_read_view_iterator_next_raw(&it, &result);
+			if (rc != 0 || result.data == NULL)
+				break;
+			struct iovec iov;
+			iov.iov_base = (void *)result.data;
+			iov.iov_len = result.size;
+			if (!xlog_dict_builder_add(builder, &iov, 1))
+				break;
+		}
+		index_read_view_iterator_destroy(&it);
+		if (rc != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * Train a zstd dictionary on tuples of the checkpoint read view and
+ * set it for the snapshot file. Called in the snapshot thread. On
+ * failure, the snapshot is written without a dictionary.
+ */
+static void
+checkpoint_train_dict(struct checkpoint *ckpt)
+{
+	struct xlog_dict_builder builder;
+	xlog_dict_builder_create(&builder);
+	char dict[XLOG_DICT_SIZE_MAX];
+	size_t dict_size;
+	if (checkpoint_sample_tuples(ckpt, &builder) != 0) {
+		diag_log();
+	} else if (!xlog_dict_builder_is_ready(&builder)) {
+		say_verbose("too little data to train snapshot dictionary");
+	} else if (xlog_dict_builder_train(&builder, dict,
+					   &dict_size) != 0 ||
+		   xdir_set_dict(&ckpt->dir, dict, dict_size) != 0) {
+		diag_log();
+	} else {
+		say_info("trained %zu byte snapshot dictionary", dict_size);
+	}
+	diag_clear(diag_get());
+	xlog_dict_builder_destroy(&builder);
+}
+
 static int
 checkpoint_write_raft(struct xlog *l, const struct raft_request *req)
 {
@@ -1061,9 +1784,17 @@ checkpoint_f(va_list ap)
 		ckpt->touch = false;
 	}
 
+	if (ckpt->is_delta && !checkpoint_check_delta(ckpt))
+		ckpt->is_delta = false;
+
+	if (ckpt->compression_dict)
+		checkpoint_train_dict(ckpt);
+
 	struct xlog *snap = &ckpt->snap;
 	assert(!xlog_is_open(snap));
-	if (xdir_create_xlog(&ckpt->dir, snap, &ckpt->vclock) != 0) {
+	if (xdir_create_delta_xlog(&ckpt->dir, snap, &ckpt->vclock,
+				   ckpt->is_delta ? &ckpt->base_vclock :
+						    NULL) != 0) {
 		/*
 		 * We call memtx_engine_abort_checkpoint on failure to discard
 		 * an incomplete xlog file. Clear the xlog object so that it's
@@ -1076,7 +1807,8 @@ checkpoint_f(va_list ap)
 	struct mh_i32_t *temp_space_ids;
 
 	bool is_synchro_written = false;
-	say_info("saving snapshot `%s'", snap->filename);
+	say_info("saving %ssnapshot `%s'", ckpt->is_delta ? "delta " : "",
+		 snap->filename);
 	ERROR_INJECT_WHILE(ERRINJ_SNAP_WRITE_DELAY, {
 		fiber_sleep(0.001);
 		if (fiber_is_cancelled()) {
@@ -1108,6 +1840,10 @@ checkpoint_f(va_list ap)
 				break;
 			is_synchro_written = true;
 		}
+		if (ckpt->is_delta && !space_id_is_system(space_rv->id) &&
+		    mh_i32_find(ckpt->clean_space_ids, space_rv->id, NULL) !=
+		    mh_end(ckpt->clean_space_ids))
+			continue;
 		struct index_read_view *index_rv =
 			space_read_view_index(space_rv, 0);
 		assert(index_rv != NULL);
@@ -1193,9 +1929,12 @@ memtx_engine_begin_checkpoint(struct engine *engine, bool is_scheduled)
 
 	assert(memtx->checkpoint == NULL);
 	memtx->checkpoint = checkpoint_new(memtx->snap_dir.dirname,
-					   memtx->snap_io_rate_limit);
+					   memtx->snap_io_rate_limit,
+					   memtx->snap_compression_level,
+					   memtx->snap_compression_dict);
 	if (memtx->checkpoint == NULL)
 		return -1;
+	checkpoint_prepare_delta(memtx->checkpoint, memtx);
 	return 0;
 }
 
@@ -1213,6 +1952,11 @@ memtx_engine_wait_checkpoint(struct engine *engine,
 	if (xdir_last_vclock(&memtx->snap_dir, &last) >= 0 &&
 	    vclock_compare(&last, vclock) == 0) {
 		memtx->checkpoint->touch = true;
+		/*
+		 * If touch fails, the snapshot is rewritten and can't
+		 * refer to itself as to a base.
+		 */
+		memtx->checkpoint->is_delta = false;
 	}
 	vclock_copy(&memtx->checkpoint->vclock, vclock);
 
@@ -1245,15 +1989,33 @@ memtx_engine_commit_checkpoint(struct engine *engine,
 {
 	ERROR_INJECT_TERMINATE(ERRINJ_SNAP_COMMIT_FAIL);
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
+	struct checkpoint *ckpt = memtx->checkpoint;
 
-	assert(memtx->checkpoint != NULL);
-	assert(!xlog_is_open(&memtx->checkpoint->snap));
+	assert(ckpt != NULL);
+	assert(!xlog_is_open(&ckpt->snap));
 
-	if (!memtx->checkpoint->touch) {
+	if (!ckpt->touch) {
 		ERROR_INJECT_YIELD(ERRINJ_SNAP_COMMIT_DELAY);
-		coio_call(memtx_engine_commit_checkpoint_f,
-			  &memtx->checkpoint->snap);
+		coio_call(memtx_engine_commit_checkpoint_f, &ckpt->snap);
+		int64_t signature = vclock_sum(&ckpt->vclock);
+		mh_int_t k = mh_i64ptr_find(memtx->delta_snaps, signature,
+					    NULL);
+		if (k != mh_end(memtx->delta_snaps))
+			mh_i64ptr_del(memtx->delta_snaps, k, NULL);
+		if (ckpt->is_delta) {
+			struct mh_i64ptr_node_t node = {
+				(uint64_t)signature,
+				(void *)(intptr_t)vclock_sum(&ckpt->base_vclock)
+			};
+			mh_i64ptr_put(memtx->delta_snaps, &node, NULL, NULL);
+		}
 	}
+	memtx->last_checkpoint_gen = ckpt->gen;
+	vclock_copy(&memtx->last_checkpoint_vclock, &ckpt->vclock);
+	if (memtx->last_checkpoint_space_ids != NULL)
+		mh_i32_delete(memtx->last_checkpoint_space_ids);
+	memtx->last_checkpoint_space_ids = ckpt->space_ids;
+	ckpt->space_ids = NULL;
 
 	struct vclock last;
 	if (xdir_last_vclock(&memtx->snap_dir, &last) < 0 ||
@@ -1292,8 +2054,18 @@ static void
 memtx_engine_collect_garbage(struct engine *engine, const struct vclock *vclock)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
-	xdir_collect_garbage(&memtx->snap_dir, vclock_sum(vclock),
-			     XDIR_GC_ASYNC);
+	/* Keep all snapshots of the delta chain of the oldest checkpoint. */
+	int64_t signature = vclock_sum(vclock);
+	int64_t base;
+	while ((base = memtx_engine_snap_base(memtx, signature)) >= 0)
+		signature = base;
+	xdir_collect_garbage(&memtx->snap_dir, signature, XDIR_GC_ASYNC);
+	mh_int_t k;
+	mh_foreach(memtx->delta_snaps, k) {
+		if ((int64_t)mh_i64ptr_node(memtx->delta_snaps, k)->key <
+		    signature)
+			mh_i64ptr_del(memtx->delta_snaps, k, NULL);
+	}
 }
 
 static int
@@ -1301,9 +2073,15 @@ memtx_engine_backup(struct engine *engine, const struct vclock *vclock,
 		    engine_backup_cb cb, void *cb_arg)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
-	const char *filename = xdir_format_filename(&memtx->snap_dir,
-						    vclock_sum(vclock));
-	return cb(filename, cb_arg);
+	int64_t signature = vclock_sum(vclock);
+	do {
+		const char *filename = xdir_format_filename(&memtx->snap_dir,
+							    signature);
+		if (cb(filename, cb_arg) != 0)
+			return -1;
+		signature = memtx_engine_snap_base(memtx, signature);
+	} while (signature >= 0);
+	return 0;
 }
 
 struct memtx_join_ctx {
@@ -1655,6 +2433,36 @@ memtx_tuple_validate(struct tuple_format *format, struct tuple *tuple)
 	return rc;
 }
 
+/**
+ * Reads meta of all snapshots stored in the snapshot directory to find
+ * delta snapshots. A snapshot with unreadable meta is treated as full:
+ * recovery will fail to open it anyway.
+ */
+static void
+memtx_engine_scan_delta_snaps(struct memtx_engine *memtx)
+{
+	for (struct vclock *vclock = vclockset_first(&memtx->snap_dir.index);
+	     vclock != NULL;
+	     vclock = vclockset_next(&memtx->snap_dir.index, vclock)) {
+		int64_t signature = vclock_sum(vclock);
+		struct xlog_cursor cursor;
+		if (xdir_open_cursor(&memtx->snap_dir, signature,
+				     &cursor) != 0) {
+			diag_log();
+			continue;
+		}
+		if (vclock_is_set(&cursor.meta.base_vclock)) {
+			struct mh_i64ptr_node_t node = {
+				(uint64_t)signature,
+				(void *)(intptr_t)vclock_sum(
+					&cursor.meta.base_vclock)
+			};
+			mh_i64ptr_put(memtx->delta_snaps, &node, NULL, NULL);
+		}
+		xlog_cursor_close(&cursor, false);
+	}
+}
+
 struct memtx_engine *
 memtx_engine_new(const char *snap_dirname, bool force_recovery,
 		 uint64_t tuple_arena_max_size, uint32_t objsize_min,
@@ -1674,6 +2482,7 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 	xdir_create(&memtx->snap_dir, snap_dirname, "SNAP", &INSTANCE_UUID,
 		    &xlog_opts_default);
 	memtx->snap_dir.force_recovery = force_recovery;
+	memtx->delta_snaps = mh_i64ptr_new();
 
 	if (xdir_scan(&memtx->snap_dir, true) != 0)
 		goto fail;
@@ -1697,6 +2506,7 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 		INSTANCE_UUID = cursor.meta.instance_uuid;
 		xlog_cursor_close(&cursor, false);
 	}
+	memtx_engine_scan_delta_snaps(memtx);
 
 	/* Apprise the garbage collector of available checkpoints. */
 	for (struct vclock *vclock = vclockset_first(&memtx->snap_dir.index);
@@ -1791,6 +2601,10 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 
 	memtx->state = MEMTX_INITIALIZED;
 	memtx->max_tuple_size = MAX_TUPLE_SIZE;
+	memtx->snap_compression_level = XLOG_COMPRESSION_LEVEL_DEFAULT;
+	memtx->snap_compression_dict = false;
+	memtx->checkpoint_gen = 1;
+	vclock_create(&memtx->last_checkpoint_vclock);
 	memtx->force_recovery = force_recovery;
 	if (sort_threads == 0) {
 		char *ompnum_str = getenv_safe("OMP_NUM_THREADS", NULL, 0);
@@ -1839,6 +2653,7 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 	return memtx;
 fail:
 	xdir_destroy(&memtx->snap_dir);
+	mh_i64ptr_delete(memtx->delta_snaps);
 	free(memtx);
 	return NULL;
 }
@@ -1936,6 +2751,21 @@ memtx_engine_stat_index(struct memtx_engine *memtx, struct info_handler *h)
 	info_table_end(h); /* index */
 }
 
+/** Appends memtx snapshot recovery stats to info. */
+static void
+memtx_engine_stat_recovery(struct memtx_engine *memtx,
+			   struct info_handler *h)
+{
+	struct memtx_recovery_stat *stat = &memtx->recovery_stat;
+	info_table_begin(h, "recovery");
+	info_append_int(h, "rows", stat->rows);
+	info_append_int(h, "bytes", stat->bytes);
+	info_append_double(h, "read_time", stat->read_time);
+	info_append_double(h, "apply_time", stat->apply_time);
+	info_append_double(h, "build_time", stat->build_time);
+	info_table_end(h); /* recovery */
+}
+
 void
 memtx_engine_stat(struct memtx_engine *memtx, struct info_handler *h)
 {
@@ -1943,6 +2773,7 @@ memtx_engine_stat(struct memtx_engine *memtx, struct info_handler *h)
 	memtx_engine_stat_data(memtx, h);
 	memtx_engine_stat_index(memtx, h);
 	memtx_engine_stat_tx(memtx, h);
+	memtx_engine_stat_recovery(memtx, h);
 	info_end(h);
 }
 
@@ -1961,6 +2792,26 @@ memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit)
 	memtx->snap_io_rate_limit = limit * 1024 * 1024;
 }
 
+void
+memtx_engine_set_snap_compression_level(struct memtx_engine *memtx,
+					int level)
+{
+	memtx->snap_compression_level = level;
+}
+
+void
+memtx_engine_set_snap_compression_dict(struct memtx_engine *memtx,
+				       bool compression_dict)
+{
+	memtx->snap_compression_dict = compression_dict;
+}
+
+void
+memtx_engine_set_snap_delta_max(struct memtx_engine *memtx, int delta_max)
+{
+	memtx->snap_delta_max = delta_max;
+}
+
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size)
 {
@@ -2065,6 +2916,8 @@ static void
 memtx_tuple_delete(struct tuple_format *format, struct tuple *tuple)
 {
 	assert(tuple_is_unreferenced(tuple));
+	if (format->is_compressed)
+		memtx_tuple_compression_on_delete(tuple);
 	MemtxAllocator<ALLOC>::free_tuple(tuple);
 	tuple_format_unref(format);
 }
@@ -2197,6 +3050,8 @@ memtx_index_def_change_requires_rebuild(struct index *index,
 		return true;
 	if (old_def->opts.hint != new_def->opts.hint)
 		return true;
+	if (old_def->opts.hash_bits != new_def->opts.hash_bits)
+		return true;
 
 	const struct key_def *old_cmp_def, *new_cmp_def;
 	if (index_depends_on_pk(index)) {
@@ -2269,8 +3124,8 @@ memtx_prepare_read_view_tuple(struct tuple *tuple,
 	result->data = tuple_data_range(tuple, &result->size);
 	if (!index->space->rv->disable_decompression) {
 		result->data = memtx_tuple_decompress_raw(
-				result->data, result->data + result->size,
-				&result->size);
+				tuple_format(tuple), result->data,
+				result->data + result->size, &result->size);
 		if (result->data == NULL)
 			return -1;
 	}
@@ -102,6 +102,23 @@ enum memtx_recovery_state {
 typedef void
 (*memtx_on_indexes_built_cb)(void);
 
+/** Statistics of the memtx snapshot recovery. */
+struct memtx_recovery_stat {
+	/** Number of rows recovered from the snapshot. */
+	int64_t rows;
+	/** Size of the recovered rows, in bytes. */
+	int64_t bytes;
+	/**
+	 * Time spent reading, decompressing and decoding the snapshot
+	 * by the snapshot reader thread, in seconds.
+	 */
+	double read_time;
+	/** Time spent applying snapshot rows in tx, in seconds. */
+	double apply_time;
+	/** Time spent building secondary keys, in seconds. */
+	double build_time;
+};
+
 struct memtx_engine {
 	struct engine base;
 	/** Engine recovery state, see enum memtx_recovery_state description. */
@@ -112,6 +129,39 @@ struct memtx_engine {
 	struct xdir snap_dir;
 	/** Limit disk usage of checkpointing (bytes per second). */
 	uint64_t snap_io_rate_limit;
+	/** zstd compression level of snapshot files, 0 - disabled. */
+	int snap_compression_level;
+	/**
+	 * Set if a zstd dictionary is trained for each snapshot file,
+	 * box.cfg.snap_compression_dict.
+	 */
+	bool snap_compression_dict;
+	/**
+	 * Max number of delta snapshots that may follow a full snapshot,
+	 * box.cfg.snap_delta_max. 0 - delta snapshots are disabled.
+	 */
+	int snap_delta_max;
+	/**
+	 * Checkpoint generation. Incremented when a checkpoint read view
+	 * is opened. A space is stamped with the current generation on
+	 * each change, see memtx_space::checkpoint_gen.
+	 */
+	uint64_t checkpoint_gen;
+	/**
+	 * Generation of the last committed checkpoint or 0 if there was
+	 * no checkpoint since the instance start. Spaces stamped with
+	 * a greater generation have changed since the last checkpoint.
+	 */
+	uint64_t last_checkpoint_gen;
+	/** Vclock of the last committed checkpoint. */
+	struct vclock last_checkpoint_vclock;
+	/** Ids of user spaces written to the last committed checkpoint. */
+	struct mh_i32_t *last_checkpoint_space_ids;
+	/**
+	 * Delta snapshots stored in the snapshot directory: maps the
+	 * signature of a delta snapshot to the signature of its base.
+	 */
+	struct mh_i64ptr_t *delta_snaps;
 	/** Skip invalid snapshot records if this flag is set. */
 	bool force_recovery;
 	/**
@@ -169,6 +219,8 @@ struct memtx_engine {
 	int sort_threads;
 	/** Set of extents allocated using malloc. */
 	struct mh_ptr_t *malloc_extents;
+	/** Snapshot recovery statistics. */
+	struct memtx_recovery_stat recovery_stat;
 };
 
 struct memtx_gc_task;
@@ -220,6 +272,17 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 void
 memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit);
 
+void
+memtx_engine_set_snap_compression_level(struct memtx_engine *memtx,
+					int level);
+
+void
+memtx_engine_set_snap_compression_dict(struct memtx_engine *memtx,
+				       bool compression_dict);
+
+void
+memtx_engine_set_snap_delta_max(struct memtx_engine *memtx, int delta_max);
+
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size);
 
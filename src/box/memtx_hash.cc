@@ -29,12 +29,14 @@
  * SUCH DAMAGE.
  */
 #include "memtx_hash.h"
+#include "memtx_arrow.h"
 #include "say.h"
 #include "fiber.h"
 #include "index.h"
 #include "tuple.h"
 #include "txn.h"
 #include "memtx_tx.h"
+#include "port.h"
 #include "memtx_engine.h"
 #include "memtx_tuple_compression.h"
 #include "space.h"
@@ -67,8 +69,20 @@ memtx_hash_equal_key(struct tuple *tuple, const char *key,
 #define LIGHT_EQUAL(a, b, c) memtx_hash_equal(a, b, c)
 #define LIGHT_EQUAL_KEY(a, b, c) memtx_hash_equal_key(a, b, c)
 
+#define LIGHT_NAMESPACE NS_HASH32
+
+#include "salad/light.h"
+
+#undef LIGHT_NAMESPACE
+
+#define LIGHT_NAMESPACE NS_HASH64
+#define LIGHT_HASH_TYPE uint64_t
+
 #include "salad/light.h"
 
+#undef LIGHT_NAMESPACE
+#undef LIGHT_HASH_TYPE
+
 #undef LIGHT_NAME
 #undef LIGHT_DATA_TYPE
 #undef LIGHT_KEY_TYPE
@@ -76,40 +90,103 @@ memtx_hash_equal_key(struct tuple *tuple, const char *key,
 #undef LIGHT_EQUAL
 #undef LIGHT_EQUAL_KEY
 
+/**
+ * Hash table types and hash functions of an index that stores
+ * 32-bit or 64-bit hashes, see index_opts::hash_bits. Light functions
+ * are found by argument-dependent lookup.
+ */
+template <bool USE_HASH64>
+struct memtx_hash_light;
+
+template <>
+struct memtx_hash_light<false> {
+	typedef NS_HASH32::light_index_core core;
+	typedef NS_HASH32::light_index_view view;
+	typedef NS_HASH32::light_index_iterator iterator;
+	typedef uint32_t hash_t;
+
+	static hash_t
+	tuple_hash(struct tuple *tuple, struct key_def *key_def)
+	{
+		return ::tuple_hash(tuple, key_def);
+	}
+
+	static hash_t
+	key_hash(const char *key, struct key_def *key_def)
+	{
+		return ::key_hash(key, key_def);
+	}
+};
+
+template <>
+struct memtx_hash_light<true> {
+	typedef NS_HASH64::light_index_core core;
+	typedef NS_HASH64::light_index_view view;
+	typedef NS_HASH64::light_index_iterator iterator;
+	typedef uint64_t hash_t;
+
+	static hash_t
+	tuple_hash(struct tuple *tuple, struct key_def *key_def)
+	{
+		return ::tuple_hash64(tuple, key_def);
+	}
+
+	static hash_t
+	key_hash(const char *key, struct key_def *key_def)
+	{
+		return ::key_hash64(key, key_def);
+	}
+};
+
+/** Special position meaning that nothing was found. */
+static const uint32_t light_index_end = NS_HASH32::light_index_end;
+static_assert(NS_HASH64::light_index_end == light_index_end,
+	      "light_index_end must not depend on the hash type");
+
+template <bool USE_HASH64>
 struct memtx_hash_index {
 	struct index base;
-	struct light_index_core hash_table;
+	typename memtx_hash_light<USE_HASH64>::core hash_table;
 	struct memtx_gc_task gc_task;
-	struct light_index_iterator gc_iterator;
+	typename memtx_hash_light<USE_HASH64>::iterator gc_iterator;
 };
 
 /* {{{ MemtxHash Iterators ****************************************/
 
+template <bool USE_HASH64>
 struct hash_iterator {
 	struct iterator base; /* Must be the first member. */
-	struct light_index_iterator iterator;
+	typename memtx_hash_light<USE_HASH64>::iterator iterator;
 	/** Memory pool the iterator was allocated from. */
 	struct mempool *pool;
 };
 
-static_assert(sizeof(struct hash_iterator) <= MEMTX_ITERATOR_SIZE,
-	      "sizeof(struct hash_iterator) must be less than or equal "
+static_assert(sizeof(struct hash_iterator<false>) <= MEMTX_ITERATOR_SIZE,
+	      "sizeof(struct hash_iterator<false>) must be less than or equal "
+	      "to MEMTX_ITERATOR_SIZE");
+static_assert(sizeof(struct hash_iterator<true>) <= MEMTX_ITERATOR_SIZE,
+	      "sizeof(struct hash_iterator<true>) must be less than or equal "
 	      "to MEMTX_ITERATOR_SIZE");
 
+template <bool USE_HASH64>
 static void
 hash_iterator_free(struct iterator *iterator)
 {
-	assert(iterator->free == hash_iterator_free);
-	struct hash_iterator *it = (struct hash_iterator *) iterator;
+	assert(iterator->free == hash_iterator_free<USE_HASH64>);
+	struct hash_iterator<USE_HASH64> *it =
+		(struct hash_iterator<USE_HASH64> *)iterator;
 	mempool_free(it->pool, it);
 }
 
+template <bool USE_HASH64>
 static int
 hash_iterator_ge_base(struct iterator *ptr, struct tuple **ret)
 {
-	assert(ptr->free == hash_iterator_free);
-	struct hash_iterator *it = (struct hash_iterator *) ptr;
-	struct memtx_hash_index *index = (struct memtx_hash_index *)
+	assert(ptr->free == hash_iterator_free<USE_HASH64>);
+	struct hash_iterator<USE_HASH64> *it =
+		(struct hash_iterator<USE_HASH64> *)ptr;
+	struct memtx_hash_index<USE_HASH64> *index =
+		(struct memtx_hash_index<USE_HASH64> *)
 		index_weak_ref_get_index_checked(&ptr->index_ref);
 	struct tuple **res = light_index_iterator_get_and_next(&index->hash_table,
 							       &it->iterator);
@@ -117,12 +194,15 @@ hash_iterator_ge_base(struct iterator *ptr, struct tuple **ret)
 	return 0;
 }
 
+template <bool USE_HASH64>
 static int
 hash_iterator_gt_base(struct iterator *ptr, struct tuple **ret)
 {
-	assert(ptr->free == hash_iterator_free);
-	struct hash_iterator *it = (struct hash_iterator *) ptr;
-	struct memtx_hash_index *index = (struct memtx_hash_index *)
+	assert(ptr->free == hash_iterator_free<USE_HASH64>);
+	struct hash_iterator<USE_HASH64> *it =
+		(struct hash_iterator<USE_HASH64> *)ptr;
+	struct memtx_hash_index<USE_HASH64> *index =
+		(struct memtx_hash_index<USE_HASH64> *)
 		index_weak_ref_get_index_checked(&ptr->index_ref);
 	struct tuple **res = light_index_iterator_get_and_next(&index->hash_table,
 							       &it->iterator);
@@ -134,6 +214,7 @@ hash_iterator_gt_base(struct iterator *ptr, struct tuple **ret)
 }
 
 #define WRAP_ITERATOR_METHOD(name)						\
+template <bool USE_HASH64>							\
 static int									\
 name(struct iterator *iterator, struct tuple **ret)				\
 {										\
@@ -145,10 +226,11 @@ name(struct iterator *iterator, struct tuple **ret)				\
 	do {									\
 		int rc;								\
 		if (is_first) {							\
-			rc = name##_base(iterator, ret);			\
-			iterator->next_internal = hash_iterator_ge;		\
+			rc = name##_base<USE_HASH64>(iterator, ret);		\
+			iterator->next_internal =				\
+				hash_iterator_ge<USE_HASH64>;			\
 		} else {							\
-			rc = hash_iterator_ge_base(iterator, ret);		\
+			rc = hash_iterator_ge_base<USE_HASH64>(iterator, ret);	\
 		}								\
 		if (rc != 0 || *ret == NULL)					\
 			return rc;						\
@@ -164,12 +246,13 @@ WRAP_ITERATOR_METHOD(hash_iterator_gt);
 
 #undef WRAP_ITERATOR_METHOD
 
+template <bool USE_HASH64>
 static int
 hash_iterator_eq(struct iterator *it, struct tuple **ret)
 {
 	it->next_internal = exhausted_iterator_next;
 	/* always returns zero. */
-	hash_iterator_ge_base(it, ret);
+	hash_iterator_ge_base<USE_HASH64>(it, ret);
 	if (*ret == NULL)
 		return 0;
 	struct txn *txn = in_txn();
@@ -184,13 +267,15 @@ hash_iterator_eq(struct iterator *it, struct tuple **ret)
 
 /* {{{ MemtxHash -- implementation of all hashes. **********************/
 
+template <bool USE_HASH64>
 static void
-memtx_hash_index_free(struct memtx_hash_index *index)
+memtx_hash_index_free(struct memtx_hash_index<USE_HASH64> *index)
 {
 	light_index_destroy(&index->hash_table);
 	free(index);
 }
 
+template <bool USE_HASH64>
 static void
 memtx_hash_index_gc_run(struct memtx_gc_task *task, bool *done)
 {
@@ -204,10 +289,11 @@ memtx_hash_index_gc_run(struct memtx_gc_task *task, bool *done)
 	enum { YIELD_LOOPS = 10 };
 #endif
 
-	struct memtx_hash_index *index = container_of(task,
-			struct memtx_hash_index, gc_task);
-	struct light_index_core *hash = &index->hash_table;
-	struct light_index_iterator *itr = &index->gc_iterator;
+	struct memtx_hash_index<USE_HASH64> *index = container_of(task,
+			struct memtx_hash_index<USE_HASH64>, gc_task);
+	typename memtx_hash_light<USE_HASH64>::core *hash = &index->hash_table;
+	typename memtx_hash_light<USE_HASH64>::iterator *itr =
+		&index->gc_iterator;
 
 	struct tuple **res;
 	unsigned int loops = 0;
@@ -221,23 +307,32 @@ memtx_hash_index_gc_run(struct memtx_gc_task *task, bool *done)
 	*done = true;
 }
 
+template <bool USE_HASH64>
 static void
 memtx_hash_index_gc_free(struct memtx_gc_task *task)
 {
-	struct memtx_hash_index *index = container_of(task,
-			struct memtx_hash_index, gc_task);
+	struct memtx_hash_index<USE_HASH64> *index = container_of(task,
+			struct memtx_hash_index<USE_HASH64>, gc_task);
 	memtx_hash_index_free(index);
 }
 
-static const struct memtx_gc_task_vtab memtx_hash_index_gc_vtab = {
-	.run = memtx_hash_index_gc_run,
-	.free = memtx_hash_index_gc_free,
-};
+template <bool USE_HASH64>
+static const struct memtx_gc_task_vtab *
+get_memtx_hash_index_gc_vtab(void)
+{
+	static const struct memtx_gc_task_vtab vtab = {
+		.run = memtx_hash_index_gc_run<USE_HASH64>,
+		.free = memtx_hash_index_gc_free<USE_HASH64>,
+	};
+	return &vtab;
+}
 
+template <bool USE_HASH64>
 static void
 memtx_hash_index_destroy(struct index *base)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	struct memtx_hash_index<USE_HASH64> *index =
+		(struct memtx_hash_index<USE_HASH64> *)base;
 	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
 	if (base->def->iid == 0) {
 		/*
@@ -245,7 +340,7 @@ memtx_hash_index_destroy(struct index *base)
 		 * in the index, which may take a while. Schedule a
 		 * background task in order not to block tx thread.
 		 */
-		index->gc_task.vtab = &memtx_hash_index_gc_vtab;
+		index->gc_task.vtab = get_memtx_hash_index_gc_vtab<USE_HASH64>();
 		light_index_iterator_begin(&index->hash_table,
 					   &index->gc_iterator);
 		memtx_engine_schedule_gc(memtx, &index->gc_task);
@@ -258,39 +353,48 @@ memtx_hash_index_destroy(struct index *base)
 	}
 }
 
+template <bool USE_HASH64>
 static void
 memtx_hash_index_update_def(struct index *base)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	struct memtx_hash_index<USE_HASH64> *index =
+		(struct memtx_hash_index<USE_HASH64> *)base;
 	index->hash_table.common.arg = index->base.def->key_def;
 }
 
+template <bool USE_HASH64>
 static ssize_t
 memtx_hash_index_size(struct index *base)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	struct memtx_hash_index<USE_HASH64> *index =
+		(struct memtx_hash_index<USE_HASH64> *)base;
 	struct space *space = space_by_id(base->def->space_id);
 	/* Substract invisible count. */
 	return light_index_count(&index->hash_table) -
 	       memtx_tx_index_invisible_count(in_txn(), space, base);
 }
 
+template <bool USE_HASH64>
 static ssize_t
 memtx_hash_index_bsize(struct index *base)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	struct memtx_hash_index<USE_HASH64> *index =
+		(struct memtx_hash_index<USE_HASH64> *)base;
 	return matras_extent_count(&index->hash_table.mtable) *
 					MEMTX_EXTENT_SIZE;
 }
 
+template <bool USE_HASH64>
 static int
 memtx_hash_index_random(struct index *base, uint32_t rnd, struct tuple **result)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	struct light_index_core *hash_table = &index->hash_table;
+	struct memtx_hash_index<USE_HASH64> *index =
+		(struct memtx_hash_index<USE_HASH64> *)base;
+	typename memtx_hash_light<USE_HASH64>::core *hash_table =
+		&index->hash_table;
 	struct txn *txn = in_txn();
 	struct space *space = space_by_id(base->def->space_id);
-	if (memtx_hash_index_size(base) == 0) {
+	if (memtx_hash_index_size<USE_HASH64>(base) == 0) {
 		*result = NULL;
 		memtx_tx_track_full_scan(txn, space, base);
 		return 0;
@@ -310,20 +414,23 @@ memtx_hash_index_random(struct index *base, uint32_t rnd, struct tuple **result)
 	return memtx_prepare_result_tuple(space, result);
 }
 
+template <bool USE_HASH64>
 static ssize_t
 memtx_hash_index_count(struct index *base, enum iterator_type type,
 		       const char *key, uint32_t part_count)
 {
 	if (type == ITER_ALL)
-		return memtx_hash_index_size(base); /* optimization */
+		return memtx_hash_index_size<USE_HASH64>(base); /* optimization */
 	return generic_index_count(base, type, key, part_count);
 }
 
+template <bool USE_HASH64>
 static int
 memtx_hash_index_get_internal(struct index *base, const char *key,
 			      uint32_t part_count, struct tuple **result)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	struct memtx_hash_index<USE_HASH64> *index =
+		(struct memtx_hash_index<USE_HASH64> *)base;
 
 	assert(base->def->opts.is_unique &&
 	       part_count == base->def->key_def->part_count);
@@ -332,7 +439,9 @@ memtx_hash_index_get_internal(struct index *base, const char *key,
 	struct space *space = space_by_id(base->def->space_id);
 	struct txn *txn = in_txn();
 	*result = NULL;
-	uint32_t h = key_hash(key, base->def->key_def);
+	typename memtx_hash_light<USE_HASH64>::hash_t h =
+		memtx_hash_light<USE_HASH64>::key_hash(key,
+						       base->def->key_def);
 	uint32_t k = light_index_find_key(&index->hash_table, h, key);
 	if (k != light_index_end) {
 		struct tuple *tuple = light_index_get(&index->hash_table, k);
@@ -343,6 +452,65 @@ memtx_hash_index_get_internal(struct index *base, const char *key,
 	return 0;
 }
 
+enum {
+	/**
+	 * How many keys ahead of the current one the hash table is
+	 * prefetched for in a batched lookup.
+	 */
+	MEMTX_HASH_GET_MANY_PREFETCH_DISTANCE = 8,
+};
+
+/**
+ * Batched lookup: the hashes of all keys are computed first, then the
+ * hash table slot of a key is prefetched a few lookups before it is
+ * needed so that the cache misses of consecutive lookups overlap.
+ */
+template <bool USE_HASH64>
+static int
+memtx_hash_index_get_many(struct index *base, const char **keys,
+			  uint32_t key_count, struct port *port)
+{
+	typedef typename memtx_hash_light<USE_HASH64>::hash_t hash_t;
+	struct memtx_hash_index<USE_HASH64> *index =
+		(struct memtx_hash_index<USE_HASH64> *)base;
+	assert(base->def->opts.is_unique);
+	struct key_def *key_def = base->def->key_def;
+	struct space *space = space_by_id(base->def->space_id);
+	struct txn *txn = in_txn();
+	struct region *region = &fiber()->gc;
+	RegionGuard region_guard(region);
+	hash_t *hashes = xregion_alloc_array(region, hash_t, key_count);
+	for (uint32_t i = 0; i < key_count; i++) {
+		hashes[i] = memtx_hash_light<USE_HASH64>::key_hash(keys[i],
+								   key_def);
+	}
+	uint32_t distance = MIN(key_count,
+				(uint32_t)MEMTX_HASH_GET_MANY_PREFETCH_DISTANCE);
+	for (uint32_t i = 0; i < distance; i++)
+		light_index_prefetch(&index->hash_table, hashes[i]);
+	for (uint32_t i = 0; i < key_count; i++) {
+		if (i + distance < key_count) {
+			light_index_prefetch(&index->hash_table,
+					     hashes[i + distance]);
+		}
+		struct tuple *tuple = NULL;
+		uint32_t k = light_index_find_key(&index->hash_table,
+						  hashes[i], keys[i]);
+		if (k != light_index_end) {
+			tuple = light_index_get(&index->hash_table, k);
+			tuple = memtx_tx_tuple_clarify(txn, space, tuple,
+						       base, 0);
+		} else {
+			memtx_tx_track_point(txn, space, base, keys[i]);
+		}
+		if (memtx_prepare_result_tuple(space, &tuple) != 0)
+			return -1;
+		if (tuple != NULL)
+			port_c_add_tuple(port, tuple);
+	}
+	return 0;
+}
+
 /**
  * If key is present then replace it's tuple with `new_tuple'. Otherwise
  * insert `new_tuple'. In case of replace old tuple is returned in `dup_tuple'.
@@ -352,12 +520,15 @@ memtx_hash_index_get_internal(struct index *base, const char *key,
  *
  * Returns 0 on success and -1 on OOM (diag is set).
  */
+template <bool USE_HASH64>
 static int
-memtx_hash_index_replace_impl(struct memtx_hash_index *index,
+memtx_hash_index_replace_impl(struct memtx_hash_index<USE_HASH64> *index,
 			      struct tuple *new_tuple, struct tuple **dup_tuple,
 			      uint32_t *pos)
 {
-	uint32_t h = tuple_hash(new_tuple, index->base.def->key_def);
+	typename memtx_hash_light<USE_HASH64>::hash_t h =
+		memtx_hash_light<USE_HASH64>::tuple_hash(
+			new_tuple, index->base.def->key_def);
 	if (index_inject_oom() != 0)
 		goto fail;
 	*pos = light_index_replace(&index->hash_table, h, new_tuple,
@@ -384,11 +555,14 @@ memtx_hash_index_replace_impl(struct memtx_hash_index *index,
  *
  * Returns 0 on success and -1 on OOM (diag is set).
  */
+template <bool USE_HASH64>
 static int
-memtx_hash_index_insert_impl(struct memtx_hash_index *index,
+memtx_hash_index_insert_impl(struct memtx_hash_index<USE_HASH64> *index,
 			     struct tuple *new_tuple)
 {
-	uint32_t h = tuple_hash(new_tuple, index->base.def->key_def);
+	typename memtx_hash_light<USE_HASH64>::hash_t h =
+		memtx_hash_light<USE_HASH64>::tuple_hash(
+			new_tuple, index->base.def->key_def);
 	if (index_inject_oom() != 0)
 		goto fail;
 	if (light_index_insert(&index->hash_table,
@@ -406,8 +580,10 @@ memtx_hash_index_insert_impl(struct memtx_hash_index *index,
  *
  * Returns 0 on success and -1 on OOM (diag is set).
  */
+template <bool USE_HASH64>
 static int
-memtx_hash_index_delete_impl(struct memtx_hash_index *index, uint32_t pos)
+memtx_hash_index_delete_impl(struct memtx_hash_index<USE_HASH64> *index,
+			     uint32_t pos)
 {
 	if (index_inject_oom() != 0)
 		goto fail;
@@ -425,11 +601,14 @@ memtx_hash_index_delete_impl(struct memtx_hash_index *index, uint32_t pos)
  *
  * Returns 0 on success and -1 on OOM (diag is set).
  */
+template <bool USE_HASH64>
 static int
-memtx_hash_index_delete_value_impl(struct memtx_hash_index *index,
+memtx_hash_index_delete_value_impl(struct memtx_hash_index<USE_HASH64> *index,
 				   struct tuple *tuple)
 {
-	uint32_t h = tuple_hash(tuple, index->base.def->key_def);
+	typename memtx_hash_light<USE_HASH64>::hash_t h =
+		memtx_hash_light<USE_HASH64>::tuple_hash(
+			tuple, index->base.def->key_def);
 	if (index_inject_oom() != 0)
 		goto fail;
 	if (light_index_delete_value(&index->hash_table, h, tuple) != 0)
@@ -440,12 +619,14 @@ memtx_hash_index_delete_value_impl(struct memtx_hash_index *index,
 	return -1;
 }
 
+template <bool USE_HASH64>
 static int
 memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 			 struct tuple *new_tuple, enum dup_replace_mode mode,
 			 struct tuple **result, struct tuple **successor)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	struct memtx_hash_index<USE_HASH64> *index =
+		(struct memtx_hash_index<USE_HASH64> *)base;
 
 	/* HASH index doesn't support ordering. */
 	*successor = NULL;
@@ -484,12 +665,14 @@ memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 }
 
 /** Implementation of create_iterator for memtx hash index. */
+template <bool USE_HASH64>
 static struct iterator *
 memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 				 const char *key, uint32_t part_count,
 				 const char *pos)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	struct memtx_hash_index<USE_HASH64> *index =
+		(struct memtx_hash_index<USE_HASH64> *)base;
 	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
 
 	assert(part_count == 0 || key != NULL);
@@ -498,16 +681,17 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 		return NULL;
 	}
 
-	struct hash_iterator *it = (struct hash_iterator *)
+	struct hash_iterator<USE_HASH64> *it =
+		(struct hash_iterator<USE_HASH64> *)
 		mempool_alloc(&memtx->iterator_pool);
 	if (it == NULL) {
-		diag_set(OutOfMemory, sizeof(struct hash_iterator),
+		diag_set(OutOfMemory, sizeof(struct hash_iterator<USE_HASH64>),
 			 "memtx_hash_index", "iterator");
 		return NULL;
 	}
 	iterator_create(&it->base, base);
 	it->pool = &memtx->iterator_pool;
-	it->base.free = hash_iterator_free;
+	it->base.free = hash_iterator_free<USE_HASH64>;
 	light_index_iterator_begin(&index->hash_table, &it->iterator);
 	struct space *space = index_weak_ref_get_space_checked(
 		&it->base.index_ref);
@@ -524,11 +708,12 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 
 		if (part_count != 0) {
 			light_index_iterator_key(&index->hash_table, &it->iterator,
-					key_hash(key, base->def->key_def), key);
-			it->base.next_internal = hash_iterator_gt;
+					memtx_hash_light<USE_HASH64>::key_hash(
+						key, base->def->key_def), key);
+			it->base.next_internal = hash_iterator_gt<USE_HASH64>;
 		} else {
 			light_index_iterator_begin(&index->hash_table, &it->iterator);
-			it->base.next_internal = hash_iterator_ge;
+			it->base.next_internal = hash_iterator_ge<USE_HASH64>;
 		}
 		/* This iterator needs to be supported as a legacy. */
 		memtx_tx_track_full_scan(in_txn(), space, &index->base);
@@ -536,14 +721,15 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 	}
 	case ITER_ALL:
 		light_index_iterator_begin(&index->hash_table, &it->iterator);
-		it->base.next_internal = hash_iterator_ge;
+		it->base.next_internal = hash_iterator_ge<USE_HASH64>;
 		memtx_tx_track_full_scan(in_txn(), space, &index->base);
 		break;
 	case ITER_EQ:
 		assert(part_count > 0);
 		light_index_iterator_key(&index->hash_table, &it->iterator,
-				key_hash(key, base->def->key_def), key);
-		it->base.next_internal = hash_iterator_eq;
+				memtx_hash_light<USE_HASH64>::key_hash(
+					key, base->def->key_def), key);
+		it->base.next_internal = hash_iterator_eq<USE_HASH64>;
 		if (it->iterator.slotpos == light_index_end)
 			memtx_tx_track_point(in_txn(), space,
 					     &index->base, key);
@@ -557,34 +743,42 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 }
 
 /** Read view implementation. */
+template <bool USE_HASH64>
 struct hash_read_view {
 	/** Base class. */
 	struct index_read_view base;
 	/** Read view index. Ref counter incremented. */
-	struct memtx_hash_index *index;
+	struct memtx_hash_index<USE_HASH64> *index;
 	/** Light read view. */
-	struct light_index_view view;
+	typename memtx_hash_light<USE_HASH64>::view view;
 	/** Used for clarifying read view tuples. */
 	struct memtx_tx_snapshot_cleaner cleaner;
 };
 
 /** Read view iterator implementation. */
+template <bool USE_HASH64>
 struct hash_read_view_iterator {
 	/** Base class. */
 	struct index_read_view_iterator_base base;
 	/** Light iterator. */
-	struct light_index_iterator iterator;
+	typename memtx_hash_light<USE_HASH64>::iterator iterator;
 };
 
-static_assert(sizeof(struct hash_read_view_iterator) <=
+static_assert(sizeof(struct hash_read_view_iterator<false>) <=
 	      INDEX_READ_VIEW_ITERATOR_SIZE,
-	      "sizeof(struct hash_read_view_iterator) must be less than or "
-	      "equal to INDEX_READ_VIEW_ITERATOR_SIZE");
+	      "sizeof(struct hash_read_view_iterator<false>) must be less "
+	      "than or equal to INDEX_READ_VIEW_ITERATOR_SIZE");
+static_assert(sizeof(struct hash_read_view_iterator<true>) <=
+	      INDEX_READ_VIEW_ITERATOR_SIZE,
+	      "sizeof(struct hash_read_view_iterator<true>) must be less "
+	      "than or equal to INDEX_READ_VIEW_ITERATOR_SIZE");
 
+template <bool USE_HASH64>
 static void
 hash_read_view_free(struct index_read_view *base)
 {
-	struct hash_read_view *rv = (struct hash_read_view *)base;
+	struct hash_read_view<USE_HASH64> *rv =
+		(struct hash_read_view<USE_HASH64> *)base;
 	light_index_view_destroy(&rv->view);
 	index_unref(&rv->index->base);
 	memtx_tx_snapshot_cleaner_destroy(&rv->cleaner);
@@ -596,27 +790,44 @@ hash_read_view_free(struct index_read_view *base)
 # include "memtx_hash_read_view.cc"
 #else /* !defined(ENABLE_READ_VIEW) */
 
+/**
+ * Implementation of get_raw index_read_view callback. Only the light
+ * read view and the read view's own copy of the index definition are
+ * used so the function may be called from any thread.
+ */
+template <bool USE_HASH64>
 static int
-hash_read_view_get_raw(struct index_read_view *rv,
+hash_read_view_get_raw(struct index_read_view *base,
 		       const char *key, uint32_t part_count,
 		       struct read_view_tuple *result)
 {
-	(void)rv;
-	(void)key;
+	struct hash_read_view<USE_HASH64> *rv =
+		(struct hash_read_view<USE_HASH64> *)base;
+	assert(part_count == base->def->key_def->part_count);
 	(void)part_count;
-	(void)result;
-	unreachable();
-	return 0;
+	typename memtx_hash_light<USE_HASH64>::hash_t h =
+		memtx_hash_light<USE_HASH64>::key_hash(key,
+						       base->def->key_def);
+	uint32_t k = light_index_view_find_key(&rv->view, h, key);
+	if (k == light_index_end) {
+		*result = read_view_tuple_none();
+		return 0;
+	}
+	struct tuple **tuple = light_index_view_get(&rv->view, k);
+	return memtx_prepare_read_view_tuple(*tuple, base, &rv->cleaner,
+					     result);
 }
 
 /** Implementation of next_raw index_read_view_iterator callback. */
+template <bool USE_HASH64>
 static int
 hash_read_view_iterator_next_raw(struct index_read_view_iterator *iterator,
 				 struct read_view_tuple *result)
 {
-	struct hash_read_view_iterator *it =
-		(struct hash_read_view_iterator *)iterator;
-	struct hash_read_view *rv = (struct hash_read_view *)it->base.index;
+	struct hash_read_view_iterator<USE_HASH64> *it =
+		(struct hash_read_view_iterator<USE_HASH64> *)iterator;
+	struct hash_read_view<USE_HASH64> *rv =
+		(struct hash_read_view<USE_HASH64> *)it->base.index;
 
 	while (true) {
 		struct tuple **res = light_index_view_iterator_get_and_next(
@@ -635,8 +846,9 @@ hash_read_view_iterator_next_raw(struct index_read_view_iterator *iterator,
 }
 
 /** Positions the iterator to the given key. */
+template <bool USE_HASH64>
 static int
-hash_read_view_iterator_start(struct hash_read_view_iterator *it,
+hash_read_view_iterator_start(struct hash_read_view_iterator<USE_HASH64> *it,
 			      enum iterator_type type,
 			      const char *key, uint32_t part_count)
 {
@@ -646,21 +858,24 @@ hash_read_view_iterator_start(struct hash_read_view_iterator *it,
 	(void)type;
 	(void)key;
 	(void)part_count;
-	struct hash_read_view *rv = (struct hash_read_view *)it->base.index;
-	it->base.next_raw = hash_read_view_iterator_next_raw;
+	struct hash_read_view<USE_HASH64> *rv =
+		(struct hash_read_view<USE_HASH64> *)it->base.index;
+	it->base.next_raw = hash_read_view_iterator_next_raw<USE_HASH64>;
 	light_index_view_iterator_begin(&rv->view, &it->iterator);
 	return 0;
 }
 
+template <bool USE_HASH64>
 static void
-hash_read_view_reset_key_def(struct hash_read_view *rv)
+hash_read_view_reset_key_def(struct hash_read_view<USE_HASH64> *rv)
 {
-	rv->view.common.arg = NULL;
+	rv->view.common.arg = rv->base.def->key_def;
 }
 
 #endif /* !defined(ENABLE_READ_VIEW) */
 
 /** Implementation of create_iterator index_read_view callback. */
+template <bool USE_HASH64>
 static int
 hash_read_view_create_iterator(struct index_read_view *base,
 			       enum iterator_type type,
@@ -672,9 +887,10 @@ hash_read_view_create_iterator(struct index_read_view *base,
 		diag_set(UnsupportedIndexFeature, base->def, "pagination");
 		return -1;
 	}
-	struct hash_read_view *rv = (struct hash_read_view *)base;
-	struct hash_read_view_iterator *it =
-		(struct hash_read_view_iterator *)iterator;
+	struct hash_read_view<USE_HASH64> *rv =
+		(struct hash_read_view<USE_HASH64> *)base;
+	struct hash_read_view_iterator<USE_HASH64> *it =
+		(struct hash_read_view_iterator<USE_HASH64> *)iterator;
 	it->base.index = base;
 	it->base.destroy = generic_index_read_view_iterator_destroy;
 	it->base.next_raw = exhausted_index_read_view_iterator_next_raw;
@@ -683,23 +899,41 @@ hash_read_view_create_iterator(struct index_read_view *base,
 	return hash_read_view_iterator_start(it, type, key, part_count);
 }
 
+/** Implementation of create_arrow_stream index_read_view callback. */
+template <bool USE_HASH64>
+static int
+hash_read_view_create_arrow_stream(struct index_read_view *base,
+				   uint32_t field_count, const uint32_t *fields,
+				   const char *key, uint32_t part_count,
+				   const struct arrow_options *options,
+				   struct ArrowArrayStream *stream)
+{
+	struct hash_read_view<USE_HASH64> *rv =
+		(struct hash_read_view<USE_HASH64> *)base;
+	return memtx_index_read_view_create_arrow_stream(
+		base, light_index_view_count(&rv->view), field_count, fields,
+		key, part_count, options, stream);
+}
+
 /** Implementation of create_read_view index callback. */
+template <bool USE_HASH64>
 static struct index_read_view *
 memtx_hash_index_create_read_view(struct index *base)
 {
 	static const struct index_read_view_vtab vtab = {
-		.free = hash_read_view_free,
+		.free = hash_read_view_free<USE_HASH64>,
 		.count = generic_index_read_view_count,
-		.get_raw = hash_read_view_get_raw,
-		.create_iterator = hash_read_view_create_iterator,
+		.get_raw = hash_read_view_get_raw<USE_HASH64>,
+		.create_iterator = hash_read_view_create_iterator<USE_HASH64>,
 		.create_iterator_with_offset =
 			generic_index_read_view_create_iterator_with_offset,
 		.create_arrow_stream =
-			generic_index_read_view_create_arrow_stream,
+			hash_read_view_create_arrow_stream<USE_HASH64>,
 	};
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	struct hash_read_view *rv =
-		(struct hash_read_view *)xmalloc(sizeof(*rv));
+	struct memtx_hash_index<USE_HASH64> *index =
+		(struct memtx_hash_index<USE_HASH64> *)base;
+	struct hash_read_view<USE_HASH64> *rv =
+		(struct hash_read_view<USE_HASH64> *)xmalloc(sizeof(*rv));
 	index_read_view_create(&rv->base, &vtab, base->def);
 	struct space *space = space_by_id(base->def->space_id);
 	assert(space != NULL);
@@ -711,47 +945,60 @@ memtx_hash_index_create_read_view(struct index *base)
 	return (struct index_read_view *)rv;
 }
 
-static const struct index_vtab memtx_hash_index_vtab = {
-	/* .destroy = */ memtx_hash_index_destroy,
-	/* .commit_create = */ generic_index_commit_create,
-	/* .abort_create = */ generic_index_abort_create,
-	/* .commit_modify = */ generic_index_commit_modify,
-	/* .commit_drop = */ generic_index_commit_drop,
-	/* .update_def = */ memtx_hash_index_update_def,
-	/* .depends_on_pk = */ generic_index_depends_on_pk,
-	/* .def_change_requires_rebuild = */
-		memtx_index_def_change_requires_rebuild,
-	/* .size = */ memtx_hash_index_size,
-	/* .bsize = */ memtx_hash_index_bsize,
-	/* .quantile = */ generic_index_quantile,
-	/* .min = */ generic_index_min,
-	/* .max = */ generic_index_max,
-	/* .random = */ memtx_hash_index_random,
-	/* .count = */ memtx_hash_index_count,
-	/* .get_internal = */ memtx_hash_index_get_internal,
-	/* .get = */ memtx_index_get,
-	/* .replace = */ memtx_hash_index_replace,
-	/* .create_iterator = */ memtx_hash_index_create_iterator,
-	/* .create_iterator_with_offset = */
-	generic_index_create_iterator_with_offset,
-	/* .create_arrow_stream = */ generic_index_create_arrow_stream,
-	/* .create_read_view = */ memtx_hash_index_create_read_view,
-	/* .stat = */ generic_index_stat,
-	/* .compact = */ generic_index_compact,
-	/* .reset_stat = */ generic_index_reset_stat,
-	/* .begin_build = */ generic_index_begin_build,
-	/* .reserve = */ generic_index_reserve,
-	/* .build_next = */ generic_index_build_next,
-	/* .end_build = */ generic_index_end_build,
-};
+/** Get index vtab by @a USE_HASH64. */
+template <bool USE_HASH64>
+static const struct index_vtab *
+get_memtx_hash_index_vtab(void)
+{
+	static const struct index_vtab vtab = {
+		/* .destroy = */ memtx_hash_index_destroy<USE_HASH64>,
+		/* .commit_create = */ generic_index_commit_create,
+		/* .abort_create = */ generic_index_abort_create,
+		/* .commit_modify = */ generic_index_commit_modify,
+		/* .commit_drop = */ generic_index_commit_drop,
+		/* .update_def = */ memtx_hash_index_update_def<USE_HASH64>,
+		/* .depends_on_pk = */ generic_index_depends_on_pk,
+		/* .def_change_requires_rebuild = */
+			memtx_index_def_change_requires_rebuild,
+		/* .size = */ memtx_hash_index_size<USE_HASH64>,
+		/* .bsize = */ memtx_hash_index_bsize<USE_HASH64>,
+		/* .quantile = */ generic_index_quantile,
+		/* .min = */ generic_index_min,
+		/* .max = */ generic_index_max,
+		/* .random = */ memtx_hash_index_random<USE_HASH64>,
+		/* .count = */ memtx_hash_index_count<USE_HASH64>,
+		/* .get_internal = */
+			memtx_hash_index_get_internal<USE_HASH64>,
+		/* .get = */ memtx_index_get,
+		/* .get_many = */ memtx_hash_index_get_many<USE_HASH64>,
+		/* .replace = */ memtx_hash_index_replace<USE_HASH64>,
+		/* .create_iterator = */
+			memtx_hash_index_create_iterator<USE_HASH64>,
+		/* .create_iterator_with_offset = */
+		generic_index_create_iterator_with_offset,
+		/* .create_arrow_stream = */ memtx_index_create_arrow_stream,
+		/* .create_read_view = */
+			memtx_hash_index_create_read_view<USE_HASH64>,
+		/* .stat = */ generic_index_stat,
+		/* .compact = */ generic_index_compact,
+		/* .reset_stat = */ generic_index_reset_stat,
+		/* .begin_build = */ generic_index_begin_build,
+		/* .reserve = */ generic_index_reserve,
+		/* .build_next = */ generic_index_build_next,
+		/* .end_build = */ generic_index_end_build,
+	};
+	return &vtab;
+}
 
-struct index *
-memtx_hash_index_new(struct memtx_engine *memtx, struct index_def *def)
+template <bool USE_HASH64>
+static struct index *
+memtx_hash_index_new_tpl(struct memtx_engine *memtx, struct index_def *def)
 {
-	struct memtx_hash_index *index =
-		(struct memtx_hash_index *)xcalloc(1, sizeof(*index));
+	struct memtx_hash_index<USE_HASH64> *index =
+		(struct memtx_hash_index<USE_HASH64> *)
+		xcalloc(1, sizeof(*index));
 	index_create(&index->base, (struct engine *)memtx,
-		     &memtx_hash_index_vtab, def);
+		     get_memtx_hash_index_vtab<USE_HASH64>(), def);
 
 	light_index_create(&index->hash_table, index->base.def->key_def,
 			   &memtx->index_extent_allocator,
@@ -759,4 +1006,12 @@ memtx_hash_index_new(struct memtx_engine *memtx, struct index_def *def)
 	return &index->base;
 }
 
+struct index *
+memtx_hash_index_new(struct memtx_engine *memtx, struct index_def *def)
+{
+	if (def->opts.hash_bits == 64)
+		return memtx_hash_index_new_tpl<true>(memtx, def);
+	return memtx_hash_index_new_tpl<false>(memtx, def);
+}
+
 /* }}} */
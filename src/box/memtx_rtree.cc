@@ -412,6 +412,7 @@ static const struct index_vtab memtx_rtree_index_vtab = {
 	/* .count = */ memtx_rtree_index_count,
 	/* .get_internal = */ memtx_rtree_index_get_internal,
 	/* .get = */ memtx_index_get,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_rtree_index_replace,
 	/* .create_iterator = */ memtx_rtree_index_create_iterator,
 	/* .create_iterator_with_offset = */
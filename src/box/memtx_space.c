@@ -29,6 +29,7 @@
  * SUCH DAMAGE.
  */
 #include "memtx_space.h"
+#include "arrow_insert.h"
 #include "space.h"
 #include "space_upgrade.h"
 #include "iproto_constants.h"
@@ -392,6 +393,7 @@ memtx_space_replace_tuple(struct space *space, struct txn_stmt *stmt,
 				      mode, &result);
 	if (rc != 0)
 		goto finish;
+	memtx_space_touch(space);
 	txn_stmt_prepare_rollback_info(stmt, result, new_tuple);
 	stmt->engine_savepoint = stmt;
 	stmt->new_tuple = orig_new_tuple;
@@ -404,8 +406,6 @@ memtx_space_replace_tuple(struct space *space, struct txn_stmt *stmt,
 		tuple_ref(stmt->old_tuple);
 		tuple_unref(orig_old_tuple);
 	}
-	if (space->upgrade != NULL && new_tuple != NULL)
-		memtx_space_upgrade_track_tuple(space->upgrade, new_tuple);
 finish:
 	/*
 	 * Regardless of whether the function ended with success or
@@ -425,9 +425,12 @@ memtx_space_execute_replace(struct space *space, struct txn *txn,
 {
 	struct txn_stmt *stmt = txn_current_stmt(txn);
 	enum dup_replace_mode mode = dup_replace_mode(request->type);
+	struct tuple_format *format = space->format;
+	if (unlikely(space->upgrade != NULL))
+		format = memtx_space_upgrade_tuple_format(space->upgrade);
 	struct tuple *new_tuple =
-		space->format->vtab.tuple_new(space->format, request->tuple,
-					      request->tuple_end);
+		format->vtab.tuple_new(format, request->tuple,
+				       request->tuple_end);
 	if (new_tuple == NULL) {
 		error_set_space(diag_last_error(diag_get()), space->def);
 		return -1;
@@ -766,6 +769,12 @@ memtx_space_check_index_def(struct space *space, struct index_def *index_def)
 			return -1;
 		}
 	}
+	if (index_def->type != HASH && index_def->opts.hash_bits != 32) {
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name(space),
+			 "hash_bits is only reasonable with memtx hash index");
+		return -1;
+	}
 	switch (index_def->type) {
 	case HASH:
 		if (! index_def->opts.is_unique) {
@@ -1019,8 +1028,87 @@ struct memtx_ddl_state {
 	struct rlist stmt_triggers;
 	struct diag diag;
 	int rc;
+	/*
+	 * If set, concurrent changes are appended to the change log
+	 * instead of being applied to the index being built, see
+	 * memtx_space_bulk_build_index().
+	 */
+	bool use_log;
+	/* Log of concurrent changes. */
+	struct memtx_ddl_change *log;
+	/* Number of entries in the log. */
+	size_t log_size;
+	/* Number of entries allocated for the log. */
+	size_t log_capacity;
+};
+
+/* A change made to a space while its index is being bulk-built. */
+struct memtx_ddl_change {
+	/* Tuple to delete from the index or NULL. Referenced. */
+	struct tuple *old_tuple;
+	/* Tuple to insert into the index or NULL. Referenced. */
+	struct tuple *new_tuple;
+	/* Set if the change reverts a rolled back statement. */
+	bool is_rollback;
 };
 
+/* Appends a change to the DDL change log. */
+static void
+memtx_ddl_log_append(struct memtx_ddl_state *state, struct tuple *old_tuple,
+		     struct tuple *new_tuple, bool is_rollback)
+{
+	assert(state->use_log);
+	if (state->log_size == state->log_capacity) {
+		state->log_capacity = MAX(state->log_capacity * 2, 64);
+		state->log = xrealloc(state->log, state->log_capacity *
+						  sizeof(*state->log));
+	}
+	struct memtx_ddl_change *change = &state->log[state->log_size++];
+	change->old_tuple = old_tuple;
+	change->new_tuple = new_tuple;
+	change->is_rollback = is_rollback;
+	if (old_tuple != NULL)
+		tuple_ref(old_tuple);
+	if (new_tuple != NULL)
+		tuple_ref(new_tuple);
+}
+
+/* Applies the DDL change log to the index being built. */
+static int
+memtx_ddl_log_replay(struct memtx_ddl_state *state)
+{
+	enum dup_replace_mode mode =
+		state->index->def->opts.is_unique ? DUP_INSERT :
+						    DUP_REPLACE_OR_INSERT;
+	for (size_t i = 0; i < state->log_size; i++) {
+		struct memtx_ddl_change *change = &state->log[i];
+		struct tuple *delete = NULL;
+		struct tuple *successor = NULL;
+		/* See memtx_build_on_replace_rollback(). */
+		if (index_replace(state->index, change->old_tuple,
+				  change->new_tuple,
+				  change->is_rollback ? DUP_REPLACE_OR_INSERT :
+							mode,
+				  &delete, &successor) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/* Frees the DDL change log. */
+static void
+memtx_ddl_log_destroy(struct memtx_ddl_state *state)
+{
+	for (size_t i = 0; i < state->log_size; i++) {
+		struct memtx_ddl_change *change = &state->log[i];
+		if (change->old_tuple != NULL)
+			tuple_unref(change->old_tuple);
+		if (change->new_tuple != NULL)
+			tuple_unref(change->new_tuple);
+	}
+	free(state->log);
+}
+
 static int
 memtx_check_on_replace(struct trigger *trigger, void *event)
 {
@@ -1183,10 +1271,15 @@ memtx_build_on_replace_rollback(struct trigger *base, void *event)
 
 	/* The trigger is fired and will be deleted - remove from the state. */
 	rlist_del_entry(trigger, in_state);
+	assert(stmt != NULL);
+	if (state->use_log) {
+		memtx_ddl_log_append(state, stmt->new_tuple, stmt->old_tuple,
+				     true);
+		return 0;
+	}
 	/*
 	 * Old tuple's format is valid if it exists.
 	 */
-	assert(stmt != NULL);
 	assert(stmt->old_tuple == NULL ||
 	       memtx_tuple_validate(state->format, stmt->old_tuple) == 0);
 
@@ -1232,6 +1325,39 @@ memtx_build_on_replace_commit(struct trigger *base, void *event)
 	return 0;
 }
 
+/**
+ * Applies a concurrent replace to the already built part of an index.
+ * On failure moves the error to the DDL state.
+ */
+static int
+memtx_build_apply_replace(struct memtx_ddl_state *state,
+			  struct txn_stmt *stmt)
+{
+	struct tuple *delete = NULL;
+	enum dup_replace_mode mode =
+		state->index->def->opts.is_unique ? DUP_INSERT :
+						    DUP_REPLACE_OR_INSERT;
+	struct tuple *successor;
+	state->rc = index_replace(state->index, stmt->old_tuple,
+				  stmt->new_tuple, mode, &delete, &successor);
+	if (state->rc != 0) {
+		diag_move(diag_get(), &state->diag);
+		return -1;
+	}
+	/*
+	 * All tuples stored in a memtx space are
+	 * referenced by the primary index. That is
+	 * why we need to ref new tuple and unref old tuple.
+	 */
+	if (state->index->def->iid == 0) {
+		if (stmt->new_tuple != NULL)
+			tuple_ref(stmt->new_tuple);
+		if (stmt->old_tuple != NULL)
+			tuple_unref(stmt->old_tuple);
+	}
+	return 0;
+}
+
 static int
 memtx_build_on_replace(struct trigger *trigger, void *event)
 {
@@ -1243,9 +1369,11 @@ memtx_build_on_replace(struct trigger *trigger, void *event)
 							    stmt->old_tuple;
 	/*
 	 * Only update the already built part of an index. All the other
-	 * tuples will be inserted when build continues.
+	 * tuples will be inserted when build continues. No cursor means
+	 * that all tuples have been processed.
 	 */
-	if (tuple_compare(state->cursor, HINT_NONE, cmp_tuple, HINT_NONE,
+	if (state->cursor != NULL &&
+	    tuple_compare(state->cursor, HINT_NONE, cmp_tuple, HINT_NONE,
 			  state->cmp_def) < 0)
 		return 0;
 
@@ -1256,28 +1384,13 @@ memtx_build_on_replace(struct trigger *trigger, void *event)
 		return 0;
 	}
 
-	struct tuple *delete = NULL;
-	enum dup_replace_mode mode =
-		state->index->def->opts.is_unique ? DUP_INSERT :
-						    DUP_REPLACE_OR_INSERT;
-	struct tuple *successor;
-	state->rc = index_replace(state->index, stmt->old_tuple,
-				  stmt->new_tuple, mode, &delete, &successor);
-	if (state->rc != 0) {
-		diag_move(diag_get(), &state->diag);
+	if (state->use_log) {
+		/* The change is applied when the index is built. */
+		memtx_ddl_log_append(state, stmt->old_tuple, stmt->new_tuple,
+				     false);
+	} else if (memtx_build_apply_replace(state, stmt) != 0) {
 		return 0;
 	}
-	/*
-	 * All tuples stored in a memtx space are
-	 * referenced by the primary index. That is
-	 * why we need to ref new tuple and unref old tuple.
-	 */
-	if (state->index->def->iid == 0) {
-		if (stmt->new_tuple != NULL)
-			tuple_ref(stmt->new_tuple);
-		if (stmt->old_tuple != NULL)
-			tuple_unref(stmt->old_tuple);
-	}
 	/*
 	 * Set on_rollback trigger on stmt to avoid
 	 * problem when rollbacked changes appears in
@@ -1298,6 +1411,232 @@ memtx_build_on_replace(struct trigger *trigger, void *event)
 	return 0;
 }
 
+/**
+ * Returns true if a secondary index can be built with
+ * memtx_space_bulk_build_index().
+ */
+static bool
+memtx_space_can_bulk_build_index(struct space *space, struct index *pk,
+				 struct index *new_index)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)space->engine;
+	struct key_def *key_def = new_index->def->key_def;
+	/*
+	 * The primary key must be ordered to track concurrent changes
+	 * with a cursor. With MVCC, concurrent writes conflict with
+	 * the DDL so they aren't logged.
+	 */
+	if (new_index->def->iid == 0 || new_index->def->type != TREE ||
+	    key_def->is_multikey || key_def->for_func_index ||
+	    pk->def->type != TREE || memtx_tx_manager_use_mvcc_engine ||
+	    memtx->state != MEMTX_OK)
+		return false;
+	struct errinj *inj = errinj(ERRINJ_BUILD_INDEX_DISABLE_YIELD,
+				   ERRINJ_BOOL);
+	return inj == NULL || !inj->bparam;
+}
+
+/**
+ * Checks if the index build must be aborted after a yield: the fiber
+ * was cancelled or a concurrent change failed.
+ */
+static int
+memtx_ddl_state_check(struct memtx_ddl_state *state)
+{
+	if (fiber_is_cancelled()) {
+		diag_set(FiberIsCancelled);
+		return -1;
+	}
+	if (state->rc != 0) {
+		diag_move(&state->diag, diag_get());
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Returns true if the given tuple is stored in the space with
+ * the given primary key.
+ */
+static int
+memtx_space_tuple_is_stored(struct index *pk, struct tuple *tuple,
+			    bool *is_stored)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char *key = tuple_extract_key(tuple, pk->def->key_def,
+					    MULTIKEY_NONE, NULL);
+	if (key == NULL)
+		return -1;
+	uint32_t part_count = mp_decode_array(&key);
+	struct tuple *found;
+	int rc = index_get_internal(pk, key, part_count, &found);
+	region_truncate(region, region_svp);
+	*is_stored = found == tuple;
+	return rc;
+}
+
+/**
+ * Checks a bulk-built unique index for duplicates. Before the change
+ * log is applied, the index may contain tuples that were replaced or
+ * deleted concurrently, so equal keys are a conflict only if both
+ * tuples are still stored in the space.
+ */
+static int
+memtx_space_check_bulk_built_index(struct index *pk,
+				   struct memtx_ddl_state *state)
+{
+	struct index *index = state->index;
+	struct key_def *key_def = index->def->key_def;
+	struct iterator *it = index_create_iterator(index, ITER_ALL, NULL, 0);
+	if (it == NULL)
+		return -1;
+	int rc;
+	size_t count = 0;
+	struct tuple *prev = NULL;
+	struct tuple *tuple;
+	while ((rc = iterator_next_internal(it, &tuple)) == 0 &&
+	       tuple != NULL) {
+		bool is_dup = prev != NULL &&
+			      !(key_def->is_nullable &&
+				tuple_key_contains_null(tuple, key_def,
+							MULTIKEY_NONE)) &&
+			      tuple_compare(prev, HINT_NONE, tuple, HINT_NONE,
+					    key_def) == 0;
+		bool is_prev_stored = true, is_stored = true;
+		if (is_dup &&
+		    (memtx_space_tuple_is_stored(pk, tuple, &is_stored) != 0 ||
+		     memtx_space_tuple_is_stored(pk, prev,
+						 &is_prev_stored) != 0)) {
+			rc = -1;
+			break;
+		}
+		if (is_dup && is_stored && is_prev_stored) {
+			diag_set(ClientError, ER_TUPLE_FOUND,
+				 index->def->name, index->def->space_name,
+				 tuple_str(prev), tuple_str(tuple),
+				 prev, tuple);
+			rc = -1;
+			break;
+		}
+		/* Compare the following tuples with a stored one. */
+		if (is_stored)
+			prev = tuple;
+		/*
+		 * The index isn't modified during yields. Tuples deleted
+		 * concurrently are referenced by the change log.
+		 */
+		if (++count % MEMTX_DDL_YIELD_LOOPS == 0) {
+			fiber_sleep(0);
+			rc = memtx_ddl_state_check(state);
+			if (rc != 0)
+				break;
+		}
+	}
+	iterator_delete(it);
+	return rc;
+}
+
+/**
+ * Builds a secondary tree index of a space in normal operation.
+ *
+ * Inserting tuples one by one into the tree is slow, so the index is
+ * built in stages instead:
+ *
+ * 1. Tuples are collected from the primary key into the build array
+ *    of the new index, yielding periodically.
+ * 2. The array is sorted on memtx_sort_threads threads while the tx
+ *    thread yields, and the tree is bulk-loaded from it.
+ * 3. The unique constraint is checked, and changes made to the space
+ *    during the build are applied to the index from the change log.
+ *    The last step doesn't yield so the index is up-to-date when
+ *    the function returns.
+ *
+ * A concurrent change is logged if it touches a tuple that has already
+ * been collected. Logged tuples are referenced so that the sort threads
+ * never access a freed tuple.
+ */
+static int
+memtx_space_bulk_build_index(struct space *src_space, struct index *pk,
+			     struct index *new_index,
+			     struct tuple_format *new_format)
+{
+	struct memtx_ddl_state state;
+	state.index = new_index;
+	state.format = new_format;
+	state.cursor = NULL;
+	state.cmp_def = pk->def->key_def;
+	state.rc = 0;
+	state.use_log = true;
+	state.log = NULL;
+	state.log_size = 0;
+	state.log_capacity = 0;
+	diag_create(&state.diag);
+	rlist_create(&state.stmt_triggers);
+
+	struct trigger on_replace;
+	trigger_create(&on_replace, memtx_build_on_replace, &state, NULL);
+	trigger_add(&src_space->on_replace, &on_replace);
+
+	int rc = -1;
+	struct key_def *key_def = new_index->def->key_def;
+	struct iterator *it = NULL;
+	index_begin_build(new_index);
+	if (index_reserve(new_index, index_size(pk)) != 0)
+		goto out;
+	it = index_create_iterator(pk, ITER_ALL, NULL, 0);
+	if (it == NULL)
+		goto out;
+	struct tuple *tuple;
+	size_t count = 0;
+	while ((rc = iterator_next_internal(it, &tuple)) == 0 &&
+	       tuple != NULL) {
+		if (!tuple_format_is_compatible_with_key_def(tuple_format(tuple),
+							     key_def)) {
+			rc = -1;
+			break;
+		}
+		rc = memtx_tuple_validate(new_format, tuple);
+		if (rc != 0)
+			break;
+		rc = index_build_next(new_index, tuple);
+		if (rc != 0)
+			break;
+		ERROR_INJECT_DOUBLE(ERRINJ_BUILD_INDEX_TIMEOUT, inj->dparam > 0,
+				    thread_sleep(inj->dparam));
+		state.cursor = tuple;
+		tuple_ref(state.cursor);
+		if (++count % MEMTX_DDL_YIELD_LOOPS == 0)
+			fiber_sleep(0);
+		ERROR_INJECT_YIELD(ERRINJ_BUILD_INDEX_DELAY);
+		tuple_unref(state.cursor);
+		rc = memtx_ddl_state_check(&state);
+		if (rc != 0)
+			break;
+	}
+	iterator_delete(it);
+	if (rc != 0)
+		goto out;
+	/* All tuples are collected, log all changes from now on. */
+	state.cursor = NULL;
+	index_end_build(new_index);
+	rc = memtx_ddl_state_check(&state);
+	if (rc == 0 && new_index->def->opts.is_unique)
+		rc = memtx_space_check_bulk_built_index(pk, &state);
+	if (rc == 0)
+		rc = memtx_ddl_log_replay(&state);
+out:
+	trigger_clear(&on_replace);
+	struct memtx_build_stmt_trigger *trg;
+	rlist_foreach_entry(trg, &state.stmt_triggers, in_state) {
+		trigger_clear(&trg->on_rollback);
+		trigger_clear(&trg->on_commit);
+	}
+	memtx_ddl_log_destroy(&state);
+	diag_destroy(&state.diag);
+	return rc;
+}
+
 static int
 memtx_space_build_index(struct space *src_space, struct index *new_index,
 			struct tuple_format *new_format,
@@ -1332,6 +1671,10 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 	if (txn_check_singlestatement(txn, "index build") != 0)
 		return -1;
 
+	if (memtx_space_can_bulk_build_index(src_space, pk, new_index))
+		return memtx_space_bulk_build_index(src_space, pk, new_index,
+						    new_format);
+
 	/* Now deal with any kind of add index during normal operation. */
 	struct iterator *it = index_create_iterator(pk, ITER_ALL, NULL, 0);
 	if (it == NULL)
@@ -1360,7 +1703,9 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 		state.index = new_index;
 		state.format = new_format;
 		state.cmp_def = pk->def->key_def;
+		state.cursor = NULL;
 		state.rc = 0;
+		state.use_log = false;
 		diag_create(&state.diag);
 		rlist_create(&state.stmt_triggers);
 
@@ -1537,7 +1882,7 @@ static const struct space_vtab memtx_space_vtab = {
 	/* .execute_delete = */ memtx_space_execute_delete,
 	/* .execute_update = */ memtx_space_execute_update,
 	/* .execute_upsert = */ memtx_space_execute_upsert,
-	/* .execute_insert_arrow = */ generic_space_execute_insert_arrow,
+	/* .execute_insert_arrow = */ arrow_insert_rows,
 	/* .ephemeral_replace = */ memtx_space_ephemeral_replace,
 	/* .ephemeral_delete = */ memtx_space_ephemeral_delete,
 	/* .ephemeral_rowid_next = */ memtx_space_ephemeral_rowid_next,
@@ -1594,5 +1939,6 @@ memtx_space_new(struct memtx_engine *memtx,
 	memset(&memtx_space->tuple_stat, 0, sizeof(memtx_space->tuple_stat));
 	memtx_space->rowid = 0;
 	memtx_space->replace = memtx_space_replace_no_keys;
+	memtx_space->checkpoint_gen = memtx->checkpoint_gen;
 	return (struct space *)memtx_space;
 }
@@ -62,6 +62,12 @@ struct memtx_space {
 	 */
 	int (*replace)(struct space *, struct tuple *, struct tuple *,
 		       enum dup_replace_mode, struct tuple **);
+	/**
+	 * Value of memtx_engine::checkpoint_gen at the time of the last
+	 * change of the space data. Used to skip spaces that haven't
+	 * changed since the last checkpoint in delta snapshots.
+	 */
+	uint64_t checkpoint_gen;
 };
 
 /**
@@ -102,6 +108,19 @@ memtx_space_is_recovering(struct space *space)
 	return memtx->state < MEMTX_OK;
 }
 
+/**
+ * Mark the space data as changed since the last checkpoint. Must be
+ * called on each change of the space data, including commit and
+ * rollback of a statement.
+ */
+static inline void
+memtx_space_touch(struct space *space)
+{
+	assert(space_is_memtx(space));
+	struct memtx_engine *memtx = (struct memtx_engine *)space->engine;
+	((struct memtx_space *)space)->checkpoint_gen = memtx->checkpoint_gen;
+}
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -8,22 +8,71 @@
 #include <stddef.h>
 
 #include "diag.h"
+#include "engine.h"
 #include "errcode.h"
+#include "fiber.h"
+#include "index.h"
 #include "space.h"
 #include "space_def.h"
+#include "space_upgrade.h"
+#include "tuple_format.h"
 
 #if defined(ENABLE_SPACE_UPGRADE)
 # error unimplemented
 #endif
 
+/**
+ * Creates a format for tuples recovered while the upgrade is in progress.
+ * Such tuples may be stored in either the old or the new format, so the
+ * format only checks fields indexed by the new space.
+ */
+static struct tuple_format *
+memtx_space_upgrade_recovery_format_new(struct space *space)
+{
+	size_t region_svp = region_used(&fiber()->gc);
+	struct key_def **keys = xregion_alloc_array(&fiber()->gc,
+						    struct key_def *,
+						    space->index_count);
+	for (uint32_t i = 0; i < space->index_count; i++)
+		keys[i] = space->index[i]->def->key_def;
+	struct tuple_format *format = tuple_format_new(
+		&space->format->vtab, space->format->engine, keys,
+		space->index_count, NULL, 0, 0, NULL,
+		space->format->is_temporary, false, NULL, 0, NULL, 0);
+	region_truncate(&fiber()->gc, region_svp);
+	return format;
+}
+
 int
 memtx_space_prepare_upgrade(struct space *old_space, struct space *new_space)
 {
-	(void)old_space;
-	if (new_space->def->opts.upgrade_def != NULL) {
-		diag_set(ClientError, ER_UNSUPPORTED, "Community edition",
-			 "space upgrade");
+	if (new_space->def->opts.upgrade_def == NULL)
+		return 0;
+	/*
+	 * Tuples may be upgraded only once: the upgrade function expects
+	 * a tuple in the format the space had before the upgrade started.
+	 */
+	if (old_space->upgrade != NULL &&
+	    old_space->upgrade->status != SPACE_UPGRADE_ERROR &&
+	    recovery_state == FINISHED_RECOVERY) {
+		diag_set(ClientError, ER_ALTER_SPACE, space_name(old_space),
+			 "space upgrade is in progress");
 		return -1;
 	}
-	return 0;
+	struct tuple_format *format =
+		memtx_space_upgrade_recovery_format_new(new_space);
+	if (format == NULL)
+		return -1;
+	tuple_format_ref(format);
+	new_space->upgrade = space_upgrade_new(new_space, format);
+	tuple_format_unref(format);
+	return new_space->upgrade != NULL ? 0 : -1;
+}
+
+struct tuple_format *
+memtx_space_upgrade_tuple_format(struct space_upgrade *upgrade)
+{
+	if (recovery_state != FINISHED_RECOVERY)
+		return upgrade->recovery_format;
+	return upgrade->space->format;
 }
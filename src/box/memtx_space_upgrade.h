@@ -23,36 +23,19 @@ struct space;
 struct space_upgrade;
 struct space_upgrade_read_view;
 struct tuple;
+struct tuple_format;
 
 /** Memtx implementation of space_vtab::prepare_upgrade. */
 int
 memtx_space_prepare_upgrade(struct space *old_space, struct space *new_space);
 
 /**
- * Adds a tuple to the upgraded tuple set.
- * The tuple must not be in the set.
+ * Returns the format for tuples inserted into a space that is being
+ * upgraded. Tuples recovered from disk may be stored in either the old
+ * or the new format so they get a format that only checks indexed fields.
  */
-static inline void
-memtx_space_upgrade_track_tuple(struct space_upgrade *upgrade,
-				struct tuple *tuple)
-{
-	(void)upgrade;
-	(void)tuple;
-	unreachable();
-}
-
-/**
- * Removes a tuple from the upgraded tuple set.
- * Does nothing if the tuple isn't in the set.
- */
-static inline void
-memtx_space_upgrade_untrack_tuple(struct space_upgrade *upgrade,
-				  struct tuple *tuple)
-{
-	(void)upgrade;
-	(void)tuple;
-	unreachable();
-}
+struct tuple_format *
+memtx_space_upgrade_tuple_format(struct space_upgrade *upgrade);
 
 /**
  * Returns true if a tuple fetched from a read view needs to be upgraded.
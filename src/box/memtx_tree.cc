@@ -29,6 +29,7 @@
  * SUCH DAMAGE.
  */
 #include "memtx_tree.h"
+#include "memtx_arrow.h"
 #include "memtx_engine.h"
 #include "memtx_tuple_compression.h"
 #include "space.h"
@@ -40,6 +41,7 @@
 #include "tuple.h"
 #include "txn.h"
 #include "memtx_tx.h"
+#include "port.h"
 #include "trivia/config.h"
 #include "trivia/util.h"
 #include "tt_sort.h"
@@ -1330,6 +1332,112 @@ memtx_tree_index_get_internal(struct index *base, const char *key,
 	return 0;
 }
 
+/** A key of a batched lookup in a memtx tree index. */
+struct memtx_tree_get_many_key {
+	/** Key parts without the MsgPack array header. */
+	const char *key;
+	/** Comparison hint of the key. */
+	hint_t hint;
+	/** Position of the key in the batch. */
+	uint32_t pos;
+};
+
+/** Argument of memtx_tree_get_many_key_compare(). */
+struct memtx_tree_get_many_compare_arg {
+	/** Number of parts in every key. */
+	uint32_t part_count;
+	/** Definition used for key comparison. */
+	struct key_def *cmp_def;
+};
+
+static int
+memtx_tree_get_many_key_compare(const void *a, const void *b, void *arg)
+{
+	const struct memtx_tree_get_many_key *key_a =
+		(const struct memtx_tree_get_many_key *)a;
+	const struct memtx_tree_get_many_key *key_b =
+		(const struct memtx_tree_get_many_key *)b;
+	struct memtx_tree_get_many_compare_arg *cmp_arg =
+		(struct memtx_tree_get_many_compare_arg *)arg;
+	return key_compare(key_a->key, cmp_arg->part_count, key_a->hint,
+			   key_b->key, cmp_arg->part_count, key_b->hint,
+			   cmp_arg->cmp_def);
+}
+
+/**
+ * Batched lookup: the keys are sorted before descending the tree so
+ * that consecutive lookups walk mostly the same inner blocks, which
+ * stay in the CPU cache, instead of jumping between random subtrees.
+ * The descents themselves are interleaved by memtx_tree_find_many()
+ * so that cache misses of different keys overlap.
+ */
+template <bool USE_HINT>
+static int
+memtx_tree_index_get_many(struct index *base, const char **keys,
+			  uint32_t key_count, struct port *port)
+{
+	assert(base->def->opts.is_unique);
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base;
+	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	uint32_t part_count = base->def->key_def->part_count;
+	struct txn *txn = in_txn();
+	struct space *space = space_by_id(base->def->space_id);
+	bool is_multikey = base->def->key_def->is_multikey;
+	struct region *region = &fiber()->gc;
+	RegionGuard region_guard(region);
+	struct memtx_tree_get_many_key *sorted =
+		xregion_alloc_array(region, typeof(*sorted), key_count);
+	struct tuple **results =
+		xregion_alloc_array(region, typeof(*results), key_count);
+	for (uint32_t i = 0; i < key_count; i++) {
+		sorted[i].key = keys[i];
+		sorted[i].hint = USE_HINT ?
+				 key_hint(keys[i], part_count, cmp_def) :
+				 HINT_NONE;
+		sorted[i].pos = i;
+	}
+	struct memtx_tree_get_many_compare_arg cmp_arg;
+	cmp_arg.part_count = part_count;
+	cmp_arg.cmp_def = cmp_def;
+	tt_sort(sorted, key_count, sizeof(sorted[0]),
+		memtx_tree_get_many_key_compare, &cmp_arg, 1);
+	struct memtx_tree_key_data<USE_HINT> *key_data =
+		xregion_alloc_array(region, typeof(*key_data), key_count);
+	struct memtx_tree_key_data<USE_HINT> **key_ptrs =
+		xregion_alloc_array(region, typeof(*key_ptrs), key_count);
+	struct memtx_tree_data<USE_HINT> **found =
+		xregion_alloc_array(region, typeof(*found), key_count);
+	for (uint32_t i = 0; i < key_count; i++) {
+		key_data[i].key = sorted[i].key;
+		key_data[i].part_count = part_count;
+		if (USE_HINT)
+			key_data[i].set_hint(sorted[i].hint);
+		key_ptrs[i] = &key_data[i];
+	}
+	memtx_tree_find_many(&index->tree, key_ptrs, key_count, found);
+	for (uint32_t i = 0; i < key_count; i++) {
+		struct memtx_tree_data<USE_HINT> *res = found[i];
+		struct tuple *tuple = NULL;
+		if (res == NULL) {
+			memtx_tx_track_point(txn, space, base, sorted[i].key);
+		} else {
+			uint32_t mk_index = is_multikey ?
+					    (uint32_t)res->hint : 0;
+			tuple = memtx_tx_tuple_clarify(txn, space, res->tuple,
+						       base, mk_index);
+		}
+		results[sorted[i].pos] = tuple;
+	}
+	for (uint32_t i = 0; i < key_count; i++) {
+		if (memtx_prepare_result_tuple(space, &results[i]) != 0)
+			return -1;
+		if (results[i] != NULL)
+			port_c_add_tuple(port, results[i]);
+	}
+	return 0;
+}
+
 /**
  * Implementation of iterator position for general and multikey indexes.
  */
@@ -2452,6 +2560,28 @@ tree_read_view_create_iterator(struct index_read_view *base,
 		base, type, key, part_count, pos, 0, iterator);
 }
 
+/** Implementation of create_arrow_stream index_read_view callback. */
+template <bool USE_HINT>
+static int
+tree_read_view_create_arrow_stream(struct index_read_view *base,
+				   uint32_t field_count, const uint32_t *fields,
+				   const char *key, uint32_t part_count,
+				   const struct arrow_options *options,
+				   struct ArrowArrayStream *stream)
+{
+	struct key_def *key_def = base->def->key_def;
+	if (key_def->is_multikey || key_def->for_func_index) {
+		return generic_index_read_view_create_arrow_stream(
+			base, field_count, fields, key, part_count, options,
+			stream);
+	}
+	struct tree_read_view<USE_HINT> *rv =
+		(struct tree_read_view<USE_HINT> *)base;
+	return memtx_index_read_view_create_arrow_stream(
+		base, memtx_tree_view_size(&rv->tree_view), field_count,
+		fields, key, part_count, options, stream);
+}
+
 /** Implementation of create_read_view index callback. */
 template <bool USE_HINT>
 static struct index_read_view *
@@ -2465,7 +2595,7 @@ memtx_tree_index_create_read_view(struct index *base)
 		.create_iterator_with_offset =
 			tree_read_view_create_iterator_with_offset<USE_HINT>,
 		.create_arrow_stream =
-			generic_index_read_view_create_arrow_stream,
+			tree_read_view_create_arrow_stream<USE_HINT>,
 	};
 	struct memtx_tree_index<USE_HINT> *index =
 		(struct memtx_tree_index<USE_HINT> *)base;
@@ -2507,6 +2637,7 @@ static const struct index_vtab memtx_tree_disabled_index_vtab = {
 	/* .count = */ generic_index_count,
 	/* .get_internal = */ generic_index_get_internal,
 	/* .get = */ generic_index_get,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ disabled_index_replace,
 	/* .create_iterator = */ generic_index_create_iterator,
 	/* .create_iterator_with_offset = */
@@ -2571,6 +2702,7 @@ get_memtx_tree_index_vtab(void)
 		/* .count = */ memtx_tree_index_count<USE_HINT>,
 		/* .get_internal */ memtx_tree_index_get_internal<USE_HINT>,
 		/* .get = */ memtx_index_get,
+		/* .get_many = */ memtx_tree_index_get_many<USE_HINT>,
 		/* .replace = */ is_mk ? memtx_tree_index_replace_multikey :
 				 is_func ? memtx_tree_func_index_replace :
 				 memtx_tree_index_replace<USE_HINT>,
@@ -2578,7 +2710,9 @@ get_memtx_tree_index_vtab(void)
 			memtx_tree_index_create_iterator<USE_HINT>,
 		/* .create_iterator_with_offset = */
 		memtx_tree_index_create_iterator_with_offset<USE_HINT>,
-		/* .create_arrow_stream = */ generic_index_create_arrow_stream,
+		/* .create_arrow_stream = */ is_mk || is_func ?
+			generic_index_create_arrow_stream :
+			memtx_index_create_arrow_stream,
 		/* .create_read_view = */
 			memtx_tree_index_create_read_view<USE_HINT>,
 		/* .stat = */ generic_index_stat,
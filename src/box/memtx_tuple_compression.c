@@ -0,0 +1,292 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2025, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "memtx_tuple_compression.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "msgpuck.h"
+#include "small/region.h"
+
+#include "diag.h"
+#include "error.h"
+#include "fiber.h"
+#include "memtx_engine.h"
+#include "mp_compression.h"
+#include "mp_extension_types.h"
+#include "trivia/util.h"
+#include "tuple.h"
+#include "tuple_format.h"
+
+#if defined(ENABLE_TUPLE_COMPRESSION)
+# error unimplemented
+#endif
+
+/**
+ * Fields smaller than this are never compressed: the compression header
+ * would eat up all the savings.
+ */
+enum { MEMTX_TUPLE_COMPRESSION_MIN_SIZE = 64 };
+
+/** Compression statistics, updated in the tx thread only. */
+static struct memtx_tuple_compression_stat compression_stat;
+
+/** Checks if a MsgPack value is MP_COMPRESSION. */
+static inline bool
+mp_is_compression(const char *data)
+{
+	if (mp_typeof(*data) != MP_EXT)
+		return false;
+	int8_t type;
+	mp_decode_extl(&data, &type);
+	return type == MP_COMPRESSION;
+}
+
+/**
+ * Returns the compression type of field @a fieldno declared in the tuple
+ * format. Only fields declared with compression may be stored compressed:
+ * MP_COMPRESSION values in other fields came from the user and are opaque.
+ */
+static inline enum compression_type
+memtx_tuple_field_compression(struct tuple_format *format, uint32_t fieldno)
+{
+	if (!format->is_compressed ||
+	    fieldno >= tuple_format_field_count(format))
+		return COMPRESSION_TYPE_NONE;
+	return tuple_format_field(format, fieldno)->compression_type;
+}
+
+/** Checks if field @a fieldno with data @a field is stored compressed. */
+static inline bool
+memtx_tuple_field_is_compressed(struct tuple_format *format, uint32_t fieldno,
+				const char *field)
+{
+	return memtx_tuple_field_compression(format, fieldno) !=
+	       COMPRESSION_TYPE_NONE && mp_is_compression(field);
+}
+
+struct tuple *
+memtx_tuple_compress(struct tuple *tuple)
+{
+	struct tuple_format *format = tuple_format(tuple);
+	assert(format->is_compressed);
+	uint32_t bsize;
+	const char *data = tuple_data_range(tuple, &bsize);
+	const char *pos = data;
+	uint32_t field_count = mp_decode_array(&pos);
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	/* Fields are replaced only if they shrink. */
+	char *new_data = xregion_alloc(region, bsize);
+	char *new_pos = new_data;
+	memcpy(new_pos, data, pos - data);
+	new_pos += pos - data;
+
+	size_t raw_size = 0;
+	size_t compressed_size = 0;
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		size_t size = pos - field;
+		enum compression_type type =
+			memtx_tuple_field_compression(format, i);
+		if (type != COMPRESSION_TYPE_NONE && mp_is_compression(field)) {
+			/*
+			 * Only memtx may compress fields, otherwise reads
+			 * would fail on a value that isn't a valid frame.
+			 */
+			diag_set(ClientError, ER_COMPRESSION,
+				 tt_sprintf("field %u is already compressed",
+					    i + 1));
+			region_truncate(region, region_svp);
+			return NULL;
+		}
+		if (type != COMPRESSION_TYPE_NONE &&
+		    size >= MEMTX_TUPLE_COMPRESSION_MIN_SIZE) {
+			char *buf = xregion_alloc(
+				region, mp_sizeof_compression_max(size, type));
+			char *buf_end = mp_compress(buf, field, size, type);
+			if (buf_end == NULL) {
+				diag_set(ClientError, ER_COMPRESSION,
+					 tt_sprintf("failed to compress "
+						    "field %u", i + 1));
+				region_truncate(region, region_svp);
+				return NULL;
+			}
+			if ((size_t)(buf_end - buf) < size) {
+				memcpy(new_pos, buf, buf_end - buf);
+				new_pos += buf_end - buf;
+				raw_size += size;
+				compressed_size += buf_end - buf;
+				continue;
+			}
+		}
+		memcpy(new_pos, field, size);
+		new_pos += size;
+	}
+	assert(pos == data + bsize);
+	assert(new_pos <= new_data + bsize);
+	if (compressed_size == 0) {
+		region_truncate(region, region_svp);
+		return tuple;
+	}
+	/* The original tuple has already been validated. */
+	struct tuple *new_tuple = memtx_tuple_new_raw(format, new_data, new_pos,
+						      /*validate=*/false);
+	region_truncate(region, region_svp);
+	if (new_tuple == NULL)
+		return NULL;
+	compression_stat.raw_size += raw_size;
+	compression_stat.compressed_size += compressed_size;
+	return new_tuple;
+}
+
+struct tuple *
+memtx_tuple_decompress(struct tuple *tuple)
+{
+	if (!tuple_is_compressed(tuple))
+		return tuple;
+	uint32_t bsize;
+	const char *data = tuple_data_range(tuple, &bsize);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t size;
+	const char *new_data = memtx_tuple_decompress_raw(tuple_format(tuple),
+							  data, data + bsize,
+							  &size);
+	if (new_data == NULL) {
+		region_truncate(region, region_svp);
+		return NULL;
+	}
+	if (new_data == data)
+		return tuple;
+	struct tuple *new_tuple = memtx_tuple_new_raw(tuple_format(tuple),
+						      new_data,
+						      new_data + size,
+						      /*validate=*/false);
+	region_truncate(region, region_svp);
+	return new_tuple;
+}
+
+const char *
+memtx_tuple_decompress_raw(struct tuple_format *format, const char *tuple,
+			   const char *tuple_end, uint32_t *p_size)
+{
+	if (!format->is_compressed) {
+		*p_size = tuple_end - tuple;
+		return tuple;
+	}
+	const char *pos = tuple;
+	uint32_t field_count = mp_decode_array(&pos);
+	const char *fields = pos;
+	size_t size = pos - tuple;
+	bool is_compressed = false;
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		if (!memtx_tuple_field_is_compressed(format, i, field)) {
+			size += pos - field;
+			continue;
+		}
+		size_t raw_size = mp_compression_raw_size(field);
+		if (raw_size == 0)
+			goto corrupted;
+		size += raw_size;
+		is_compressed = true;
+	}
+	assert(pos == tuple_end);
+	if (!is_compressed) {
+		*p_size = tuple_end - tuple;
+		return tuple;
+	}
+	if (size > UINT32_MAX) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 "decompressed tuple is too large");
+		return NULL;
+	}
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	char *data = xregion_alloc(region, size);
+	char *data_pos = data;
+	memcpy(data_pos, tuple, fields - tuple);
+	data_pos += fields - tuple;
+	pos = fields;
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		if (!memtx_tuple_field_is_compressed(format, i, field)) {
+			mp_next(&pos);
+			memcpy(data_pos, field, pos - field);
+			data_pos += pos - field;
+			continue;
+		}
+		size_t raw_size = mp_decompress(&pos, data_pos,
+						data + size - data_pos);
+		if (raw_size == 0) {
+			region_truncate(region, region_svp);
+			goto corrupted;
+		}
+		data_pos += raw_size;
+	}
+	assert(data_pos == data + size);
+	*p_size = size;
+	return data;
+corrupted:
+	diag_set(ClientError, ER_DECOMPRESSION, "corrupted tuple data");
+	return NULL;
+}
+
+int
+memtx_tuple_field_decompress(struct tuple_format *format, uint32_t fieldno,
+			     const char **field)
+{
+	if (*field == NULL ||
+	    !memtx_tuple_field_is_compressed(format, fieldno, *field))
+		return 0;
+	const char *pos = *field;
+	size_t raw_size = mp_compression_raw_size(pos);
+	if (raw_size == 0)
+		goto corrupted;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	char *data = xregion_alloc(region, raw_size);
+	if (mp_decompress(&pos, data, raw_size) != raw_size) {
+		region_truncate(region, region_svp);
+		goto corrupted;
+	}
+	*field = data;
+	return 0;
+corrupted:
+	diag_set(ClientError, ER_DECOMPRESSION, "corrupted tuple data");
+	return -1;
+}
+
+void
+memtx_tuple_compression_on_delete(struct tuple *tuple)
+{
+	struct tuple_format *format = tuple_format(tuple);
+	uint32_t bsize;
+	const char *pos = tuple_data_range(tuple, &bsize);
+	uint32_t field_count = mp_decode_array(&pos);
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		if (!memtx_tuple_field_is_compressed(format, i, field))
+			continue;
+		size_t raw_size = mp_compression_raw_size(field);
+		size_t compressed_size = pos - field;
+		assert(compression_stat.raw_size >= raw_size);
+		assert(compression_stat.compressed_size >= compressed_size);
+		compression_stat.raw_size -= raw_size;
+		compression_stat.compressed_size -= compressed_size;
+	}
+}
+
+void
+memtx_tuple_compression_stat(struct memtx_tuple_compression_stat *stat)
+{
+	*stat = compression_stat;
+}
@@ -11,34 +11,73 @@
 # include "memtx_tuple_compression_impl.h"
 #else /* !defined(ENABLE_TUPLE_COMPRESSION) */
 
-#include "tuple.h"
+#include <stddef.h>
+#include <stdint.h>
 
 #if defined(__cplusplus)
 extern "C" {
 #endif
 
-static inline struct tuple *
-memtx_tuple_compress(struct tuple *tuple)
-{
-        (void)tuple;
-        unreachable();
-        return NULL;
-}
-
-static inline struct tuple *
-memtx_tuple_decompress(struct tuple *tuple)
-{
-	assert(!tuple_is_compressed(tuple));
-	return tuple;
-}
-
-static inline const char *
-memtx_tuple_decompress_raw(const char *tuple, const char *tuple_end,
-			   uint32_t *p_size)
-{
-	*p_size = tuple_end - tuple;
-	return tuple;
-}
+struct tuple;
+struct tuple_format;
+
+/** Statistics of memtx tuple compression. */
+struct memtx_tuple_compression_stat {
+	/** Size of compressed fields before compression, in bytes. */
+	size_t raw_size;
+	/** Size of compressed fields after compression, in bytes. */
+	size_t compressed_size;
+};
+
+/**
+ * Returns a tuple with fields compressed according to the tuple format.
+ * Fields that don't shrink after compression are stored as is. If no
+ * field was compressed, returns the original tuple. On error returns
+ * NULL and sets diag.
+ */
+struct tuple *
+memtx_tuple_compress(struct tuple *tuple);
+
+/**
+ * Returns a tuple with all fields decompressed. If the tuple has no
+ * compressed fields, returns the original tuple. On error returns NULL
+ * and sets diag.
+ */
+struct tuple *
+memtx_tuple_decompress(struct tuple *tuple);
+
+/**
+ * Decompresses the data of a tuple with the given format. Only fields
+ * declared with compression in the format are decompressed. If the data
+ * has no compressed fields, returns it as is, otherwise the decompressed
+ * data is allocated on the fiber region. On error returns NULL and sets
+ * diag.
+ */
+const char *
+memtx_tuple_decompress_raw(struct tuple_format *format, const char *tuple,
+			   const char *tuple_end, uint32_t *p_size);
+
+/**
+ * Decompresses a single field of a tuple with the given format, leaving
+ * the other fields intact. @a field points to the field data or NULL.
+ * If the field is stored compressed, it is replaced with a pointer to
+ * the decompressed data allocated on the fiber region. Returns 0 on
+ * success. On error returns -1 and sets diag.
+ */
+int
+memtx_tuple_field_decompress(struct tuple_format *format, uint32_t fieldno,
+			     const char **field);
+
+/**
+ * Accounts the compressed fields of a tuple that is about to be deleted
+ * in the compression statistics.
+ */
+void
+memtx_tuple_compression_on_delete(struct tuple *tuple);
+
+/** Returns memtx tuple compression statistics. */
+void
+memtx_tuple_compression_stat(struct memtx_tuple_compression_stat *stat);
 
 #if defined(__cplusplus)
 } /* extern "C" */
@@ -30,6 +30,7 @@
  */
 #include "recovery.h"
 
+#include "small/ibuf.h"
 #include "small/rlist.h"
 #include "scoped_guard.h"
 #include "trigger.h"
@@ -38,6 +39,7 @@
 #include "xrow.h"
 #include "xstream.h"
 #include "wal.h" /* wal_watcher */
+#include "wal_tail.h"
 #include "replication.h"
 #include "session.h"
 #include "coio_file.h"
@@ -101,6 +103,9 @@ recovery_new(const char *wal_dirname, bool force_recovery,
 	r->wal_dir.force_recovery = force_recovery;
 
 	vclock_copy(&r->vclock, vclock);
+	r->cursor_row_count = 0;
+	r->tail_seq = -1;
+	r->tail_file = -1;
 
 	/**
 	 * Avoid scanning WAL dir before we recovered
@@ -175,6 +180,7 @@ recovery_open_log(struct recovery *r, const struct vclock *vclock)
 	recovery_close_log(r);
 
 	xdir_open_cursor_xc(&r->wal_dir, vclock_sum(vclock), &r->cursor);
+	r->cursor_row_count = 0;
 
 	if (state == XLOG_CURSOR_NEW &&
 	    vclock_compare(vclock, &r->vclock) > 0) {
@@ -236,6 +242,59 @@ recovery_delete(struct recovery *r)
 	free(r);
 }
 
+/**
+ * Feed a row read from a WAL to the stream and promote the recovery
+ * vclock, unless the row has already been applied.
+ *
+ * @param is_sending_tx is set if a transaction is being sent,
+ *                      i.e. its last row hasn't been read yet.
+ */
+static void
+recover_row(struct recovery *r, struct xstream *stream,
+	    struct xrow_header *row, bool *is_sending_tx)
+{
+	/*
+	 * All rows in xlog files have an assigned replica
+	 * id. The only exception are local rows, which
+	 * are signed with a zero replica id.
+	 */
+	assert(row->replica_id != 0 || row->group_id == GROUP_LOCAL);
+	int64_t current_lsn = vclock_get(&r->vclock, row->replica_id);
+	if (row->lsn <= current_lsn) {
+		/*
+		 * Skip the already applied row, if it is not needed to
+		 * preserve transaction boundaries (is not the last row
+		 * of a currently recovered transaction). Otherwise,
+		 * replace it with a NOP, so that the transaction end
+		 * flag reaches the receiver, but the data isn't
+		 * recovered twice.
+		 */
+		if (!*is_sending_tx || !row->is_commit)
+			return; /* already applied, skip */
+		row->type = IPROTO_NOP;
+		row->bodycnt = 0;
+		row->body[0].iov_base = NULL;
+		row->body[0].iov_len = 0;
+	} else {
+		/*
+		 * We can promote the vclock either before or
+		 * after xstream_write(): it only makes any impact
+		 * in case of forced recovery, when we skip the
+		 * failed row anyway.
+		 */
+		vclock_follow_xrow(&r->vclock, row);
+	}
+	*is_sending_tx = !row->is_commit;
+	if (xstream_write(stream, row) != 0) {
+		if (!r->wal_dir.force_recovery)
+			diag_raise();
+
+		say_error("skipping row {%u: %lld}",
+			  (unsigned)row->replica_id, (long long)row->lsn);
+		diag_log();
+	}
+}
+
 /**
  * Read all rows in a file starting from the last position.
  * Advance the position. If end of file is reached,
@@ -251,6 +310,7 @@ recover_xlog(struct recovery *r, struct xstream *stream,
 	bool is_sending_tx = false;
 	while (xlog_cursor_next_xc(&r->cursor, &row,
 				   r->wal_dir.force_recovery) == 0) {
+		r->cursor_row_count++;
 		if (++stream->row_count % WAL_ROWS_PER_YIELD == 0) {
 			xstream_yield(stream);
 		}
@@ -270,46 +330,7 @@ recover_xlog(struct recovery *r, struct xstream *stream,
 		    r->vclock.signature >= stop_vclock->signature)
 			return;
 
-		/*
-		 * All rows in xlog files have an assigned replica
-		 * id. The only exception are local rows, which
-		 * are signed with a zero replica id.
-		 */
-		assert(row.replica_id != 0 || row.group_id == GROUP_LOCAL);
-		int64_t current_lsn = vclock_get(&r->vclock, row.replica_id);
-		if (row.lsn <= current_lsn) {
-			/*
-			 * Skip the already applied row, if it is not needed to
-			 * preserve transaction boundaries (is not the last row
-			 * of a currently recovered transaction). Otherwise,
-			 * replace it with a NOP, so that the transaction end
-			 * flag reaches the receiver, but the data isn't
-			 * recovered twice.
-			 */
-			if (!is_sending_tx || !row.is_commit)
-				continue; /* already applied, skip */
-			row.type = IPROTO_NOP;
-			row.bodycnt = 0;
-			row.body[0].iov_base = NULL;
-			row.body[0].iov_len = 0;
-		} else {
-			/*
-			 * We can promote the vclock either before or
-			 * after xstream_write(): it only makes any impact
-			 * in case of forced recovery, when we skip the
-			 * failed row anyway.
-			 */
-			vclock_follow_xrow(&r->vclock, &row);
-		}
-		is_sending_tx = !row.is_commit;
-		if (xstream_write(stream, &row) != 0) {
-			if (!r->wal_dir.force_recovery)
-				diag_raise();
-
-			say_error("skipping row {%u: %lld}",
-				  (unsigned)row.replica_id, (long long)row.lsn);
-			diag_log();
-		}
+		recover_row(r, stream, &row, &is_sending_tx);
 	}
 }
 
@@ -380,6 +401,74 @@ recover_remaining_wals(struct recovery *r, struct xstream *stream,
 		tnt_raise(XlogGapError, &r->vclock, stop_vclock);
 }
 
+/**
+ * Switch to the next WAL file while reading rows from the WAL tail.
+ * The current file is done so close it as if it was read from disk.
+ */
+static void
+recovery_switch_tail_file(struct recovery *r, int64_t file)
+{
+	if (xlog_cursor_is_open(&r->cursor))
+		xlog_cursor_close(&r->cursor, false);
+	r->tail_file = file;
+	trigger_run_xc(&r->on_close_log, NULL);
+}
+
+bool
+recover_wal_tail(struct recovery *r, struct xstream *stream,
+		 struct ibuf *buf)
+{
+	if (r->tail_seq < 0) {
+		/*
+		 * Look up the position at which we stopped reading
+		 * the current WAL file in the WAL tail.
+		 */
+		if (!xlog_cursor_is_open(&r->cursor))
+			return false;
+		r->tail_file = vclock_sum(&r->cursor.meta.vclock);
+		r->tail_seq = wal_tail_find(r->tail_file, r->cursor_row_count);
+		if (r->tail_seq < 0)
+			return false;
+	}
+	bool is_sending_tx = false;
+	int count;
+	while ((count = wal_tail_read(r->tail_seq, buf)) > 0) {
+		for (int i = 0; i < count; i++) {
+			struct wal_tail_row_header header;
+			memcpy(&header, buf->rpos, sizeof(header));
+			buf->rpos += sizeof(header);
+			const char *data = buf->rpos;
+			buf->rpos += header.size;
+			if (header.file != r->tail_file)
+				recovery_switch_tail_file(r, header.file);
+			struct xrow_header row;
+			if (xrow_decode(&row, &data, buf->rpos, true) != 0)
+				diag_raise();
+			r->tail_seq++;
+			if (++stream->row_count % WAL_ROWS_PER_YIELD == 0)
+				xstream_yield(stream);
+			recover_row(r, stream, &row, &is_sending_tx);
+		}
+		ibuf_reset(buf);
+	}
+	if (count == 0)
+		return true;
+	/*
+	 * The next row has been evicted from the WAL tail so we have
+	 * to read WAL files starting from the current vclock. If the
+	 * cursor was closed on switching to the next file, reset it so
+	 * that it's reopened as on the first scan: there's no file we
+	 * read last to check the reopened one against. Rescan the WAL
+	 * directory, because we could miss WAL rotation events while
+	 * reading the tail.
+	 */
+	r->tail_seq = -1;
+	if (!xlog_cursor_is_open(&r->cursor))
+		r->cursor.state = XLOG_CURSOR_NEW;
+	xdir_scan_xc(&r->wal_dir, true);
+	return false;
+}
+
 void
 recovery_finalize(struct recovery *r)
 {
@@ -40,6 +40,7 @@
 extern "C" {
 #endif /* defined(__cplusplus) */
 
+struct ibuf;
 struct xrow_header;
 struct xstream;
 
@@ -47,6 +48,15 @@ struct recovery {
 	struct vclock vclock;
 	/** The WAL cursor we're currently reading/writing from/to. */
 	struct xlog_cursor cursor;
+	/** Number of rows read from the current WAL file. */
+	int64_t cursor_row_count;
+	/**
+	 * Sequence number of the next row to read from the WAL tail
+	 * or -1 if rows are read from WAL files, see wal_tail.h.
+	 */
+	int64_t tail_seq;
+	/** Signature of the WAL file of the last row read from the tail. */
+	int64_t tail_file;
 	struct xdir wal_dir;
 	/**
 	 * This fiber is used in local hot standby mode.
@@ -104,4 +114,17 @@ void
 recover_remaining_wals(struct recovery *r, struct xstream *stream,
 		       const struct vclock *stop_vclock, bool scan_dir);
 
+/**
+ * Read rows following the current position from the WAL tail,
+ * see wal_tail.h. The rows are copied to the given buffer.
+ *
+ * Returns false if the rows following the current position aren't
+ * stored in the WAL tail (the reader lags behind or hasn't caught up
+ * with the WAL yet), in which case they must be read from WAL files
+ * with recover_remaining_wals().
+ */
+bool
+recover_wal_tail(struct recovery *r, struct xstream *stream,
+		 struct ibuf *buf);
+
 #endif /* TARANTOOL_RECOVERY_H_INCLUDED */
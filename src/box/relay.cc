@@ -54,6 +54,7 @@
 #include "xrow_io.h"
 #include "xstream.h"
 #include "wal.h"
+#include "wal_tail.h"
 #include "txn_limbo.h"
 #include "raft.h"
 #include "box.h"
@@ -121,6 +122,12 @@ struct relay {
 	struct recovery *r;
 	/** Xstream argument to recovery */
 	struct xstream stream;
+	/** Buffer for rows read from the WAL tail. */
+	struct ibuf wal_tail_buf;
+	/** Number of WAL events handled by reading the WAL tail. */
+	int64_t wal_tail_hits;
+	/** Number of WAL events handled by reading WAL files. */
+	int64_t wal_tail_misses;
 	/** A region used to save rows when collecting transactions. */
 	struct lsregion lsregion;
 	/** A monotonically growing identifier for lsregion allocations. */
@@ -268,6 +275,18 @@ relay_txn_lag(const struct relay *relay)
 	return relay->tx.txn_lag;
 }
 
+int64_t
+relay_wal_tail_hits(const struct relay *relay)
+{
+	return relay->wal_tail_hits;
+}
+
+int64_t
+relay_wal_tail_misses(const struct relay *relay)
+{
+	return relay->wal_tail_misses;
+}
+
 static void
 relay_send(struct relay *relay, struct xrow_header *packet);
 static void
@@ -342,6 +361,8 @@ relay_start(struct relay *relay, struct iostream *io, uint64_t sync,
 	relay->last_row_time = ev_monotonic_now(loop());
 	relay->tx_seen_time = relay->last_row_time;
 	relay->last_heartbeat_time = relay->last_row_time;
+	relay->wal_tail_hits = 0;
+	relay->wal_tail_misses = 0;
 	/* Never send rows for REPLICA_ID_NIL to anyone */
 	relay->id_filter = 1 << REPLICA_ID_NIL;
 	memset(&relay->status_msg, 0, sizeof(relay->status_msg));
@@ -727,6 +748,16 @@ relay_process_wal_event(struct wal_watcher *watcher, unsigned events)
 		return;
 	}
 	try {
+		/*
+		 * Try to send new rows from memory first. This works
+		 * as long as the relay keeps up with the WAL.
+		 */
+		if (recover_wal_tail(relay->r, &relay->stream,
+				     &relay->wal_tail_buf)) {
+			relay->wal_tail_hits++;
+			return;
+		}
+		relay->wal_tail_misses++;
 		recover_remaining_wals(relay->r, &relay->stream, NULL,
 				       (events & WAL_EVENT_ROTATE) != 0);
 	} catch (Exception *e) {
@@ -1020,6 +1051,8 @@ relay_subscribe_f(va_list ap)
 		fiber_sleep(0.01);
 		xstream_yield(&relay->stream);
 	}
+	ibuf_create(&relay->wal_tail_buf, &cord()->slabc, 16 * 1024);
+	wal_tail_attach();
 	wal_set_watcher(&relay->wal_watcher, relay->wal_endpoint.name,
 			relay_process_wal_event, cbus_process);
 
@@ -1066,6 +1099,8 @@ relay_subscribe_f(va_list ap)
 	 */
 	trigger_clear(&on_close_log);
 	wal_clear_watcher(&relay->wal_watcher, cbus_process);
+	wal_tail_detach();
+	ibuf_destroy(&relay->wal_tail_buf);
 
 	/* Join ack reader fiber. */
 	fiber_cancel(reader);
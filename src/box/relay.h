@@ -97,6 +97,20 @@ relay_last_row_time(const struct relay *relay);
 double
 relay_txn_lag(const struct relay *relay);
 
+/**
+ * Returns the number of WAL events the relay handled by reading
+ * rows from the WAL tail, see wal_tail.h.
+ */
+int64_t
+relay_wal_tail_hits(const struct relay *relay);
+
+/**
+ * Returns the number of WAL events the relay handled by reading
+ * WAL files.
+ */
+int64_t
+relay_wal_tail_misses(const struct relay *relay);
+
 /**
  * Makes the relay issue a new vclock sync request and returns the sync to wait
  * for.
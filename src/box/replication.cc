@@ -64,6 +64,7 @@ double replication_synchro_timeout = 5.0; /* seconds */
 double replication_sync_timeout = 300.0; /* seconds */
 bool replication_skip_conflict = false;
 int replication_threads = 1;
+int replication_apply_concurrency = 1;
 
 bool cfg_replication_anon = true;
 struct tt_uuid cfg_bootstrap_leader_uuid;
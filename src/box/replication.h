@@ -111,6 +111,8 @@ extern struct fiber *replication_anon_gc_fiber;
 
 enum { REPLICATION_THREADS_MAX = 1000 };
 
+enum { REPLICATION_APPLY_CONCURRENCY_MAX = 1000 };
+
 enum bootstrap_strategy {
 	BOOTSTRAP_STRATEGY_INVALID = -1,
 	BOOTSTRAP_STRATEGY_AUTO,
@@ -256,6 +258,12 @@ extern bool replication_skip_conflict;
 /** How many threads to use for decoding incoming replication stream. */
 extern int replication_threads;
 
+/**
+ * Max number of transactions received from a master that may be applied
+ * concurrently. 1 means that transactions are applied one by one.
+ */
+extern int replication_apply_concurrency;
+
 /**
  * A list of triggers fired once quorum of "healthy" connections is acquired.
  */
@@ -95,10 +95,10 @@ system_space_is_sync(struct space *space)
 	return false;
 }
 
-int
-access_check_space(struct space *space, user_access_t access)
+bool
+space_has_access(struct space *space, struct credentials *cr,
+		 user_access_t access)
 {
-	struct credentials *cr = effective_user();
 	/* Any space access also requires global USAGE privilege. */
 	access |= PRIV_U;
 	/*
@@ -115,12 +115,19 @@ access_check_space(struct space *space, user_access_t access)
 	 */
 	space_access &= ~entity_access_get(SC_SPACE)[cr->auth_token].effective;
 
-	if (space_access &&
-	    /* Check for missing USAGE access, ignore owner rights. */
-	    (space_access & PRIV_U ||
-	     /* Check for missing specific access, respect owner rights. */
-	    (space->def->uid != cr->uid &&
-	     space_access & ~space->access[cr->auth_token].effective))) {
+	return !space_access ||
+	       /* Check for missing USAGE access, ignore owner rights. */
+	       (!(space_access & PRIV_U) &&
+		/* Check for missing specific access, respect owner rights. */
+		(space->def->uid == cr->uid ||
+		 !(space_access & ~space->access[cr->auth_token].effective)));
+}
+
+int
+access_check_space(struct space *space, user_access_t access)
+{
+	struct credentials *cr = effective_user();
+	if (!space_has_access(space, cr, access)) {
 		/*
 		 * Report access violation. Throw "no such user"
 		 * error if there is no user with this id.
@@ -897,7 +904,9 @@ space_push_replace_trigger_arguments(struct port *args, struct txn *txn)
 	port_c_add_str0(args, iproto_type_name(stmt->type));
 	/* Pass xrow header and body to recovery triggers. */
 	if (stmt->space->run_recovery_triggers) {
-		struct xrow_header *row = stmt->row;
+		/* Rows of a multi-row request aren't logged separately. */
+		struct xrow_header *row = stmt->row != NULL ?
+					  stmt->row : stmt->parent_row;
 		assert(row != NULL && row->header != NULL);
 		port_c_add_mp_object(args, row->header, row->header_end,
 				     &iproto_mp_ctx);
@@ -1382,7 +1391,8 @@ space_execute_insert_arrow(struct space *space, struct txn *txn,
 			goto eof;
 	}
 
-	rc = space->vtab->execute_insert_arrow(space, txn, array, schema);
+	rc = space->vtab->execute_insert_arrow(space, txn, request, array,
+					       schema);
 
 	if (array->release != NULL)
 		array->release(array);
@@ -1542,10 +1552,12 @@ generic_space_bsize(struct space *space)
 
 int
 generic_space_execute_insert_arrow(struct space *space, struct txn *txn,
+				   struct request *request,
 				   struct ArrowArray *array,
 				   struct ArrowSchema *schema)
 {
 	(void)txn;
+	(void)request;
 	(void)array;
 	(void)schema;
 	diag_set(ClientError, ER_UNSUPPORTED, space->engine->name,
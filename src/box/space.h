@@ -77,6 +77,7 @@ struct space_vtab {
 	 * The implementation may move or release the input array and schema.
 	 */
 	int (*execute_insert_arrow)(struct space *space, struct txn *txn,
+				    struct request *request,
 				    struct ArrowArray *array,
 				    struct ArrowSchema *schema);
 
@@ -532,6 +533,14 @@ space_bsize(struct space *space);
 struct index_def *
 space_index_def(struct space *space, int n);
 
+/**
+ * Check whether or not the given credentials grant the requested
+ * access to the space. Doesn't set diag.
+ */
+bool
+space_has_access(struct space *space, struct credentials *cr,
+		 user_access_t access);
+
 /**
  * Check whether or not the current user can be granted
  * the requested access to the space.
@@ -771,6 +780,7 @@ space_cleanup_constraints(struct space *space);
  */
 size_t generic_space_bsize(struct space *);
 int generic_space_execute_insert_arrow(struct space *space, struct txn *txn,
+				       struct request *request,
 				       struct ArrowArray *array,
 				       struct ArrowSchema *schema);
 int generic_space_ephemeral_replace(struct space *, const char *, const char *);
@@ -7,47 +7,626 @@
 
 #include <assert.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "box.h"
+#include "diag.h"
+#include "engine.h"
+#include "errcode.h"
+#include "error.h"
+#include "fiber.h"
+#include "func.h"
+#include "index.h"
 #include "msgpuck.h"
+#include "port.h"
+#include "replication.h"
+#include "schema.h"
+#include "schema_def.h"
+#include "session.h"
+#include "small/region.h"
 #include "space.h"
 #include "space_def.h"
 #include "trivia/config.h"
+#include "tt_static.h"
+#include "tt_uuid.h"
+#include "tuple.h"
+#include "txn.h"
 
 #if defined(ENABLE_SPACE_UPGRADE)
 # error unimplemented
 #endif
 
-static struct space_upgrade_def {} dummy_def;
+enum {
+	/**
+	 * Max number of tuples checked by the background upgrade fiber
+	 * in one transaction. The fiber yields after each batch so that
+	 * the upgrade doesn't block the tx thread.
+	 */
+	SPACE_UPGRADE_BATCH_SIZE = 1000,
+};
+
+const char *space_upgrade_status_strs[] = {
+	/* [SPACE_UPGRADE_INPROGRESS] = */ "inprogress",
+	/* [SPACE_UPGRADE_ERROR]      = */ "error",
+};
+
+/**
+ * Space upgrade definition, stored in the space options:
+ *
+ *   upgrade = {func = <id>, arg = <any>, owner = <uuid>, rate = <number>}
+ *
+ * All keys are optional. If the function isn't set, tuples are only
+ * checked against the new space format. If the owner isn't set, tuples
+ * are upgraded in the background on any writable instance. If the rate
+ * isn't set, the background fiber only yields between batches.
+ */
+struct space_upgrade_def {
+	/** Id of the upgrade function, 0 if not set. */
+	uint32_t func_id;
+	/** Instance that upgrades tuples in the background. */
+	struct tt_uuid owner;
+	/**
+	 * Max number of tuples checked by the background fiber per
+	 * second, 0 if not limited.
+	 */
+	double rate;
+	/** Size of arg. */
+	uint32_t arg_size;
+	/**
+	 * MsgPack argument passed to the upgrade function or NULL.
+	 * Points to the data stored after the struct.
+	 */
+	char *arg;
+};
 
 struct space_upgrade_def *
 space_upgrade_def_decode(const char **data, struct region *region)
 {
-	(void)region;
-	/**
-	 * Option decoder may only fail with IllegalParams error so we return
-	 * a non-NULL ptr here and abort later, in space_prepare_upgrade.
-	 */
-	mp_next(data);
-	return &dummy_def;
+	if (mp_typeof(**data) != MP_MAP) {
+		diag_set(IllegalParams, "upgrade options must be a map");
+		return NULL;
+	}
+	uint32_t func_id = 0;
+	struct tt_uuid owner = uuid_nil;
+	double rate = 0;
+	const char *arg = NULL;
+	const char *arg_end = NULL;
+	uint32_t map_size = mp_decode_map(data);
+	for (uint32_t i = 0; i < map_size; i++) {
+		if (mp_typeof(**data) != MP_STR) {
+			diag_set(IllegalParams,
+				 "upgrade option name must be a string");
+			return NULL;
+		}
+		uint32_t key_len;
+		const char *key = mp_decode_str(data, &key_len);
+		if (key_len == strlen("func") &&
+		    memcmp(key, "func", key_len) == 0) {
+			if (mp_typeof(**data) != MP_UINT) {
+				diag_set(IllegalParams, "upgrade option 'func' "
+					 "must be a function id");
+				return NULL;
+			}
+			func_id = mp_decode_uint(data);
+		} else if (key_len == strlen("arg") &&
+			   memcmp(key, "arg", key_len) == 0) {
+			arg = *data;
+			mp_next(data);
+			arg_end = *data;
+		} else if (key_len == strlen("owner") &&
+			   memcmp(key, "owner", key_len) == 0) {
+			uint32_t len;
+			const char *str = mp_typeof(**data) != MP_STR ? NULL :
+					  mp_decode_str(data, &len);
+			if (str == NULL ||
+			    tt_uuid_from_strl(str, len, &owner) != 0) {
+				diag_set(IllegalParams, "upgrade option "
+					 "'owner' must be a UUID string");
+				return NULL;
+			}
+		} else if (key_len == strlen("rate") &&
+			   memcmp(key, "rate", key_len) == 0) {
+			if (mp_read_double(data, &rate) != 0 ||
+			    !(rate > 0)) {
+				diag_set(IllegalParams, "upgrade option "
+					 "'rate' must be a positive number");
+				return NULL;
+			}
+		} else {
+			diag_set(IllegalParams, "unexpected upgrade option "
+				 "'%.*s'", (int)key_len, key);
+			return NULL;
+		}
+	}
+	uint32_t arg_size = arg_end - arg;
+	size_t size = sizeof(struct space_upgrade_def) + arg_size;
+	struct space_upgrade_def *def =
+		(struct space_upgrade_def *)xregion_aligned_alloc(
+			region, size, alignof(struct space_upgrade_def));
+	def->func_id = func_id;
+	def->owner = owner;
+	def->rate = rate;
+	def->arg_size = arg_size;
+	def->arg = NULL;
+	if (arg != NULL) {
+		def->arg = (char *)(def + 1);
+		memcpy(def->arg, arg, arg_size);
+	}
+	return def;
 }
 
 struct space_upgrade_def *
 space_upgrade_def_dup(const struct space_upgrade_def *def)
 {
-	assert(def == NULL || def == &dummy_def);
-	return def != NULL ? &dummy_def : NULL;
+	if (def == NULL)
+		return NULL;
+	size_t size = sizeof(*def) + def->arg_size;
+	struct space_upgrade_def *copy = xmalloc(size);
+	memcpy(copy, def, size);
+	if (def->arg != NULL)
+		copy->arg = (char *)(copy + 1);
+	return copy;
 }
 
 void
 space_upgrade_def_delete(struct space_upgrade_def *def)
 {
-	assert(def == NULL || def == &dummy_def);
-	(void)def;
+	free(def);
+}
+
+uint32_t
+space_upgrade_def_func_id(const struct space_upgrade_def *def)
+{
+	return def->func_id;
+}
+
+const struct tt_uuid *
+space_upgrade_def_owner(const struct space_upgrade_def *def)
+{
+	return &def->owner;
+}
+
+double
+space_upgrade_def_rate(const struct space_upgrade_def *def)
+{
+	return def->rate;
+}
+
+/**
+ * Returns the upgrade function, resolving it on the first call.
+ * Returns NULL and sets diag if the function doesn't exist.
+ */
+static struct func *
+space_upgrade_func(struct space_upgrade *upgrade)
+{
+	if (upgrade->func != NULL)
+		return upgrade->func;
+	uint32_t func_id = upgrade->def->func_id;
+	struct func *func = func_by_id(func_id);
+	if (func == NULL) {
+		diag_set(ClientError, ER_NO_SUCH_FUNCTION, int2str(func_id));
+		return NULL;
+	}
+	func_pin(func, &upgrade->func_holder, FUNC_HOLDER_SPACE_UPGRADE);
+	upgrade->func = func;
+	return func;
+}
+
+/** Checks that a function can be used for space upgrade. */
+static int
+space_upgrade_check_func(struct func *func)
+{
+	if (func->def->language != FUNC_LANGUAGE_LUA ||
+	    func->def->body == NULL || !func->def->is_deterministic) {
+		diag_set(ClientError, ER_WRONG_SPACE_UPGRADE_OPTIONS,
+			 tt_sprintf("function '%s' doesn't meet space upgrade "
+				    "function criteria (stored, deterministic, "
+				    "written in Lua)", func->def->name));
+		return -1;
+	}
+	return 0;
+}
+
+struct space_upgrade *
+space_upgrade_new(struct space *space, struct tuple_format *recovery_format)
+{
+	const struct space_upgrade_def *def = space->def->opts.upgrade_def;
+	assert(def != NULL);
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		if (space->index[i]->def->key_def->for_func_index) {
+			diag_set(ClientError, ER_UNSUPPORTED,
+				 "Space upgrade", "functional indexes");
+			return NULL;
+		}
+	}
+	struct space_upgrade *upgrade = xcalloc(1, sizeof(*upgrade));
+	/*
+	 * Reads call the upgrade function, which is written in Lua,
+	 * so they can't be called via FFI. Re-enabled on delete.
+	 */
+	box_read_ffi_disable();
+	upgrade->space = space;
+	upgrade->def = space_upgrade_def_dup(def);
+	upgrade->recovery_format = recovery_format;
+	tuple_format_ref(recovery_format);
+	upgrade->status = SPACE_UPGRADE_INPROGRESS;
+	/*
+	 * The function space may not be recovered yet, in which case
+	 * the function is resolved on the first use.
+	 */
+	if (def->func_id != 0 && recovery_state == FINISHED_RECOVERY &&
+	    (space_upgrade_func(upgrade) == NULL ||
+	     space_upgrade_check_func(upgrade->func) != 0)) {
+		space_upgrade_delete(upgrade);
+		return NULL;
+	}
+	return upgrade;
+}
+
+void
+space_upgrade_delete(struct space_upgrade *upgrade)
+{
+	/*
+	 * The fiber looks up the space after each batch and exits if
+	 * the upgrade state has changed.
+	 */
+	if (upgrade->fiber != NULL && upgrade->fiber != fiber())
+		fiber_cancel(upgrade->fiber);
+	if (upgrade->func != NULL)
+		func_unpin(&upgrade->func_holder);
+	if (upgrade->error != NULL)
+		error_unref(upgrade->error);
+	tuple_format_unref(upgrade->recovery_format);
+	space_upgrade_def_delete(upgrade->def);
+	free(upgrade);
+	box_read_ffi_enable();
+}
+
+bool
+space_upgrade_tuple_needs_upgrade(struct space_upgrade *upgrade,
+				  struct tuple *tuple)
+{
+	return tuple_format(tuple) != upgrade->space->format;
+}
+
+/**
+ * Checks that the upgrade didn't change fields indexed by the space
+ * indexes. Multikey indexes require the whole top-level fields to be
+ * unchanged.
+ */
+static int
+space_upgrade_check_indexed_fields(struct space *space,
+				   struct tuple *old_tuple,
+				   struct tuple *new_tuple)
+{
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct index_def *index_def = space->index[i]->def;
+		struct key_def *key_def = index_def->key_def;
+		bool is_equal = true;
+		if (!key_def->is_multikey) {
+			is_equal = tuple_compare(old_tuple, HINT_NONE,
+						 new_tuple, HINT_NONE,
+						 key_def) == 0;
+		}
+		for (uint32_t j = 0; key_def->is_multikey && is_equal &&
+				     j < key_def->part_count; j++) {
+			uint32_t fieldno = key_def->parts[j].fieldno;
+			const char *old_field = tuple_field(old_tuple, fieldno);
+			const char *new_field = tuple_field(new_tuple, fieldno);
+			if (old_field == NULL || new_field == NULL) {
+				is_equal = old_field == new_field;
+				continue;
+			}
+			const char *old_end = old_field;
+			const char *new_end = new_field;
+			mp_next(&old_end);
+			mp_next(&new_end);
+			is_equal = old_end - old_field == new_end - new_field &&
+				   memcmp(old_field, new_field,
+					  old_end - old_field) == 0;
+		}
+		if (!is_equal) {
+			diag_set(ClientError, ER_CANT_UPGRADE_INDEXED_FIELD,
+				 space_name(space), space_id(space),
+				 index_def->name, old_tuple, new_tuple);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Calls the upgrade function for a tuple and returns the MsgPack array
+ * it returned, allocated on the fiber region.
+ */
+static const char *
+space_upgrade_call_func(struct space_upgrade *upgrade, struct tuple *tuple,
+			uint32_t *size)
+{
+	struct func *func = space_upgrade_func(upgrade);
+	if (func == NULL)
+		return NULL;
+	struct port args, ret;
+	port_c_create(&args);
+	port_c_add_tuple(&args, tuple);
+	if (upgrade->def->arg != NULL) {
+		port_c_add_mp(&args, upgrade->def->arg,
+			      upgrade->def->arg + upgrade->def->arg_size);
+	}
+	int rc = func_call_no_access_check(func, &args, &ret);
+	port_destroy(&args);
+	if (rc != 0)
+		return NULL;
+	const char *data = port_get_msgpack(&ret, size);
+	port_destroy(&ret);
+	if (data == NULL)
+		return NULL;
+	const char *data_end = data + *size;
+	if (mp_decode_array(&data) != 1 || mp_typeof(*data) != MP_ARRAY) {
+		diag_set(ClientError, ER_WRONG_SPACE_UPGRADE_OPTIONS,
+			 tt_sprintf("function '%s' must return a tuple",
+				    func->def->name));
+		return NULL;
+	}
+	*size = data_end - data;
+	return data;
+}
+
+struct tuple *
+space_upgrade_apply(struct space_upgrade *upgrade, struct tuple *tuple)
+{
+	if (!space_upgrade_tuple_needs_upgrade(upgrade, tuple))
+		return tuple;
+	struct space *space = upgrade->space;
+	struct tuple_format *format = space->format;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char *data;
+	uint32_t size;
+	if (upgrade->def->func_id != 0) {
+		data = space_upgrade_call_func(upgrade, tuple, &size);
+		if (data == NULL)
+			goto error;
+	} else {
+		data = tuple_data_range(tuple, &size);
+	}
+	struct tuple *new_tuple = format->vtab.tuple_new(format, data,
+							 data + size);
+	if (new_tuple == NULL)
+		goto error;
+	tuple_ref(new_tuple);
+	if (space_upgrade_check_indexed_fields(space, tuple, new_tuple) != 0) {
+		tuple_unref(new_tuple);
+		goto error;
+	}
+	region_truncate(region, region_svp);
+	tuple_bless(new_tuple);
+	tuple_unref(new_tuple);
+	return new_tuple;
+error:
+	region_truncate(region, region_svp);
+	error_set_space(diag_last_error(diag_get()), space->def);
+	return NULL;
+}
+
+/**
+ * Looks up a space by id and returns its upgrade state if the current
+ * fiber is supposed to upgrade it in the background, NULL otherwise.
+ */
+static struct space_upgrade *
+space_upgrade_by_fiber(uint32_t space_id)
+{
+	if (fiber_is_cancelled())
+		return NULL;
+	struct space *space = space_by_id(space_id);
+	if (space == NULL || space->upgrade == NULL ||
+	    space->upgrade->fiber != fiber())
+		return NULL;
+	return space->upgrade;
+}
+
+/**
+ * Collects up to SPACE_UPGRADE_BATCH_SIZE tuples following the given
+ * position in the primary index. Referenced tuples that need upgrade
+ * are stored in @a tuples. The position is updated.
+ */
+static int
+space_upgrade_collect(struct space_upgrade *upgrade, char **pos,
+		      struct tuple **tuples, int *count, int *checked,
+		      bool *is_done)
+{
+	struct space *space = upgrade->space;
+	struct index *pk = space_index(space, 0);
+	*count = 0;
+	*checked = 0;
+	*is_done = true;
+	if (pk == NULL)
+		return 0;
+	const char *key = *pos;
+	uint32_t part_count = key != NULL ? mp_decode_array(&key) : 0;
+	struct iterator *it = index_create_iterator(
+		pk, key != NULL ? ITER_GT : ITER_ALL, key, part_count);
+	if (it == NULL)
+		return -1;
+	int rc = 0;
+	struct tuple *last = NULL;
+	*is_done = false;
+	while (*checked < SPACE_UPGRADE_BATCH_SIZE) {
+		struct tuple *tuple;
+		rc = iterator_next_internal(it, &tuple);
+		if (rc != 0)
+			break;
+		if (tuple == NULL) {
+			*is_done = true;
+			break;
+		}
+		last = tuple;
+		++*checked;
+		if (space_upgrade_tuple_needs_upgrade(upgrade, tuple)) {
+			tuple_ref(tuple);
+			tuples[(*count)++] = tuple;
+		}
+	}
+	if (rc == 0 && last != NULL) {
+		uint32_t key_size;
+		const char *last_key = tuple_extract_key(last, pk->def->key_def,
+							 MULTIKEY_NONE,
+							 &key_size);
+		if (last_key == NULL) {
+			rc = -1;
+		} else {
+			*pos = xrealloc(*pos, key_size);
+			memcpy(*pos, last_key, key_size);
+		}
+	}
+	iterator_delete(it);
+	return rc;
+}
+
+/**
+ * Upgrades the next batch of tuples in a transaction. The upgrade
+ * function may yield, in which case the space may be dropped or
+ * altered, so the upgrade state is looked up after each call.
+ */
+static int
+space_upgrade_batch(struct space_upgrade *upgrade, char **pos, int *checked,
+		    bool *is_done)
+{
+	uint32_t id = space_id(upgrade->space);
+	struct tuple *tuples[SPACE_UPGRADE_BATCH_SIZE];
+	int count;
+	*checked = 0;
+	if (box_txn_begin() != 0)
+		return -1;
+	int rc = space_upgrade_collect(upgrade, pos, tuples, &count,
+				       checked, is_done);
+	for (int i = 0; i < count; i++) {
+		if (rc == 0 && space_upgrade_by_fiber(id) != upgrade) {
+			/* The upgrade was stopped. */
+			*is_done = false;
+			box_txn_rollback();
+			rc = 1;
+		}
+		if (rc == 0) {
+			struct tuple *new_tuple =
+				space_upgrade_apply(upgrade, tuples[i]);
+			uint32_t size;
+			const char *data = new_tuple == NULL ? NULL :
+				tuple_data_range(new_tuple, &size);
+			rc = data == NULL ? -1 :
+			     box_replace(id, data, data + size, NULL);
+		}
+		tuple_unref(tuples[i]);
+	}
+	if (rc > 0)
+		return 0;
+	if (rc != 0) {
+		box_txn_rollback();
+		return -1;
+	}
+	if (box_txn_commit() != 0)
+		return -1;
+	upgrade = space_upgrade_by_fiber(id);
+	if (upgrade != NULL)
+		upgrade->processed += *checked;
+	return 0;
+}
+
+/**
+ * Completes the upgrade by dropping the upgrade option from the space
+ * definition. This alters the space so that it has the new format.
+ */
+static int
+space_upgrade_complete(uint32_t space_id)
+{
+	char key[16];
+	char *key_end = mp_encode_array(key, 1);
+	key_end = mp_encode_uint(key_end, space_id);
+	char ops[64];
+	char *ops_end = mp_encode_array(ops, 1);
+	ops_end = mp_encode_array(ops_end, 3);
+	ops_end = mp_encode_str0(ops_end, "#");
+	ops_end = mp_encode_str0(ops_end, "flags.upgrade");
+	ops_end = mp_encode_uint(ops_end, 1);
+	assert(ops_end <= ops + sizeof(ops));
+	return box_update(BOX_SPACE_ID, 0, key, key_end, ops, ops_end,
+			  0, NULL);
+}
+
+/** Background upgrade fiber function. */
+static int
+space_upgrade_f(va_list ap)
+{
+	uint32_t space_id = va_arg(ap, uint32_t);
+	fiber_set_user(fiber(), &admin_credentials);
+	/* Let the caller finish the alter. */
+	fiber_sleep(0);
+	char *pos = NULL;
+	struct space_upgrade *upgrade;
+	while ((upgrade = space_upgrade_by_fiber(space_id)) != NULL) {
+		if (box_is_ro()) {
+			/* Wait until the instance becomes writable. */
+			if (box_wait_ro(false, TIMEOUT_INFINITY) != 0)
+				break;
+			continue;
+		}
+		int checked;
+		bool is_done;
+		int rc = space_upgrade_batch(upgrade, &pos, &checked,
+					     &is_done);
+		if (rc == 0 && is_done)
+			rc = space_upgrade_complete(space_id);
+		upgrade = space_upgrade_by_fiber(space_id);
+		if (upgrade == NULL)
+			break;
+		if (rc != 0) {
+			struct error *e = diag_last_error(diag_get());
+			say_error("failed to upgrade space '%s': %s",
+				  space_name(upgrade->space), e->errmsg);
+			error_ref(e);
+			upgrade->error = e;
+			upgrade->status = SPACE_UPGRADE_ERROR;
+			upgrade->fiber = NULL;
+			break;
+		}
+		/*
+		 * Let other fibers run. If the rate is limited, sleep
+		 * for the time the checked tuples are worth. The fiber
+		 * is cancelled if the upgrade is deleted meanwhile.
+		 */
+		double rate = upgrade->def->rate;
+		fiber_sleep(rate > 0 ? checked / rate : 0);
+	}
+	free(pos);
+	struct space *space = space_by_id(space_id);
+	if (space != NULL && space->upgrade != NULL &&
+	    space->upgrade->fiber == fiber())
+		space->upgrade->fiber = NULL;
+	return 0;
 }
 
 void
 space_upgrade_run(struct space *space)
 {
-	assert(space->def->opts.upgrade_def == NULL);
-	(void)space;
+	struct space_upgrade *upgrade = space->upgrade;
+	if (upgrade == NULL || upgrade->fiber != NULL ||
+	    upgrade->status != SPACE_UPGRADE_INPROGRESS ||
+	    recovery_state != FINISHED_RECOVERY)
+		return;
+	const struct tt_uuid *owner = &upgrade->def->owner;
+	if (!tt_uuid_is_nil(owner) && !tt_uuid_is_equal(owner, &INSTANCE_UUID))
+		return;
+	struct fiber *f = fiber_new_system(
+		tt_sprintf("space.upgrade.%u", space_id(space)),
+		space_upgrade_f);
+	if (f == NULL) {
+		diag_log();
+		return;
+	}
+	upgrade->fiber = f;
+	upgrade->processed = 0;
+	struct index *pk = space_index(space, 0);
+	upgrade->total = pk != NULL ? index_size(pk) : 0;
+	fiber_start(f, space_id(space));
 }
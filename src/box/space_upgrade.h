@@ -11,20 +11,80 @@
 # include "space_upgrade_impl.h"
 #else /* !defined(ENABLE_SPACE_UPGRADE) */
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
+#include "func_cache.h"
 #include "trivia/util.h"
 
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
 
+struct error;
+struct fiber;
 struct region;
 struct space;
-struct space_upgrade;
 struct space_upgrade_def;
 struct space_upgrade_read_view;
 struct tuple;
+struct tuple_format;
+struct tt_uuid;
+
+/** Status of a space upgrade. */
+enum space_upgrade_status {
+	/** The upgrade is in progress. */
+	SPACE_UPGRADE_INPROGRESS,
+	/** The background upgrade failed, see space_upgrade::error. */
+	SPACE_UPGRADE_ERROR,
+	space_upgrade_status_MAX,
+};
+
+/** Lowercase names of space upgrade statuses. */
+extern const char *space_upgrade_status_strs[];
+
+/**
+ * Online space upgrade state.
+ *
+ * The state is created when a space is altered with the upgrade option
+ * set. Tuples stored in the space before the alter are converted to the
+ * new format lazily, when they are read or updated, by applying the
+ * upgrade function to them. A background fiber converts the remaining
+ * tuples in batches and, once done, drops the upgrade option from the
+ * space definition.
+ *
+ * A tuple is considered upgraded if it has the space format. Tuples
+ * loaded from disk on recovery get a relaxed format so after restart
+ * the upgrade starts over and the function may be applied to a tuple
+ * that was already upgraded.
+ */
+struct space_upgrade {
+	/** Space that is being upgraded. */
+	struct space *space;
+	/** Upgrade definition. */
+	struct space_upgrade_def *def;
+	/** Upgrade function or NULL if not resolved yet or not set. */
+	struct func *func;
+	/** Holder of the upgrade function. */
+	struct func_cache_holder func_holder;
+	/**
+	 * Format used for tuples recovered from disk while the upgrade
+	 * is in progress. It only checks indexed fields, which can't be
+	 * changed by the upgrade.
+	 */
+	struct tuple_format *recovery_format;
+	/** Upgrade status. */
+	enum space_upgrade_status status;
+	/** Error that stopped the background upgrade or NULL. */
+	struct error *error;
+	/** Fiber upgrading tuples in the background or NULL. */
+	struct fiber *fiber;
+	/** Number of tuples checked by the background fiber. */
+	int64_t processed;
+	/** Number of tuples in the space when the fiber was started. */
+	int64_t total;
+};
 
 /**
  * Decodes space upgrade definition from MsgPack data.
@@ -50,28 +110,54 @@ void
 space_upgrade_def_delete(struct space_upgrade_def *def);
 
 /**
- * Deletes a space upgrade state.
+ * Returns the id of the upgrade function or 0 if the upgrade doesn't
+ * have a function.
  */
-static inline void
-space_upgrade_delete(struct space_upgrade *upgrade)
-{
-	(void)upgrade;
-	unreachable();
-}
+uint32_t
+space_upgrade_def_func_id(const struct space_upgrade_def *def);
+
+/**
+ * Returns the UUID of the instance that upgrades tuples in the background
+ * or nil UUID if any writable instance may do it.
+ */
+const struct tt_uuid *
+space_upgrade_def_owner(const struct space_upgrade_def *def);
+
+/**
+ * Returns the max number of tuples upgraded in the background per second
+ * or 0 if the rate isn't limited.
+ */
+double
+space_upgrade_def_rate(const struct space_upgrade_def *def);
+
+/**
+ * Creates a space upgrade state for the given space, which must have
+ * the upgrade option set. The recovery format is owned by the state.
+ * Returns NULL and sets diag on error.
+ */
+struct space_upgrade *
+space_upgrade_new(struct space *space, struct tuple_format *recovery_format);
+
+/**
+ * Deletes a space upgrade state. Stops the background fiber.
+ */
+void
+space_upgrade_delete(struct space_upgrade *upgrade);
+
+/**
+ * Returns true if the given tuple stored in the space needs upgrade.
+ */
+bool
+space_upgrade_tuple_needs_upgrade(struct space_upgrade *upgrade,
+				  struct tuple *tuple);
 
 /**
  * Applies the given space upgrade function to a tuple.
  * Returns the new tuple on success, NULL on error.
  * The new tuple is referenced with tuple_bless.
  */
-static inline struct tuple *
-space_upgrade_apply(struct space_upgrade *upgrade, struct tuple *tuple)
-{
-	(void)upgrade;
-	(void)tuple;
-	unreachable();
-	return NULL;
-}
+struct tuple *
+space_upgrade_apply(struct space_upgrade *upgrade, struct tuple *tuple);
 
 /**
  * Starts space upgrade in the background if required.
@@ -85,6 +171,8 @@ space_upgrade_run(struct space *space);
  *
  * The original space upgrade function may be dropped after calling this
  * function - the read view function doesn't depend on it.
+ *
+ * Read views with space upgrade enabled aren't used in this build.
  */
 static inline struct space_upgrade_read_view *
 space_upgrade_read_view_new(struct space_upgrade *upgrade)
@@ -1018,6 +1018,7 @@ enum {
 #define SQL_SubqCoroutine  0x0100	/* Evaluate subqueries as coroutines */
 #define SQL_Transitive     0x0200	/* Transitive constraints */
 #define SQL_OmitNoopJoin   0x0400	/* Omit unused tables in joins */
+#define SQL_BloomFilter    0x0800	/* Bloom filter on automatic indexes */
 #define SQL_AllOpts        0xffff	/* All optimizations */
 
 /*
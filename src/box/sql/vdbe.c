@@ -57,6 +57,8 @@
 #include "box/sequence.h"
 #include "box/session_settings.h"
 
+#include <PMurHash.h>
+
 #ifdef SQL_DEBUG
 
 /*
@@ -355,6 +357,100 @@ vdbe_field_ref_fetch(struct vdbe_field_ref *field_ref, uint32_t fieldno,
 	return 0;
 }
 
+/**
+ * Hash a single value for a Bloom filter. Values that are equal according
+ * to the index key comparator must have equal hashes, so numbers are hashed
+ * by their integer value regardless of their type, and all non-integer
+ * numbers share the same hash. Strings and varbinaries are hashed by their
+ * content only if @a hash_bytes is set, i.e. if they are compared without
+ * a collation.
+ */
+static uint64_t
+vdbe_filter_hash_mem(const struct Mem *mem, bool hash_bytes)
+{
+	/* Hash of numbers that are not integers or out of range. */
+	const uint64_t no_int_hash = 0x7ff8000000000001ULL;
+	switch (mem->type) {
+	case MEM_TYPE_INT:
+	case MEM_TYPE_UINT:
+		return mem->u.u;
+	case MEM_TYPE_DOUBLE: {
+		double d = mem->u.r;
+		if (d < 0 && d >= (double)INT64_MIN &&
+		    (double)(int64_t)d == d)
+			return (uint64_t)(int64_t)d;
+		if (d >= 0 && d < (double)UINT64_MAX &&
+		    (double)(uint64_t)d == d)
+			return (uint64_t)d;
+		return no_int_hash;
+	}
+	case MEM_TYPE_DEC: {
+		if (!decimal_is_int(&mem->u.d))
+			return no_int_hash;
+		if (decimal_is_neg(&mem->u.d)) {
+			int64_t i;
+			if (decimal_to_int64(&mem->u.d, &i) == NULL)
+				return no_int_hash;
+			return (uint64_t)i;
+		}
+		uint64_t u;
+		if (decimal_to_uint64(&mem->u.d, &u) == NULL)
+			return no_int_hash;
+		return u;
+	}
+	case MEM_TYPE_STR:
+	case MEM_TYPE_BIN:
+		if (!hash_bytes)
+			return mem->type;
+		return PMurHash32(0, mem->z, mem->n);
+	case MEM_TYPE_BOOL:
+		return mem->u.b;
+	default:
+		return mem->type;
+	}
+}
+
+/** Minimal size of a Bloom filter, in bytes. */
+#define VDBE_FILTER_SIZE_MIN 64
+/** Maximal size of a Bloom filter, in bytes. */
+#define VDBE_FILTER_SIZE_MAX 10000000
+
+/**
+ * Return the size of a Bloom filter for the rows of the space a cursor
+ * is opened on, in bytes. With one byte per row about 12% of the keys
+ * that were not added to the filter pass it. If the engine can't tell
+ * the number of rows, @a row_estimate is used.
+ */
+static uint32_t
+vdbe_filter_size(const struct BtCursor *cursor, int64_t row_estimate)
+{
+	struct index *pk = space_index(cursor->space, 0);
+	int64_t rows = pk != NULL ? index_size(pk) : 0;
+	if (rows < 0) {
+		diag_clear(diag_get());
+		rows = row_estimate;
+	}
+	return MIN(MAX(rows, VDBE_FILTER_SIZE_MIN), VDBE_FILTER_SIZE_MAX);
+}
+
+/**
+ * Compute the number of the Bloom filter bit for the key stored in @a count
+ * registers starting with @a key.
+ */
+static uint64_t
+vdbe_filter_bit(const struct Mem *filter, const struct Mem *key, int count,
+		bool hash_bytes)
+{
+	assert(mem_is_bin(filter) && filter->n > 0);
+	uint64_t h = 0;
+	for (int i = 0; i < count; i++) {
+		h ^= vdbe_filter_hash_mem(&key[i], hash_bytes);
+		h *= 0x9e3779b97f4a7c15ULL;
+		h ^= h >> 32;
+	}
+	return h % ((uint64_t)filter->n * 8);
+}
+
 /*
  * Execute as much of a VDBE program as we can.
  * This is the core of sql_step().
@@ -1807,6 +1903,54 @@ case OP_Once: {             /* jump */
 	break;
 }
 
+/* Opcode: FilterInit P1 P2 P3 * *
+ * Synopsis: r[P2]=filter(cursor P1)
+ *
+ * Store an empty Bloom filter in register P2. The filter is sized for
+ * the number of rows in the space cursor P1 is opened on. If the number
+ * is unknown, P3 rows are assumed.
+ */
+case OP_FilterInit: {          /* out2 */
+	assert(p->apCsr[pOp->p1]->eCurType == CURTYPE_TARANTOOL);
+	uint32_t size = vdbe_filter_size(p->apCsr[pOp->p1]->uc.pCursor,
+					 pOp->p3);
+	pOut = vdbe_prepare_null_out(p, pOp->p2);
+	mem_set_bin_allocated(pOut, sql_xmalloc0(size), size);
+	break;
+}
+
+/* Opcode: FilterAdd P1 * P3 P4 P5
+ * Synopsis: filter(P1) += key(P3@P4)
+ *
+ * Compute a hash of the P4 registers starting with r[P3] and add it to
+ * the Bloom filter stored in register P1. If P5 is not zero, strings and
+ * varbinaries are hashed by their content.
+ */
+case OP_FilterAdd: {
+	pIn1 = &aMem[pOp->p1];
+	uint64_t bit = vdbe_filter_bit(pIn1, &aMem[pOp->p3], pOp->p4.i,
+				       pOp->p5 != 0);
+	pIn1->z[bit / 8] |= 1 << (bit % 8);
+	break;
+}
+
+/* Opcode: Filter P1 P2 P3 P4 P5
+ * Synopsis: if key(P3@P4) not in filter(P1) goto P2
+ *
+ * Compute a hash of the P4 registers starting with r[P3] the same way
+ * FilterAdd does it. If the hash is not in the Bloom filter stored in
+ * register P1, jump to P2. Otherwise, the key may or may not be present
+ * among the keys added to the filter, so fall through.
+ */
+case OP_Filter: {              /* jump */
+	pIn1 = &aMem[pOp->p1];
+	uint64_t bit = vdbe_filter_bit(pIn1, &aMem[pOp->p3], pOp->p4.i,
+				       pOp->p5 != 0);
+	if ((pIn1->z[bit / 8] & (1 << (bit % 8))) == 0)
+		goto jump_to_p2;
+	break;
+}
+
 /* Opcode: If P1 P2 P3 * *
  *
  * Jump to P2 if the value in register P1 is true. If the value
@@ -712,6 +712,17 @@ termCanDriveIndex(WhereTerm * pTerm,	/* WHERE clause term to check */
 	return 1;
 }
 
+bool
+sql_filter_hash_bytes(const struct key_def *key_def, uint32_t part_count)
+{
+	assert(part_count <= key_def->part_count);
+	for (uint32_t i = 0; i < part_count; i++) {
+		if (key_def->parts[i].coll != NULL)
+			return false;
+	}
+	return true;
+}
+
 /**
  * Generate a code that will create a tuple, which is supposed to be inserted
  * in the ephemeral index space. The created tuple consists of rowid and
@@ -722,11 +733,15 @@ termCanDriveIndex(WhereTerm * pTerm,	/* WHERE clause term to check */
  * @param cursor Cursor of source space from which values for tuple are fetched.
  * @param reg_out Register to contain the created tuple.
  * @param reg_eph Register holding pointer to ephemeral index.
+ * @param reg_filter Register holding Bloom filter to add the first
+ *        @a filter_part_count fields of the tuple to or 0.
+ * @param filter_part_count Number of key parts added to the filter.
  */
 static void
 vdbe_emit_ephemeral_index_tuple(struct Parse *parse,
 				const struct key_def *key_def, int cursor,
-				int reg_out, int reg_eph)
+				int reg_out, int reg_eph, int reg_filter,
+				uint32_t filter_part_count)
 {
 	assert(reg_out != 0);
 	struct Vdbe *v = parse->pVdbe;
@@ -736,6 +751,13 @@ vdbe_emit_ephemeral_index_tuple(struct Parse *parse,
 		uint32_t tabl_col = key_def->parts[j].fieldno;
 		sqlVdbeAddOp3(v, OP_Column, cursor, tabl_col, reg_base + j);
 	}
+	if (reg_filter != 0) {
+		assert(filter_part_count <= key_def->part_count);
+		sqlVdbeAddOp4Int(v, OP_FilterAdd, reg_filter, 0, reg_base,
+				 filter_part_count);
+		sqlVdbeChangeP5(v, sql_filter_hash_bytes(key_def,
+							 filter_part_count));
+	}
 	sqlVdbeAddOp2(v, OP_NextIdEphemeral, reg_eph, reg_base + col_cnt);
 	sqlVdbeAddOp3(v, OP_MakeRecord, reg_base, col_cnt + 1, reg_out);
 	sqlReleaseTempRange(parse, reg_base, col_cnt + 1);
@@ -913,6 +935,19 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	sqlVdbeAddOp3(v, OP_IteratorOpen, pLevel->iIdxCur, 0, reg_eph);
 	VdbeComment((v, "for %s", space->def->name));
 
+	/*
+	 * Create a Bloom filter for the equality key of the index, so that
+	 * lookups of the keys that are not in the index can be skipped
+	 * without descending the tree. The filter is sized when the
+	 * statement is executed, from the number of rows in the table.
+	 */
+	if (OptimizationEnabled(SQL_BloomFilter)) {
+		u64 estimate = sqlLogEstToInt(sql_space_tuple_log_count(space));
+		pLevel->regFilter = ++pParse->nMem;
+		sqlVdbeAddOp3(v, OP_FilterInit, pLevel->iTabCur,
+			      pLevel->regFilter, MIN(estimate, INT32_MAX));
+	}
+
 	/* Fill the automatic index with content */
 	sqlExprCachePush(pParse);
 	assert(pWC->pWInfo->pTabList->a[pLevel->iFrom].fg.viaCoroutine == 0);
@@ -920,7 +955,8 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	addrTop = sqlVdbeAddOp1(v, OP_Rewind, cursor);
 	regRecord = sqlGetTempReg(pParse);
 	vdbe_emit_ephemeral_index_tuple(pParse, idx_def->key_def, cursor,
-					regRecord, reg_eph);
+					regRecord, reg_eph, pLevel->regFilter,
+					pLoop->nEq);
 	sqlVdbeAddOp2(v, OP_IdxInsert, regRecord, reg_eph);
 	sqlVdbeAddOp2(v, OP_Next, cursor, addrTop + 1);
 	sqlVdbeChangeP5(v, SQL_STMTSTATUS_AUTOINDEX);
@@ -86,6 +86,7 @@ struct WhereLevel {
 	int addrCont;		/* Jump here to continue with the next loop cycle */
 	int addrFirst;		/* First instruction of interior of the loop */
 	int addrBody;		/* Beginning of the body of this loop */
+	int regFilter;		/* Bloom filter for the automatic index */
 	u8 iFrom;		/* Which entry in the FROM clause */
 	u8 op, p3, p5;		/* Opcode, P3 & P5 of the opcode that ends the loop */
 	int p1, p2;		/* Operands of the opcode used to ends the loop */
@@ -447,6 +448,14 @@ WhereTerm *sqlWhereFindTerm(WhereClause * pWC,	/* The WHERE clause to be searche
 				u32 op,	/* Mask of WO_xx values describing operator */
 				struct index_def *idx_def);
 
+/**
+ * Return true if strings and varbinaries in the first @a part_count parts
+ * of the key are compared byte-wise, so a Bloom filter built for the key
+ * may hash them by content.
+ */
+bool
+sql_filter_hash_bytes(const struct key_def *key_def, uint32_t part_count);
+
 /* wherecode.c: */
 int sqlWhereExplainOneScan(Parse * pParse,	/* Parse context */
 			       SrcList * pTabList,	/* Table list this loop refers to */
@@ -873,6 +873,17 @@ sqlWhereCodeOneLoopStart(WhereInfo * pWInfo,	/* Complete information about the W
 		regBase =
 		    codeAllEqualityTerms(pParse, pLevel, bRev, nExtraReg);
 		addrNxt = pLevel->addrNxt;
+		/*
+		 * Skip the lookup in the automatic index if the Bloom filter
+		 * built along with it says that the key is not there.
+		 */
+		if (pLevel->regFilter != 0) {
+			assert((pLoop->wsFlags & WHERE_AUTO_INDEX) != 0);
+			sqlVdbeAddOp4Int(v, OP_Filter, pLevel->regFilter,
+					 addrNxt, regBase, nEq);
+			sqlVdbeChangeP5(v, sql_filter_hash_bytes(
+						idx_def->key_def, nEq));
+		}
 
 		startEq = !pRangeStart
 		    || pRangeStart->eOperator & (WO_LE | WO_GE);
@@ -485,8 +485,7 @@ tuple_field_go_to_index(const char **field, uint64_t index)
 		uint32_t count = mp_decode_array(field);
 		if (index >= count)
 			return -1;
-		for (; index > 0; --index)
-			mp_next(field);
+		mp_next_n(field, index);
 		return 0;
 	} else if (type == MP_MAP) {
 		index += TUPLE_INDEX_BASE;
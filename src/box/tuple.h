@@ -36,6 +36,7 @@
 #include "error.h"
 #include "tt_static.h"
 #include "tt_uuid.h"
+#include "mp_util.h"
 #include "tuple_format.h"
 
 #if defined(__cplusplus)
@@ -997,8 +998,7 @@ tuple_field_raw_by_path(struct tuple_format *format, const char *tuple,
 		field_count = mp_decode_array(&tuple);
 		if (unlikely(fieldno >= field_count))
 			return NULL;
-		for (uint32_t k = 0; k < fieldno; k++)
-			mp_next(&tuple);
+		mp_next_n(&tuple, fieldno);
 		if (path != NULL &&
 		    unlikely(tuple_go_to_path(&tuple, path, path_len,
 					      index_base, multikey_idx) != 0))
@@ -1046,8 +1046,7 @@ tuple_field_raw(struct tuple_format *format, const char *tuple,
 		uint32_t field_count = mp_decode_array(&tuple);
 		if (unlikely(field_no >= field_count))
 			return NULL;
-		for ( ; field_no > 0; field_no--)
-			mp_next(&tuple);
+		mp_next_n(&tuple, field_no);
 	}
 	return tuple;
 }
@@ -44,6 +44,7 @@
 #include "key_def.h"
 #include "tuple.h"
 #include "salad/bloom.h"
+#include "salad/ribbon.h"
 #include "trivia/util.h"
 #include <PMurHash.h>
 
@@ -259,19 +260,39 @@ tuple_bloom_builder_add_key(struct tuple_bloom_builder *builder,
 	return 0;
 }
 
+/**
+ * Estimate the false positive rate of a ribbon filter storing
+ * @a stored_count partial keys for lookups of @a checked_count
+ * distinct keys of a higher rank. Unlike a bloom filter, a ribbon
+ * filter has the same false positive rate for any key, but if
+ * there are more keys of a higher rank than partial keys, most
+ * of the checked keys share a partial key stored in the filter
+ * and so pass the check. To account for that, use the bloom filter
+ * formula for the filter with the same false positive rate.
+ */
+static double
+tuple_bloom_part_fpr(const struct ribbon *part, uint32_t stored_count,
+		     uint32_t checked_count)
+{
+	if (stored_count == 0)
+		return 1;
+	double load = (double)checked_count / stored_count;
+	return pow(1 - exp(-M_LN2 * load), part->result_bits);
+}
+
 struct tuple_bloom *
 tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
 {
 	uint32_t part_count = builder->part_count;
 	size_t size = sizeof(struct tuple_bloom) +
-			part_count * sizeof(struct bloom);
+			part_count * sizeof(union tuple_bloom_part);
 	struct tuple_bloom *bloom = malloc(size);
 	if (bloom == NULL) {
 		diag_set(OutOfMemory, size, "malloc", "tuple bloom");
 		return NULL;
 	}
 
-	bloom->version = TUPLE_BLOOM_VERSION_V3;
+	bloom->version = TUPLE_BLOOM_VERSION_V4;
 	bloom->part_count = 0;
 
 	for (uint32_t i = 0; i < part_count; i++) {
@@ -286,18 +307,20 @@ tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
 		 * for keys of a higher rank.
 		 */
 		double part_fpr = fpr;
-		for (uint32_t j = 0; j < i; j++)
-			part_fpr /= bloom_fpr(&bloom->parts[j], count);
+		for (uint32_t j = 0; j < i; j++) {
+			part_fpr /= tuple_bloom_part_fpr(
+				&bloom->parts[j].ribbon,
+				builder->parts[j].count, count);
+		}
 		part_fpr = MIN(part_fpr, 0.5);
-		if (bloom_create(&bloom->parts[i], count, part_fpr) != 0) {
-			diag_set(OutOfMemory, 0, "bloom_create",
+		if (ribbon_create(&bloom->parts[i].ribbon, hash_arr->values,
+				  count, part_fpr) != 0) {
+			diag_set(OutOfMemory, 0, "ribbon_create",
 				 "tuple bloom part");
 			tuple_bloom_delete(bloom);
 			return NULL;
 		}
 		bloom->part_count++;
-		for (uint32_t k = 0; k < count; k++)
-			bloom_add(&bloom->parts[i], hash_arr->values[k]);
 	}
 	return bloom;
 }
@@ -305,8 +328,12 @@ tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
 void
 tuple_bloom_delete(struct tuple_bloom *bloom)
 {
-	for (uint32_t i = 0; i < bloom->part_count; i++)
-		bloom_destroy(&bloom->parts[i]);
+	for (uint32_t i = 0; i < bloom->part_count; i++) {
+		if (bloom->version == TUPLE_BLOOM_VERSION_V4)
+			ribbon_destroy(&bloom->parts[i].ribbon);
+		else
+			bloom_destroy(&bloom->parts[i].bloom);
+	}
 	free(bloom);
 }
 
@@ -317,7 +344,7 @@ tuple_bloom_maybe_has(const struct tuple_bloom *bloom, struct tuple *tuple,
 	assert(!key_def->is_multikey || multikey_idx != MULTIKEY_NONE);
 
 	if (bloom->version == TUPLE_BLOOM_VERSION_V1) {
-		return bloom_maybe_has(&bloom->parts[0],
+		return bloom_maybe_has(&bloom->parts[0].bloom,
 				       tuple_hash(tuple, key_def));
 	}
 
@@ -332,18 +359,20 @@ tuple_bloom_maybe_has(const struct tuple_bloom *bloom, struct tuple *tuple,
 				&h, &carry, tuple, &key_def->parts[i],
 				multikey_idx);
 			uint32_t hash = PMurHash32_Result(h, carry, total_size);
-			if (!bloom_maybe_has(&bloom->parts[i], hash))
+			if (!bloom_maybe_has(&bloom->parts[i].bloom, hash))
 				return false;
 		}
 		return true;
 	}
-	assert(bloom->version == TUPLE_BLOOM_VERSION_V3);
+	bool is_ribbon = bloom->version == TUPLE_BLOOM_VERSION_V4;
 	for (uint32_t i = 0; i < key_def->part_count; i++) {
 		total_size += tuple_hash_key_part(&h, &carry, tuple,
 						  &key_def->parts[i],
 						  multikey_idx);
 		uint32_t hash = PMurHash32_Result(h, carry, total_size);
-		if (!bloom_maybe_has(&bloom->parts[i], hash))
+		if (is_ribbon ?
+		    !ribbon_maybe_has(&bloom->parts[i].ribbon, hash) :
+		    !bloom_maybe_has(&bloom->parts[i].bloom, hash))
 			return false;
 	}
 	return true;
@@ -357,7 +386,7 @@ tuple_bloom_maybe_has_key(const struct tuple_bloom *bloom,
 	if (bloom->version == TUPLE_BLOOM_VERSION_V1) {
 		if (part_count < key_def->part_count)
 			return true;
-		return bloom_maybe_has(&bloom->parts[0],
+		return bloom_maybe_has(&bloom->parts[0].bloom,
 				       key_hash(key, key_def));
 	}
 
@@ -373,17 +402,19 @@ tuple_bloom_maybe_has_key(const struct tuple_bloom *bloom,
 				&h, &carry, &key, key_def->parts[i].type,
 				key_def->parts[i].coll);
 			uint32_t hash = PMurHash32_Result(h, carry, total_size);
-			if (!bloom_maybe_has(&bloom->parts[i], hash))
+			if (!bloom_maybe_has(&bloom->parts[i].bloom, hash))
 				return false;
 		}
 		return true;
 	}
-	assert(bloom->version == TUPLE_BLOOM_VERSION_V3);
+	bool is_ribbon = bloom->version == TUPLE_BLOOM_VERSION_V4;
 	for (uint32_t i = 0; i < part_count; i++) {
 		total_size += tuple_hash_field(&h, &carry, &key,
 					       key_def->parts[i].coll);
 		uint32_t hash = PMurHash32_Result(h, carry, total_size);
-		if (!bloom_maybe_has(&bloom->parts[i], hash))
+		if (is_ribbon ?
+		    !ribbon_maybe_has(&bloom->parts[i].ribbon, hash) :
+		    !bloom_maybe_has(&bloom->parts[i].bloom, hash))
 			return false;
 	}
 	return true;
@@ -430,13 +461,64 @@ tuple_bloom_decode_part(struct bloom *part, const char **data)
 	return 0;
 }
 
+static size_t
+tuple_bloom_sizeof_ribbon_part(const struct ribbon *part)
+{
+	size_t size = 0;
+	size += mp_sizeof_array(4);
+	size += mp_sizeof_uint(part->slot_count);
+	size += mp_sizeof_uint(part->result_bits);
+	size += mp_sizeof_uint(part->seed);
+	size += mp_sizeof_bin(ribbon_store_size(part));
+	return size;
+}
+
+static char *
+tuple_bloom_encode_ribbon_part(const struct ribbon *part, char *buf)
+{
+	buf = mp_encode_array(buf, 4);
+	buf = mp_encode_uint(buf, part->slot_count);
+	buf = mp_encode_uint(buf, part->result_bits);
+	buf = mp_encode_uint(buf, part->seed);
+	buf = mp_encode_binl(buf, ribbon_store_size(part));
+	buf = ribbon_store(part, buf);
+	return buf;
+}
+
+static int
+tuple_bloom_decode_ribbon_part(struct ribbon *part, const char **data)
+{
+	memset(part, 0, sizeof(*part));
+	if (mp_decode_array(data) != 4)
+		unreachable();
+	part->slot_count = mp_decode_uint(data);
+	part->result_bits = mp_decode_uint(data);
+	part->seed = mp_decode_uint(data);
+	size_t store_size = mp_decode_binl(data);
+	assert(part->slot_count % RIBBON_WIDTH == 0);
+	assert(store_size == ribbon_store_size(part));
+	if (ribbon_load_table(part, *data) != 0) {
+		diag_set(OutOfMemory, store_size, "ribbon_load_table",
+			 "tuple bloom part");
+		return -1;
+	}
+	*data += store_size;
+	return 0;
+}
+
 size_t
 tuple_bloom_size(const struct tuple_bloom *bloom)
 {
 	size_t size = 0;
 	size += mp_sizeof_array(bloom->part_count);
-	for (uint32_t i = 0; i < bloom->part_count; i++)
-		size += tuple_bloom_sizeof_part(&bloom->parts[i]);
+	for (uint32_t i = 0; i < bloom->part_count; i++) {
+		if (bloom->version == TUPLE_BLOOM_VERSION_V4)
+			size += tuple_bloom_sizeof_ribbon_part(
+				&bloom->parts[i].ribbon);
+		else
+			size += tuple_bloom_sizeof_part(
+				&bloom->parts[i].bloom);
+	}
 	return size;
 }
 
@@ -444,8 +526,14 @@ char *
 tuple_bloom_encode(const struct tuple_bloom *bloom, char *buf)
 {
 	buf = mp_encode_array(buf, bloom->part_count);
-	for (uint32_t i = 0; i < bloom->part_count; i++)
-		buf = tuple_bloom_encode_part(&bloom->parts[i], buf);
+	for (uint32_t i = 0; i < bloom->part_count; i++) {
+		if (bloom->version == TUPLE_BLOOM_VERSION_V4)
+			buf = tuple_bloom_encode_ribbon_part(
+				&bloom->parts[i].ribbon, buf);
+		else
+			buf = tuple_bloom_encode_part(
+				&bloom->parts[i].bloom, buf);
+	}
 	return buf;
 }
 
@@ -469,11 +557,12 @@ tuple_bloom_decode(const char **data, enum tuple_bloom_version version)
 			unreachable();
 		if (mp_decode_uint(data) != 0) /* version */
 			unreachable();
-		bloom->parts[0].table_size = mp_decode_uint(data);
-		bloom->parts[0].hash_count = mp_decode_uint(data);
+		struct bloom *part = &bloom->parts[0].bloom;
+		part->table_size = mp_decode_uint(data);
+		part->hash_count = mp_decode_uint(data);
 		size_t store_size = mp_decode_binl(data);
-		assert(store_size == bloom_store_size(&bloom->parts[0]));
-		if (bloom_load_table(&bloom->parts[0], *data) != 0) {
+		assert(store_size == bloom_store_size(part));
+		if (bloom_load_table(part, *data) != 0) {
 			diag_set(OutOfMemory, store_size, "bloom_load_table",
 				 "tuple bloom part");
 			free(bloom);
@@ -485,7 +574,7 @@ tuple_bloom_decode(const char **data, enum tuple_bloom_version version)
 	case TUPLE_BLOOM_VERSION_V3:
 		bloom->part_count = 0;
 		for (uint32_t i = 0; i < part_count; i++) {
-			if (tuple_bloom_decode_part(&bloom->parts[i],
+			if (tuple_bloom_decode_part(&bloom->parts[i].bloom,
 						    data) != 0) {
 				tuple_bloom_delete(bloom);
 				return NULL;
@@ -493,6 +582,17 @@ tuple_bloom_decode(const char **data, enum tuple_bloom_version version)
 			bloom->part_count++;
 		}
 		break;
+	case TUPLE_BLOOM_VERSION_V4:
+		bloom->part_count = 0;
+		for (uint32_t i = 0; i < part_count; i++) {
+			if (tuple_bloom_decode_ribbon_part(
+					&bloom->parts[i].ribbon, data) != 0) {
+				tuple_bloom_delete(bloom);
+				return NULL;
+			}
+			bloom->part_count++;
+		}
+		break;
 	}
 	return bloom;
 }
@@ -35,6 +35,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "salad/bloom.h"
+#include "salad/ribbon.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -51,8 +52,18 @@ enum tuple_bloom_version {
 	 * MessagePack integers.
 	 */
 	TUPLE_BLOOM_VERSION_V2,
-	/** The latest bloom filter. */
+	/** Blocked bloom filter used before ribbon filters. */
 	TUPLE_BLOOM_VERSION_V3,
+	/** The latest filter: a ribbon filter per each partial key. */
+	TUPLE_BLOOM_VERSION_V4,
+};
+
+/** Filter of a partial key. The type depends on the version. */
+union tuple_bloom_part {
+	/** Used by versions V1-V3. */
+	struct bloom bloom;
+	/** Used by version V4. */
+	struct ribbon ribbon;
 };
 
 /**
@@ -68,8 +79,8 @@ struct tuple_bloom {
 	enum tuple_bloom_version version;
 	/** Number of key parts. */
 	uint32_t part_count;
-	/** Array of bloom filters, one per each partial key. */
-	struct bloom parts[0];
+	/** Array of filters, one per each partial key. */
+	union tuple_bloom_part parts[0];
 };
 
 /**
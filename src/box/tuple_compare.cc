@@ -1410,6 +1410,319 @@ static const comparator_with_key_signature cmp_wk_arr[] = {
 
 #undef KEY_COMPARATOR
 
+/* {{{ Typed tuple comparators */
+
+/*
+ * The precompiled comparators above are specialized both by field numbers
+ * and by field types, so they only match primary keys. Comparators below
+ * are specialized by field types only, while field numbers and collations
+ * are taken from the key definition, so they can be used for secondary
+ * index keys, including nullable keys and keys with collations, and save
+ * the per-part switch of the slowpath comparators.
+ */
+
+/**
+ * Max number of key parts typed comparators are instantiated for.
+ * It's enough for a two-part secondary key extended with a primary key.
+ */
+enum { TYPED_COMPARE_PART_COUNT_MAX = 3 };
+
+/**
+ * Returns the field type a typed comparator compares fields of the given
+ * type as or field_type_MAX if there's no typed comparator for it.
+ */
+static inline enum field_type
+typed_compare_field_type(enum field_type type)
+{
+	switch (type) {
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_UINT8:
+	case FIELD_TYPE_UINT16:
+	case FIELD_TYPE_UINT32:
+	case FIELD_TYPE_UINT64:
+		return FIELD_TYPE_UNSIGNED;
+	case FIELD_TYPE_INTEGER:
+	case FIELD_TYPE_INT8:
+	case FIELD_TYPE_INT16:
+	case FIELD_TYPE_INT32:
+	case FIELD_TYPE_INT64:
+		return FIELD_TYPE_INTEGER;
+	case FIELD_TYPE_STRING:
+		return FIELD_TYPE_STRING;
+	default:
+		return field_type_MAX;
+	}
+}
+
+template <int TYPE>
+static inline int
+typed_field_compare(struct key_part *part, const char *field_a,
+		    const char *field_b);
+
+template <>
+inline int
+typed_field_compare<FIELD_TYPE_UNSIGNED>(struct key_part *part,
+					 const char *field_a,
+					 const char *field_b)
+{
+	(void)part;
+	return mp_compare_uint(field_a, field_b);
+}
+
+template <>
+inline int
+typed_field_compare<FIELD_TYPE_INTEGER>(struct key_part *part,
+					const char *field_a,
+					const char *field_b)
+{
+	(void)part;
+	return mp_compare_integer_with_type(field_a, mp_typeof(*field_a),
+					    field_b, mp_typeof(*field_b));
+}
+
+template <>
+inline int
+typed_field_compare<FIELD_TYPE_STRING>(struct key_part *part,
+				       const char *field_a,
+				       const char *field_b)
+{
+	return part->coll != NULL ?
+	       mp_compare_str_coll(field_a, field_b, part->coll) :
+	       mp_compare_str(field_a, field_b);
+}
+
+/*
+ * Compares two fields of a key part, see key_part_compare_fields().
+ * If the key is nullable, a field may be NIL or absent (NULL).
+ */
+template <bool is_nullable, int TYPE>
+static ALWAYS_INLINE int
+typed_part_compare(struct key_part *part, const char *field_a,
+		   const char *field_b, bool *was_null_met)
+{
+	if (is_nullable) {
+		bool a_is_value = field_a != NULL &&
+				  mp_typeof(*field_a) != MP_NIL;
+		bool b_is_value = field_b != NULL &&
+				  mp_typeof(*field_b) != MP_NIL;
+		if (!a_is_value || !b_is_value) {
+			*was_null_met = true;
+			return a_is_value - b_is_value;
+		}
+	}
+	return typed_field_compare<TYPE>(part, field_a, field_b);
+}
+
+namespace /* local symbols */ {
+
+template <bool is_nullable, int ...TYPES>
+struct TypedFieldCompare {};
+
+template <bool is_nullable>
+struct TypedFieldCompare<is_nullable>
+{
+	inline static int compare(struct tuple *, struct tuple *,
+				  struct tuple_format *,
+				  struct tuple_format *,
+				  struct key_part *, struct key_part *,
+				  bool *)
+	{
+		return 0;
+	}
+};
+
+template <bool is_nullable, int TYPE, int ...MORE_TYPES>
+struct TypedFieldCompare<is_nullable, TYPE, MORE_TYPES...>
+{
+	inline static int compare(struct tuple *tuple_a,
+				  struct tuple *tuple_b,
+				  struct tuple_format *format_a,
+				  struct tuple_format *format_b,
+				  struct key_part *part,
+				  struct key_part *unique_end,
+				  bool *was_null_met)
+	{
+		/*
+		 * Parts following the unique ones are compared only
+		 * if NULLs were met, see tuple_compare_slowpath().
+		 */
+		if (is_nullable && part == unique_end && !*was_null_met)
+			return 0;
+		const char *field_a = tuple_field_raw(
+			format_a, tuple_data(tuple_a),
+			tuple_field_map(tuple_a), part->fieldno);
+		const char *field_b = tuple_field_raw(
+			format_b, tuple_data(tuple_b),
+			tuple_field_map(tuple_b), part->fieldno);
+		int rc = typed_part_compare<is_nullable, TYPE>(
+			part, field_a, field_b, was_null_met);
+		if (rc != 0)
+			return rc;
+		return TypedFieldCompare<is_nullable, MORE_TYPES...>::
+			compare(tuple_a, tuple_b, format_a, format_b,
+				part + 1, unique_end, was_null_met);
+	}
+};
+
+template <bool is_nullable, int ...TYPES>
+struct TypedTupleCompare
+{
+	static int compare(struct tuple *tuple_a, hint_t tuple_a_hint,
+			   struct tuple *tuple_b, hint_t tuple_b_hint,
+			   struct key_def *key_def)
+	{
+		assert(key_def->part_count == sizeof...(TYPES));
+		assert(is_nullable == key_def->is_nullable);
+		int rc = hint_cmp(tuple_a_hint, tuple_b_hint);
+		if (rc != 0)
+			return rc;
+		bool was_null_met = false;
+		return TypedFieldCompare<is_nullable, TYPES...>::
+			compare(tuple_a, tuple_b, tuple_format(tuple_a),
+				tuple_format(tuple_b), key_def->parts,
+				key_def->parts + key_def->unique_part_count,
+				&was_null_met);
+	}
+};
+
+template <bool is_nullable, int ...TYPES>
+struct TypedFieldCompareWithKey {};
+
+template <bool is_nullable>
+struct TypedFieldCompareWithKey<is_nullable>
+{
+	inline static int compare(struct tuple *, struct tuple_format *,
+				  const char *, uint32_t, struct key_part *)
+	{
+		return 0;
+	}
+};
+
+template <bool is_nullable, int TYPE, int ...MORE_TYPES>
+struct TypedFieldCompareWithKey<is_nullable, TYPE, MORE_TYPES...>
+{
+	inline static int compare(struct tuple *tuple,
+				  struct tuple_format *format,
+				  const char *key, uint32_t part_count,
+				  struct key_part *part)
+	{
+		const char *field = tuple_field_raw(format, tuple_data(tuple),
+						    tuple_field_map(tuple),
+						    part->fieldno);
+		bool unused;
+		int rc = typed_part_compare<is_nullable, TYPE>(
+			part, field, key, &unused);
+		if (rc != 0 || part_count == 1)
+			return rc;
+		mp_next(&key);
+		return TypedFieldCompareWithKey<is_nullable, MORE_TYPES...>::
+			compare(tuple, format, key, part_count - 1, part + 1);
+	}
+};
+
+template <bool is_nullable, int ...TYPES>
+struct TypedTupleCompareWithKey
+{
+	static int compare(struct tuple *tuple, hint_t tuple_hint,
+			   const char *key, uint32_t part_count,
+			   hint_t key_hint, struct key_def *key_def)
+	{
+		assert(key_def->part_count == sizeof...(TYPES));
+		assert(is_nullable == key_def->is_nullable);
+		assert(part_count <= key_def->part_count);
+		/* Part count can be 0 in wildcard searches. */
+		if (part_count == 0)
+			return 0;
+		int rc = hint_cmp(tuple_hint, key_hint);
+		if (rc != 0)
+			return rc;
+		return TypedFieldCompareWithKey<is_nullable, TYPES...>::
+			compare(tuple, tuple_format(tuple), key, part_count,
+				key_def->parts);
+	}
+};
+
+/**
+ * Looks up typed comparators for the key definition parts starting from
+ * the part number sizeof...(TYPES). TYPES are the types of the preceding
+ * parts, DEPTH is the max number of parts that can be appended to them.
+ */
+template <int DEPTH, bool is_nullable, int ...TYPES>
+struct TypedCompareSelector
+{
+	static void select(struct key_def *def, tuple_compare_t *cmp,
+			   tuple_compare_with_key_t *cmp_wk)
+	{
+		uint32_t i = sizeof...(TYPES);
+		if (i == def->part_count) {
+			*cmp = TypedTupleCompare<is_nullable, TYPES...>::
+				compare;
+			*cmp_wk = TypedTupleCompareWithKey<is_nullable,
+							   TYPES...>::compare;
+			return;
+		}
+		switch (typed_compare_field_type(def->parts[i].type)) {
+		case FIELD_TYPE_UNSIGNED:
+			TypedCompareSelector<DEPTH - 1, is_nullable, TYPES...,
+					     FIELD_TYPE_UNSIGNED>::
+				select(def, cmp, cmp_wk);
+			break;
+		case FIELD_TYPE_INTEGER:
+			TypedCompareSelector<DEPTH - 1, is_nullable, TYPES...,
+					     FIELD_TYPE_INTEGER>::
+				select(def, cmp, cmp_wk);
+			break;
+		case FIELD_TYPE_STRING:
+			TypedCompareSelector<DEPTH - 1, is_nullable, TYPES...,
+					     FIELD_TYPE_STRING>::
+				select(def, cmp, cmp_wk);
+			break;
+		default:
+			break;
+		}
+	}
+};
+
+template <bool is_nullable, int ...TYPES>
+struct TypedCompareSelector<0, is_nullable, TYPES...>
+{
+	static void select(struct key_def *def, tuple_compare_t *cmp,
+			   tuple_compare_with_key_t *cmp_wk)
+	{
+		if (def->part_count != sizeof...(TYPES))
+			return;
+		*cmp = TypedTupleCompare<is_nullable, TYPES...>::compare;
+		*cmp_wk = TypedTupleCompareWithKey<is_nullable, TYPES...>::
+			compare;
+	}
+};
+
+} /* end of anonymous namespace */
+
+/**
+ * Looks up typed comparators for the key definition. Sets @a cmp and
+ * @a cmp_wk to NULL if there are no typed comparators for it.
+ */
+template <bool is_nullable>
+static void
+key_def_find_typed_compare_func(struct key_def *def, tuple_compare_t *cmp,
+				tuple_compare_with_key_t *cmp_wk)
+{
+	assert(is_nullable == def->is_nullable);
+	assert(!def->has_json_paths);
+	assert(!def->for_func_index);
+	assert(!key_def_has_desc_parts(def));
+	*cmp = NULL;
+	*cmp_wk = NULL;
+	if (def->part_count == 0 ||
+	    def->part_count > TYPED_COMPARE_PART_COUNT_MAX)
+		return;
+	TypedCompareSelector<TYPED_COMPARE_PART_COUNT_MAX, is_nullable>::
+		select(def, cmp, cmp_wk);
+}
+
+/* }}} Typed tuple comparators */
+
 /**
  * A functional index tuple compare.
  * tuple_a_hint and tuple_b_hint are expected to be valid pointers to functional
@@ -2239,6 +2552,16 @@ key_def_set_compare_func_fast(struct key_def *def)
 			break;
 		}
 	}
+	if (!is_sequential && (cmp == NULL || cmp_wk == NULL)) {
+		tuple_compare_t typed_cmp;
+		tuple_compare_with_key_t typed_cmp_wk;
+		key_def_find_typed_compare_func<false>(def, &typed_cmp,
+						       &typed_cmp_wk);
+		if (cmp == NULL)
+			cmp = typed_cmp;
+		if (cmp_wk == NULL)
+			cmp_wk = typed_cmp_wk;
+	}
 	if (cmp == NULL) {
 		cmp = is_sequential ?
 			tuple_compare_sequential<false, false, false> :
@@ -2266,14 +2589,20 @@ key_def_set_compare_func_plain(struct key_def *def)
 			<is_nullable, has_optional_parts, has_desc_parts>;
 		def->tuple_compare_with_key = tuple_compare_with_key_sequential
 			<is_nullable, has_optional_parts, has_desc_parts>;
-	} else {
-		def->tuple_compare = tuple_compare_slowpath
-				    <is_nullable, has_optional_parts,
-				     false, false, has_desc_parts>;
-		def->tuple_compare_with_key = tuple_compare_with_key_slowpath
-					     <is_nullable, has_optional_parts,
-					      false, false, has_desc_parts>;
+		return;
+	}
+	if (!has_desc_parts) {
+		key_def_find_typed_compare_func<is_nullable>(
+			def, &def->tuple_compare, &def->tuple_compare_with_key);
+		if (def->tuple_compare != NULL)
+			return;
 	}
+	def->tuple_compare = tuple_compare_slowpath
+			    <is_nullable, has_optional_parts,
+			     false, false, has_desc_parts>;
+	def->tuple_compare_with_key = tuple_compare_with_key_slowpath
+				     <is_nullable, has_optional_parts,
+				      false, false, has_desc_parts>;
 }
 
 /* Proxy-template. */
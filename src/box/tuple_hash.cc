@@ -32,6 +32,7 @@
 #include "tuple_hash.h"
 #include "tuple.h"
 #include <PMurHash.h>
+#include "bit/bit.h"
 #include "coll/coll.h"
 #include <math.h>
 
@@ -39,8 +40,162 @@ enum {
 	HASH_SEED = 13U
 };
 
+/**
+ * Running state of the 32-bit hash of key fields (PMurHash32).
+ */
+struct murmur3_hasher {
+	/** Type of the resulting hash. */
+	typedef uint32_t hash_t;
+	uint32_t h;
+	uint32_t carry;
+
+	murmur3_hasher() : h(HASH_SEED), carry(0) {}
+
+	murmur3_hasher(uint32_t h_arg, uint32_t carry_arg)
+		: h(h_arg), carry(carry_arg) {}
+
+	void
+	process(const char *data, uint32_t size)
+	{
+		PMurHash32_Process(&h, &carry, data, size);
+	}
+
+	/** Process a string as it is seen by the collation. */
+	uint32_t
+	process_coll(const char *str, uint32_t size, struct coll *coll)
+	{
+		return coll->hash(str, size, &h, &carry, coll);
+	}
+
+	hash_t
+	result(uint32_t total_size)
+	{
+		return PMurHash32_Result(h, carry, total_size);
+	}
+};
+
+/** 64-bit hash primes, the same as in xxHash. */
+static const uint64_t HASH64_PRIME_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t HASH64_PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t HASH64_PRIME_3 = 0x165667B19E3779F9ULL;
+static const uint64_t HASH64_PRIME_MX = 0x165667919E3779F9ULL;
+
+/**
+ * Multiply two 64-bit numbers and fold the 128-bit product by XOR-ing
+ * its high and low halves.
+ */
+static inline uint64_t
+hash64_mul_fold(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+	__uint128_t product = (__uint128_t)a * b;
+	return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+	uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+	uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+	uint64_t lo_lo = a_lo * b_lo;
+	uint64_t hi_lo = a_hi * b_lo;
+	uint64_t lo_hi = a_lo * b_hi;
+	uint64_t hi_hi = a_hi * b_hi;
+	uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+	uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+	uint64_t lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+	return lower ^ upper;
+#endif
+}
+
+/** Mix 16 bytes of input into a 64-bit value. */
+static inline uint64_t
+hash64_mix16(const char *data, uint64_t seed)
+{
+	return hash64_mul_fold(load_u64(data) ^ (HASH64_PRIME_1 + seed),
+			       load_u64(data + 8) ^ (HASH64_PRIME_2 - seed));
+}
+
+/**
+ * Running state of the 64-bit hash of key fields.
+ *
+ * Key fields are short (most often they are integers encoded in
+ * 1-9 bytes), so each field is hashed on its own the way XXH3 hashes
+ * short inputs: up to 16 input bytes are loaded into two 64-bit words
+ * with possibly overlapping loads, mixed with the running state and
+ * multiplied with a 128-bit product folded to 64 bits. Longer fields
+ * are processed in independent 16-byte stripes that don't depend on
+ * each other, so that the multiplications can run in parallel.
+ */
+struct hash64_hasher {
+	/** Type of the resulting hash. */
+	typedef uint64_t hash_t;
+	uint64_t h;
+
+	hash64_hasher() : h(HASH_SEED) {}
+
+	void
+	process(const char *data, uint32_t size)
+	{
+		uint64_t lo, hi;
+		if (size > 16) {
+			uint64_t acc = h + size * HASH64_PRIME_1;
+			const char *end = data + size;
+			uint64_t seed = h;
+			for (; end - data > 16; data += 16) {
+				acc += hash64_mix16(data, seed);
+				seed += HASH64_PRIME_3;
+			}
+			acc += hash64_mix16(end - 16, seed);
+			h = acc;
+			return;
+		}
+		if (size >= 8) {
+			lo = load_u64(data);
+			hi = load_u64(data + size - 8);
+		} else if (size >= 4) {
+			lo = load_u32(data);
+			hi = load_u32(data + size - 4);
+		} else if (size > 0) {
+			lo = (uint8_t)data[0] |
+			     ((uint32_t)(uint8_t)data[size / 2] << 8) |
+			     ((uint32_t)(uint8_t)data[size - 1] << 16);
+			hi = 0;
+		} else {
+			lo = hi = 0;
+		}
+		h = hash64_mul_fold(lo ^ (HASH64_PRIME_1 + h),
+				    hi ^ (HASH64_PRIME_2 - h) ^ size);
+	}
+
+	/**
+	 * Process a string as it is seen by the collation: the sort key
+	 * of the string is mixed into the state part by part, so that
+	 * collated strings get full 64-bit hashes.
+	 */
+	uint32_t
+	process_coll(const char *str, uint32_t size, struct coll *coll)
+	{
+		return coll->sort_key(str, size, process_sort_key_part,
+				      this, coll);
+	}
+
+	static void
+	process_sort_key_part(const char *data, size_t size, void *arg)
+	{
+		static_cast<hash64_hasher *>(arg)->process(data, size);
+	}
+
+	hash_t
+	result(uint32_t total_size)
+	{
+		uint64_t r = h ^ (total_size * HASH64_PRIME_2);
+		r ^= r >> 37;
+		r *= HASH64_PRIME_MX;
+		r ^= r >> 32;
+		return r;
+	}
+};
+
+template <class hasher>
 static uint32_t
-hash_mp_uint(uint32_t *ph, uint32_t *pcarry, uint64_t num)
+hash_mp_uint(hasher *state, uint64_t num)
 {
 	char data[16];
 	uint32_t size;
@@ -57,12 +212,13 @@ hash_mp_uint(uint32_t *ph, uint32_t *pcarry, uint64_t num)
 		mp_store_u64(data, num);
 		size = 8;
 	}
-	PMurHash32_Process(ph, pcarry, data, size);
+	state->process(data, size);
 	return size;
 }
 
+template <class hasher>
 static uint32_t
-hash_mp_nint(uint32_t *ph, uint32_t *pcarry, int64_t num)
+hash_mp_nint(hasher *state, int64_t num)
 {
 	assert(num < 0);
 	char data[16];
@@ -80,58 +236,72 @@ hash_mp_nint(uint32_t *ph, uint32_t *pcarry, int64_t num)
 		mp_store_u64(data, num);
 		size = 8;
 	}
-	PMurHash32_Process(ph, pcarry, data, size);
+	state->process(data, size);
 	return size;
 }
 
+template <class hasher>
 static uint32_t
-hash_mp_int(uint32_t *ph, uint32_t *pcarry, int64_t num)
+hash_mp_int(hasher *state, int64_t num)
 {
 	if (num >= 0)
-		return hash_mp_uint(ph, pcarry, num);
-	return hash_mp_nint(ph, pcarry, num);
+		return hash_mp_uint(state, num);
+	return hash_mp_nint(state, num);
 }
 
+template <class hasher>
 static uint32_t
-hash_mp_double(uint32_t *ph, uint32_t *pcarry, double num)
+hash_mp_double(hasher *state, double num)
 {
 	char buf[16];
 	char *end = mp_store_double(buf, num);
 	size_t size = end - buf;
-	PMurHash32_Process(ph, pcarry, buf, size);
+	state->process(buf, size);
 	return size;
 }
 
-template <bool has_optional_parts, bool has_json_paths>
-uint32_t
+template <class hasher, bool has_optional_parts, bool has_json_paths>
+typename hasher::hash_t
 tuple_hash_impl(struct tuple *tuple, struct key_def *key_def);
 
-void
-key_def_set_hash_func(struct key_def *key_def) {
+template <class hasher>
+static void
+key_def_set_hash_func_impl(struct key_def *key_def,
+			   typename hasher::hash_t (**func)(struct tuple *,
+							    struct key_def *))
+{
 	if (key_def->has_optional_parts) {
 		if (key_def->has_json_paths)
-			key_def->tuple_hash = tuple_hash_impl<true, true>;
+			*func = tuple_hash_impl<hasher, true, true>;
 		else
-			key_def->tuple_hash = tuple_hash_impl<true, false>;
+			*func = tuple_hash_impl<hasher, true, false>;
 	} else {
 		if (key_def->has_json_paths)
-			key_def->tuple_hash = tuple_hash_impl<false, true>;
+			*func = tuple_hash_impl<hasher, false, true>;
 		else
-			key_def->tuple_hash = tuple_hash_impl<false, false>;
+			*func = tuple_hash_impl<hasher, false, false>;
 	}
 }
 
-uint32_t
-tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
-		 struct coll *coll)
+void
+key_def_set_hash_func(struct key_def *key_def) {
+	key_def_set_hash_func_impl<murmur3_hasher>(key_def,
+						   &key_def->tuple_hash);
+	key_def_set_hash_func_impl<hash64_hasher>(key_def,
+						  &key_def->tuple_hash64);
+}
+
+template <class hasher>
+static uint32_t
+tuple_hash_field_impl(hasher *state, const char **field, struct coll *coll)
 {
 	const char *f = *field;
 	uint32_t size;
 	switch (mp_typeof(**field)) {
 	case MP_UINT:
-		return hash_mp_uint(ph1, pcarry, mp_decode_uint(field));
+		return hash_mp_uint(state, mp_decode_uint(field));
 	case MP_INT:
-		return hash_mp_int(ph1, pcarry, mp_decode_int(field));
+		return hash_mp_int(state, mp_decode_int(field));
 	case MP_STR:
 		/*
 		 * (!) MP_STR fields hashed **excluding** MsgPack format
@@ -141,7 +311,7 @@ tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
 		 */
 		f = mp_decode_str(field, &size);
 		if (coll != NULL)
-			return coll->hash(f, size, ph1, pcarry, coll);
+			return state->process_coll(f, size, coll);
 		break;
 	case MP_FLOAT:
 	case MP_DOUBLE: {
@@ -157,10 +327,10 @@ tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
 			     mp_decode_double(field);
 		if (!isfinite(val) || modf(val, &iptr) != 0 ||
 		    val < -exp2(63) || val >= exp2(64))
-			return hash_mp_double(ph1, pcarry, val);
+			return hash_mp_double(state, val);
 		if (val >= 0)
-			return hash_mp_uint(ph1, pcarry, (uint64_t)val);
-		return hash_mp_nint(ph1, pcarry, (int64_t)val);
+			return hash_mp_uint(state, (uint64_t)val);
+		return hash_mp_nint(state, (int64_t)val);
 	}
 	default:
 		mp_next(field);
@@ -176,19 +346,41 @@ tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
 		break;
 	}
 	assert(size < INT32_MAX);
-	PMurHash32_Process(ph1, pcarry, f, size);
+	state->process(f, size);
 	return size;
 }
 
-uint32_t
-tuple_hash_null(uint32_t *ph1, uint32_t *pcarry)
+template <class hasher>
+static uint32_t
+tuple_hash_null_impl(hasher *state)
 {
 	assert(mp_sizeof_nil() == 1);
 	const char null = 0xc0;
-	PMurHash32_Process(ph1, pcarry, &null, 1);
+	state->process(&null, 1);
 	return mp_sizeof_nil();
 }
 
+uint32_t
+tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
+		 struct coll *coll)
+{
+	murmur3_hasher state(*ph1, *pcarry);
+	uint32_t size = tuple_hash_field_impl(&state, field, coll);
+	*ph1 = state.h;
+	*pcarry = state.carry;
+	return size;
+}
+
+uint32_t
+tuple_hash_null(uint32_t *ph1, uint32_t *pcarry)
+{
+	murmur3_hasher state(*ph1, *pcarry);
+	uint32_t size = tuple_hash_null_impl(&state);
+	*ph1 = state.h;
+	*pcarry = state.carry;
+	return size;
+}
+
 uint32_t
 tuple_hash_key_part(uint32_t *ph1, uint32_t *pcarry, struct tuple *tuple,
 		    struct key_part *part, int multikey_idx)
@@ -199,16 +391,15 @@ tuple_hash_key_part(uint32_t *ph1, uint32_t *pcarry, struct tuple *tuple,
 	return tuple_hash_field(ph1, pcarry, &field, part->coll);
 }
 
-template <bool has_optional_parts, bool has_json_paths>
-uint32_t
+template <class hasher, bool has_optional_parts, bool has_json_paths>
+typename hasher::hash_t
 tuple_hash_impl(struct tuple *tuple, struct key_def *key_def)
 {
 	assert(has_json_paths == key_def->has_json_paths);
 	assert(has_optional_parts == key_def->has_optional_parts);
 	assert(!key_def->is_multikey);
 	assert(!key_def->for_func_index);
-	uint32_t h = HASH_SEED;
-	uint32_t carry = 0;
+	hasher state;
 	uint32_t total_size = 0;
 	uint32_t prev_fieldno = key_def->parts[0].fieldno;
 	struct tuple_format *format = tuple_format(tuple);
@@ -224,10 +415,10 @@ tuple_hash_impl(struct tuple *tuple, struct key_def *key_def)
 	}
 	const char *end = (char *)tuple + tuple_size(tuple);
 	if (has_optional_parts && field == NULL) {
-		total_size += tuple_hash_null(&h, &carry);
+		total_size += tuple_hash_null_impl(&state);
 	} else {
-		total_size += tuple_hash_field(&h, &carry, &field,
-					       key_def->parts[0].coll);
+		total_size += tuple_hash_field_impl(&state, &field,
+						    key_def->parts[0].coll);
 	}
 	for (uint32_t part_id = 1; part_id < key_def->part_count; part_id++) {
 		struct key_part *part = &key_def->parts[part_id];
@@ -248,28 +439,40 @@ tuple_hash_impl(struct tuple *tuple, struct key_def *key_def)
 		}
 
 		if (has_optional_parts && (field == NULL || field >= end)) {
-			total_size += tuple_hash_null(&h, &carry);
+			total_size += tuple_hash_null_impl(&state);
 		} else {
 			total_size +=
-				tuple_hash_field(&h, &carry, &field,
-						 key_def->parts[part_id].coll);
+				tuple_hash_field_impl(&state, &field,
+						      key_def->parts[part_id].coll);
 		}
 		prev_fieldno = key_def->parts[part_id].fieldno;
 	}
 
-	return PMurHash32_Result(h, carry, total_size);
+	return state.result(total_size);
 }
 
-uint32_t
-key_hash(const char *key, struct key_def *key_def)
+template <class hasher>
+static typename hasher::hash_t
+key_hash_impl(const char *key, struct key_def *key_def)
 {
-	uint32_t h = HASH_SEED;
-	uint32_t carry = 0;
+	hasher state;
 	uint32_t total_size = 0;
 
 	for (struct key_part *part = key_def->parts;
 	     part < key_def->parts + key_def->part_count; part++)
-		total_size += tuple_hash_field(&h, &carry, &key, part->coll);
+		total_size += tuple_hash_field_impl(&state, &key, part->coll);
+
+	return state.result(total_size);
+}
 
-	return PMurHash32_Result(h, carry, total_size);
+uint32_t
+key_hash(const char *key, struct key_def *key_def)
+{
+	return key_hash_impl<murmur3_hasher>(key, key_def);
+}
+
+uint64_t
+key_hash64(const char *key, struct key_def *key_def)
+{
+	return key_hash_impl<hash64_hasher>(key, key_def);
 }
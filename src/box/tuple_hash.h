@@ -37,7 +37,7 @@ extern "C" {
 struct key_def;
 
 /**
- * Initialize tuple_hash() and key_hash() function for the key_def
+ * Initialize tuple_hash() and tuple_hash64() functions for the key_def
  * @param key_def key definition
  */
 void
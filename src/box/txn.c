@@ -310,6 +310,7 @@ txn_stmt_new(struct txn *txn, uint16_t type)
 	stmt->next_in_del_list = NULL;
 	stmt->engine_savepoint = NULL;
 	stmt->row = NULL;
+	stmt->parent_row = NULL;
 	stmt->has_triggers = false;
 	stmt->is_own_change = false;
 	stmt->type = type;
@@ -680,9 +681,11 @@ txn_commit_stmt(struct txn *txn, struct request *request)
 	/*
 	 * Create WAL record for the write requests in
 	 * non-data-temporary spaces. stmt->space can be NULL for
-	 * IRPOTO_NOP or IPROTO_RAFT_CONFIRM.
+	 * IRPOTO_NOP or IPROTO_RAFT_CONFIRM. request is NULL for
+	 * rows of a multi-row request logged by the parent statement.
 	 */
-	if (stmt->space == NULL || !space_is_data_temporary(stmt->space)) {
+	if (request != NULL && (stmt->space == NULL ||
+				!space_is_data_temporary(stmt->space))) {
 		if (txn_add_redo(txn, stmt, request) != 0)
 			goto fail;
 		assert(stmt->row != NULL);
@@ -343,6 +343,12 @@ struct txn_stmt {
 	void *engine_savepoint;
 	/** Redo info: the binary log row */
 	struct xrow_header *row;
+	/**
+	 * Log row of the multi-row request the statement is a part of,
+	 * if the statement isn't logged itself, otherwise NULL. It's
+	 * passed to recovery triggers instead of the statement row.
+	 */
+	struct xrow_header *parent_row;
 	/** on_commit and/or on_rollback list is not empty. */
 	bool has_triggers;
 	/*
@@ -971,6 +977,10 @@ txn_stmt_mark_as_temporary(struct txn *txn, struct txn_stmt *stmt);
  * End a statement. In autocommit mode, end
  * the current transaction as well.
  *
+ * If @a request is NULL, no redo log record is created for the
+ * statement. This is used for rows of a multi-row request, which
+ * is logged as a whole by the parent statement.
+ *
  * Return 0 on success. On error, rollback
  * the statement and return -1.
  */
@@ -55,6 +55,7 @@
 #include <small/region.h>
 #include <small/mempool.h>
 
+#include "arrow_insert.h"
 #include "coio_task.h"
 #include "cbus.h"
 #include "histogram.h"
@@ -230,6 +231,20 @@ vy_lsm(struct index *index)
 
 /** {{{ Introspection */
 
+static void
+vy_info_append_task(const struct vy_task_progress *progress, void *arg)
+{
+	struct info_handler *h = arg;
+	info_table_begin(h, progress->worker);
+	info_append_str(h, "type", progress->type);
+	info_append_int(h, "space_id", progress->lsm->space_id);
+	info_append_int(h, "index_id", progress->lsm->index_id);
+	info_append_int(h, "input_rows", progress->input_rows);
+	info_append_int(h, "output_rows", progress->output_rows);
+	info_append_double(h, "time", progress->time);
+	info_table_end(h);
+}
+
 static void
 vy_info_append_scheduler(struct vy_env *env, struct info_handler *h)
 {
@@ -248,6 +263,9 @@ vy_info_append_scheduler(struct vy_env *env, struct info_handler *h)
 	info_append_int(h, "compaction_output", stat->compaction_output);
 	info_append_int(h, "compaction_queue",
 			env->lsm_env.compaction_queue_size);
+	info_table_begin(h, "tasks");
+	vy_scheduler_foreach_task(&env->scheduler, vy_info_append_task, h);
+	info_table_end(h); /* tasks */
 	info_table_end(h); /* scheduler */
 }
 
@@ -298,6 +316,7 @@ vy_info_append_memory(struct vy_env *env, struct info_handler *h)
 	info_append_int(h, "level0", lsregion_used(&env->mem_env.allocator));
 	info_append_int(h, "tuple", env->stmt_env.sum_tuple_size);
 	info_append_int(h, "tuple_cache", env->cache_env.mem_used);
+	info_append_int(h, "page_cache", env->run_env.page_cache.mem_used);
 	info_append_int(h, "page_index", env->lsm_env.page_index_size);
 	info_append_int(h, "bloom_filter", env->lsm_env.bloom_size);
 	info_table_end(h); /* memory */
@@ -412,6 +431,15 @@ vinyl_index_stat(struct index *index, struct info_handler *h)
 	info_append_int(h, "hit", stat->disk.iterator.bloom_hit);
 	info_append_int(h, "miss", stat->disk.iterator.bloom_miss);
 	info_table_end(h); /* bloom */
+	info_table_begin(h, "page_cache");
+	info_append_int(h, "hit", stat->disk.iterator.page_cache_hit);
+	info_append_int(h, "miss", stat->disk.iterator.page_cache_miss);
+	info_table_end(h); /* page_cache */
+	info_table_begin(h, "readahead");
+	info_append_int(h, "pages", stat->disk.iterator.readahead_pages);
+	info_append_int(h, "hit", stat->disk.iterator.readahead_hit);
+	info_append_int(h, "wait", stat->disk.iterator.readahead_wait);
+	info_table_end(h); /* readahead */
 	info_table_end(h); /* iterator */
 	info_table_begin(h, "dump");
 	info_append_int(h, "count", stat->disk.dump.count);
@@ -512,6 +540,7 @@ vinyl_engine_memory_stat(struct engine *engine, struct engine_memory_stat *stat)
 	stat->index += env->lsm_env.bloom_size;
 	stat->index += env->lsm_env.page_index_size;
 	stat->cache += env->cache_env.mem_used;
+	stat->cache += env->run_env.page_cache.mem_used;
 	stat->tx += vy_tx_manager_mem_used(env->xm);
 }
 
@@ -678,6 +707,12 @@ vinyl_space_check_index_def(struct space *space, struct index_def *index_def)
 			 "hint is only reasonable with memtx tree index");
 		return -1;
 	}
+	if (index_def->opts.hash_bits != 32) {
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name(space),
+			 "hash_bits is only reasonable with memtx hash index");
+		return -1;
+	}
 
 	struct key_def *key_def = index_def->key_def;
 
@@ -699,9 +734,10 @@ vinyl_space_check_index_def(struct space *space, struct index_def *index_def)
 			 "covering index");
 		return -1;
 	}
-	if (index_def->opts.layout != NULL) {
+	if (vy_run_layout_by_name(index_def->opts.layout) ==
+	    vy_run_layout_MAX) {
 		diag_set(ClientError, ER_UNSUPPORTED, "vinyl",
-			 "'layout' option");
+			 tt_sprintf("layout '%s'", index_def->opts.layout));
 		return -1;
 	}
 	return 0;
@@ -933,6 +969,7 @@ vinyl_index_update_def(struct index *index)
 {
 	struct vy_lsm *lsm = vy_lsm(index);
 	lsm->opts = index->def->opts;
+	lsm->run_layout = vy_run_layout_by_name(index->def->opts.layout);
 	/*
 	 * Sic: We copy key definitions in-place instead of reallocating them
 	 * because they may be used by read iterators by pointer, for example,
@@ -2833,6 +2870,7 @@ vy_env_shutdown(struct vy_env *e)
 {
 	vy_scheduler_shutdown(&e->scheduler);
 	vy_squash_queue_shutdown(e->squash_queue);
+	vy_run_env_shutdown(&e->run_env);
 	vy_log_shutdown();
 }
 
@@ -2854,6 +2892,34 @@ vinyl_engine_set_cache(struct engine *engine, size_t quota)
 	vy_cache_env_set_quota(&env->cache_env, quota);
 }
 
+void
+vinyl_engine_set_page_cache(struct engine *engine, size_t quota)
+{
+	struct vy_env *env = vy_env(engine);
+	vy_run_env_set_page_cache(&env->run_env, quota);
+}
+
+void
+vinyl_engine_set_max_subcompactions(struct engine *engine, int count)
+{
+	struct vy_env *env = vy_env(engine);
+	env->scheduler.max_subcompactions = count;
+}
+
+void
+vinyl_engine_set_readahead(struct engine *engine, int page_count)
+{
+	struct vy_env *env = vy_env(engine);
+	vy_run_env_set_readahead(&env->run_env, page_count);
+}
+
+void
+vinyl_engine_set_log_compression_level(struct engine *engine, int level)
+{
+	(void)engine;
+	vy_log_set_compression_level(level);
+}
+
 int
 vinyl_engine_set_memory(struct engine *engine, size_t size)
 {
@@ -4791,7 +4857,7 @@ static const struct space_vtab vinyl_space_vtab = {
 	/* .execute_delete = */ vinyl_space_execute_delete,
 	/* .execute_update = */ vinyl_space_execute_update,
 	/* .execute_upsert = */ vinyl_space_execute_upsert,
-	/* .execute_insert_arrow = */ generic_space_execute_insert_arrow,
+	/* .execute_insert_arrow = */ arrow_insert_rows,
 	/* .ephemeral_replace = */ generic_space_ephemeral_replace,
 	/* .ephemeral_delete = */ generic_space_ephemeral_delete,
 	/* .ephemeral_rowid_next = */ generic_space_ephemeral_rowid_next,
@@ -4829,6 +4895,7 @@ static const struct index_vtab vinyl_index_vtab = {
 	/* .count = */ generic_index_count,
 	/* .get_internal = */ generic_index_get_internal,
 	/* .get = */ vinyl_index_get,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ generic_index_replace,
 	/* .create_iterator = */ vinyl_index_create_iterator,
 	/* .create_iterator_with_offset = */
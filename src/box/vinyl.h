@@ -41,6 +41,12 @@ extern "C" {
 struct info_handler;
 struct engine;
 
+/** Max value of the vinyl_max_subcompactions option. */
+enum { VINYL_MAX_SUBCOMPACTIONS_MAX = 16 };
+
+/** Max value of the vinyl_readahead option. */
+enum { VINYL_READAHEAD_MAX = 256 };
+
 struct engine *
 vinyl_engine_new(const char *dir, size_t memory,
 		 int read_threads, int write_threads, bool force_recovery);
@@ -57,6 +63,32 @@ vinyl_engine_stat(struct engine *engine, struct info_handler *handler);
 void
 vinyl_engine_set_cache(struct engine *engine, size_t quota);
 
+/**
+ * Update vinyl page cache size.
+ */
+void
+vinyl_engine_set_page_cache(struct engine *engine, size_t quota);
+
+/**
+ * Update the max number of parts a range compaction may be
+ * split into.
+ */
+void
+vinyl_engine_set_max_subcompactions(struct engine *engine, int count);
+
+/**
+ * Update the max number of pages a range scan may read ahead.
+ */
+void
+vinyl_engine_set_readahead(struct engine *engine, int page_count);
+
+/**
+ * Update the zstd compression level of vylog files. Takes effect
+ * when the vylog is rotated on checkpoint.
+ */
+void
+vinyl_engine_set_log_compression_level(struct engine *engine, int level);
+
 /**
  * Update vinyl memory size.
  */
@@ -1253,6 +1253,19 @@ vy_log_rotate(const struct vclock *vclock)
 	return -1;
 }
 
+void
+vy_log_set_compression_level(int level)
+{
+	/*
+	 * The options are read when the log file is opened, see
+	 * vy_log_open() and vy_log_create(), which is only done
+	 * under the latch.
+	 */
+	latch_lock(&vy_log.latch);
+	vy_log.dir.opts.compression_level = level;
+	latch_unlock(&vy_log.latch);
+}
+
 void
 vy_log_collect_garbage(const struct vclock *vclock)
 {
@@ -476,6 +476,14 @@ vy_log_open(struct xlog *xlog);
 int
 vy_log_rotate(const struct vclock *vclock);
 
+/**
+ * Set the zstd compression level of vylog files. 0 disables
+ * compression. The current vylog file keeps its level, the new
+ * one is used starting from the next rotation.
+ */
+void
+vy_log_set_compression_level(int level);
+
 /**
  * Remove metadata log files that are not needed to recover
  * from checkpoint @vclock.
@@ -227,6 +227,7 @@ vy_lsm_new(struct vy_lsm_env *lsm_env, struct vy_cache_env *cache_env,
 	lsm->index_id = index_def->iid;
 	lsm->group_id = group_id;
 	lsm->opts = index_def->opts;
+	lsm->run_layout = vy_run_layout_by_name(index_def->opts.layout);
 	vy_lsm_read_set_new(&lsm->read_set);
 	rlist_create(&lsm->on_destroy);
 
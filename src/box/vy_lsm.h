@@ -46,6 +46,7 @@
 #include "vy_range.h"
 #include "vy_stat.h"
 #include "vy_read_set.h"
+#include "vy_run.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -190,8 +191,15 @@ struct vy_lsm {
 	uint32_t space_id;
 	/** Replication group ID. */
 	uint32_t group_id;
-	/** Index options. */
+	/**
+	 * Index options.
+	 *
+	 * Note, string options aren't copied so they must not be
+	 * accessed, use the fields below instead.
+	 */
 	struct index_opts opts;
+	/** Layout of runs written by dump and compaction. */
+	enum vy_run_layout run_layout;
 	/** Key definition used to compare tuples. */
 	struct key_def *cmp_def;
 	/** Key definition passed by the user. */
@@ -38,7 +38,10 @@
 #include "cbus.h"
 #include "memory.h"
 #include "coio_task.h"
+#include "coio_uring.h"
 
+#include "column_mask.h"
+#include "mp_extension_types.h"
 #include "replication.h"
 #include "tuple_bloom.h"
 #include "xlog.h"
@@ -58,6 +61,8 @@ static const uint64_t vy_run_info_key_map = (1 << VY_RUN_INFO_MIN_KEY) |
 					    (1 << VY_RUN_INFO_MAX_LSN) |
 					    (1 << VY_RUN_INFO_PAGE_COUNT);
 
+const char *vy_run_layout_strs[] = {"row", "columnar"};
+
 /** xlog meta type for .run files */
 #define XLOG_META_TYPE_RUN "RUN"
 
@@ -81,6 +86,13 @@ const char *vy_file_suffix[] = {
 struct vy_run_reader {
 	/** Thread that processes read requests. */
 	struct cord cord;
+	/** Fiber fetching read requests in the reader thread. */
+	struct fiber *fiber;
+	/**
+	 * Number of read requests being processed in separate
+	 * fibers, see vy_run_reader_loop().
+	 */
+	int task_count;
 	/** Pipe from tx to the reader thread. */
 	struct cpipe reader_pipe;
 	/** Pipe from the reader thread to tx. */
@@ -103,6 +115,11 @@ struct vy_page_read_task {
 	struct key_def *cmp_def;
 	/** disk format (needed for key lookup) */
 	struct tuple_format *format;
+	/**
+	 * Fields to read from a columnar page. If the page turns out
+	 * to contain the key, it's reread in full.
+	 */
+	uint64_t column_mask;
 	/** [out] position of the key in the page */
 	uint32_t pos_in_page;
 	/** [out] true if key was found in the page */
@@ -119,6 +136,57 @@ vy_free_zdctx(void *arg)
 	ZSTD_freeDStream(arg);
 }
 
+/** Process a read request in a reader thread fiber. */
+static int
+vy_run_reader_task_f(va_list ap)
+{
+	struct vy_run_reader *reader = va_arg(ap, struct vy_run_reader *);
+	struct cmsg *msg = va_arg(ap, struct cmsg *);
+	cmsg_deliver(msg);
+	/* cbus_stop_loop() cancels the fiber delivering its message. */
+	if (fiber_is_cancelled())
+		fiber_cancel(reader->fiber);
+	if (--reader->task_count == 0)
+		fiber_wakeup(reader->fiber);
+	return 0;
+}
+
+/**
+ * Like cbus_loop(), but processes each read request in a separate
+ * fiber. Used if the reader thread has an io_uring ring so that
+ * the reads of different requests are submitted in one batch and
+ * run in parallel.
+ */
+static void
+vy_run_reader_loop(struct vy_run_reader *reader,
+		   struct cbus_endpoint *endpoint)
+{
+	while (true) {
+		struct stailq output;
+		stailq_create(&output);
+		cbus_endpoint_fetch(endpoint, &output);
+		struct cmsg *msg, *msg_next;
+		stailq_foreach_entry_safe(msg, msg_next, &output, fifo) {
+			struct fiber *f = fiber_new_system(
+				cord_name(cord()), vy_run_reader_task_f);
+			if (f == NULL) {
+				diag_log();
+				cmsg_deliver(msg);
+				continue;
+			}
+			reader->task_count++;
+			fiber_start(f, reader, msg);
+		}
+		fiber_check_gc();
+		if (fiber_is_cancelled())
+			break;
+		fiber_yield();
+	}
+	/* Wait for the requests in progress to complete. */
+	while (reader->task_count > 0)
+		fiber_yield();
+}
+
 /** Run reader thread function. */
 static int
 vy_run_reader_f(va_list ap)
@@ -126,15 +194,50 @@ vy_run_reader_f(va_list ap)
 	struct vy_run_reader *reader = va_arg(ap, struct vy_run_reader *);
 	struct cbus_endpoint endpoint;
 
+	reader->fiber = fiber();
+	reader->task_count = 0;
+	coio_uring_init();
 	cpipe_create(&reader->tx_pipe, "tx_prio");
 	cbus_endpoint_create(&endpoint, cord_name(cord()),
 			     fiber_schedule_cb, fiber());
-	cbus_loop(&endpoint);
+	if (coio_uring_is_enabled())
+		vy_run_reader_loop(reader, &endpoint);
+	else
+		cbus_loop(&endpoint);
 	cbus_endpoint_destroy(&endpoint, cbus_process);
 	cpipe_destroy(&reader->tx_pipe);
+	coio_uring_free();
 	return 0;
 }
 
+/**
+ * Read from a run file. Like fio_pread(), reads until the buffer
+ * is full or the end of the file is reached. Reader threads that
+ * have an io_uring ring use it so that the fiber yields while the
+ * read is in progress. Reads done in tx (on recovery) are blocking.
+ */
+static ssize_t
+vy_run_pread(int fd, void *buf, size_t count, off_t offset)
+{
+	if (cord_is_main() || !coio_uring_is_enabled())
+		return fio_pread(fd, buf, count, offset);
+	size_t n = 0;
+	while (n < count) {
+		ssize_t rc = coio_uring_pread(fd, (char *)buf + n, count - n,
+					      offset + n);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			say_syserror("pread, [%s]", fio_filename(fd));
+			return -1;
+		}
+		if (rc == 0)
+			break;
+		n += rc;
+	}
+	return n;
+}
+
 /** Start run reader threads. */
 static void
 vy_run_env_start_readers(struct vy_run_env *env)
@@ -177,6 +280,174 @@ vy_run_env_stop_readers(struct vy_run_env *env)
 	free(env->reader_pool);
 }
 
+static void
+vy_page_delete(struct vy_page *page);
+
+static inline void
+vy_page_ref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	page->refs++;
+}
+
+static inline void
+vy_page_unref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	if (--page->refs == 0)
+		vy_page_delete(page);
+}
+
+/** Page cache key: {run id, page no}. */
+struct vy_page_cache_key {
+	int64_t run_id;
+	uint32_t page_no;
+};
+
+static inline uint32_t
+vy_page_cache_hash(int64_t run_id, uint32_t page_no)
+{
+	uint64_t h = (uint64_t)run_id * 0x9E3779B97F4A7C15ULL + page_no;
+	return (uint32_t)(h ^ (h >> 32));
+}
+
+#define mh_name _vy_page_cache
+#define mh_key_t const struct vy_page_cache_key *
+#define mh_node_t struct vy_page *
+#define mh_arg_t void *
+#define mh_hash(a, arg) (vy_page_cache_hash((*(a))->run_id, (*(a))->page_no))
+#define mh_hash_key(a, arg) (vy_page_cache_hash((a)->run_id, (a)->page_no))
+#define mh_cmp(a, b, arg) ((*(a))->run_id != (*(b))->run_id || \
+			   (*(a))->page_no != (*(b))->page_no)
+#define mh_cmp_key(a, b, arg) ((a)->run_id != (*(b))->run_id || \
+			       (a)->page_no != (*(b))->page_no)
+#define MH_SOURCE
+#include "salad/mhash.h"
+
+/** Size of memory occupied by a page. */
+static inline size_t
+vy_page_size(struct vy_page *page)
+{
+	return sizeof(*page) + page->row_count * sizeof(uint32_t) +
+	       page->unpacked_size;
+}
+
+static void
+vy_page_cache_create(struct vy_page_cache *cache)
+{
+	cache->map = mh_vy_page_cache_new();
+	rlist_create(&cache->lru);
+	cache->mem_used = 0;
+	cache->quota = 0;
+}
+
+/** Remove a page from the cache and drop the reference to it. */
+static void
+vy_page_cache_remove(struct vy_page_cache *cache, struct vy_page *page,
+		     mh_int_t pos)
+{
+	assert(*mh_vy_page_cache_node(cache->map, pos) == page);
+	mh_vy_page_cache_del(cache->map, pos, NULL);
+	rlist_del_entry(page, in_cache);
+	assert(cache->mem_used >= vy_page_size(page));
+	cache->mem_used -= vy_page_size(page);
+	vy_page_unref(page);
+}
+
+/** Evict least recently used pages until the cache fits in the quota. */
+static void
+vy_page_cache_evict(struct vy_page_cache *cache)
+{
+	while (cache->mem_used > cache->quota) {
+		assert(!rlist_empty(&cache->lru));
+		struct vy_page *page = rlist_last_entry(&cache->lru,
+							struct vy_page,
+							in_cache);
+		struct vy_page_cache_key key = {page->run_id, page->page_no};
+		mh_int_t pos = mh_vy_page_cache_find(cache->map, &key, NULL);
+		vy_page_cache_remove(cache, page, pos);
+	}
+}
+
+static void
+vy_page_cache_destroy(struct vy_page_cache *cache)
+{
+	cache->quota = 0;
+	vy_page_cache_evict(cache);
+	mh_vy_page_cache_delete(cache->map);
+}
+
+/**
+ * Look up a page in the cache. On success, moves the page to
+ * the head of the LRU list and returns it. The caller must take
+ * a reference to the page if it wants to keep it.
+ */
+static struct vy_page *
+vy_page_cache_get(struct vy_page_cache *cache, int64_t run_id,
+		  uint32_t page_no)
+{
+	if (cache->mem_used == 0)
+		return NULL;
+	struct vy_page_cache_key key = {run_id, page_no};
+	mh_int_t pos = mh_vy_page_cache_find(cache->map, &key, NULL);
+	if (pos == mh_end(cache->map))
+		return NULL;
+	struct vy_page *page = *mh_vy_page_cache_node(cache->map, pos);
+	rlist_move_entry(&cache->lru, page, in_cache);
+	return page;
+}
+
+/**
+ * Add a page to the cache. The cache takes a reference to the
+ * page. Does nothing if the page doesn't fit in the quota.
+ */
+static void
+vy_page_cache_put(struct vy_page_cache *cache, struct vy_page *page)
+{
+	assert(rlist_empty(&page->in_cache));
+	assert(!page->is_partial);
+	size_t size = vy_page_size(page);
+	if (size > cache->quota)
+		return;
+	struct vy_page *replaced = NULL;
+	struct vy_page **replaced_ptr = &replaced;
+	mh_vy_page_cache_put(cache->map, &page, &replaced_ptr, NULL);
+	if (replaced != NULL) {
+		/*
+		 * The same page may be read by two fibers
+		 * concurrently. Keep the newest copy.
+		 */
+		rlist_del_entry(replaced, in_cache);
+		cache->mem_used -= vy_page_size(replaced);
+		vy_page_unref(replaced);
+	}
+	vy_page_ref(page);
+	rlist_add_entry(&cache->lru, page, in_cache);
+	cache->mem_used += size;
+	vy_page_cache_evict(cache);
+}
+
+/** Remove all pages of a run from the cache. */
+static void
+vy_page_cache_invalidate_run(struct vy_page_cache *cache, struct vy_run *run)
+{
+	for (uint32_t page_no = 0; page_no < run->info.page_count &&
+	     cache->mem_used > 0; page_no++) {
+		struct vy_page_cache_key key = {run->id, page_no};
+		mh_int_t pos = mh_vy_page_cache_find(cache->map, &key, NULL);
+		if (pos != mh_end(cache->map))
+			vy_page_cache_remove(cache, *mh_vy_page_cache_node(
+						cache->map, pos), pos);
+	}
+}
+
+void
+vy_run_env_set_page_cache(struct vy_run_env *env, size_t quota)
+{
+	env->page_cache.quota = quota;
+	vy_page_cache_evict(&env->page_cache);
+}
+
 /**
  * Initialize vinyl run environment
  */
@@ -189,8 +460,14 @@ vy_run_env_create(struct vy_run_env *env, int read_threads)
 	mempool_create(&env->read_task_pool, cord_slab_cache(),
 		       sizeof(struct vy_page_read_task));
 	env->initial_join = false;
+	vy_page_cache_create(&env->page_cache);
+	rlist_create(&env->readahead_tasks);
+	fiber_cond_create(&env->readahead_cond);
 }
 
+static void
+vy_run_env_free_readahead(struct vy_run_env *env);
+
 /**
  * Destroy vinyl run environment
  */
@@ -199,6 +476,9 @@ vy_run_env_destroy(struct vy_run_env *env)
 {
 	if (env->reader_pool != NULL)
 		vy_run_env_stop_readers(env);
+	vy_run_env_free_readahead(env);
+	fiber_cond_destroy(&env->readahead_cond);
+	vy_page_cache_destroy(&env->page_cache);
 	mempool_destroy(&env->read_task_pool);
 	tt_pthread_key_delete(env->zdctx_key);
 }
@@ -214,6 +494,18 @@ vy_run_env_enable_coio(struct vy_run_env *env)
 	vy_run_env_start_readers(env);
 }
 
+/**
+ * Pick a reader thread to process the next read request.
+ */
+static struct vy_run_reader *
+vy_run_env_next_reader(struct vy_run_env *env)
+{
+	assert(env->reader_pool != NULL);
+	struct vy_run_reader *reader = &env->reader_pool[env->next_reader++];
+	env->next_reader %= env->reader_pool_size;
+	return reader;
+}
+
 /**
  * Execute a task on behalf of a reader thread.
  */
@@ -226,9 +518,7 @@ vy_run_env_coio_call(struct vy_run_env *env, struct cbus_call_msg *msg,
 		return func(msg);
 
 	/* Pick a reader thread. */
-	struct vy_run_reader *reader;
-	reader = &env->reader_pool[env->next_reader++];
-	env->next_reader %= env->reader_pool_size;
+	struct vy_run_reader *reader = vy_run_env_next_reader(env);
 
 	/* Post the task to the reader thread. */
 	if (cbus_call(&reader->reader_pipe, &reader->tx_pipe, msg, func) != 0)
@@ -270,6 +560,9 @@ vy_page_info_destroy(struct vy_page_info *page_info)
 {
 	if (page_info->min_key != NULL)
 		free(page_info->min_key);
+	for (uint32_t i = 0; i < page_info->chunk_count; i++)
+		free(page_info->chunks[i].min);
+	free(page_info->chunks);
 }
 
 struct vy_run *
@@ -317,6 +610,7 @@ void
 vy_run_delete(struct vy_run *run)
 {
 	assert(run->refs == 0);
+	vy_page_cache_invalidate_run(&run->env->page_cache, run);
 	if (run->fd >= 0 && close(run->fd) < 0)
 		say_syserror("close failed");
 	vy_run_clear(run);
@@ -528,6 +822,59 @@ vy_slice_cut(struct vy_slice *slice, int64_t id, struct vy_entry begin,
 	return 0;
 }
 
+/**
+ * Decode chunks of a columnar page from @a data and advance @a data.
+ * The chunks are encoded as an array of arrays:
+ *
+ *   [offset, size, unpacked_size(, min, max)]
+ *
+ * where min and max are present only for field chunks that have
+ * min/max stats, see struct vy_page_chunk.
+ */
+static int
+vy_page_info_decode_chunks(struct vy_page_info *page, const char **data,
+			   const char *filename)
+{
+	uint32_t chunk_count = mp_decode_array(data);
+	if (chunk_count == 0)
+		goto error;
+	size_t size = chunk_count * sizeof(*page->chunks);
+	page->chunks = calloc(1, size);
+	if (page->chunks == NULL) {
+		diag_set(OutOfMemory, size, "calloc", "struct vy_page_chunk");
+		return -1;
+	}
+	page->chunk_count = chunk_count;
+	for (uint32_t i = 0; i < chunk_count; i++) {
+		struct vy_page_chunk *chunk = &page->chunks[i];
+		uint32_t field_count = mp_decode_array(data);
+		if (field_count != 3 && field_count != 5)
+			goto error;
+		chunk->offset = mp_decode_uint(data);
+		chunk->size = mp_decode_uint(data);
+		chunk->unpacked_size = mp_decode_uint(data);
+		if (field_count == 3)
+			continue;
+		const char *min = *data;
+		mp_next(data);
+		const char *max = *data;
+		mp_next(data);
+		size = *data - min;
+		chunk->min = malloc(size);
+		if (chunk->min == NULL) {
+			diag_set(OutOfMemory, size, "malloc", "column stat");
+			return -1;
+		}
+		memcpy(chunk->min, min, size);
+		chunk->max = chunk->min + (max - min);
+	}
+	return 0;
+error:
+	diag_set(ClientError, ER_INVALID_INDEX_FILE, filename,
+		 "Can't decode page info: invalid chunks");
+	return -1;
+}
+
 /**
  * Decode page information from xrow.
  *
@@ -580,6 +927,13 @@ vy_page_info_decode(struct vy_page_info *page, const struct xrow_header *xrow,
 		case VY_PAGE_INFO_ROW_INDEX_OFFSET:
 			page->row_index_offset = mp_decode_uint(&pos);
 			break;
+		case VY_PAGE_INFO_CHUNKS:
+			if (vy_page_info_decode_chunks(page, &pos,
+						       filename) != 0) {
+				vy_page_info_destroy(page);
+				return -1;
+			}
+			break;
 		default:
 			mp_next(&pos); /* unknown key, ignore */
 			break;
@@ -632,8 +986,10 @@ iproto_to_tuple_bloom_version(uint32_t key)
 		return TUPLE_BLOOM_VERSION_V1;
 	case VY_RUN_INFO_BLOOM_FILTER_LEGACY_V2:
 		return TUPLE_BLOOM_VERSION_V2;
-	case VY_RUN_INFO_BLOOM_FILTER:
+	case VY_RUN_INFO_BLOOM_FILTER_LEGACY_V3:
 		return TUPLE_BLOOM_VERSION_V3;
+	case VY_RUN_INFO_BLOOM_FILTER:
+		return TUPLE_BLOOM_VERSION_V4;
 	default:
 		unreachable();
 	}
@@ -649,6 +1005,8 @@ tuple_bloom_version_to_iproto(enum tuple_bloom_version version)
 	case TUPLE_BLOOM_VERSION_V2:
 		return VY_RUN_INFO_BLOOM_FILTER_LEGACY_V2;
 	case TUPLE_BLOOM_VERSION_V3:
+		return VY_RUN_INFO_BLOOM_FILTER_LEGACY_V3;
+	case TUPLE_BLOOM_VERSION_V4:
 		return VY_RUN_INFO_BLOOM_FILTER;
 	default:
 		unreachable();
@@ -709,6 +1067,7 @@ vy_run_info_decode(struct vy_run_info *run_info,
 			break;
 		case VY_RUN_INFO_BLOOM_FILTER_LEGACY_V1:
 		case VY_RUN_INFO_BLOOM_FILTER_LEGACY_V2:
+		case VY_RUN_INFO_BLOOM_FILTER_LEGACY_V3:
 		case VY_RUN_INFO_BLOOM_FILTER:
 			run_info->bloom = tuple_bloom_decode(
 				&pos, iproto_to_tuple_bloom_version(key));
@@ -745,6 +1104,11 @@ vy_page_new(const struct vy_page_info *page_info)
 	}
 	page->unpacked_size = page_info->unpacked_size;
 	page->row_count = page_info->row_count;
+	page->is_columnar = false;
+	page->is_partial = false;
+	page->column_mask = COLUMN_MASK_FULL;
+	page->refs = 1;
+	rlist_create(&page->in_cache);
 	page->row_index = calloc(page_info->row_count, sizeof(uint32_t));
 	if (page->row_index == NULL) {
 		diag_set(OutOfMemory, page_info->row_count * sizeof(uint32_t),
@@ -752,6 +1116,12 @@ vy_page_new(const struct vy_page_info *page_info)
 		free(page);
 		return NULL;
 	}
+	if (page_info->chunks != NULL) {
+		/* Allocated by vy_page_read_columnar(). */
+		page->unpacked_size = 0;
+		page->data = NULL;
+		return page;
+	}
 
 	page->data = (char *)malloc(page_info->unpacked_size);
 	if (page->data == NULL) {
@@ -767,11 +1137,14 @@ vy_page_new(const struct vy_page_info *page_info)
 static void
 vy_page_delete(struct vy_page *page)
 {
+	assert(page->refs == 0);
+	assert(rlist_empty(&page->in_cache));
 	uint32_t *row_index = page->row_index;
 	char *data = page->data;
 #if !defined(NDEBUG)
 	memset(row_index, '#', sizeof(uint32_t) * page->row_count);
-	memset(data, '#', page->unpacked_size);
+	if (data != NULL)
+		memset(data, '#', page->unpacked_size);
 	memset(page, '#', sizeof(*page));
 #endif /* !defined(NDEBUG) */
 	free(row_index);
@@ -807,11 +1180,23 @@ static struct vy_entry
 vy_page_stmt(struct vy_page *page, uint32_t stmt_no,
 	     struct key_def *cmp_def, struct tuple_format *format)
 {
-	struct xrow_header xrow;
-	if (vy_page_xrow(page, stmt_no, &xrow) != 0)
-		return vy_entry_none();
 	struct vy_entry entry;
-	entry.stmt = vy_stmt_decode(&xrow, format);
+	if (page->is_columnar) {
+		assert(stmt_no < page->row_count);
+		const char *data = page->data + page->row_index[stmt_no];
+		struct vy_stmt_columnar_header header;
+		if (vy_stmt_columnar_header_decode(&data, &header) != 0)
+			return vy_entry_none();
+		const char *data_end = data;
+		mp_next(&data_end);
+		entry.stmt = vy_stmt_decode_columnar(&header, data, data_end,
+						     format);
+	} else {
+		struct xrow_header xrow;
+		if (vy_page_xrow(page, stmt_no, &xrow) != 0)
+			return vy_entry_none();
+		entry.stmt = vy_stmt_decode(&xrow, format);
+	}
 	if (entry.stmt == NULL)
 		return vy_entry_none();
 	entry.hint = vy_stmt_hint(entry.stmt, cmp_def);
@@ -855,20 +1240,24 @@ vy_page_find_key(struct vy_page *page, struct vy_entry key,
 	return 0;
 }
 
+static void
+vy_run_iterator_stop_readahead(struct vy_run_iterator *itr);
+
 /**
  * End iteration and free cached data.
  */
 static void
 vy_run_iterator_stop(struct vy_run_iterator *itr)
 {
+	vy_run_iterator_stop_readahead(itr);
 	if (itr->curr.stmt != NULL) {
 		tuple_unref(itr->curr.stmt);
 		itr->curr = vy_entry_none();
 	}
 	if (itr->curr_page != NULL) {
-		vy_page_delete(itr->curr_page);
+		vy_page_unref(itr->curr_page);
 		if (itr->prev_page != NULL)
-			vy_page_delete(itr->prev_page);
+			vy_page_unref(itr->prev_page);
 		itr->curr_page = itr->prev_page = NULL;
 	}
 }
@@ -914,37 +1303,519 @@ vy_run_filename(struct vy_run *run)
 	return buf;
 }
 
+/* {{{ Columnar pages */
+
 /**
- * Read a page requests from vinyl xlog data file.
+ * Return true if min/max stats of a field chunk account the given
+ * value. Only values that can be compared with the scalar comparator
+ * are accounted so nulls, arrays, maps, intervals and unknown
+ * extensions are skipped. Nulls precede all other values while the
+ * rest of them can't be indexed so the max value is still good for
+ * skipping pages.
+ */
+static bool
+vy_column_value_has_stat(const char *value)
+{
+	int8_t ext_type;
+	switch (mp_typeof(*value)) {
+	case MP_UINT:
+	case MP_INT:
+	case MP_STR:
+	case MP_BIN:
+	case MP_BOOL:
+	case MP_FLOAT:
+	case MP_DOUBLE:
+		return true;
+	case MP_EXT:
+		mp_decode_extl(&value, &ext_type);
+		return ext_type == MP_DECIMAL || ext_type == MP_UUID ||
+		       ext_type == MP_DATETIME;
+	default:
+		return false;
+	}
+}
+
+/** Min/max stats of a field chunk being built. */
+struct vy_column_stat {
+	/** Min value or NULL if no values were accounted. */
+	const char *min;
+	/** Max value or NULL if no values were accounted. */
+	const char *max;
+	/** Set if the column has values that can't be accounted. */
+	bool is_disabled;
+};
+
+/** Account a field value in min/max stats of a field chunk. */
+static void
+vy_column_stat_add(struct vy_column_stat *stat, const char *value)
+{
+	if (!vy_column_value_has_stat(value))
+		return;
+	if (stat->min == NULL ||
+	    tuple_compare_field(value, stat->min, FIELD_TYPE_SCALAR,
+				NULL) < 0)
+		stat->min = value;
+	if (stat->max == NULL ||
+	    tuple_compare_field(value, stat->max, FIELD_TYPE_SCALAR,
+				NULL) > 0)
+		stat->max = value;
+}
+
+/**
+ * Account key parts of a primary index DELETE statement in min/max
+ * stats of field chunks. Stats of fields indexed by JSON path are
+ * disabled because the key stores a part of the field only.
+ */
+static void
+vy_column_stat_add_key(struct vy_column_stat *stat, uint32_t column_count,
+		       struct key_def *cmp_def, const char *key)
+{
+	uint32_t part_count = mp_decode_array(&key);
+	assert(part_count <= cmp_def->part_count);
+	for (uint32_t i = 0; i < part_count; i++) {
+		struct key_part *part = &cmp_def->parts[i];
+		if (part->fieldno < column_count) {
+			if (part->path != NULL)
+				stat[part->fieldno].is_disabled = true;
+			else
+				vy_column_stat_add(&stat[part->fieldno], key);
+		}
+		mp_next(&key);
+	}
+}
+
+/** Return true if a chunk of a columnar page was read into the page. */
+static inline bool
+vy_page_has_chunk(const struct vy_page *page, uint32_t chunk_no)
+{
+	if (page->data == NULL)
+		return false;
+	return !page->is_partial || chunk_no == 0 ||
+	       column_mask_fieldno_is_set(page->column_mask, chunk_no - 1);
+}
+
+/**
+ * Return true if a chunk of a columnar page needs to be read from
+ * the file to get fields set in @a column_mask.
+ */
+static inline bool
+vy_page_chunk_is_needed(const struct vy_page *page, uint32_t chunk_no,
+			uint64_t column_mask)
+{
+	if (vy_page_has_chunk(page, chunk_no))
+		return false;
+	return chunk_no == 0 ||
+	       column_mask_fieldno_is_set(column_mask, chunk_no - 1);
+}
+
+/** Cursor over values stored in a chunk of a columnar page. */
+struct vy_column_cursor {
+	/** Next value or NULL if the chunk wasn't read. */
+	const char *pos;
+	/** Number of values left. */
+	uint32_t count;
+};
+
+/**
+ * Calculate min/max stats of field chunks of a columnar page given
+ * cursors over its chunks, see struct vy_page_chunk.
+ */
+static int
+vy_page_info_build_column_stat(struct vy_page_info *page,
+			       struct key_def *cmp_def,
+			       const struct vy_column_cursor *cursors)
+{
+	struct region *region = &fiber()->gc;
+	uint32_t column_count = page->chunk_count - 1;
+	if (column_count == 0)
+		return 0;
+	size_t size;
+	struct vy_column_stat *stat = region_alloc_array(
+		region, typeof(stat[0]), column_count, &size);
+	if (stat == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "stat");
+		return -1;
+	}
+	memset(stat, 0, size);
+	for (uint32_t i = 0; i < column_count; i++) {
+		const char *value = cursors[i + 1].pos;
+		for (uint32_t j = 0; j < cursors[i + 1].count; j++) {
+			vy_column_stat_add(&stat[i], value);
+			mp_next(&value);
+		}
+	}
+	/* Primary index DELETE keys are stored in statement headers. */
+	const char *pos = cursors[0].pos;
+	for (uint32_t i = 0; i < cursors[0].count; i++) {
+		struct vy_stmt_columnar_header header;
+		if (vy_stmt_columnar_header_decode(&pos, &header) != 0)
+			return -1;
+		if (header.type == IPROTO_DELETE && header.extra != NULL) {
+			vy_column_stat_add_key(stat, column_count,
+					       cmp_def, header.extra);
+		}
+	}
+	for (uint32_t i = 0; i < column_count; i++) {
+		if (stat[i].min == NULL || stat[i].is_disabled)
+			continue;
+		const char *min_end = stat[i].min;
+		mp_next(&min_end);
+		const char *max_end = stat[i].max;
+		mp_next(&max_end);
+		size_t min_size = min_end - stat[i].min;
+		size_t max_size = max_end - stat[i].max;
+		size = min_size + max_size;
+		struct vy_page_chunk *chunk = &page->chunks[i + 1];
+		chunk->min = malloc(size);
+		if (chunk->min == NULL) {
+			diag_set(OutOfMemory, size, "malloc", "column stat");
+			return -1;
+		}
+		memcpy(chunk->min, stat[i].min, min_size);
+		chunk->max = chunk->min + min_size;
+		memcpy(chunk->max, stat[i].max, max_size);
+	}
+	return 0;
+}
+
+/**
+ * Decode a chunk of a columnar page stored in an xrow.
  *
- * @retval 0 on success
- * @retval -1 on error, check diag
+ * @param xrow        Chunk xrow.
+ * @param chunk_no    Number of the chunk in the page.
+ * @param[out] no     Number of field chunks in the page for the header
+ *                    chunk, number of the field for a field chunk.
+ * @param[out] cursor Cursor over values stored in the chunk.
+ *
+ * @retval  0 Success.
+ * @retval -1 Error.
  */
 static int
-vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
-	     struct vy_run *run, ZSTD_DStream *zdctx)
+vy_page_chunk_decode_xrow(const struct xrow_header *xrow, uint32_t chunk_no,
+			  uint64_t *no, struct vy_column_cursor *cursor)
 {
-	/* read xlog tx from xlog file */
-	size_t region_svp = region_used(&fiber()->gc);
-	char *data = (char *)region_alloc(&fiber()->gc, page_info->size);
+	if (xrow->type != VY_RUN_COLUMN) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 tt_sprintf("Wrong chunk type "
+				    "(expected %d, got %u)",
+				    VY_RUN_COLUMN, (unsigned)xrow->type));
+		return -1;
+	}
+	if (xrow->bodycnt == 0)
+		goto error;
+	const char *pos = xrow->body[0].iov_base;
+	const char *end = pos + xrow->body[0].iov_len;
+	const char *check = pos;
+	if (mp_check(&check, end) != 0 || mp_typeof(*pos) != MP_MAP)
+		goto error;
+	/* Header chunk stores FIELD_COUNT, field chunks store FIELD_NO. */
+	uint32_t no_key = chunk_no == 0 ? VY_COLUMN_FIELD_COUNT :
+					  VY_COLUMN_FIELD_NO;
+	bool no_found = false;
+	cursor->pos = NULL;
+	cursor->count = 0;
+	uint32_t map_size = mp_decode_map(&pos);
+	for (uint32_t i = 0; i < map_size; i++) {
+		if (mp_typeof(*pos) != MP_UINT) {
+			mp_next(&pos);
+			mp_next(&pos);
+			continue;
+		}
+		uint64_t key = mp_decode_uint(&pos);
+		if (key == VY_COLUMN_DATA) {
+			if (mp_typeof(*pos) != MP_ARRAY)
+				goto error;
+			cursor->pos = pos;
+			cursor->count = mp_decode_array(&cursor->pos);
+		} else if (key == no_key) {
+			if (mp_typeof(*pos) != MP_UINT)
+				goto error;
+			*no = mp_decode_uint(&pos);
+			no_found = true;
+			continue;
+		}
+		mp_next(&pos);
+	}
+	if (cursor->pos == NULL || !no_found)
+		goto error;
+	return 0;
+error:
+	diag_set(ClientError, ER_INVALID_RUN_FILE,
+		 tt_sprintf("Can't decode chunk %u of a columnar page",
+			    (unsigned)chunk_no));
+	return -1;
+}
+
+/**
+ * Decode an unpacked chunk of a columnar page.
+ *
+ * @param data        Chunk data.
+ * @param data_end    End of @a data.
+ * @param chunk_no    Number of the chunk in the page.
+ * @param field_count Number of field chunks in the page.
+ * @param[out] cursor Cursor over values stored in the chunk.
+ *
+ * @retval  0 Success.
+ * @retval -1 Error.
+ */
+static int
+vy_page_chunk_decode(const char *data, const char *data_end,
+		     uint32_t chunk_no, uint32_t field_count,
+		     struct vy_column_cursor *cursor)
+{
+	struct xrow_header xrow;
+	if (xrow_decode(&xrow, &data, data_end, true) != 0)
+		return -1;
+	uint64_t no;
+	if (vy_page_chunk_decode_xrow(&xrow, chunk_no, &no, cursor) != 0)
+		return -1;
+	uint64_t expected_no = chunk_no == 0 ? field_count : chunk_no - 1;
+	if (no != expected_no) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 tt_sprintf("Can't decode chunk %u of a columnar page",
+				    (unsigned)chunk_no));
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Read consecutive chunks [@a begin, @a end) of a columnar page with
+ * a single read call and decode them. The chunk data is allocated on
+ * the fiber region.
+ *
+ * @param page_info   Page information.
+ * @param run         Run to read from.
+ * @param begin       First chunk to read.
+ * @param end         End of the chunk range.
+ * @param zdctx       Decompression context.
+ * @param[out] cursors Cursors over the chunks, indexed by chunk number.
+ *
+ * @retval  0 Success.
+ * @retval -1 Error.
+ */
+static int
+vy_page_read_chunks(const struct vy_page_info *page_info, struct vy_run *run,
+		    uint32_t begin, uint32_t end, ZSTD_DStream *zdctx,
+		    struct vy_column_cursor *cursors)
+{
+	struct region *region = &fiber()->gc;
+	const struct vy_page_chunk *first = &page_info->chunks[begin];
+	const struct vy_page_chunk *last = &page_info->chunks[end - 1];
+	size_t size = last->offset + last->size - first->offset;
+	char *data = region_alloc(region, size);
 	if (data == NULL) {
-		diag_set(OutOfMemory, page_info->size, "region gc", "page");
+		diag_set(OutOfMemory, size, "region gc", "page");
 		return -1;
 	}
-	ssize_t readen = fio_pread(run->fd, data, page_info->size,
-				   page_info->offset);
+	ssize_t readen = vy_run_pread(run->fd, data, size, first->offset);
 	ERROR_INJECT(ERRINJ_VYRUN_DATA_READ, {
 		readen = -1;
 		errno = EIO;});
 	if (readen < 0) {
 		diag_set(SystemError, "failed to read from file");
-		goto error;
+		return -1;
 	}
-	if (readen != (ssize_t)page_info->size) {
+	if (readen != (ssize_t)size) {
 		diag_set(ClientError, ER_INVALID_RUN_FILE,
 			 "Unexpected end of file");
+		return -1;
+	}
+	for (uint32_t i = begin; i < end; i++) {
+		const struct vy_page_chunk *chunk = &page_info->chunks[i];
+		const char *src = data + (chunk->offset - first->offset);
+		char *rows = region_alloc(region, chunk->unpacked_size);
+		if (rows == NULL) {
+			diag_set(OutOfMemory, chunk->unpacked_size,
+				 "region gc", "page chunk");
+			return -1;
+		}
+		if (xlog_tx_decode(src, src + chunk->size, rows,
+				   rows + chunk->unpacked_size, zdctx) != 0)
+			return -1;
+		if (vy_page_chunk_decode(rows, rows + chunk->unpacked_size, i,
+					 page_info->chunk_count - 1,
+					 &cursors[i]) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * Materialize statements of a columnar page in the page data from
+ * chunks decoded into @a cursors. Statements are stored as a header
+ * (see struct vy_stmt_columnar_header) followed by a MsgPack array of
+ * fields so that they can be decoded with vy_page_stmt().
+ *
+ * Chunks that weren't read have cursors with NULL position. If the page
+ * is partial, their values are taken from the page data, otherwise they
+ * are replaced with nulls.
+ *
+ * @param page        Page to fill.
+ * @param page_info   Page information.
+ * @param column_mask Fields read into @a cursors.
+ * @param cursors     Cursors over the page chunks.
+ *
+ * @retval  0 Success.
+ * @retval -1 Error.
+ */
+static int
+vy_page_fill_columnar(struct vy_page *page,
+		      const struct vy_page_info *page_info,
+		      uint64_t column_mask, struct vy_column_cursor *cursors)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t chunk_count = page_info->chunk_count;
+	uint32_t field_count = chunk_count - 1;
+	/* Statements materialized by a previous read of the page. */
+	const char *old_data = page->is_partial ? page->data : NULL;
+	char *data = NULL;
+	size_t size;
+	uint32_t *row_index = region_alloc_array(
+		region, typeof(row_index[0]), page->row_count, &size);
+	if (row_index == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "row_index");
+		return -1;
+	}
+	/* Estimate the size of the materialized page. */
+	size = (size_t)page->row_count * mp_sizeof_array(UINT32_MAX);
+	if (old_data != NULL)
+		size += page->unpacked_size;
+	uint32_t missing_count = 0;
+	for (uint32_t i = 0; i < chunk_count; i++) {
+		if (cursors[i].pos != NULL)
+			size += page_info->chunks[i].unpacked_size;
+		else if (!vy_page_has_chunk(page, i))
+			missing_count++;
+	}
+	size += (size_t)page->row_count * missing_count * mp_sizeof_nil();
+
+	if (old_data == NULL && cursors[0].count != page->row_count)
+		goto invalid;
+	data = malloc(size);
+	if (data == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "page->data");
 		goto error;
 	}
+	char *wpos = data;
+	const char *headers = cursors[0].pos;
+	for (uint32_t i = 0; i < page->row_count; i++) {
+		const char *header_begin = old_data != NULL ?
+					   old_data + page->row_index[i] :
+					   headers;
+		const char *pos = header_begin;
+		struct vy_stmt_columnar_header header;
+		if (vy_stmt_columnar_header_decode(&pos, &header) != 0)
+			goto error;
+		if (header.field_count > field_count)
+			goto invalid;
+		row_index[i] = wpos - data;
+		memcpy(wpos, header_begin, pos - header_begin);
+		wpos += pos - header_begin;
+		wpos = mp_encode_array(wpos, header.field_count);
+		if (old_data != NULL) {
+			/* Skip the array header of the old statement. */
+			mp_decode_array(&pos);
+		} else {
+			headers = pos;
+		}
+		for (uint32_t j = 0; j < header.field_count; j++) {
+			const char *value = NULL;
+			if (old_data != NULL) {
+				value = pos;
+				mp_next(&pos);
+			}
+			struct vy_column_cursor *cursor = &cursors[j + 1];
+			if (cursor->pos != NULL) {
+				if (cursor->count == 0)
+					goto invalid;
+				value = cursor->pos;
+				mp_next(&cursor->pos);
+				cursor->count--;
+				memcpy(wpos, value, cursor->pos - value);
+				wpos += cursor->pos - value;
+			} else if (value != NULL) {
+				memcpy(wpos, value, pos - value);
+				wpos += pos - value;
+			} else {
+				wpos = mp_encode_nil(wpos);
+			}
+		}
+	}
+	for (uint32_t i = 1; i < chunk_count; i++) {
+		if (cursors[i].count != 0)
+			goto invalid;
+	}
+	assert(wpos <= data + size);
+	memcpy(page->row_index, row_index,
+	       page->row_count * sizeof(*row_index));
+	free(page->data);
+	page->data = data;
+	page->unpacked_size = wpos - data;
+	page->is_columnar = true;
+	page->column_mask = old_data != NULL ?
+			    page->column_mask | column_mask : column_mask;
+	page->is_partial = missing_count > 0;
+	region_truncate(region, region_svp);
+	return 0;
+invalid:
+	diag_set(ClientError, ER_INVALID_RUN_FILE,
+		 "Inconsistent chunks of a columnar page");
+error:
+	free(data);
+	region_truncate(region, region_svp);
+	return -1;
+}
+
+/**
+ * Read a page of a columnar run.
+ *
+ * Only the header chunk and chunks of fields set in @a column_mask are
+ * read, see vy_page_fill_columnar(). If the page is partial, i.e. some
+ * fields were read before, only chunks that are missing in the page are
+ * read.
+ *
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+static int
+vy_page_read_columnar(struct vy_page *page,
+		      const struct vy_page_info *page_info,
+		      struct vy_run *run, uint64_t column_mask,
+		      ZSTD_DStream *zdctx)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t chunk_count = page_info->chunk_count;
+	size_t size;
+	struct vy_column_cursor *cursors = region_alloc_array(
+		region, typeof(cursors[0]), chunk_count, &size);
+	if (cursors == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "cursors");
+		goto error;
+	}
+	/* Read the needed chunks, coalescing adjacent ones. */
+	uint32_t begin = 0;
+	while (begin < chunk_count) {
+		if (!vy_page_chunk_is_needed(page, begin, column_mask)) {
+			cursors[begin].pos = NULL;
+			cursors[begin].count = 0;
+			begin++;
+			continue;
+		}
+		uint32_t end = begin + 1;
+		while (end < chunk_count &&
+		       vy_page_chunk_is_needed(page, end, column_mask) &&
+		       page_info->chunks[end].offset ==
+		       page_info->chunks[end - 1].offset +
+		       page_info->chunks[end - 1].size)
+			end++;
+		if (vy_page_read_chunks(page_info, run, begin, end, zdctx,
+					cursors) != 0)
+			goto error;
+		begin = end;
+	}
 
 	struct errinj *inj = errinj(ERRINJ_VY_READ_PAGE_TIMEOUT, ERRINJ_DOUBLE);
 	if (inj != NULL && inj->dparam > 0)
@@ -952,27 +1823,100 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
 
 	ERROR_INJECT_SLEEP(ERRINJ_VY_READ_PAGE_DELAY);
 
+	if (vy_page_fill_columnar(page, page_info, column_mask, cursors) != 0)
+		goto error;
+	region_truncate(region, region_svp);
+	ERROR_INJECT(ERRINJ_VY_READ_PAGE, {
+		diag_set(ClientError, ER_INJECTION, "vinyl page read");
+		return -1;});
+	return 0;
+error:
+	region_truncate(region, region_svp);
+	diag_log();
+	say_error("error reading %s@%llu:%u", vy_run_filename(run),
+		  (unsigned long long)page_info->offset,
+		  (unsigned)page_info->size);
+	return -1;
+}
+
+/* }}} Columnar pages */
+
+/**
+ * Decode a page of a row run given its data read from the file.
+ *
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+static int
+vy_page_decode(struct vy_page *page, const struct vy_page_info *page_info,
+	       const char *data, ZSTD_DStream *zdctx)
+{
+	struct errinj *inj = errinj(ERRINJ_VY_READ_PAGE_TIMEOUT, ERRINJ_DOUBLE);
+	if (inj != NULL && inj->dparam > 0)
+		thread_sleep(inj->dparam);
+
+	ERROR_INJECT_SLEEP(ERRINJ_VY_READ_PAGE_DELAY);
+
 	/* decode xlog tx */
-	const char *data_pos = data;
-	const char *data_end = data + readen;
+	const char *data_end = data + page_info->size;
 	char *rows = page->data;
 	char *rows_end = rows + page_info->unpacked_size;
 	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx) != 0)
-		goto error;
+		return -1;
 
 	struct xrow_header xrow;
-	data_pos = page->data + page_info->row_index_offset;
+	const char *data_pos = page->data + page_info->row_index_offset;
 	data_end = page->data + page_info->unpacked_size;
 	if (xrow_decode(&xrow, &data_pos, data_end, true) == -1)
-		goto error;
+		return -1;
 	if (xrow.type != VY_RUN_ROW_INDEX) {
 		diag_set(ClientError, ER_INVALID_RUN_FILE,
 			 tt_sprintf("Wrong row index type "
 				    "(expected %d, got %u)",
 				    VY_RUN_ROW_INDEX, (unsigned)xrow.type));
+		return -1;
+	}
+	return vy_row_index_decode(page->row_index, page->row_count, &xrow);
+}
+
+/**
+ * Read a page requests from vinyl xlog data file.
+ * @a column_mask is used only for columnar pages, see
+ * vy_page_read_columnar().
+ *
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+static int
+vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
+	     struct vy_run *run, uint64_t column_mask, ZSTD_DStream *zdctx)
+{
+	if (page_info->chunks != NULL) {
+		return vy_page_read_columnar(page, page_info, run,
+					     column_mask, zdctx);
+	}
+	/* read xlog tx from xlog file */
+	size_t region_svp = region_used(&fiber()->gc);
+	char *data = (char *)region_alloc(&fiber()->gc, page_info->size);
+	if (data == NULL) {
+		diag_set(OutOfMemory, page_info->size, "region gc", "page");
+		return -1;
+	}
+	ssize_t readen = vy_run_pread(run->fd, data, page_info->size,
+				   page_info->offset);
+	ERROR_INJECT(ERRINJ_VYRUN_DATA_READ, {
+		readen = -1;
+		errno = EIO;});
+	if (readen < 0) {
+		diag_set(SystemError, "failed to read from file");
 		goto error;
 	}
-	if (vy_row_index_decode(page->row_index, page->row_count, &xrow) != 0)
+	if (readen != (ssize_t)page_info->size) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 "Unexpected end of file");
+		goto error;
+	}
+	if (vy_page_decode(page, page_info, data, zdctx) != 0)
 		goto error;
 	region_truncate(&fiber()->gc, region_svp);
 	ERROR_INJECT(ERRINJ_VY_READ_PAGE, {
@@ -989,47 +1933,436 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
 }
 
 /**
- * Get thread local zstd decompression context
+ * Get thread local zstd decompression context
+ */
+static ZSTD_DStream *
+vy_env_get_zdctx(struct vy_run_env *env)
+{
+	ZSTD_DStream *zdctx = tt_pthread_getspecific(env->zdctx_key);
+	if (zdctx == NULL) {
+		zdctx = ZSTD_createDStream();
+		if (zdctx == NULL) {
+			diag_set(OutOfMemory, sizeof(zdctx), "malloc",
+				 "zstd context");
+			return NULL;
+		}
+		tt_pthread_setspecific(env->zdctx_key, zdctx);
+	}
+	return zdctx;
+}
+
+/**
+ * vinyl read task callback
+ */
+static int
+vy_page_read_cb(struct cbus_call_msg *base)
+{
+	struct vy_page_read_task *task = (struct vy_page_read_task *)base;
+	ZSTD_DStream *zdctx = vy_env_get_zdctx(task->run->env);
+	if (zdctx == NULL)
+		return -1;
+	if (vy_page_read(task->page, task->page_info, task->run,
+			 task->column_mask, zdctx) != 0)
+		return -1;
+	if (task->key.stmt != NULL &&
+	    vy_page_find_key(task->page, task->key, task->cmp_def,
+			     task->format, task->iterator_type,
+			     &task->pos_in_page, &task->equal_found) != 0)
+		return -1;
+	if (task->page->is_partial && task->equal_found) {
+		/*
+		 * The key is in the page, read the rest of fields.
+		 * Chunks that have already been read are reused.
+		 */
+		if (vy_page_read(task->page, task->page_info, task->run,
+				 COLUMN_MASK_FULL, zdctx) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/* {{{ Readahead */
+
+/**
+ * Cbus task that reads a few pages of a run ahead of a run iterator
+ * that scans the run. The task is posted to a reader thread without
+ * waiting for completion. The iterator may be closed before the task
+ * completes, in which case the task is freed on completion.
+ */
+struct vy_readahead {
+	/** parent */
+	struct cbus_call_msg base;
+	/** Run to read pages from - ref. counted. */
+	struct vy_run *run;
+	/** Number of the first page to read. */
+	uint32_t first_page_no;
+	/** Number of pages to read. */
+	uint32_t page_count;
+	/** Set when the reader thread is done with the task. */
+	bool is_complete;
+	/** Set if the pages aren't needed by the iterator anymore. */
+	bool is_detached;
+	/** Signaled when the task is complete. */
+	struct fiber_cond complete_cond;
+	/** Link in vy_run_env::readahead_tasks while in flight. */
+	struct rlist in_env;
+	/**
+	 * Pages, page_count elements. A page is set to NULL when
+	 * the iterator takes it.
+	 */
+	struct vy_page *pages[0];
+};
+
+static bool
+vy_readahead_has_page(struct vy_readahead *ra, uint32_t page_no)
+{
+	return page_no >= ra->first_page_no &&
+	       page_no < ra->first_page_no + ra->page_count;
+}
+
+static struct vy_readahead *
+vy_readahead_new(struct vy_run *run, uint32_t first_page_no,
+		 uint32_t page_count)
+{
+	size_t size = sizeof(struct vy_readahead) +
+		      page_count * sizeof(struct vy_page *);
+	struct vy_readahead *ra = calloc(1, size);
+	if (ra == NULL) {
+		diag_set(OutOfMemory, size, "calloc", "vy_readahead");
+		return NULL;
+	}
+	for (uint32_t i = 0; i < page_count; i++) {
+		struct vy_page_info *page_info =
+			vy_run_page_info(run, first_page_no + i);
+		ra->pages[i] = vy_page_new(page_info);
+		if (ra->pages[i] == NULL)
+			goto fail;
+		ra->pages[i]->run_id = run->id;
+		ra->pages[i]->page_no = first_page_no + i;
+	}
+	ra->run = run;
+	vy_run_ref(run);
+	ra->first_page_no = first_page_no;
+	ra->page_count = page_count;
+	fiber_cond_create(&ra->complete_cond);
+	return ra;
+fail:
+	for (uint32_t i = 0; i < page_count && ra->pages[i] != NULL; i++)
+		vy_page_unref(ra->pages[i]);
+	free(ra);
+	return NULL;
+}
+
+static void
+vy_readahead_delete(struct vy_readahead *ra)
+{
+	assert(ra->is_complete);
+	for (uint32_t i = 0; i < ra->page_count; i++) {
+		if (ra->pages[i] != NULL)
+			vy_page_unref(ra->pages[i]);
+	}
+	diag_destroy(&ra->base.diag);
+	fiber_cond_destroy(&ra->complete_cond);
+	vy_run_unref(ra->run);
+	free(ra);
+}
+
+/**
+ * Release a readahead task that isn't needed by the iterator anymore.
+ * If the task is still in progress, it'll be freed on completion.
+ */
+static void
+vy_readahead_release(struct vy_readahead *ra)
+{
+	if (ra->is_complete)
+		vy_readahead_delete(ra);
+	else
+		ra->is_detached = true;
+}
+
+/**
+ * Read pages of a readahead task in a reader thread. Pages stored
+ * in the file one after another are read with a single call.
+ */
+static int
+vy_readahead_cb(struct cbus_call_msg *base)
+{
+	struct vy_readahead *ra = (struct vy_readahead *)base;
+	struct vy_run *run = ra->run;
+	struct region *region = &fiber()->gc;
+	ZSTD_DStream *zdctx = vy_env_get_zdctx(run->env);
+	if (zdctx == NULL)
+		return -1;
+	uint32_t begin = 0;
+	while (begin < ra->page_count) {
+		const struct vy_page_info *first =
+			vy_run_page_info(run, ra->first_page_no + begin);
+		if (first->chunks != NULL) {
+			if (vy_page_read(ra->pages[begin], first, run,
+					 COLUMN_MASK_FULL, zdctx) != 0)
+				return -1;
+			begin++;
+			continue;
+		}
+		const struct vy_page_info *last = first;
+		uint32_t end = begin + 1;
+		while (end < ra->page_count) {
+			const struct vy_page_info *next =
+				vy_run_page_info(run, ra->first_page_no + end);
+			if (next->chunks != NULL ||
+			    next->offset != last->offset + last->size)
+				break;
+			last = next;
+			end++;
+		}
+		size_t region_svp = region_used(region);
+		size_t size = last->offset + last->size - first->offset;
+		char *data = region_alloc(region, size);
+		if (data == NULL) {
+			diag_set(OutOfMemory, size, "region gc", "pages");
+			return -1;
+		}
+		ssize_t readen = vy_run_pread(run->fd, data, size, first->offset);
+		ERROR_INJECT(ERRINJ_VYRUN_DATA_READ, {
+			readen = -1;
+			errno = EIO;});
+		if (readen < 0) {
+			diag_set(SystemError, "failed to read from file");
+			goto error;
+		}
+		if (readen != (ssize_t)size) {
+			diag_set(ClientError, ER_INVALID_RUN_FILE,
+				 "Unexpected end of file");
+			goto error;
+		}
+		for (uint32_t i = begin; i < end; i++) {
+			const struct vy_page_info *page_info =
+				vy_run_page_info(run, ra->first_page_no + i);
+			if (vy_page_decode(ra->pages[i], page_info,
+					   data + page_info->offset -
+					   first->offset, zdctx) != 0)
+				goto error;
+		}
+		region_truncate(region, region_svp);
+		ERROR_INJECT(ERRINJ_VY_READ_PAGE, {
+			diag_set(ClientError, ER_INJECTION, "vinyl page read");
+			return -1;});
+		begin = end;
+		continue;
+error:
+		region_truncate(region, region_svp);
+		return -1;
+	}
+	return 0;
+}
+
+/** Called in tx when a readahead task is complete. */
+static int
+vy_readahead_complete_cb(struct cbus_call_msg *base)
+{
+	struct vy_readahead *ra = (struct vy_readahead *)base;
+	struct vy_run_env *env = ra->run->env;
+	rlist_del_entry(ra, in_env);
+	if (rlist_empty(&env->readahead_tasks))
+		fiber_cond_broadcast(&env->readahead_cond);
+	ra->is_complete = true;
+	if (ra->is_detached)
+		vy_readahead_delete(ra);
+	else
+		fiber_cond_broadcast(&ra->complete_cond);
+	return 0;
+}
+
+void
+vy_run_env_set_readahead(struct vy_run_env *env, uint32_t page_count)
+{
+	env->readahead = page_count;
+}
+
+void
+vy_run_env_shutdown(struct vy_run_env *env)
+{
+	env->readahead = 0;
+	while (!rlist_empty(&env->readahead_tasks))
+		fiber_cond_wait(&env->readahead_cond);
+}
+
+/**
+ * Free readahead tasks that were never completed in tx. Called
+ * after the reader threads are stopped so no task is in progress.
+ * Tasks still owned by iterators are freed when released.
+ */
+static void
+vy_run_env_free_readahead(struct vy_run_env *env)
+{
+	struct vy_readahead *ra, *tmp;
+	rlist_foreach_entry_safe(ra, &env->readahead_tasks, in_env, tmp) {
+		rlist_del_entry(ra, in_env);
+		ra->is_complete = true;
+		if (ra->is_detached)
+			vy_readahead_delete(ra);
+	}
+}
+
+/* }}} Readahead */
+
+/**
+ * Remember a page in the iterator. The iterator keeps references
+ * to two most recently used pages.
+ */
+static void
+vy_run_iterator_cache_page(struct vy_run_iterator *itr, struct vy_page *page)
+{
+	if (itr->prev_page != NULL)
+		vy_page_unref(itr->prev_page);
+	itr->prev_page = itr->curr_page;
+	itr->curr_page = page;
+}
+
+/**
+ * Release pages read ahead by the iterator and reset scan detection.
  */
-static ZSTD_DStream *
-vy_env_get_zdctx(struct vy_run_env *env)
+static void
+vy_run_iterator_stop_readahead(struct vy_run_iterator *itr)
 {
-	ZSTD_DStream *zdctx = tt_pthread_getspecific(env->zdctx_key);
-	if (zdctx == NULL) {
-		zdctx = ZSTD_createDStream();
-		if (zdctx == NULL) {
-			diag_set(OutOfMemory, sizeof(zdctx), "malloc",
-				 "zstd context");
-			return NULL;
-		}
-		tt_pthread_setspecific(env->zdctx_key, zdctx);
-	}
-	return zdctx;
+	if (itr->readahead != NULL)
+		vy_readahead_release(itr->readahead);
+	if (itr->readahead_next != NULL)
+		vy_readahead_release(itr->readahead_next);
+	itr->readahead = itr->readahead_next = NULL;
+	itr->scan_page_no = -1;
+	itr->scan_page_count = 0;
+	itr->readahead_size = 0;
 }
 
 /**
- * vinyl read task callback
+ * Take a page read ahead by the iterator. If the page is still being
+ * read, wait for the read to complete. If the page wasn't read ahead
+ * or the read failed, @result is set to NULL and the caller is supposed
+ * to read the page synchronously.
+ *
+ * @retval 0 success
+ * @retval -1 the fiber was cancelled while waiting
  */
-static int
-vy_page_read_cb(struct cbus_call_msg *base)
+static NODISCARD int
+vy_run_iterator_take_readahead(struct vy_run_iterator *itr, uint32_t page_no,
+			       struct vy_page **result)
 {
-	struct vy_page_read_task *task = (struct vy_page_read_task *)base;
-	ZSTD_DStream *zdctx = vy_env_get_zdctx(task->run->env);
-	if (zdctx == NULL)
-		return -1;
-	if (vy_page_read(task->page, task->page_info, task->run, zdctx) != 0)
-		return -1;
-	if (task->key.stmt != NULL &&
-	    vy_page_find_key(task->page, task->key, task->cmp_def,
-			     task->format, task->iterator_type,
-			     &task->pos_in_page, &task->equal_found) != 0)
-		return -1;
+	*result = NULL;
+	struct vy_readahead *ra = itr->readahead;
+	if (ra == NULL)
+		return 0;
+	if (!vy_readahead_has_page(ra, page_no)) {
+		ra = itr->readahead_next;
+		if (ra == NULL || !vy_readahead_has_page(ra, page_no))
+			return 0;
+		/* The scan has moved on to the next batch. */
+		vy_readahead_release(itr->readahead);
+		itr->readahead = ra;
+		itr->readahead_next = NULL;
+	}
+	if (!ra->is_complete) {
+		itr->stat->readahead_wait++;
+		do {
+			if (fiber_cond_wait(&ra->complete_cond) != 0)
+				return -1;
+		} while (!ra->is_complete);
+	}
+	if (ra->base.rc != 0) {
+		/* The error will be reported by the synchronous read. */
+		vy_run_iterator_stop_readahead(itr);
+		return 0;
+	}
+	uint32_t i = page_no - ra->first_page_no;
+	*result = ra->pages[i];
+	ra->pages[i] = NULL;
+	if (*result != NULL)
+		itr->stat->readahead_hit++;
 	return 0;
 }
 
+/**
+ * Account a page read from disk for scan detection and, if the
+ * iterator reads consecutive pages, start reading the following
+ * pages in the background. The number of pages read ahead starts
+ * from two and doubles with each batch up to the configured limit.
+ * Readahead is best effort so errors are silently ignored.
+ */
+static void
+vy_run_iterator_readahead(struct vy_run_iterator *itr, uint32_t page_no)
+{
+	struct vy_slice *slice = itr->slice;
+	struct vy_run_env *env = slice->run->env;
+	int dir = iterator_direction(itr->iterator_type);
+	if (itr->scan_page_no != page_no) {
+		/* The iterator jumped, drop pages read ahead. */
+		if (itr->readahead != NULL &&
+		    !vy_readahead_has_page(itr->readahead, page_no))
+			vy_run_iterator_stop_readahead(itr);
+		itr->scan_page_count = 0;
+		itr->readahead_size = 0;
+	}
+	itr->scan_page_count++;
+	itr->scan_page_no = (int64_t)page_no + dir;
+
+	struct vy_readahead *ra = itr->readahead;
+	if (env->readahead == 0 || env->reader_pool == NULL ||
+	    itr->scan_page_count < 2 || itr->readahead_next != NULL)
+		return;
+
+	/* Start the next batch where the current one ends. */
+	int64_t first = (int64_t)page_no + dir;
+	if (ra != NULL) {
+		first = dir > 0 ? ra->first_page_no + ra->page_count :
+				  (int64_t)ra->first_page_no - 1;
+	}
+	uint32_t size = itr->readahead_size == 0 ? 2 :
+			itr->readahead_size * 2;
+	size = MIN(size, env->readahead);
+	int64_t last = first + (int64_t)dir * (size - 1);
+	last = MAX(last, (int64_t)slice->first_page_no);
+	last = MIN(last, (int64_t)slice->last_page_no);
+	if (first < (int64_t)slice->first_page_no ||
+	    first > (int64_t)slice->last_page_no)
+		return;
+	if (dir < 0)
+		SWAP(first, last);
+	uint32_t page_count = last - first + 1;
+
+	struct vy_readahead *next = vy_readahead_new(slice->run, first,
+						     page_count);
+	if (next == NULL) {
+		diag_clear(diag_get());
+		return;
+	}
+	itr->readahead_size = size;
+	if (ra == NULL)
+		itr->readahead = next;
+	else
+		itr->readahead_next = next;
+
+	/* Update read statistics. */
+	itr->stat->readahead_pages += page_count;
+	for (uint32_t i = 0; i < page_count; i++) {
+		const struct vy_page_info *page_info =
+			vy_run_page_info(slice->run, first + i);
+		itr->stat->read.rows += page_info->row_count;
+		itr->stat->read.bytes += page_info->unpacked_size;
+		itr->stat->read.bytes_compressed += page_info->size;
+		itr->stat->read.pages++;
+	}
+
+	struct vy_run_reader *reader = vy_run_env_next_reader(env);
+	rlist_add_tail_entry(&env->readahead_tasks, next, in_env);
+	cbus_call_async(&reader->reader_pipe, &reader->tx_pipe, &next->base,
+			vy_readahead_cb, vy_readahead_complete_cb);
+}
+
 /**
  * Read a page from disk given its number.
- * The function caches two most recently read pages.
+ * The function caches two most recently read pages. Besides,
+ * complete pages are stored in the page cache shared by all
+ * iterators.
  *
  * @retval 0 success
  * @retval -1 critical error
@@ -1045,15 +2378,43 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 
 	/* Check cache */
 	struct vy_page *page = NULL;
-	if (itr->curr_page != NULL &&
+	if (itr->curr_page != NULL && !itr->curr_page->is_partial &&
 	    itr->curr_page->page_no == page_no) {
 		page = itr->curr_page;
-	} else if (itr->prev_page != NULL &&
+	} else if (itr->prev_page != NULL && !itr->prev_page->is_partial &&
 		   itr->prev_page->page_no == page_no) {
 		SWAP(itr->prev_page, itr->curr_page);
 		page = itr->curr_page;
 	}
+	struct vy_page_cache *page_cache = &env->page_cache;
+	if (page == NULL && page_cache->quota > 0) {
+		page = vy_page_cache_get(page_cache, slice->run->id, page_no);
+		if (page != NULL) {
+			vy_page_ref(page);
+			vy_run_iterator_cache_page(itr, page);
+			itr->stat->page_cache_hit++;
+		} else {
+			itr->stat->page_cache_miss++;
+		}
+	}
+	if (page != NULL) {
+		if (key.stmt != NULL &&
+		    vy_page_find_key(page, key, itr->cmp_def,
+				     itr->format, iterator_type,
+				     pos_in_page, equal_found) != 0)
+			return -1;
+		*result = page;
+		return 0;
+	}
+
+	/* Check pages read ahead */
+	if (vy_run_iterator_take_readahead(itr, page_no, &page) != 0)
+		return -1;
 	if (page != NULL) {
+		vy_run_iterator_cache_page(itr, page);
+		if (page_cache->quota > 0)
+			vy_page_cache_put(page_cache, page);
+		vy_run_iterator_readahead(itr, page_no);
 		if (key.stmt != NULL &&
 		    vy_page_find_key(page, key, itr->cmp_def,
 				     itr->format, iterator_type,
@@ -1074,7 +2435,7 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	if (task == NULL) {
 		diag_set(OutOfMemory, sizeof(*task),
 			 "mempool", "vy_page_read_task");
-		vy_page_delete(page);
+		vy_page_unref(page);
 		return -1;
 	}
 	task->run = slice->run;
@@ -1084,6 +2445,16 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	task->iterator_type = iterator_type;
 	task->cmp_def = itr->cmp_def;
 	task->format = itr->format;
+	task->column_mask = COLUMN_MASK_FULL;
+	if (key.stmt != NULL && iterator_type == ITER_EQ &&
+	    !vy_stmt_is_key_format(itr->format)) {
+		/*
+		 * An EQ lookup in a primary index is likely to miss the
+		 * page so first read only key fields to look up the key.
+		 * A secondary index stores only key fields anyway.
+		 */
+		task->column_mask = itr->cmp_def->column_mask;
+	}
 	task->pos_in_page = 0;
 	task->equal_found = false;
 
@@ -1094,23 +2465,36 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 
 	mempool_free(&env->read_task_pool, task);
 	if (rc != 0) {
-		vy_page_delete(page);
+		vy_page_unref(page);
 		return -1;
 	}
 
 	/* Update cache */
-	if (itr->prev_page != NULL)
-		vy_page_delete(itr->prev_page);
-	itr->prev_page = itr->curr_page;
-	itr->curr_page = page;
+	page->run_id = slice->run->id;
 	page->page_no = page_no;
+	vy_run_iterator_cache_page(itr, page);
+	if (!page->is_partial && page_cache->quota > 0)
+		vy_page_cache_put(page_cache, page);
 
 	/* Update read statistics. */
 	itr->stat->read.rows += page_info->row_count;
-	itr->stat->read.bytes += page_info->unpacked_size;
-	itr->stat->read.bytes_compressed += page_info->size;
+	if (page->is_partial) {
+		for (uint32_t i = 0; i < page_info->chunk_count; i++) {
+			const struct vy_page_chunk *chunk =
+				&page_info->chunks[i];
+			if (!vy_page_has_chunk(page, i))
+				continue;
+			itr->stat->read.bytes += chunk->unpacked_size;
+			itr->stat->read.bytes_compressed += chunk->size;
+		}
+	} else {
+		itr->stat->read.bytes += page_info->unpacked_size;
+		itr->stat->read.bytes_compressed += page_info->size;
+	}
 	itr->stat->read.pages++;
 
+	vy_run_iterator_readahead(itr, page_no);
+
 	*result = page;
 	return 0;
 }
@@ -1142,6 +2526,93 @@ vy_run_iterator_read(struct vy_run_iterator *itr,
 	return 0;
 }
 
+/**
+ * Get the field chunk of a columnar page that stores the first key
+ * part and the value of the first key part of @a key to compare them
+ * by min/max stats. Returns false if the stats can't be used.
+ */
+static bool
+vy_run_iterator_page_stat(struct vy_run_iterator *itr,
+			  const struct vy_page_info *page_info,
+			  struct vy_entry key,
+			  const struct vy_page_chunk **chunk,
+			  const char **value)
+{
+	if (page_info->chunks == NULL)
+		return false;
+	struct key_part *part = &itr->cmp_def->parts[0];
+	if (part->coll != NULL || part->sort_order == SORT_ORDER_DESC)
+		return false;
+	/*
+	 * Statements of a secondary index store key parts only while
+	 * a primary index stores whole tuples.
+	 */
+	uint32_t fieldno = 0;
+	if (!vy_stmt_is_key_format(itr->format)) {
+		if (part->path != NULL)
+			return false;
+		fieldno = part->fieldno;
+	}
+	if (fieldno + 1 >= page_info->chunk_count)
+		return false;
+	*chunk = &page_info->chunks[fieldno + 1];
+	if ((*chunk)->max == NULL)
+		return false;
+	if (vy_stmt_is_key(key.stmt)) {
+		if (vy_stmt_is_empty_key(key.stmt))
+			return false;
+		*value = tuple_data(key.stmt);
+		mp_decode_array(value);
+	} else {
+		*value = tuple_field_by_part(key.stmt, part,
+					     vy_entry_multikey_idx(key,
+							itr->cmp_def));
+	}
+	return *value != NULL && vy_column_value_has_stat(*value);
+}
+
+/**
+ * Check if the given key is greater than all statements stored in
+ * a columnar page judging by min/max stats of the field chunk that
+ * stores the first key part. Used to skip pages that can't contain
+ * the key without reading them.
+ */
+static bool
+vy_run_iterator_key_is_after_page(struct vy_run_iterator *itr,
+				  const struct vy_page_info *page_info,
+				  struct vy_entry key)
+{
+	const struct vy_page_chunk *chunk;
+	const char *value;
+	if (!vy_run_iterator_page_stat(itr, page_info, key, &chunk, &value))
+		return false;
+	return tuple_compare_field(value, chunk->max, FIELD_TYPE_SCALAR,
+				   NULL) > 0;
+}
+
+/**
+ * Check if an EQ iterator that has just moved to the beginning of
+ * a page is done, because the first key part of the search key is
+ * less than its min value stored in the page. Used to stop a scan
+ * without reading the page.
+ */
+static bool
+vy_run_iterator_eq_is_done(struct vy_run_iterator *itr,
+			   struct vy_run_iterator_pos pos)
+{
+	if (itr->iterator_type != ITER_EQ || pos.pos_in_page != 0)
+		return false;
+	const struct vy_page_info *page_info =
+		vy_run_page_info(itr->slice->run, pos.page_no);
+	const struct vy_page_chunk *chunk;
+	const char *value;
+	if (!vy_run_iterator_page_stat(itr, page_info, itr->key,
+				       &chunk, &value))
+		return false;
+	return tuple_compare_field(value, chunk->min, FIELD_TYPE_SCALAR,
+				   NULL) < 0;
+}
+
 /**
  * Binary search in a run for the given key.
  * In terms of STL, makes lower_bound for EQ,GE,LT and upper_bound for GT,LE
@@ -1163,6 +2634,13 @@ vy_run_iterator_search(struct vy_run_iterator *itr,
 					       equal_key);
 	if (pos->page_no == itr->slice->run->info.page_count)
 		return 1;
+	if (vy_run_iterator_key_is_after_page(itr,
+			vy_run_page_info(itr->slice->run, pos->page_no), key)) {
+		pos->page_no++;
+		pos->pos_in_page = 0;
+		*equal_key = false;
+		return 0;
+	}
 	bool equal_in_page;
 	struct vy_page *page;
 	int rc = vy_run_iterator_load_page(itr, pos->page_no, key,
@@ -1248,7 +2726,8 @@ vy_run_iterator_find_lsn(struct vy_run_iterator *itr, struct vy_entry *ret)
 	while (vy_stmt_lsn(itr->curr.stmt) > (**itr->read_view).vlsn ||
 	       vy_stmt_flags(itr->curr.stmt) & VY_STMT_SKIP_READ) {
 		if (vy_run_iterator_next_pos(itr, itr->iterator_type,
-					     &itr->curr_pos) != 0) {
+					     &itr->curr_pos) != 0 ||
+		    vy_run_iterator_eq_is_done(itr, itr->curr_pos)) {
 			vy_run_iterator_stop(itr);
 			return 0;
 		}
@@ -1517,6 +2996,12 @@ vy_run_iterator_open(struct vy_run_iterator *itr,
 	itr->prev_page = NULL;
 	itr->search_started = false;
 
+	itr->scan_page_no = -1;
+	itr->scan_page_count = 0;
+	itr->readahead_size = 0;
+	itr->readahead = NULL;
+	itr->readahead_next = NULL;
+
 	/*
 	 * Make sure the format we use to create tuples won't
 	 * go away if DDL is called while the iterator is used.
@@ -1552,7 +3037,8 @@ vy_run_iterator_next_key(struct vy_run_iterator *itr, struct vy_entry *ret)
 		if (next.stmt != NULL)
 			tuple_unref(next.stmt);
 		if (vy_run_iterator_next_pos(itr, itr->iterator_type,
-					     &itr->curr_pos) != 0) {
+					     &itr->curr_pos) != 0 ||
+		    vy_run_iterator_eq_is_done(itr, itr->curr_pos)) {
 			vy_run_iterator_stop(itr);
 			return 0;
 		}
@@ -1720,6 +3206,15 @@ vy_run_acct_page(struct vy_run *run, struct vy_page_info *page)
 	mp_next(&min_key_end);
 	run->page_index_size += sizeof(struct vy_page_info);
 	run->page_index_size += min_key_end - page->min_key;
+	run->page_index_size += page->chunk_count * sizeof(*page->chunks);
+	for (uint32_t i = 0; i < page->chunk_count; i++) {
+		struct vy_page_chunk *chunk = &page->chunks[i];
+		if (chunk->min == NULL)
+			continue;
+		const char *max_end = chunk->max;
+		mp_next(&max_end);
+		run->page_index_size += max_end - chunk->min;
+	}
 	run->count.rows += page->row_count;
 	run->count.bytes += page->unpacked_size;
 	run->count.bytes_compressed += page->size;
@@ -1932,6 +3427,50 @@ vy_run_alloc_page_info(struct vy_run *run, uint32_t *page_info_capacity)
 
 /** {{{ vy_page_info */
 
+/** Return the size of encoded chunks of a columnar page. */
+static size_t
+vy_page_info_sizeof_chunks(const struct vy_page_info *page_info)
+{
+	size_t size = mp_sizeof_array(page_info->chunk_count);
+	for (uint32_t i = 0; i < page_info->chunk_count; i++) {
+		const struct vy_page_chunk *chunk = &page_info->chunks[i];
+		size += mp_sizeof_array(5) +
+			mp_sizeof_uint(chunk->offset) +
+			mp_sizeof_uint(chunk->size) +
+			mp_sizeof_uint(chunk->unpacked_size);
+		if (chunk->min != NULL) {
+			const char *max_end = chunk->max;
+			mp_next(&max_end);
+			size += max_end - chunk->min;
+		}
+	}
+	return size;
+}
+
+/**
+ * Encode chunks of a columnar page to @a buf and return advanced @a buf.
+ * See vy_page_info_decode_chunks() for the format.
+ */
+static char *
+vy_page_info_encode_chunks(const struct vy_page_info *page_info, char *buf)
+{
+	buf = mp_encode_array(buf, page_info->chunk_count);
+	for (uint32_t i = 0; i < page_info->chunk_count; i++) {
+		const struct vy_page_chunk *chunk = &page_info->chunks[i];
+		buf = mp_encode_array(buf, chunk->min != NULL ? 5 : 3);
+		buf = mp_encode_uint(buf, chunk->offset);
+		buf = mp_encode_uint(buf, chunk->size);
+		buf = mp_encode_uint(buf, chunk->unpacked_size);
+		if (chunk->min != NULL) {
+			const char *max_end = chunk->max;
+			mp_next(&max_end);
+			memcpy(buf, chunk->min, max_end - chunk->min);
+			buf += max_end - chunk->min;
+		}
+	}
+	return buf;
+}
+
 /**
  * Encode vy_page_info as xrow.
  * Allocates using region_alloc.
@@ -1954,10 +3493,14 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	mp_next(&tmp);
 	min_key_size = tmp - page_info->min_key;
 
+	uint32_t key_count = 6;
+	if (page_info->chunks != NULL)
+		key_count++;
+
 	/* calc tuple size */
 	uint32_t size;
 	/* 3 items: page offset, size, and map */
-	size = mp_sizeof_map(6) +
+	size = mp_sizeof_map(key_count) +
 	       mp_sizeof_uint(VY_PAGE_INFO_OFFSET) +
 	       mp_sizeof_uint(page_info->offset) +
 	       mp_sizeof_uint(VY_PAGE_INFO_SIZE) +
@@ -1970,6 +3513,10 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	       mp_sizeof_uint(page_info->unpacked_size) +
 	       mp_sizeof_uint(VY_PAGE_INFO_ROW_INDEX_OFFSET) +
 	       mp_sizeof_uint(page_info->row_index_offset);
+	if (page_info->chunks != NULL) {
+		size += mp_sizeof_uint(VY_PAGE_INFO_CHUNKS) +
+			vy_page_info_sizeof_chunks(page_info);
+	}
 
 	char *pos = region_alloc(region, size);
 	if (pos == NULL) {
@@ -1980,7 +3527,7 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	memset(xrow, 0, sizeof(*xrow));
 	/* encode page */
 	xrow->body->iov_base = pos;
-	pos = mp_encode_map(pos, 6);
+	pos = mp_encode_map(pos, key_count);
 	pos = mp_encode_uint(pos, VY_PAGE_INFO_OFFSET);
 	pos = mp_encode_uint(pos, page_info->offset);
 	pos = mp_encode_uint(pos, VY_PAGE_INFO_SIZE);
@@ -1994,6 +3541,11 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	pos = mp_encode_uint(pos, page_info->unpacked_size);
 	pos = mp_encode_uint(pos, VY_PAGE_INFO_ROW_INDEX_OFFSET);
 	pos = mp_encode_uint(pos, page_info->row_index_offset);
+	if (page_info->chunks != NULL) {
+		pos = mp_encode_uint(pos, VY_PAGE_INFO_CHUNKS);
+		pos = vy_page_info_encode_chunks(page_info, pos);
+	}
+	assert(pos <= (char *)xrow->body->iov_base + size);
 	xrow->body->iov_len = (void *)pos - xrow->body->iov_base;
 	xrow->bodycnt = 1;
 
@@ -2184,7 +3736,8 @@ int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		     const char *dirpath, uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
-		     uint64_t page_size, double bloom_fpr, bool no_compression)
+		     uint64_t page_size, double bloom_fpr, bool no_compression,
+		     enum vy_run_layout layout)
 {
 	memset(writer, 0, sizeof(*writer));
 	writer->run = run;
@@ -2196,6 +3749,7 @@ vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 	writer->page_size = page_size;
 	writer->bloom_fpr = bloom_fpr;
 	writer->no_compression = no_compression;
+	writer->layout = layout;
 	if (bloom_fpr < 1) {
 		writer->bloom = tuple_bloom_builder_new(key_def->part_count);
 		if (writer->bloom == NULL)
@@ -2204,6 +3758,7 @@ vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 	xlog_clear(&writer->data_xlog);
 	ibuf_create(&writer->row_index_buf, &cord()->slabc,
 		    4096 * sizeof(uint32_t));
+	ibuf_create(&writer->header_buf, &cord()->slabc, 16 * 1024);
 	run->info.min_lsn = INT64_MAX;
 	run->info.max_lsn = -1;
 	assert(run->page_info == NULL);
@@ -2272,10 +3827,242 @@ vy_run_writer_start_page(struct vy_run_writer *writer,
 				key, writer->cmp_def) != 0)
 		return -1;
 	run->info.page_count++;
-	xlog_tx_begin(&writer->data_xlog);
+	/* Columnar page chunks are written in separate transactions. */
+	if (writer->layout == VY_RUN_LAYOUT_ROW)
+		xlog_tx_begin(&writer->data_xlog);
+	return 0;
+}
+
+/**
+ * Make sure a run writer has buffers for @a column_count fields
+ * of a columnar page.
+ */
+static int
+vy_run_writer_reserve_columns(struct vy_run_writer *writer,
+			      uint32_t column_count)
+{
+	if (column_count > writer->column_capacity) {
+		uint32_t capacity = MAX(writer->column_capacity * 2, 16);
+		while (capacity < column_count)
+			capacity *= 2;
+		size_t size = capacity * sizeof(*writer->column_bufs);
+		struct vy_run_column_buf *bufs = realloc(writer->column_bufs,
+							 size);
+		if (bufs == NULL) {
+			diag_set(OutOfMemory, size, "realloc",
+				 "struct vy_run_column_buf");
+			return -1;
+		}
+		for (uint32_t i = writer->column_capacity; i < capacity; i++) {
+			ibuf_create(&bufs[i].data, &cord()->slabc, 1024);
+			bufs[i].count = 0;
+		}
+		writer->column_bufs = bufs;
+		writer->column_capacity = capacity;
+	}
+	writer->column_count = MAX(writer->column_count, column_count);
+	return 0;
+}
+
+/**
+ * Append a statement to the buffers of a current columnar page:
+ * the statement header goes to the header buffer while field
+ * values are appended to column buffers, one per field.
+ */
+static int
+vy_run_writer_write_to_columns(struct vy_run_writer *writer,
+			       struct vy_entry entry, struct vy_page_info *page)
+{
+	char *header, *header_end;
+	const char *data, *data_end;
+	if (vy_stmt_encode_columnar(entry.stmt, writer->cmp_def,
+				    writer->iid == 0,
+				    vy_entry_multikey_idx(entry,
+							  writer->cmp_def),
+				    &header, &header_end,
+				    &data, &data_end) != 0)
+		return -1;
+	size_t size = header_end - header;
+	char *buf = ibuf_alloc(&writer->header_buf, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "ibuf", "statement header");
+		return -1;
+	}
+	memcpy(buf, header, size);
+	page->unpacked_size += size;
+	uint32_t field_count = data != NULL ? mp_decode_array(&data) : 0;
+	if (vy_run_writer_reserve_columns(writer, field_count) != 0)
+		return -1;
+	for (uint32_t i = 0; i < field_count; i++) {
+		struct vy_run_column_buf *column = &writer->column_bufs[i];
+		const char *value = data;
+		mp_next(&data);
+		size = data - value;
+		buf = ibuf_alloc(&column->data, size);
+		if (buf == NULL) {
+			diag_set(OutOfMemory, size, "ibuf", "column");
+			return -1;
+		}
+		memcpy(buf, value, size);
+		column->count++;
+		page->unpacked_size += size;
+	}
+	assert(data == data_end);
+	page->row_count++;
+	return 0;
+}
+
+/**
+ * Write a chunk of a columnar page in a separate xlog transaction.
+ *
+ * @param writer   Run writer.
+ * @param chunk_no Number of the chunk in the page.
+ * @param data     Encoded values to store in the chunk.
+ * @param count    Number of values.
+ * @param[out] chunk Chunk information.
+ *
+ * @retval -1 Memory or IO error.
+ * @retval  0 Success.
+ */
+static int
+vy_run_writer_write_chunk(struct vy_run_writer *writer, uint32_t chunk_no,
+			  struct ibuf *data, uint32_t count,
+			  struct vy_page_chunk *chunk)
+{
+	/* Header chunk stores FIELD_COUNT, field chunks store FIELD_NO. */
+	uint32_t no_key = chunk_no == 0 ? VY_COLUMN_FIELD_COUNT :
+					  VY_COLUMN_FIELD_NO;
+	uint32_t no = chunk_no == 0 ? writer->column_count : chunk_no - 1;
+	size_t size = mp_sizeof_map(2) +
+		      mp_sizeof_uint(no_key) + mp_sizeof_uint(no) +
+		      mp_sizeof_uint(VY_COLUMN_DATA) + mp_sizeof_array(count);
+	char *buf = region_alloc(&fiber()->gc, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "region", "chunk");
+		return -1;
+	}
+	struct xrow_header xrow;
+	memset(&xrow, 0, sizeof(xrow));
+	xrow.type = VY_RUN_COLUMN;
+	xrow.body[0].iov_base = buf;
+	buf = mp_encode_map(buf, 2);
+	buf = mp_encode_uint(buf, no_key);
+	buf = mp_encode_uint(buf, no);
+	buf = mp_encode_uint(buf, VY_COLUMN_DATA);
+	buf = mp_encode_array(buf, count);
+	xrow.body[0].iov_len = buf - (char *)xrow.body[0].iov_base;
+	xrow.body[1].iov_base = data->rpos;
+	xrow.body[1].iov_len = ibuf_used(data);
+	xrow.bodycnt = 2;
+
+	struct xlog *xlog = &writer->data_xlog;
+	chunk->offset = xlog->offset;
+	xlog_tx_begin(xlog);
+	ssize_t written = xlog_write_row(xlog, &xrow);
+	if (written < 0)
+		return -1;
+	chunk->unpacked_size = written;
+	written = xlog_tx_commit(xlog);
+	if (written == 0)
+		written = xlog_flush(xlog);
+	if (written < 0)
+		return -1;
+	chunk->size = written;
+	return 0;
+}
+
+/**
+ * Calculate min/max stats of field chunks of a current columnar page,
+ * see struct vy_page_chunk.
+ */
+static int
+vy_run_writer_build_column_stat(struct vy_run_writer *writer,
+				struct vy_page_info *page)
+{
+	size_t size;
+	struct vy_column_cursor *cursors = region_alloc_array(
+		&fiber()->gc, typeof(cursors[0]), page->chunk_count, &size);
+	if (cursors == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "cursors");
+		return -1;
+	}
+	cursors[0].pos = writer->header_buf.rpos;
+	cursors[0].count = page->row_count;
+	for (uint32_t i = 1; i < page->chunk_count; i++) {
+		struct vy_run_column_buf *column = &writer->column_bufs[i - 1];
+		cursors[i].pos = column->data.rpos;
+		cursors[i].count = column->count;
+	}
+	return vy_page_info_build_column_stat(page, writer->cmp_def, cursors);
+}
+
+/**
+ * Finish a current columnar page: write the header chunk followed by
+ * field chunks and calculate their min/max stats.
+ */
+static int
+vy_run_writer_end_columnar_page(struct vy_run_writer *writer,
+				struct vy_page_info *page)
+{
+	uint32_t chunk_count = writer->column_count + 1;
+	size_t size = chunk_count * sizeof(*page->chunks);
+	page->chunks = calloc(1, size);
+	if (page->chunks == NULL) {
+		diag_set(OutOfMemory, size, "calloc", "struct vy_page_chunk");
+		return -1;
+	}
+	page->chunk_count = chunk_count;
+	if (vy_run_writer_write_chunk(writer, 0, &writer->header_buf,
+				      page->row_count, &page->chunks[0]) != 0)
+		return -1;
+	for (uint32_t i = 1; i < chunk_count; i++) {
+		struct vy_run_column_buf *column = &writer->column_bufs[i - 1];
+		if (vy_run_writer_write_chunk(writer, i, &column->data,
+					      column->count,
+					      &page->chunks[i]) != 0)
+			return -1;
+	}
+	if (vy_run_writer_build_column_stat(writer, page) != 0)
+		return -1;
+	page->offset = page->chunks[0].offset;
+	page->size = 0;
+	page->unpacked_size = 0;
+	for (uint32_t i = 0; i < chunk_count; i++) {
+		page->size += page->chunks[i].size;
+		page->unpacked_size += page->chunks[i].unpacked_size;
+	}
+	vy_run_acct_page(writer->run, page);
+	ibuf_reset(&writer->header_buf);
+	for (uint32_t i = 0; i < writer->column_count; i++) {
+		ibuf_reset(&writer->column_bufs[i].data);
+		writer->column_bufs[i].count = 0;
+	}
+	writer->column_count = 0;
 	return 0;
 }
 
+/** Return true if no statements were written to a current page. */
+static inline bool
+vy_run_writer_page_is_empty(struct vy_run_writer *writer)
+{
+	if (writer->layout == VY_RUN_LAYOUT_COLUMNAR)
+		return ibuf_used(&writer->header_buf) == 0;
+	return ibuf_used(&writer->row_index_buf) == 0;
+}
+
+/** Return true if a current page has reached the page size. */
+static inline bool
+vy_run_writer_page_is_full(struct vy_run_writer *writer)
+{
+	if (writer->layout == VY_RUN_LAYOUT_COLUMNAR) {
+		struct vy_run *run = writer->run;
+		struct vy_page_info *page =
+			run->page_info + run->info.page_count - 1;
+		return page->unpacked_size >= writer->page_size;
+	}
+	return obuf_size(&writer->data_xlog.obuf) >= writer->page_size;
+}
+
 /**
  * Write @a stmt into a current page.
  * @param writer Run writer.
@@ -2296,16 +4083,22 @@ vy_run_writer_write_to_page(struct vy_run_writer *writer, struct vy_entry entry)
 	vy_stmt_ref_if_possible(entry.stmt);
 	struct vy_run *run = writer->run;
 	struct vy_page_info *page = run->page_info + run->info.page_count - 1;
-	uint32_t *offset = (uint32_t *)ibuf_alloc(&writer->row_index_buf,
-						  sizeof(uint32_t));
-	if (offset == NULL) {
-		diag_set(OutOfMemory, sizeof(uint32_t), "ibuf", "row index");
-		return -1;
+	if (writer->layout == VY_RUN_LAYOUT_COLUMNAR) {
+		if (vy_run_writer_write_to_columns(writer, entry, page) != 0)
+			return -1;
+	} else {
+		uint32_t *offset = (uint32_t *)ibuf_alloc(
+			&writer->row_index_buf, sizeof(uint32_t));
+		if (offset == NULL) {
+			diag_set(OutOfMemory, sizeof(uint32_t),
+				 "ibuf", "row index");
+			return -1;
+		}
+		*offset = page->unpacked_size;
+		if (vy_run_dump_stmt(entry, &writer->data_xlog, page,
+				     writer->cmp_def, writer->iid == 0) != 0)
+			return -1;
 	}
-	*offset = page->unpacked_size;
-	if (vy_run_dump_stmt(entry, &writer->data_xlog, page,
-			     writer->cmp_def, writer->iid == 0) != 0)
-		return -1;
 	int64_t lsn = vy_stmt_lsn(entry.stmt);
 	run->info.min_lsn = MIN(run->info.min_lsn, lsn);
 	run->info.max_lsn = MAX(run->info.max_lsn, lsn);
@@ -2327,6 +4120,8 @@ vy_run_writer_end_page(struct vy_run_writer *writer)
 	struct vy_page_info *page = run->page_info + run->info.page_count - 1;
 
 	assert(page->row_count > 0);
+	if (writer->layout == VY_RUN_LAYOUT_COLUMNAR)
+		return vy_run_writer_end_columnar_page(writer, page);
 	assert(ibuf_used(&writer->row_index_buf) ==
 	       sizeof(uint32_t) * page->row_count);
 
@@ -2359,12 +4154,12 @@ vy_run_writer_append_stmt(struct vy_run_writer *writer, struct vy_entry entry)
 	if (!xlog_is_open(&writer->data_xlog) &&
 	    vy_run_writer_create_xlog(writer) != 0)
 		goto out;
-	if (ibuf_used(&writer->row_index_buf) == 0 &&
+	if (vy_run_writer_page_is_empty(writer) &&
 	    vy_run_writer_start_page(writer, entry) != 0)
 		goto out;
 	if (vy_run_writer_write_to_page(writer, entry) != 0)
 		goto out;
-	if (obuf_size(&writer->data_xlog.obuf) >= writer->page_size &&
+	if (vy_run_writer_page_is_full(writer) &&
 	    vy_run_writer_end_page(writer) != 0)
 		goto out;
 	rc = 0;
@@ -2387,6 +4182,10 @@ vy_run_writer_destroy(struct vy_run_writer *writer)
 	if (writer->bloom != NULL)
 		tuple_bloom_builder_delete(writer->bloom);
 	ibuf_destroy(&writer->row_index_buf);
+	ibuf_destroy(&writer->header_buf);
+	for (uint32_t i = 0; i < writer->column_capacity; i++)
+		ibuf_destroy(&writer->column_bufs[i].data);
+	free(writer->column_bufs);
 }
 
 int
@@ -2395,7 +4194,7 @@ vy_run_writer_commit(struct vy_run_writer *writer)
 	int rc = -1;
 	size_t region_svp = region_used(&fiber()->gc);
 
-	if (ibuf_used(&writer->row_index_buf) != 0 &&
+	if (!vy_run_writer_page_is_empty(writer) &&
 	    vy_run_writer_end_page(writer) != 0)
 		goto out;
 
@@ -2456,6 +4255,121 @@ vy_run_writer_abort(struct vy_run_writer *writer)
 	vy_run_writer_destroy(writer);
 }
 
+/**
+ * Decode a chunk of a columnar page read with an xlog cursor. The chunk
+ * body is copied to the fiber region, because the cursor reuses its
+ * buffer for the next transaction.
+ */
+static int
+vy_page_chunk_decode_copy(struct xrow_header *xrow, uint32_t chunk_no,
+			  uint64_t *no, struct vy_column_cursor *cursor)
+{
+	if (xrow->bodycnt > 0) {
+		size_t size = xrow->body[0].iov_len;
+		char *body = region_alloc(&fiber()->gc, size);
+		if (body == NULL) {
+			diag_set(OutOfMemory, size, "region", "chunk");
+			return -1;
+		}
+		memcpy(body, xrow->body[0].iov_base, size);
+		xrow->body[0].iov_base = body;
+	}
+	return vy_page_chunk_decode_xrow(xrow, chunk_no, no, cursor);
+}
+
+/**
+ * Read a columnar page for vy_run_rebuild_index() and restore its
+ * chunks along with their min/max stats.
+ *
+ * @param cursor        Cursor over the run file positioned at the
+ *                      header chunk of the page.
+ * @param xrow          Header chunk xrow.
+ * @param page_offset   Offset of the header chunk in the run file.
+ * @param[in,out] next_offset End of the last transaction read.
+ * @param cmp_def       Key definition of the index.
+ * @param[out] info     Page info to store the chunks in.
+ *
+ * @retval page with materialized statements on success
+ * @retval NULL on error, check diag
+ */
+static struct vy_page *
+vy_run_rebuild_columnar_page(struct xlog_cursor *cursor,
+			     struct xrow_header *xrow, off_t page_offset,
+			     off_t *next_offset, struct key_def *cmp_def,
+			     struct vy_page_info *info)
+{
+	uint64_t field_count;
+	struct vy_column_cursor header;
+	if (vy_page_chunk_decode_copy(xrow, 0, &field_count, &header) != 0)
+		return NULL;
+	if (field_count >= UINT32_MAX) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 "Can't decode chunk 0 of a columnar page");
+		return NULL;
+	}
+	uint32_t chunk_count = field_count + 1;
+	size_t size = chunk_count * sizeof(*info->chunks);
+	info->chunks = calloc(1, size);
+	if (info->chunks == NULL) {
+		diag_set(OutOfMemory, size, "calloc", "struct vy_page_chunk");
+		return NULL;
+	}
+	info->chunk_count = chunk_count;
+	struct vy_column_cursor *cursors = region_alloc_array(
+		&fiber()->gc, typeof(cursors[0]), chunk_count, &size);
+	if (cursors == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "cursors");
+		return NULL;
+	}
+	cursors[0] = header;
+	struct vy_page_chunk *chunk = &info->chunks[0];
+	chunk->offset = page_offset;
+	chunk->size = *next_offset - page_offset;
+	chunk->unpacked_size = xlog_cursor_tx_pos(cursor);
+	for (uint32_t i = 1; i < chunk_count; i++) {
+		chunk = &info->chunks[i];
+		chunk->offset = *next_offset;
+		int rc = xlog_cursor_next_tx(cursor);
+		if (rc == 0)
+			rc = xlog_cursor_next_row(cursor, xrow);
+		if (rc > 0) {
+			diag_set(ClientError, ER_INVALID_RUN_FILE,
+				 "Unexpected end of file");
+		}
+		if (rc != 0)
+			return NULL;
+		*next_offset = xlog_cursor_pos(cursor);
+		chunk->size = *next_offset - chunk->offset;
+		chunk->unpacked_size = xlog_cursor_tx_pos(cursor);
+		uint64_t no;
+		if (vy_page_chunk_decode_copy(xrow, i, &no, &cursors[i]) != 0)
+			return NULL;
+		if (no != i - 1) {
+			diag_set(ClientError, ER_INVALID_RUN_FILE,
+				 tt_sprintf("Can't decode chunk %u of "
+					    "a columnar page", (unsigned)i));
+			return NULL;
+		}
+	}
+	info->offset = page_offset;
+	info->row_count = header.count;
+	for (uint32_t i = 0; i < chunk_count; i++) {
+		info->size += info->chunks[i].size;
+		info->unpacked_size += info->chunks[i].unpacked_size;
+	}
+	if (vy_page_info_build_column_stat(info, cmp_def, cursors) != 0)
+		return NULL;
+	struct vy_page *page = vy_page_new(info);
+	if (page == NULL)
+		return NULL;
+	if (vy_page_fill_columnar(page, info, COLUMN_MASK_FULL,
+				  cursors) != 0) {
+		vy_page_unref(page);
+		return NULL;
+	}
+	return page;
+}
+
 int
 vy_run_rebuild_index(struct vy_run *run, const char *dir,
 		     uint32_t space_id, uint32_t iid,
@@ -2484,6 +4398,10 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 	int64_t min_lsn = INT64_MAX;
 	struct tuple *prev_tuple = NULL;
 	char *page_min_key = NULL;
+	/* Page and chunks of a columnar page being restored. */
+	struct vy_page *columnar_page = NULL;
+	struct vy_page_info columnar_info;
+	memset(&columnar_info, 0, sizeof(columnar_info));
 
 	struct tuple_bloom_builder *bloom_builder = NULL;
 	if (opts->bloom_fpr < 1) {
@@ -2505,15 +4423,52 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 		uint64_t page_row_index_offset = 0;
 		uint64_t row_offset = xlog_cursor_tx_pos(&cursor);
 
+		uint32_t stmt_no = 0;
 		struct xrow_header xrow;
-		while ((rc = xlog_cursor_next_row(&cursor, &xrow)) == 0) {
-			if (xrow.type == VY_RUN_ROW_INDEX) {
-				page_row_index_offset = row_offset;
+		while (true) {
+			struct tuple *tuple;
+			if (columnar_page != NULL) {
+				if (stmt_no == columnar_page->row_count)
+					break;
+				tuple = vy_page_stmt(columnar_page, stmt_no++,
+						     cmp_def, format).stmt;
+			} else {
+				rc = xlog_cursor_next_row(&cursor, &xrow);
+				if (rc != 0)
+					break;
+				if (xrow.type == VY_RUN_ROW_INDEX) {
+					page_row_index_offset = row_offset;
+					row_offset = xlog_cursor_tx_pos(&cursor);
+					continue;
+				}
+				if (xrow.type == VY_RUN_COLUMN) {
+					/*
+					 * A columnar page starts with
+					 * the header chunk and spans
+					 * a few transactions.
+					 */
+					if (page_row_count > 0) {
+						diag_set(ClientError,
+							 ER_INVALID_RUN_FILE,
+							 "Unexpected chunk of "
+							 "a columnar page");
+						goto close_err;
+					}
+					columnar_page =
+						vy_run_rebuild_columnar_page(
+							&cursor, &xrow,
+							page_offset,
+							&next_page_offset,
+							cmp_def,
+							&columnar_info);
+					if (columnar_page == NULL)
+						goto close_err;
+					continue;
+				}
+				tuple = vy_stmt_decode(&xrow, format);
 				row_offset = xlog_cursor_tx_pos(&cursor);
-				continue;
 			}
 			++page_row_count;
-			struct tuple *tuple = vy_stmt_decode(&xrow, format);
 			if (tuple == NULL)
 				goto close_err;
 			if (bloom_builder != NULL) {
@@ -2542,11 +4497,11 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 				if (page_min_key == NULL)
 					goto close_err;
 			}
-			if (xrow.lsn > max_lsn)
-				max_lsn = xrow.lsn;
-			if (xrow.lsn < min_lsn)
-				min_lsn = xrow.lsn;
-			row_offset = xlog_cursor_tx_pos(&cursor);
+			int64_t lsn = vy_stmt_lsn(tuple);
+			if (lsn > max_lsn)
+				max_lsn = lsn;
+			if (lsn < min_lsn)
+				min_lsn = lsn;
 		}
 		struct vy_page_info *info;
 		info = run->page_info + run->info.page_count;
@@ -2554,9 +4509,19 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 					page_min_key, cmp_def) != 0)
 			goto close_err;
 		info->row_count = page_row_count;
-		info->size = next_page_offset - page_offset;
-		info->unpacked_size = xlog_cursor_tx_pos(&cursor);
-		info->row_index_offset = page_row_index_offset;
+		if (columnar_page != NULL) {
+			info->size = columnar_info.size;
+			info->unpacked_size = columnar_info.unpacked_size;
+			info->chunk_count = columnar_info.chunk_count;
+			info->chunks = columnar_info.chunks;
+			memset(&columnar_info, 0, sizeof(columnar_info));
+			vy_page_unref(columnar_page);
+			columnar_page = NULL;
+		} else {
+			info->size = next_page_offset - page_offset;
+			info->unpacked_size = xlog_cursor_tx_pos(&cursor);
+			info->row_index_offset = page_row_index_offset;
+		}
 		++run->info.page_count;
 		vy_run_acct_page(run, info);
 
@@ -2603,6 +4568,9 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 		tuple_unref(prev_tuple);
 	if (page_min_key != NULL)
 		free(page_min_key);
+	if (columnar_page != NULL)
+		vy_page_unref(columnar_page);
+	vy_page_info_destroy(&columnar_info);
 	if (bloom_builder != NULL)
 		tuple_bloom_builder_delete(bloom_builder);
 	if (xlog_cursor_is_open(&cursor))
@@ -2688,8 +4656,9 @@ vy_slice_stream_read_page(struct vy_slice_stream *stream)
 	if (stream->page == NULL)
 		return -1;
 
-	if (vy_page_read(stream->page, page_info, run, zdctx) != 0) {
-		vy_page_delete(stream->page);
+	if (vy_page_read(stream->page, page_info, run, COLUMN_MASK_FULL,
+			 zdctx) != 0) {
+		vy_page_unref(stream->page);
 		stream->page = NULL;
 		return -1;
 	}
@@ -2722,14 +4691,14 @@ vy_slice_stream_search(struct vy_stmt_stream *virt_stream)
 	if (vy_page_find_key(stream->page, stream->slice->begin,
 			     stream->cmp_def, stream->format, ITER_GE,
 			     &stream->pos_in_page, &unused) != 0) {
-		vy_page_delete(stream->page);
+		vy_page_unref(stream->page);
 		stream->page = NULL;
 		return -1;
 	}
 
 	if (stream->pos_in_page == stream->page->row_count) {
 		/* The first tuple is in the beginning of the next page */
-		vy_page_delete(stream->page);
+		vy_page_unref(stream->page);
 		stream->page = NULL;
 		stream->page_no++;
 		stream->pos_in_page = 0;
@@ -2792,7 +4761,7 @@ vy_slice_stream_next(struct vy_stmt_stream *virt_stream, struct vy_entry *ret)
 		 * Out of page. Free page, move the position to the next page
 		 * and * nullify page pointer to read it on the next iteration.
 		 */
-		vy_page_delete(stream->page);
+		vy_page_unref(stream->page);
 		stream->page = NULL;
 		stream->page_no++;
 		stream->pos_in_page = 0;
@@ -2810,7 +4779,7 @@ vy_slice_stream_stop(struct vy_stmt_stream *virt_stream)
 	assert(virt_stream->iface->stop == vy_slice_stream_stop);
 	struct vy_slice_stream *stream = (struct vy_slice_stream *)virt_stream;
 	if (stream->page != NULL) {
-		vy_page_delete(stream->page);
+		vy_page_unref(stream->page);
 		stream->page = NULL;
 	}
 	if (stream->entry.stmt != NULL) {
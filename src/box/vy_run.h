@@ -44,6 +44,7 @@
 #include "xlog.h"
 
 #include "small/mempool.h"
+#include "small/rlist.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -51,6 +52,24 @@ extern "C" {
 
 struct vy_history;
 struct vy_run_reader;
+struct vy_readahead;
+struct mh_vy_page_cache_t;
+
+/**
+ * Cache of decompressed pages shared by all run iterators.
+ * Pages are evicted in the LRU order when the size of cached
+ * pages exceeds the quota. Used only from the tx thread.
+ */
+struct vy_page_cache {
+	/** Map {run id, page no} -> struct vy_page. */
+	struct mh_vy_page_cache_t *map;
+	/** List of cached pages, most recently used first. */
+	struct rlist lru;
+	/** Size of memory occupied by cached pages. */
+	size_t mem_used;
+	/** Max size of memory that may be occupied by cached pages. */
+	size_t quota;
+};
 
 /** Part of vinyl environment for run read/write */
 struct vy_run_env {
@@ -74,6 +93,20 @@ struct vy_run_env {
 	 * unconditionally remove unused runs' files in-place.
 	 */
 	bool initial_join;
+	/** Cache of decompressed pages. */
+	struct vy_page_cache page_cache;
+	/**
+	 * Max number of pages a run iterator may read ahead when
+	 * it detects a scan. Zero disables readahead.
+	 */
+	uint32_t readahead;
+	/**
+	 * Readahead tasks posted to reader threads and not
+	 * completed yet, linked by vy_readahead::in_env.
+	 */
+	struct rlist readahead_tasks;
+	/** Signaled when the last in-flight readahead task completes. */
+	struct fiber_cond readahead_cond;
 };
 
 /**
@@ -96,6 +129,60 @@ struct vy_run_info {
 	struct vy_stmt_stat stmt_stat;
 };
 
+/** Layout of statements in run pages. */
+enum vy_run_layout {
+	/** Each statement is stored as a separate xrow. */
+	VY_RUN_LAYOUT_ROW,
+	/**
+	 * Statement fields are split into column chunks, one per
+	 * field, see struct vy_page_chunk.
+	 */
+	VY_RUN_LAYOUT_COLUMNAR,
+	vy_run_layout_MAX,
+};
+
+/** Run layout names, used for the index 'layout' option. */
+extern const char *vy_run_layout_strs[];
+
+/**
+ * Return a run layout given its name or vy_run_layout_MAX if
+ * the name is invalid. NULL stands for the default layout.
+ */
+static inline enum vy_run_layout
+vy_run_layout_by_name(const char *name)
+{
+	if (name == NULL)
+		return VY_RUN_LAYOUT_ROW;
+	return STR2ENUM(vy_run_layout, name);
+}
+
+/**
+ * Chunk of a page of a columnar run.
+ *
+ * A columnar page is stored as a sequence of xlog transactions, one
+ * per chunk, each holding a single VY_RUN_COLUMN xrow. The first chunk
+ * stores statement headers (see struct vy_stmt_columnar_header) while
+ * the following chunks store field values, one chunk per field. This
+ * way a reader that needs only a few fields doesn't have to read and
+ * decode the whole page.
+ */
+struct vy_page_chunk {
+	/** Offset of the chunk in the run file. */
+	uint64_t offset;
+	/** Size of the chunk in the run file. */
+	uint32_t size;
+	/** Size of the chunk in memory, i.e. unpacked. */
+	uint32_t unpacked_size;
+	/**
+	 * Min and max values stored in a field chunk, including key
+	 * parts of primary index DELETE statements, or NULL if there
+	 * are no values that can be compared, see vy_column_stat_add().
+	 * Both values are allocated in the same memory block.
+	 */
+	char *min;
+	char *max;
+};
+
 /**
  * Run page metadata. Is a written to a file as a single chunk.
  */
@@ -114,6 +201,10 @@ struct vy_page_info {
 	hint_t min_key_hint;
 	/** Offset of the row index in the page. */
 	uint32_t row_index_offset;
+	/** Number of chunks of a columnar page. */
+	uint32_t chunk_count;
+	/** Chunks of a columnar page or NULL for a row page. */
+	struct vy_page_chunk *chunks;
 };
 
 /**
@@ -286,14 +377,43 @@ struct vy_run_iterator {
 	struct vy_page *prev_page;
 	/** Is false until first .._get or .._next_.. method is called */
 	bool search_started;
+	/**
+	 * Number of the page a scan is expected to read next from
+	 * disk, i.e. the page following the last read page in the
+	 * iteration order. Used for detecting scans.
+	 */
+	int64_t scan_page_no;
+	/** Number of pages read from disk one after another. */
+	uint32_t scan_page_count;
+	/** Number of pages to read ahead by the next request. */
+	uint32_t readahead_size;
+	/**
+	 * Pages read ahead by the iterator in a reader thread
+	 * and consumed by the iterator now.
+	 */
+	struct vy_readahead *readahead;
+	/** Pages read ahead following the pages of readahead. */
+	struct vy_readahead *readahead_next;
 };
 
 /**
  * Vinyl page stored in memory.
  */
 struct vy_page {
+	/** ID of the run the page belongs to. */
+	int64_t run_id;
 	/** Page position in the run file. */
 	uint32_t page_no;
+	/**
+	 * Reference counter. A page is referenced by run iterators
+	 * and by the page cache.
+	 */
+	int refs;
+	/**
+	 * Link in vy_page_cache::lru. Empty if the page isn't
+	 * stored in the page cache.
+	 */
+	struct rlist in_cache;
 	/** Size of page data in memory, i.e. unpacked. */
 	uint32_t unpacked_size;
 	/** Number of statements in the page. */
@@ -302,6 +422,19 @@ struct vy_page {
 	uint32_t *row_index;
 	/** Pointer to the page data. */
 	char *data;
+	/**
+	 * Set if the page was read from a columnar run. Such a page
+	 * stores a statement header followed by a tuple for each
+	 * statement instead of xrows, see vy_page_read_columnar().
+	 */
+	bool is_columnar;
+	/**
+	 * Set if only some fields of a columnar page were read.
+	 * The rest of fields are replaced with nulls.
+	 */
+	bool is_partial;
+	/** Fields read into a partial page, see is_partial. */
+	uint64_t column_mask;
 };
 
 /**
@@ -320,6 +453,13 @@ vy_run_env_create(struct vy_run_env *env, int read_threads);
 void
 vy_run_env_destroy(struct vy_run_env *env);
 
+/**
+ * Disable readahead and wait for readahead tasks posted to
+ * reader threads to complete. May yield.
+ */
+void
+vy_run_env_shutdown(struct vy_run_env *env);
+
 /**
  * Enable coio reads for a vinyl run environment.
  *
@@ -335,6 +475,21 @@ vy_run_env_destroy(struct vy_run_env *env);
 void
 vy_run_env_enable_coio(struct vy_run_env *env);
 
+/**
+ * Set the max size of memory that may be occupied by the page
+ * cache. Evicts pages if the cache is bigger than the new quota.
+ * Zero disables the page cache.
+ */
+void
+vy_run_env_set_page_cache(struct vy_run_env *env, size_t quota);
+
+/**
+ * Set the max number of pages a run iterator may read ahead.
+ * Zero disables readahead.
+ */
+void
+vy_run_env_set_readahead(struct vy_run_env *env, uint32_t page_count);
+
 /**
  * Return the size of a run bloom filter.
  */
@@ -615,6 +770,14 @@ void
 vy_slice_stream_open(struct vy_slice_stream *stream, struct vy_slice *slice,
 		     struct key_def *cmp_def, struct tuple_format *format);
 
+/** Buffer of field values of a page of a columnar run. */
+struct vy_run_column_buf {
+	/** Encoded field values. */
+	struct ibuf data;
+	/** Number of values in the buffer. */
+	uint32_t count;
+};
+
 /**
  * Run_writer fills a created run with statements one by one,
  * splitting them into pages.
@@ -647,6 +810,8 @@ struct vy_run_writer {
 	uint32_t page_info_capacity;
 	/** Don't use compression while writing xlog files. */
 	bool no_compression;
+	/** Layout of the run pages. */
+	enum vy_run_layout layout;
 	/** Xlog to write data. */
 	struct xlog data_xlog;
 	/** Bloom filter false positive rate. */
@@ -655,6 +820,14 @@ struct vy_run_writer {
 	struct tuple_bloom_builder *bloom;
 	/** Buffer of a current page row offsets. */
 	struct ibuf row_index_buf;
+	/** Buffer of statement headers of a current columnar page. */
+	struct ibuf header_buf;
+	/** Buffers of field values of a current columnar page. */
+	struct vy_run_column_buf *column_bufs;
+	/** Number of fields stored in a current columnar page. */
+	uint32_t column_count;
+	/** Number of allocated column buffers. */
+	uint32_t column_capacity;
 	/**
 	 * Remember a last written statement to use it as a source
 	 * of max key of a finished run.
@@ -667,7 +840,8 @@ int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		     const char *dirpath, uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
-		     uint64_t page_size, double bloom_fpr, bool no_compression);
+		     uint64_t page_size, double bloom_fpr, bool no_compression,
+		     enum vy_run_layout layout);
 
 /**
  * Write a specified statement into a run.
@@ -38,6 +38,7 @@
 #include <stdlib.h>
 #include <small/rlist.h>
 #include <tarantool_ev.h>
+#include <pmatomic.h>
 
 #include "diag.h"
 #include "errcode.h"
@@ -80,10 +81,13 @@ static const struct cmsg_hop vy_task_complete_route[] = {
 };
 
 struct vy_task;
+struct vy_subcompaction;
 
 /** Vinyl worker thread. */
 struct vy_worker {
 	struct cord cord;
+	/** Name of the worker thread. */
+	char name[FIBER_NAME_MAX];
 	/** Pipe from tx to the worker thread. */
 	struct cpipe worker_pipe;
 	/** Pipe from the worker thread to tx. */
@@ -132,6 +136,8 @@ struct vy_deferred_delete_batch {
 };
 
 struct vy_task_ops {
+	/** Task type name, reported by box.stat.vinyl(). */
+	const char *name;
 	/**
 	 * This function is called from a worker. It is supposed to do work
 	 * which is too heavy for the tx thread (like IO or compression).
@@ -205,6 +211,7 @@ struct vy_task {
 	 */
 	double bloom_fpr;
 	int64_t page_size;
+	enum vy_run_layout layout;
 	/**
 	 * Deferred DELETE handler passed to the write iterator.
 	 * It sends deferred DELETE statements generated during
@@ -218,8 +225,66 @@ struct vy_task {
 	 * and not yet processed.
 	 */
 	int deferred_delete_in_progress;
+	/** Estimated number of statements to process. */
+	int64_t input_rows;
+	/**
+	 * Number of statements written so far. Updated by
+	 * the worker thread, read by tx for reporting progress.
+	 */
+	int64_t output_rows;
+	/**
+	 * Subcompaction this task is a part of or NULL if the task
+	 * is a dump or a compaction of a whole range.
+	 */
+	struct vy_subcompaction *subcompaction;
+	/**
+	 * Slices of compacted runs cut to the boundaries of the part
+	 * of the range compacted by a subcompaction task, linked by
+	 * vy_slice::in_range.
+	 */
+	struct rlist cut_slices;
 	/** Link in vy_scheduler::processed_tasks. */
 	struct stailq_entry in_processed;
+	/** Link in vy_scheduler::active_tasks. */
+	struct rlist in_active;
+};
+
+enum {
+	/** Max number of parts a range compaction may be split into. */
+	VY_SUBCOMPACTION_MAX = 16,
+};
+
+/**
+ * Compaction of a range split into parts by key. The parts are
+ * compacted in parallel by separate tasks, each of which writes
+ * its own run. When all the tasks are complete, the range is
+ * replaced with new ranges, one per part, see
+ * vy_subcompaction_commit().
+ */
+struct vy_subcompaction {
+	/** Pointer to the scheduler. */
+	struct vy_scheduler *scheduler;
+	/** Range being compacted. */
+	struct vy_range *range;
+	/** First (newest) and last (oldest) compacted slices. */
+	struct vy_slice *first_slice, *last_slice;
+	/** Number of parts. */
+	int part_count;
+	/**
+	 * Part boundaries: part i spans keys [keys[i], keys[i + 1]).
+	 * The first and the last keys are the range boundaries.
+	 */
+	struct vy_entry keys[VY_SUBCOMPACTION_MAX + 1];
+	/** Tasks compacting the parts. */
+	struct vy_task *tasks[VY_SUBCOMPACTION_MAX];
+	/** Runs written by the tasks. */
+	struct vy_run *runs[VY_SUBCOMPACTION_MAX];
+	/** Number of tasks that haven't been completed yet. */
+	int pending_count;
+	/** Set if any of the tasks failed. */
+	bool is_failed;
+	/** Time of the subcompaction creation. */
+	double start_time;
 };
 
 static const struct vy_deferred_delete_handler_iface
@@ -253,6 +318,8 @@ vy_task_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	vy_lsm_ref(lsm);
 	diag_create(&task->diag);
 	task->deferred_delete_handler.iface = &vy_task_deferred_delete_iface;
+	rlist_create(&task->cut_slices);
+	rlist_create(&task->in_active);
 	return task;
 }
 
@@ -332,14 +399,15 @@ vy_worker_pool_start(struct vy_worker_pool *pool)
 		panic("failed to allocate vinyl worker pool");
 
 	for (int i = 0; i < pool->size; i++) {
-		char name[FIBER_NAME_MAX];
-		snprintf(name, sizeof(name), "vinyl.%s.%d", pool->name, i);
 		struct vy_worker *worker = &pool->workers[i];
-		if (cord_costart(&worker->cord, name, vy_worker_f, worker) != 0)
+		snprintf(worker->name, sizeof(worker->name), "vinyl.%s.%d",
+			 pool->name, i);
+		if (cord_costart(&worker->cord, worker->name,
+				 vy_worker_f, worker) != 0)
 			panic("failed to start vinyl worker thread");
 
 		worker->pool = pool;
-		cpipe_create(&worker->worker_pipe, name);
+		cpipe_create(&worker->worker_pipe, worker->name);
 		stailq_add_tail_entry(&pool->idle_workers, worker, in_idle);
 
 		struct cmsg_hop *route = worker->deferred_delete_route;
@@ -451,6 +519,8 @@ vy_scheduler_create(struct vy_scheduler *scheduler, int write_threads,
 			      "compaction", compaction_threads);
 
 	stailq_create(&scheduler->processed_tasks);
+	rlist_create(&scheduler->active_tasks);
+	scheduler->max_subcompactions = 1;
 
 	vy_dump_heap_create(&scheduler->dump_heap);
 	vy_compaction_heap_create(&scheduler->compaction_heap);
@@ -533,6 +603,24 @@ vy_scheduler_reset_stat(struct vy_scheduler *scheduler)
 	stat->compaction_output = 0;
 }
 
+void
+vy_scheduler_foreach_task(struct vy_scheduler *scheduler,
+			  vy_task_progress_f cb, void *arg)
+{
+	double now = ev_monotonic_now(loop());
+	struct vy_task *task;
+	rlist_foreach_entry(task, &scheduler->active_tasks, in_active) {
+		struct vy_task_progress progress;
+		progress.worker = task->worker->name;
+		progress.type = task->ops->name;
+		progress.lsm = task->lsm;
+		progress.input_rows = task->input_rows;
+		progress.output_rows = pm_atomic_load(&task->output_rows);
+		progress.time = now - task->start_time;
+		cb(&progress, arg);
+	}
+}
+
 static int
 vy_scheduler_on_delete_lsm(struct trigger *trigger, void *event)
 {
@@ -1117,7 +1205,7 @@ vy_task_write_run(struct vy_task *task, bool no_compression)
 				 lsm->space_id, lsm->index_id,
 				 task->cmp_def, task->key_def,
 				 task->page_size, task->bloom_fpr,
-				 no_compression) != 0)
+				 no_compression, task->layout) != 0)
 		goto fail;
 
 	if (wi->iface->start(wi) != 0)
@@ -1134,6 +1222,7 @@ vy_task_write_run(struct vy_task *task, bool no_compression)
 		rc = vy_run_writer_append_stmt(&writer, entry);
 		if (rc != 0)
 			break;
+		pm_atomic_fetch_add(&task->output_rows, 1);
 
 		if (++loops % YIELD_LOOPS == 0)
 			fiber_sleep(0);
@@ -1375,6 +1464,7 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 		 struct vy_lsm *lsm, struct vy_task **p_task)
 {
 	static struct vy_task_ops dump_ops = {
+		.name = "dump",
 		.execute = vy_task_dump_execute,
 		.complete = vy_task_dump_complete,
 		.abort = vy_task_dump_abort,
@@ -1451,12 +1541,14 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 			continue;
 		if (vy_write_iterator_new_mem(wi, mem) != 0)
 			goto err_wi_sub;
+		task->input_rows += mem->count.rows;
 	}
 
 	task->new_run = new_run;
 	task->wi = wi;
 	task->bloom_fpr = lsm->opts.bloom_fpr;
 	task->page_size = lsm->opts.page_size;
+	task->layout = lsm->run_layout;
 
 	lsm->is_dumping = true;
 	vy_scheduler_update_lsm(scheduler, lsm);
@@ -1687,11 +1779,518 @@ vy_task_compaction_abort(struct vy_task *task)
 	vy_scheduler_update_lsm(scheduler, lsm);
 }
 
+/** Free a subcompaction once all its tasks are complete. */
+static void
+vy_subcompaction_delete(struct vy_subcompaction *sub)
+{
+	assert(sub->pending_count == 0);
+	for (int i = 0; i <= sub->part_count; i++) {
+		if (sub->keys[i].stmt != NULL)
+			tuple_unref(sub->keys[i].stmt);
+	}
+	free(sub);
+}
+
+/**
+ * Close the write iterator of a subcompaction task and delete
+ * the slices it was reading.
+ */
+static void
+vy_task_subcompaction_cleanup(struct vy_task *task)
+{
+	/* The iterator has been cleaned up in worker. */
+	if (task->wi != NULL)
+		task->wi->iface->close(task->wi);
+	task->wi = NULL;
+	struct vy_slice *slice, *next_slice;
+	rlist_foreach_entry_safe(slice, &task->cut_slices, in_range,
+				 next_slice)
+		vy_slice_delete(slice);
+	rlist_create(&task->cut_slices);
+}
+
+/**
+ * Replace the compacted range with new ranges, one per part.
+ * Each new range gets a slice of the run written for the part
+ * and slices of the range runs that weren't compacted cut to
+ * the part boundaries.
+ */
+static int
+vy_subcompaction_commit(struct vy_subcompaction *sub, struct vy_lsm *lsm)
+{
+	struct vy_scheduler *scheduler = sub->scheduler;
+	struct vy_range *range = sub->range;
+	struct vy_slice *first_slice = sub->first_slice;
+	struct vy_slice *last_slice = sub->last_slice;
+	double compaction_time = ev_monotonic_now(loop()) - sub->start_time;
+	struct vy_range *parts[VY_SUBCOMPACTION_MAX] = { NULL };
+	struct vy_disk_stmt_counter compaction_input;
+	struct vy_disk_stmt_counter compaction_output;
+	struct vy_slice *slice, *new_slice;
+	struct vy_run *run;
+
+	/* See the comment in vy_task_compaction_complete(). */
+	if (lsm->is_dropped) {
+		for (int i = 0; i < sub->part_count; i++)
+			vy_run_discard(sub->runs[i]);
+		goto out;
+	}
+
+	/*
+	 * Allocate new ranges and create slices for them.
+	 * vy_range_add_slice() adds a slice to the list head,
+	 * so to preserve the order of the slices list, we have
+	 * to iterate backward.
+	 */
+	for (int i = 0; i < sub->part_count; i++) {
+		struct vy_range *part = vy_range_new(vy_log_next_id(),
+						     sub->keys[i],
+						     sub->keys[i + 1],
+						     lsm->cmp_def);
+		if (part == NULL)
+			goto fail;
+		parts[i] = part;
+		bool is_compacted = false;
+		rlist_foreach_entry_reverse(slice, &range->slices, in_range) {
+			if (slice == last_slice)
+				is_compacted = true;
+			if (!is_compacted) {
+				if (vy_slice_cut(slice, vy_log_next_id(),
+						 part->begin, part->end,
+						 lsm->cmp_def, &new_slice) != 0)
+					goto fail;
+				if (new_slice != NULL)
+					vy_range_add_slice(part, new_slice);
+				continue;
+			}
+			if (slice != first_slice)
+				continue;
+			/*
+			 * Replace the compacted slices with a slice
+			 * of the run written for this part unless
+			 * the run is empty.
+			 */
+			is_compacted = false;
+			run = sub->runs[i];
+			if (vy_run_is_empty(run))
+				continue;
+			new_slice = vy_slice_new(vy_log_next_id(), run,
+						 vy_entry_none(), vy_entry_none(),
+						 lsm->cmp_def);
+			if (new_slice == NULL)
+				goto fail;
+			vy_range_add_slice(part, new_slice);
+		}
+	}
+
+	/*
+	 * Build the list of runs that became unused
+	 * as a result of compaction.
+	 */
+	RLIST_HEAD(unused_runs);
+	for (slice = first_slice; ; slice = rlist_next_entry(slice, in_range)) {
+		slice->run->compacted_slice_count++;
+		if (slice == last_slice)
+			break;
+	}
+	for (slice = first_slice; ; slice = rlist_next_entry(slice, in_range)) {
+		run = slice->run;
+		if (run->compacted_slice_count == run->slice_count)
+			rlist_add_entry(&unused_runs, run, in_unused);
+		slice->run->compacted_slice_count = 0;
+		if (slice == last_slice)
+			break;
+	}
+
+	/*
+	 * Log change in metadata.
+	 */
+	vy_log_tx_begin();
+	rlist_foreach_entry(slice, &range->slices, in_range)
+		vy_log_delete_slice(slice->id);
+	vy_log_delete_range(range->id);
+	rlist_foreach_entry(run, &unused_runs, in_unused)
+		vy_log_drop_run(run->id, VY_LOG_GC_LSN_CURRENT);
+	for (int i = 0; i < sub->part_count; i++) {
+		run = sub->runs[i];
+		if (!vy_run_is_empty(run))
+			vy_log_create_run(lsm->id, run->id, run->dump_lsn,
+					  run->dump_count);
+	}
+	for (int i = 0; i < sub->part_count; i++) {
+		struct vy_range *part = parts[i];
+		vy_log_insert_range(lsm->id, part->id,
+				    tuple_data_or_null(part->begin.stmt),
+				    tuple_data_or_null(part->end.stmt));
+		rlist_foreach_entry(slice, &part->slices, in_range)
+			vy_log_insert_slice(part->id, slice->run->id, slice->id,
+					    tuple_data_or_null(slice->begin.stmt),
+					    tuple_data_or_null(slice->end.stmt));
+	}
+	if (vy_log_tx_commit() < 0)
+		goto fail;
+
+	/* See the comment in vy_task_compaction_complete(). */
+	rlist_foreach_entry(run, &unused_runs, in_unused) {
+		if (run->dump_lsn > vy_log_signature() ||
+		    scheduler->run_env->initial_join)
+			vy_run_remove_files(lsm->env->path, lsm->space_id,
+					    lsm->index_id, run->id);
+	}
+
+	/*
+	 * Account the new runs if they are not empty,
+	 * otherwise discard them.
+	 */
+	vy_disk_stmt_counter_reset(&compaction_output);
+	for (int i = 0; i < sub->part_count; i++) {
+		run = sub->runs[i];
+		vy_disk_stmt_counter_add(&compaction_output, &run->count);
+		if (!vy_run_is_empty(run)) {
+			vy_lsm_add_run(lsm, run);
+			/* Drop the reference held by the task. */
+			vy_run_unref(run);
+		} else {
+			vy_run_discard(run);
+		}
+	}
+
+	/*
+	 * Replace the compacted range with the new ranges and
+	 * account compaction in LSM tree statistics.
+	 */
+	vy_disk_stmt_counter_reset(&compaction_input);
+	for (slice = first_slice; ; slice = rlist_next_entry(slice, in_range)) {
+		vy_disk_stmt_counter_add(&compaction_input, &slice->count);
+		if (slice == last_slice)
+			break;
+	}
+	vy_lsm_unacct_range(lsm, range);
+	assert(heap_node_is_stray(&range->heap_node));
+	vy_range_heap_insert(&lsm->range_heap, range);
+	vy_lsm_remove_range(lsm, range);
+	for (int i = 0; i < sub->part_count; i++) {
+		struct vy_range *part = parts[i];
+		part->n_compactions = range->n_compactions + 1;
+		vy_range_update_compaction_priority(part, &lsm->opts);
+		vy_range_update_dumps_per_compaction(part);
+		vy_lsm_add_range(lsm, part);
+		vy_lsm_acct_range(lsm, part);
+	}
+	lsm->range_tree_version++;
+	vy_lsm_acct_compaction(lsm, compaction_time,
+			       &compaction_input, &compaction_output);
+	scheduler->stat.compaction_input += compaction_input.bytes;
+	scheduler->stat.compaction_output += compaction_output.bytes;
+	scheduler->stat.compaction_time += compaction_time;
+
+	/*
+	 * Unaccount unused runs and delete the old range.
+	 */
+	rlist_foreach_entry(run, &unused_runs, in_unused)
+		vy_lsm_remove_run(lsm, run);
+	say_verbose("%s: completed compacting range %s in %d parts",
+		    vy_lsm_name(lsm), vy_range_str(range), sub->part_count);
+	rlist_foreach_entry(slice, &range->slices, in_range)
+		vy_slice_wait_pinned(slice);
+	vy_range_delete(range);
+	vy_scheduler_update_lsm(scheduler, lsm);
+	return 0;
+fail:
+	for (int i = 0; i < sub->part_count; i++) {
+		if (parts[i] != NULL)
+			vy_range_delete(parts[i]);
+	}
+	return -1;
+out:
+	assert(heap_node_is_stray(&range->heap_node));
+	vy_range_heap_insert(&lsm->range_heap, range);
+	vy_scheduler_update_lsm(scheduler, lsm);
+	return 0;
+}
+
+/** Discard the runs written by a failed subcompaction. */
+static void
+vy_subcompaction_abort(struct vy_subcompaction *sub, struct vy_lsm *lsm)
+{
+	struct vy_range *range = sub->range;
+	for (int i = 0; i < sub->part_count; i++)
+		vy_run_discard(sub->runs[i]);
+	assert(heap_node_is_stray(&range->heap_node));
+	vy_range_heap_insert(&lsm->range_heap, range);
+	vy_scheduler_update_lsm(sub->scheduler, lsm);
+}
+
+static int
+vy_task_subcompaction_complete(struct vy_task *task)
+{
+	struct vy_subcompaction *sub = task->subcompaction;
+	assert(sub->pending_count > 0);
+	/*
+	 * Delete the cut slices before committing, because they
+	 * pin the compacted runs, see vy_subcompaction_commit().
+	 */
+	vy_task_subcompaction_cleanup(task);
+	/* The last complete task commits the whole subcompaction. */
+	if (sub->pending_count == 1 && !sub->is_failed &&
+	    vy_subcompaction_commit(sub, task->lsm) != 0)
+		return -1;
+	if (--sub->pending_count == 0) {
+		if (sub->is_failed)
+			vy_subcompaction_abort(sub, task->lsm);
+		vy_subcompaction_delete(sub);
+	}
+	return 0;
+}
+
+static void
+vy_task_subcompaction_abort(struct vy_task *task)
+{
+	struct vy_subcompaction *sub = task->subcompaction;
+	struct vy_lsm *lsm = task->lsm;
+
+	vy_task_subcompaction_cleanup(task);
+
+	struct error *e = diag_last_error(&task->diag);
+	error_log(e);
+	say_error("%s: failed to compact range %s",
+		  vy_lsm_name(lsm), vy_range_str(sub->range));
+
+	sub->is_failed = true;
+	assert(sub->pending_count > 0);
+	if (--sub->pending_count == 0) {
+		vy_subcompaction_abort(sub, lsm);
+		vy_subcompaction_delete(sub);
+	}
+}
+
+/**
+ * Choose the boundaries of the parts a range compaction is split
+ * into. The boundaries are estimated with the page index of the
+ * biggest compacted run so that the parts are roughly equal.
+ * The number of parts stored in vy_subcompaction::part_count
+ * may be less than requested if there isn't enough pages in
+ * the run. Returns 0 on success, -1 on memory error.
+ */
+static int
+vy_subcompaction_split(struct vy_subcompaction *sub, struct vy_lsm *lsm,
+		       struct vy_slice *slice, int part_count)
+{
+	struct vy_range *range = sub->range;
+	struct vy_run *run = slice->run;
+	struct vy_entry begin = slice->begin.stmt != NULL ?
+				slice->begin : lsm->env->empty_key;
+	const char *prev_key = vy_run_page_info(run,
+					slice->first_page_no)->min_key;
+	int count = 0;
+	sub->keys[count++] = range->begin;
+	if (range->begin.stmt != NULL)
+		tuple_ref(range->begin.stmt);
+	for (int i = 1; i < part_count; i++) {
+		const char *key = vy_run_estimate_key_at(
+			run, lsm->cmp_def, begin,
+			slice->count.rows * i / part_count);
+		if (key == NULL)
+			break;
+		/* Page min keys grow so skip the page seen last. */
+		if (key == prev_key)
+			continue;
+		if (range->begin.stmt != NULL &&
+		    vy_entry_compare_with_raw_key(range->begin, key, HINT_NONE,
+						  lsm->cmp_def) >= 0)
+			continue;
+		if (range->end.stmt != NULL &&
+		    vy_entry_compare_with_raw_key(range->end, key, HINT_NONE,
+						  lsm->cmp_def) <= 0)
+			break;
+		struct vy_entry entry = vy_entry_key_from_msgpack(
+			lsm->env->key_format, lsm->cmp_def, key);
+		if (entry.stmt == NULL) {
+			/* Let vy_subcompaction_delete() free the keys. */
+			sub->part_count = count - 1;
+			return -1;
+		}
+		sub->keys[count++] = entry;
+		prev_key = key;
+	}
+	sub->keys[count] = range->end;
+	if (range->end.stmt != NULL)
+		tuple_ref(range->end.stmt);
+	sub->part_count = count;
+	return 0;
+}
+
+/**
+ * Try to split compaction of a range into parts compacted in
+ * parallel by idle compaction workers. Each part is going to
+ * become a separate range so the range is split only if the
+ * parts are at least as big as the target range size, otherwise
+ * they would be coalesced back.
+ *
+ * The compacted slices are passed in [first_slice, last_slice].
+ * On success sets @p_task to the first task of the subcompaction
+ * or to NULL if the range compaction can't be split. On failure
+ * all workers but @worker are returned to the pool.
+ */
+static int
+vy_task_subcompaction_new(struct vy_scheduler *scheduler,
+			  struct vy_worker *worker, struct vy_lsm *lsm,
+			  struct vy_range *range, struct vy_slice *first_slice,
+			  struct vy_slice *last_slice, int64_t dump_lsn,
+			  int32_t dump_count, bool is_last_level,
+			  struct vy_task **p_task)
+{
+	static struct vy_task_ops subcompaction_ops = {
+		.name = "compaction",
+		.execute = vy_task_compaction_execute,
+		.complete = vy_task_subcompaction_complete,
+		.abort = vy_task_subcompaction_abort,
+	};
+
+	*p_task = NULL;
+
+	struct vy_slice *slice, *max_slice = NULL;
+	struct vy_disk_stmt_counter input;
+	vy_disk_stmt_counter_reset(&input);
+	for (slice = first_slice; ; slice = rlist_next_entry(slice, in_range)) {
+		vy_disk_stmt_counter_add(&input, &slice->count);
+		if (max_slice == NULL ||
+		    slice->count.rows > max_slice->count.rows)
+			max_slice = slice;
+		if (slice == last_slice)
+			break;
+	}
+	int64_t part_count = input.bytes / vy_lsm_range_size(lsm);
+	part_count = MIN(part_count, scheduler->max_subcompactions);
+	part_count = MIN(part_count, VY_SUBCOMPACTION_MAX);
+	if (part_count < 2 || max_slice->count.pages < part_count)
+		return 0;
+
+	/* Grab idle workers, one per part. */
+	struct vy_worker *workers[VY_SUBCOMPACTION_MAX];
+	int worker_count = 0;
+	workers[worker_count++] = worker;
+	while (worker_count < part_count) {
+		struct vy_worker *w = vy_worker_pool_get(
+					&scheduler->compaction_pool);
+		if (w == NULL)
+			break;
+		workers[worker_count++] = w;
+	}
+	if (worker_count < 2)
+		return 0;
+
+	struct vy_subcompaction *sub = calloc(1, sizeof(*sub));
+	if (sub == NULL) {
+		diag_set(OutOfMemory, sizeof(*sub),
+			 "malloc", "struct vy_subcompaction");
+		goto err_sub;
+	}
+	sub->scheduler = scheduler;
+	sub->range = range;
+	sub->first_slice = first_slice;
+	sub->last_slice = last_slice;
+	sub->start_time = ev_monotonic_now(loop());
+	if (vy_subcompaction_split(sub, lsm, max_slice, worker_count) != 0)
+		goto err_split;
+	if (sub->part_count < 2) {
+		/* Not enough pages to split the range. */
+		vy_subcompaction_delete(sub);
+		for (int i = 1; i < worker_count; i++)
+			vy_worker_pool_put(workers[i]);
+		return 0;
+	}
+
+	int task_count = 0;
+	for (int i = 0; i < sub->part_count; i++) {
+		struct vy_task *task = vy_task_new(scheduler, workers[i], lsm,
+						   &subcompaction_ops);
+		if (task == NULL)
+			goto err_task;
+		sub->tasks[task_count++] = task;
+		task->subcompaction = sub;
+		task->range = range;
+		task->first_slice = first_slice;
+		task->last_slice = last_slice;
+		task->bloom_fpr = lsm->opts.bloom_fpr;
+		task->page_size = lsm->opts.page_size;
+		task->layout = lsm->run_layout;
+
+		struct vy_run *new_run = vy_run_prepare(scheduler->run_env,
+							lsm);
+		if (new_run == NULL)
+			goto err_task;
+		new_run->dump_lsn = dump_lsn;
+		new_run->dump_count = dump_count;
+		sub->runs[i] = new_run;
+		task->new_run = new_run;
+
+		task->wi = vy_write_iterator_new(task->cmp_def,
+					lsm->index_id == 0, is_last_level,
+					scheduler->read_views,
+					lsm->index_id > 0 ? NULL :
+					&task->deferred_delete_handler);
+		if (task->wi == NULL)
+			goto err_task;
+		for (slice = first_slice; ;
+		     slice = rlist_next_entry(slice, in_range)) {
+			struct vy_slice *cut;
+			if (vy_slice_cut(slice, vy_log_next_id(),
+					 sub->keys[i], sub->keys[i + 1],
+					 lsm->cmp_def, &cut) != 0)
+				goto err_task;
+			if (cut != NULL) {
+				rlist_add_tail_entry(&task->cut_slices, cut,
+						     in_range);
+				task->input_rows += cut->count.rows;
+				if (vy_write_iterator_new_slice(task->wi, cut,
+						lsm->disk_format) != 0)
+					goto err_task;
+			}
+			if (slice == last_slice)
+				break;
+		}
+	}
+	for (int i = sub->part_count; i < worker_count; i++)
+		vy_worker_pool_put(workers[i]);
+	sub->pending_count = sub->part_count;
+
+	/*
+	 * Remove the range we are going to compact from the heap
+	 * so that it doesn't get selected again.
+	 */
+	vy_range_heap_delete(&lsm->range_heap, range);
+	vy_scheduler_update_lsm(scheduler, lsm);
+
+	say_verbose("%s: started compacting range %s in %d parts, runs %d/%d",
+		    vy_lsm_name(lsm), vy_range_str(range), sub->part_count,
+		    range->compaction_priority, range->slice_count);
+	*p_task = sub->tasks[0];
+	return 0;
+
+err_task:
+	for (int i = 0; i < task_count; i++) {
+		struct vy_task *task = sub->tasks[i];
+		vy_task_subcompaction_cleanup(task);
+		if (task->new_run != NULL)
+			vy_run_discard(task->new_run);
+		vy_task_delete(task);
+	}
+err_split:
+	vy_subcompaction_delete(sub);
+err_sub:
+	/* The first worker is put back by the caller. */
+	for (int i = 1; i < worker_count; i++)
+		vy_worker_pool_put(workers[i]);
+	return -1;
+}
+
 static int
 vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 		       struct vy_lsm *lsm, struct vy_task **p_task)
 {
 	static struct vy_task_ops compaction_ops = {
+		.name = "compaction",
 		.execute = vy_task_compaction_execute,
 		.complete = vy_task_compaction_complete,
 		.abort = vy_task_compaction_abort,
@@ -1707,17 +2306,59 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 		return 0;
 	}
 
-	struct vy_task *task = vy_task_new(scheduler, worker, lsm,
-					   &compaction_ops);
+	/* Find the slices to compact. */
+	struct vy_slice *slice, *first_slice = NULL, *last_slice = NULL;
+	int64_t dump_lsn = -1;
+	int32_t dump_count = 0;
+	int n = range->compaction_priority;
+	rlist_foreach_entry(slice, &range->slices, in_range) {
+		dump_lsn = MAX(dump_lsn, slice->run->dump_lsn);
+		dump_count += slice->run->dump_count;
+		if (first_slice == NULL)
+			first_slice = slice;
+		last_slice = slice;
+		if (--n == 0)
+			break;
+	}
+	assert(n == 0);
+	assert(dump_lsn >= 0);
+	bool is_last_level = (range->compaction_priority == range->slice_count);
+	if (is_last_level)
+		dump_count -= last_slice->run->dump_count;
+	/*
+	 * Do not update dumps_per_compaction in case compaction
+	 * was triggered manually to avoid unexpected side effects,
+	 * such as splitting/coalescing ranges for no good reason.
+	 */
+	if (range->needs_compaction)
+		dump_count = last_slice->run->dump_count;
+
+	/*
+	 * If the range is big enough, try to split its compaction
+	 * into parts executed in parallel by idle workers.
+	 */
+	struct vy_task *task;
+	if (vy_task_subcompaction_new(scheduler, worker, lsm, range,
+				      first_slice, last_slice, dump_lsn,
+				      dump_count, is_last_level, &task) != 0)
+		goto err_task;
+	if (task != NULL) {
+		range->needs_compaction = false;
+		*p_task = task;
+		return 0;
+	}
+
+	task = vy_task_new(scheduler, worker, lsm, &compaction_ops);
 	if (task == NULL)
 		goto err_task;
 
 	struct vy_run *new_run = vy_run_prepare(scheduler->run_env, lsm);
 	if (new_run == NULL)
 		goto err_run;
+	new_run->dump_lsn = dump_lsn;
+	new_run->dump_count = dump_count;
 
 	struct vy_stmt_stream *wi;
-	bool is_last_level = (range->compaction_priority == range->slice_count);
 	wi = vy_write_iterator_new(task->cmp_def, lsm->index_id == 0,
 				   is_last_level, scheduler->read_views,
 				   lsm->index_id > 0 ? NULL :
@@ -1725,45 +2366,25 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	if (wi == NULL)
 		goto err_wi;
 
-	struct vy_slice *slice;
-	int32_t dump_count = 0;
-	int n = range->compaction_priority;
-	rlist_foreach_entry(slice, &range->slices, in_range) {
+	for (slice = first_slice; ; slice = rlist_next_entry(slice, in_range)) {
 		if (vy_write_iterator_new_slice(wi, slice,
 						lsm->disk_format) != 0)
 			goto err_wi_sub;
-		new_run->dump_lsn = MAX(new_run->dump_lsn,
-					slice->run->dump_lsn);
-		dump_count += slice->run->dump_count;
-		/* Remember the slices we are compacting. */
-		if (task->first_slice == NULL)
-			task->first_slice = slice;
-		task->last_slice = slice;
-
-		if (--n == 0)
+		task->input_rows += slice->count.rows;
+		if (slice == last_slice)
 			break;
 	}
-	assert(n == 0);
-	assert(new_run->dump_lsn >= 0);
-	if (range->compaction_priority == range->slice_count)
-		dump_count -= slice->run->dump_count;
-	/*
-	 * Do not update dumps_per_compaction in case compaction
-	 * was triggered manually to avoid unexpected side effects,
-	 * such as splitting/coalescing ranges for no good reason.
-	 */
-	if (range->needs_compaction)
-		new_run->dump_count = slice->run->dump_count;
-	else
-		new_run->dump_count = dump_count;
 
 	range->needs_compaction = false;
 
 	task->range = range;
+	task->first_slice = first_slice;
+	task->last_slice = last_slice;
 	task->new_run = new_run;
 	task->wi = wi;
 	task->bloom_fpr = lsm->opts.bloom_fpr;
 	task->page_size = lsm->opts.page_size;
+	task->layout = lsm->run_layout;
 
 	/*
 	 * Remove the range we are going to compact from the heap
@@ -1779,7 +2400,7 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	return 0;
 
 err_wi_sub:
-	task->wi->iface->close(wi);
+	wi->iface->close(wi);
 err_wi:
 	vy_run_discard(new_run);
 err_run:
@@ -2013,17 +2634,11 @@ vy_schedule(struct vy_scheduler *scheduler, struct vy_task **ptask)
 	if (vy_scheduler_peek_dump(scheduler, ptask) != 0)
 		goto fail;
 	if (*ptask != NULL)
-		goto found;
+		return 0;
 
 	if (vy_scheduler_peek_compaction(scheduler, ptask) != 0)
 		goto fail;
-	if (*ptask != NULL)
-		goto found;
-
-	/* no task to run */
-	return 0;
-found:
-	scheduler->stat.tasks_inprogress++;
+	/* *ptask is set to NULL if there's no task to run. */
 	return 0;
 fail:
 	assert(!diag_is_empty(diag_get()));
@@ -2032,6 +2647,16 @@ vy_schedule(struct vy_scheduler *scheduler, struct vy_task **ptask)
 
 }
 
+/** Send a task to the worker it's assigned to for execution. */
+static void
+vy_scheduler_start_task(struct vy_scheduler *scheduler, struct vy_task *task)
+{
+	scheduler->stat.tasks_inprogress++;
+	rlist_add_tail_entry(&scheduler->active_tasks, task, in_active);
+	cmsg_init(&task->cmsg, vy_task_execute_route);
+	cpipe_push(&task->worker->worker_pipe, &task->cmsg);
+}
+
 static int
 vy_task_complete(struct vy_task *task)
 {
@@ -2039,6 +2664,7 @@ vy_task_complete(struct vy_task *task)
 
 	assert(scheduler->stat.tasks_inprogress > 0);
 	scheduler->stat.tasks_inprogress--;
+	rlist_del_entry(task, in_active);
 
 	struct diag *diag = &task->diag;
 	if (task->is_failed) {
@@ -2130,8 +2756,16 @@ vy_scheduler_f(va_list va)
 		}
 
 		/* Queue the task for execution. */
-		cmsg_init(&task->cmsg, vy_task_execute_route);
-		cpipe_push(&task->worker->worker_pipe, &task->cmsg);
+		struct vy_subcompaction *sub = task->subcompaction;
+		if (sub != NULL) {
+			/* Start all parts of the subcompaction at once. */
+			assert(sub->tasks[0] == task);
+			for (int i = 0; i < sub->part_count; i++)
+				vy_scheduler_start_task(scheduler,
+							sub->tasks[i]);
+		} else {
+			vy_scheduler_start_task(scheduler, task);
+		}
 
 		fiber_reschedule();
 		continue;
@@ -78,8 +78,18 @@ struct vy_scheduler {
 	struct vy_worker_pool dump_pool;
 	/** Pool of threads for performing background compactions. */
 	struct vy_worker_pool compaction_pool;
+	/**
+	 * Max number of parts compaction of a range may be split
+	 * into, see box.cfg.vinyl_max_subcompactions.
+	 */
+	int max_subcompactions;
 	/** Queue of processed tasks, linked by vy_task::in_processed. */
 	struct stailq processed_tasks;
+	/**
+	 * List of tasks that are currently being executed by
+	 * workers, linked by vy_task::in_active.
+	 */
+	struct rlist active_tasks;
 	/**
 	 * Heap of LSM trees, ordered by dump priority,
 	 * linked by vy_lsm::in_dump.
@@ -160,6 +170,33 @@ struct vy_scheduler {
 	struct vy_quota *quota;
 };
 
+/** Progress of a task that is being executed by a worker. */
+struct vy_task_progress {
+	/** Name of the worker thread executing the task. */
+	const char *worker;
+	/** Task type: "dump" or "compaction". */
+	const char *type;
+	/** LSM tree the task is for. */
+	struct vy_lsm *lsm;
+	/** Number of statements the task has to process (estimated). */
+	int64_t input_rows;
+	/** Number of statements written by the task so far. */
+	int64_t output_rows;
+	/** Time elapsed since the task was scheduled, in seconds. */
+	double time;
+};
+
+typedef void
+(*vy_task_progress_f)(const struct vy_task_progress *progress, void *arg);
+
+/**
+ * Call @a cb for each task that is currently being executed
+ * by a worker.
+ */
+void
+vy_scheduler_foreach_task(struct vy_scheduler *scheduler,
+			  vy_task_progress_f cb, void *arg);
+
 /**
  * Return true if memory dump is in progress, i.e. there are
  * in-memory trees that are being dumped right now or should
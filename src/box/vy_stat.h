@@ -94,6 +94,19 @@ struct vy_run_iterator_stat {
 	 * prevent a disk read.
 	 */
 	int64_t bloom_miss;
+	/** Number of pages found in the page cache. */
+	int64_t page_cache_hit;
+	/** Number of pages not found in the page cache. */
+	int64_t page_cache_miss;
+	/** Number of pages read ahead. */
+	int64_t readahead_pages;
+	/** Number of pages read ahead and then used by the iterator. */
+	int64_t readahead_hit;
+	/**
+	 * Number of times the iterator had to wait for pages
+	 * that were being read ahead.
+	 */
+	int64_t readahead_wait;
 	/**
 	 * Number of statements actually read from the disk.
 	 * It may be greater than the number of statements
@@ -751,58 +751,218 @@ vy_stmt_encode_secondary(struct tuple *value, struct key_def *cmp_def,
 	return 0;
 }
 
-struct tuple *
-vy_stmt_decode(struct xrow_header *xrow, struct tuple_format *format)
+/**
+ * Create a statement of the given type read from a run file.
+ * @a data is a tuple or a key, for DELETE, and @a ops are UPSERT
+ * operations.
+ */
+static struct tuple *
+vy_stmt_new_decoded(struct tuple_format *format, enum iproto_type type,
+		    const char *data, const char *data_end,
+		    const char *ops, const char *ops_end)
 {
-	ERROR_INJECT_COUNTDOWN(ERRINJ_VY_STMT_DECODE_COUNTDOWN, {
-		diag_set(ClientError, ER_INJECTION,
-			 "vinyl statement decode");
-		return NULL;
-	});
 	struct vy_stmt_env *env = format->engine;
-	struct request request;
-	uint64_t key_map = dml_request_key_map(xrow->type);
-	key_map &= ~(1ULL << IPROTO_SPACE_ID); /* space_id is optional */
-	if (xrow_decode_dml(xrow, &request, key_map) != 0)
-		return NULL;
-	struct tuple *stmt = NULL;
-	struct iovec ops;
-	switch (request.type) {
+	struct iovec ops_iov;
+	switch (type) {
 	case IPROTO_DELETE:
 		/* Always use key format for DELETE statements. */
-		stmt = vy_stmt_new_with_ops(env->key_format,
-					    request.key, request.key_end,
+		return vy_stmt_new_with_ops(env->key_format, data, data_end,
 					    NULL, 0, IPROTO_DELETE);
-		break;
 	case IPROTO_INSERT:
 	case IPROTO_REPLACE:
-		stmt = vy_stmt_new_with_ops(format, request.tuple,
-					    request.tuple_end,
-					    NULL, 0, request.type);
-		break;
+		return vy_stmt_new_with_ops(format, data, data_end,
+					    NULL, 0, type);
 	case IPROTO_UPSERT:
-		ops.iov_base = (char *)request.ops;
-		ops.iov_len = request.ops_end - request.ops;
-		stmt = vy_stmt_new_upsert(format, request.tuple,
-					  request.tuple_end, &ops, 1);
-		break;
+		ops_iov.iov_base = (char *)ops;
+		ops_iov.iov_len = ops_end - ops;
+		return vy_stmt_new_upsert(format, data, data_end,
+					  &ops_iov, 1);
 	default:
 		/* TODO: report filename. */
 		diag_set(ClientError, ER_INVALID_RUN_FILE,
 			 tt_sprintf("Can't decode statement: "
 				    "unknown request type %u",
-				    (unsigned)request.type));
+				    (unsigned)type));
 		return NULL;
 	}
+}
 
+struct tuple *
+vy_stmt_decode(struct xrow_header *xrow, struct tuple_format *format)
+{
+	ERROR_INJECT_COUNTDOWN(ERRINJ_VY_STMT_DECODE_COUNTDOWN, {
+		diag_set(ClientError, ER_INJECTION,
+			 "vinyl statement decode");
+		return NULL;
+	});
+	struct request request;
+	uint64_t key_map = dml_request_key_map(xrow->type);
+	key_map &= ~(1ULL << IPROTO_SPACE_ID); /* space_id is optional */
+	if (xrow_decode_dml(xrow, &request, key_map) != 0)
+		return NULL;
+	struct tuple *stmt;
+	if (request.type == IPROTO_DELETE) {
+		stmt = vy_stmt_new_decoded(format, IPROTO_DELETE,
+					   request.key, request.key_end,
+					   NULL, NULL);
+	} else {
+		stmt = vy_stmt_new_decoded(format, request.type,
+					   request.tuple, request.tuple_end,
+					   request.ops, request.ops_end);
+	}
 	if (stmt == NULL)
-		return NULL; /* OOM */
+		return NULL;
 
 	vy_stmt_meta_decode(&request, stmt);
 	vy_stmt_set_lsn(stmt, xrow->lsn);
 	return stmt;
 }
 
+int
+vy_stmt_encode_columnar(struct tuple *value, struct key_def *key_def,
+			bool is_primary, int multikey_idx,
+			char **header, char **header_end,
+			const char **data, const char **data_end)
+{
+	enum iproto_type type = vy_stmt_type(value);
+	uint32_t size;
+	const char *extra = NULL;
+	uint32_t extra_size = 0;
+	*data = NULL;
+	*data_end = NULL;
+	if (!is_primary || type != IPROTO_DELETE) {
+		if (is_primary || vy_stmt_is_key(value)) {
+			*data = type == IPROTO_UPSERT ?
+				vy_upsert_data_range(value, &size) :
+				tuple_data_range(value, &size);
+		} else {
+			*data = tuple_extract_key(value, key_def,
+						  multikey_idx, &size);
+		}
+		if (*data == NULL)
+			return -1;
+		*data_end = *data + size;
+	}
+	if (is_primary && type == IPROTO_DELETE) {
+		/* Primary index DELETE is stored as a key. */
+		extra = vy_stmt_is_key(value) ?
+			tuple_data_range(value, &extra_size) :
+			tuple_extract_key(value, key_def, MULTIKEY_NONE,
+					  &extra_size);
+		if (extra == NULL)
+			return -1;
+	} else if (type == IPROTO_UPSERT) {
+		assert(is_primary);
+		extra = vy_stmt_upsert_ops(value, &extra_size);
+	}
+	const char *pos = *data;
+	uint32_t field_count = pos != NULL ? mp_decode_array(&pos) : 0;
+	uint8_t flags = vy_stmt_persistent_flags(value, is_primary);
+	int64_t lsn = vy_stmt_lsn(value);
+
+	size = mp_sizeof_array(5) + mp_sizeof_uint(type) +
+	       mp_sizeof_uint(lsn) + mp_sizeof_uint(flags) +
+	       mp_sizeof_uint(field_count) + extra_size;
+	char *buf = region_alloc(&fiber()->gc, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "region", "statement header");
+		return -1;
+	}
+	char *wpos = mp_encode_array(buf, extra != NULL ? 5 : 4);
+	wpos = mp_encode_uint(wpos, type);
+	wpos = mp_encode_uint(wpos, lsn);
+	wpos = mp_encode_uint(wpos, flags);
+	wpos = mp_encode_uint(wpos, field_count);
+	if (extra != NULL) {
+		memcpy(wpos, extra, extra_size);
+		wpos += extra_size;
+	}
+	assert(wpos <= buf + size);
+	*header = buf;
+	*header_end = wpos;
+	return 0;
+}
+
+int
+vy_stmt_columnar_header_decode(const char **data,
+			       struct vy_stmt_columnar_header *header)
+{
+	const char *pos = *data;
+	uint32_t count;
+	if (mp_typeof(*pos) != MP_ARRAY ||
+	    (count = mp_decode_array(&pos)) < 4)
+		goto error;
+	for (int i = 0; i < 4; i++) {
+		if (mp_typeof(*pos) != MP_UINT)
+			goto error;
+		uint64_t value = mp_decode_uint(&pos);
+		switch (i) {
+		case 0:
+			header->type = value;
+			break;
+		case 1:
+			header->lsn = value;
+			break;
+		case 2:
+			header->flags = value;
+			break;
+		case 3:
+			header->field_count = value;
+			break;
+		}
+	}
+	header->extra = NULL;
+	header->extra_end = NULL;
+	if (count > 4) {
+		header->extra = pos;
+		mp_next(&pos);
+		header->extra_end = pos;
+		if (mp_typeof(*header->extra) != MP_ARRAY ||
+		    (header->type != IPROTO_DELETE &&
+		     header->type != IPROTO_UPSERT))
+			goto error;
+	}
+	for (uint32_t i = 5; i < count; i++)
+		mp_next(&pos);
+	*data = pos;
+	return 0;
+error:
+	diag_set(ClientError, ER_INVALID_RUN_FILE,
+		 "Can't decode statement header");
+	return -1;
+}
+
+struct tuple *
+vy_stmt_decode_columnar(const struct vy_stmt_columnar_header *header,
+			const char *data, const char *data_end,
+			struct tuple_format *format)
+{
+	ERROR_INJECT_COUNTDOWN(ERRINJ_VY_STMT_DECODE_COUNTDOWN, {
+		diag_set(ClientError, ER_INJECTION,
+			 "vinyl statement decode");
+		return NULL;
+	});
+	struct tuple *stmt;
+	if (header->type == IPROTO_DELETE && header->extra != NULL) {
+		stmt = vy_stmt_new_decoded(format, IPROTO_DELETE,
+					   header->extra, header->extra_end,
+					   NULL, NULL);
+	} else if (header->type == IPROTO_UPSERT && header->extra == NULL) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 "Can't decode statement: missing UPSERT operations");
+		return NULL;
+	} else {
+		stmt = vy_stmt_new_decoded(format, header->type,
+					   data, data_end, header->extra,
+					   header->extra_end);
+	}
+	if (stmt == NULL)
+		return NULL;
+	vy_stmt_set_flags(stmt, header->flags);
+	vy_stmt_set_lsn(stmt, header->lsn);
+	return stmt;
+}
+
 int
 vy_stmt_snprint(char *buf, int size, struct tuple *stmt)
 {
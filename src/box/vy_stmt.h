@@ -730,6 +730,75 @@ vy_stmt_encode_secondary(struct tuple *value, struct key_def *cmp_def,
 struct tuple *
 vy_stmt_decode(struct xrow_header *xrow, struct tuple_format *format);
 
+/**
+ * Header of a statement stored in a columnar run page.
+ *
+ * Fields of statements stored in a columnar page are split into
+ * column chunks, one per field, while the rest of statement data
+ * is stored in the header, which is encoded as a MsgPack array:
+ *
+ *   [type, lsn, flags, field_count(, extra)]
+ *
+ * where field_count is the number of fields stored in column chunks
+ * and extra is the key of a primary index DELETE (which has no fields
+ * stored in columns) or UPSERT operations.
+ */
+struct vy_stmt_columnar_header {
+	/** Statement type. */
+	enum iproto_type type;
+	/** Statement LSN. */
+	int64_t lsn;
+	/** Persistent statement flags. */
+	uint8_t flags;
+	/** Number of fields stored in column chunks. */
+	uint32_t field_count;
+	/** Primary index DELETE key or UPSERT operations or NULL. */
+	const char *extra;
+	/** End of @extra. */
+	const char *extra_end;
+};
+
+/**
+ * Encode a statement for a columnar run page.
+ *
+ * @param value statement to encode
+ * @param key_def key definition
+ * @param is_primary set if the statement is written to a primary index
+ * @param multikey_idx multikey index hint
+ * @param[out] header statement header allocated on the fiber region
+ * @param[out] header_end end of @a header
+ * @param[out] data MsgPack array of fields to store in column chunks
+ * @param[out] data_end end of @a data
+ *
+ * @retval 0 if OK
+ * @retval -1 if error
+ */
+int
+vy_stmt_encode_columnar(struct tuple *value, struct key_def *key_def,
+			bool is_primary, int multikey_idx,
+			char **header, char **header_end,
+			const char **data, const char **data_end);
+
+/**
+ * Decode a statement header stored in a columnar run page and advance
+ * @a data. Returns -1 and sets diag if the header is malformed.
+ */
+int
+vy_stmt_columnar_header_decode(const char **data,
+			       struct vy_stmt_columnar_header *header);
+
+/**
+ * Reconstruct a vinyl statement stored in a columnar run page from
+ * its header and fields, given as a MsgPack array.
+ *
+ * @retval stmt on success
+ * @retval NULL on error
+ */
+struct tuple *
+vy_stmt_decode_columnar(const struct vy_stmt_columnar_header *header,
+			const char *data, const char *data_end,
+			struct tuple_format *format);
+
 /**
  * Format a statement into string.
  * Example: REPLACE([1, 2, "string"], lsn=48)
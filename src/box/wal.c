@@ -29,6 +29,7 @@
  * SUCH DAMAGE.
  */
 #include "wal.h"
+#include "wal_tail.h"
 
 #include "fiber.h"
 #include "fio.h"
@@ -41,9 +42,13 @@
 #include "vy_log.h"
 #include "cbus.h"
 #include "coio_task.h"
+#include "coio_uring.h"
 #include "replication.h"
 #include "iproto_constants.h"
 #include "watcher.h"
+#include "info/info.h"
+#include "clock.h"
+#include "latency.h"
 
 enum {
 	/**
@@ -55,6 +60,11 @@ enum {
 	 * latency. 1 MB seems to be a well balanced choice.
 	 */
 	WAL_FALLOCATE_LEN = 1024 * 1024,
+	/**
+	 * Max number of written blocks kept by the WAL thread
+	 * for reuse if the compression pool is used.
+	 */
+	WAL_BLOCK_CACHE_SIZE = 16,
 };
 
 const char *wal_mode_STRS[WAL_MODE_MAX] = {
@@ -73,6 +83,50 @@ wal_write_async(struct journal *, struct journal_entry *);
 static int
 wal_write_none_async(struct journal *, struct journal_entry *);
 
+/**
+ * WAL writer statistics. Updated in tx when a batch written
+ * by the WAL thread returns back.
+ */
+struct wal_writer_stat {
+	/** Number of batches sent to WAL and not completed yet. */
+	int64_t queue_batches;
+	/** Number of rows in the batches not completed yet. */
+	int64_t queue_rows;
+	/** Number of batches written since the last reset. */
+	int64_t batches;
+	/** Number of rows written since the last reset. */
+	int64_t rows;
+	/** Number of bytes written since the last reset. */
+	int64_t bytes;
+	/**
+	 * Time a batch spends in the tx-wal pipe before the WAL
+	 * thread starts writing it.
+	 */
+	struct latency queue_latency;
+	/** Time the WAL thread spends writing a batch. */
+	struct latency write_latency;
+	/** Time between submitting a batch and its completion. */
+	struct latency commit_latency;
+};
+
+/**
+ * A thread of the WAL compression pool. Compression threads
+ * checksum and compress blocks of rows encoded by the WAL thread,
+ * see wal_write_group().
+ */
+struct wal_compressor {
+	/** The compression thread. */
+	struct cord cord;
+	/** Pipe from the WAL thread to the compression thread. */
+	struct cpipe compress_pipe;
+	/** Pipe from the compression thread to the WAL thread. */
+	struct cpipe wal_pipe;
+	/** Route of blocks sent to the compression thread. */
+	struct cmsg_hop route[2];
+	/** zstd context of the compression thread or NULL. */
+	ZSTD_CCtx *zctx;
+};
+
 /*
  * WAL writer - maintain a Write Ahead Log for every change
  * in the data state.
@@ -107,6 +161,8 @@ struct wal_writer
 	 * rolled back too.
 	 */
 	struct journal_entry *last_entry;
+	/** Write pipeline statistics, see box.stat.wal(). */
+	struct wal_writer_stat stat;
 	/* ----------------- wal ------------------- */
 	/** A setting from instance configuration - wal_max_size */
 	int64_t wal_max_size;
@@ -158,6 +214,12 @@ struct wal_writer
 	bool checkpoint_triggered;
 	/** The current WAL file. */
 	struct xlog current_wal;
+	/**
+	 * Number of rows written to the current WAL file or -1 if
+	 * unknown, in which case written rows aren't stored in the
+	 * WAL tail, see wal_tail.h.
+	 */
+	int64_t current_wal_row_count;
 	/**
 	 * Used if there was a WAL I/O error and we need to
 	 * keep adding all incoming requests to the rollback
@@ -170,6 +232,41 @@ struct wal_writer
 	 * Used for replication relays.
 	 */
 	struct rlist watchers;
+	/** Fiber processing the 'wal' endpoint, see wal_writer_loop(). */
+	struct fiber *loop_fiber;
+	/** Set if the loop fiber waits for new messages. */
+	bool loop_is_idle;
+	/** Set if new messages arrived to the 'wal' endpoint. */
+	bool loop_has_input;
+	/**
+	 * Number of threads in the compression pool, a setting
+	 * from instance configuration - wal_compression_threads.
+	 * If 0, the pool isn't used and the WAL thread compresses
+	 * and writes each batch on its own.
+	 */
+	int compress_pool_size;
+	/** Compression threads. */
+	struct wal_compressor *compress_pool;
+	/** Index of the compression thread to use next. */
+	int next_compressor;
+	/** Endpoint receiving blocks prepared by the pool. */
+	struct cbus_endpoint compress_endpoint;
+	/** Fiber waiting for the pool to return a block or NULL. */
+	struct fiber *compress_waiter;
+	/** Blocks sent to the pool and not written yet, in order. */
+	struct stailq blocks;
+	/** Written blocks kept for reuse. */
+	struct stailq free_blocks;
+	/** Number of blocks in free_blocks. */
+	int free_block_count;
+	/**
+	 * Set if a zstd dictionary is trained for each new WAL
+	 * file, a setting from instance configuration -
+	 * wal_compression_dict.
+	 */
+	bool compression_dict;
+	/** Samples of rows written to the current WAL file. */
+	struct xlog_dict_builder dict_builder;
 };
 
 struct wal_msg {
@@ -185,6 +282,55 @@ struct wal_msg {
 	struct stailq rollback;
 	/** vclock after the batch processed. */
 	struct vclock vclock;
+	/** Number of rows in the batch. */
+	int64_t n_rows;
+	/** Number of bytes written to disk for the batch. */
+	int64_t written_size;
+	/** Time when the batch was pushed to the WAL thread. */
+	double submit_time;
+	/** Time when the WAL thread started writing the batch. */
+	double write_start_time;
+	/** Time when the WAL thread finished writing the batch. */
+	double write_end_time;
+	/**
+	 * Set if the batch has been written together with the
+	 * batches preceding it, see wal_writer_process().
+	 */
+	bool is_written;
+	/** Link in a group of batches, see wal_write_group(). */
+	struct stailq_entry in_group;
+};
+
+/** A block of WAL rows sent to the compression pool. */
+struct wal_block {
+	struct xlog_block base;
+	/** Message sending the block to the pool and back. */
+	struct cmsg msg;
+	/** Compression thread preparing the block. */
+	struct wal_compressor *compressor;
+	/** Set when the compression thread is done with the block. */
+	bool is_ready;
+	/** Batch of the last journal entry stored in the block. */
+	struct wal_msg *batch;
+	/** The last journal entry stored in the block. */
+	struct journal_entry *last_entry;
+	/** vclock diff of the group after the last entry. */
+	struct vclock vclock_diff;
+};
+
+/**
+ * State of a group of batches written with the compression pool,
+ * see wal_write_group().
+ */
+struct wal_group {
+	/** Batches of the group linked by wal_msg::in_group. */
+	struct stailq batches;
+	/** Batch of the last entry written to disk or NULL. */
+	struct wal_msg *last_batch;
+	/** The last entry written to disk or NULL. */
+	struct journal_entry *last_entry;
+	/** vclock diff of the group after the last written entry. */
+	struct vclock vclock_diff;
 };
 
 /**
@@ -229,6 +375,12 @@ wal_msg_create(struct wal_msg *batch)
 	stailq_create(&batch->commit);
 	stailq_create(&batch->rollback);
 	vclock_create(&batch->vclock);
+	batch->n_rows = 0;
+	batch->written_size = 0;
+	batch->submit_time = clock_monotonic();
+	batch->write_start_time = batch->submit_time;
+	batch->write_end_time = batch->submit_time;
+	batch->is_written = false;
 }
 
 static struct wal_msg *
@@ -237,9 +389,12 @@ wal_msg(struct cmsg *msg)
 	return msg->route == wal_request_route ? (struct wal_msg *) msg : NULL;
 }
 
-/** Write a request to a log in a single transaction. */
-static ssize_t
-xlog_write_entry(struct xlog *l, struct journal_entry *entry)
+/**
+ * Encode a request to a log buffer in a single transaction.
+ * Returns 0 on success, -1 on error.
+ */
+static int
+xlog_encode_entry(struct xlog *l, struct journal_entry *entry)
 {
 	/*
 	 * Iterate over request rows (tx statements)
@@ -262,6 +417,15 @@ xlog_write_entry(struct xlog *l, struct journal_entry *entry)
 			return -1;
 		}
 	}
+	return 0;
+}
+
+/** Write a request to a log in a single transaction. */
+static ssize_t
+xlog_write_entry(struct xlog *l, struct journal_entry *entry)
+{
+	if (xlog_encode_entry(l, entry) != 0)
+		return -1;
 	return xlog_tx_commit(l);
 }
 
@@ -372,6 +536,18 @@ tx_complete_batch(struct cmsg *msg)
 		stailq_concat(&writer->rollback, &batch->rollback);
 		tx_complete_rollback();
 	}
+	struct wal_writer_stat *stat = &writer->stat;
+	stat->queue_batches--;
+	stat->queue_rows -= batch->n_rows;
+	stat->batches++;
+	stat->rows += batch->n_rows;
+	stat->bytes += batch->written_size;
+	latency_collect(&stat->queue_latency,
+			batch->write_start_time - batch->submit_time);
+	latency_collect(&stat->write_latency,
+			batch->write_end_time - batch->write_start_time);
+	latency_collect(&stat->commit_latency,
+			clock_monotonic() - batch->submit_time);
 	/* Update the tx vclock to the latest written by wal. */
 	vclock_copy(writer->instance_vclock, &batch->vclock);
 	tx_schedule_queue(&batch->commit);
@@ -408,6 +584,35 @@ tx_notify_checkpoint(struct cmsg *msg)
 	free(msg);
 }
 
+static int
+wal_writer_stat_create(struct wal_writer_stat *stat)
+{
+	memset(stat, 0, sizeof(*stat));
+	if (latency_create(&stat->queue_latency) != 0)
+		goto fail_queue;
+	if (latency_create(&stat->write_latency) != 0)
+		goto fail_write;
+	if (latency_create(&stat->commit_latency) != 0)
+		goto fail_commit;
+	return 0;
+fail_commit:
+	latency_destroy(&stat->write_latency);
+fail_write:
+	latency_destroy(&stat->queue_latency);
+fail_queue:
+	diag_set(OutOfMemory, sizeof(struct latency), "malloc",
+		 "struct latency");
+	return -1;
+}
+
+static void
+wal_writer_stat_destroy(struct wal_writer_stat *stat)
+{
+	latency_destroy(&stat->queue_latency);
+	latency_destroy(&stat->write_latency);
+	latency_destroy(&stat->commit_latency);
+}
+
 /**
  * Initialize WAL writer context. Even though it's a singleton,
  * encapsulate the details just in case we may use
@@ -416,7 +621,7 @@ tx_notify_checkpoint(struct cmsg *msg)
 static void
 wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 		  const char *wal_dirname, int64_t wal_max_size,
-		  double wal_retention_period,
+		  double wal_retention_period, int compression_threads,
 		  const struct tt_uuid *instance_uuid,
 		  struct vclock *instance_vclock,
 		  struct vclock *checkpoint_vclock,
@@ -426,6 +631,8 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 	writer->instance_vclock = instance_vclock;
 	writer->wal_mode = wal_mode;
 	writer->wal_max_size = wal_max_size;
+	writer->compress_pool_size = wal_mode == WAL_NONE ?
+				     0 : compression_threads;
 
 	journal_create(&writer->base,
 		       wal_mode == WAL_NONE ?
@@ -433,6 +640,7 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 
 	struct xlog_opts opts = xlog_opts_default;
 	opts.sync_is_async = true;
+	opts.write_with_uring = true;
 	xdir_create(&writer->wal_dir, wal_dirname, "XLOG", instance_uuid,
 		    &opts);
 	writer->wal_dir.force_recovery = true;
@@ -443,8 +651,11 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 	 */
 	xdir_set_retention_period(&writer->wal_dir, wal_retention_period);
 	xlog_clear(&writer->current_wal);
+	writer->current_wal_row_count = -1;
 	if (wal_mode == WAL_FSYNC)
 		writer->wal_dir.open_wflags |= O_SYNC;
+	writer->compression_dict = false;
+	xlog_dict_builder_create(&writer->dict_builder);
 
 	stailq_create(&writer->rollback);
 	writer->is_in_rollback = false;
@@ -471,6 +682,8 @@ static void
 wal_writer_destroy(struct wal_writer *writer)
 {
 	xdir_destroy(&writer->wal_dir);
+	xlog_dict_builder_destroy(&writer->dict_builder);
+	wal_writer_stat_destroy(&writer->stat);
 }
 
 /** WAL writer thread routine. */
@@ -502,6 +715,8 @@ wal_open_f(struct cbus_call_msg *msg)
 			sum_already_on_disk += (uint64_t)attr.st_size;
 	}
 	writer->checkpoint_wal_size = sum_already_on_disk;
+	/* We don't know how many rows there are in the file. */
+	writer->current_wal_row_count = -1;
 	return xlog_open(&writer->current_wal, path, &writer->wal_dir.opts);
 }
 
@@ -567,7 +782,7 @@ wal_open(struct wal_writer *writer)
 int
 wal_init(enum wal_mode wal_mode, const char *wal_dirname,
 	 int64_t wal_max_size, double wal_retention_period,
-	 const struct tt_uuid *instance_uuid,
+	 int compression_threads, const struct tt_uuid *instance_uuid,
 	 struct vclock *instance_vclock,
 	 struct vclock *checkpoint_vclock,
 	 wal_on_garbage_collection_f on_garbage_collection,
@@ -575,10 +790,13 @@ wal_init(enum wal_mode wal_mode, const char *wal_dirname,
 {
 	/* Initialize the state. */
 	struct wal_writer *writer = &wal_writer_singleton;
+	if (wal_writer_stat_create(&writer->stat) != 0)
+		return -1;
+	wal_tail_init();
 	wal_writer_create(writer, wal_mode, wal_dirname, wal_max_size,
-			  wal_retention_period, instance_uuid, instance_vclock,
-			  checkpoint_vclock, on_garbage_collection,
-			  on_checkpoint_threshold);
+			  wal_retention_period, compression_threads,
+			  instance_uuid, instance_vclock, checkpoint_vclock,
+			  on_garbage_collection, on_checkpoint_threshold);
 
 	/* Start WAL thread. */
 	if (cord_costart(&writer->cord, "wal", wal_writer_f, NULL) != 0)
@@ -631,6 +849,7 @@ wal_free(void)
 	trigger_destroy(&wal_on_write);
 
 	wal_writer_destroy(writer);
+	wal_tail_free();
 }
 
 struct wal_vclock_msg {
@@ -818,6 +1037,119 @@ wal_set_queue_max_size(int64_t size)
 	journal_queue_set_max_size(size);
 }
 
+struct wal_set_compression_level_msg {
+	struct cbus_call_msg base;
+	int compression_level;
+};
+
+static int
+wal_set_compression_level_f(struct cbus_call_msg *data)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	struct wal_set_compression_level_msg *msg;
+	msg = (struct wal_set_compression_level_msg *)data;
+	writer->wal_dir.opts.compression_level = msg->compression_level;
+	/* Apply the new level to the WAL file being written, too. */
+	if (xlog_is_open(&writer->current_wal)) {
+		writer->current_wal.opts.compression_level =
+			msg->compression_level;
+	}
+	return 0;
+}
+
+void
+wal_set_compression_level(int level)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	if (writer->wal_mode == WAL_NONE)
+		return;
+	struct wal_set_compression_level_msg msg;
+	msg.compression_level = level;
+	cbus_call(&writer->wal_pipe, &writer->tx_prio_pipe, &msg.base,
+		  wal_set_compression_level_f);
+}
+
+struct wal_set_compression_dict_msg {
+	struct cbus_call_msg base;
+	bool compression_dict;
+};
+
+static int
+wal_set_compression_dict_f(struct cbus_call_msg *data)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	struct wal_set_compression_dict_msg *msg;
+	msg = (struct wal_set_compression_dict_msg *)data;
+	writer->compression_dict = msg->compression_dict;
+	if (!writer->compression_dict)
+		xlog_dict_builder_reset(&writer->dict_builder);
+	return 0;
+}
+
+void
+wal_set_compression_dict(bool compression_dict)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	if (writer->wal_mode == WAL_NONE)
+		return;
+	struct wal_set_compression_dict_msg msg;
+	msg.compression_dict = compression_dict;
+	cbus_call(&writer->wal_pipe, &writer->tx_prio_pipe, &msg.base,
+		  wal_set_compression_dict_f);
+}
+
+static void
+wal_stat_latency(struct info_handler *h, const char *name,
+		 struct latency *latency)
+{
+	info_table_begin(h, name);
+	info_append_double(h, "p50", latency_get(latency, 50));
+	info_append_double(h, "p90", latency_get(latency, 90));
+	info_append_double(h, "p99", latency_get(latency, 99));
+	info_table_end(h);
+}
+
+void
+wal_stat(struct info_handler *h)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	struct wal_writer_stat *stat = &writer->stat;
+	info_begin(h);
+	/* Statistics are allocated in wal_init(). */
+	if (stat->commit_latency.histogram == NULL)
+		goto out;
+	info_table_begin(h, "queue");
+	info_append_int(h, "batches", stat->queue_batches);
+	info_append_int(h, "rows", stat->queue_rows);
+	info_append_int(h, "bytes", journal_queue.size);
+	info_table_end(h); /* queue */
+	info_append_int(h, "batches", stat->batches);
+	info_append_int(h, "rows", stat->rows);
+	info_append_int(h, "bytes", stat->bytes);
+	info_table_begin(h, "latency");
+	wal_stat_latency(h, "queue", &stat->queue_latency);
+	wal_stat_latency(h, "write", &stat->write_latency);
+	wal_stat_latency(h, "commit", &stat->commit_latency);
+	info_table_end(h); /* latency */
+out:
+	info_end(h);
+}
+
+void
+wal_reset_stat(void)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	struct wal_writer_stat *stat = &writer->stat;
+	if (stat->commit_latency.histogram == NULL)
+		return;
+	stat->batches = 0;
+	stat->rows = 0;
+	stat->bytes = 0;
+	latency_reset(&stat->queue_latency);
+	latency_reset(&stat->write_latency);
+	latency_reset(&stat->commit_latency);
+}
+
 /** Retention delay configuration message. */
 struct wal_set_retention_period_msg {
 	/* The state of a synchronous cross-thread call. */
@@ -920,6 +1252,46 @@ wal_collect_garbage(const struct vclock *vclock)
 static void
 wal_notify_watchers(struct wal_writer *writer, unsigned events);
 
+/**
+ * Train a zstd dictionary for the next WAL file on rows sampled
+ * from the previous one. The old dictionary is kept if there are
+ * too few samples or training fails.
+ */
+static void
+wal_train_dict(struct wal_writer *writer)
+{
+	if (!writer->compression_dict ||
+	    writer->wal_dir.opts.compression_level == 0) {
+		xdir_set_dict(&writer->wal_dir, NULL, 0);
+		return;
+	}
+	if (!xlog_dict_builder_is_ready(&writer->dict_builder))
+		return;
+	char dict[XLOG_DICT_SIZE_MAX];
+	size_t dict_size;
+	if (xlog_dict_builder_train(&writer->dict_builder, dict,
+				    &dict_size) != 0 ||
+	    xdir_set_dict(&writer->wal_dir, dict, dict_size) != 0) {
+		diag_log();
+		diag_clear(diag_get());
+		return;
+	}
+	say_verbose("trained %zu byte WAL dictionary", dict_size);
+}
+
+/** Add rows of a journal entry to the WAL dictionary samples. */
+static void
+wal_sample_entry(struct wal_writer *writer, struct journal_entry *entry)
+{
+	if (!writer->compression_dict)
+		return;
+	for (int i = 0; i < entry->n_rows; i++) {
+		struct xrow_header *row = entry->rows[i];
+		xlog_dict_builder_add(&writer->dict_builder,
+				      row->body, row->bodycnt);
+	}
+}
+
 /**
  * If there is no current WAL, try to open it, and close the
  * previous WAL. We close the previous WAL only after opening
@@ -951,10 +1323,12 @@ wal_opt_rotate(struct wal_writer *writer)
 	if (xlog_is_open(&writer->current_wal))
 		return 0;
 
+	wal_train_dict(writer);
 	if (xdir_create_materialized_xlog(&writer->wal_dir,
 					  &writer->current_wal,
 					  &writer->vclock) != 0)
 		return -1;
+	writer->current_wal_row_count = 0;
 	/*
 	 * Keep track of the new WAL vclock. Required for garbage
 	 * collection, see wal_collect_garbage().
@@ -1129,17 +1503,421 @@ wal_assign_lsn(struct vclock *vclock_diff, struct vclock *base,
 	(*end)->is_commit = true;
 }
 
+/**
+ * Store rows of a written batch in the WAL tail so that relays
+ * can send them without reading the WAL file.
+ */
+static void
+wal_append_tail(struct wal_writer *writer, struct wal_msg *wal_msg)
+{
+	if (writer->current_wal_row_count < 0) {
+		wal_tail_reset();
+		return;
+	}
+	int64_t file = vclock_sum(&writer->current_wal.meta.vclock);
+	struct journal_entry *entry;
+	stailq_foreach_entry(entry, &wal_msg->commit, fifo) {
+		wal_tail_append(file, writer->current_wal_row_count,
+				entry->rows, entry->n_rows);
+		writer->current_wal_row_count += entry->n_rows;
+	}
+}
+
+/** Sleep in the WAL thread before a write if requested by tests. */
+static void
+wal_inject_delay(void)
+{
+	ERROR_INJECT_SLEEP(ERRINJ_WAL_DELAY);
+
+	ERROR_INJECT_COUNTDOWN(ERRINJ_WAL_DELAY_COUNTDOWN, {
+		struct errinj *e = errinj(ERRINJ_WAL_DELAY, ERRINJ_BOOL);
+		e->bparam = true;
+		ERROR_INJECT_SLEEP(ERRINJ_WAL_DELAY);
+	});
+}
+
+/**
+ * Notify TX if the checkpoint threshold has been exceeded.
+ * Use malloc() for allocating the notification message and
+ * don't panic on error, because if we fail to send the
+ * message now, we will retry next time we process a request.
+ */
+static void
+wal_check_checkpoint_threshold(struct wal_writer *writer)
+{
+	if (writer->checkpoint_triggered ||
+	    writer->checkpoint_wal_size <= writer->checkpoint_threshold)
+		return;
+	static struct cmsg_hop route[] = {
+		{ tx_notify_checkpoint, NULL },
+	};
+	struct cmsg *msg = malloc(sizeof(*msg));
+	if (msg != NULL) {
+		cmsg_init(msg, route);
+		cpipe_push(&writer->tx_prio_pipe, msg);
+		writer->checkpoint_triggered = true;
+	} else {
+		say_warn("failed to allocate checkpoint "
+			 "notification message");
+	}
+}
+
+/** Get an empty block to send to the compression pool. */
+static struct wal_block *
+wal_block_new(struct wal_writer *writer)
+{
+	if (!stailq_empty(&writer->free_blocks)) {
+		writer->free_block_count--;
+		return stailq_shift_entry(&writer->free_blocks,
+					  struct wal_block, base.in_list);
+	}
+	struct wal_block *block = malloc(sizeof(*block));
+	if (block == NULL) {
+		diag_set(OutOfMemory, sizeof(*block), "malloc",
+			 "struct wal_block");
+		return NULL;
+	}
+	xlog_block_create(&block->base);
+	return block;
+}
+
+/** Free a block or keep it for reuse. */
+static void
+wal_block_delete(struct wal_writer *writer, struct wal_block *block)
+{
+	if (writer->free_block_count < WAL_BLOCK_CACHE_SIZE) {
+		xlog_block_reset(&block->base);
+		stailq_add_entry(&writer->free_blocks, block, base.in_list);
+		writer->free_block_count++;
+		return;
+	}
+	xlog_block_destroy(&block->base);
+	free(block);
+}
+
+/** Checksum and compress a block in a compression thread. */
+static void
+wal_block_prepare_f(struct cmsg *msg)
+{
+	struct wal_block *block = container_of(msg, struct wal_block, msg);
+	xlog_block_prepare(&block->base, block->compressor->zctx);
+}
+
+/** Receive a block prepared by the compression pool. */
+static void
+wal_block_complete_f(struct cmsg *msg)
+{
+	struct wal_block *block = container_of(msg, struct wal_block, msg);
+	block->is_ready = true;
+}
+
+/**
+ * Callback invoked when the compression pool returns blocks.
+ * Wakes up the fiber waiting for them, if any.
+ */
+static void
+wal_compress_notify_cb(ev_loop *loop, struct ev_watcher *watcher,
+		       int revents)
+{
+	(void)loop;
+	(void)revents;
+	struct wal_writer *writer = watcher->data;
+	if (writer->compress_waiter != NULL)
+		fiber_wakeup(writer->compress_waiter);
+}
+
+/**
+ * Wait for the compression pool to return blocks. Must be called
+ * right after processing the compression endpoint, without
+ * yielding in between, so that the wakeup isn't missed.
+ */
+static void
+wal_compress_wait(struct wal_writer *writer)
+{
+	assert(writer->compress_waiter == NULL);
+	writer->compress_waiter = fiber();
+	fiber_yield();
+	writer->compress_waiter = NULL;
+}
+
+/**
+ * Move rows buffered in the current WAL file to a block and send
+ * it to the compression pool. @a batch and @a entry are the batch
+ * and the journal entry the last buffered row belongs to.
+ */
+static int
+wal_submit_block(struct wal_writer *writer, struct wal_msg *batch,
+		 struct journal_entry *entry, struct vclock *vclock_diff)
+{
+	struct wal_block *block = wal_block_new(writer);
+	if (block == NULL)
+		return -1;
+	if (!xlog_flush_block(&writer->current_wal, &block->base)) {
+		wal_block_delete(writer, block);
+		return 0;
+	}
+	block->is_ready = false;
+	block->batch = batch;
+	block->last_entry = entry;
+	vclock_copy(&block->vclock_diff, vclock_diff);
+	block->compressor = &writer->compress_pool[writer->next_compressor];
+	writer->next_compressor = (writer->next_compressor + 1) %
+				  writer->compress_pool_size;
+	cmsg_init(&block->msg, block->compressor->route);
+	stailq_add_tail_entry(&writer->blocks, block, base.in_list);
+	cpipe_push(&block->compressor->compress_pipe, &block->msg);
+	return 0;
+}
+
+/**
+ * Write blocks returned by the compression pool to the current
+ * WAL file in order. Blocks that are ready one after another are
+ * written with a single write. If @a wait is set, wait for all
+ * blocks sent to the pool, otherwise stop at the first block that
+ * isn't ready yet. Returns 0 on success, -1 on write error.
+ */
+static int
+wal_write_blocks(struct wal_writer *writer, struct wal_group *group,
+		 bool wait)
+{
+	struct xlog *l = &writer->current_wal;
+	while (!stailq_empty(&writer->blocks)) {
+		cbus_process(&writer->compress_endpoint);
+		struct stailq ready;
+		stailq_create(&ready);
+		struct wal_block *block = NULL;
+		while (!stailq_empty(&writer->blocks) &&
+		       stailq_first_entry(&writer->blocks, struct wal_block,
+					  base.in_list)->is_ready) {
+			block = stailq_shift_entry(&writer->blocks,
+						   struct wal_block,
+						   base.in_list);
+			stailq_add_tail_entry(&ready, block, base.in_list);
+		}
+		if (block == NULL) {
+			if (!wait)
+				break;
+			wal_compress_wait(writer);
+			continue;
+		}
+		ssize_t written = xlog_write_blocks(l, &ready);
+		if (written >= 0) {
+			writer->checkpoint_wal_size += written;
+			group->last_batch = block->batch;
+			group->last_entry = block->last_entry;
+			vclock_copy(&group->vclock_diff, &block->vclock_diff);
+		}
+		struct wal_block *next;
+		stailq_foreach_entry_safe(block, next, &ready, base.in_list) {
+			if (written >= 0) {
+				block->batch->written_size +=
+					xlog_block_size(&block->base);
+			}
+			wal_block_delete(writer, block);
+		}
+		if (written < 0)
+			return -1;
+	}
+	return 0;
+}
+
+/** Wait for all blocks sent to the compression pool and drop them. */
+static void
+wal_discard_blocks(struct wal_writer *writer)
+{
+	while (!stailq_empty(&writer->blocks)) {
+		cbus_process(&writer->compress_endpoint);
+		struct wal_block *block = stailq_first_entry(
+			&writer->blocks, struct wal_block, base.in_list);
+		if (!block->is_ready) {
+			wal_compress_wait(writer);
+			continue;
+		}
+		stailq_shift(&writer->blocks);
+		wal_block_delete(writer, block);
+	}
+}
+
+/**
+ * Write a group of batches using the compression pool. Rows are
+ * encoded by the WAL thread, blocks of rows are checksummed and
+ * compressed by the pool threads, and written to the WAL file in
+ * order by the WAL thread as soon as they are ready. So encoding,
+ * compression and writing of a group overlap, and the group is
+ * written with as few writes as possible.
+ */
+static void
+wal_write_group(struct wal_writer *writer, struct wal_group *group)
+{
+	struct xlog *l = &writer->current_wal;
+	int err_code = JOURNAL_ENTRY_ERR_UNKNOWN;
+	struct wal_msg *batch;
+	struct journal_entry *entry;
+	struct error *error;
+	size_t approx_len = 0;
+	double write_start_time = clock_monotonic();
+	stailq_foreach_entry(batch, &group->batches, in_group) {
+		if (stailq_empty(&batch->commit))
+			panic("Attempted to write an empty batch to WAL");
+		approx_len += batch->approx_len;
+		batch->write_start_time = write_start_time;
+		batch->is_written = true;
+	}
+	group->last_batch = NULL;
+	group->last_entry = NULL;
+	vclock_create(&group->vclock_diff);
+	/*
+	 * Track all vclock changes made by the group into
+	 * vclock_diff variable. Unlike wal_write_to_disk(),
+	 * the writer's vclock is updated once the whole group
+	 * is processed, because it's used for assigning LSNs.
+	 */
+	struct vclock vclock_diff;
+	vclock_create(&vclock_diff);
+
+	wal_inject_delay();
+
+	if (writer->is_in_rollback) {
+		/* We're rolling back a failed write. */
+		err_code = JOURNAL_ENTRY_ERR_CASCADE;
+		goto done;
+	}
+
+	/* Xlog is only rotated between queue processing  */
+	if (wal_opt_rotate(writer) != 0) {
+		err_code = JOURNAL_ENTRY_ERR_IO;
+		goto done;
+	}
+
+	/* Ensure there's enough disk space before writing anything. */
+	if (wal_fallocate(writer, approx_len) != 0) {
+		err_code = JOURNAL_ENTRY_ERR_IO;
+		goto done;
+	}
+
+	ERROR_INJECT_SLEEP_FOR(ERRINJ_WAL_DELAY_DURATION);
+	/*
+	 * A block is sent to the pool only at a request boundary,
+	 * so a request is never split between blocks, see the
+	 * comment in wal_write_to_disk().
+	 */
+	stailq_foreach_entry(batch, &group->batches, in_group) {
+		stailq_foreach_entry(entry, &batch->commit, fifo) {
+			wal_assign_lsn(&vclock_diff, &writer->vclock, entry);
+			entry->res = vclock_sum(&vclock_diff) +
+				     vclock_sum(&writer->vclock);
+			if (xlog_encode_entry(l, entry) != 0) {
+				err_code = JOURNAL_ENTRY_ERR_IO;
+				goto done;
+			}
+			wal_sample_entry(writer, entry);
+			if (!xlog_tx_commit_buffered(l))
+				continue;
+			if (wal_submit_block(writer, batch, entry,
+					     &vclock_diff) != 0 ||
+			    wal_write_blocks(writer, group, false) != 0) {
+				xlog_tx_rollback(l);
+				err_code = JOURNAL_ENTRY_ERR_IO;
+				goto done;
+			}
+		}
+		/* Remember the vclock diff after the batch. */
+		vclock_copy(&batch->vclock, &vclock_diff);
+	}
+	batch = stailq_last_entry(&group->batches, struct wal_msg, in_group);
+	entry = stailq_last_entry(&batch->commit, struct journal_entry, fifo);
+	if (wal_submit_block(writer, batch, entry, &vclock_diff) != 0 ||
+	    wal_write_blocks(writer, group, true) != 0) {
+		xlog_tx_rollback(l);
+		err_code = JOURNAL_ENTRY_ERR_IO;
+		goto done;
+	}
+	assert(group->last_entry == entry);
+	stailq_foreach_entry(batch, &group->batches, in_group)
+		wal_append_tail(writer, batch);
+	wal_check_checkpoint_threshold(writer);
+done:
+	wal_discard_blocks(writer);
+	error = diag_last_error(diag_get());
+	if (error) {
+		/* Until we can pass the error to tx, log it and clear. */
+		error_log(error);
+		diag_clear(diag_get());
+	}
+	if (err_code == JOURNAL_ENTRY_ERR_IO) {
+		/* See wal_write_to_disk(). */
+		writer->current_wal_row_count = -1;
+		wal_tail_reset();
+	}
+	struct vclock vclock;
+	vclock_copy(&vclock, &writer->vclock);
+	if (group->last_entry != NULL)
+		vclock_merge(&writer->vclock, &group->vclock_diff);
+	/*
+	 * Batches preceding the batch of the last written entry are
+	 * committed, the batches following it are rolled back.
+	 */
+	bool is_committed = group->last_batch != NULL;
+	double write_end_time = clock_monotonic();
+	stailq_foreach_entry(batch, &group->batches, in_group) {
+		struct stailq_entry *last_committed = NULL;
+		if (batch == group->last_batch) {
+			last_committed = &group->last_entry->fifo;
+			is_committed = false;
+		} else if (is_committed) {
+			last_committed = stailq_last(&batch->commit);
+		}
+		if (last_committed == stailq_last(&batch->commit)) {
+			/* Remember the vclock after the batch. */
+			struct vclock diff;
+			vclock_copy(&diff, &batch->vclock);
+			vclock_copy(&batch->vclock, &vclock);
+			vclock_merge(&batch->vclock, &diff);
+		} else {
+			vclock_copy(&batch->vclock, &writer->vclock);
+		}
+		struct stailq rollback;
+		stailq_cut_tail(&batch->commit, last_committed, &rollback);
+		if (!stailq_empty(&rollback)) {
+			assert(err_code != JOURNAL_ENTRY_ERR_UNKNOWN);
+			stailq_foreach_entry(entry, &rollback, fifo)
+				entry->res = err_code;
+			stailq_concat(&batch->rollback, &rollback);
+			wal_begin_rollback();
+		}
+		batch->write_end_time = write_end_time;
+	}
+	assert(err_code != JOURNAL_ENTRY_ERR_UNKNOWN ||
+	       group->last_batch == stailq_last_entry(&group->batches,
+						      struct wal_msg,
+						      in_group));
+	wal_notify_watchers(writer, WAL_EVENT_WRITE);
+	ERROR_INJECT_SLEEP(ERRINJ_RELAY_FASTER_THAN_TX);
+}
+
 static void
 wal_write_to_disk(struct cmsg *msg)
 {
 	struct wal_writer *writer = &wal_writer_singleton;
 	struct wal_msg *wal_msg = (struct wal_msg *) msg;
+	if (writer->compress_pool_size > 0) {
+		/* The batch may have been written with a group. */
+		if (!wal_msg->is_written) {
+			struct wal_group group;
+			stailq_create(&group.batches);
+			stailq_add_tail_entry(&group.batches, wal_msg,
+					      in_group);
+			wal_write_group(writer, &group);
+		}
+		return;
+	}
 	int err_code = JOURNAL_ENTRY_ERR_UNKNOWN;
 	struct stailq_entry *last_committed = NULL;
 	struct journal_entry *entry;
 	struct error *error;
 	if (stailq_empty(&wal_msg->commit))
 		panic("Attempted to write an empty batch to WAL");
+	wal_msg->write_start_time = clock_monotonic();
 
 	/*
 	 * Track all vclock changes made by this batch into
@@ -1149,13 +1927,7 @@ wal_write_to_disk(struct cmsg *msg)
 	struct vclock vclock_diff;
 	vclock_create(&vclock_diff);
 
-	ERROR_INJECT_SLEEP(ERRINJ_WAL_DELAY);
-
-	ERROR_INJECT_COUNTDOWN(ERRINJ_WAL_DELAY_COUNTDOWN, {
-		struct errinj *e = errinj(ERRINJ_WAL_DELAY, ERRINJ_BOOL);
-		e->bparam = true;
-		ERROR_INJECT_SLEEP(ERRINJ_WAL_DELAY);
-	});
+	wal_inject_delay();
 
 	if (writer->is_in_rollback) {
 		/* We're rolling back a failed write. */
@@ -1206,6 +1978,7 @@ wal_write_to_disk(struct cmsg *msg)
 		wal_assign_lsn(&vclock_diff, &writer->vclock, entry);
 		entry->res = vclock_sum(&vclock_diff) +
 			     vclock_sum(&writer->vclock);
+		wal_sample_entry(writer, entry);
 		rc = xlog_write_entry(l, entry);
 		if (rc < 0) {
 			err_code = JOURNAL_ENTRY_ERR_IO;
@@ -1213,6 +1986,7 @@ wal_write_to_disk(struct cmsg *msg)
 		}
 		if (rc > 0) {
 			writer->checkpoint_wal_size += rc;
+			wal_msg->written_size += rc;
 			last_committed = &entry->fifo;
 			vclock_merge(&writer->vclock, &vclock_diff);
 		}
@@ -1224,30 +1998,11 @@ wal_write_to_disk(struct cmsg *msg)
 		goto done;
 	}
 	writer->checkpoint_wal_size += rc;
+	wal_msg->written_size += rc;
 	last_committed = stailq_last(&wal_msg->commit);
 	vclock_merge(&writer->vclock, &vclock_diff);
-
-	/*
-	 * Notify TX if the checkpoint threshold has been exceeded.
-	 * Use malloc() for allocating the notification message and
-	 * don't panic on error, because if we fail to send the
-	 * message now, we will retry next time we process a request.
-	 */
-	if (!writer->checkpoint_triggered &&
-	    writer->checkpoint_wal_size > writer->checkpoint_threshold) {
-		static struct cmsg_hop route[] = {
-			{ tx_notify_checkpoint, NULL },
-		};
-		struct cmsg *msg = malloc(sizeof(*msg));
-		if (msg != NULL) {
-			cmsg_init(msg, route);
-			cpipe_push(&writer->tx_prio_pipe, msg);
-			writer->checkpoint_triggered = true;
-		} else {
-			say_warn("failed to allocate checkpoint "
-				 "notification message");
-		}
-	}
+	wal_append_tail(writer, wal_msg);
+	wal_check_checkpoint_threshold(writer);
 
 done:
 	error = diag_last_error(diag_get());
@@ -1256,6 +2011,15 @@ wal_write_to_disk(struct cmsg *msg)
 		error_log(error);
 		diag_clear(diag_get());
 	}
+	if (err_code == JOURNAL_ENTRY_ERR_IO) {
+		/*
+		 * Some rows of the batch may have been written to the
+		 * current WAL file so we don't know its row count anymore.
+		 * Stop filling the WAL tail until the next WAL is created.
+		 */
+		writer->current_wal_row_count = -1;
+		wal_tail_reset();
+	}
 	/*
 	 * Remember the vclock of the last successfully written row so
 	 * that we can update instance_vclock once this message gets
@@ -1283,10 +2047,176 @@ wal_write_to_disk(struct cmsg *msg)
 	} else {
 		assert(err_code == JOURNAL_ENTRY_ERR_UNKNOWN);
 	}
+	wal_msg->write_end_time = clock_monotonic();
 	wal_notify_watchers(writer, WAL_EVENT_WRITE);
 	ERROR_INJECT_SLEEP(ERRINJ_RELAY_FASTER_THAN_TX);
 }
 
+/**
+ * Callback invoked when new messages arrive to the 'wal' endpoint.
+ * Wakes up the loop fiber only if it waits for new messages, because
+ * the fiber may yield while writing to a WAL file with io_uring and
+ * a spurious wakeup would be consumed there.
+ */
+static void
+wal_writer_notify_cb(ev_loop *loop, struct ev_watcher *watcher, int revents)
+{
+	(void)loop;
+	(void)revents;
+	struct wal_writer *writer = watcher->data;
+	writer->loop_has_input = true;
+	if (writer->loop_is_idle)
+		fiber_wakeup(writer->loop_fiber);
+}
+
+/**
+ * Process messages sent to the WAL thread. If the compression pool
+ * is used, batches that arrived one after another are written as
+ * a single group, see wal_write_group(). Batches are queued while
+ * the previous group is being written, so the slower the disk is,
+ * the more batches are written and synced at once.
+ */
+static void
+wal_writer_process(struct wal_writer *writer, struct cbus_endpoint *endpoint)
+{
+	if (writer->compress_pool_size == 0) {
+		cbus_process(endpoint);
+		return;
+	}
+	struct stailq output;
+	stailq_create(&output);
+	cbus_endpoint_fetch(endpoint, &output);
+	struct cmsg *msg, *next;
+	stailq_foreach_entry_safe(msg, next, &output, fifo) {
+		struct wal_msg *batch = wal_msg(msg);
+		if (batch != NULL && !batch->is_written) {
+			struct wal_group group;
+			stailq_create(&group.batches);
+			struct stailq_entry *item = &msg->fifo;
+			do {
+				batch = wal_msg(stailq_entry(item, struct cmsg,
+							     fifo));
+				if (batch == NULL)
+					break;
+				stailq_add_tail_entry(&group.batches, batch,
+						      in_group);
+			} while ((item = stailq_next(item)) != NULL);
+			wal_write_group(writer, &group);
+		}
+		cmsg_deliver(msg);
+	}
+}
+
+/**
+ * Process messages sent to the WAL thread until the loop is stopped
+ * with cbus_stop_loop(). Unlike cbus_loop(), messages that arrive
+ * while a message handler yields are processed without waiting for
+ * the next wakeup.
+ */
+static void
+wal_writer_loop(struct wal_writer *writer, struct cbus_endpoint *endpoint)
+{
+	while (true) {
+		writer->loop_has_input = false;
+		wal_writer_process(writer, endpoint);
+		fiber_check_gc();
+		if (fiber_is_cancelled())
+			break;
+		if (writer->loop_has_input)
+			continue;
+		writer->loop_is_idle = true;
+		fiber_yield();
+		writer->loop_is_idle = false;
+	}
+}
+
+/** Compression thread routine. */
+static int
+wal_compressor_f(va_list ap)
+{
+	struct wal_compressor *compressor = va_arg(ap, struct wal_compressor *);
+	compressor->zctx = ZSTD_createCCtx();
+	if (compressor->zctx == NULL) {
+		say_error("failed to create zstd context, "
+			  "WAL blocks won't be compressed");
+	}
+	cpipe_create(&compressor->wal_pipe, "wal_compress");
+	/* Return each block as soon as it's ready. */
+	cpipe_set_max_input(&compressor->wal_pipe, 1);
+	struct cbus_endpoint endpoint;
+	cbus_endpoint_create(&endpoint, cord_name(cord()),
+			     fiber_schedule_cb, fiber());
+	cbus_loop(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	cpipe_destroy(&compressor->wal_pipe);
+	ZSTD_freeCCtx(compressor->zctx);
+	return 0;
+}
+
+/** Start the compression pool. Called in the WAL thread. */
+static void
+wal_compress_pool_start(struct wal_writer *writer)
+{
+	assert(writer->compress_pool_size > 0);
+	writer->next_compressor = 0;
+	writer->compress_waiter = NULL;
+	stailq_create(&writer->blocks);
+	stailq_create(&writer->free_blocks);
+	writer->free_block_count = 0;
+	cbus_endpoint_create(&writer->compress_endpoint, "wal_compress",
+			     wal_compress_notify_cb, writer);
+	writer->compress_pool = calloc(writer->compress_pool_size,
+				       sizeof(*writer->compress_pool));
+	if (writer->compress_pool == NULL)
+		panic("failed to allocate WAL compression thread pool");
+	for (int i = 0; i < writer->compress_pool_size; i++) {
+		struct wal_compressor *compressor = &writer->compress_pool[i];
+		compressor->route[0].f = wal_block_prepare_f;
+		compressor->route[0].pipe = &compressor->wal_pipe;
+		compressor->route[1].f = wal_block_complete_f;
+		compressor->route[1].pipe = NULL;
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "wal.compress.%d", i);
+		if (cord_costart(&compressor->cord, name,
+				 wal_compressor_f, compressor) != 0)
+			panic("failed to start WAL compression thread");
+		cpipe_create(&compressor->compress_pipe, name);
+		/* Send each block as soon as it's encoded. */
+		cpipe_set_max_input(&compressor->compress_pipe, 1);
+	}
+}
+
+/** Stop the compression pool. Called in the WAL thread. */
+static void
+wal_compress_pool_stop(struct wal_writer *writer)
+{
+	assert(stailq_empty(&writer->blocks));
+	for (int i = 0; i < writer->compress_pool_size; i++) {
+		struct wal_compressor *compressor = &writer->compress_pool[i];
+		cbus_stop_loop(&compressor->compress_pipe);
+		cpipe_destroy(&compressor->compress_pipe);
+	}
+	for (int i = 0; i < writer->compress_pool_size; i++) {
+		struct wal_compressor *compressor = &writer->compress_pool[i];
+		if (cord_join(&compressor->cord) != 0)
+			panic_syserror("failed to join WAL compression thread");
+	}
+	/* Let the notify callback wake up the fiber waiting for pipes. */
+	writer->compress_waiter = fiber();
+	cbus_endpoint_destroy(&writer->compress_endpoint, cbus_process);
+	writer->compress_waiter = NULL;
+	free(writer->compress_pool);
+	writer->compress_pool = NULL;
+	struct wal_block *block, *next;
+	stailq_foreach_entry_safe(block, next, &writer->free_blocks,
+				  base.in_list) {
+		xlog_block_destroy(&block->base);
+		free(block);
+	}
+	stailq_create(&writer->free_blocks);
+	writer->free_block_count = 0;
+}
+
 /** WAL writer main loop.  */
 static int
 wal_writer_f(va_list ap)
@@ -1296,17 +2226,23 @@ wal_writer_f(va_list ap)
 
 	/** Initialize eio in this thread */
 	coio_enable();
+	coio_uring_init();
 
+	writer->loop_fiber = fiber();
+	writer->loop_is_idle = false;
+	writer->loop_has_input = false;
 	struct cbus_endpoint endpoint;
-	cbus_endpoint_create(&endpoint, "wal", fiber_schedule_cb, fiber());
+	cbus_endpoint_create(&endpoint, "wal", wal_writer_notify_cb, writer);
 	/*
 	 * Create a pipe to TX thread. Use a high priority
 	 * endpoint, to ensure that WAL messages are delivered
 	 * even when tx fiber pool is used up by net messages.
 	 */
 	cpipe_create(&writer->tx_prio_pipe, "tx_prio");
+	if (writer->compress_pool_size > 0)
+		wal_compress_pool_start(writer);
 
-	cbus_loop(&endpoint);
+	wal_writer_loop(writer, &endpoint);
 
 	/*
 	 * Create a new empty WAL on shutdown so that we don't
@@ -1332,7 +2268,12 @@ wal_writer_f(va_list ap)
 		wal_xlog_close(&vy_log_writer.xlog);
 
 	cpipe_destroy(&writer->tx_prio_pipe);
+	/* Let the notify callback wake up the fiber waiting for pipes. */
+	writer->loop_is_idle = true;
 	cbus_endpoint_destroy(&endpoint, cbus_process);
+	if (writer->compress_pool_size > 0)
+		wal_compress_pool_stop(writer);
+	coio_uring_free();
 	return 0;
 }
 
@@ -1390,6 +2331,7 @@ wal_write_async(struct journal *journal, struct journal_entry *entry)
 		 */
 		stailq_add_tail_entry(&batch->commit, entry, fifo);
 		cpipe_push(&writer->wal_pipe, &batch->base);
+		writer->stat.queue_batches++;
 	}
 	/*
 	 * Remember last entry sent to WAL. In case of rollback
@@ -1398,6 +2340,8 @@ wal_write_async(struct journal *journal, struct journal_entry *entry)
 	 */
 	writer->last_entry = entry;
 	batch->approx_len += entry->approx_len;
+	batch->n_rows += entry->n_rows;
+	writer->stat.queue_rows += entry->n_rows;
 	writer->wal_pipe.n_input += entry->n_rows * XROW_IOVMAX;
 #ifndef NDEBUG
 	++errinj(ERRINJ_WAL_WRITE_COUNT, ERRINJ_INT)->iparam;
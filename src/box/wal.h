@@ -40,6 +40,7 @@
 struct fiber;
 struct wal_writer;
 struct tt_uuid;
+struct info_handler;
 
 enum wal_mode {
 	/**
@@ -69,6 +70,8 @@ enum {
 	 * loop for the whole recovery stage.
 	 */
 	WAL_ROWS_PER_YIELD = 1 << 15,
+	/** Max number of threads in the WAL compression pool. */
+	WAL_COMPRESSION_THREADS_MAX = 64,
 };
 
 /** String constants for the supported modes. */
@@ -108,7 +111,7 @@ typedef void (*wal_on_checkpoint_threshold_f)(void);
 int
 wal_init(enum wal_mode wal_mode, const char *wal_dirname,
 	 int64_t wal_max_size, double wal_retention_period,
-	 const struct tt_uuid *instance_uuid,
+	 int compression_threads, const struct tt_uuid *instance_uuid,
 	 struct vclock *instance_vclock,
 	 struct vclock *checkpoint_vclock,
 	 wal_on_garbage_collection_f on_garbage_collection,
@@ -269,6 +272,33 @@ wal_set_checkpoint_threshold(int64_t threshold);
 void
 wal_set_queue_max_size(int64_t size);
 
+/**
+ * Set zstd compression level of WAL files. 0 disables compression.
+ * Takes effect for the current WAL file immediately.
+ */
+void
+wal_set_compression_level(int level);
+
+/**
+ * Enable or disable zstd dictionaries for WAL files. If enabled,
+ * a dictionary is trained on rows written to a WAL file and used
+ * for compressing the next WAL file.
+ */
+void
+wal_set_compression_dict(bool compression_dict);
+
+/**
+ * Fill box.stat.wal(): the number of batches and rows waiting
+ * for the WAL thread, totals written since the last reset and
+ * queue/write/commit latency percentiles of a batch.
+ */
+void
+wal_stat(struct info_handler *h);
+
+/** Reset WAL statistics, called by box.stat.reset(). */
+void
+wal_reset_stat(void);
+
 /**
  * Set new value for wal_retention_period, update expiration time
  * of all xlog files.
@@ -0,0 +1,325 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "wal_tail.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diag.h"
+#include "fiber.h"
+#include "small/ibuf.h"
+#include "trivia/util.h"
+#include "tt_pthread.h"
+#include "xrow.h"
+
+enum {
+	/**
+	 * Expected average size of an encoded row. Used for sizing
+	 * the ring of row descriptors.
+	 */
+	WAL_TAIL_AVG_ROW_SIZE = 64,
+	/** Min number of row descriptors. */
+	WAL_TAIL_ROWS_MIN = 16,
+	/** Max number of rows copied by wal_tail_read() at once. */
+	WAL_TAIL_READ_ROWS_MAX = 256,
+	/** Max size of rows copied by wal_tail_read() at once. */
+	WAL_TAIL_READ_SIZE_MAX = 256 * 1024,
+};
+
+/** Descriptor of a row stored in the WAL tail. */
+struct wal_tail_row {
+	/** Signature of the WAL file the row was written to. */
+	int64_t file;
+	/** Ordinal number of the row in the WAL file. */
+	int64_t row_no;
+	/** Offset of the encoded row in the data ring. */
+	uint64_t offset;
+	/** Size of the encoded row. */
+	uint32_t size;
+};
+
+struct wal_tail {
+	/** Protects all members below. */
+	pthread_mutex_t mutex;
+	/** Ring of row descriptors, indexed by sequence number. */
+	struct wal_tail_row *rows;
+	/** Size of the row descriptor ring. A power of two. */
+	size_t row_capacity;
+	/** Ring of encoded rows. */
+	char *data;
+	/** Size of the encoded row ring. */
+	size_t data_capacity;
+	/** Sequence number of the oldest stored row. */
+	int64_t first_seq;
+	/** Sequence number that will be assigned to the next row. */
+	int64_t next_seq;
+	/** Offset of the oldest stored row in the data ring. */
+	uint64_t data_begin;
+	/** Offset at which the next row will be stored. */
+	uint64_t data_end;
+	/** Number of registered readers. */
+	int reader_count;
+};
+
+static struct wal_tail wal_tail;
+
+static inline struct wal_tail_row *
+wal_tail_row(struct wal_tail *t, int64_t seq)
+{
+	return &t->rows[seq & (t->row_capacity - 1)];
+}
+
+/** Drop all stored rows and break the sequence. */
+static void
+wal_tail_reset_locked(struct wal_tail *t)
+{
+	/*
+	 * Skip a sequence number so that a reader waiting for the next
+	 * row notices that it may have missed some rows.
+	 */
+	t->first_seq = ++t->next_seq;
+	t->data_begin = t->data_end;
+}
+
+/** Evict the oldest stored row. */
+static void
+wal_tail_evict_locked(struct wal_tail *t)
+{
+	assert(t->first_seq < t->next_seq);
+	t->first_seq++;
+	t->data_begin = t->first_seq < t->next_seq ?
+			wal_tail_row(t, t->first_seq)->offset : t->data_end;
+}
+
+/** Copy data to the data ring at the given offset. */
+static void
+wal_tail_write_data(struct wal_tail *t, uint64_t offset,
+		    const char *src, size_t size)
+{
+	size_t pos = offset % t->data_capacity;
+	size_t n = MIN(size, t->data_capacity - pos);
+	memcpy(t->data + pos, src, n);
+	memcpy(t->data, src + n, size - n);
+}
+
+/** Copy data from the data ring at the given offset. */
+static void
+wal_tail_read_data(struct wal_tail *t, uint64_t offset,
+		   char *dst, size_t size)
+{
+	size_t pos = offset % t->data_capacity;
+	size_t n = MIN(size, t->data_capacity - pos);
+	memcpy(dst, t->data + pos, n);
+	memcpy(dst + n, t->data, size - n);
+}
+
+/** Append an encoded row to the WAL tail. */
+static void
+wal_tail_append_row_locked(struct wal_tail *t, int64_t file, int64_t row_no,
+			   const struct iovec *iov, int iovcnt)
+{
+	size_t size = 0;
+	for (int i = 0; i < iovcnt; i++)
+		size += iov[i].iov_len;
+	if (size > t->data_capacity) {
+		wal_tail_reset_locked(t);
+		return;
+	}
+	while (t->data_end + size - t->data_begin > t->data_capacity ||
+	       t->next_seq - t->first_seq == (int64_t)t->row_capacity)
+		wal_tail_evict_locked(t);
+	struct wal_tail_row *row = wal_tail_row(t, t->next_seq);
+	row->file = file;
+	row->row_no = row_no;
+	row->offset = t->data_end;
+	row->size = size;
+	for (int i = 0; i < iovcnt; i++) {
+		wal_tail_write_data(t, t->data_end, iov[i].iov_base,
+				    iov[i].iov_len);
+		t->data_end += iov[i].iov_len;
+	}
+	t->next_seq++;
+}
+
+void
+wal_tail_init(void)
+{
+	memset(&wal_tail, 0, sizeof(wal_tail));
+	tt_pthread_mutex_init(&wal_tail.mutex, NULL);
+}
+
+void
+wal_tail_free(void)
+{
+	tt_pthread_mutex_destroy(&wal_tail.mutex);
+	free(wal_tail.rows);
+	free(wal_tail.data);
+}
+
+int
+wal_tail_set_size(size_t size)
+{
+	struct wal_tail *t = &wal_tail;
+	if (size == t->data_capacity)
+		return 0;
+	char *data = NULL;
+	struct wal_tail_row *rows = NULL;
+	size_t row_capacity = 0;
+	if (size > 0) {
+		row_capacity = WAL_TAIL_ROWS_MIN;
+		while (row_capacity < size / WAL_TAIL_AVG_ROW_SIZE)
+			row_capacity *= 2;
+		data = malloc(size);
+		if (data == NULL) {
+			diag_set(OutOfMemory, size, "malloc", "WAL tail");
+			return -1;
+		}
+		rows = malloc(row_capacity * sizeof(*rows));
+		if (rows == NULL) {
+			diag_set(OutOfMemory, row_capacity * sizeof(*rows),
+				 "malloc", "WAL tail rows");
+			free(data);
+			return -1;
+		}
+	}
+	tt_pthread_mutex_lock(&t->mutex);
+	SWAP(t->data, data);
+	SWAP(t->rows, rows);
+	t->data_capacity = size;
+	t->row_capacity = row_capacity;
+	wal_tail_reset_locked(t);
+	tt_pthread_mutex_unlock(&t->mutex);
+	free(data);
+	free(rows);
+	return 0;
+}
+
+size_t
+wal_tail_size(void)
+{
+	return wal_tail.data_capacity;
+}
+
+void
+wal_tail_attach(void)
+{
+	tt_pthread_mutex_lock(&wal_tail.mutex);
+	wal_tail.reader_count++;
+	tt_pthread_mutex_unlock(&wal_tail.mutex);
+}
+
+void
+wal_tail_detach(void)
+{
+	tt_pthread_mutex_lock(&wal_tail.mutex);
+	assert(wal_tail.reader_count > 0);
+	wal_tail.reader_count--;
+	tt_pthread_mutex_unlock(&wal_tail.mutex);
+}
+
+void
+wal_tail_append(int64_t file, int64_t row_no,
+		struct xrow_header **rows, int count)
+{
+	struct wal_tail *t = &wal_tail;
+	size_t region_svp = region_used(&fiber()->gc);
+	tt_pthread_mutex_lock(&t->mutex);
+	if (t->reader_count == 0 || t->data_capacity == 0) {
+		wal_tail_reset_locked(t);
+		goto out;
+	}
+	for (int i = 0; i < count; i++) {
+		struct iovec iov[XROW_IOVMAX];
+		int iovcnt;
+		/* Encode the row the same way it's written to the WAL. */
+		xrow_encode(rows[i], /*sync=*/0, /*fixheader_len=*/0,
+			    iov, &iovcnt);
+		wal_tail_append_row_locked(t, file, row_no + i, iov, iovcnt);
+	}
+out:
+	tt_pthread_mutex_unlock(&t->mutex);
+	region_truncate(&fiber()->gc, region_svp);
+}
+
+void
+wal_tail_reset(void)
+{
+	tt_pthread_mutex_lock(&wal_tail.mutex);
+	wal_tail_reset_locked(&wal_tail);
+	tt_pthread_mutex_unlock(&wal_tail.mutex);
+}
+
+/** Check if the row is stored at the given position of a WAL file. */
+static inline bool
+wal_tail_row_is_at(const struct wal_tail_row *row,
+		   int64_t file, int64_t row_no)
+{
+	return row->file == file && row->row_no == row_no;
+}
+
+int64_t
+wal_tail_find(int64_t file, int64_t row_no)
+{
+	struct wal_tail *t = &wal_tail;
+	int64_t seq = -1;
+	tt_pthread_mutex_lock(&t->mutex);
+	/* Find the first row stored at or after the given position. */
+	int64_t lo = t->first_seq;
+	int64_t hi = t->next_seq;
+	while (lo < hi) {
+		int64_t mid = lo + (hi - lo) / 2;
+		struct wal_tail_row *row = wal_tail_row(t, mid);
+		if (row->file < file ||
+		    (row->file == file && row->row_no < row_no))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo < t->next_seq &&
+	    wal_tail_row_is_at(wal_tail_row(t, lo), file, row_no)) {
+		seq = lo;
+	} else if (lo > t->first_seq &&
+		   wal_tail_row_is_at(wal_tail_row(t, lo - 1),
+				      file, row_no - 1)) {
+		/*
+		 * The row preceding the position is the last one
+		 * written to the file so the next stored row (if any)
+		 * follows the position.
+		 */
+		seq = lo;
+	}
+	tt_pthread_mutex_unlock(&t->mutex);
+	return seq;
+}
+
+int
+wal_tail_read(int64_t seq, struct ibuf *out)
+{
+	struct wal_tail *t = &wal_tail;
+	int count = 0;
+	size_t total_size = 0;
+	tt_pthread_mutex_lock(&t->mutex);
+	if (seq < t->first_seq) {
+		tt_pthread_mutex_unlock(&t->mutex);
+		return -1;
+	}
+	for (; seq < t->next_seq && count < WAL_TAIL_READ_ROWS_MAX &&
+	       total_size < WAL_TAIL_READ_SIZE_MAX; seq++, count++) {
+		struct wal_tail_row *row = wal_tail_row(t, seq);
+		struct wal_tail_row_header header;
+		header.file = row->file;
+		header.size = row->size;
+		char *p = xibuf_alloc(out, sizeof(header) + row->size);
+		memcpy(p, &header, sizeof(header));
+		wal_tail_read_data(t, row->offset, p + sizeof(header),
+				   row->size);
+		total_size += row->size;
+	}
+	tt_pthread_mutex_unlock(&t->mutex);
+	return count;
+}
@@ -0,0 +1,116 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct ibuf;
+struct xrow_header;
+
+/**
+ * WAL tail is an in-memory ring buffer of the most recently written WAL
+ * rows. It is filled by the WAL thread after each successful write and
+ * read by replication relays so that a relay that keeps up with the WAL
+ * doesn't need to re-read and decode WAL files.
+ *
+ * Rows are identified by a monotonically growing sequence number. Rows
+ * with consecutive sequence numbers are consecutive in the WAL. When the
+ * continuity is broken (a write error, the buffer is resized, or there's
+ * no reader), the buffer is reset and the sequence number jumps so that
+ * all readers have to fall back to reading WAL files.
+ *
+ * To switch from files to the buffer, a reader looks up a row by its
+ * position in a WAL file: the file signature and the ordinal number of
+ * the row in the file, see wal_tail_find().
+ */
+
+/** Header of a row copied out of the WAL tail by wal_tail_read(). */
+struct wal_tail_row_header {
+	/** Signature of the WAL file the row was written to. */
+	int64_t file;
+	/** Size of the encoded row following the header. */
+	uint32_t size;
+};
+
+/** Initialize the WAL tail. The buffer is disabled until resized. */
+void
+wal_tail_init(void);
+
+/** Free the WAL tail. */
+void
+wal_tail_free(void);
+
+/**
+ * Set the WAL tail buffer size, in bytes. Zero disables the buffer.
+ * The buffer is reset. Returns -1 and sets diag on memory allocation
+ * error, in which case the buffer isn't changed.
+ */
+int
+wal_tail_set_size(size_t size);
+
+/** Return the WAL tail buffer size, in bytes. */
+size_t
+wal_tail_size(void);
+
+/**
+ * Register a reader. Rows aren't stored while there are no readers.
+ * May be called from any thread.
+ */
+void
+wal_tail_attach(void);
+
+/** Unregister a reader. May be called from any thread. */
+void
+wal_tail_detach(void);
+
+/**
+ * Append rows of a transaction written to a WAL file. Called by the WAL
+ * thread after the rows have been flushed to disk.
+ *
+ * @param file     signature of the WAL file.
+ * @param row_no   ordinal number of the first row in the file.
+ * @param rows     rows to append.
+ * @param count    number of rows.
+ */
+void
+wal_tail_append(int64_t file, int64_t row_no,
+		struct xrow_header **rows, int count);
+
+/**
+ * Drop all rows stored in the WAL tail and make the readers fall back
+ * to files. Called by the WAL thread if rows were written to disk but
+ * could not be appended.
+ */
+void
+wal_tail_reset(void);
+
+/**
+ * Find the sequence number of the row stored at the given position of
+ * a WAL file. If all rows preceding the position are stored, but the row
+ * itself hasn't been written yet, returns the sequence number the row
+ * will be assigned. Otherwise, returns -1.
+ */
+int64_t
+wal_tail_find(int64_t file, int64_t row_no);
+
+/**
+ * Copy rows starting from the one with the given sequence number to
+ * a buffer. Each row is prefixed with struct wal_tail_row_header.
+ *
+ * Returns the number of copied rows, which is 0 if the row hasn't been
+ * written yet, or -1 if the row has been evicted from the buffer.
+ */
+int
+wal_tail_read(int64_t seq, struct ibuf *out);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -32,6 +32,9 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <ctype.h>
+#include <base64.h>
+#define ZDICT_STATIC_LINKING_ONLY
+#include "zdict.h"
 
 #include "fiber.h"
 #include "exception.h"
@@ -41,6 +44,7 @@
 #include <msgpuck.h>
 
 #include "coio_task.h"
+#include "coio_uring.h"
 #include "tt_static.h"
 #include "error.h"
 #include "xrow.h"
@@ -97,18 +101,23 @@ const struct xlog_opts xlog_opts_default = {
 	.sync_interval = 0,
 	.free_cache = false,
 	.sync_is_async = false,
+	.write_with_uring = false,
 	.no_compression = false,
+	.compression_level = XLOG_COMPRESSION_LEVEL_DEFAULT,
 };
 
 /* {{{ struct xlog_meta */
 
 enum {
+	/** The maximum length of a base64-encoded dictionary. */
+	XLOG_DICT_STR_LEN_MAX = (XLOG_DICT_SIZE_MAX + 2) / 3 * 4,
 	/*
 	 * The maximum length of xlog meta
 	 *
 	 * @sa xlog_meta_parse()
 	 */
-	XLOG_META_LEN_MAX = 1024 + VCLOCK_STR_LEN_MAX
+	XLOG_META_LEN_MAX = 1024 + 2 * VCLOCK_STR_LEN_MAX +
+			    XLOG_DICT_STR_LEN_MAX,
 };
 
 #define INSTANCE_UUID_KEY "Instance"
@@ -116,6 +125,8 @@ enum {
 #define VCLOCK_KEY "VClock"
 #define VERSION_KEY "Version"
 #define PREV_VCLOCK_KEY "PrevVClock"
+#define BASE_VCLOCK_KEY "BaseVClock"
+#define DICT_KEY "Dictionary"
 
 static const char v13[] = "0.13";
 static const char v12[] = "0.12";
@@ -136,6 +147,8 @@ xlog_meta_create(struct xlog_meta *meta, const char *filetype,
 		vclock_copy(&meta->prev_vclock, prev_vclock);
 	else
 		vclock_clear(&meta->prev_vclock);
+	vclock_clear(&meta->base_vclock);
+	meta->dict_size = 0;
 }
 
 /**
@@ -169,6 +182,18 @@ xlog_meta_format(const struct xlog_meta *meta, char *buf, int size)
 		SNPRINT(total, snprintf, buf, size, PREV_VCLOCK_KEY ": %s\n",
 			vclock_to_string(&meta->prev_vclock));
 	}
+	if (vclock_is_set(&meta->base_vclock)) {
+		SNPRINT(total, snprintf, buf, size, BASE_VCLOCK_KEY ": %s\n",
+			vclock_to_string(&meta->base_vclock));
+	}
+	if (meta->dict_size > 0) {
+		char dict[XLOG_DICT_STR_LEN_MAX];
+		int dict_len = base64_encode(meta->dict, meta->dict_size,
+					     dict, sizeof(dict),
+					     BASE64_NOWRAP);
+		SNPRINT(total, snprintf, buf, size, DICT_KEY ": %.*s\n",
+			dict_len, dict);
+	}
 	SNPRINT(total, snprintf, buf, size, "\n");
 	assert(total > 0);
 	return total;
@@ -260,6 +285,7 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 
 	vclock_clear(&meta->vclock);
 	vclock_clear(&meta->prev_vclock);
+	vclock_clear(&meta->base_vclock);
 
 	/*
 	 * Parse "key: value" pairs
@@ -310,6 +336,27 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 			 */
 			if (parse_vclock(val, val_end, &meta->prev_vclock) != 0)
 				return -1;
+		} else if (xlog_meta_key_equal(key, key_end, BASE_VCLOCK_KEY)) {
+			/*
+			 * BaseVClock: <vclock>
+			 */
+			if (parse_vclock(val, val_end, &meta->base_vclock) != 0)
+				return -1;
+		} else if (xlog_meta_key_equal(key, key_end, DICT_KEY)) {
+			/*
+			 * Dictionary: <base64>
+			 */
+			if (val_end - val > XLOG_DICT_STR_LEN_MAX) {
+				diag_set(XlogError, "dictionary is too big");
+				return -1;
+			}
+			meta->dict_size = base64_decode(val, val_end - val,
+							meta->dict,
+							sizeof(meta->dict));
+			if (meta->dict_size == 0) {
+				diag_set(XlogError, "can't parse dictionary");
+				return -1;
+			}
 		} else if (xlog_meta_key_equal(key, key_end, VERSION_KEY)) {
 			/* Ignore Version: for now */
 		} else {
@@ -371,6 +418,29 @@ xdir_destroy(struct xdir *dir)
 {
 	/** Free vclock objects allocated in xdir_scan(). */
 	vclockset_reset(&dir->index);
+	free(dir->dict);
+	dir->dict = NULL;
+	dir->dict_size = 0;
+}
+
+int
+xdir_set_dict(struct xdir *dir, const char *dict, size_t dict_size)
+{
+	assert(dict_size <= XLOG_DICT_SIZE_MAX);
+	char *copy = NULL;
+	if (dict != NULL) {
+		copy = malloc(dict_size);
+		if (copy == NULL) {
+			diag_set(OutOfMemory, dict_size, "malloc",
+				 "xlog dictionary");
+			return -1;
+		}
+		memcpy(copy, dict, dict_size);
+	}
+	free(dir->dict);
+	dir->dict = copy;
+	dir->dict_size = copy != NULL ? dict_size : 0;
+	return 0;
 }
 
 /**
@@ -829,6 +899,8 @@ xlog_free(struct xlog *xlog)
 	obuf_destroy(&xlog->zbuf);
 	ZSTD_freeCCtx(xlog->zctx);
 	xlog->zctx = NULL;
+	ZSTD_freeCDict(xlog->zcdict);
+	xlog->zcdict = NULL;
 }
 
 int
@@ -1000,6 +1072,14 @@ xdir_touch_xlog(struct xdir *dir, const struct vclock *vclock)
 int
 xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 		 const struct vclock *vclock)
+{
+	return xdir_create_delta_xlog(dir, xlog, vclock, NULL);
+}
+
+int
+xdir_create_delta_xlog(struct xdir *dir, struct xlog *xlog,
+		       const struct vclock *vclock,
+		       const struct vclock *base_vclock)
 {
 	int64_t signature = vclock_sum(vclock);
 	assert(signature >= 0);
@@ -1012,6 +1092,14 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 	struct xlog_meta meta;
 	xlog_meta_create(&meta, dir->filetype, dir->instance_uuid,
 			 vclock, prev_vclock);
+	if (base_vclock != NULL) {
+		assert(vclock_sum(base_vclock) < signature);
+		vclock_copy(&meta.base_vclock, base_vclock);
+	}
+	if (dir->dict != NULL) {
+		memcpy(meta.dict, dir->dict, dir->dict_size);
+		meta.dict_size = dir->dict_size;
+	}
 
 	const char *filename = xdir_format_filename(dir, signature);
 	return xlog_create(xlog, filename, dir->open_wflags, &meta, &dir->opts);
@@ -1066,36 +1154,35 @@ xlog_fallocate(struct xlog *log, size_t len)
 }
 
 /**
- * Write a sequence of uncompressed xrow objects.
+ * Write the whole iovec to the xlog file at the current position,
+ * see xlog_opts::write_with_uring.
+ */
+static ssize_t
+xlog_writevn(struct xlog *log, struct iovec *iov, int iovcnt)
+{
+	if (log->opts.write_with_uring && coio_uring_is_enabled())
+		return coio_uring_writevn(log->fd, iov, iovcnt);
+	return fio_writevn(log->fd, iov, iovcnt);
+}
+
+/**
+ * Encode the fixheader of an xlog block.
  *
- * @retval -1 error
- * @retval >= 0 the number of bytes written
+ * @param fixheader  buffer of XLOG_FIXHEADER_SIZE bytes
+ * @param magic      row_marker or zrow_marker
+ * @param len        size of the block data following the fixheader
+ * @param crc32c     checksum of the block data
  */
-static off_t
-xlog_tx_write_plain(struct xlog *log)
+static void
+xlog_encode_fixheader(char *fixheader, log_magic_t magic, size_t len,
+		      uint32_t crc32c)
 {
-	/**
-	 * We created an obuf savepoint at start of xlog_tx,
-	 * now populate it with data.
-	 */
-	char *fixheader = (char *)log->obuf.iov[0].iov_base;
-	memcpy(fixheader, &row_marker, sizeof(log_magic_t));
+	memcpy(fixheader, &magic, sizeof(log_magic_t));
 	char *data = fixheader + sizeof(log_magic_t);
-
-	data = mp_encode_uint(data,
-			      obuf_size(&log->obuf) - XLOG_FIXHEADER_SIZE);
+	data = mp_encode_uint(data, len);
 	/* Encode crc32 for previous row */
 	data = mp_encode_uint(data, 0);
 	/* Encode crc32 for current row */
-	uint32_t crc32c = 0;
-	struct iovec *iov;
-	size_t offset = XLOG_FIXHEADER_SIZE;
-	for (iov = log->obuf.iov; iov->iov_len; ++iov) {
-		crc32c = crc32_calc(crc32c,
-				    (char *)iov->iov_base + offset,
-				    iov->iov_len - offset);
-		offset = 0;
-	}
 	data = mp_encode_uint(data, crc32c);
 	/*
 	 * Encode a padding, to ensure the resulting
@@ -1109,13 +1196,102 @@ xlog_tx_write_plain(struct xlog *log)
 			data += padding - 1;
 		}
 	}
+}
+
+/**
+ * Calculate the checksum of rows stored in an xlog output buffer
+ * after the space reserved for the fixheader.
+ */
+static uint32_t
+xlog_obuf_crc32(struct obuf *obuf)
+{
+	uint32_t crc32c = 0;
+	struct iovec *iov;
+	size_t offset = XLOG_FIXHEADER_SIZE;
+	for (iov = obuf->iov; iov->iov_len; ++iov) {
+		crc32c = crc32_calc(crc32c,
+				    (char *)iov->iov_base + offset,
+				    iov->iov_len - offset);
+		offset = 0;
+	}
+	return crc32c;
+}
+
+/**
+ * Digest the dictionary stored in the xlog meta for the current
+ * compression level unless it's already done. Does nothing if
+ * the xlog has no dictionary. The previously digested dictionary
+ * is freed so the caller must make sure it isn't used anymore.
+ *
+ * @retval 0 success
+ * @retval -1 out of memory, check diag
+ */
+static int
+xlog_load_cdict(struct xlog *log)
+{
+	if (log->meta.dict_size == 0)
+		return 0;
+	int level = log->opts.compression_level;
+	if (log->zcdict != NULL && log->zcdict_level == level)
+		return 0;
+	ZSTD_freeCDict(log->zcdict);
+	log->zcdict = ZSTD_createCDict(log->meta.dict, log->meta.dict_size,
+				       level);
+	if (log->zcdict == NULL) {
+		diag_set(OutOfMemory, log->meta.dict_size, "ZSTD_createCDict",
+			 "xlog dictionary");
+		return -1;
+	}
+	log->zcdict_level = level;
+	return 0;
+}
+
+/**
+ * Start compressing a block with the given dictionary or without
+ * a dictionary if it's NULL.
+ *
+ * @retval 0 success
+ * @retval -1 error, check diag
+ */
+static int
+xlog_compress_begin(ZSTD_CCtx *zctx, const ZSTD_CDict *zcdict, int level)
+{
+	size_t rc;
+	if (zcdict != NULL)
+		rc = ZSTD_compressBegin_usingCDict(zctx, zcdict);
+	else
+		rc = ZSTD_compressBegin(zctx, level);
+	if (ZSTD_isError(rc)) {
+		diag_set(ClientError, ER_COMPRESSION, ZSTD_getErrorName(rc));
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Write a sequence of uncompressed xrow objects.
+ *
+ * @retval -1 error
+ * @retval >= 0 the number of bytes written
+ */
+static off_t
+xlog_tx_write_plain(struct xlog *log)
+{
+	/**
+	 * We created an obuf savepoint at start of xlog_tx,
+	 * now populate it with data.
+	 */
+	char *fixheader = (char *)log->obuf.iov[0].iov_base;
+	xlog_encode_fixheader(fixheader, row_marker,
+			      obuf_size(&log->obuf) - XLOG_FIXHEADER_SIZE,
+			      xlog_obuf_crc32(&log->obuf));
 
 	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
 		diag_set(ClientError, ER_INJECTION, "xlog write injection");
 		return -1;
 	});
 
-	ssize_t written = fio_writevn(log->fd, log->obuf.iov, log->obuf.pos + 1);
+	ssize_t written = xlog_writevn(log, log->obuf.iov, log->obuf.pos + 1);
 	if (written < 0) {
 		diag_set(SystemError, "failed to write to '%s' file",
 			 log->filename);
@@ -1141,8 +1317,10 @@ xlog_tx_write_zstd(struct xlog *log)
 	}
 	uint32_t crc32c = 0;
 	struct iovec *iov;
-	/* 3 is compression level. */
-	ZSTD_compressBegin(log->zctx, 3);
+	if (xlog_load_cdict(log) != 0 ||
+	    xlog_compress_begin(log->zctx, log->zcdict,
+				log->opts.compression_level) != 0)
+		goto error;
 	size_t offset = XLOG_FIXHEADER_SIZE;
 	for (iov = log->obuf.iov; iov->iov_len; ++iov) {
 		/* Estimate max output buffer size. */
@@ -1182,25 +1360,9 @@ xlog_tx_write_zstd(struct xlog *log)
 		offset = 0;
 	}
 
-	memcpy(fixheader, &zrow_marker, sizeof(log_magic_t));
-	char *data;
-	data = fixheader + sizeof(log_magic_t);
-	data = mp_encode_uint(data,
-			      obuf_size(&log->zbuf) - XLOG_FIXHEADER_SIZE);
-	/* Encode crc32 for previous row */
-	data = mp_encode_uint(data, 0);
-	/* Encode crc32 for current row */
-	data = mp_encode_uint(data, crc32c);
-	/* Encode padding */
-	ssize_t padding;
-	padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
-	if (padding > 0) {
-		data = mp_encode_strl(data, padding - 1);
-		if (padding > 1) {
-			memset(data, 0, padding - 1);
-			data += padding - 1;
-		}
-	}
+	xlog_encode_fixheader(fixheader, zrow_marker,
+			      obuf_size(&log->zbuf) - XLOG_FIXHEADER_SIZE,
+			      crc32c);
 
 	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
 		diag_set(ClientError, ER_INJECTION, "xlog write injection");
@@ -1209,8 +1371,7 @@ xlog_tx_write_zstd(struct xlog *log)
 	});
 
 	ssize_t written;
-	written = fio_writevn(log->fd, log->zbuf.iov,
-			      log->zbuf.pos + 1);
+	written = xlog_writevn(log, log->zbuf.iov, log->zbuf.pos + 1);
 	if (written < 0) {
 		diag_set(SystemError, "failed to write to '%s' file",
 			 log->filename);
@@ -1229,27 +1390,12 @@ xlog_tx_write_zstd(struct xlog *log)
 #define SYNC_ROUND_UP(size)	(SYNC_ROUND_DOWN(size + SYNC_MASK))
 
 /**
- * Writes xlog batch to file
+ * Account a write of @a rows rows that took @a written bytes
+ * (-1 if the write failed) and sync the file if needed.
  */
 static ssize_t
-xlog_tx_write(struct xlog *log)
+xlog_tx_complete(struct xlog *log, ssize_t written, int64_t rows)
 {
-	if (obuf_size(&log->obuf) == XLOG_FIXHEADER_SIZE)
-		return 0;
-	ssize_t written;
-
-	if (!log->opts.no_compression &&
-	    obuf_size(&log->obuf) >= XLOG_TX_COMPRESS_THRESHOLD) {
-		written = xlog_tx_write_zstd(log);
-	} else {
-		written = xlog_tx_write_plain(log);
-	}
-	ERROR_INJECT(ERRINJ_WAL_WRITE, {
-		diag_set(ClientError, ER_INJECTION, "xlog write injection");
-		written = -1;
-	});
-
-	obuf_reset(&log->obuf);
 	/*
 	 * Simplify recovery after a temporary write failure:
 	 * truncate the file to the best known good write
@@ -1267,8 +1413,7 @@ xlog_tx_write(struct xlog *log)
 	else
 		log->allocated = 0;
 	log->offset += written;
-	log->rows += log->tx_rows;
-	log->tx_rows = 0;
+	log->rows += rows;
 	if ((log->opts.sync_interval && log->offset >=
 	    (off_t)(log->synced_size + log->opts.sync_interval)) ||
 	    (log->opts.rate_limit && log->offset >=
@@ -1310,6 +1455,33 @@ xlog_tx_write(struct xlog *log)
 	return written;
 }
 
+/**
+ * Writes xlog batch to file
+ */
+static ssize_t
+xlog_tx_write(struct xlog *log)
+{
+	if (obuf_size(&log->obuf) == XLOG_FIXHEADER_SIZE)
+		return 0;
+	ssize_t written;
+
+	if (!log->opts.no_compression && log->opts.compression_level > 0 &&
+	    obuf_size(&log->obuf) >= XLOG_TX_COMPRESS_THRESHOLD) {
+		written = xlog_tx_write_zstd(log);
+	} else {
+		written = xlog_tx_write_plain(log);
+	}
+	ERROR_INJECT(ERRINJ_WAL_WRITE, {
+		diag_set(ClientError, ER_INJECTION, "xlog write injection");
+		written = -1;
+	});
+
+	obuf_reset(&log->obuf);
+	int64_t rows = log->tx_rows;
+	log->tx_rows = 0;
+	return xlog_tx_complete(log, written, rows);
+}
+
 /*
  * Add a row to a log and possibly flush the log.
  *
@@ -1426,6 +1598,295 @@ xlog_flush(struct xlog *log)
 	return xlog_tx_write(log);
 }
 
+void
+xlog_block_create(struct xlog_block *block)
+{
+	obuf_create(&block->obuf, &cord()->slabc,
+		    XLOG_TX_AUTOCOMMIT_THRESHOLD);
+	block->rows = 0;
+	block->compression_level = 0;
+	block->zcdict = NULL;
+	block->zdata = NULL;
+	block->zsize = 0;
+}
+
+void
+xlog_block_reset(struct xlog_block *block)
+{
+	obuf_reset(&block->obuf);
+	block->rows = 0;
+	block->compression_level = 0;
+	block->zcdict = NULL;
+	free(block->zdata);
+	block->zdata = NULL;
+	block->zsize = 0;
+}
+
+void
+xlog_block_destroy(struct xlog_block *block)
+{
+	assert(block->obuf.slabc == &cord()->slabc);
+	obuf_destroy(&block->obuf);
+	free(block->zdata);
+}
+
+bool
+xlog_tx_commit_buffered(struct xlog *log)
+{
+	log->is_autocommit = true;
+	return obuf_size(&log->obuf) >= XLOG_TX_AUTOCOMMIT_THRESHOLD;
+}
+
+bool
+xlog_flush_block(struct xlog *log, struct xlog_block *block)
+{
+	assert(log->is_autocommit);
+	assert(obuf_size(&block->obuf) == 0);
+	assert(block->zdata == NULL);
+	if (obuf_size(&log->obuf) <= XLOG_FIXHEADER_SIZE) {
+		obuf_reset(&log->obuf);
+		return false;
+	}
+	/* Swap the buffers so that both keep their slabs. */
+	struct obuf obuf = log->obuf;
+	log->obuf = block->obuf;
+	block->obuf = obuf;
+	block->rows = log->tx_rows;
+	log->tx_rows = 0;
+	if (!log->opts.no_compression &&
+	    obuf_size(&block->obuf) >= XLOG_TX_COMPRESS_THRESHOLD)
+		block->compression_level = log->opts.compression_level;
+	else
+		block->compression_level = 0;
+	block->zcdict = NULL;
+	if (block->compression_level > 0) {
+		/* The block can still be written uncompressed. */
+		if (xlog_load_cdict(log) != 0) {
+			diag_log();
+			diag_clear(diag_get());
+			block->compression_level = 0;
+		}
+		block->zcdict = log->zcdict;
+	}
+	return true;
+}
+
+/**
+ * Compress the rows of a block into a buffer allocated with malloc().
+ * Returns 0 on success. On failure, sets diag and returns -1.
+ */
+static int
+xlog_block_compress(struct xlog_block *block, ZSTD_CCtx *zctx)
+{
+	struct obuf *obuf = &block->obuf;
+	size_t zmax_size = XLOG_FIXHEADER_SIZE;
+	size_t offset = XLOG_FIXHEADER_SIZE;
+	struct iovec *iov;
+	for (iov = obuf->iov; iov->iov_len; ++iov) {
+		zmax_size += ZSTD_compressBound(iov->iov_len - offset);
+		offset = 0;
+	}
+	char *zdata = malloc(zmax_size);
+	if (zdata == NULL) {
+		diag_set(OutOfMemory, zmax_size, "malloc",
+			 "compression buffer");
+		return -1;
+	}
+	char *zdst = zdata + XLOG_FIXHEADER_SIZE;
+	uint32_t crc32c = 0;
+	if (xlog_compress_begin(zctx, block->zcdict,
+				block->compression_level) != 0) {
+		free(zdata);
+		return -1;
+	}
+	offset = XLOG_FIXHEADER_SIZE;
+	for (iov = obuf->iov; iov->iov_len; ++iov) {
+		size_t (*fcompress)(ZSTD_CCtx *, void *, size_t,
+				    const void *, size_t);
+		/* See xlog_tx_write_zstd(). */
+		if (iov == obuf->iov + obuf->pos || !(iov + 1)->iov_len)
+			fcompress = ZSTD_compressEnd;
+		else
+			fcompress = ZSTD_compressContinue;
+		size_t zsize = fcompress(zctx, zdst,
+					 zdata + zmax_size - zdst,
+					 (char *)iov->iov_base + offset,
+					 iov->iov_len - offset);
+		if (ZSTD_isError(zsize)) {
+			diag_set(ClientError, ER_COMPRESSION,
+				 ZSTD_getErrorName(zsize));
+			free(zdata);
+			return -1;
+		}
+		crc32c = crc32_calc(crc32c, zdst, zsize);
+		zdst += zsize;
+		offset = 0;
+	}
+	xlog_encode_fixheader(zdata, zrow_marker,
+			      zdst - zdata - XLOG_FIXHEADER_SIZE, crc32c);
+	block->zdata = zdata;
+	block->zsize = zdst - zdata;
+	return 0;
+}
+
+void
+xlog_block_prepare(struct xlog_block *block, ZSTD_CCtx *zctx)
+{
+	assert(obuf_size(&block->obuf) > XLOG_FIXHEADER_SIZE);
+	assert(block->zdata == NULL);
+	if (block->compression_level > 0 && zctx != NULL) {
+		if (xlog_block_compress(block, zctx) == 0)
+			return;
+		/* The block can still be written uncompressed. */
+		diag_log();
+		diag_clear(diag_get());
+	}
+	char *fixheader = (char *)block->obuf.iov[0].iov_base;
+	xlog_encode_fixheader(fixheader, row_marker,
+			      obuf_size(&block->obuf) - XLOG_FIXHEADER_SIZE,
+			      xlog_obuf_crc32(&block->obuf));
+}
+
+ssize_t
+xlog_write_blocks(struct xlog *log, struct stailq *blocks)
+{
+	int iovcnt = 0;
+	int64_t rows = 0;
+	struct xlog_block *block;
+	stailq_foreach_entry(block, blocks, in_list) {
+		iovcnt += block->zdata != NULL ? 1 : block->obuf.pos + 1;
+		rows += block->rows;
+	}
+	size_t region_svp = region_used(&fiber()->gc);
+	size_t size;
+	struct iovec *iov = region_alloc_array(&fiber()->gc, struct iovec,
+					       iovcnt, &size);
+	if (iov == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "iov");
+		return xlog_tx_complete(log, -1, 0);
+	}
+	struct iovec *pos = iov;
+	stailq_foreach_entry(block, blocks, in_list) {
+		if (block->zdata != NULL) {
+			pos->iov_base = block->zdata;
+			pos->iov_len = block->zsize;
+			pos++;
+		} else {
+			memcpy(pos, block->obuf.iov,
+			       (block->obuf.pos + 1) * sizeof(*pos));
+			pos += block->obuf.pos + 1;
+		}
+	}
+	assert(pos == iov + iovcnt);
+	ssize_t written = 0;
+	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
+		diag_set(ClientError, ER_INJECTION, "xlog write injection");
+		written = -1;
+	});
+	if (written == 0) {
+		written = xlog_writevn(log, iov, iovcnt);
+		if (written < 0) {
+			diag_set(SystemError, "failed to write to '%s' file",
+				 log->filename);
+		}
+	}
+	ERROR_INJECT(ERRINJ_WAL_WRITE, {
+		diag_set(ClientError, ER_INJECTION, "xlog write injection");
+		written = -1;
+	});
+	region_truncate(&fiber()->gc, region_svp);
+	return xlog_tx_complete(log, written, rows);
+}
+
+void
+xlog_dict_builder_create(struct xlog_dict_builder *builder)
+{
+	memset(builder, 0, sizeof(*builder));
+}
+
+void
+xlog_dict_builder_destroy(struct xlog_dict_builder *builder)
+{
+	free(builder->samples);
+	free(builder->sample_sizes);
+}
+
+bool
+xlog_dict_builder_add(struct xlog_dict_builder *builder,
+		      const struct iovec *iov, int iovcnt)
+{
+	size_t size = 0;
+	for (int i = 0; i < iovcnt; i++)
+		size += iov[i].iov_len;
+	size = MIN(size, (size_t)XLOG_DICT_SAMPLE_SIZE_MAX);
+	if (size == 0)
+		return true;
+	if (builder->samples_size + size > XLOG_DICT_SAMPLES_SIZE_MAX)
+		return false;
+	if (builder->samples == NULL) {
+		builder->samples = malloc(XLOG_DICT_SAMPLES_SIZE_MAX);
+		if (builder->samples == NULL)
+			return false;
+	}
+	if (builder->sample_count == builder->sample_count_max) {
+		unsigned count = MAX(builder->sample_count_max * 2, 1024U);
+		size_t *sizes = realloc(builder->sample_sizes,
+					count * sizeof(*sizes));
+		if (sizes == NULL)
+			return false;
+		builder->sample_sizes = sizes;
+		builder->sample_count_max = count;
+	}
+	char *pos = builder->samples + builder->samples_size;
+	size_t left = size;
+	for (int i = 0; i < iovcnt && left > 0; i++) {
+		size_t len = MIN(iov[i].iov_len, left);
+		memcpy(pos, iov[i].iov_base, len);
+		pos += len;
+		left -= len;
+	}
+	builder->sample_sizes[builder->sample_count++] = size;
+	builder->samples_size += size;
+	return true;
+}
+
+bool
+xlog_dict_builder_is_ready(struct xlog_dict_builder *builder)
+{
+	return builder->samples_size >= XLOG_DICT_SAMPLES_SIZE_MIN;
+}
+
+int
+xlog_dict_builder_train(struct xlog_dict_builder *builder,
+			char *dict, size_t *dict_size)
+{
+	/*
+	 * Unlike ZDICT_trainFromBuffer(), don't search for the best
+	 * parameters, because a dictionary is trained in the thread
+	 * writing the file and a single pass is much faster.
+	 */
+	ZDICT_fastCover_params_t params;
+	memset(&params, 0, sizeof(params));
+	params.k = 200;
+	params.d = 8;
+	params.f = 16;
+	params.accel = 1;
+	params.splitPoint = 1.0;
+	size_t rc = ZDICT_trainFromBuffer_fastCover(dict, XLOG_DICT_SIZE_MAX,
+						    builder->samples,
+						    builder->sample_sizes,
+						    builder->sample_count,
+						    params);
+	xlog_dict_builder_reset(builder);
+	if (ZDICT_isError(rc)) {
+		diag_set(ClientError, ER_COMPRESSION,
+			 ZDICT_getErrorName(rc));
+		return -1;
+	}
+	*dict_size = rc;
+	return 0;
+}
+
 static int
 sync_cb(eio_req *req)
 {
@@ -1834,7 +2295,8 @@ xlog_tx_cursor_create(struct xlog_tx_cursor *tx_cursor,
 	};
 
 	assert(fixheader.magic == zrow_marker);
-	ZSTD_initDStream(zdctx);
+	/* Keep the dictionary loaded by xlog_cursor_create_dctx(). */
+	ZSTD_DCtx_reset(zdctx, ZSTD_reset_session_only);
 	int rc;
 	do {
 		if (ibuf_reserve(&tx_cursor->rows,
@@ -2029,6 +2491,33 @@ xlog_cursor_next(struct xlog_cursor *cursor,
 	return 0;
 }
 
+/**
+ * Create a decompression context for reading a file with the given
+ * meta. If the file has a dictionary, it's loaded to the context.
+ * Returns NULL and sets diag on error.
+ */
+static ZSTD_DStream *
+xlog_cursor_create_dctx(const struct xlog_meta *meta)
+{
+	ZSTD_DStream *zdctx = ZSTD_createDStream();
+	if (zdctx == NULL) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 "failed to create context");
+		return NULL;
+	}
+	if (meta->dict_size == 0)
+		return zdctx;
+	size_t rc = ZSTD_DCtx_loadDictionary(zdctx, meta->dict,
+					     meta->dict_size);
+	if (ZSTD_isError(rc)) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 ZSTD_getErrorName(rc));
+		ZSTD_freeDStream(zdctx);
+		return NULL;
+	}
+	return zdctx;
+}
+
 int
 xlog_cursor_openfd(struct xlog_cursor *i, int fd, const char *name)
 {
@@ -2056,12 +2545,9 @@ xlog_cursor_openfd(struct xlog_cursor *i, int fd, const char *name)
 		goto error;
 	}
 	snprintf(i->name, sizeof(i->name), "%s", name);
-	i->zdctx = ZSTD_createDStream();
-	if (i->zdctx == NULL) {
-		diag_set(ClientError, ER_DECOMPRESSION,
-			 "failed to create context");
+	i->zdctx = xlog_cursor_create_dctx(&i->meta);
+	if (i->zdctx == NULL)
 		goto error;
-	}
 	i->state = XLOG_CURSOR_ACTIVE;
 	return 0;
 error:
@@ -2113,12 +2599,9 @@ xlog_cursor_openmem(struct xlog_cursor *i, const char *data, size_t size,
 		goto error;
 	}
 	snprintf(i->name, sizeof(i->name), "%s", name);
-	i->zdctx = ZSTD_createDStream();
-	if (i->zdctx == NULL) {
-		diag_set(ClientError, ER_DECOMPRESSION,
-			 "failed to create context");
+	i->zdctx = xlog_cursor_create_dctx(&i->meta);
+	if (i->zdctx == NULL)
 		goto error;
-	}
 	i->state = XLOG_CURSOR_ACTIVE;
 	return 0;
 error:
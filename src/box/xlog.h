@@ -41,6 +41,7 @@
 
 #include "small/ibuf.h"
 #include "small/obuf.h"
+#include "salad/stailq.h"
 
 struct iovec;
 struct xrow_header;
@@ -74,6 +75,14 @@ struct xlog_opts {
 	 * block writers when an xlog is rotated.
 	 */
 	bool sync_is_async;
+	/**
+	 * If this flag is set and the calling thread has an io_uring
+	 * ring (see coio_uring.h), xlog blocks are written with it so
+	 * that other fibers of the thread may run during a write.
+	 *
+	 * This option is useful for WAL files.
+	 */
+	bool write_with_uring;
 	/**
 	 * If this flag is set, the xlog writer won't use zstd
 	 * compression.
@@ -82,6 +91,30 @@ struct xlog_opts {
 	 * to be read frequently, e.g. L1 run files in Vinyl.
 	 */
 	bool no_compression;
+	/**
+	 * zstd compression level used for xlog blocks. 0 disables
+	 * compression of newly written blocks, but unlike
+	 * no_compression it may be changed for an open xlog.
+	 */
+	int compression_level;
+};
+
+enum {
+	/** Default zstd compression level of xlog blocks. */
+	XLOG_COMPRESSION_LEVEL_DEFAULT = 3,
+	/** Maximal zstd compression level of xlog blocks. */
+	XLOG_COMPRESSION_LEVEL_MAX = 22,
+	/** Maximal size of a zstd dictionary stored in xlog meta. */
+	XLOG_DICT_SIZE_MAX = 4096,
+	/** Dictionary samples longer than this are truncated. */
+	XLOG_DICT_SAMPLE_SIZE_MAX = 1024,
+	/**
+	 * Max size of samples to train a dictionary on. zstd
+	 * recommends about 100 times the dictionary size.
+	 */
+	XLOG_DICT_SAMPLES_SIZE_MAX = 100 * XLOG_DICT_SIZE_MAX,
+	/** Don't train a dictionary on less data than this. */
+	XLOG_DICT_SAMPLES_SIZE_MIN = 10 * XLOG_DICT_SIZE_MAX,
 };
 
 extern const struct xlog_opts xlog_opts_default;
@@ -153,6 +186,14 @@ struct xdir {
 	 * Directory path.
 	 */
 	char dirname[PATH_MAX];
+	/**
+	 * zstd dictionary stored in the meta of new files and used
+	 * for compressing their blocks, allocated with malloc(),
+	 * or NULL. See xdir_set_dict().
+	 */
+	char *dict;
+	/** Size of the dictionary. */
+	size_t dict_size;
 };
 
 /**
@@ -168,6 +209,17 @@ xdir_create(struct xdir *dir, const char *dirname, const char *filetype,
 void
 xdir_destroy(struct xdir *dir);
 
+/**
+ * Set the zstd dictionary for files created in the directory
+ * from now on. Pass NULL to create files without a dictionary.
+ * Files that are already open keep their dictionaries.
+ *
+ * @retval 0 success
+ * @retval -1 out of memory, check diag
+ */
+int
+xdir_set_dict(struct xdir *dir, const char *dict, size_t dict_size);
+
 /**
  * Scan or re-scan a directory and update directory
  * index with all log files (or snapshots) in the directory.
@@ -349,6 +401,21 @@ struct xlog_meta {
 	 * directory for missing WALs.
 	 */
 	struct vclock prev_vclock;
+	/**
+	 * Text file header: vector clock of the file this file
+	 * is a delta to. Set only for delta snapshots, which
+	 * store only the data changed since the base snapshot.
+	 */
+	struct vclock base_vclock;
+	/**
+	 * Text file header: zstd dictionary used for compressing
+	 * the file blocks, stored base64-encoded. Files with
+	 * a dictionary can't be read by versions that don't
+	 * support it.
+	 */
+	char dict[XLOG_DICT_SIZE_MAX];
+	/** Size of the dictionary, 0 if the file has none. */
+	size_t dict_size;
 };
 
 /**
@@ -421,6 +488,13 @@ struct xlog {
 	struct obuf obuf;
 	/** The context of zstd compression */
 	ZSTD_CCtx *zctx;
+	/**
+	 * The dictionary from the meta digested for compression
+	 * at level zcdict_level or NULL, created on demand.
+	 */
+	ZSTD_CDict *zcdict;
+	/** Compression level of zcdict. */
+	int zcdict_level;
 	/**
 	 * Compressed output buffer
 	 */
@@ -465,6 +539,16 @@ int
 xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 		 const struct vclock *vclock);
 
+/**
+ * Same as xdir_create_xlog(), but also stores @a base_vclock in
+ * the file meta to mark the new file as a delta to the file with
+ * the given vclock. @a base_vclock may be NULL.
+ */
+int
+xdir_create_delta_xlog(struct xdir *dir, struct xlog *xlog,
+		       const struct vclock *vclock,
+		       const struct vclock *base_vclock);
+
 /**
  * Shortcut for xdir_create_xlog() + xlog_materialize().
  */
@@ -567,6 +651,158 @@ xlog_tx_rollback(struct xlog *log);
 ssize_t
 xlog_flush(struct xlog *log);
 
+/**
+ * A block of rows detached from the xlog output buffer with
+ * xlog_flush_block(). Lets the caller checksum and compress
+ * blocks out of line, possibly in other threads, and then write
+ * them in order with xlog_write_blocks().
+ */
+struct xlog_block {
+	/** Rows, preceded by the space reserved for the fixheader. */
+	struct obuf obuf;
+	/** Number of rows in the block. */
+	int64_t rows;
+	/** zstd compression level, 0 if the block isn't compressed. */
+	int compression_level;
+	/**
+	 * Dictionary of the xlog the block belongs to or NULL.
+	 * Owned by the xlog, which must not be closed or have
+	 * its compression level changed until the block is
+	 * written.
+	 */
+	const ZSTD_CDict *zcdict;
+	/**
+	 * The compressed block, including the fixheader, allocated
+	 * with malloc(), or NULL if the rows are written as is.
+	 */
+	char *zdata;
+	/** Size of the compressed block. */
+	size_t zsize;
+	/** Link in a list of blocks to write. */
+	struct stailq_entry in_list;
+};
+
+/** Size of a prepared block on disk. */
+static inline size_t
+xlog_block_size(struct xlog_block *block)
+{
+	return block->zdata != NULL ? block->zsize : obuf_size(&block->obuf);
+}
+
+/** Initialize an empty block. */
+void
+xlog_block_create(struct xlog_block *block);
+
+/** Empty a block so that it can be reused. */
+void
+xlog_block_reset(struct xlog_block *block);
+
+/** Free memory used by a block. */
+void
+xlog_block_destroy(struct xlog_block *block);
+
+/**
+ * Like xlog_tx_commit(), but never writes the buffered rows.
+ *
+ * @retval true if the buffer is big enough to be moved to
+ *         a block with xlog_flush_block()
+ * @retval false otherwise
+ */
+bool
+xlog_tx_commit_buffered(struct xlog *log);
+
+/**
+ * Move all buffered rows to an empty block.
+ *
+ * @retval true if the block was filled
+ * @retval false if there are no buffered rows
+ */
+bool
+xlog_flush_block(struct xlog *log, struct xlog_block *block);
+
+/**
+ * Encode the fixheader of a block and compress it if needed.
+ * Only the block is accessed so the function may be called in
+ * any thread, the zstd context must belong to that thread. If
+ * the context is NULL or the compression fails, the block is
+ * written uncompressed.
+ */
+void
+xlog_block_prepare(struct xlog_block *block, ZSTD_CCtx *zctx);
+
+/**
+ * Write a list of prepared blocks to the xlog file in one go.
+ * On failure, the file is truncated to the last good position.
+ *
+ * @retval >= 0 the number of bytes written
+ * @retval -1 error, check diag
+ */
+ssize_t
+xlog_write_blocks(struct xlog *log, struct stailq *blocks);
+
+/**
+ * Collects samples of rows and trains a zstd dictionary on them
+ * to be stored in the meta of new xlog files, see xdir_set_dict().
+ * A dictionary helps to compress small blocks, which don't have
+ * enough data to learn from.
+ */
+struct xlog_dict_builder {
+	/** Samples stored one after another. */
+	char *samples;
+	/** Total size of the samples. */
+	size_t samples_size;
+	/** Sizes of the samples. */
+	size_t *sample_sizes;
+	/** Number of the samples. */
+	unsigned sample_count;
+	/** Capacity of the sample_sizes array. */
+	unsigned sample_count_max;
+};
+
+/** Initialize an empty dictionary builder. */
+void
+xlog_dict_builder_create(struct xlog_dict_builder *builder);
+
+/** Free memory used by a dictionary builder. */
+void
+xlog_dict_builder_destroy(struct xlog_dict_builder *builder);
+
+/** Drop all samples collected so far. */
+static inline void
+xlog_dict_builder_reset(struct xlog_dict_builder *builder)
+{
+	builder->samples_size = 0;
+	builder->sample_count = 0;
+}
+
+/**
+ * Add a sample consisting of @a iovcnt pieces. Long samples are
+ * truncated, empty samples are ignored.
+ *
+ * @retval true the sample was added
+ * @retval false the builder is full or memory allocation failed
+ */
+bool
+xlog_dict_builder_add(struct xlog_dict_builder *builder,
+		      const struct iovec *iov, int iovcnt);
+
+/** Check if there are enough samples to train a dictionary. */
+bool
+xlog_dict_builder_is_ready(struct xlog_dict_builder *builder);
+
+/**
+ * Train a dictionary on the samples collected so far and drop
+ * the samples.
+ *
+ * @param dict       buffer of XLOG_DICT_SIZE_MAX bytes
+ * @param dict_size  set to the size of the trained dictionary
+ * @retval 0 success
+ * @retval -1 error, check diag
+ */
+int
+xlog_dict_builder_train(struct xlog_dict_builder *builder,
+			char *dict, size_t *dict_size);
+
 /**
  * Closes an xlog object.
  *
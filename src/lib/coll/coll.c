@@ -138,6 +138,36 @@ coll_bin_hash(const char *s, size_t s_len, uint32_t *ph, uint32_t *pcarry,
 	return s_len;
 }
 
+/** Get a sort key of a string using ICU collation. */
+static uint32_t
+coll_icu_sort_key(const char *s, size_t s_len, coll_sort_key_part_f cb,
+		  void *arg, struct coll *coll)
+{
+	uint32_t total_size = 0;
+	UCharIterator itr;
+	uiter_setUTF8(&itr, s, s_len);
+	uint8_t *buf = (uint8_t *) tt_static_buf();
+	uint32_t state[2] = {0, 0};
+	UErrorCode status = U_ZERO_ERROR;
+	int32_t got;
+	do {
+		got = ucol_nextSortKeyPart(coll->collator, &itr, state, buf,
+					   TT_STATIC_BUF_LEN, &status);
+		cb((const char *)buf, got, arg);
+		total_size += got;
+	} while (got == TT_STATIC_BUF_LEN);
+	return total_size;
+}
+
+static uint32_t
+coll_bin_sort_key(const char *s, size_t s_len, coll_sort_key_part_f cb,
+		  void *arg, struct coll *coll)
+{
+	(void) coll;
+	cb(s, s_len, arg);
+	return s_len;
+}
+
 static size_t
 coll_icu_hint(const char *s, size_t s_len, char *buf, size_t buf_len,
 	      struct coll *coll)
@@ -272,6 +302,7 @@ coll_icu_init_cmp(struct coll *coll, const struct coll_def *def)
 	coll->cmp = coll_icu_cmp;
 	coll->hash = coll_icu_hash;
 	coll->hint = coll_icu_hint;
+	coll->sort_key = coll_icu_sort_key;
 	return 0;
 }
 
@@ -387,6 +418,7 @@ coll_new(const struct coll_def *def)
 		coll->cmp = coll_bin_cmp;
 		coll->hash = coll_bin_hash;
 		coll->hint = coll_bin_hint;
+		coll->sort_key = coll_bin_sort_key;
 		break;
 	default:
 		unreachable();
@@ -51,6 +51,13 @@ typedef uint32_t (*coll_hash_f)(const char *s, size_t s_len, uint32_t *ph,
 typedef size_t (*coll_hint_f)(const char *s, size_t s_len, char *buf,
 			      size_t buf_len, struct coll *coll);
 
+typedef void (*coll_sort_key_part_f)(const char *data, size_t size,
+				     void *arg);
+
+typedef uint32_t (*coll_sort_key_f)(const char *s, size_t s_len,
+				    coll_sort_key_part_f cb, void *arg,
+				    struct coll *coll);
+
 struct UCollator;
 
 /** Default universal casemap for case transformations. */
@@ -79,6 +86,16 @@ struct coll {
 	 * copied. Sort keys may be compared using strcmp().
 	 */
 	coll_hint_f hint;
+	/**
+	 * String sort key.
+	 *
+	 * This function passes the sort key for a string to
+	 * the given callback in consecutive parts and returns
+	 * the sort key size. Strings that are equal according
+	 * to the collation have equal sort keys, so it may be
+	 * used for hashing with any hash function.
+	 */
+	coll_sort_key_f sort_key;
 	/** Reference counter. */
 	int refs;
 	/**
@@ -30,6 +30,7 @@
  */
 #include "coio_file.h"
 #include "coio_task.h"
+#include "coio_uring.h"
 #include "fiber.h"
 #include "say.h"
 #include "fio.h"
@@ -164,6 +165,9 @@ coio_file_close(int fd)
 ssize_t
 coio_pwrite(int fd, const void *buf, size_t count, off_t offset)
 {
+	if (coio_uring_is_enabled())
+		return coio_uring_pwrite(fd, buf, count, offset);
+
 	ssize_t left = count, pos = 0, res, chunk;
 	eio_req *req;
 
@@ -193,6 +197,9 @@ coio_pwrite(int fd, const void *buf, size_t count, off_t offset)
 ssize_t
 coio_pread(int fd, void *buf, size_t count, off_t offset)
 {
+	if (coio_uring_is_enabled())
+		return coio_uring_pread(fd, buf, count, offset);
+
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_read(fd, buf, count,
 				offset, 0, coio_complete, &eio);
@@ -535,6 +542,9 @@ coio_sync(void)
 int
 coio_fsync(int fd)
 {
+	if (coio_uring_is_enabled())
+		return coio_uring_fsync(fd);
+
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_fsync(fd, 0, coio_complete, &eio);
 	return coio_wait_done(req, &eio);
@@ -543,6 +553,9 @@ coio_fsync(int fd)
 int
 coio_fdatasync(int fd)
 {
+	if (coio_uring_is_enabled())
+		return coio_uring_fdatasync(fd);
+
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_fdatasync(fd, 0, coio_complete, &eio);
 	return coio_wait_done(req, &eio);
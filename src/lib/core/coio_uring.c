@@ -0,0 +1,634 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2025, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "coio_uring.h"
+
+#include "trivia/config.h"
+#include "tweaks.h"
+
+bool coio_uring_enabled = true;
+TWEAK_BOOL(coio_uring_enabled);
+
+#if defined(HAVE_IO_URING)
+
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "errinj.h"
+#include "fiber.h"
+#include "say.h"
+#include "small/rlist.h"
+#include "trivia/util.h"
+#include "tt_strerror.h"
+
+enum {
+	/** Number of submission queue entries of a ring. */
+	COIO_URING_ENTRIES = 256,
+	/** Max opcode number checked with IORING_REGISTER_PROBE. */
+	COIO_URING_PROBE_OPS = 256,
+};
+
+/** Initial delay before retrying a failed submission, in seconds. */
+static const double COIO_URING_RETRY_DELAY_MIN = 0.001;
+/** Max delay before retrying a failed submission, in seconds. */
+static const double COIO_URING_RETRY_DELAY_MAX = 0.1;
+
+/** A file I/O request issued by a fiber. */
+struct coio_uring_req {
+	/** The fiber waiting for the request completion. */
+	struct fiber *fiber;
+	/** Result of the operation, negated errno on failure. */
+	int result;
+	/** Set when the completion is reaped. */
+	bool done;
+};
+
+/** A fiber waiting for a free request slot. */
+struct coio_uring_waiter {
+	/** Link in coio_uring::slot_waiters. */
+	struct rlist link;
+	struct fiber *fiber;
+};
+
+/** io_uring instance driven by a thread event loop. */
+struct coio_uring {
+	/** io_uring file descriptor. */
+	int fd;
+	/** eventfd signalled by the kernel on request completion. */
+	int event_fd;
+	/** Mapped submission ring. */
+	void *sq_ptr;
+	size_t sq_size;
+	/** Mapped completion ring. */
+	void *cq_ptr;
+	size_t cq_size;
+	/** Mapped submission queue entries. */
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+	/** Submission ring pointers, see io_uring_setup(2). */
+	unsigned *sq_head;
+	unsigned *sq_tail;
+	unsigned *sq_array;
+	unsigned sq_mask;
+	unsigned sq_entries;
+	/** Completion ring pointers, see io_uring_setup(2). */
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	struct io_uring_cqe *cqes;
+	unsigned cq_mask;
+	/** Number of queued entries not submitted to the kernel yet. */
+	unsigned n_pending;
+	/**
+	 * Number of requests queued and not completed yet. Never
+	 * exceeds sq_entries so neither ring can overflow.
+	 */
+	unsigned n_inflight;
+	/** Fibers waiting for n_inflight to drop below sq_entries. */
+	struct rlist slot_waiters;
+	/** Event loop driving the ring. */
+	struct ev_loop *loop;
+	/** Reaps completions when event_fd is signalled. */
+	struct ev_io complete_io;
+	/** Submits queued entries before the event loop blocks. */
+	struct ev_prepare submit_prepare;
+	/** Retries a submission the kernel couldn't accept. */
+	struct ev_timer retry_timer;
+	/** Delay of the next retry, 0 if the last submission succeeded. */
+	double retry_delay;
+};
+
+/** Ring of the current thread or NULL if io_uring is unavailable. */
+static __thread struct coio_uring *coio_uring;
+
+static int
+sys_io_uring_setup(unsigned entries, struct io_uring_params *params)
+{
+	return syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int
+sys_io_uring_enter(int fd, unsigned to_submit)
+{
+	return syscall(__NR_io_uring_enter, fd, to_submit, 0, 0, NULL, 0);
+}
+
+static int
+sys_io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args)
+{
+	return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+/** Check that the kernel supports all operations we use. */
+static bool
+coio_uring_probe(int fd)
+{
+	static const int ops[] = {
+		IORING_OP_READ, IORING_OP_WRITE, IORING_OP_WRITEV,
+		IORING_OP_FSYNC,
+	};
+	struct io_uring_probe *probe = xcalloc(1, sizeof(*probe) +
+			COIO_URING_PROBE_OPS * sizeof(probe->ops[0]));
+	bool ok = sys_io_uring_register(fd, IORING_REGISTER_PROBE, probe,
+					COIO_URING_PROBE_OPS) == 0;
+	for (size_t i = 0; ok && i < lengthof(ops); i++) {
+		ok = ops[i] <= probe->last_op &&
+		     (probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED) != 0;
+	}
+	free(probe);
+	return ok;
+}
+
+static void
+coio_uring_delete(struct coio_uring *ring)
+{
+	if (ring->loop != NULL) {
+		ev_io_stop(ring->loop, &ring->complete_io);
+		ev_prepare_stop(ring->loop, &ring->submit_prepare);
+		ev_timer_stop(ring->loop, &ring->retry_timer);
+	}
+	if (ring->sqes != NULL && ring->sqes != MAP_FAILED)
+		munmap(ring->sqes, ring->sqes_size);
+	if (ring->cq_ptr != NULL && ring->cq_ptr != MAP_FAILED)
+		munmap(ring->cq_ptr, ring->cq_size);
+	if (ring->sq_ptr != NULL && ring->sq_ptr != MAP_FAILED)
+		munmap(ring->sq_ptr, ring->sq_size);
+	if (ring->event_fd >= 0)
+		close(ring->event_fd);
+	close(ring->fd);
+	free(ring);
+}
+
+/** Set the result of a request and wake up the waiting fiber. */
+static void
+coio_uring_complete(struct coio_uring *ring, struct coio_uring_req *req,
+		    int result)
+{
+	req->result = result;
+	req->done = true;
+	fiber_wakeup(req->fiber);
+	assert(ring->n_inflight > 0);
+	ring->n_inflight--;
+}
+
+/** Wake up at most @a count fibers waiting for a free request slot. */
+static void
+coio_uring_wakeup_slot_waiters(struct coio_uring *ring, unsigned count)
+{
+	for (; count > 0 && !rlist_empty(&ring->slot_waiters); count--) {
+		struct coio_uring_waiter *waiter = rlist_shift_entry(
+			&ring->slot_waiters, struct coio_uring_waiter, link);
+		fiber_wakeup(waiter->fiber);
+	}
+}
+
+/**
+ * Fail the entries queued since the last submission. Without
+ * IORING_SETUP_SQPOLL the kernel only reads the submission ring
+ * in io_uring_enter(2) so the entries may be taken back.
+ */
+static void
+coio_uring_fail_pending(struct coio_uring *ring, int error)
+{
+	unsigned count = ring->n_pending;
+	unsigned tail = *ring->sq_tail;
+	for (unsigned i = 0; i < count; i++) {
+		tail--;
+		struct io_uring_sqe *sqe = &ring->sqes[tail & ring->sq_mask];
+		struct coio_uring_req *req =
+			(struct coio_uring_req *)(uintptr_t)sqe->user_data;
+		coio_uring_complete(ring, req, -error);
+	}
+	__atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+	ring->n_pending = 0;
+	coio_uring_wakeup_slot_waiters(ring, count);
+}
+
+/**
+ * Retry the submission after a delay. The delay is doubled on each
+ * failed attempt so as not to spin while the kernel is short of
+ * resources or the completion ring is full.
+ */
+static void
+coio_uring_submit_later(struct coio_uring *ring)
+{
+	if (ring->retry_delay == 0)
+		ring->retry_delay = COIO_URING_RETRY_DELAY_MIN;
+	else
+		ring->retry_delay = MIN(ring->retry_delay * 2,
+					COIO_URING_RETRY_DELAY_MAX);
+	ev_timer_set(&ring->retry_timer, ring->retry_delay, 0);
+	ev_timer_start(ring->loop, &ring->retry_timer);
+}
+
+/**
+ * Submit all queued entries to the kernel. If the kernel can't
+ * accept them right now, retries later. On any other error, fails
+ * the queued requests with the error.
+ */
+static void
+coio_uring_submit(struct coio_uring *ring)
+{
+	ev_prepare_stop(ring->loop, &ring->submit_prepare);
+	while (ring->n_pending > 0) {
+		int rc = sys_io_uring_enter(ring->fd, ring->n_pending);
+		if (rc > 0) {
+			assert((unsigned)rc <= ring->n_pending);
+			ring->n_pending -= rc;
+			continue;
+		}
+		if (rc < 0 && errno == EINTR)
+			continue;
+		if (rc == 0 || errno == EAGAIN || errno == EBUSY) {
+			coio_uring_submit_later(ring);
+			return;
+		}
+		say_syserror("io_uring_enter failed");
+		coio_uring_fail_pending(ring, errno);
+	}
+	ring->retry_delay = 0;
+}
+
+static void
+coio_uring_submit_cb(struct ev_loop *loop, struct ev_prepare *watcher,
+		     int events)
+{
+	(void)loop;
+	(void)events;
+	coio_uring_submit((struct coio_uring *)watcher->data);
+}
+
+static void
+coio_uring_retry_cb(struct ev_loop *loop, struct ev_timer *watcher,
+		    int events)
+{
+	(void)loop;
+	(void)events;
+	coio_uring_submit((struct coio_uring *)watcher->data);
+}
+
+/** Reap all available completions and wake up the waiting fibers. */
+static void
+coio_uring_complete_cb(struct ev_loop *loop, struct ev_io *watcher,
+		       int events)
+{
+	(void)loop;
+	(void)events;
+	struct coio_uring *ring = (struct coio_uring *)watcher->data;
+	/*
+	 * Reset the counter before reaping so that a completion
+	 * posted after that signals the eventfd again.
+	 */
+	uint64_t value;
+	if (read(ring->event_fd, &value, sizeof(value)) < 0 &&
+	    errno != EAGAIN && errno != EINTR)
+		say_syserror("failed to read io_uring eventfd");
+	unsigned head = *ring->cq_head;
+	unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+	unsigned count = tail - head;
+	for (; head != tail; head++) {
+		struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+		coio_uring_complete(ring, (struct coio_uring_req *)
+				    (uintptr_t)cqe->user_data, cqe->res);
+	}
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+	coio_uring_wakeup_slot_waiters(ring, count);
+}
+
+void
+coio_uring_init(void)
+{
+	assert(coio_uring == NULL);
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	int fd = sys_io_uring_setup(COIO_URING_ENTRIES, &params);
+	if (fd < 0) {
+		say_verbose("io_uring is not available: %s",
+			    tt_strerror(errno));
+		return;
+	}
+	struct coio_uring *ring = xcalloc(1, sizeof(*ring));
+	ring->fd = fd;
+	ring->event_fd = -1;
+	rlist_create(&ring->slot_waiters);
+	if (!coio_uring_probe(fd)) {
+		say_verbose("io_uring is not available: "
+			    "required operations are not supported");
+		goto fail;
+	}
+	if ((params.features & IORING_FEAT_RW_CUR_POS) == 0) {
+		say_verbose("io_uring is not available: "
+			    "writes at the current file position are not "
+			    "supported");
+		goto fail;
+	}
+	ring->sq_size = params.sq_off.array +
+			params.sq_entries * sizeof(unsigned);
+	ring->sq_ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE,
+			    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	ring->cq_size = params.cq_off.cqes +
+			params.cq_entries * sizeof(struct io_uring_cqe);
+	ring->cq_ptr = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE,
+			    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+			  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (ring->sq_ptr == MAP_FAILED || ring->cq_ptr == MAP_FAILED ||
+	    ring->sqes == MAP_FAILED) {
+		say_syserror("failed to map io_uring");
+		goto fail;
+	}
+	char *sq = (char *)ring->sq_ptr;
+	ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+	ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+	ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+	ring->sq_mask = *(unsigned *)(sq + params.sq_off.ring_mask);
+	ring->sq_entries = params.sq_entries;
+	char *cq = (char *)ring->cq_ptr;
+	ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+	ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+	ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+	ring->cq_mask = *(unsigned *)(cq + params.cq_off.ring_mask);
+	assert(params.cq_entries >= params.sq_entries);
+
+	ring->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (ring->event_fd < 0) {
+		say_syserror("failed to create io_uring eventfd");
+		goto fail;
+	}
+	if (sys_io_uring_register(fd, IORING_REGISTER_EVENTFD,
+				  &ring->event_fd, 1) != 0) {
+		say_syserror("failed to register io_uring eventfd");
+		goto fail;
+	}
+	ring->loop = loop();
+	ev_io_init(&ring->complete_io, coio_uring_complete_cb,
+		   ring->event_fd, EV_READ);
+	ring->complete_io.data = ring;
+	ev_io_start(ring->loop, &ring->complete_io);
+	ev_prepare_init(&ring->submit_prepare, coio_uring_submit_cb);
+	ring->submit_prepare.data = ring;
+	ev_timer_init(&ring->retry_timer, coio_uring_retry_cb, 0, 0);
+	ring->retry_timer.data = ring;
+	coio_uring = ring;
+	say_verbose("using io_uring for file I/O");
+	return;
+fail:
+	coio_uring_delete(ring);
+}
+
+void
+coio_uring_free(void)
+{
+	if (coio_uring == NULL)
+		return;
+	/* The buffers of in-flight requests may be gone on shutdown. */
+	if (coio_uring->n_inflight > 0)
+		return;
+	coio_uring_delete(coio_uring);
+	coio_uring = NULL;
+}
+
+bool
+coio_uring_is_enabled(void)
+{
+	return coio_uring != NULL && coio_uring_enabled;
+}
+
+/**
+ * Get a submission queue entry for a new request. Waits for
+ * a free slot if there are too many requests in flight.
+ */
+static struct io_uring_sqe *
+coio_uring_get_sqe(struct coio_uring *ring)
+{
+	while (ring->n_inflight >= ring->sq_entries) {
+		struct coio_uring_waiter waiter;
+		waiter.fiber = fiber();
+		rlist_add_tail_entry(&ring->slot_waiters, &waiter, link);
+		fiber_yield();
+		/* No-op if removed by coio_uring_complete_cb(). */
+		rlist_del_entry(&waiter, link);
+	}
+	unsigned index = *ring->sq_tail & ring->sq_mask;
+	struct io_uring_sqe *sqe = &ring->sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	ring->sq_array[index] = index;
+	return sqe;
+}
+
+/**
+ * Queue the entry returned by coio_uring_get_sqe() and wait for
+ * its completion. It is submitted along with the entries queued
+ * by other fibers at the end of the event loop iteration.
+ */
+static int
+coio_uring_exec(struct coio_uring *ring, struct io_uring_sqe *sqe)
+{
+	struct coio_uring_req req;
+	req.fiber = fiber();
+	req.result = 0;
+	req.done = false;
+	sqe->user_data = (uintptr_t)&req;
+	__atomic_store_n(ring->sq_tail, *ring->sq_tail + 1, __ATOMIC_RELEASE);
+	ring->n_inflight++;
+	/* If a retry is scheduled, the entry is submitted with it. */
+	if (ring->n_pending++ == 0)
+		ev_prepare_start(ring->loop, &ring->submit_prepare);
+	while (!req.done)
+		fiber_yield();
+	if (req.result < 0) {
+		errno = -req.result;
+		return -1;
+	}
+	return req.result;
+}
+
+static ssize_t
+coio_uring_rw(int opcode, int fd, void *buf, size_t count, off_t offset)
+{
+	struct coio_uring *ring = coio_uring;
+	assert(ring != NULL);
+	struct io_uring_sqe *sqe = coio_uring_get_sqe(ring);
+	sqe->opcode = opcode;
+	sqe->fd = fd;
+	sqe->addr = (uintptr_t)buf;
+	/* Like read(2), may transfer less than requested. */
+	sqe->len = MIN(count, (size_t)INT_MAX);
+	sqe->off = offset;
+	return coio_uring_exec(ring, sqe);
+}
+
+ssize_t
+coio_uring_pread(int fd, void *buf, size_t count, off_t offset)
+{
+	return coio_uring_rw(IORING_OP_READ, fd, buf, count, offset);
+}
+
+ssize_t
+coio_uring_pwrite(int fd, const void *buf, size_t count, off_t offset)
+{
+	ssize_t left = count, pos = 0, res, chunk;
+	while (left > 0) {
+		chunk = left;
+		ERROR_INJECT(ERRINJ_COIO_WRITE_CHUNK, {
+			chunk = 1;
+		});
+		res = coio_uring_rw(IORING_OP_WRITE, fd,
+				    (void *)((const char *)buf + pos),
+				    chunk, offset + pos);
+		if (res < 0)
+			return -1;
+		left -= res;
+		pos += res;
+	}
+	return pos;
+}
+
+ssize_t
+coio_uring_writevn(int fd, const struct iovec *iov, int iovcnt)
+{
+	struct coio_uring *ring = coio_uring;
+	assert(ring != NULL);
+	ssize_t total = 0;
+	/* Number of bytes of iov[0] written by the previous request. */
+	size_t skip = 0;
+	while (iovcnt > 0) {
+		ssize_t res;
+		if (skip == 0) {
+			struct io_uring_sqe *sqe = coio_uring_get_sqe(ring);
+			sqe->opcode = IORING_OP_WRITEV;
+			sqe->fd = fd;
+			sqe->addr = (uintptr_t)iov;
+			sqe->len = MIN(iovcnt, IOV_MAX);
+			/* Write at the current file position. */
+			sqe->off = (uint64_t)-1;
+			res = coio_uring_exec(ring, sqe);
+		} else {
+			/*
+			 * The caller's iovec can't be modified so
+			 * finish a partially written one separately.
+			 */
+			res = coio_uring_rw(IORING_OP_WRITE, fd,
+					    (char *)iov->iov_base + skip,
+					    iov->iov_len - skip, -1);
+		}
+		if (res < 0)
+			return -1;
+		if (res == 0) {
+			errno = EIO;
+			return -1;
+		}
+		total += res;
+		res += skip;
+		while (iovcnt > 0 && (size_t)res >= iov->iov_len) {
+			res -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		skip = res;
+	}
+	return total;
+}
+
+static int
+coio_uring_sync(int fd, unsigned flags)
+{
+	struct coio_uring *ring = coio_uring;
+	assert(ring != NULL);
+	struct io_uring_sqe *sqe = coio_uring_get_sqe(ring);
+	sqe->opcode = IORING_OP_FSYNC;
+	sqe->fd = fd;
+	sqe->fsync_flags = flags;
+	return coio_uring_exec(ring, sqe);
+}
+
+int
+coio_uring_fsync(int fd)
+{
+	return coio_uring_sync(fd, 0);
+}
+
+int
+coio_uring_fdatasync(int fd)
+{
+	return coio_uring_sync(fd, IORING_FSYNC_DATASYNC);
+}
+
+#else /* !defined(HAVE_IO_URING) */
+
+void
+coio_uring_init(void)
+{
+}
+
+void
+coio_uring_free(void)
+{
+}
+
+bool
+coio_uring_is_enabled(void)
+{
+	return false;
+}
+
+ssize_t
+coio_uring_pread(int fd, void *buf, size_t count, off_t offset)
+{
+	(void)fd;
+	(void)buf;
+	(void)count;
+	(void)offset;
+	unreachable();
+	return -1;
+}
+
+ssize_t
+coio_uring_pwrite(int fd, const void *buf, size_t count, off_t offset)
+{
+	(void)fd;
+	(void)buf;
+	(void)count;
+	(void)offset;
+	unreachable();
+	return -1;
+}
+
+ssize_t
+coio_uring_writevn(int fd, const struct iovec *iov, int iovcnt)
+{
+	(void)fd;
+	(void)iov;
+	(void)iovcnt;
+	unreachable();
+	return -1;
+}
+
+int
+coio_uring_fsync(int fd)
+{
+	(void)fd;
+	unreachable();
+	return -1;
+}
+
+int
+coio_uring_fdatasync(int fd)
+{
+	(void)fd;
+	unreachable();
+	return -1;
+}
+
+#endif /* !defined(HAVE_IO_URING) */
@@ -0,0 +1,88 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2025, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Cooperative file I/O on top of Linux io_uring.
+ *
+ * The ring is owned by the thread that called coio_uring_init() and
+ * is driven by its event loop. Requests issued by fibers are queued
+ * to the submission ring and submitted with a single io_uring_enter(2)
+ * call per event loop iteration, completions are signalled with an
+ * eventfd. So a batch of reads and writes issued by many fibers costs
+ * one system call and no thread hops.
+ *
+ * The functions below may only be called if coio_uring_is_enabled()
+ * returns true. coio_file.h functions check it and fall back on coio
+ * worker threads otherwise, e.g. if the kernel doesn't support the
+ * required io_uring operations or io_uring is forbidden by seccomp.
+ *
+ * Like coio_file.h, doesn't support timeouts or cancellation and
+ * follows the error reporting convention of the respective system
+ * calls. If the kernel fails to accept a batch of requests, e.g.
+ * because it's short of memory, the submission is retried after a
+ * delay. Other submission errors fail the queued requests.
+ *
+ * The backend is opt-in: it's only built with -DENABLE_IO_URING=ON.
+ * Apart from coio_file.h, it's used by the WAL writer thread and
+ * vinyl run reader threads, which create their own rings.
+ */
+
+/**
+ * If unset, coio_file.h functions don't use io_uring even if it is
+ * available. Set with the coio_uring_enabled tweak.
+ */
+extern bool coio_uring_enabled;
+
+/**
+ * Create a ring for the calling thread. If io_uring isn't available,
+ * leaves it disabled for the thread.
+ */
+void
+coio_uring_init(void);
+
+/** Destroy the ring of the calling thread, if any. */
+void
+coio_uring_free(void);
+
+/**
+ * Return true if the calling thread has a ring and the use of
+ * io_uring isn't disabled with the coio_uring_enabled tweak.
+ */
+bool
+coio_uring_is_enabled(void);
+
+ssize_t
+coio_uring_pread(int fd, void *buf, size_t count, off_t offset);
+
+/** Write the whole buffer, retrying on short writes. */
+ssize_t
+coio_uring_pwrite(int fd, const void *buf, size_t count, off_t offset);
+
+/**
+ * Write the whole iovec at the current file position, retrying on
+ * short writes, like fio_writevn().
+ */
+ssize_t
+coio_uring_writevn(int fd, const struct iovec *iov, int iovcnt);
+
+int
+coio_uring_fsync(int fd);
+
+int
+coio_uring_fdatasync(int fd);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -0,0 +1,167 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2025, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "trivia/config.h"
+
+#if defined(ENABLE_TUPLE_COMPRESSION)
+# error unimplemented
+#endif
+
+#include "mp_compression.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "msgpuck.h"
+#include "mp_extension_types.h"
+
+size_t
+mp_sizeof_compression_max(size_t src_size, enum compression_type type)
+{
+	assert(type != COMPRESSION_TYPE_NONE && type < compression_type_MAX);
+	size_t len = mp_sizeof_uint(type) + mp_sizeof_uint(src_size) +
+		     tt_compress_bound(type, src_size);
+	return mp_sizeof_ext(len);
+}
+
+char *
+mp_compress(char *dst, const char *src, size_t src_size,
+	    enum compression_type type)
+{
+	assert(type != COMPRESSION_TYPE_NONE && type < compression_type_MAX);
+	size_t header_size = mp_sizeof_uint(type) + mp_sizeof_uint(src_size);
+	size_t bound = tt_compress_bound(type, src_size);
+	/*
+	 * The size of the compressed data is unknown until it's compressed,
+	 * so reserve the max MP_EXT header and move the payload if the
+	 * actual header turns out to be shorter.
+	 */
+	size_t ext_header_max = mp_sizeof_ext(header_size + bound) -
+				(header_size + bound);
+	char *payload = dst + ext_header_max;
+	char *data = mp_encode_uint(payload, type);
+	data = mp_encode_uint(data, src_size);
+	size_t size = tt_compress(type, data, bound, src, src_size);
+	if (size == 0)
+		return NULL;
+	uint32_t len = header_size + size;
+	char *pos = mp_encode_extl(dst, MP_COMPRESSION, len);
+	if (pos != payload)
+		memmove(pos, payload, len);
+	return pos + len;
+}
+
+/**
+ * Decode the MP_COMPRESSION payload header. Return the compression type
+ * or compression_type_MAX if the data is corrupted.
+ */
+static enum compression_type
+compression_unpack(const char **data, uint32_t len, size_t *raw_size,
+		   uint32_t *size)
+{
+	const char *end = *data + len;
+	if (len == 0 || mp_typeof(**data) != MP_UINT ||
+	    mp_check_uint(*data, end) > 0)
+		return compression_type_MAX;
+	uint64_t type = mp_decode_uint(data);
+	if (type == COMPRESSION_TYPE_NONE || type >= compression_type_MAX)
+		return compression_type_MAX;
+	if (*data == end || mp_typeof(**data) != MP_UINT ||
+	    mp_check_uint(*data, end) > 0)
+		return compression_type_MAX;
+	*raw_size = mp_decode_uint(data);
+	*size = end - *data;
+	return type;
+}
+
+size_t
+mp_compression_raw_size(const char *data)
+{
+	int8_t ext_type;
+	uint32_t len = mp_decode_extl(&data, &ext_type);
+	assert(ext_type == MP_COMPRESSION);
+	(void)ext_type;
+	size_t raw_size;
+	uint32_t size;
+	if (compression_unpack(&data, len, &raw_size,
+			       &size) == compression_type_MAX)
+		return 0;
+	return raw_size;
+}
+
+/** Decompress MP_COMPRESSION given without MP_EXT header. */
+static size_t
+compression_decompress(const char **data, uint32_t len, char *dst,
+		       size_t dst_size)
+{
+	const char *end = *data + len;
+	size_t raw_size;
+	uint32_t size;
+	enum compression_type type = compression_unpack(data, len,
+							&raw_size, &size);
+	if (type == compression_type_MAX || raw_size > dst_size ||
+	    tt_decompress(type, dst, raw_size, *data, size) != 0)
+		return 0;
+	*data = end;
+	return raw_size;
+}
+
+size_t
+mp_decompress(const char **src, char *dst, size_t dst_size)
+{
+	int8_t ext_type;
+	uint32_t len = mp_decode_extl(src, &ext_type);
+	assert(ext_type == MP_COMPRESSION);
+	(void)ext_type;
+	return compression_decompress(src, len, dst, dst_size);
+}
+
+/**
+ * Decompress the value given without MP_EXT header to a buffer allocated
+ * with malloc. Return NULL if the value is corrupted.
+ */
+static char *
+compression_decompress_alloc(const char **data, uint32_t len)
+{
+	const char *p = *data;
+	size_t raw_size;
+	uint32_t size;
+	if (compression_unpack(&p, len, &raw_size,
+			       &size) == compression_type_MAX)
+		return NULL;
+	char *buf = malloc(raw_size);
+	if (buf == NULL)
+		return NULL;
+	const char *pos = buf;
+	if (compression_decompress(data, len, buf, raw_size) != raw_size ||
+	    mp_check_exact(&pos, buf + raw_size) != 0) {
+		free(buf);
+		return NULL;
+	}
+	return buf;
+}
+
+int
+mp_snprint_compression(char *buf, int size, const char **data, uint32_t len)
+{
+	char *raw = compression_decompress_alloc(data, len);
+	if (raw == NULL)
+		return -1;
+	int rc = mp_snprint(buf, size, raw);
+	free(raw);
+	return rc;
+}
+
+int
+mp_fprint_compression(FILE *file, const char **data, uint32_t len)
+{
+	char *raw = compression_decompress_alloc(data, len);
+	if (raw == NULL)
+		return -1;
+	int rc = mp_fprint(file, raw);
+	free(raw);
+	return rc;
+}
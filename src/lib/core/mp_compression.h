@@ -20,48 +20,81 @@
 extern "C" {
 #endif
 
-static inline char *
+/*
+ * A compressed MsgPack value is stored as MP_EXT of type MP_COMPRESSION.
+ * The extension payload consists of the compression type (MP_UINT), the
+ * size of the original value (MP_UINT), and the compressed data.
+ */
+
+/**
+ * Return the max number of bytes @a src_size bytes of MsgPack may take
+ * after compression with @a type, including the MP_EXT header.
+ */
+size_t
+mp_sizeof_compression_max(size_t src_size, enum compression_type type);
+
+/**
+ * Compress a MsgPack value and encode it as MP_COMPRESSION.
+ *
+ * @param dst A buffer of at least mp_sizeof_compression_max() bytes.
+ * @param src MessagePack value to compress.
+ * @param src_size Size of the value.
+ * @param type Compression type, must not be COMPRESSION_TYPE_NONE.
+ * @return A pointer to the end of the encoded data or NULL on
+ *         compression error (diag is not set).
+ */
+char *
 mp_compress(char *dst, const char *src, size_t src_size,
-	    enum compression_type type)
-{
-        (void)dst;
-        (void)src;
-        (void)src_size;
-        (void)type;
-        unreachable();
-        return NULL;
-}
+	    enum compression_type type);
+
+/**
+ * Return the size of the original MsgPack value stored in MP_COMPRESSION.
+ *
+ * @param data MessagePack encoded MP_COMPRESSION, with MP_EXT header.
+ * @return The original size or 0 if the data is corrupted.
+ */
+size_t
+mp_compression_raw_size(const char *data);
 
-static inline size_t
-mp_decompress(const char **src, char *dst, size_t dst_size)
-{
-        (void)src;
-        (void)dst;
-        (void)dst_size;
-        unreachable();
-        return 0;
-}
+/**
+ * Decompress MP_COMPRESSION into the original MsgPack value.
+ *
+ * @param src MessagePack encoded MP_COMPRESSION, with MP_EXT header.
+ * @param dst A buffer to write the original value to.
+ * @param dst_size Buffer size, at least mp_compression_raw_size().
+ * @return The size of the decompressed value or 0 if the data is
+ *         corrupted (diag is not set).
+ * @post *src = next value after MP_COMPRESSION.
+ */
+size_t
+mp_decompress(const char **src, char *dst, size_t dst_size);
 
-static inline int
-mp_snprint_compression(char *buf, int size, const char **data, uint32_t len)
-{
-        (void)buf;
-        (void)size;
-        (void)data;
-        (void)len;
-        unreachable();
-        return -1;
-}
+/**
+ * Print the string representation of the compressed value into a given
+ * buffer.
+ *
+ * @param buf Target buffer to write string to.
+ * @param size Buffer size.
+ * @param data MessagePack encoded MP_COMPRESSION, without MP_EXT header.
+ * @param len MessagePack size.
+ * @retval < 0 Error.
+ * @retval >= 0 How many bytes were written, or would have been written, if
+ *              there was enough buffer space.
+ */
+int
+mp_snprint_compression(char *buf, int size, const char **data, uint32_t len);
 
-static inline int
-mp_fprint_compression(FILE *file, const char **data, uint32_t len)
-{
-        (void)file;
-        (void)data;
-        (void)len;
-        unreachable();
-        return -1;
-}
+/**
+ * Print the string representation of the compressed value into a stream.
+ *
+ * @param file Target stream to write string to.
+ * @param data MessagePack encoded MP_COMPRESSION, without MP_EXT header.
+ * @param len MessagePack size.
+ * @retval < 0 Error.
+ * @retval >= 0 How many bytes were written.
+ */
+int
+mp_fprint_compression(FILE *file, const char **data, uint32_t len);
 
 #if defined(__cplusplus)
 } /* extern "C" */
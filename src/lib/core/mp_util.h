@@ -6,6 +6,11 @@
  */
 #include <stdarg.h>
 #include <stddef.h>
+#include <stdint.h>
+
+#include "bit/bit.h"
+#include "msgpuck.h"
+#include "trivia/config.h"
 
 #if defined(__cplusplus)
 extern "C"
@@ -47,6 +52,64 @@ const char *
 mp_format_on_region(struct region *region, size_t *size, const char *format,
 		    ...);
 
+/**
+ * Return a mask with the high bit of every zero byte of @a x set.
+ */
+static inline uint64_t
+mp_zero_bytes_mask(uint64_t x)
+{
+	const uint64_t low_bits = 0x7f7f7f7f7f7f7f7fULL;
+	return ~(((x & low_bits) + low_bits) | x) & ~low_bits;
+}
+
+/**
+ * Return a mask with the high bit of every byte of @a x set if the
+ * byte is a complete MessagePack value: a positive or negative fixint,
+ * nil, false or true.
+ */
+static inline uint64_t
+mp_single_byte_values_mask(uint64_t x)
+{
+	const uint64_t ones = 0x0101010101010101ULL;
+	uint64_t mask = ~x;
+	mask |= mp_zero_bytes_mask((x & (0xe0 * ones)) ^ (0xe0 * ones));
+	mask |= mp_zero_bytes_mask(x ^ (0xc0 * ones));
+	mask |= mp_zero_bytes_mask((x & (0xfe * ones)) ^ (0xc2 * ones));
+	return mask & (0x80 * ones);
+}
+
+/**
+ * Skip @a n MessagePack values. Works like calling mp_next() @a n
+ * times, but runs of single-byte values (small integers, nils and
+ * booleans), which make up most of wide and sparse tuples, are
+ * skipped eight bytes at a time.
+ */
+static inline void
+mp_next_n(const char **data, uint32_t n)
+{
+#ifndef HAVE_BYTE_ORDER_BIG_ENDIAN
+	const uint64_t high_bits = 0x8080808080808080ULL;
+	/*
+	 * Every value takes at least one byte, so it's safe to load
+	 * eight bytes as long as eight or more values are left.
+	 */
+	while (n >= 8) {
+		uint64_t mask = mp_single_byte_values_mask(load_u64(*data));
+		if (mask == high_bits) {
+			*data += 8;
+			n -= 8;
+			continue;
+		}
+		uint32_t count = bit_ctz_u64(~mask & high_bits) / 8;
+		*data += count;
+		mp_next(data);
+		n -= count + 1;
+	}
+#endif
+	for (; n > 0; n--)
+		mp_next(data);
+}
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -9,6 +9,170 @@
 # error unimplemented
 #endif
 
+#include "tt_compression.h"
+
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+#include <zstd.h>
+#if defined(HAVE_LZ4)
+# include <lz4.h>
+#endif
+
+#include "trivia/util.h"
+#include "say.h"
+
 const char *compression_type_strs[] = {
         "none",
+        "zstd",
+        "lz4",
 };
+
+bool
+tt_compression_is_supported(enum compression_type type)
+{
+	switch (type) {
+	case COMPRESSION_TYPE_ZSTD:
+		return true;
+	case COMPRESSION_TYPE_LZ4:
+#if defined(HAVE_LZ4)
+		return true;
+#else
+		return false;
+#endif
+	default:
+		return false;
+	}
+}
+
+/** Compression level used for COMPRESSION_TYPE_ZSTD. */
+enum { TT_COMPRESSION_ZSTD_LEVEL = 3 };
+
+/**
+ * ZSTD contexts are expensive to create so they are cached per thread.
+ * Compression happens in the tx thread, but decompression may also be
+ * done by read view threads, hence thread-local keys with destructors.
+ */
+static pthread_once_t zstd_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t zstd_cctx_key;
+static pthread_key_t zstd_dctx_key;
+
+static void
+zstd_cctx_free(void *ctx)
+{
+	ZSTD_freeCCtx(ctx);
+}
+
+static void
+zstd_dctx_free(void *ctx)
+{
+	ZSTD_freeDCtx(ctx);
+}
+
+static void
+zstd_key_init(void)
+{
+	if (pthread_key_create(&zstd_cctx_key, zstd_cctx_free) != 0 ||
+	    pthread_key_create(&zstd_dctx_key, zstd_dctx_free) != 0)
+		panic("failed to create zstd context keys");
+}
+
+/** Returns the compression context of the current thread or NULL. */
+static ZSTD_CCtx *
+zstd_cctx_get(void)
+{
+	pthread_once(&zstd_key_once, zstd_key_init);
+	ZSTD_CCtx *ctx = pthread_getspecific(zstd_cctx_key);
+	if (ctx == NULL) {
+		ctx = ZSTD_createCCtx();
+		if (ctx != NULL)
+			pthread_setspecific(zstd_cctx_key, ctx);
+	}
+	return ctx;
+}
+
+/** Returns the decompression context of the current thread or NULL. */
+static ZSTD_DCtx *
+zstd_dctx_get(void)
+{
+	pthread_once(&zstd_key_once, zstd_key_init);
+	ZSTD_DCtx *ctx = pthread_getspecific(zstd_dctx_key);
+	if (ctx == NULL) {
+		ctx = ZSTD_createDCtx();
+		if (ctx != NULL)
+			pthread_setspecific(zstd_dctx_key, ctx);
+	}
+	return ctx;
+}
+
+size_t
+tt_compress_bound(enum compression_type type, size_t size)
+{
+	switch (type) {
+	case COMPRESSION_TYPE_ZSTD:
+		return ZSTD_compressBound(size);
+#if defined(HAVE_LZ4)
+	case COMPRESSION_TYPE_LZ4:
+		/* Returns 0 if the input is too large for LZ4. */
+		return size > LZ4_MAX_INPUT_SIZE ? 0 : LZ4_compressBound(size);
+#endif
+	default:
+		unreachable();
+	}
+	return 0;
+}
+
+size_t
+tt_compress(enum compression_type type, char *dst, size_t dst_size,
+	    const char *src, size_t src_size)
+{
+	switch (type) {
+	case COMPRESSION_TYPE_ZSTD: {
+		ZSTD_CCtx *ctx = zstd_cctx_get();
+		if (ctx == NULL)
+			return 0;
+		size_t rc = ZSTD_compressCCtx(ctx, dst, dst_size,
+					      src, src_size,
+					      TT_COMPRESSION_ZSTD_LEVEL);
+		return ZSTD_isError(rc) ? 0 : rc;
+	}
+#if defined(HAVE_LZ4)
+	case COMPRESSION_TYPE_LZ4: {
+		if (src_size > LZ4_MAX_INPUT_SIZE)
+			return 0;
+		int rc = LZ4_compress_default(src, dst, src_size,
+					      MIN(dst_size, INT_MAX));
+		return rc > 0 ? rc : 0;
+	}
+#endif
+	default:
+		unreachable();
+	}
+	return 0;
+}
+
+int
+tt_decompress(enum compression_type type, char *dst, size_t dst_size,
+	      const char *src, size_t src_size)
+{
+	switch (type) {
+	case COMPRESSION_TYPE_ZSTD: {
+		ZSTD_DCtx *ctx = zstd_dctx_get();
+		if (ctx == NULL)
+			return -1;
+		size_t rc = ZSTD_decompressDCtx(ctx, dst, dst_size,
+						src, src_size);
+		return ZSTD_isError(rc) || rc != dst_size ? -1 : 0;
+	}
+#if defined(HAVE_LZ4)
+	case COMPRESSION_TYPE_LZ4: {
+		if (src_size > INT_MAX || dst_size > INT_MAX)
+			return -1;
+		int rc = LZ4_decompress_safe(src, dst, src_size, dst_size);
+		return rc < 0 || (size_t)rc != dst_size ? -1 : 0;
+	}
+#endif
+	default:
+		return -1;
+	}
+}
@@ -21,11 +21,44 @@ extern "C" {
 
 enum compression_type {
         COMPRESSION_TYPE_NONE = 0,
+        COMPRESSION_TYPE_ZSTD,
+        COMPRESSION_TYPE_LZ4,
         compression_type_MAX
 };
 
 extern const char *compression_type_strs[];
 
+/**
+ * Returns true if this build can compress data with @a type.
+ * LZ4 is available only if Tarantool was built with liblz4.
+ */
+bool
+tt_compression_is_supported(enum compression_type type);
+
+/**
+ * Returns the max size of @a size bytes compressed with @a type.
+ */
+size_t
+tt_compress_bound(enum compression_type type, size_t size);
+
+/**
+ * Compresses @a src_size bytes from @a src to @a dst, which must be at
+ * least tt_compress_bound() bytes long. Returns the compressed size.
+ * On error returns 0, diag is not set.
+ */
+size_t
+tt_compress(enum compression_type type, char *dst, size_t dst_size,
+	    const char *src, size_t src_size);
+
+/**
+ * Decompresses @a src_size bytes from @a src to @a dst. Returns 0 on
+ * success. Returns -1 if the data is corrupted or doesn't fit into
+ * @a dst_size bytes, diag is not set.
+ */
+int
+tt_decompress(enum compression_type type, char *dst, size_t dst_size,
+	      const char *src, size_t src_size);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
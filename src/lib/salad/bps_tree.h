@@ -316,6 +316,15 @@
  * #define BPS_BLOCK_LINEAR_SEARCH
  */
 
+/**
+ * A switch to turn off software prefetching of blocks. By default,
+ * a lookup prefetches all cache lines of the next block on its way
+ * from the root to a leaf before searching in the block, so the cache
+ * misses of the search in a block are served in parallel rather than
+ * one after another. To turn it off
+ * #define BPS_BLOCK_NO_PREFETCH
+ */
+
 /**
  * A switch to make the tree store the cardinality of each of its
  * child blocks in an array. A block cardinality is the amount of
@@ -411,6 +420,7 @@ typedef int64_t bps_tree_block_card_t;
 #define bps_tree_find_impl _bps_tree(find)
 #define bps_tree_find _api_name(find)
 #define bps_tree_view_find _api_name(view_find)
+#define bps_tree_find_many _api_name(find_many)
 #define bps_tree_find_get_offset _api_name(find_get_offset)
 #define bps_tree_view_find_get_offset _api_name(view_find_get_offset)
 #define bps_tree_insert_impl _bps_tree(insert)
@@ -494,6 +504,7 @@ typedef int64_t bps_tree_block_card_t;
 #define BPS_TREE_BT_LEAF _BPS_TREE(BT_LEAF)
 
 #define bps_tree_restore_block _bps_tree(restore_block)
+#define bps_tree_prefetch_block _bps_tree(prefetch_block)
 #define bps_tree_root _bps_tree(root)
 #define bps_tree_touch_block _bps_tree(touch_block)
 #define bps_tree_touch_leaf _bps_tree(touch_leaf)
@@ -754,6 +765,22 @@ bps_tree_find(const struct bps_tree *tree, bps_tree_key_t key);
 static inline bps_tree_elem_t *
 bps_tree_view_find(const struct bps_tree_view *view, bps_tree_key_t key);
 
+/**
+ * @brief Find the first elements that are equal to a batch of keys.
+ * The tree is descended for several keys at once, level by level, so
+ * that the cache misses of different lookups overlap. It is faster
+ * than calling bps_tree_find for each key on trees that don't fit in
+ * the CPU cache, especially if the keys are sorted.
+ * @param tree - pointer to a tree
+ * @param keys - array of keys
+ * @param count - number of keys
+ * @param[out] result - array of @a count pointers, result[i] is set to
+ *  the first element equal to keys[i] or NULL if not found
+ */
+static inline void
+bps_tree_find_many(const struct bps_tree *tree, bps_tree_key_t *keys,
+		   size_t count, bps_tree_elem_t **result);
+
 #if defined(BPS_INNER_CHILD_CARDS) || defined(BPS_INNER_CARD)
 
 /**
@@ -1858,6 +1885,21 @@ bps_tree_restore_block(const struct bps_tree_common *tree,
 						   tree->view, id);
 }
 
+/**
+ * @brief Prefetch all cache lines of a block that is about to be searched.
+ */
+static inline void
+bps_tree_prefetch_block(const struct bps_block *block)
+{
+#ifndef BPS_BLOCK_NO_PREFETCH
+	const char *data = (const char *)block;
+	for (size_t i = 0; i < BPS_TREE_BLOCK_SIZE; i += 64)
+		__builtin_prefetch(data + i);
+#else
+	(void)block;
+#endif
+}
+
 /**
  * @brief Get a pointer to block by it's ID.
  */
@@ -2457,6 +2499,7 @@ bps_tree_lower_bound_impl(const struct bps_tree_common *tree,
 						  key, exact);
 		block_id = inner->child_ids[pos];
 		block = bps_tree_restore_block(tree, block_id);
+		bps_tree_prefetch_block(block);
 
 #if defined(BPS_INNER_CHILD_CARDS) || defined(BPS_INNER_CARD)
 		if (offset != NULL) {
@@ -2540,6 +2583,7 @@ bps_tree_upper_bound_impl(const struct bps_tree_common *tree,
 			*exact = true;
 		block_id = inner->child_ids[pos];
 		block = bps_tree_restore_block(tree, block_id);
+		bps_tree_prefetch_block(block);
 
 #if defined(BPS_INNER_CHILD_CARDS) || defined(BPS_INNER_CARD)
 		if (offset != NULL) {
@@ -2623,6 +2667,7 @@ bps_tree_lower_bound_elem_impl(const struct bps_tree_common *tree,
 						   key, exact);
 		block_id = inner->child_ids[pos];
 		block = bps_tree_restore_block(tree, block_id);
+		bps_tree_prefetch_block(block);
 
 #if defined(BPS_INNER_CHILD_CARDS) || defined(BPS_INNER_CARD)
 		if (offset != NULL) {
@@ -2707,6 +2752,7 @@ bps_tree_upper_bound_elem_impl(const struct bps_tree_common *tree,
 			*exact = true;
 		block_id = inner->child_ids[pos];
 		block = bps_tree_restore_block(tree, block_id);
+		bps_tree_prefetch_block(block);
 
 #if defined(BPS_INNER_CHILD_CARDS) || defined(BPS_INNER_CARD)
 		if (offset != NULL) {
@@ -3096,6 +3142,7 @@ bps_tree_find_impl(const struct bps_tree_common *tree, bps_tree_key_t key,
 						  inner->header.size - 1,
 						  key, &exact);
 		block = bps_tree_restore_block(tree, inner->child_ids[pos]);
+		bps_tree_prefetch_block(block);
 
 #if defined(BPS_INNER_CHILD_CARDS) || defined(BPS_INNER_CARD)
 		if (offset != NULL) {
@@ -3131,6 +3178,57 @@ bps_tree_view_find(const struct bps_tree_view *view, bps_tree_key_t key)
 	return bps_tree_find_impl(&view->common, key, NULL);
 }
 
+static inline void
+bps_tree_find_many(const struct bps_tree *t, bps_tree_key_t *keys,
+		   size_t count, bps_tree_elem_t **result)
+{
+	const struct bps_tree_common *tree = &t->common;
+	if (tree->root_id == (bps_tree_block_id_t)(-1)) {
+		for (size_t k = 0; k < count; k++)
+			result[k] = NULL;
+		return;
+	}
+	/*
+	 * The keys are processed in groups. All lookups of a group go
+	 * down one level at a time, and the blocks of the next level are
+	 * prefetched for all of them before any of them is searched, so
+	 * up to BATCH independent cache misses are in flight at once.
+	 */
+	enum { BATCH = 16 };
+	struct bps_block *blocks[BATCH];
+	struct bps_block *root = bps_tree_root(tree);
+	for (size_t begin = 0; begin < count; begin += BATCH) {
+		size_t n = MIN((size_t)BATCH, count - begin);
+		bps_tree_key_t *batch = keys + begin;
+		for (size_t k = 0; k < n; k++)
+			blocks[k] = root;
+		for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+			for (size_t k = 0; k < n; k++) {
+				struct bps_inner *inner =
+					(struct bps_inner *)blocks[k];
+				bool exact = false;
+				bps_tree_pos_t pos;
+				pos = bps_tree_find_ins_point_key(
+					tree, inner->elems,
+					inner->header.size - 1,
+					batch[k], &exact);
+				blocks[k] = bps_tree_restore_block(
+					tree, inner->child_ids[pos]);
+				bps_tree_prefetch_block(blocks[k]);
+			}
+		}
+		for (size_t k = 0; k < n; k++) {
+			struct bps_leaf *leaf = (struct bps_leaf *)blocks[k];
+			bool exact = false;
+			bps_tree_pos_t pos;
+			pos = bps_tree_find_ins_point_key(tree, leaf->elems,
+							  leaf->header.size,
+							  batch[k], &exact);
+			result[begin + k] = exact ? leaf->elems + pos : NULL;
+		}
+	}
+}
+
 #if defined(BPS_INNER_CHILD_CARDS) || defined(BPS_INNER_CARD)
 
 static inline bps_tree_elem_t *
@@ -7629,6 +7727,7 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_find_impl
 #undef bps_tree_find
 #undef bps_tree_view_find
+#undef bps_tree_find_many
 #undef bps_tree_find_get_offset
 #undef bps_tree_view_find_get_offset
 #undef bps_tree_insert_impl
@@ -7705,6 +7804,7 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef BPS_TREE_BT_LEAF
 
 #undef bps_tree_restore_block
+#undef bps_tree_prefetch_block
 #undef bps_tree_root
 #undef bps_tree_touch_block
 #undef bps_tree_touch_leaf
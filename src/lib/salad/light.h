@@ -91,6 +91,25 @@
 #error "LIGHT_EQUAL_KEY must be defined"
 #endif
 
+/**
+ * Optional type of hash values: uint32_t (default) or uint64_t.
+ * Hash values are stored in records and compared before values,
+ * so wider hashes save value comparisons in big tables, where most
+ * of the bits of a 32-bit hash are used to find a slot, at the cost
+ * of doubled record size.
+ * #define LIGHT_HASH_TYPE uint64_t
+ */
+
+/**
+ * Optional namespace (C++ only). If set, all structs and functions
+ * are declared in the namespace so that the header can be included
+ * several times with the same LIGHT_NAME, for example:
+ * #define LIGHT_NAMESPACE my
+ * ...
+ * struct my::light_test_core hash_table;
+ * my::light_test_create(&hash_table, ...);
+ */
+
 /**
  * Tools for name substitution:
  */
@@ -104,18 +123,31 @@
 #endif
 #define LIGHT(name) CONCAT4(light, LIGHT_NAME, _, name)
 
+#ifdef LIGHT_NAMESPACE
+namespace LIGHT_NAMESPACE {
+#endif
+
+/**
+ * Type of hash values stored in the hash table.
+ */
+#ifdef LIGHT_HASH_TYPE
+typedef LIGHT_HASH_TYPE LIGHT(hash_t);
+#else
+typedef uint32_t LIGHT(hash_t);
+#endif
+
 /**
  * Overhead per value stored in a hash table.
  * Must be adjusted if struct LIGHT(record) is modified.
  */
-enum { LIGHT_RECORD_OVERHEAD = 8 };
+enum { LIGHT_RECORD_OVERHEAD = 2 * sizeof(LIGHT(hash_t)) };
 
 /**
  * Struct for one record of the hash table
  */
 struct LIGHT(record) {
 	/* hash of a value */
-	uint32_t hash;
+	LIGHT(hash_t) hash;
 	/* slot of the next record in chain */
 	uint32_t next;
 	/* the value */
@@ -254,6 +286,14 @@ LIGHT(count)(struct LIGHT(core) *ht);
 static inline uint32_t
 LIGHT(view_count)(struct LIGHT(view) *v);
 
+/**
+ * @brief Prefetch the record where an item with given hash is placed
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to prefetch
+ */
+static inline void
+LIGHT(prefetch)(const struct LIGHT(core) *ht, LIGHT(hash_t) hash);
+
 /**
  * @brief Find a record with given hash and value
  * @param ht - pointer to a hash table struct
@@ -262,7 +302,8 @@ LIGHT(view_count)(struct LIGHT(view) *v);
  * @return integer ID of found record or light_end if nothing found
  */
 static inline uint32_t
-LIGHT(find)(const struct LIGHT(core) *ht, uint32_t hash, LIGHT_DATA_TYPE data);
+LIGHT(find)(const struct LIGHT(core) *ht, LIGHT(hash_t) hash,
+	    LIGHT_DATA_TYPE data);
 
 /**
  * @brief Find a record with given hash and value
@@ -272,7 +313,7 @@ LIGHT(find)(const struct LIGHT(core) *ht, uint32_t hash, LIGHT_DATA_TYPE data);
  * @return integer ID of found record or light_end if nothing found
  */
 static inline uint32_t
-LIGHT(view_find)(const struct LIGHT(view) *v, uint32_t hash,
+LIGHT(view_find)(const struct LIGHT(view) *v, LIGHT(hash_t) hash,
 		 LIGHT_DATA_TYPE data);
 
 /**
@@ -283,7 +324,8 @@ LIGHT(view_find)(const struct LIGHT(view) *v, uint32_t hash,
  * @return integer ID of found record or light_end if nothing found
  */
 static inline uint32_t
-LIGHT(find_key)(const struct LIGHT(core) *ht, uint32_t hash, LIGHT_KEY_TYPE data);
+LIGHT(find_key)(const struct LIGHT(core) *ht, LIGHT(hash_t) hash,
+		LIGHT_KEY_TYPE data);
 
 /**
  * @brief Find a record with given hash and key
@@ -293,7 +335,7 @@ LIGHT(find_key)(const struct LIGHT(core) *ht, uint32_t hash, LIGHT_KEY_TYPE data
  * @return integer ID of found record or light_end if nothing found
  */
 static inline uint32_t
-LIGHT(view_find_key)(const struct LIGHT(view) *v, uint32_t hash,
+LIGHT(view_find_key)(const struct LIGHT(view) *v, LIGHT(hash_t) hash,
 		     LIGHT_KEY_TYPE data);
 
 /**
@@ -304,7 +346,7 @@ LIGHT(view_find_key)(const struct LIGHT(view) *v, uint32_t hash,
  * @return integer ID of inserted record or light_end if failed
  */
 static inline uint32_t
-LIGHT(insert)(struct LIGHT(core) *ht, uint32_t hash, LIGHT_DATA_TYPE data);
+LIGHT(insert)(struct LIGHT(core) *ht, LIGHT(hash_t) hash, LIGHT_DATA_TYPE data);
 
 /**
  * @brief Replace a record with given hash and value
@@ -315,7 +357,7 @@ LIGHT(insert)(struct LIGHT(core) *ht, uint32_t hash, LIGHT_DATA_TYPE data);
  * @return integer ID of found record or light_end if nothing found
  */
 static inline uint32_t
-LIGHT(replace)(struct LIGHT(core) *ht, uint32_t hash,
+LIGHT(replace)(struct LIGHT(core) *ht, LIGHT(hash_t) hash,
 	       LIGHT_DATA_TYPE data, LIGHT_DATA_TYPE *replaced);
 
 /**
@@ -336,7 +378,7 @@ LIGHT(delete)(struct LIGHT(core) *ht, uint32_t slotpos);
  */
 static inline int
 LIGHT(delete_value)(struct LIGHT(core) *ht,
-		    uint32_t hash, LIGHT_DATA_TYPE value);
+		    LIGHT(hash_t) hash, LIGHT_DATA_TYPE value);
 
 /**
  * @brief Get a value from a desired position
@@ -391,7 +433,7 @@ LIGHT(view_iterator_begin)(const struct LIGHT(view) *v,
  */
 static inline void
 LIGHT(iterator_key)(const struct LIGHT(core) *ht, struct LIGHT(iterator) *itr,
-	            uint32_t hash, LIGHT_KEY_TYPE data);
+	            LIGHT(hash_t) hash, LIGHT_KEY_TYPE data);
 
 /**
  * @brief Set iterator to position determined by key
@@ -402,7 +444,7 @@ LIGHT(iterator_key)(const struct LIGHT(core) *ht, struct LIGHT(iterator) *itr,
  */
 static inline void
 LIGHT(view_iterator_key)(const struct LIGHT(view) *v,
-			 struct LIGHT(iterator) *itr, uint32_t hash,
+			 struct LIGHT(iterator) *itr, LIGHT(hash_t) hash,
 			 LIGHT_KEY_TYPE data);
 
 /**
@@ -518,10 +560,10 @@ LIGHT(view_count)(struct LIGHT(view) *v)
  * given hash should be placed.
  */
 static inline uint32_t
-LIGHT(slot)(const struct LIGHT(common) *ht, uint32_t hash)
+LIGHT(slot)(const struct LIGHT(common) *ht, LIGHT(hash_t) hash)
 {
 	uint32_t cover_mask = ht->cover_mask;
-	uint32_t res = hash & cover_mask;
+	uint32_t res = (uint32_t)hash & cover_mask;
 	/*
 	 * Calculate the following expression without branch instructions:
 	 * probe = res >= ht->table_size;
@@ -552,6 +594,15 @@ LIGHT(touch_record)(struct LIGHT(common) *ht, uint32_t slot)
 	return (struct LIGHT(record) *)matras_touch(ht->mtable, slot);
 }
 
+static inline void
+LIGHT(prefetch)(const struct LIGHT(core) *htab, LIGHT(hash_t) hash)
+{
+	const struct LIGHT(common) *ht = &htab->common;
+	if (ht->count == 0)
+		return;
+	__builtin_prefetch(LIGHT(get_record)(ht, LIGHT(slot)(ht, hash)));
+}
+
 /**
  * @brief Find a record with given hash and value
  * @param ht - pointer to a hash table struct
@@ -560,7 +611,7 @@ LIGHT(touch_record)(struct LIGHT(common) *ht, uint32_t slot)
  * @return integer ID of found record or light_end if nothing found
  */
 static inline uint32_t
-LIGHT(find_impl)(const struct LIGHT(common) *ht, uint32_t hash,
+LIGHT(find_impl)(const struct LIGHT(common) *ht, LIGHT(hash_t) hash,
 		 LIGHT_DATA_TYPE value)
 {
 	if (ht->count == 0)
@@ -583,14 +634,14 @@ LIGHT(find_impl)(const struct LIGHT(common) *ht, uint32_t hash,
 }
 
 static inline uint32_t
-LIGHT(find)(const struct LIGHT(core) *ht, uint32_t hash,
+LIGHT(find)(const struct LIGHT(core) *ht, LIGHT(hash_t) hash,
 	    LIGHT_DATA_TYPE value)
 {
 	return LIGHT(find_impl)(&ht->common, hash, value);
 }
 
 static inline uint32_t
-LIGHT(view_find)(const struct LIGHT(view) *v, uint32_t hash,
+LIGHT(view_find)(const struct LIGHT(view) *v, LIGHT(hash_t) hash,
 		 LIGHT_DATA_TYPE value)
 {
 	return LIGHT(find_impl)(&v->common, hash, value);
@@ -604,7 +655,7 @@ LIGHT(view_find)(const struct LIGHT(view) *v, uint32_t hash,
  * @return integer ID of found record or light_end if nothing found
  */
 static inline uint32_t
-LIGHT(find_key_impl)(const struct LIGHT(common) *ht, uint32_t hash,
+LIGHT(find_key_impl)(const struct LIGHT(common) *ht, LIGHT(hash_t) hash,
 		     LIGHT_KEY_TYPE key)
 {
 	if (ht->count == 0)
@@ -627,13 +678,14 @@ LIGHT(find_key_impl)(const struct LIGHT(common) *ht, uint32_t hash,
 }
 
 static inline uint32_t
-LIGHT(find_key)(const struct LIGHT(core) *ht, uint32_t hash, LIGHT_KEY_TYPE key)
+LIGHT(find_key)(const struct LIGHT(core) *ht, LIGHT(hash_t) hash,
+		LIGHT_KEY_TYPE key)
 {
 	return LIGHT(find_key_impl)(&ht->common, hash, key);
 }
 
 static inline uint32_t
-LIGHT(view_find_key)(const struct LIGHT(view) *v, uint32_t hash,
+LIGHT(view_find_key)(const struct LIGHT(view) *v, LIGHT(hash_t) hash,
 		     LIGHT_KEY_TYPE key)
 {
 	return LIGHT(find_key_impl)(&v->common, hash, key);
@@ -648,7 +700,7 @@ LIGHT(view_find_key)(const struct LIGHT(view) *v, uint32_t hash,
  * @return integer ID of found record or light_end if nothing found
  */
 static inline uint32_t
-LIGHT(replace)(struct LIGHT(core) *htab, uint32_t hash,
+LIGHT(replace)(struct LIGHT(core) *htab, LIGHT(hash_t) hash,
 	       LIGHT_DATA_TYPE value, LIGHT_DATA_TYPE *replaced)
 {
 	struct LIGHT(common) *ht = &htab->common;
@@ -684,7 +736,7 @@ LIGHT(replace)(struct LIGHT(core) *htab, uint32_t hash,
 static inline uint32_t
 LIGHT(get_empty_prev)(struct LIGHT(record) *record)
 {
-	return record->hash;
+	return (uint32_t)record->hash;
 }
 
 /*
@@ -960,7 +1012,8 @@ LIGHT(grow)(struct LIGHT(common) *ht)
  * @return integer ID of inserted record or light_end if failed
  */
 static inline uint32_t
-LIGHT(insert)(struct LIGHT(core) *htab, uint32_t hash, LIGHT_DATA_TYPE value)
+LIGHT(insert)(struct LIGHT(core) *htab, LIGHT(hash_t) hash,
+	      LIGHT_DATA_TYPE value)
 {
 	struct LIGHT(common) *ht = &htab->common;
 	if (ht->table_size == 0)
@@ -1086,7 +1139,7 @@ LIGHT(delete)(struct LIGHT(core) *htab, uint32_t slot)
  * (only with freezed iterators)
  */
 static inline int
-LIGHT(delete_value)(struct LIGHT(core) *htab, uint32_t hash,
+LIGHT(delete_value)(struct LIGHT(core) *htab, LIGHT(hash_t) hash,
 		    LIGHT_DATA_TYPE value)
 {
 	struct LIGHT(common) *ht = &htab->common;
@@ -1226,7 +1279,7 @@ LIGHT(view_iterator_begin)(const struct LIGHT(view) *v,
  */
 static inline void
 LIGHT(iterator_key_impl)(const struct LIGHT(common) *ht,
-			 struct LIGHT(iterator) *itr, uint32_t hash,
+			 struct LIGHT(iterator) *itr, LIGHT(hash_t) hash,
 			 LIGHT_KEY_TYPE data)
 {
 	itr->slotpos = LIGHT(find_key_impl)(ht, hash, data);
@@ -1234,14 +1287,14 @@ LIGHT(iterator_key_impl)(const struct LIGHT(common) *ht,
 
 static inline void
 LIGHT(iterator_key)(const struct LIGHT(core) *ht, struct LIGHT(iterator) *itr,
-		    uint32_t hash, LIGHT_KEY_TYPE data)
+		    LIGHT(hash_t) hash, LIGHT_KEY_TYPE data)
 {
 	LIGHT(iterator_key_impl)(&ht->common, itr, hash, data);
 }
 
 static inline void
 LIGHT(view_iterator_key)(const struct LIGHT(view) *v,
-			 struct LIGHT(iterator) *itr, uint32_t hash,
+			 struct LIGHT(iterator) *itr, LIGHT(hash_t) hash,
 			 LIGHT_KEY_TYPE data)
 {
 	LIGHT(iterator_key_impl)(&v->common, itr, hash, data);
@@ -1364,3 +1417,6 @@ LIGHT(selfcheck)(const struct LIGHT(core) *htab)
 	return res;
 }
 
+#ifdef LIGHT_NAMESPACE
+} /* namespace LIGHT_NAMESPACE { */
+#endif
@@ -0,0 +1,239 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "ribbon.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+	/** Number of seeds tried before the slot count is increased. */
+	RIBBON_SEED_COUNT = 16,
+	/** Size granularity of the solution table, in words. */
+	RIBBON_TABLE_WORDS_ALIGN = 8,
+};
+
+/**
+ * Return the slot count for a filter storing the given number of
+ * values. The linear system is solvable with high probability if
+ * the number of slots exceeds the number of values by a few per cent
+ * so that the overhead grows very slowly with the number of values.
+ */
+static uint32_t
+ribbon_slot_count(uint32_t count, double overhead)
+{
+	double slot_count = ceil(count * (1 + overhead));
+	slot_count = MAX(slot_count, (double)RIBBON_WIDTH);
+	slot_count = ceil(slot_count / RIBBON_WIDTH) * RIBBON_WIDTH;
+	assert(slot_count <= UINT32_MAX);
+	return slot_count;
+}
+
+/**
+ * Return the number of fingerprint bits for a filter with the given
+ * slot count. Like the blocked Bloom filter, which is allocated in
+ * whole cache lines, the table size is rounded up to a multiple of
+ * RIBBON_TABLE_WORDS_ALIGN words, and the spare words are spent on
+ * extra fingerprint bits. This costs nothing for big filters but
+ * makes small ones, which are rounded up the most, much more precise.
+ */
+static uint32_t
+ribbon_result_bits(uint32_t slot_count, uint32_t min_result_bits)
+{
+	uint32_t block_count = slot_count / RIBBON_WIDTH;
+	uint32_t word_count = block_count * min_result_bits;
+	word_count = (word_count + RIBBON_TABLE_WORDS_ALIGN - 1) /
+		     RIBBON_TABLE_WORDS_ALIGN * RIBBON_TABLE_WORDS_ALIGN;
+	return MIN(word_count / block_count,
+		   (uint32_t)RIBBON_RESULT_BITS_MAX);
+}
+
+/**
+ * Add an equation to the banding matrix. The matrix is stored as
+ * two arrays indexed by slot: coefficient rows and results. Row i
+ * is either empty or has the lowest bit (corresponding to slot i)
+ * set. Returns false if the equation contradicts the matrix.
+ */
+static bool
+ribbon_band_add(uint64_t *coeffs, uint32_t *results,
+		const struct ribbon_key *key)
+{
+	uint32_t start = key->start;
+	uint64_t coeff = key->coeff;
+	uint32_t result = key->result;
+	while (true) {
+		assert((coeff & 1) != 0);
+		if (coeffs[start] == 0) {
+			coeffs[start] = coeff;
+			results[start] = result;
+			return true;
+		}
+		coeff ^= coeffs[start];
+		result ^= results[start];
+		if (coeff == 0) {
+			/*
+			 * The equation is a linear combination of
+			 * the stored ones. It's fine if the results
+			 * match, e.g. the same value was added twice.
+			 */
+			return result == 0;
+		}
+		uint32_t shift = bit_ctz_u64(coeff);
+		coeff >>= shift;
+		start += shift;
+	}
+}
+
+/**
+ * Try to build a filter with the slot count and the seed set in
+ * the given ribbon structure. The coefficient and result buffers
+ * must have slot_count elements. Returns false if the linear system
+ * turned out to be unsolvable.
+ */
+static bool
+ribbon_build(struct ribbon *ribbon, const ribbon_hash_t *hashes,
+	     uint32_t count, uint64_t *coeffs, uint32_t *results)
+{
+	uint32_t slot_count = ribbon->slot_count;
+	uint32_t bits = ribbon->result_bits;
+	uint32_t result_mask = bits < 32 ? (1U << bits) - 1 : UINT32_MAX;
+	memset(coeffs, 0, slot_count * sizeof(*coeffs));
+	for (uint32_t i = 0; i < count; i++) {
+		struct ribbon_key key;
+		ribbon_key_create(&key, slot_count, ribbon->seed, hashes[i]);
+		key.result &= result_mask;
+		if (!ribbon_band_add(coeffs, results, &key))
+			return false;
+	}
+	/*
+	 * Back substitution. For each result bit we keep a sliding
+	 * window of the solution bits computed so far: bit k of
+	 * state[j] is bit j of the solution row of slot i + k.
+	 * Unused slots are filled with pseudo-random bits so that
+	 * a lookup of a value that isn't stored in the filter sees
+	 * a random fingerprint.
+	 */
+	uint64_t state[RIBBON_RESULT_BITS_MAX] = {0};
+	uint64_t filler = ribbon_mix(ribbon->seed);
+	memset(ribbon->table, 0, ribbon_store_size(ribbon));
+	for (uint32_t i = slot_count; i-- > 0; ) {
+		uint64_t coeff = coeffs[i];
+		uint32_t result;
+		if (coeff != 0) {
+			result = results[i];
+		} else {
+			filler = ribbon_mix(filler + i);
+			result = (uint32_t)filler;
+		}
+		uint64_t *block = ribbon->table + (i / RIBBON_WIDTH) * bits;
+		uint32_t shift = i % RIBBON_WIDTH;
+		for (uint32_t j = 0; j < bits; j++) {
+			uint64_t bit = (result >> j) & 1;
+			state[j] <<= 1;
+			bit ^= bit_count_u64(state[j] & coeff) & 1;
+			state[j] |= bit;
+			block[j] |= bit << shift;
+		}
+	}
+	return true;
+}
+
+int
+ribbon_create(struct ribbon *ribbon, const ribbon_hash_t *hashes,
+	      uint32_t count, double false_positive_rate)
+{
+	/* Number of fingerprint bits. */
+	double result_bits = ceil(-log2(false_positive_rate));
+	result_bits = MAX(result_bits, 1.);
+	result_bits = MIN(result_bits, (double)RIBBON_RESULT_BITS_MAX);
+	ribbon->table = NULL;
+
+	double overhead = 0.005 * log2(MAX(count, 2U)) + 0.01;
+	uint32_t slot_count = ribbon_slot_count(count, overhead);
+	uint64_t *coeffs = NULL;
+	uint32_t *results = NULL;
+	while (true) {
+		ribbon->slot_count = slot_count;
+		ribbon->result_bits = ribbon_result_bits(slot_count,
+							 result_bits);
+		uint64_t *table = realloc(ribbon->table,
+					  ribbon_store_size(ribbon));
+		uint64_t *new_coeffs = realloc(coeffs,
+					       slot_count * sizeof(*coeffs));
+		uint32_t *new_results = realloc(results,
+						slot_count * sizeof(*results));
+		if (table != NULL)
+			ribbon->table = table;
+		if (new_coeffs != NULL)
+			coeffs = new_coeffs;
+		if (new_results != NULL)
+			results = new_results;
+		if (table == NULL || new_coeffs == NULL ||
+		    new_results == NULL)
+			goto error;
+		for (uint32_t seed = 0; seed < RIBBON_SEED_COUNT; seed++) {
+			ribbon->seed = seed;
+			if (ribbon_build(ribbon, hashes, count,
+					 coeffs, results))
+				goto done;
+		}
+		/* Very unlikely, retry with more slots. */
+		overhead += 0.05;
+		slot_count = ribbon_slot_count(count, overhead);
+	}
+done:
+	free(coeffs);
+	free(results);
+	return 0;
+error:
+	free(ribbon->table);
+	free(coeffs);
+	free(results);
+	ribbon->table = NULL;
+	return -1;
+}
+
+void
+ribbon_destroy(struct ribbon *ribbon)
+{
+	free(ribbon->table);
+}
+
+double
+ribbon_fpr(const struct ribbon *ribbon)
+{
+	return exp2(-(double)ribbon->result_bits);
+}
+
+size_t
+ribbon_store_size(const struct ribbon *ribbon)
+{
+	return (size_t)ribbon->slot_count / RIBBON_WIDTH *
+	       ribbon->result_bits * sizeof(*ribbon->table);
+}
+
+char *
+ribbon_store(const struct ribbon *ribbon, char *table)
+{
+	size_t store_size = ribbon_store_size(ribbon);
+	memcpy(table, ribbon->table, store_size);
+	return table + store_size;
+}
+
+int
+ribbon_load_table(struct ribbon *ribbon, const char *table)
+{
+	size_t size = ribbon_store_size(ribbon);
+	ribbon->table = malloc(size);
+	if (ribbon->table == NULL)
+		return -1;
+	memcpy(ribbon->table, table, size);
+	return 0;
+}
@@ -0,0 +1,198 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+/*
+ * Standard Ribbon filter with interleaved solution storage:
+ *  Dillinger, P. C.; Walzer, S. (2021)
+ *  "Ribbon filter: practically smaller than Bloom and Xor"
+ *  https://arxiv.org/abs/2103.02515
+ *
+ * A value is mapped to a slot range of RIBBON_WIDTH bits starting at
+ * a random position, a random coefficient row of the same width and
+ * a fingerprint of result_bits bits. The filter stores a solution Z
+ * of the linear system over GF(2) such that for each value stored in
+ * the filter the parity of (coefficients & Z[start..start+width))
+ * equals the fingerprint, bit-wise. A lookup of a value that isn't
+ * stored in the filter matches a random fingerprint hence the false
+ * positive rate is 2^-result_bits while the filter takes only a few
+ * per cent more than result_bits bits per value, which is about 30%
+ * less than a Bloom filter with the same false positive rate.
+ *
+ * Unlike a Bloom filter, a Ribbon filter can't be updated: all
+ * values must be known when the filter is created.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "bit/bit.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+enum {
+	/** Number of slots covered by a value. */
+	RIBBON_WIDTH = 64,
+	/** Max number of fingerprint bits. */
+	RIBBON_RESULT_BITS_MAX = 32,
+};
+
+typedef uint32_t ribbon_hash_t;
+
+/**
+ * Ribbon filter data structure.
+ */
+struct ribbon {
+	/** Number of slots, a multiple of RIBBON_WIDTH. */
+	uint32_t slot_count;
+	/** Number of fingerprint bits. */
+	uint16_t result_bits;
+	/** Seed used for hashing the values. */
+	uint16_t seed;
+	/**
+	 * Solution, RIBBON_WIDTH slots per block. A block consists
+	 * of result_bits words, word i stores bit i of the solution
+	 * rows of the block slots.
+	 */
+	uint64_t *table;
+};
+
+/* {{{ API declaration */
+
+/**
+ * Allocate and build a ribbon filter storing the given values.
+ *
+ * @param ribbon - structure to initialize
+ * @param hashes - hashes of the values to store, may have duplicates
+ * @param count - number of hashes
+ * @param false_positive_rate - desired false positive rate
+ * @return 0 - OK, -1 - memory error
+ */
+int
+ribbon_create(struct ribbon *ribbon, const ribbon_hash_t *hashes,
+	      uint32_t count, double false_positive_rate);
+
+/**
+ * Free resources of the ribbon filter.
+ *
+ * @param ribbon - the ribbon filter
+ */
+void
+ribbon_destroy(struct ribbon *ribbon);
+
+/**
+ * Query for presence of a value in the data set
+ * @param ribbon - the ribbon filter
+ * @param hash - hash of the value
+ * @return true - the value could be in data set; false - the value is
+ *  definitively not in data set
+ */
+static bool
+ribbon_maybe_has(const struct ribbon *ribbon, ribbon_hash_t hash);
+
+/**
+ * Return the expected false positive rate of a ribbon filter.
+ * @param ribbon - the ribbon filter
+ * @return - expected false positive rate
+ */
+double
+ribbon_fpr(const struct ribbon *ribbon);
+
+/**
+ * Calculate size of a buffer that is needed for storing ribbon table
+ * @param ribbon - the ribbon filter to store
+ * @return - Exact size
+ */
+size_t
+ribbon_store_size(const struct ribbon *ribbon);
+
+/**
+ * Store ribbon filter table to the given buffer
+ * Other struct ribbon members must be stored manually.
+ * @param ribbon - the ribbon filter to store
+ * @param table - buffer to store to
+ * @return - end of written buffer
+ */
+char *
+ribbon_store(const struct ribbon *ribbon, char *table);
+
+/**
+ * Allocate table and load it from given buffer.
+ * Other struct ribbon members must be loaded manually.
+ *
+ * @param ribbon - structure to load to
+ * @param table - data to load
+ * @return 0 - OK, -1 - memory error
+ */
+int
+ribbon_load_table(struct ribbon *ribbon, const char *table);
+
+/* }}} API declaration */
+
+/* {{{ API definition */
+
+/** Value hashes derived from a value hash and a filter seed. */
+struct ribbon_key {
+	/** First slot covered by the value. */
+	uint32_t start;
+	/** Fingerprint. */
+	uint32_t result;
+	/** Coefficient row, the lowest bit is always set. */
+	uint64_t coeff;
+};
+
+/** splitmix64 finalizer. */
+static inline uint64_t
+ribbon_mix(uint64_t x)
+{
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+static inline void
+ribbon_key_create(struct ribbon_key *key, uint32_t slot_count,
+		  uint16_t seed, ribbon_hash_t hash)
+{
+	/*
+	 * The mix function is a bijection so distinct hashes never
+	 * get the same mixed value.
+	 */
+	uint64_t h = ribbon_mix(hash + ((uint64_t)seed << 32));
+	uint32_t start_count = slot_count - RIBBON_WIDTH + 1;
+	key->start = ((h >> 32) * start_count) >> 32;
+	key->result = (uint32_t)h;
+	key->coeff = ribbon_mix(h) | 1;
+}
+
+static inline bool
+ribbon_maybe_has(const struct ribbon *ribbon, ribbon_hash_t hash)
+{
+	struct ribbon_key key;
+	ribbon_key_create(&key, ribbon->slot_count, ribbon->seed, hash);
+	uint32_t bits = ribbon->result_bits;
+	const uint64_t *block = ribbon->table +
+				(key.start / RIBBON_WIDTH) * bits;
+	uint32_t shift = key.start % RIBBON_WIDTH;
+	/* Most negative lookups return after checking one or two bits. */
+	for (uint32_t i = 0; i < bits; i++) {
+		uint64_t row = block[i] >> shift;
+		if (shift != 0)
+			row |= block[bits + i] << (RIBBON_WIDTH - shift);
+		if ((bit_count_u64(row & key.coeff) & 1) !=
+		    ((key.result >> i) & 1))
+			return false;
+	}
+	return true;
+}
+
+/* }}} API definition */
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
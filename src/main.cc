@@ -52,6 +52,7 @@
 #include "fiber.h"
 #include "cbus.h"
 #include "coio_task.h"
+#include "coio_uring.h"
 #include <crc32.h>
 #include "memory.h"
 #include <say.h>
@@ -557,6 +558,7 @@ tarantool_free(void)
 
 	/* Shutdown worker pool. Waits until threads terminate. */
 	coio_shutdown();
+	coio_uring_free();
 
 	box_lua_free();
 	/* Lua may have reference to engine tuples. */
@@ -1002,6 +1004,7 @@ main(int argc, char **argv)
 	popen_init();
 	coio_init();
 	coio_enable();
+	coio_uring_init();
 	signal_init();
 	cbus_init();
 	tnt_thread_init();
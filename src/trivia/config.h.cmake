@@ -205,6 +205,12 @@
 
 #cmakedefine HAVE_PRCTL_H 1
 
+/** linux/io_uring.h with IORING_OP_READ - see coio_uring.h */
+#cmakedefine HAVE_IO_URING 1
+
+/** liblz4 for COMPRESSION_TYPE_LZ4 - see tt_compression.h */
+#cmakedefine HAVE_LZ4 1
+
 #cmakedefine HAVE_UUIDGEN 1
 #cmakedefine HAVE_CLOCK_GETTIME 1
 #cmakedefine HAVE_CLOCK_GETTIME_DECL 1
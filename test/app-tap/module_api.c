@@ -3392,23 +3392,529 @@ test_box_insert_arrow(struct lua_State *L)
 	fail_unless(lua_isnumber(L, 1));
 	uint32_t space_id = lua_tointeger(L, 1);
 
+	/* Column 'id': unsigned integers. */
+	struct ArrowSchema id_schema;
+	memset(&id_schema, 0, sizeof(id_schema));
+	id_schema.format = "L";
+	id_schema.name = "id";
+	id_schema.release = arrow_schema_destroy;
+
+	uint64_t ids[3] = {1, 2, 3};
+	const void *id_buffers[2] = {NULL, ids};
+	struct ArrowArray id_array;
+	memset(&id_array, 0, sizeof(id_array));
+	id_array.length = 3;
+	id_array.n_buffers = 2;
+	id_array.buffers = id_buffers;
+	id_array.release = arrow_array_destroy;
+
+	/* Column 'name': strings, the second one is null. */
+	struct ArrowSchema name_schema;
+	memset(&name_schema, 0, sizeof(name_schema));
+	name_schema.format = "u";
+	name_schema.name = "name";
+	name_schema.flags = ARROW_FLAG_NULLABLE;
+	name_schema.release = arrow_schema_destroy;
+
+	uint8_t validity = 0x05;
+	int32_t offsets[4] = {0, 1, 1, 4};
+	const void *name_buffers[3] = {&validity, offsets, "accc"};
+	struct ArrowArray name_array;
+	memset(&name_array, 0, sizeof(name_array));
+	name_array.length = 3;
+	name_array.null_count = 1;
+	name_array.n_buffers = 3;
+	name_array.buffers = name_buffers;
+	name_array.release = arrow_array_destroy;
+
+	/*
+	 * Column 'data': binary values. They are short to check that
+	 * they are sized as MP_BIN, which has a longer header than
+	 * MP_STR for values shorter than 32 bytes.
+	 */
+	struct ArrowSchema data_schema;
+	memset(&data_schema, 0, sizeof(data_schema));
+	data_schema.format = "z";
+	data_schema.name = "data";
+	data_schema.release = arrow_schema_destroy;
+
+	int32_t data_offsets[4] = {0, 2, 2, 5};
+	const void *data_buffers[3] = {NULL, data_offsets, "\x01\x02xyz"};
+	struct ArrowArray data_array;
+	memset(&data_array, 0, sizeof(data_array));
+	data_array.length = 3;
+	data_array.n_buffers = 3;
+	data_array.buffers = data_buffers;
+	data_array.release = arrow_array_destroy;
+
+	struct ArrowSchema *schema_children[3] = {
+		&id_schema, &name_schema, &data_schema,
+	};
 	struct ArrowSchema schema;
 	memset(&schema, 0, sizeof(schema));
 	schema.format = "+s";
+	schema.n_children = 3;
+	schema.children = schema_children;
 	schema.release = arrow_schema_destroy;
 
+	struct ArrowArray *array_children[3] = {
+		&id_array, &name_array, &data_array,
+	};
 	struct ArrowArray array;
 	memset(&array, 0, sizeof(array));
+	array.length = 3;
 	array.n_buffers = 1;
 	const void *buffers[1] = {NULL};
 	array.buffers = buffers;
+	array.n_children = 3;
+	array.children = array_children;
 	array.release = arrow_array_destroy;
 
 	int rc = box_insert_arrow(space_id, &array, &schema);
-	fail_unless(rc == -1);
+	fail_unless(rc == 0);
 	fail_unless(array.release == NULL);
 	fail_unless(schema.release == NULL);
-	check_diag("ClientError", "memtx does not support arrow format");
+
+	/* Duplicate keys: the whole batch is rolled back. */
+	ids[0] = 4;
+	array.release = arrow_array_destroy;
+	schema.release = arrow_schema_destroy;
+	rc = box_insert_arrow(space_id, &array, &schema);
+	fail_unless(rc == -1);
+	check_diag("ClientError", "Duplicate key exists in unique index "
+		   "\"pk\" in space \"test_insert_arrow\" with old tuple - "
+		   "[2, null, \"\"] and new tuple - [2, null, \"\"]");
+	lua_pushboolean(L, 1);
+	return 1;
+}
+
+/**
+ * Check an Arrow stream over the space created by the Lua part of
+ * the box_index_arrow_stream test.
+ */
+static void
+check_index_arrow_stream(uint32_t space_id, bool use_read_view)
+{
+	char key[8];
+	char *key_end = mp_encode_array(key, 0);
+	box_arrow_options_t *options = box_arrow_options_new();
+	box_arrow_options_set_batch_row_count(options, 3);
+	box_arrow_options_set_use_read_view(options, use_read_view);
+
+	uint32_t fields[] = {0, 1, 2};
+	struct ArrowArrayStream stream;
+	int rc = box_index_arrow_stream(space_id, 0, lengthof(fields), fields,
+					key, key_end, options, &stream);
+	fail_unless(rc == 0);
+
+	/* A read view stream doesn't see changes made after its creation. */
+	char tuple[8];
+	char *tuple_end = mp_encode_array(tuple, 1);
+	tuple_end = mp_encode_uint(tuple_end, 11);
+	fail_unless(box_insert(space_id, tuple, tuple_end, NULL) == 0);
+	uint64_t row_count = use_read_view ? 10 : 11;
+
+	struct ArrowSchema schema;
+	fail_unless(stream.get_schema(&stream, &schema) == 0);
+	fail_unless(strcmp(schema.format, "+s") == 0);
+	fail_unless(schema.n_children == 3);
+	fail_unless(strcmp(schema.children[0]->format, "L") == 0);
+	fail_unless(strcmp(schema.children[0]->name, "id") == 0);
+	fail_unless((schema.children[0]->flags & ARROW_FLAG_NULLABLE) == 0);
+	fail_unless(strcmp(schema.children[1]->format, "u") == 0);
+	fail_unless(strcmp(schema.children[1]->name, "name") == 0);
+	fail_unless((schema.children[1]->flags & ARROW_FLAG_NULLABLE) != 0);
+	/* Fields without a type are returned as raw MsgPack. */
+	fail_unless(strcmp(schema.children[2]->format, "z") == 0);
+	fail_unless(strcmp(schema.children[2]->name, "") == 0);
+	fail_unless((schema.children[2]->flags & ARROW_FLAG_NULLABLE) != 0);
+	schema.release(&schema);
+
+	/*
+	 * The space contains {i, i % 2 == 0 ? tostring(i) : nil, 'x'},
+	 * i = 1..10, and {11} inserted above.
+	 */
+	uint64_t expected_id = 1;
+	int batch_count = 0;
+	while (true) {
+		struct ArrowArray array;
+		fail_unless(stream.get_next(&stream, &array) == 0);
+		if (array.release == NULL)
+			break;
+		batch_count++;
+		fail_unless(array.n_children == 3);
+		uint64_t rows_left = row_count - expected_id + 1;
+		fail_unless(array.length ==
+			    (int64_t)(rows_left < 3 ? rows_left : 3));
+		struct ArrowArray *ids = array.children[0];
+		struct ArrowArray *names = array.children[1];
+		struct ArrowArray *raw = array.children[2];
+		fail_unless(ids->length == array.length);
+		fail_unless(ids->null_count == 0);
+		fail_unless(names->length == array.length);
+		fail_unless(raw->length == array.length);
+		const uint64_t *id_values = ids->buffers[1];
+		const uint8_t *name_validity = names->buffers[0];
+		const int32_t *name_offsets = names->buffers[1];
+		const char *name_data = names->buffers[2];
+		const uint8_t *raw_validity = raw->buffers[0];
+		const int32_t *raw_offsets = raw->buffers[1];
+		const char *raw_data = raw->buffers[2];
+		for (int64_t i = 0; i < array.length; i++, expected_id++) {
+			fail_unless(id_values[i] == expected_id);
+			bool is_null = raw_validity != NULL &&
+				(raw_validity[i / 8] & (1 << i % 8)) == 0;
+			fail_unless(is_null == (expected_id == 11));
+			if (!is_null) {
+				fail_unless(raw_offsets[i + 1] -
+					    raw_offsets[i] == 2);
+				fail_unless(memcmp(raw_data + raw_offsets[i],
+						   "\xa1x", 2) == 0);
+			}
+			is_null = (name_validity[i / 8] & (1 << i % 8)) == 0;
+			fail_unless(is_null == (expected_id % 2 != 0));
+			if (is_null)
+				continue;
+			char expected_name[8];
+			int len = snprintf(expected_name, sizeof(expected_name),
+					   "%llu",
+					   (unsigned long long)expected_id);
+			fail_unless(name_offsets[i + 1] - name_offsets[i] == len);
+			fail_unless(memcmp(name_data + name_offsets[i],
+					   expected_name, len) == 0);
+		}
+		array.release(&array);
+	}
+	fail_unless(batch_count == 4);
+	fail_unless(expected_id == row_count + 1);
+	stream.release(&stream);
+
+	key_end = mp_encode_array(key, 1);
+	key_end = mp_encode_uint(key_end, 11);
+	fail_unless(box_delete(space_id, 0, key, key_end, NULL) == 0);
+
+	/* Read view streams don't support keys. */
+	if (use_read_view) {
+		rc = box_index_arrow_stream(space_id, 0, lengthof(fields),
+					    fields, key, key_end, options,
+					    &stream);
+		fail_unless(rc == -1);
+		check_diag("ClientError",
+			   "Arrow stream in read view does not support keys");
+	}
+	box_arrow_options_delete(options);
+}
+
+/** Return the child array of a single-row batch with the given format. */
+static const void *
+arrow_single_value(struct ArrowSchema *schema, struct ArrowArray *array,
+		   int i, const char *format)
+{
+	fail_unless(strcmp(schema->children[i]->format, format) == 0);
+	fail_unless(array->children[i]->length == 1);
+	fail_unless(array->children[i]->null_count == 0);
+	return array->children[i]->buffers[1];
+}
+
+static int
+test_box_index_arrow_stream_types(struct lua_State *L)
+{
+	fail_unless(lua_gettop(L) == 1);
+	fail_unless(lua_isnumber(L, 1));
+	uint32_t space_id = lua_tointeger(L, 1);
+
+	char key[8];
+	char *key_end = mp_encode_array(key, 0);
+	uint32_t fields[] = {1, 2, 3, 4, 5, 6};
+	for (int use_read_view = 0; use_read_view <= 1; use_read_view++) {
+		box_arrow_options_t *options = box_arrow_options_new();
+		box_arrow_options_set_use_read_view(options, use_read_view);
+		struct ArrowArrayStream stream;
+		int rc = box_index_arrow_stream(space_id, 0, lengthof(fields),
+						fields, key, key_end, options,
+						&stream);
+		box_arrow_options_delete(options);
+		fail_unless(rc == 0);
+		struct ArrowSchema schema;
+		fail_unless(stream.get_schema(&stream, &schema) == 0);
+		struct ArrowArray array;
+		fail_unless(stream.get_next(&stream, &array) == 0);
+		fail_unless(array.length == 1);
+
+		/* decimal: -1.5 */
+		const int32_t *offsets =
+			arrow_single_value(&schema, &array, 0, "u");
+		const char *data = array.children[0]->buffers[2];
+		fail_unless(offsets[1] - offsets[0] == 4);
+		fail_unless(memcmp(data + offsets[0], "-1.5", 4) == 0);
+		/* decimal32, scale 2: -12.3 */
+		const int64_t *d32 =
+			arrow_single_value(&schema, &array, 1, "d:9,2");
+		fail_unless(d32[0] == -1230 && d32[1] == -1);
+		/* decimal256, scale 3: 7 */
+		const int64_t *d256 =
+			arrow_single_value(&schema, &array, 2, "d:76,3,256");
+		fail_unless(d256[0] == 7000 && d256[1] == 0 &&
+			    d256[2] == 0 && d256[3] == 0);
+		/* uuid: 11223344-5566-7788-99aa-bbccddeeff00 */
+		const char *uuid =
+			arrow_single_value(&schema, &array, 3, "w:16");
+		fail_unless(memcmp(uuid, "\x11\x22\x33\x44\x55\x66\x77\x88"
+				   "\x99\xaa\xbb\xcc\xdd\xee\xff\x00",
+				   16) == 0);
+		/* datetime: 1 second 5 nanoseconds since Epoch */
+		const int64_t *dt =
+			arrow_single_value(&schema, &array, 4, "tsn:UTC");
+		fail_unless(dt[0] == 1000000005);
+		/* array: {1, 2} as raw MsgPack */
+		offsets = arrow_single_value(&schema, &array, 5, "z");
+		data = array.children[5]->buffers[2];
+		fail_unless(offsets[1] - offsets[0] == 3);
+		fail_unless(memcmp(data + offsets[0], "\x92\x01\x02", 3) == 0);
+
+		array.release(&array);
+		schema.release(&schema);
+		fail_unless(stream.get_next(&stream, &array) == 0);
+		fail_unless(array.release == NULL);
+		stream.release(&stream);
+	}
+	lua_pushboolean(L, 1);
+	return 1;
+}
+
+static int
+test_box_index_arrow_stream(struct lua_State *L)
+{
+	fail_unless(lua_gettop(L) == 1);
+	fail_unless(lua_isnumber(L, 1));
+	uint32_t space_id = lua_tointeger(L, 1);
+	check_index_arrow_stream(space_id, false);
+	check_index_arrow_stream(space_id, true);
+	lua_pushboolean(L, 1);
+	return 1;
+}
+
+/**
+ * Return the ids selected by an Arrow stream over the space created by
+ * the Lua part of the box_index_arrow_stream_predicates test. Checks
+ * that no batch is empty and stores the number of batches.
+ */
+static int
+arrow_stream_select_ids(uint32_t space_id, box_arrow_options_t *options,
+			uint64_t *ids, int *batch_count)
+{
+	char key[8];
+	char *key_end = mp_encode_array(key, 0);
+	uint32_t fields[] = {0};
+	struct ArrowArrayStream stream;
+	int rc = box_index_arrow_stream(space_id, 0, lengthof(fields), fields,
+					key, key_end, options, &stream);
+	fail_unless(rc == 0);
+	int count = 0;
+	*batch_count = 0;
+	while (true) {
+		struct ArrowArray array;
+		fail_unless(stream.get_next(&stream, &array) == 0);
+		if (array.release == NULL)
+			break;
+		fail_unless(array.length > 0);
+		(*batch_count)++;
+		const uint64_t *values = array.children[0]->buffers[1];
+		for (int64_t i = 0; i < array.length; i++)
+			ids[count++] = values[i];
+		array.release(&array);
+	}
+	stream.release(&stream);
+	return count;
+}
+
+static int
+test_box_index_arrow_stream_predicates(struct lua_State *L)
+{
+	fail_unless(lua_gettop(L) == 1);
+	fail_unless(lua_isnumber(L, 1));
+	uint32_t space_id = lua_tointeger(L, 1);
+
+	/*
+	 * The space contains {i, i % 2 == 0 ? tostring(i) : nil,
+	 * i * 0.5, colors[i % 3 + 1], true}, where colors are
+	 * {'red', 'green', 'blue'}, i = 1..10.
+	 */
+	char value[16];
+	char *value_end;
+	uint64_t ids[10];
+	int batch_count;
+	for (int use_read_view = 0; use_read_view <= 1; use_read_view++) {
+		box_arrow_options_t *options = box_arrow_options_new();
+		box_arrow_options_set_batch_row_count(options, 4);
+		box_arrow_options_set_use_read_view(options, use_read_view);
+		value_end = mp_encode_uint(value, 3);
+		box_arrow_options_add_predicate(options, 0,
+						BOX_ARROW_PREDICATE_GE,
+						value, value_end);
+		value_end = mp_encode_str0(value, "red");
+		box_arrow_options_add_predicate(options, 3,
+						BOX_ARROW_PREDICATE_EQ,
+						value, value_end);
+		value_end = mp_encode_double(value, 4.0);
+		box_arrow_options_add_predicate(options, 2,
+						BOX_ARROW_PREDICATE_LT,
+						value, value_end);
+		/*
+		 * Rows 1-4 and 5-8 yield a row each, rows 9-10 yield no
+		 * rows and are skipped.
+		 */
+		int count = arrow_stream_select_ids(space_id, options, ids,
+						    &batch_count);
+		fail_unless(count == 2);
+		fail_unless(ids[0] == 3 && ids[1] == 6);
+		fail_unless(batch_count == 2);
+		box_arrow_options_delete(options);
+
+		/* Null fields never satisfy a predicate. */
+		options = box_arrow_options_new();
+		box_arrow_options_set_use_read_view(options, use_read_view);
+		value_end = mp_encode_str0(value, "4");
+		box_arrow_options_add_predicate(options, 1,
+						BOX_ARROW_PREDICATE_NE,
+						value, value_end);
+		count = arrow_stream_select_ids(space_id, options, ids,
+						&batch_count);
+		fail_unless(count == 4);
+		fail_unless(ids[0] == 2 && ids[1] == 6 &&
+			    ids[2] == 8 && ids[3] == 10);
+		fail_unless(batch_count == 1);
+		box_arrow_options_delete(options);
+
+		char key[8];
+		char *key_end = mp_encode_array(key, 0);
+		uint32_t fields[] = {0};
+		struct ArrowArrayStream stream;
+		options = box_arrow_options_new();
+		box_arrow_options_set_use_read_view(options, use_read_view);
+		value_end = mp_encode_bool(value, true);
+		box_arrow_options_add_predicate(options, 4,
+						BOX_ARROW_PREDICATE_EQ,
+						value, value_end);
+		int rc = box_index_arrow_stream(space_id, 0, lengthof(fields),
+						fields, key, key_end, options,
+						&stream);
+		fail_unless(rc == -1);
+		check_diag("ClientError", "Arrow stream predicate does not "
+			   "support fields of type boolean");
+		box_arrow_options_delete(options);
+
+		options = box_arrow_options_new();
+		box_arrow_options_set_use_read_view(options, use_read_view);
+		value_end = mp_encode_str0(value, "x");
+		box_arrow_options_add_predicate(options, 0,
+						BOX_ARROW_PREDICATE_EQ,
+						value, value_end);
+		rc = box_index_arrow_stream(space_id, 0, lengthof(fields),
+					    fields, key, key_end, options,
+					    &stream);
+		fail_unless(rc == -1);
+		check_diag("IllegalParams", "Invalid predicate value for "
+			   "field 1 (id): expected unsigned, got string");
+		box_arrow_options_delete(options);
+	}
+	lua_pushboolean(L, 1);
+	return 1;
+}
+
+static int
+test_box_index_arrow_stream_dictionary(struct lua_State *L)
+{
+	fail_unless(lua_gettop(L) == 1);
+	fail_unless(lua_isnumber(L, 1));
+	uint32_t space_id = lua_tointeger(L, 1);
+
+	char key[8];
+	char *key_end = mp_encode_array(key, 0);
+	uint32_t fields[] = {3};
+	for (int use_read_view = 0; use_read_view <= 1; use_read_view++) {
+		box_arrow_options_t *options = box_arrow_options_new();
+		box_arrow_options_set_use_read_view(options, use_read_view);
+		box_arrow_options_set_use_dictionary(options, true);
+		struct ArrowArrayStream stream;
+		int rc = box_index_arrow_stream(space_id, 0, lengthof(fields),
+						fields, key, key_end, options,
+						&stream);
+		box_arrow_options_delete(options);
+		fail_unless(rc == 0);
+		struct ArrowSchema schema;
+		fail_unless(stream.get_schema(&stream, &schema) == 0);
+		struct ArrowSchema *child = schema.children[0];
+		fail_unless(strcmp(child->format, "i") == 0);
+		fail_unless(child->dictionary != NULL);
+		fail_unless(strcmp(child->dictionary->format, "u") == 0);
+		schema.release(&schema);
+
+		struct ArrowArray array;
+		fail_unless(stream.get_next(&stream, &array) == 0);
+		fail_unless(array.length == 10);
+		struct ArrowArray *column = array.children[0];
+		fail_unless(column->null_count == 0);
+		fail_unless(column->dictionary != NULL);
+		/* The dictionary is in the order of the first occurrence. */
+		const char *colors[] = {"green", "blue", "red"};
+		struct ArrowArray *dictionary = column->dictionary;
+		fail_unless(dictionary->length == lengthof(colors));
+		const int32_t *offsets = dictionary->buffers[1];
+		const char *data = dictionary->buffers[2];
+		for (size_t i = 0; i < lengthof(colors); i++) {
+			int len = strlen(colors[i]);
+			fail_unless(offsets[i + 1] - offsets[i] == len);
+			fail_unless(memcmp(data + offsets[i], colors[i],
+					   len) == 0);
+		}
+		const int32_t *indexes = column->buffers[1];
+		for (int i = 0; i < 10; i++)
+			fail_unless(indexes[i] == i % 3);
+		array.release(&array);
+		fail_unless(stream.get_next(&stream, &array) == 0);
+		fail_unless(array.release == NULL);
+		stream.release(&stream);
+	}
+	lua_pushboolean(L, 1);
+	return 1;
+}
+
+static int
+test_box_index_arrow_stream_upgrade(struct lua_State *L)
+{
+	fail_unless(lua_gettop(L) == 1);
+	fail_unless(lua_isnumber(L, 1));
+	uint32_t space_id = lua_tointeger(L, 1);
+
+	char key[8];
+	char *key_end = mp_encode_array(key, 0);
+	uint32_t fields[] = {0, 1};
+	box_arrow_options_t *options = box_arrow_options_new();
+	struct ArrowArrayStream stream;
+
+	/* Tuples are upgraded by a stream without a read view. */
+	int rc = box_index_arrow_stream(space_id, 0, lengthof(fields), fields,
+					key, key_end, options, &stream);
+	fail_unless(rc == 0);
+	struct ArrowArray array;
+	fail_unless(stream.get_next(&stream, &array) == 0);
+	fail_unless(array.length == 1);
+	const int32_t *offsets = array.children[1]->buffers[1];
+	const char *data = array.children[1]->buffers[2];
+	fail_unless(offsets[1] - offsets[0] == 1);
+	fail_unless(memcmp(data + offsets[0], "x", 1) == 0);
+	array.release(&array);
+	stream.release(&stream);
+
+	/* Read view streams don't support space upgrade. */
+	box_arrow_options_set_use_read_view(options, true);
+	rc = box_index_arrow_stream(space_id, 0, lengthof(fields), fields,
+				    key, key_end, options, &stream);
+	fail_unless(rc == -1);
+	check_diag("ClientError",
+		   "Arrow stream in read view does not support space upgrade");
+	box_arrow_options_delete(options);
 	lua_pushboolean(L, 1);
 	return 1;
 }
@@ -3472,6 +3978,15 @@ luaopen_module_api(lua_State *L)
 		{"box_iproto_override_set", test_box_iproto_override_set},
 		{"box_iproto_override_reset", test_box_iproto_override_reset},
 		{"box_insert_arrow", test_box_insert_arrow},
+		{"box_index_arrow_stream", test_box_index_arrow_stream},
+		{"box_index_arrow_stream_types",
+		 test_box_index_arrow_stream_types},
+		{"box_index_arrow_stream_upgrade",
+		 test_box_index_arrow_stream_upgrade},
+		{"box_index_arrow_stream_predicates",
+		 test_box_index_arrow_stream_predicates},
+		{"box_index_arrow_stream_dictionary",
+		 test_box_index_arrow_stream_dictionary},
 		{NULL, NULL}
 	};
 	luaL_register(L, "module_api", lib);
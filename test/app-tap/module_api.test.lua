@@ -671,13 +671,115 @@ local function test_box_ibuf(test, module)
 end
 
 local function test_box_insert_arrow(test, module)
+    test:plan(2)
+    local s = box.schema.space.create('test_insert_arrow', {format = {
+        {'id', 'unsigned'},
+        {'name', 'string', is_nullable = true},
+        {'data', 'varbinary'},
+    }})
+    s:create_index('pk')
+    test:ok(module.box_insert_arrow(s.id), "box_insert_arrow API")
+    local rows = {}
+    for _, tuple in s:pairs() do
+        table.insert(rows, {tuple.id, tuple.name, tostring(tuple.data)})
+    end
+    test:is_deeply(rows, {{1, 'a', '\x01\x02'}, {2, box.NULL, ''},
+                          {3, 'ccc', 'xyz'}}, "box_insert_arrow data")
+    s:drop()
+end
+
+local function test_box_index_arrow_stream(test, module)
     test:plan(1)
-    test:ok(module.box_insert_arrow(box.space.test.id),
-            "box_insert_arrow API")
+    local s = box.schema.space.create('test_arrow', {format = {
+        {'id', 'unsigned'},
+        {'name', 'string', is_nullable = true},
+    }})
+    s:create_index('pk')
+    for i = 1, 10 do
+        s:insert({i, i % 2 == 0 and tostring(i) or box.NULL, 'x'})
+    end
+    test:ok(module.box_index_arrow_stream(s.id), "box_index_arrow_stream API")
+    s:drop()
+end
+
+local function test_box_index_arrow_stream_types(test, module)
+    test:plan(1)
+    local datetime = require('datetime')
+    local decimal = require('decimal')
+    local uuid = require('uuid')
+    local s = box.schema.space.create('test_arrow_types', {format = {
+        {'id', 'unsigned'},
+        {'dec', 'decimal'},
+        {'d32', 'decimal32', scale = 2},
+        {'d256', 'decimal256', scale = 3},
+        {'u', 'uuid'},
+        {'dt', 'datetime'},
+        {'arr', 'array'},
+    }})
+    s:create_index('pk')
+    s:insert({1, decimal.new('-1.5'), decimal.new('-12.3'), decimal.new(7),
+              uuid.fromstr('11223344-5566-7788-99aa-bbccddeeff00'),
+              datetime.new({timestamp = 1, nsec = 5}), {1, 2}})
+    test:ok(module.box_index_arrow_stream_types(s.id),
+            "box_index_arrow_stream field types")
+    s:drop()
+end
+
+local function test_box_index_arrow_stream_upgrade(test, module)
+    test:plan(1)
+    local s = box.schema.space.create('test_arrow_upgrade', {format = {
+        {'id', 'unsigned'},
+    }})
+    s:create_index('pk')
+    s:insert({1})
+    box.schema.func.create('test_arrow_upgrade', {
+        body = 'function(t) return {t[1], "x"} end',
+        is_deterministic = true,
+    })
+    -- The upgrade is owned by another instance so tuples aren't
+    -- upgraded in the background.
+    box.space._space:update(s.id, {
+        {'=', 'flags.upgrade', {
+            func = box.func.test_arrow_upgrade.id,
+            owner = '11111111-1111-1111-1111-111111111111',
+        }},
+        {'=', 'format', {{name = 'id', type = 'unsigned'},
+                         {name = 'name', type = 'string'}}},
+    })
+    test:ok(module.box_index_arrow_stream_upgrade(s.id),
+            "box_index_arrow_stream with space upgrade")
+    -- Complete the upgrade to drop the space.
+    s:replace(s:get(1))
+    box.space._space:update(s.id, {{'#', 'flags.upgrade', 1}})
+    s:drop()
+    box.schema.func.drop('test_arrow_upgrade')
+end
+
+local function test_box_index_arrow_stream_predicates(test, module)
+    test:plan(2)
+    local colors = {'red', 'green', 'blue'}
+    local s = box.schema.space.create('test_arrow_predicates', {format = {
+        {'id', 'unsigned'},
+        {'name', 'string', is_nullable = true},
+        {'score', 'double'},
+        {'color', 'string'},
+        {'flag', 'boolean'},
+    }})
+    s:create_index('pk')
+    for i = 1, 10 do
+        s:insert({i, i % 2 == 0 and tostring(i) or box.NULL,
+                  ffi.cast('double', i * 0.5),
+                  colors[i % 3 + 1], true})
+    end
+    test:ok(module.box_index_arrow_stream_predicates(s.id),
+            "box_index_arrow_stream with predicates")
+    test:ok(module.box_index_arrow_stream_dictionary(s.id),
+            "box_index_arrow_stream with dictionary columns")
+    s:drop()
 end
 
 require('tap').test("module_api", function(test)
-    test:plan(52)
+    test:plan(56)
     local status, module = pcall(require, 'module_api')
     test:is(status, true, "module")
     test:ok(status, "module is loaded")
@@ -716,6 +818,13 @@ require('tap').test("module_api", function(test)
     test:test("box_iproto_override", test_box_iproto_override, module)
     test:test("box_ibuf", test_box_ibuf, module)
     test:test("box_insert_arrow", test_box_insert_arrow, module)
+    test:test("box_index_arrow_stream", test_box_index_arrow_stream, module)
+    test:test("box_index_arrow_stream_types",
+              test_box_index_arrow_stream_types, module)
+    test:test("box_index_arrow_stream_upgrade",
+              test_box_index_arrow_stream_upgrade, module)
+    test:test("box_index_arrow_stream_predicates",
+              test_box_index_arrow_stream_predicates, module)
 
     space:drop()
 end)
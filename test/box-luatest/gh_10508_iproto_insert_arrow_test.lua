@@ -55,8 +55,10 @@ end)
 -- Test various invalid requests.
 g.test_iproto_insert_arrow_invalid = function(cg)
     cg.server:exec(function()
-        local s = box.schema.create_space('test')
-        s:create_index('pk')
+        local s = box.schema.create_space('test', {
+            format = {{'a', 'integer'}},
+        })
+        s:create_index('pk', {parts = {'a'}})
 
         -- <MP_MAP> {}
         local r = _G.iproto_insert_arrow('80')
@@ -128,7 +130,7 @@ g.test_iproto_insert_arrow_invalid = function(cg)
                         'Arrow decode error: ' ..
                         'Expected at least 8 bytes in remainder of stream')
 
-        -- A valid request, but memtx does not support arrow format.
+        -- A valid request.
         r = _G.iproto_insert_arrow([[
             8210cd020036c8011008ffffffff70000000040000009effffff0400010004000000
             b6ffffff0c00000004000000000000000100000004000000daffffff140000000202
@@ -139,7 +141,7 @@ g.test_iproto_insert_arrow_invalid = function(cg)
             00000000000000000000000000000800000000000000000000000100000001000000
             0000000000000000000000000a00140004000c0010000c0014000400060008000c00
             00000000000000000000]])
-        t.assert_equals(r[box.iproto.key.ERROR_24],
-                        'memtx does not support arrow format')
+        t.assert_equals(r[box.iproto.key.ERROR_24], nil)
+        t.assert_equals(s:select(), {{0}})
     end)
 end
@@ -78,7 +78,141 @@ g.test_space_insert_arrow = function(cg)
         local mp_arrow = string.fromhex(mp_arrow_hex:gsub("%s+", ""))
         local arrow = msgpack.decode(mp_arrow)
         t.assert_error_msg_equals(
-            "memtx does not support arrow format",
+            "Field 'a' was not found in space 'test' format",
             s.insert_arrow, s, arrow)
+        s:format({{'a', 'integer'}, {'b', 'string', is_nullable = true}})
+        t.assert_error_msg_equals(
+            "No index #0 is defined in space 'test'",
+            s.insert_arrow, s, arrow)
+        s:create_index('pk', {parts = {'a'}})
+        s:insert_arrow(arrow)
+        t.assert_equals(s:select(), {{0}})
+        t.assert_error_msg_content_equals(
+            "Duplicate key exists in unique index \"pk\" in space " ..
+            "\"test\" with old tuple - [0] and new tuple - [0]",
+            s.insert_arrow, s, arrow)
+    end, {mp_arrow_hex})
+end
+
+g.test_space_insert_arrow_engine = function(cg)
+    cg.server:exec(function(mp_arrow_hex)
+        local msgpack = require('msgpack')
+        local mp_arrow = string.fromhex(mp_arrow_hex:gsub("%s+", ""))
+        local arrow = msgpack.decode(mp_arrow)
+        for _, engine in ipairs({'memtx', 'vinyl'}) do
+            local s = box.schema.create_space('test', {
+                engine = engine, format = {{'a', 'integer'}},
+            })
+            s:create_index('pk', {parts = {'a'}})
+            s:create_index('sk', {parts = {{1, 'integer'}}})
+            -- Rows are inserted in the current transaction.
+            box.begin()
+            s:insert_arrow(arrow)
+            t.assert_equals(s:select(), {{0}})
+            box.rollback()
+            t.assert_equals(s:select(), {})
+            -- on_replace triggers are run for each row.
+            local new_tuples = {}
+            s:on_replace(function(_, new)
+                table.insert(new_tuples, new:totable())
+            end)
+            s:insert_arrow(arrow)
+            t.assert_equals(s:select(), {{0}})
+            t.assert_equals(s.index.sk:select(), {{0}})
+            t.assert_equals(new_tuples, {{0}})
+            s:drop()
+        end
     end, {mp_arrow_hex})
 end
+
+g.test_space_insert_arrow_unsupported = function(cg)
+    cg.server:exec(function(mp_arrow_hex)
+        local msgpack = require('msgpack')
+        local mp_arrow = string.fromhex(mp_arrow_hex:gsub("%s+", ""))
+        local arrow = msgpack.decode(mp_arrow)
+        local s = box.schema.create_space('test', {
+            format = {{'a', 'unsigned'}},
+        })
+        s:create_index('pk', {sequence = true})
+        t.assert_error_msg_equals(
+            "box_insert_arrow does not support spaces with sequences",
+            s.insert_arrow, s, arrow)
+        s:drop()
+        s = box.schema.create_space('test', {format = {
+            {'a', 'unsigned'}, {'b', 'unsigned', default = 1,
+                                is_nullable = true}}})
+        s:create_index('pk')
+        t.assert_error_msg_equals(
+            "box_insert_arrow does not support spaces with field defaults",
+            s.insert_arrow, s, arrow)
+        s:format({{'a', 'unsigned'}})
+        s:before_replace(function(_, new) return new end)
+        t.assert_error_msg_equals(
+            "box_insert_arrow does not support spaces with " ..
+            "before_replace triggers",
+            s.insert_arrow, s, arrow)
+    end, {mp_arrow_hex})
+end
+
+g.test_space_insert_arrow_recovery = function(cg)
+    cg.server:exec(function(mp_arrow_hex)
+        local msgpack = require('msgpack')
+        local mp_arrow = string.fromhex(mp_arrow_hex:gsub("%s+", ""))
+        local arrow = msgpack.decode(mp_arrow)
+        for _, engine in ipairs({'memtx', 'vinyl'}) do
+            local s = box.schema.create_space('test_' .. engine, {
+                engine = engine, format = {{'a', 'integer'}},
+            })
+            s:create_index('pk', {parts = {'a'}})
+            s:insert_arrow(arrow)
+        end
+    end, {mp_arrow_hex})
+    cg.server:restart()
+    cg.server:exec(function()
+        for _, engine in ipairs({'memtx', 'vinyl'}) do
+            local s = box.space['test_' .. engine]
+            t.assert_equals(s:select(), {{0}})
+            s:drop()
+        end
+    end)
+end
+
+g.test_space_insert_arrow_recovery_triggers = function(cg)
+    cg.server:exec(function(mp_arrow_hex)
+        local msgpack = require('msgpack')
+        local mp_arrow = string.fromhex(mp_arrow_hex:gsub("%s+", ""))
+        local arrow = msgpack.decode(mp_arrow)
+        local s = box.schema.create_space('test_triggers', {
+            format = {{'a', 'integer'}},
+        })
+        s:create_index('pk', {parts = {'a'}})
+        s:insert_arrow(arrow)
+    end, {mp_arrow_hex})
+    local run_before_cfg = [[
+        local trigger = require('trigger')
+        local msgpack = require('msgpack')
+        rawset(_G, 'recovered', {})
+        trigger.set('box.space.test_triggers.on_recovery_replace', 'test',
+                    function(_, new, _, req, header, body)
+            assert(msgpack.is_object(header))
+            assert(msgpack.is_object(body))
+            table.insert(rawget(_G, 'recovered'),
+                         {new:totable(), req, body.space_id})
+        end)
+        -- A logged batch is replayed even if the space has before_replace
+        -- triggers on recovery.
+        trigger.set('box.space.test_triggers.before_recovery_replace',
+                    'test', function(_, new) return new end)
+    ]]
+    cg.server:restart({
+        env = {
+            ['TARANTOOL_RUN_BEFORE_BOX_CFG'] = run_before_cfg,
+        }
+    })
+    cg.server:exec(function()
+        local s = box.space.test_triggers
+        t.assert_equals(s:select(), {{0}})
+        t.assert_equals(rawget(_G, 'recovered'), {{{0}, 'INSERT', s.id}})
+        s:drop()
+    end)
+end
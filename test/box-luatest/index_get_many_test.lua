@@ -0,0 +1,98 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group(nil, {
+    {engine = 'memtx', index_type = 'TREE'},
+    {engine = 'memtx', index_type = 'HASH'},
+    {engine = 'vinyl', index_type = 'TREE'},
+})
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function(engine, index_type)
+        local s = box.schema.space.create('test', {engine = engine})
+        s:create_index('pk', {type = index_type})
+        s:create_index('sk', {
+            type = index_type,
+            parts = {{2, 'string'}, {3, 'unsigned'}},
+        })
+        s:create_index('nu', {type = 'TREE', parts = {3, 'unsigned'},
+                              unique = false})
+        for i = 1, 100 do
+            s:insert({i, 'k' .. i % 10, i})
+        end
+    end, {cg.params.engine, cg.params.index_type})
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:drop()
+    end)
+end)
+
+g.test_get_many = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:get_many({}), {})
+        t.assert_equals(s:get_many({50, 1000, 3, {7}, 3}),
+                        {{50, 'k0', 50}, {3, 'k3', 3}, {7, 'k7', 7},
+                         {3, 'k3', 3}})
+        t.assert_equals(s.index.pk:get_many({1000, 2000}), {})
+        t.assert_equals(s.index.sk:get_many({{'k5', 15}, {'k5', 16},
+                                             {'k1', 91}}),
+                        {{15, 'k5', 15}, {91, 'k1', 91}})
+        local keys = {}
+        local expected = {}
+        for i = 100, 1, -1 do
+            table.insert(keys, i)
+            table.insert(expected, {i, 'k' .. i % 10, i})
+        end
+        t.assert_equals(s:get_many(keys), expected)
+        t.assert_equals(s:get_many({box.tuple.new({42})}), {{42, 'k2', 42}})
+    end)
+end
+
+g.test_get_many_in_txn = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        box.begin()
+        s:delete({1})
+        s:replace({2, 'k2', 200})
+        s:insert({101, 'k1', 101})
+        t.assert_equals(s:get_many({1, 2, 101}),
+                        {{2, 'k2', 200}, {101, 'k1', 101}})
+        box.rollback()
+        t.assert_equals(s:get_many({1, 2, 101}),
+                        {{1, 'k1', 1}, {2, 'k2', 2}})
+    end)
+end
+
+g.test_get_many_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_error_msg_content_equals(
+            "Usage: index:get_many({key1, key2, ...})",
+            s.get_many, s, 1)
+        t.assert_error_msg_content_equals(
+            "Use index:get_many(...) instead of index.get_many(...)",
+            s.index.pk.get_many, {1})
+        t.assert_error_msg_content_equals(
+            "Invalid key part count in an exact match (expected 2, got 1)",
+            s.index.sk.get_many, s.index.sk, {{'k1', 1}, {'k1'}})
+        t.assert_error_msg_content_equals(
+            "Supplied key type of part 0 does not match index part type: " ..
+            "expected unsigned",
+            s.get_many, s, {1, 'x'})
+        t.assert_error_msg_content_equals(
+            "Get() doesn't support partial keys and non-unique indexes",
+            s.index.nu.get_many, s.index.nu, {1})
+    end)
+end
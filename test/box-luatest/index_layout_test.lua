@@ -53,7 +53,7 @@ g.test_unsupported = function(cg)
         t.assert_error_covers({
             type = 'ClientError',
             name = 'UNSUPPORTED',
-            message = "vinyl does not support 'layout' option",
+            message = "vinyl does not support layout 'test'",
         }, s.create_index, s, 'pk', {layout = 'test'})
     end)
 end
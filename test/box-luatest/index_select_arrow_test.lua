@@ -0,0 +1,196 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local format = {
+            {'id', 'unsigned'},
+            {'name', 'string', is_nullable = true},
+            {'color', 'string'},
+        }
+        local colors = {'red', 'green', 'blue'}
+        local s = box.schema.space.create('src', {format = format})
+        s:create_index('pk')
+        s:create_index('color', {parts = {'color'}, unique = false})
+        for i = 1, 10 do
+            s:insert({i, i % 2 == 0 and tostring(i) or box.NULL,
+                      colors[i % 3 + 1]})
+        end
+        box.schema.space.create('dst', {format = format})
+        box.space.dst:create_index('pk')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.dst:truncate()
+    end)
+end)
+
+g.test_select_arrow = function(cg)
+    cg.server:exec(function()
+        local src = box.space.src
+        local dst = box.space.dst
+        local batches = src.index.pk:select_arrow(nil, {batch_row_count = 4})
+        t.assert_equals(#batches, 3)
+        for _, batch in ipairs(batches) do
+            t.assert_type(batch, 'string')
+            dst:insert_arrow(batch)
+        end
+        t.assert_equals(dst:select(), src:select())
+    end)
+end
+
+g.test_select_arrow_fields = function(cg)
+    cg.server:exec(function()
+        local src = box.space.src
+        local dst = box.space.dst
+        local batches = src.index.pk:select_arrow({}, {
+            fields = {'id', 3},
+        })
+        t.assert_equals(#batches, 1)
+        dst:insert_arrow(batches[1])
+        t.assert_equals(dst:select(), src:pairs():map(function(tuple)
+            return {tuple.id, box.NULL, tuple.color}
+        end):totable())
+    end)
+end
+
+g.test_select_arrow_key = function(cg)
+    cg.server:exec(function()
+        local src = box.space.src
+        local dst = box.space.dst
+        -- The key must stay valid while batches are encoded.
+        local batches = src.index.color:select_arrow({'red'}, {
+            batch_row_count = 1,
+        })
+        t.assert_equals(#batches, 3)
+        for _, batch in ipairs(batches) do
+            dst:insert_arrow(batch)
+        end
+        t.assert_equals(dst:select(), src.index.color:select({'red'}))
+        dst:truncate()
+        batches = src.index.color:select_arrow({'green'}, {
+            batch_row_count = 2,
+            where = {{'id', 'GT', 1}},
+        })
+        t.assert_equals(#batches, 2)
+        for _, batch in ipairs(batches) do
+            dst:insert_arrow(batch)
+        end
+        t.assert_equals(dst:select(), {
+            {4, '4', 'green'}, {7, box.NULL, 'green'},
+            {10, '10', 'green'},
+        })
+    end)
+end
+
+g.test_select_arrow_where = function(cg)
+    cg.server:exec(function()
+        local src = box.space.src
+        local dst = box.space.dst
+        local batches = src.index.pk:select_arrow(nil, {
+            batch_row_count = 4,
+            where = {{'id', 'GE', 3}, {'color', 'EQ', 'red'}},
+        })
+        -- Rows 1-4, 5-8 and 9-10 yield one row each.
+        t.assert_equals(#batches, 3)
+        for _, batch in ipairs(batches) do
+            dst:insert_arrow(batch)
+        end
+        t.assert_equals(dst:select(), {
+            {3, box.NULL, 'red'}, {6, '6', 'red'}, {9, box.NULL, 'red'},
+        })
+        -- Null fields never match.
+        batches = src.index.pk:select_arrow(nil, {
+            where = {{'name', 'NE', '4'}, {'id', 'LT', 9}},
+        })
+        t.assert_equals(#batches, 1)
+        dst:truncate()
+        dst:insert_arrow(batches[1])
+        t.assert_equals(dst:select(), {
+            {2, '2', 'blue'}, {6, '6', 'red'}, {8, '8', 'blue'},
+        })
+        -- No rows match.
+        batches = src.index.pk:select_arrow(nil, {
+            where = {{'id', 'GT', 10}},
+        })
+        t.assert_equals(batches, {})
+    end)
+end
+
+g.test_select_arrow_where_collation = function(cg)
+    cg.server:exec(function()
+        local format = {
+            {'id', 'unsigned'},
+            {'str', 'string', collation = 'unicode_ci'},
+        }
+        local s = box.schema.space.create('coll', {format = format})
+        s:create_index('pk')
+        s:insert({1, 'a'})
+        s:insert({2, 'A'})
+        s:insert({3, 'b'})
+        local d = box.schema.space.create('coll_dst', {format = format})
+        d:create_index('pk')
+        -- Strings are compared with the field collation.
+        local batches = s.index.pk:select_arrow(nil, {
+            where = {{'str', 'EQ', 'a'}},
+        })
+        t.assert_equals(#batches, 1)
+        d:insert_arrow(batches[1])
+        t.assert_equals(d:select(), {{1, 'a'}, {2, 'A'}})
+        d:truncate()
+        batches = s.index.pk:select_arrow(nil, {
+            where = {{'str', 'LT', 'B'}},
+        })
+        t.assert_equals(#batches, 1)
+        d:insert_arrow(batches[1])
+        t.assert_equals(d:select(), {{1, 'a'}, {2, 'A'}})
+        s:drop()
+        d:drop()
+    end)
+end
+
+g.test_select_arrow_invalid_args = function(cg)
+    cg.server:exec(function()
+        local pk = box.space.src.index.pk
+        t.assert_error_msg_equals(
+            "Use index:select_arrow(...) instead of " ..
+            "index.select_arrow(...)",
+            pk.select_arrow)
+        local usage = "Usage: index:select_arrow(key, " ..
+                      "{fields = {...}, batch_row_count = n, where = {...}})"
+        t.assert_error_msg_equals(usage, pk.select_arrow, pk, nil, 'x')
+        t.assert_error_msg_equals(usage, pk.select_arrow, pk, nil,
+                                  {batch_row_count = 0})
+        t.assert_error_msg_equals(usage, pk.select_arrow, pk, nil,
+                                  {where = {'x'}})
+        t.assert_error_msg_equals("Unknown field 'x'",
+                                  pk.select_arrow, pk, nil, {fields = {'x'}})
+        t.assert_error_msg_equals("Unknown field 'x'",
+                                  pk.select_arrow, pk, nil,
+                                  {where = {{'x', 'EQ', 1}}})
+        t.assert_error_msg_equals("Unknown predicate operator 'LIKE'",
+                                  pk.select_arrow, pk, nil,
+                                  {where = {{'id', 'LIKE', 1}}})
+        t.assert_error_msg_equals(
+            "Invalid predicate value for field 1 (id): " ..
+            "expected unsigned, got string",
+            pk.select_arrow, pk, nil, {where = {{'id', 'EQ', 'x'}}})
+
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        t.assert_error_msg_equals(
+            "select_arrow requires fields or a space format",
+            s.index.pk.select_arrow, s.index.pk)
+        s:drop()
+    end)
+end
@@ -0,0 +1,160 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {type = 'HASH'})
+        s:insert({1, 'a'})
+        s:insert({2, 'b'})
+        s = box.schema.space.create('tree')
+        s:create_index('pk', {type = 'TREE'})
+        s:insert({1, 'a'})
+        box.schema.user.grant('guest', 'read', 'space', 'test')
+        box.schema.user.grant('guest', 'read', 'space', 'tree')
+        box.cfg{iproto_read_view_period = 0.01}
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.conn = net.connect(cg.server.net_box_uri)
+end)
+
+g.after_each(function(cg)
+    cg.conn:close()
+end)
+
+local function read_view_requests(cg)
+    return cg.server:exec(function()
+        return box.stat.net().READ_VIEW_REQUESTS.total
+    end)
+end
+
+-- Checks that simple primary key lookups are served from the read view.
+g.test_get = function(cg)
+    local total = read_view_requests(cg)
+    t.helpers.retrying({}, function()
+        t.assert_equals(cg.conn.space.test:get(1), {1, 'a'})
+        t.assert_gt(read_view_requests(cg), total)
+    end)
+    total = read_view_requests(cg)
+    t.assert_equals(cg.conn.space.test:get(2), {2, 'b'})
+    t.assert_equals(cg.conn.space.test:get(3), nil)
+    t.assert_equals(cg.conn.space.test:select({1}), {{1, 'a'}})
+    t.assert_equals(cg.conn.space.test:select({1}, {limit = 0}), {})
+    t.assert_equals(read_view_requests(cg), total + 3)
+    t.assert_error_msg_contains('Invalid key part count',
+                                cg.conn.space.test.get,
+                                cg.conn.space.test, {1, 2})
+end
+
+-- Checks that the read view is refreshed periodically.
+g.test_refresh = function(cg)
+    cg.server:exec(function()
+        box.space.test:replace({10, 'x'})
+    end)
+    t.helpers.retrying({}, function()
+        t.assert_equals(cg.conn.space.test:get(10), {10, 'x'})
+    end)
+    cg.server:exec(function()
+        box.space.test:delete({10})
+    end)
+    t.helpers.retrying({}, function()
+        t.assert_equals(cg.conn.space.test:get(10), nil)
+    end)
+end
+
+-- Checks that only spaces with a HASH primary index are served.
+g.test_tree = function(cg)
+    t.helpers.retrying({}, function()
+        local total = read_view_requests(cg)
+        t.assert_equals(cg.conn.space.test:get(1), {1, 'a'})
+        t.assert_gt(read_view_requests(cg), total)
+    end)
+    local total = read_view_requests(cg)
+    t.assert_equals(cg.conn.space.tree:get(1), {1, 'a'})
+    t.assert_equals(read_view_requests(cg), total)
+end
+
+-- Checks that access rights are respected.
+g.test_access = function(cg)
+    t.assert_equals(cg.conn.space.test:get(1), {1, 'a'})
+    cg.server:exec(function()
+        box.schema.user.revoke('guest', 'read', 'space', 'test')
+    end)
+    t.assert_error_msg_contains(
+        "Read access to space 'test' is denied for user 'guest'",
+        cg.conn.space.test.get, cg.conn.space.test, 1)
+    cg.server:exec(function()
+        box.schema.user.grant('guest', 'read', 'space', 'test')
+    end)
+    t.assert_equals(cg.conn.space.test:get(1), {1, 'a'})
+end
+
+-- Checks that a connection reads its own writes even if the read view
+-- is older.
+g.test_read_own_writes = function(cg)
+    cg.server:exec(function()
+        box.schema.user.grant('guest', 'write', 'space', 'test')
+        box.cfg{iproto_read_view_period = 1000}
+    end)
+    t.helpers.retrying({}, function()
+        local total = read_view_requests(cg)
+        t.assert_equals(cg.conn.space.test:get(1), {1, 'a'})
+        t.assert_gt(read_view_requests(cg), total)
+    end)
+    local total = read_view_requests(cg)
+    cg.conn.space.test:replace({20, 'y'})
+    t.assert_equals(cg.conn.space.test:get(20), {20, 'y'})
+    local future = cg.conn.space.test:replace({21, 'z'}, {is_async = true})
+    t.assert_equals(cg.conn.space.test:get(21), {21, 'z'})
+    t.assert_equals(future:wait_result(), {21, 'z'})
+    t.assert_equals(read_view_requests(cg), total)
+    -- Other connections may get stale data until the read view is
+    -- refreshed.
+    local conn = net.connect(cg.server.net_box_uri)
+    t.helpers.retrying({}, function()
+        total = read_view_requests(cg)
+        t.assert_equals(conn.space.test:get(20), nil)
+        t.assert_gt(read_view_requests(cg), total)
+    end)
+    conn:close()
+    cg.server:exec(function()
+        box.space.test:delete({20})
+        box.space.test:delete({21})
+        box.schema.user.revoke('guest', 'write', 'space', 'test')
+        box.cfg{iproto_read_view_period = 0.01}
+    end)
+end
+
+-- Checks that the read view can be disabled.
+g.test_disable = function(cg)
+    cg.server:exec(function()
+        box.cfg{iproto_read_view_period = 0}
+    end)
+    local total = read_view_requests(cg)
+    t.assert_equals(cg.conn.space.test:get(1), {1, 'a'})
+    t.assert_equals(read_view_requests(cg), total)
+    cg.server:exec(function()
+        box.cfg{iproto_read_view_period = 0.01}
+    end)
+end
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'iproto_read_view_period': " ..
+            "the value must be greater than or equal to 0",
+            box.cfg, {iproto_read_view_period = -1})
+        t.assert_equals(box.cfg.iproto_read_view_period, 0.01)
+    end)
+end
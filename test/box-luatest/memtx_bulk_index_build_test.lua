@@ -0,0 +1,143 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {memtx_sort_threads = 4}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.error.injection.set('ERRINJ_BUILD_INDEX_DELAY', false)
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Checks that a secondary index is built correctly.
+g.test_build = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        box.begin()
+        for i = 1, 10000 do
+            s:insert({i, (i * 7919) % 10007, i % 10})
+        end
+        box.commit()
+        s:create_index('sk', {parts = {2, 'unsigned'}})
+        s:create_index('sk2', {parts = {3, 'unsigned'}, unique = false})
+        local expected = s:select()
+        table.sort(expected, function(a, b) return a[2] < b[2] end)
+        t.assert_equals(s.index.sk:select(), expected)
+        t.assert_equals(s.index.sk2:count(5), 1000)
+        t.assert_equals(s.index.sk2:select(5, {limit = 2}),
+                        {{5, (5 * 7919) % 10007, 5},
+                         {15, (15 * 7919) % 10007, 5}})
+        -- The index is maintained after build.
+        s:replace({1, 1, 1})
+        t.assert_equals(s.index.sk:get(1), {1, 1, 1})
+    end)
+end
+
+-- Checks that the unique constraint is checked.
+g.test_duplicate = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        box.begin()
+        for i = 1, 1000 do
+            s:insert({i, i})
+        end
+        s:replace({500, 1})
+        box.commit()
+        t.assert_error_msg_contains(
+            'Duplicate key exists in unique index "sk" in space "test"',
+            s.create_index, s, 'sk', {parts = {2, 'unsigned'}})
+        t.assert_equals(s.index.sk, nil)
+        -- Multiple nulls are allowed in a nullable unique index.
+        s:replace({500, box.NULL})
+        s:replace({600, box.NULL})
+        s:create_index('sk', {parts = {2, 'unsigned', is_nullable = true}})
+        t.assert_equals(s.index.sk:count(box.NULL), 2)
+    end)
+end
+
+-- Checks that changes made during the build get to the index.
+g.test_concurrent_changes = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        box.begin()
+        for i = 1, 1000 do
+            s:insert({i * 2, i * 2})
+        end
+        box.commit()
+        box.error.injection.set('ERRINJ_BUILD_INDEX_DELAY', true)
+        local f = fiber.new(s.create_index, s, 'sk',
+                            {parts = {2, 'unsigned'}})
+        f:set_joinable(true)
+        -- Changes of the tuples that have and haven't been processed.
+        for i = 1, 1000 do
+            s:replace({i * 2 - 1, i * 2 - 1})
+            if i % 3 == 0 then
+                s:delete(i * 2)
+            elseif i % 3 == 1 then
+                s:update(i * 2, {{'+', 2, 3000}})
+            end
+            fiber.yield()
+        end
+        -- A rolled back change.
+        box.begin()
+        s:replace({1, 100500})
+        box.rollback()
+        -- A key freed by a change may be reused.
+        s:update(2, {{'=', 2, 2}})
+        s:replace({100000, 2 + 3000})
+        box.error.injection.set('ERRINJ_BUILD_INDEX_DELAY', false)
+        local ok, err = f:join()
+        t.assert(ok, err)
+        local expected = s:select()
+        table.sort(expected, function(a, b) return a[2] < b[2] end)
+        t.assert_equals(s.index.sk:select(), expected)
+        t.assert_equals(s.index.sk:get(1), {1, 1})
+        t.assert_equals(s.index.sk:get(2), {2, 2})
+        t.assert_equals(s.index.sk:get(3002), {100000, 3002})
+    end)
+end
+
+-- Checks that a duplicate inserted during the build fails it.
+g.test_concurrent_duplicate = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        box.begin()
+        for i = 1, 100 do
+            s:insert({i, i})
+        end
+        box.commit()
+        box.error.injection.set('ERRINJ_BUILD_INDEX_DELAY', true)
+        local f = fiber.new(s.create_index, s, 'sk',
+                            {parts = {2, 'unsigned'}})
+        f:set_joinable(true)
+        s:replace({1000, 1})
+        box.error.injection.set('ERRINJ_BUILD_INDEX_DELAY', false)
+        local ok, err = f:join()
+        t.assert_not(ok)
+        t.assert_str_contains(tostring(err), 'Duplicate key exists')
+        t.assert_equals(s.index.sk, nil)
+    end)
+end
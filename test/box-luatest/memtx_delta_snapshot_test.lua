@@ -0,0 +1,154 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+local function define_helpers(cg)
+    cg.server:exec(function()
+        local fio = require('fio')
+        local xlog = require('xlog')
+        rawset(_G, 'last_snap', function()
+            local files = fio.glob(fio.pathjoin(box.cfg.memtx_dir, '*.snap'))
+            table.sort(files)
+            return files[#files], xlog.meta(files[#files])
+        end)
+        rawset(_G, 'is_delta', function()
+            local _, meta = _G.last_snap()
+            return next(meta.base_vclock) ~= nil
+        end)
+    end)
+end
+
+g.before_each(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            snap_delta_max = 2,
+            checkpoint_count = 100,
+            wal_cleanup_delay = 0,
+        },
+    })
+    cg.server:start()
+    define_helpers(cg)
+    cg.server:exec(function()
+        for _, name in ipairs({'a', 'b', 'c'}) do
+            local s = box.schema.space.create(name)
+            s:create_index('pk')
+            for i = 1, 10 do
+                s:insert({i, name})
+            end
+        end
+        box.snapshot()
+        t.assert_not(_G.is_delta())
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that only changed spaces are written to a delta snapshot and
+-- that the instance recovers from a chain of snapshots.
+g.test_recovery = function(cg)
+    cg.server:exec(function()
+        box.space.a:replace({1, 'x'})
+        box.snapshot()
+        t.assert(_G.is_delta())
+        local rows = {}
+        for _, row in require('xlog').pairs(_G.last_snap()) do
+            if row.BODY.space_id == box.space.a.id then
+                table.insert(rows, row.BODY.tuple)
+            end
+            t.assert_not_equals(row.BODY.space_id, box.space.b.id)
+        end
+        t.assert_equals(#rows, 10)
+        box.space.b:delete({1})
+        box.schema.space.create('d'):create_index('pk')
+        box.space.d:insert({1, 'd'})
+        box.snapshot()
+        t.assert(_G.is_delta())
+    end)
+    cg.server:restart()
+    define_helpers(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.space.a:get(1), {1, 'x'})
+        t.assert_equals(box.space.a:count(), 10)
+        t.assert_equals(box.space.b:get(1), nil)
+        t.assert_equals(box.space.b:count(), 9)
+        t.assert_equals(box.space.c:count(), 10)
+        t.assert_equals(box.space.d:select(), {{1, 'd'}})
+        -- The first snapshot after restart is full.
+        box.space.c:delete({1})
+        box.snapshot()
+        t.assert_not(_G.is_delta())
+    end)
+end
+
+-- Checks when a full snapshot is written instead of a delta.
+g.test_full = function(cg)
+    cg.server:exec(function()
+        -- The chain length is limited.
+        for _ = 1, 2 do
+            box.space.a:replace({1, 'x'})
+            box.snapshot()
+            t.assert(_G.is_delta())
+        end
+        box.space.a:replace({1, 'y'})
+        box.snapshot()
+        t.assert_not(_G.is_delta())
+        -- A space was dropped.
+        box.space.c:drop()
+        box.snapshot()
+        t.assert_not(_G.is_delta())
+        -- A space became empty.
+        box.space.b:truncate()
+        box.snapshot()
+        t.assert_not(_G.is_delta())
+        -- Delta snapshots are disabled.
+        box.cfg{snap_delta_max = 0}
+        box.space.a:replace({1, 'z'})
+        box.snapshot()
+        t.assert_not(_G.is_delta())
+    end)
+end
+
+-- Checks that backup and garbage collection keep the whole chain.
+g.test_backup_gc = function(cg)
+    cg.server:exec(function()
+        local fio = require('fio')
+        local base = _G.last_snap()
+        box.space.a:replace({1, 'x'})
+        box.snapshot()
+        local delta = _G.last_snap()
+        t.assert(_G.is_delta())
+        local files = {}
+        for _, file in ipairs(box.backup.start()) do
+            table.insert(files, fio.basename(file))
+        end
+        box.backup.stop()
+        t.assert_items_include(files, {fio.basename(delta),
+                                       fio.basename(base)})
+        box.cfg{checkpoint_count = 1}
+        box.space.b:replace({1, 'x'})
+        box.snapshot()
+        t.assert(_G.is_delta())
+        t.assert(fio.path.exists(base))
+        t.assert(fio.path.exists(delta))
+        box.space.b:replace({1, 'y'})
+        box.snapshot()
+        t.assert_not(_G.is_delta())
+        t.helpers.retrying({}, function()
+            t.assert_not(fio.path.exists(base))
+            t.assert_not(fio.path.exists(delta))
+        end)
+    end)
+end
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'snap_delta_max': " ..
+            "the value must be >= 0 and <= 2147483647",
+            box.cfg, {snap_delta_max = -1})
+        t.assert_equals(box.cfg.snap_delta_max, 2)
+    end)
+end
@@ -0,0 +1,126 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Checks that a hash index storing 64-bit hashes works as usual.
+g.test_hash64 = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {type = 'hash', hash_bits = 64})
+        s:create_index('sk', {
+            type = 'hash', hash_bits = 64,
+            parts = {{2, 'string', collation = 'unicode_ci'}},
+        })
+        t.assert_equals(s.index.pk.hash_bits, 64)
+        t.assert_equals(s.index.sk.hash_bits, 64)
+        for i = 1, 1000 do
+            s:insert({i, 'k' .. i})
+        end
+        t.assert_equals(s:len(), 1000)
+        t.assert_equals(s:get(500), {500, 'k500'})
+        t.assert_equals(s.index.sk:get('K500'), {500, 'k500'})
+        t.assert_equals(s.index.sk:select('K700', {iterator = 'eq'}),
+                        {{700, 'k700'}})
+        s:replace({500, 'x'})
+        t.assert_equals(s.index.sk:get('k500'), nil)
+        t.assert_equals(s.index.sk:get('X'), {500, 'x'})
+        s:delete(500)
+        t.assert_equals(s:get(500), nil)
+        t.assert_equals(s.index.sk:get('x'), nil)
+        t.assert_equals(s:len(), 999)
+        t.assert_error_msg_contains(
+            'Duplicate key exists', s.insert, s, {1001, 'K1'})
+        t.assert_equals(#s:select(), 999)
+    end)
+end
+
+-- Checks that numeric keys equal by value have equal hashes.
+g.test_hash64_number = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {
+            type = 'hash', hash_bits = 64, parts = {1, 'number'},
+        })
+        s:insert({1})
+        s:insert({-2})
+        s:insert({2.5})
+        t.assert_equals(s:get(1.0), {1})
+        t.assert_equals(s:get(-2.0), {-2})
+        t.assert_equals(s:get(2.5), {2.5})
+        t.assert_equals(s:get(1ULL), {1})
+    end)
+end
+
+g.test_invalid = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        t.assert_error_msg_equals(
+            "Wrong index options: 'hash_bits' must be 32 or 64",
+            s.create_index, s, 'pk', {type = 'hash', hash_bits = 48})
+        t.assert_error_msg_contains(
+            "hash_bits is only reasonable with memtx hash index",
+            s.create_index, s, 'pk', {type = 'tree', hash_bits = 64})
+        s:create_index('pk', {type = 'tree'})
+        t.assert_equals(s.index.pk.hash_bits, nil)
+        local v = box.schema.space.create('test_vinyl', {engine = 'vinyl'})
+        t.assert_error_msg_contains(
+            "hash_bits is only reasonable with memtx hash index",
+            v.create_index, v, 'pk', {hash_bits = 64})
+        v:drop()
+    end)
+end
+
+-- Checks that changing hash_bits rebuilds the index.
+g.test_alter = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {type = 'hash'})
+        t.assert_equals(s.index.pk.hash_bits, 32)
+        for i = 1, 100 do
+            s:insert({i})
+        end
+        s.index.pk:alter({hash_bits = 64})
+        t.assert_equals(s.index.pk.hash_bits, 64)
+        t.assert_equals(s:len(), 100)
+        t.assert_equals(s:get(50), {50})
+        s.index.pk:alter({hash_bits = 32})
+        t.assert_equals(s.index.pk.hash_bits, 32)
+        t.assert_equals(s:get(50), {50})
+    end)
+end
+
+-- Checks that a hash index with 64-bit hashes is recovered.
+g.test_recovery = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {type = 'hash', hash_bits = 64})
+        s:insert({1})
+        box.snapshot()
+        s:insert({2})
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s.index.pk.hash_bits, 64)
+        t.assert_equals(s:get(1), {1})
+        t.assert_equals(s:get(2), {2})
+    end)
+end
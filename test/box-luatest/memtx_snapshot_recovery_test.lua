@@ -0,0 +1,51 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that the snapshot is recovered correctly by the snapshot reader
+-- thread and that the recovery statistics are reported.
+g.test_snapshot_recovery = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'string'}})
+        box.begin()
+        for i = 1, 100000 do
+            s:insert({i, string.format('%08d', 100000 - i),
+                      string.rep('x', 32)})
+        end
+        box.commit()
+        box.snapshot()
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:count(), 100000)
+        t.assert_equals(s.index.sk:count(), 100000)
+        t.assert_equals(s:get(1), {1, '00099999', string.rep('x', 32)})
+        t.assert_equals(s.index.sk:min(),
+                        {100000, '00000000', string.rep('x', 32)})
+        local stat = box.stat.memtx().recovery
+        t.assert_ge(stat.rows, 100000)
+        t.assert_gt(stat.bytes, 100000 * 32)
+        t.assert_ge(stat.read_time, 0)
+        t.assert_ge(stat.apply_time, 0)
+        t.assert_ge(stat.build_time, 0)
+    end)
+    -- The force recovery mode reads the snapshot in the tx thread.
+    cg.server:restart({box_cfg = {force_recovery = true}})
+    cg.server:exec(function()
+        t.assert_equals(box.space.test:count(), 100000)
+        t.assert_ge(box.stat.memtx().recovery.rows, 100000)
+    end)
+end
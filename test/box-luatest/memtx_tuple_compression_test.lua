@@ -0,0 +1,190 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_enterprise()
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    if cg.server ~= nil then
+        cg.server:drop()
+    end
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Checks that compressed fields are transparent for the user.
+g.test_compression = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'payload', type = 'string', compression = 'zstd'},
+            {name = 'short', type = 'string', compression = 'zstd'},
+            {name = 'value', type = 'unsigned'},
+        }})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {'value'}, unique = false})
+        local payload = string.rep('tarantool', 1000)
+        local info = box.slab.info()
+        local compressed_size = info.compressed_size
+        local uncompressed_size = info.uncompressed_size
+        for i = 1, 100 do
+            s:insert({i, payload, 'short', i % 10})
+        end
+        info = box.slab.info()
+        t.assert_gt(info.uncompressed_size - uncompressed_size,
+                    100 * #payload)
+        t.assert_lt(info.compressed_size - compressed_size, 100 * #payload)
+
+        t.assert_equals(s:get(1), {1, payload, 'short', 1})
+        t.assert_equals(s:get(1).payload, payload)
+        t.assert_equals(s.index.sk:select(3, {limit = 1}),
+                        {{3, payload, 'short', 3}})
+        t.assert_equals(s:update(2, {{'=', 'value', 100}}),
+                        {2, payload, 'short', 100})
+        t.assert_equals(s:update(2, {{'=', 'payload', 'x'}}),
+                        {2, 'x', 'short', 100})
+        t.assert_equals(s:delete(3), {3, payload, 'short', 3})
+        t.assert_equals(s:replace({4, 'y', 'short', 4}),
+                        {4, 'y', 'short', 4})
+        t.assert_equals(s:count(), 99)
+
+        -- Tuples of a truncated space are freed in the background.
+        s:truncate()
+        t.helpers.retrying({}, function()
+            collectgarbage()
+            info = box.slab.info()
+            t.assert_equals(info.compressed_size, compressed_size)
+            t.assert_equals(info.uncompressed_size, uncompressed_size)
+        end)
+    end)
+end
+
+-- Checks that compressed tuples survive a restart.
+g.test_compression_recovery = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'payload', type = 'string', compression = 'zstd'},
+        }})
+        s:create_index('pk')
+        s:insert({1, string.rep('a', 1000)})
+        box.snapshot()
+        s:insert({2, string.rep('b', 1000)})
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:select(), {
+            {1, string.rep('a', 1000)},
+            {2, string.rep('b', 1000)},
+        })
+        t.assert_gt(box.slab.info().compressed_size, 0)
+    end)
+end
+
+-- Checks that compressed fields can't be indexed.
+g.test_compression_indexed_field = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {format = {
+            {name = 'id', type = 'unsigned', compression = 'zstd'},
+        }})
+        t.assert_error_msg_content_equals(
+            "Indexed field does not support compression",
+            s.create_index, s, 'pk')
+    end)
+end
+
+-- Checks that vinyl doesn't support compression.
+g.test_compression_vinyl = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_content_equals(
+            "Vinyl does not support compression",
+            box.schema.space.create, 'test', {engine = 'vinyl', format = {
+                {name = 'id', type = 'unsigned', compression = 'zstd'},
+            }})
+    end)
+end
+
+-- Checks that compressed values can't be supplied by the user and that
+-- values in fields without compression are never decompressed.
+g.test_compression_user_ext = function(cg)
+    cg.server:exec(function()
+        local msgpack = require('msgpack')
+        -- MP_EXT of type MP_COMPRESSION holding garbage.
+        local ext = msgpack.object_from_raw(string.char(0xd4, 0x05, 0x00))
+        local s = box.schema.space.create('test', {format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'payload', type = 'any', compression = 'zstd'},
+        }})
+        s:create_index('pk')
+        t.assert_error_msg_contains(
+            "Tuple field 2 (payload) type does not match one required " ..
+            "by operation: expected any, got extension",
+            s.insert, s, {1, ext})
+
+        local info = box.slab.info()
+        -- Fields without compression in the format are stored as is.
+        local tuple = s:insert({1, 'x', ext})
+        t.assert_equals(#tuple, 3)
+        t.assert_equals(s:get(1):bsize(), tuple:bsize())
+        t.assert_equals(s:update(1, {{'=', 2, 'y'}}):bsize(), tuple:bsize())
+        s:delete(1)
+        t.assert_equals(box.slab.info().compressed_size,
+                        info.compressed_size)
+        t.assert_equals(box.slab.info().uncompressed_size,
+                        info.uncompressed_size)
+
+        -- The same in a space without compression.
+        local s2 = box.schema.space.create('test2')
+        s2:create_index('pk')
+        s2:insert({1, ext})
+        t.assert_equals(s2:get(1):bsize(), 5)
+        -- A snapshot reads tuples from a read view.
+        box.snapshot()
+        s2:drop()
+    end)
+end
+
+-- Checks that lz4 compression works if Tarantool is built with liblz4.
+g.test_compression_lz4 = function(cg)
+    local supported = cg.server:exec(function()
+        local ok, err = pcall(box.schema.space.create, 'test', {format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'payload', type = 'string', compression = 'lz4'},
+        }})
+        if not ok then
+            t.assert_equals(err.message, "Wrong space format field 2: " ..
+                            "unknown compression type")
+        end
+        return ok
+    end)
+    t.skip_if(not supported, 'lz4 is not supported')
+    cg.server:exec(function()
+        local s = box.space.test
+        s:create_index('pk')
+        local payload = string.rep('tarantool', 1000)
+        local info = box.slab.info()
+        s:insert({1, payload})
+        s:insert({2, ''})
+        t.assert_lt(box.slab.info().compressed_size - info.compressed_size,
+                    #payload)
+        t.assert_equals(s:select(), {{1, payload}, {2, ''}})
+        box.snapshot()
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local payload = string.rep('tarantool', 1000)
+        t.assert_equals(box.space.test:select(), {{1, payload}, {2, ''}})
+    end)
+end
@@ -16,13 +16,89 @@ g.after_all(function()
     g.server:stop()
 end)
 
+g.after_each(function()
+    g.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+        for _, name in ipairs({'upgrade', 'upgrade_bad', 'upgrade_pk'}) do
+            if box.func[name] ~= nil then
+                box.func[name]:drop()
+            end
+        end
+    end)
+end)
+
+-- Creates a space with the given number of tuples {k, k}
+-- and functions used for upgrade.
+local function create_space(count)
+    g.server:exec(function(count)
+        local s = box.schema.create_space('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        for k = 1, count do
+            s:insert({k, k})
+        end
+        box.schema.func.create('upgrade', {
+            body = [[function(tuple, arg)
+                -- The function may be applied to an upgraded tuple
+                -- after restart.
+                if tuple[3] ~= nil then
+                    return tuple
+                end
+                local new = tuple:totable()
+                new[3] = string.format('%s%d', arg or '', tuple[1])
+                return new
+            end]],
+            is_deterministic = true,
+        })
+        box.schema.func.create('upgrade_bad', {
+            body = [[function(tuple)
+                if tuple[1] == 5 then
+                    error('upgrade error')
+                end
+                return tuple:update({{'=', 3, 'x'}})
+            end]],
+            is_deterministic = true,
+        })
+        box.schema.func.create('upgrade_pk', {
+            body = [[function(tuple)
+                return {tuple[1] + 1000, tuple[2], 'x'}
+            end]],
+            is_deterministic = true,
+        })
+    end, {count})
+end
+
+local new_format = {
+    {name = 'a', type = 'unsigned'},
+    {name = 'b', type = 'unsigned'},
+    {name = 'c', type = 'string'},
+}
+
 g.test_low_level_api = function()
     t.tarantool.skip_if_enterprise()
     g.server:exec(function()
         t.assert_error_msg_equals(
-            "Community edition does not support space upgrade",
+            "Wrong space options: unexpected upgrade option 'foo'",
+            box.space._space.update, box.space._space,
+            box.space.memtx.id, {{'=', 'flags.upgrade', {foo = 1}}})
+        t.assert_error_msg_equals(
+            "Wrong space options: upgrade option 'owner' " ..
+            "must be a UUID string",
+            box.space._space.update, box.space._space,
+            box.space.memtx.id, {{'=', 'flags.upgrade', {owner = 1}}})
+        for _, rate in ipairs({0, -1, 'x'}) do
+            t.assert_error_msg_equals(
+                "Wrong space options: upgrade option 'rate' " ..
+                "must be a positive number",
+                box.space._space.update, box.space._space,
+                box.space.memtx.id, {{'=', 'flags.upgrade', {rate = rate}}})
+        end
+        t.assert_error_msg_equals(
+            "Function '100500' does not exist",
             box.space._space.update, box.space._space,
-            box.space.memtx.id, {{'=', 'flags.upgrade', {}}})
+            box.space.memtx.id, {{'=', 'flags.upgrade', {func = 100500}}})
         t.assert_error_msg_equals(
             "vinyl does not support space upgrade",
             box.space._space.update, box.space._space,
@@ -36,13 +112,211 @@ end
 
 g.test_high_level_api = function()
     t.tarantool.skip_if_enterprise()
+    create_space(0)
+    g.server:exec(function()
+        t.assert_equals(box.space.memtx:upgrade(), nil)
+        t.assert_error_msg_equals(
+            "vinyl does not support space upgrade",
+            box.space.vinyl.upgrade, box.space.vinyl, {})
+        t.assert_error_msg_equals(
+            "sysview does not support space upgrade",
+            box.space._vspace.upgrade, box.space._vspace, {})
+        t.assert_error_msg_contains(
+            "unexpected option 'foo'",
+            box.space.test.upgrade, box.space.test, {foo = 1})
+        t.assert_error_msg_equals(
+            "Function 'foo' does not exist",
+            box.space.test.upgrade, box.space.test, {func = 'foo'})
+        box.schema.func.create('not_deterministic', {
+            body = 'function(t) return t end',
+        })
+        t.assert_error_msg_equals(
+            "Wrong space upgrade options: function 'not_deterministic' " ..
+            "doesn't meet space upgrade function criteria " ..
+            "(stored, deterministic, written in Lua)",
+            box.space.test.upgrade, box.space.test,
+            {func = 'not_deterministic'})
+        box.schema.func.drop('not_deterministic')
+    end)
+end
+
+-- Checks that the upgrade converts all tuples and completes.
+g.test_upgrade = function()
+    t.tarantool.skip_if_enterprise()
+    create_space(2500)
+    g.server:exec(function(new_format)
+        local s = box.space.test
+        s:upgrade({func = 'upgrade', arg = 'v', format = new_format})
+        t.assert_equals(s:upgrade(), nil)
+        t.assert_equals(box.space._space:get(s.id).flags.upgrade, nil)
+        t.assert_equals(s:format(), new_format)
+        t.assert_equals(s:len(), 2500)
+        for _, tuple in s:pairs() do
+            t.assert_equals(tuple, {tuple.a, tuple.a, 'v' .. tuple.a})
+        end
+        t.assert_error_msg_contains(
+            "Tuple field 3 (c) required by space format is missing",
+            s.insert, s, {3000, 3000})
+    end, {new_format})
+end
+
+-- Checks that the background upgrade rate may be limited.
+g.test_upgrade_rate = function()
+    t.tarantool.skip_if_enterprise()
+    create_space(2500)
+    g.server:exec(function(new_format)
+        local fiber = require('fiber')
+        local s = box.space.test
+        local start = fiber.clock()
+        s:upgrade({func = 'upgrade', format = new_format, rate = 5000,
+                   is_async = true})
+        local info = s:upgrade()
+        t.assert_equals(info.status, 'inprogress')
+        t.assert_equals(info.rate, 5000)
+        -- The fiber sleeps for 0.2 seconds after each batch of 1000.
+        fiber.sleep(0.1)
+        t.assert_lt(s:upgrade().processed, 2500)
+        t.helpers.retrying({}, function()
+            t.assert_equals(s:upgrade(), nil)
+        end)
+        t.assert_ge(fiber.clock() - start, 0.4)
+        for _, tuple in s:pairs() do
+            t.assert_equals(tuple, {tuple.a, tuple.a, tostring(tuple.a)})
+        end
+    end, {new_format})
+end
+
+-- Starts an upgrade of the test space owned by another instance so that
+-- tuples aren't upgraded in the background.
+local function start_foreign_upgrade(new_format)
+    g.server:exec(function(new_format)
+        local s = box.space.test
+        box.space._space:update(s.id, {
+            {'=', 'flags.upgrade', {
+                func = box.func.upgrade.id,
+                owner = '11111111-1111-1111-1111-111111111111',
+            }},
+            {'=', 'format', new_format},
+        })
+    end, {new_format})
+end
+
+-- Checks that tuples are converted on access while the upgrade is
+-- in progress.
+g.test_lazy_upgrade = function()
+    t.tarantool.skip_if_enterprise()
+    create_space(10)
+    start_foreign_upgrade(new_format)
+    g.server:exec(function(new_format)
+        local ffi = require('ffi')
+        local s = box.space.test
+        local info = s:upgrade()
+        t.assert_equals(info.status, 'inprogress')
+        -- Reads call the upgrade function so FFI must not be used.
+        t.assert(ffi.C.box_read_ffi_is_disabled)
+        t.assert_equals(info.func, 'upgrade')
+        t.assert_equals(info.owner, '11111111-1111-1111-1111-111111111111')
+        t.assert_equals(s:get(1), {1, 1, '1'})
+        t.assert_equals(s:get(1).c, '1')
+        t.assert_equals(s.index.sk:select({2}), {{2, 2, '2'}})
+        t.assert_equals(s:delete(3), {3, 3, '3'})
+        t.assert_equals(s:update(4, {{'=', 3, 'y'}}), {4, 4, 'y'})
+        t.assert_equals(s:replace({5, 5, 'z'}), {5, 5, 'z'})
+        t.assert_error_msg_contains(
+            "Tuple field 3 (c) required by space format is missing",
+            s.replace, s, {6, 6})
+        t.assert_error_msg_equals(
+            "Can't modify space 'test': space upgrade is in progress",
+            s.upgrade, s, {func = 'upgrade', format = new_format})
+        t.assert_error_msg_equals(
+            "Can't modify space 'test': space upgrade is in progress",
+            s.rename, s, 'test2')
+        -- The upgrade can't complete until all tuples are upgraded.
+        local complete = {{'#', 'flags.upgrade', 1}}
+        t.assert_error_msg_contains(
+            "Tuple field 3 (c) required by space format is missing",
+            box.space._space.update, box.space._space, s.id, complete)
+        for _, tuple in s:pairs() do
+            s:replace(tuple)
+        end
+        box.space._space:update(s.id, complete)
+        t.assert_equals(s:upgrade(), nil)
+        t.assert_not(ffi.C.box_read_ffi_is_disabled)
+        t.assert_equals(s:select(), {
+            {1, 1, '1'}, {2, 2, '2'}, {4, 4, 'y'}, {5, 5, 'z'},
+            {6, 6, '6'}, {7, 7, '7'}, {8, 8, '8'}, {9, 9, '9'},
+            {10, 10, '10'},
+        })
+    end, {new_format})
+end
+
+-- Checks that a failed upgrade may be restarted.
+g.test_upgrade_error = function()
+    t.tarantool.skip_if_enterprise()
+    create_space(10)
+    g.server:exec(function(new_format)
+        local s = box.space.test
+        t.assert_error_msg_contains(
+            "upgrade error", s.upgrade, s,
+            {func = 'upgrade_bad', format = new_format})
+        local info = s:upgrade()
+        t.assert_equals(info.status, 'error')
+        t.assert_str_contains(info.error.message, 'upgrade error')
+        t.assert_error_msg_contains("upgrade error", s.get, s, 5)
+        s:upgrade({func = 'upgrade', format = new_format})
+        t.assert_equals(s:upgrade(), nil)
+        t.assert_equals(s:get(5), {5, 5, '5'})
+    end, {new_format})
+end
+
+-- Checks that the upgrade function can't change indexed fields.
+g.test_indexed_field = function()
+    t.tarantool.skip_if_enterprise()
+    create_space(1)
+    g.server:exec(function(new_format)
+        local s = box.space.test
+        local ok, err = pcall(s.upgrade, s, {
+            func = 'upgrade_pk', format = new_format,
+        })
+        t.assert_not(ok)
+        t.assert_covers(err:unpack(), {
+            type = 'ClientError',
+            name = 'CANT_UPGRADE_INDEXED_FIELD',
+            message = "Space upgrade doesn't support changing " ..
+                      "indexed fields",
+            space = 'test',
+            space_id = s.id,
+            index = 'pk',
+            old_tuple = {1, 1},
+            new_tuple = {1001, 1, 'x'},
+        })
+    end, {new_format})
+end
+
+-- Checks that tuples recovered after restart are upgraded again.
+g.test_restart = function()
+    t.tarantool.skip_if_enterprise()
+    create_space(10)
+    start_foreign_upgrade(new_format)
+    g.server:exec(function()
+        local s = box.space.test
+        s:replace({1, 1, 'a'})
+        box.snapshot()
+        s:replace({2, 2, 'b'})
+    end)
+    g.server:restart()
     g.server:exec(function()
-        local errmsg = "Community edition does not support space upgrade"
-        t.assert_error_msg_equals(errmsg, box.space.memtx.upgrade,
-                                  box.space.memtx, {})
-        t.assert_error_msg_equals(errmsg, box.space.vinyl.upgrade,
-                                  box.space.vinyl, {})
-        t.assert_error_msg_equals(errmsg, box.space._vspace.upgrade,
-                                  box.space._vspace, {})
+        local s = box.space.test
+        t.assert_equals(s:upgrade().status, 'inprogress')
+        t.assert_equals(s:get(1), {1, 1, 'a'})
+        t.assert_equals(s:get(2), {2, 2, 'b'})
+        t.assert_equals(s:get(3), {3, 3, '3'})
+        for _, tuple in s:pairs() do
+            s:replace(tuple)
+        end
+        box.space._space:update(s.id, {{'#', 'flags.upgrade', 1}})
+        t.assert_equals(s:upgrade(), nil)
+        t.assert_equals(s:get(1), {1, 1, 'a'})
+        t.assert_equals(s:get(10), {10, 10, '10'})
     end)
 end
@@ -0,0 +1,73 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {wal_compression_threads = 2}})
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('primary')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_not_dynamic = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_contains(
+            "Can't set option 'wal_compression_threads' dynamically",
+            box.cfg, {wal_compression_threads = 1})
+        t.assert_equals(box.cfg.wal_compression_threads, 2)
+    end)
+end
+
+g.test_compression = function(cg)
+    cg.server:exec(function()
+        box.stat.reset()
+        box.space.test:replace({1, string.rep('x', 1024 * 1024)})
+        local stat = box.stat.wal()
+        t.assert_equals(stat.rows, 1)
+        t.assert_lt(stat.bytes, 1024 * 1024 / 10)
+    end)
+end
+
+g.test_concurrent_writes = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        local fibers = {}
+        for i = 1, 100 do
+            local f = fiber.new(function()
+                for j = 1, 10 do
+                    local id = i * 100 + j
+                    -- Mix rows that fit in a block with rows that
+                    -- overflow it to get blocks of all kinds.
+                    local size = j % 3 == 0 and 200 * 1024 or 100
+                    s:replace({id, string.rep(tostring(j), size)})
+                end
+            end)
+            f:set_joinable(true)
+            table.insert(fibers, f)
+        end
+        for _, f in ipairs(fibers) do
+            t.assert((f:join()))
+        end
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        for i = 1, 100 do
+            for j = 1, 10 do
+                local tuple = s:get(i * 100 + j)
+                t.assert_not_equals(tuple, nil)
+                local size = j % 3 == 0 and 200 * 1024 or 100
+                t.assert_equals(tuple[2], string.rep(tostring(j), size))
+            end
+        end
+        t.assert_equals(#s:get(1)[2], 1024 * 1024)
+    end)
+end
@@ -0,0 +1,85 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.schema.create_space('test')
+        box.space.test:create_index('primary')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_wal_stat = function(cg)
+    cg.server:exec(function()
+        box.stat.reset()
+        local stat = box.stat.wal()
+        t.assert_equals(stat.batches, 0)
+        t.assert_equals(stat.rows, 0)
+        t.assert_equals(stat.bytes, 0)
+        t.assert_equals(stat.queue, {batches = 0, rows = 0, bytes = 0})
+        for _, name in ipairs({'queue', 'write', 'commit'}) do
+            t.assert_equals(stat.latency[name], {p50 = 0, p90 = 0, p99 = 0})
+        end
+
+        box.space.test:insert({1})
+        box.begin()
+        box.space.test:insert({2})
+        box.space.test:insert({3})
+        box.commit()
+        stat = box.stat.wal()
+        t.assert_equals(stat.batches, 2)
+        t.assert_equals(stat.rows, 3)
+        t.assert_gt(stat.bytes, 0)
+        t.assert_equals(stat.queue, {batches = 0, rows = 0, bytes = 0})
+        for _, name in ipairs({'queue', 'write', 'commit'}) do
+            t.assert_ge(stat.latency[name].p99, stat.latency[name].p50)
+        end
+        t.assert_ge(stat.latency.commit.p99, stat.latency.write.p99)
+
+        -- Transactions committed concurrently are written in one batch.
+        local fiber = require('fiber')
+        box.stat.reset()
+        local fibers = {}
+        for i = 1, 10 do
+            fibers[i] = fiber.new(function()
+                box.space.test:replace({i})
+            end)
+            fibers[i]:set_joinable(true)
+        end
+        for i = 1, 10 do
+            fibers[i]:join()
+        end
+        stat = box.stat.wal()
+        t.assert_equals(stat.rows, 10)
+        t.assert_lt(stat.batches, 10)
+    end)
+end
+
+g.test_wal_stat_queue = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        box.error.injection.set('ERRINJ_WAL_DELAY', true)
+        local f = fiber.new(function()
+            box.space.test:replace({100})
+        end)
+        f:set_joinable(true)
+        t.helpers.retrying({}, function()
+            local stat = box.stat.wal()
+            t.assert_equals(stat.queue.batches, 1)
+            t.assert_equals(stat.queue.rows, 1)
+            t.assert_gt(stat.queue.bytes, 0)
+        end)
+        box.error.injection.set('ERRINJ_WAL_DELAY', false)
+        f:join()
+        t.assert_equals(box.stat.wal().queue,
+                        {batches = 0, rows = 0, bytes = 0})
+    end)
+end
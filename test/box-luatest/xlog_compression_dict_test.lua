@@ -0,0 +1,111 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+-- Defines helper functions on the server. Should be called after
+-- each server restart.
+local function define_helpers(cg)
+    cg.server:exec(function()
+        -- Returns true if the header of the last file matching
+        -- the given pattern has a compression dictionary.
+        rawset(_G, 'last_file_has_dict', function(dir, pattern)
+            local fio = require('fio')
+            local files = fio.glob(fio.pathjoin(dir, pattern))
+            table.sort(files)
+            local f = fio.open(files[#files], {'O_RDONLY'})
+            local data = f:read(16 * 1024)
+            f:close()
+            local header = data:sub(1, data:find('\n\n', 1, true))
+            return header:find('\nDictionary: ', 1, true) ~= nil
+        end)
+        -- Fills the test space with small similar tuples.
+        rawset(_G, 'fill', function(first, count)
+            for i = first, first + count - 1 do
+                box.space.test:replace({i, 'name' .. i,
+                                        'email' .. i .. '@x.com',
+                                        i % 100, string.rep('payload', 8)})
+            end
+        end)
+        rawset(_G, 'check', function(first, count)
+            for i = first, first + count - 1 do
+                t.assert_equals(box.space.test:get(i)[2], 'name' .. i)
+            end
+        end)
+    end)
+end
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('primary')
+    end)
+    define_helpers(cg)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.cfg{wal_compression_dict = false, snap_compression_dict = false}
+        box.space.test:truncate()
+    end)
+end)
+
+g.test_wal_compression_dict = function(cg)
+    cg.server:exec(function()
+        box.cfg{wal_compression_dict = true}
+        -- The dictionary is trained on rows written to the previous
+        -- WAL file and used starting from the next one.
+        box.snapshot()
+        _G.fill(1, 2000)
+        box.snapshot()
+        _G.fill(2001, 100)
+        t.assert(_G.last_file_has_dict(box.cfg.wal_dir, '*.xlog'))
+        _G.fill(2101, 100)
+        box.cfg{wal_compression_dict = false}
+        box.snapshot()
+        _G.fill(2201, 100)
+        t.assert_not(_G.last_file_has_dict(box.cfg.wal_dir, '*.xlog'))
+    end)
+    cg.server:restart()
+    define_helpers(cg)
+    cg.server:exec(function()
+        _G.check(1, 2300)
+    end)
+end
+
+g.test_wal_compression_dict_recovery = function(cg)
+    cg.server:exec(function()
+        box.cfg{wal_compression_dict = true}
+        box.snapshot()
+        _G.fill(1, 2000)
+        box.snapshot()
+        -- Rows written with the dictionary are only in the WAL.
+        _G.fill(2001, 2000)
+        t.assert(_G.last_file_has_dict(box.cfg.wal_dir, '*.xlog'))
+    end)
+    cg.server:restart()
+    define_helpers(cg)
+    cg.server:exec(function()
+        _G.check(1, 4000)
+    end)
+end
+
+g.test_snap_compression_dict = function(cg)
+    cg.server:exec(function()
+        box.cfg{snap_compression_dict = true}
+        _G.fill(1, 2000)
+        box.snapshot()
+        t.assert(_G.last_file_has_dict(box.cfg.memtx_dir, '*.snap'))
+    end)
+    cg.server:restart()
+    define_helpers(cg)
+    cg.server:exec(function()
+        _G.check(1, 2000)
+    end)
+end
@@ -0,0 +1,72 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('primary')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.cfg{wal_compression_level = 3, snap_compression_level = 3,
+                vinyl_log_compression_level = 3}
+    end)
+end)
+
+g.test_invalid = function(cg)
+    cg.server:exec(function()
+        for _, name in ipairs({'wal_compression_level',
+                               'snap_compression_level',
+                               'vinyl_log_compression_level'}) do
+            for _, value in ipairs({-1, 23}) do
+                t.assert_error_msg_contains(
+                    "Incorrect value for option '" .. name .. "'",
+                    box.cfg, {[name] = value})
+            end
+            t.assert_equals(box.cfg[name], 3)
+        end
+    end)
+end
+
+g.test_wal_compression_level = function(cg)
+    cg.server:exec(function()
+        local function written(level)
+            box.cfg{wal_compression_level = level}
+            box.stat.reset()
+            box.space.test:replace({1, string.rep('x', 64 * 1024)})
+            return box.stat.wal().bytes
+        end
+        local plain = written(0)
+        t.assert_gt(plain, 64 * 1024)
+        local compressed = written(3)
+        t.assert_lt(compressed, plain / 10)
+        t.assert_le(written(19), compressed)
+    end)
+end
+
+g.test_snap_compression_level = function(cg)
+    local function snap_size(level)
+        return cg.server:exec(function(level)
+            local fio = require('fio')
+            box.cfg{snap_compression_level = level}
+            box.space.test:replace({1, string.rep('x', 1024 * 1024)})
+            box.snapshot()
+            local files = fio.glob(fio.pathjoin(box.cfg.memtx_dir, '*.snap'))
+            table.sort(files)
+            return fio.stat(files[#files]).size
+        end, {level})
+    end
+    local plain = snap_size(0)
+    t.assert_gt(plain, 1024 * 1024)
+    t.assert_lt(snap_size(3), plain / 10)
+end
@@ -6,7 +6,7 @@ local socket = require('socket')
 local fio = require('fio')
 local uuid = require('uuid')
 local msgpack = require('msgpack')
-test:plan(113)
+test:plan(125)
 
 --------------------------------------------------------------------------------
 -- Invalid values
@@ -34,6 +34,8 @@ invalid('replication_sync_timeout', -1)
 invalid('replication_connect_timeout', -1)
 invalid('replication_connect_timeout', 0)
 invalid('replication_connect_quorum', -1)
+invalid('replication_apply_concurrency', 0)
+invalid('replication_apply_concurrency', 1001)
 invalid('wal_mode', 'invalid')
 invalid('listen', '//!')
 invalid('log', ':')
@@ -49,6 +51,16 @@ invalid('vinyl_run_size_ratio', 1)
 invalid('vinyl_bloom_fpr', 0)
 invalid('vinyl_bloom_fpr', 1.1)
 invalid('wal_queue_max_size', -1)
+invalid('wal_tail_size', -1)
+invalid('wal_compression_level', -1)
+invalid('wal_compression_level', 23)
+invalid('wal_compression_threads', -1)
+invalid('wal_compression_threads', 65)
+invalid('snap_compression_level', -1)
+invalid('snap_compression_level', 23)
+invalid('snap_delta_max', -1)
+invalid('vinyl_log_compression_level', -1)
+invalid('vinyl_log_compression_level', 23)
 invalid('memtx_sort_threads', 'all')
 invalid('memtx_sort_threads', -1)
 invalid('memtx_sort_threads', 0)
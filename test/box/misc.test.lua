@@ -75,6 +75,7 @@ t = {};
 for k, v in pairs(box.slab.info()) do
     table.insert(t, k)
 end;
+table.sort(t);
 t;
 is_asan or box.runtime.info().used > 0;
 box.runtime.info().maxalloc > 0;
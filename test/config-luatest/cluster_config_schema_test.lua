@@ -258,7 +258,10 @@ g.test_defaults = function()
                 wal_size = 1000000000000000000,
             },
             count = 2,
+            compression_level = 3,
+            compression_dict = false,
             snap_io_rate_limit = box.NULL,
+            delta_max = 0,
         },
         iproto = {
             advertise = {
@@ -266,6 +269,7 @@ g.test_defaults = function()
             },
             threads = 1,
             net_msg_max = 768,
+            read_view_period = 0,
             readahead = 16320,
         },
         process = {
@@ -287,7 +291,11 @@ g.test_defaults = function()
             run_size_ratio = 3.5,
             read_threads = 1,
             write_threads = 4,
+            max_subcompactions = 1,
             cache = 134217728,
+            log_compression_level = 3,
+            page_cache = 0,
+            readahead = 0,
             defer_deletes = false,
             memory = 134217728,
             timeout = 60,
@@ -316,6 +324,7 @@ g.test_defaults = function()
             sync_lag = 10,
             synchro_quorum = 'N / 2 + 1',
             skip_conflict = false,
+            apply_concurrency = 1,
             election_mode = box.NULL,
             election_timeout = 5,
             election_fencing_mode = 'soft',
@@ -330,6 +339,10 @@ g.test_defaults = function()
             max_size = 268435456,
             dir_rescan_delay = 2,
             queue_max_size = 16777216,
+            tail_size = 16777216,
+            compression_level = 3,
+            compression_dict = false,
+            compression_threads = 0,
             retention_period = is_enterprise and 0 or nil,
         },
         console = {
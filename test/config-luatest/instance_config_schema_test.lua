@@ -446,6 +446,7 @@ g.test_iproto = function()
             },
             threads = 1,
             net_msg_max = 1,
+            read_view_period = 1,
             readahead = 1,
         },
     }
@@ -458,6 +459,7 @@ g.test_iproto = function()
         },
         threads = 1,
         net_msg_max = 768,
+        read_view_period = 0,
         readahead = 16320,
     }
     local res = instance_config:apply_default({}).iproto
@@ -513,6 +515,7 @@ g.test_iproto_enterprise = function()
             },
             threads = 1,
             net_msg_max = 1,
+            read_view_period = 1,
             readahead = 1,
         },
     }
@@ -525,6 +528,7 @@ g.test_iproto_enterprise = function()
         },
         threads = 1,
         net_msg_max = 768,
+        read_view_period = 0,
         readahead = 16320,
     }
     local res = instance_config:apply_default({}).iproto
@@ -1016,7 +1020,11 @@ g.test_vinyl = function()
             run_size_ratio = 1.15,
             read_threads = 7,
             write_threads = 9,
+            max_subcompactions = 3,
             cache = 10,
+            log_compression_level = 1,
+            page_cache = 12,
+            readahead = 16,
             defer_deletes = true,
             memory = 11,
             timeout = 5.5,
@@ -1035,7 +1043,11 @@ g.test_vinyl = function()
         run_size_ratio = 3.5,
         read_threads = 1,
         write_threads = 4,
+        max_subcompactions = 1,
         cache = 134217728,
+        log_compression_level = 3,
+        page_cache = 0,
+        readahead = 0,
         defer_deletes = false,
         memory = 134217728,
         timeout = 60,
@@ -1053,6 +1065,10 @@ g.test_wal = function()
             max_size = 1,
             dir_rescan_delay = 1,
             queue_max_size = 1,
+            tail_size = 1,
+            compression_level = 1,
+            compression_dict = true,
+            compression_threads = 1,
             cleanup_delay = 1,
         },
     }
@@ -1065,6 +1081,10 @@ g.test_wal = function()
         max_size = 268435456,
         dir_rescan_delay = 2,
         queue_max_size = 16777216,
+        tail_size = 16777216,
+        compression_level = 3,
+        compression_dict = false,
+        compression_threads = 0,
     }
     local res = instance_config:apply_default({}).wal
     t.assert_equals(res, exp)
@@ -1079,6 +1099,10 @@ g.test_wal_enterprise = function()
             max_size = 1,
             dir_rescan_delay = 1,
             queue_max_size = 1,
+            tail_size = 1,
+            compression_level = 1,
+            compression_dict = true,
+            compression_threads = 1,
             cleanup_delay = 1,
             retention_period = 1,
             ext = {
@@ -1102,6 +1126,10 @@ g.test_wal_enterprise = function()
         max_size = 268435456,
         dir_rescan_delay = 2,
         queue_max_size = 16777216,
+        tail_size = 16777216,
+        compression_level = 3,
+        compression_dict = false,
+        compression_threads = 0,
         retention_period = 0,
     }
     local res = instance_config:apply_default({}).wal
@@ -1117,7 +1145,10 @@ g.test_snapshot = function()
                 wal_size = 1,
             },
             count = 1,
+            compression_level = 1,
+            compression_dict = true,
             snap_io_rate_limit = 1,
+            delta_max = 1,
         },
     }
     instance_config:validate(iconfig)
@@ -1130,7 +1161,10 @@ g.test_snapshot = function()
             wal_size = 1000000000000000000,
         },
         count = 2,
+        compression_level = 3,
+        compression_dict = false,
         snap_io_rate_limit = box.NULL,
+        delta_max = 0,
     }
     local res = instance_config:apply_default({}).snapshot
     t.assert_equals(res, exp)
@@ -1153,6 +1187,7 @@ g.test_replication = function()
             sync_lag = 1,
             synchro_quorum = 1,
             skip_conflict = true,
+            apply_concurrency = 1,
             election_mode = 'off',
             election_timeout = 1,
             election_fencing_mode = 'off',
@@ -1182,6 +1217,7 @@ g.test_replication = function()
         sync_lag = 10,
         synchro_quorum = 'N / 2 + 1',
         skip_conflict = false,
+        apply_concurrency = 1,
         election_mode = box.NULL,
         election_timeout = 5,
         election_fencing_mode = 'soft',
@@ -66,6 +66,9 @@ g.test_json_schema_section_from_config = function()
         additionalProperties = false,
         properties = {
             cleanup_delay = {type = 'number'},
+            compression_dict = {default = false, type = 'boolean'},
+            compression_level = {default = 3, type = 'integer'},
+            compression_threads = {default = 0, type = 'integer'},
             dir = {default = 'var/lib/{{ instance_name }}', type = 'string'},
             dir_rescan_delay = {default = 2, type = 'number'},
             ext = {
@@ -96,6 +99,7 @@ g.test_json_schema_section_from_config = function()
             },
             queue_max_size = {default = 16777216, type = 'integer'},
             retention_period = {default = 0, type = 'number'},
+            tail_size = {default = 16777216, type = 'integer'},
         },
         type = 'object',
     }
@@ -0,0 +1,175 @@
+local t = require('luatest')
+local server = require('luatest.server')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group('applier_parallel', t.helpers.matrix({
+    engine = {'memtx', 'vinyl'},
+}))
+
+g.before_each(function(cg)
+    cg.replica_set = replica_set:new{}
+    cg.master = cg.replica_set:build_and_add_server{
+        alias = 'master',
+        box_cfg = {
+            replication_timeout = 0.1,
+        },
+    }
+    cg.replica = cg.replica_set:build_and_add_server{
+        alias = 'replica',
+        box_cfg = {
+            replication = {
+                server.build_listen_uri('master', cg.replica_set.id),
+            },
+            replication_timeout = 0.1,
+            replication_apply_concurrency = 8,
+        },
+    }
+    cg.replica_set:start()
+    cg.master:exec(function(engine)
+        for _, name in ipairs({'a', 'b'}) do
+            local s = box.schema.space.create(name, {engine = engine})
+            s:create_index('pk')
+            s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        end
+    end, {cg.params.engine})
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_each(function(cg)
+    cg.replica_set:drop()
+end)
+
+local function apply_stat(cg)
+    return cg.replica:exec(function(id)
+        return box.info.replication[id].upstream.apply
+    end, {cg.master:get_instance_id()})
+end
+
+-- Writes to the given space from many fibers so that the replica receives
+-- transactions in batches.
+local function load(cg, space, count)
+    cg.master:exec(function(space, count)
+        local fiber = require('fiber')
+        local fibers = {}
+        for i = 1, 10 do
+            local f = fiber.new(function()
+                for j = 1, count do
+                    local s = box.space[space]
+                    box.begin()
+                    s:replace({j * 10 + i, i})
+                    s:update({j % 10 + 1}, {{'=', 2, i}})
+                    box.commit()
+                end
+            end)
+            f:set_joinable(true)
+            table.insert(fibers, f)
+        end
+        for _, f in ipairs(fibers) do
+            f:join()
+        end
+    end, {space, count})
+end
+
+local function check_data(cg)
+    cg.replica:wait_for_vclock_of(cg.master)
+    local data = cg.master:exec(function()
+        return {box.space.a:select(), box.space.b:select()}
+    end)
+    cg.replica:exec(function(data)
+        t.assert_equals({box.space.a:select(), box.space.b:select()}, data)
+    end, {data})
+end
+
+g.test_apply = function(cg)
+    cg.master:exec(function()
+        for i = 1, 10 do
+            box.space.a:insert({i, 0})
+            box.space.b:insert({i, 0})
+        end
+    end)
+    check_data(cg)
+    local stat = apply_stat(cg)
+    load(cg, 'a', 50)
+    load(cg, 'b', 50)
+    check_data(cg)
+    local new_stat = apply_stat(cg)
+    t.assert_equals(new_stat.txs - stat.txs, 1000)
+    t.assert_gt(new_stat.parallel, stat.parallel)
+    t.assert_le(new_stat.conflicts, new_stat.parallel)
+    t.assert_le(new_stat.conflict_ratio, 1)
+
+    -- Transactions touching system spaces are applied serially.
+    stat = new_stat
+    cg.master:exec(function()
+        box.schema.space.create('c'):create_index('pk')
+        box.space.c:insert({1})
+    end)
+    check_data(cg)
+    new_stat = apply_stat(cg)
+    t.assert_gt(new_stat.txs, stat.txs)
+end
+
+-- Checks that transactions on a space with triggers are applied serially.
+g.test_triggers = function(cg)
+    cg.replica:exec(function()
+        rawset(_G, 'replaced', {})
+        box.space.a:on_replace(function(_, new)
+            table.insert(_G.replaced, new[1])
+        end)
+    end)
+    local stat = apply_stat(cg)
+    cg.master:exec(function()
+        for i = 1, 10 do
+            box.space.a:insert({i, i})
+        end
+    end)
+    check_data(cg)
+    local new_stat = apply_stat(cg)
+    t.assert_equals(new_stat.txs - stat.txs, 10)
+    t.assert_equals(new_stat.parallel, stat.parallel)
+    cg.replica:exec(function()
+        t.assert_equals(_G.replaced, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10})
+    end)
+end
+
+-- Checks that an apply error stops the applier and that the transactions
+-- following the failed one aren't applied.
+g.test_error = function(cg)
+    cg.replica:exec(function()
+        box.space.b:insert({5, 5})
+    end)
+    cg.master:exec(function()
+        box.begin()
+        for i = 1, 10 do
+            box.space.a:insert({i, i})
+        end
+        box.commit()
+        box.begin()
+        for i = 1, 10 do
+            box.space.b:insert({i, i})
+        end
+        box.commit()
+        box.space.a:insert({11, 11})
+    end)
+    cg.replica:exec(function(id)
+        t.helpers.retrying({}, function()
+            local upstream = box.info.replication[id].upstream
+            t.assert_equals(upstream.status, 'stopped')
+            t.assert_str_contains(upstream.message, 'Duplicate key exists')
+        end)
+        t.assert_equals(box.space.a:count(), 10)
+        t.assert_equals(box.space.b:select(), {{5, 5}})
+    end, {cg.master:get_instance_id()})
+end
+
+g.test_cfg = function(cg)
+    cg.replica:exec(function()
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'replication_apply_concurrency': " ..
+            "must be greater than 0, less than or equal to 1000",
+            box.cfg, {replication_apply_concurrency = 0})
+        t.assert_equals(box.cfg.replication_apply_concurrency, 8)
+        box.cfg{replication_apply_concurrency = 1}
+        t.assert_equals(box.cfg.replication_apply_concurrency, 1)
+    end)
+end
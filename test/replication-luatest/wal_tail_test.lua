@@ -0,0 +1,124 @@
+local t = require('luatest')
+local server = require('luatest.server')
+local replica_set = require('luatest.replica_set')
+
+local g = t.group()
+
+g.before_each(function(cg)
+    cg.replica_set = replica_set:new{}
+    cg.master = cg.replica_set:build_and_add_server{
+        alias = 'master',
+        box_cfg = {
+            replication_timeout = 0.1,
+            -- Make the WAL rotate often.
+            wal_max_size = 4096,
+        },
+    }
+    cg.replica = cg.replica_set:build_and_add_server{
+        alias = 'replica',
+        box_cfg = {
+            replication = {
+                server.build_listen_uri('master', cg.replica_set.id),
+            },
+            replication_timeout = 0.1,
+        },
+    }
+    cg.replica_set:start()
+    cg.master:exec(function()
+        box.schema.space.create('test')
+        box.space.test:create_index('pk')
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_each(function(cg)
+    cg.replica_set:drop()
+end)
+
+local function wal_tail_stat(cg)
+    return cg.master:exec(function(id)
+        return box.info.replication[id].downstream.wal_tail
+    end, {cg.replica:get_instance_id()})
+end
+
+local function insert(cg, first, last, size)
+    cg.master:exec(function(first, last, size)
+        for i = first, last do
+            box.space.test:insert({i, string.rep('x', size)})
+        end
+    end, {first, last, size})
+end
+
+local function check_data(cg, count)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function(count)
+        t.assert_equals(box.space.test:count(), count)
+        for i = 1, count do
+            t.assert_equals(box.space.test:get(i)[1], i)
+        end
+    end, {count})
+end
+
+-- Checks that a relay following the WAL reads rows from memory and that
+-- it keeps reading from memory after the WAL is rotated.
+g.test_hits = function(cg)
+    t.assert_equals(wal_tail_stat(cg).size, 16 * 1024 * 1024)
+    local stat = wal_tail_stat(cg)
+    insert(cg, 1, 100, 100)
+    check_data(cg, 100)
+    local new_stat = wal_tail_stat(cg)
+    t.assert_gt(new_stat.hits, stat.hits)
+    -- The WAL is rotated every few rows so there's a disk read per
+    -- rotation at most.
+    t.assert_lt(new_stat.misses - stat.misses, 10)
+end
+
+-- Checks that a relay falls back to WAL files if the rows it needs
+-- aren't in memory.
+g.test_misses = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.master:exec(function()
+        box.cfg{wal_tail_size = 0}
+    end)
+    t.assert_equals(wal_tail_stat(cg).size, 0)
+    local stat = wal_tail_stat(cg)
+    insert(cg, 1, 10, 100)
+    check_data(cg, 10)
+    local new_stat = wal_tail_stat(cg)
+    t.assert_equals(new_stat.hits, stat.hits)
+    t.assert_gt(new_stat.misses, stat.misses)
+
+    -- Rows that don't fit in the buffer.
+    cg.master:exec(function()
+        box.cfg{wal_tail_size = 1024}
+    end)
+    insert(cg, 11, 20, 2000)
+    check_data(cg, 20)
+
+    -- The relay lags behind the buffer.
+    cg.master:exec(function()
+        box.cfg{wal_tail_size = 64 * 1024}
+        box.error.injection.set('ERRINJ_RELAY_SEND_DELAY', true)
+    end)
+    insert(cg, 21, 1000, 100)
+    cg.master:exec(function()
+        box.error.injection.set('ERRINJ_RELAY_SEND_DELAY', false)
+    end)
+    check_data(cg, 1000)
+
+    -- The relay catches up and reads from memory again.
+    stat = wal_tail_stat(cg)
+    insert(cg, 1001, 1010, 100)
+    check_data(cg, 1010)
+    t.assert_gt(wal_tail_stat(cg).hits, stat.hits)
+end
+
+g.test_cfg = function(cg)
+    cg.master:exec(function()
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'wal_tail_size': " ..
+            "the value must be >= 0",
+            box.cfg, {wal_tail_size = -1})
+        t.assert_equals(box.cfg.wal_tail_size, 16 * 1024 * 1024)
+    end)
+end
@@ -0,0 +1,126 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function()
+    g.server = server:new({alias = 'bloom_filter'})
+    g.server:start()
+end)
+
+g.after_all(function()
+    g.server:stop()
+end)
+
+g.after_each(function()
+    g.server:exec(function()
+        box.execute([[DROP TABLE IF EXISTS t1;]])
+        box.execute([[DROP TABLE IF EXISTS t2;]])
+    end)
+end)
+
+-- Make sure that a join on non-indexed columns checks the Bloom filter
+-- built along with the automatic index and returns correct results.
+g.test_bloom_filter_join = function()
+    g.server:exec(function()
+        box.execute([[CREATE TABLE t1(i INT PRIMARY KEY, a INT);]])
+        box.execute([[CREATE TABLE t2(i INT PRIMARY KEY, b INT);]])
+        for i = 1, 100 do
+            box.execute([[INSERT INTO t1 VALUES(?, ?);]], {i, i * 3})
+            box.execute([[INSERT INTO t2 VALUES(?, ?);]], {i, i * 5})
+        end
+        local sql = [[SELECT t1.i, t2.i FROM t1, t2 WHERE a = b
+                      ORDER BY t1.i;]]
+        local ops = {}
+        for _, row in pairs(box.execute('EXPLAIN ' .. sql).rows) do
+            ops[row[2]] = true
+        end
+        t.assert(ops['FilterInit'])
+        t.assert(ops['FilterAdd'])
+        t.assert(ops['Filter'])
+
+        local expected = {}
+        for i = 1, 100 do
+            if i * 3 % 5 == 0 and i * 3 / 5 <= 100 then
+                table.insert(expected, {i, i * 3 / 5})
+            end
+        end
+        t.assert_equals(box.execute(sql).rows, expected)
+
+        sql = [[SELECT t1.i, t2.i FROM t1 LEFT JOIN t2 ON a = b
+                WHERE t1.i <= 10 ORDER BY t1.i;]]
+        t.assert_equals(box.execute(sql).rows, {
+            {1, box.NULL}, {2, box.NULL}, {3, box.NULL}, {4, box.NULL},
+            {5, 3}, {6, box.NULL}, {7, box.NULL}, {8, box.NULL},
+            {9, box.NULL}, {10, 6},
+        })
+    end)
+end
+
+-- Make sure that equal numbers of different types pass the Bloom filter.
+g.test_bloom_filter_numbers = function()
+    g.server:exec(function()
+        box.execute([[CREATE TABLE t1(i INT PRIMARY KEY, a NUMBER);]])
+        box.execute([[CREATE TABLE t2(i INT PRIMARY KEY, b NUMBER);]])
+        box.execute([[INSERT INTO t1 VALUES(1, 1), (2, 2e0), (3, 3.5e0),
+                      (4, CAST(4 AS DECIMAL)), (5, 18446744073709551615),
+                      (6, -9223372036854775808), (7, 1e100);]])
+        box.execute([[INSERT INTO t2 VALUES(1, 1e0), (2, CAST(2 AS DECIMAL)),
+                      (3, CAST(3.5 AS DECIMAL)), (4, 4),
+                      (5, 18446744073709551615), (6, -9223372036854775808e0),
+                      (7, 1e100), (8, 0.5e0);]])
+        local sql = [[SELECT t1.i, t2.i FROM t1, t2 WHERE a = b
+                      ORDER BY t1.i;]]
+        t.assert_equals(box.execute(sql).rows, {
+            {1, 1}, {2, 2}, {3, 3}, {4, 4}, {5, 5}, {6, 6}, {7, 7},
+        })
+    end)
+end
+
+-- Make sure that strings equal according to a collation pass the Bloom
+-- filter.
+g.test_bloom_filter_collation = function()
+    g.server:exec(function()
+        box.execute([[CREATE TABLE t1(i INT PRIMARY KEY,
+                                      s STRING COLLATE "unicode_ci");]])
+        box.execute([[CREATE TABLE t2(i INT PRIMARY KEY,
+                                      s STRING COLLATE "unicode_ci");]])
+        box.execute([[INSERT INTO t1 VALUES(1, 'a'), (2, 'B'), (3, 'c');]])
+        box.execute([[INSERT INTO t2 VALUES(1, 'A'), (2, 'b'), (3, 'd');]])
+        local sql = [[SELECT t1.i, t2.i FROM t1, t2 WHERE t1.s = t2.s
+                      ORDER BY t1.i;]]
+        t.assert_equals(box.execute(sql).rows, {{1, 1}, {2, 2}})
+    end)
+end
+
+-- Make sure that strings compared byte-wise are filtered correctly.
+g.test_bloom_filter_strings = function()
+    g.server:exec(function()
+        box.execute([[CREATE TABLE t1(i INT PRIMARY KEY, s STRING);]])
+        box.execute([[CREATE TABLE t2(i INT PRIMARY KEY, s STRING);]])
+        for i = 1, 100 do
+            box.execute([[INSERT INTO t1 VALUES(?, ?);]], {i, 'k' .. i})
+            box.execute([[INSERT INTO t2 VALUES(?, ?);]], {i, 'k' .. i * 7})
+        end
+        local sql = [[SELECT t1.i, t2.i FROM t1, t2 WHERE t1.s = t2.s
+                      ORDER BY t1.i;]]
+        local expected = {}
+        for i = 1, 14 do
+            table.insert(expected, {i * 7, i})
+        end
+        t.assert_equals(box.execute(sql).rows, expected)
+    end)
+end
+
+-- Make sure that the Bloom filter works for spaces that can't tell
+-- the number of rows they contain.
+g.test_bloom_filter_view = function()
+    g.server:exec(function()
+        box.execute([[CREATE TABLE t1(i INT PRIMARY KEY, s STRING);]])
+        box.execute([[INSERT INTO t1 VALUES(1, 'T1'), (2, 'foo');]])
+        local sql = [[SELECT t1.i, "_vspace"."id" FROM t1, "_vspace"
+                      WHERE t1.s = "_vspace"."name";]]
+        local id = box.space.t1.id
+        t.assert_equals(box.execute(sql).rows, {{1, id}})
+    end)
+end
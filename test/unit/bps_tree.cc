@@ -923,6 +923,33 @@ insert_successor_test()
 	ok(true, "successor test");
 }
 
+static void
+find_many_test()
+{
+	test tree;
+	test_create(&tree, 0, &allocator, NULL);
+
+	const size_t count = 1000;
+	type_t keys[count];
+	type_t *result[count];
+	for (size_t i = 0; i < count; i++)
+		keys[i] = rand() % (2 * count);
+	test_find_many(&tree, keys, count, result);
+	for (size_t i = 0; i < count; i++)
+		fail_unless(result[i] == NULL);
+
+	for (type_t i = 0; i < (type_t)(2 * count); i += 2)
+		test_insert(&tree, i, NULL, NULL);
+	test_find_many(&tree, keys, count, result);
+	for (size_t i = 0; i < count; i++) {
+		fail_unless(result[i] == test_find(&tree, keys[i]));
+		fail_unless(result[i] == NULL || *result[i] == keys[i]);
+	}
+
+	test_destroy(&tree);
+	ok(true, "find many");
+}
+
 static void
 gh_11326_oom_on_insertion_test()
 {
@@ -960,7 +987,7 @@ gh_11326_oom_on_insertion_test()
 int
 main(void)
 {
-	plan(13);
+	plan(14);
 	header();
 
 	matras_allocator_create(&allocator, BPS_TREE_EXTENT_SIZE,
@@ -978,6 +1005,7 @@ main(void)
 	insert_get_iterator();
 	delete_value_check();
 	insert_successor_test();
+	find_many_test();
 
 	matras_allocator_destroy(&allocator);
 
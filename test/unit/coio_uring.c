@@ -0,0 +1,121 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "coio_file.h"
+#include "coio_task.h"
+#include "coio_uring.h"
+#include "fiber.h"
+#include "fio.h"
+#include "memory.h"
+
+#define UNIT_TAP_COMPATIBLE 1
+#include "unit.h"
+
+enum {
+	/** More than the number of io_uring request slots. */
+	FIBER_COUNT = 300,
+	BLOCK_SIZE = 512,
+};
+
+static char filename[] = "coio_uring.XXXXXX";
+
+static int
+write_read_f(va_list ap)
+{
+	int fd = va_arg(ap, int);
+	int i = va_arg(ap, int);
+	int *failed = va_arg(ap, int *);
+	char buf[BLOCK_SIZE];
+	char out[BLOCK_SIZE];
+	memset(buf, 'a' + i % 26, sizeof(buf));
+	off_t offset = (off_t)i * BLOCK_SIZE;
+	if (coio_pwrite(fd, buf, sizeof(buf), offset) != sizeof(buf) ||
+	    coio_pread(fd, out, sizeof(out), offset) != sizeof(out) ||
+	    memcmp(buf, out, sizeof(buf)) != 0)
+		++*failed;
+	return 0;
+}
+
+static void
+test_file_io(bool use_uring)
+{
+	plan(8);
+	coio_uring_enabled = use_uring;
+	note("io_uring is %s", coio_uring_is_enabled() ? "used" : "not used");
+
+	int fd = open(filename, O_RDWR | O_TRUNC);
+	fail_if(fd < 0);
+
+	char out[16] = {0};
+	is(coio_pwrite(fd, "hello, world", 12, 4), 12, "pwrite");
+	is(coio_pread(fd, out, sizeof(out), 4), 12, "pread");
+	is(strcmp(out, "hello, world"), 0, "pread data");
+	is(coio_fdatasync(fd), 0, "fdatasync");
+
+	struct iovec iov[] = {
+		{(void *)"HE", 2}, {NULL, 0}, {(void *)"LLO", 3},
+	};
+	ssize_t written = coio_uring_is_enabled() ?
+			  coio_uring_writevn(fd, iov, lengthof(iov)) :
+			  fio_writevn(fd, iov, lengthof(iov));
+	is(written, 5, "writevn");
+	ok(coio_pread(fd, out, sizeof(out), 0) == 16 &&
+	   memcmp(out, "HELLOello, world", 16) == 0, "writevn data");
+
+	int failed = 0;
+	struct fiber *fibers[FIBER_COUNT];
+	for (int i = 0; i < FIBER_COUNT; i++) {
+		fibers[i] = fiber_new("write_read", write_read_f);
+		fail_if(fibers[i] == NULL);
+		fiber_set_joinable(fibers[i], true);
+		fiber_start(fibers[i], fd, i, &failed);
+	}
+	for (int i = 0; i < FIBER_COUNT; i++)
+		fiber_join(fibers[i]);
+	is(failed, 0, "concurrent pwrite and pread");
+
+	close(fd);
+	ok(coio_pread(fd, out, sizeof(out), 0) < 0 && errno == EBADF,
+	   "pread from a closed file");
+
+	check_plan();
+}
+
+static int
+main_f(va_list ap)
+{
+	(void)ap;
+	test_file_io(true);
+	test_file_io(false);
+	ev_break(loop(), EVBREAK_ALL);
+	return 0;
+}
+
+int
+main(void)
+{
+	plan(2);
+	memory_init();
+	fiber_init(fiber_c_invoke);
+	coio_init();
+	coio_enable();
+	coio_uring_init();
+
+	int fd = mkstemp(filename);
+	fail_if(fd < 0);
+	close(fd);
+
+	struct fiber *f = fiber_new("main", main_f);
+	fiber_wakeup(f);
+	ev_run(loop(), 0);
+
+	unlink(filename);
+	coio_uring_free();
+	fiber_free();
+	memory_free();
+	return check_plan();
+}
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <string>
 #include <string.h>
 #include <assert.h>
 #include <msgpuck.h>
@@ -157,6 +158,60 @@ hash_test()
 	footer();
 }
 
+static void
+sort_key_append(const char *data, size_t size, void *arg)
+{
+	static_cast<string *>(arg)->append(data, size);
+}
+
+static string
+calc_sort_key(const char *str, struct coll *coll)
+{
+	string key;
+	uint32_t size = coll->sort_key(str, strlen(str), sort_key_append,
+				       &key, coll);
+	assert(size == key.size());
+	(void)size;
+	return key;
+}
+
+void
+sort_key_test()
+{
+	header();
+	plan(4);
+
+	struct coll_def def;
+	memset(&def, 0, sizeof(def));
+	snprintf(def.locale, sizeof(def.locale), "%s", "ru_RU");
+	def.type = COLL_TYPE_ICU;
+	def.icu.strength = COLL_ICU_STRENGTH_SECONDARY;
+	struct coll *coll = coll_new(&def);
+	assert(coll != NULL);
+	ok(calc_sort_key("ае", coll) == calc_sort_key("аЕ", coll),
+	   "equal strings have equal sort keys");
+	ok(calc_sort_key("ае", coll) != calc_sort_key("аё", coll),
+	   "different strings have different sort keys");
+	string key = calc_sort_key("аЕ", coll);
+	uint32_t h = HASH_SEED;
+	uint32_t carry = 0;
+	PMurHash32_Process(&h, &carry, key.data(), key.size());
+	ok(PMurHash32_Result(h, carry, key.size()) == calc_hash("аЕ", coll),
+	   "hash of the sort key is the collation hash");
+	coll_unref(coll);
+
+	memset(&def, 0, sizeof(def));
+	def.type = COLL_TYPE_BINARY;
+	coll = coll_new(&def);
+	assert(coll != NULL);
+	ok(calc_sort_key("aB", coll) == "aB",
+	   "binary sort key is the string itself");
+	coll_unref(coll);
+
+	check_plan();
+	footer();
+}
+
 void
 cache_test()
 {
@@ -192,6 +247,7 @@ main(int, const char**)
 	fiber_init(fiber_c_invoke);
 	manual_test();
 	hash_test();
+	sort_key_test();
 	cache_test();
 	fiber_free();
 	memory_free();
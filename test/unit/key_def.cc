@@ -1369,6 +1369,104 @@ test_tuple_compare_sequential_no_optional_parts_unique(bool ascending_key,
 	check_plan();
 }
 
+/**
+ * Checks the comparators specialized by key part types, which are used
+ * for non-sequential keys of unsigned, integer and string parts.
+ */
+static void
+test_tuple_compare_typed(bool is_nullable, bool has_optional_parts)
+{
+	/* has_optional_parts is only valid if is_nullable. */
+	fail_unless(!has_optional_parts || is_nullable);
+
+	struct key_def *pk_def = test_key_def_new(
+		"[{%s%u%s%s}]", "field", 0, "type", "unsigned");
+	struct key_def *key_def = test_key_def_new(
+		"[{%s%u%s%s%s%b}{%s%u%s%s%s%b}]",
+		"field", 2, "type", "integer", "is_nullable", is_nullable,
+		"field", 3, "type", "unsigned", "is_nullable",
+		has_optional_parts);
+	struct key_def *cmp_def = key_def_merge(key_def, pk_def);
+	fail_unless(cmp_def->part_count == 3);
+	fail_unless(!key_def_is_sequential(cmp_def));
+
+	key_def_update_optionality(cmp_def, has_optional_parts ? 0 : 4);
+	fail_unless(cmp_def->is_nullable == is_nullable);
+	fail_unless(cmp_def->has_optional_parts == has_optional_parts);
+
+	const char *funcname = (const char *)xstrdup(tt_sprintf(
+		"TypedTupleCompare<%s, key_def: %s optional parts>",
+		is_nullable ? "true" : "false",
+		has_optional_parts ? "with" : "without"));
+
+	std::vector<struct tuple *> tuples_eq;
+	std::vector<struct tuple *> tuples_gt;
+
+	test_generate_common_cases(tuples_eq, tuples_gt, cmp_def);
+
+	if (is_nullable) {
+		/* NILs are met, so the primary key part is compared. */
+		tuples_gt.push_back(test_tuple_new("[%u%uNIL%u]", 1, 0, 0));
+		tuples_gt.push_back(test_tuple_new("[%u%uNIL%u]", 0, 0, 0));
+	}
+
+	plan(tuples_eq.size() + tuples_gt.size());
+	header();
+
+	test_check_cases(tuples_eq, tuples_gt, cmp_def, funcname,
+			 test_check_tuple_compare);
+
+	test_delete_cases(tuples_eq, tuples_gt);
+	key_def_delete(key_def);
+	key_def_delete(pk_def);
+	key_def_delete(cmp_def);
+	free((void *)funcname);
+
+	footer();
+	check_plan();
+}
+
+static void
+test_tuple_compare_with_key_typed(bool is_nullable, bool has_optional_parts)
+{
+	/* has_optional_parts is only valid if is_nullable. */
+	fail_unless(!has_optional_parts || is_nullable);
+
+	struct key_def *key_def = test_key_def_new(
+		"[{%s%u%s%s%s%b}{%s%u%s%s%s%b}]",
+		"field", 2, "type", "integer", "is_nullable", is_nullable,
+		"field", 3, "type", "unsigned", "is_nullable",
+		has_optional_parts);
+	fail_unless(!key_def_is_sequential(key_def));
+
+	key_def_update_optionality(key_def, has_optional_parts ? 0 : 4);
+	fail_unless(key_def->is_nullable == is_nullable);
+	fail_unless(key_def->has_optional_parts == has_optional_parts);
+
+	const char *funcname = (const char *)xstrdup(tt_sprintf(
+		"TypedTupleCompareWithKey<%s, key_def: %s optional parts>",
+		is_nullable ? "true" : "false",
+		has_optional_parts ? "with" : "without"));
+
+	std::vector<struct tuple *> tuples_eq;
+	std::vector<struct tuple *> tuples_gt;
+
+	test_generate_common_cases(tuples_eq, tuples_gt, key_def);
+
+	plan(tuples_eq.size() + tuples_gt.size());
+	header();
+
+	test_check_cases(tuples_eq, tuples_gt, key_def, funcname,
+			 test_check_tuple_compare_with_key);
+
+	test_delete_cases(tuples_eq, tuples_gt);
+	key_def_delete(key_def);
+	free((void *)funcname);
+
+	footer();
+	check_plan();
+}
+
 static void
 test_key_def_find_by_fieldno(void)
 {
@@ -1400,7 +1498,7 @@ test_key_def_find_by_fieldno(void)
 static int
 test_main(void)
 {
-	plan(51);
+	plan(57);
 	header();
 
 	test_func_compare();
@@ -1453,6 +1551,12 @@ test_main(void)
 	test_key_compare_singlepart(true, false);
 	test_key_compare_singlepart(false, true);
 	test_key_compare_singlepart(false, false);
+	test_tuple_compare_typed(true, true);
+	test_tuple_compare_typed(true, false);
+	test_tuple_compare_typed(false, false);
+	test_tuple_compare_with_key_typed(true, true);
+	test_tuple_compare_with_key_typed(true, false);
+	test_tuple_compare_with_key_typed(false, false);
 	test_key_def_find_by_fieldno();
 
 	footer();
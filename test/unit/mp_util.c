@@ -0,0 +1,89 @@
+#include "core/mp_util.h"
+
+#include "msgpuck/msgpuck.h"
+#include "trivia/util.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define UNIT_TAP_COMPATIBLE 1
+#include "unit.h"
+
+/** Encode a random value, single-byte ones being the most frequent. */
+static char *
+encode_random_value(char *data)
+{
+	switch (rand() % 10) {
+	case 0:
+		return mp_encode_uint(data, rand());
+	case 1:
+		return mp_encode_int(data, -rand() % 100);
+	case 2:
+		return mp_encode_str0(data, "abc");
+	case 3:
+		return mp_encode_double(data, 1.5);
+	case 4:
+		return mp_encode_bool(data, rand() % 2 == 0);
+	case 5:
+	case 6:
+		return mp_encode_nil(data);
+	default:
+		return mp_encode_uint(data, rand() % 128);
+	}
+}
+
+static void
+test_mp_next_n(void)
+{
+	plan(1);
+	header();
+
+	enum { VALUE_COUNT = 1000 };
+	/*
+	 * The buffer is allocated exactly to check that mp_next_n()
+	 * doesn't read past the end of data under ASAN.
+	 */
+	char buf[VALUE_COUNT * 9];
+	char *end = buf;
+	for (int i = 0; i < VALUE_COUNT; i++)
+		end = encode_random_value(end);
+	size_t size = end - buf;
+	char *data = xmalloc(size);
+	memcpy(data, buf, size);
+
+	bool success = true;
+	for (uint32_t n = 0; n <= VALUE_COUNT; n++) {
+		const char *expected = data;
+		for (uint32_t i = 0; i < n; i++)
+			mp_next(&expected);
+		const char *actual = data;
+		mp_next_n(&actual, n);
+		if (actual != expected) {
+			success = false;
+			break;
+		}
+	}
+	ok(success, "mp_next_n skips the same data as mp_next");
+
+	free(data);
+
+	footer();
+	check_plan();
+}
+
+int
+main(void)
+{
+	plan(1);
+	header();
+
+	time_t seed = time(NULL);
+	srand(seed);
+	/* Print the seed to be able to reproduce a failure. */
+	note("random seed is %llu", (unsigned long long)seed);
+	test_mp_next_n();
+
+	footer();
+	return check_plan();
+}
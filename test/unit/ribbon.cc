@@ -0,0 +1,130 @@
+#include "salad/ribbon.h"
+#include "salad/bloom.h"
+#include <unordered_set>
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+uint32_t h(uint32_t i)
+{
+	return i * 2654435761;
+}
+
+void
+simple_test()
+{
+	cout << "*** " << __func__ << " ***" << endl;
+	srand(time(0));
+	uint32_t error_count = 0;
+	uint32_t fp_rate_too_big = 0;
+	for (double p = 0.001; p < 0.5; p *= 1.3) {
+		uint64_t tests = 0;
+		uint64_t false_positive = 0;
+		for (uint32_t count = 1000; count <= 10000; count *= 2) {
+			unordered_set<uint32_t> check;
+			vector<uint32_t> hashes;
+			for (uint32_t i = 0; i < count; i++) {
+				uint32_t val = rand() % (count * 10);
+				check.insert(val);
+				hashes.push_back(h(val));
+			}
+			struct ribbon ribbon;
+			ribbon_create(&ribbon, hashes.data(), count, p);
+			for (uint32_t i = 0; i < count * 10; i++) {
+				bool has = check.find(i) != check.end();
+				bool ribbon_possible =
+					ribbon_maybe_has(&ribbon, h(i));
+				tests++;
+				if (has && !ribbon_possible)
+					error_count++;
+				if (!has && ribbon_possible)
+					false_positive++;
+			}
+			ribbon_destroy(&ribbon);
+		}
+		double fp_rate = (double)false_positive / tests;
+		if (fp_rate > p + 0.001)
+			fp_rate_too_big++;
+	}
+	cout << "error_count = " << error_count << endl;
+	cout << "fp_rate_too_big = " << fp_rate_too_big << endl;
+}
+
+void
+store_load_test()
+{
+	cout << "*** " << __func__ << " ***" << endl;
+	srand(time(0));
+	uint32_t error_count = 0;
+	uint32_t fp_rate_too_big = 0;
+	for (double p = 0.01; p < 0.5; p *= 1.5) {
+		uint64_t tests = 0;
+		uint64_t false_positive = 0;
+		for (uint32_t count = 300; count <= 3000; count *= 10) {
+			unordered_set<uint32_t> check;
+			vector<uint32_t> hashes;
+			for (uint32_t i = 0; i < count; i++) {
+				uint32_t val = rand() % (count * 10);
+				check.insert(val);
+				hashes.push_back(h(val));
+			}
+			struct ribbon ribbon;
+			ribbon_create(&ribbon, hashes.data(), count, p);
+			struct ribbon test = ribbon;
+			char *buf = (char *)malloc(ribbon_store_size(&ribbon));
+			ribbon_store(&ribbon, buf);
+			ribbon_destroy(&ribbon);
+			memset(&ribbon, '#', sizeof(ribbon));
+			ribbon_load_table(&test, buf);
+			free(buf);
+			for (uint32_t i = 0; i < count * 10; i++) {
+				bool has = check.find(i) != check.end();
+				bool ribbon_possible =
+					ribbon_maybe_has(&test, h(i));
+				tests++;
+				if (has && !ribbon_possible)
+					error_count++;
+				if (!has && ribbon_possible)
+					false_positive++;
+			}
+			ribbon_destroy(&test);
+		}
+		double fp_rate = (double)false_positive / tests;
+		if (fp_rate > p + 0.001)
+			fp_rate_too_big++;
+	}
+	cout << "error_count = " << error_count << endl;
+	cout << "fp_rate_too_big = " << fp_rate_too_big << endl;
+}
+
+void
+size_test()
+{
+	cout << "*** " << __func__ << " ***" << endl;
+	uint32_t too_big = 0;
+	for (double p = 0.001; p < 0.5; p *= 1.3) {
+		for (uint32_t count = 1000; count <= 100000; count *= 10) {
+			vector<uint32_t> hashes;
+			for (uint32_t i = 0; i < count; i++)
+				hashes.push_back(h(i));
+			struct ribbon ribbon;
+			ribbon_create(&ribbon, hashes.data(), count, p);
+			struct bloom bloom;
+			bloom_create(&bloom, count, ribbon_fpr(&ribbon));
+			if (ribbon_store_size(&ribbon) >= bloom_store_size(&bloom))
+				too_big++;
+			ribbon_destroy(&ribbon);
+			bloom_destroy(&bloom);
+		}
+	}
+	cout << "too_big = " << too_big << endl;
+}
+
+int
+main(void)
+{
+	simple_test();
+	store_load_test();
+	size_test();
+}
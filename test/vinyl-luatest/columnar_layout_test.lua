@@ -0,0 +1,285 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local common = require('test.vinyl-luatest.common')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = common.default_box_cfg()})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        for _, name in ipairs({'test', 'row', 'col'}) do
+            if box.space[name] ~= nil then
+                box.space[name]:drop()
+            end
+        end
+    end)
+end)
+
+-- Checks that a space with the columnar layout stores the same data as
+-- a space with the row layout.
+g.test_data = function(cg)
+    cg.server:exec(function()
+        for _, layout in ipairs({'row', 'col'}) do
+            local s = box.schema.space.create(layout, {engine = 'vinyl'})
+            local opts = {
+                layout = layout == 'col' and 'columnar' or 'row',
+                page_size = 256,
+            }
+            s:create_index('pk', table.merge(opts, {
+                parts = {{1, 'unsigned'}},
+            }))
+            s:create_index('sk', table.merge(opts, {
+                parts = {{2, 'string'}, {3, 'unsigned', is_nullable = true}},
+                unique = false,
+            }))
+        end
+        rawset(_G, 'load', function(seed)
+            math.randomseed(seed)
+            local ops = {}
+            for _ = 1, 1000 do
+                local k = math.random(500)
+                local tuple = {k, 'v' .. math.random(20)}
+                -- Tuples of different length with nulls and maps.
+                local field_count = math.random(6)
+                for i = 3, field_count do
+                    local r = math.random(4)
+                    if r == 1 then
+                        tuple[i] = box.NULL
+                    elseif r == 2 and i > 3 then
+                        tuple[i] = {a = k, b = {i}}
+                    else
+                        tuple[i] = math.random(100)
+                    end
+                end
+                local r = math.random(10)
+                if r <= 6 then
+                    table.insert(ops, {'replace', tuple})
+                elseif r <= 8 then
+                    table.insert(ops, {'upsert', tuple,
+                                       {{'=', 2, 'u' .. k}}})
+                else
+                    table.insert(ops, {'delete', {k}})
+                end
+            end
+            for _, name in ipairs({'row', 'col'}) do
+                local s = box.space[name]
+                box.begin()
+                for _, op in ipairs(ops) do
+                    s[op[1]](s, op[2], op[3])
+                end
+                box.commit()
+            end
+        end)
+        _G.load(1)
+        box.snapshot()
+        _G.load(2)
+        box.snapshot()
+    end)
+    local function check()
+        cg.server:exec(function()
+            local row, col = box.space.row, box.space.col
+            local keys = {
+                pk = {{}, {100}, {250}},
+                sk = {{}, {'v10'}, {'v10', 50}, {'u7'}},
+            }
+            for name, index_keys in pairs(keys) do
+                for _, it in ipairs({'ge', 'le', 'gt', 'lt', 'eq'}) do
+                    for _, key in ipairs(index_keys) do
+                        local opts = {iterator = it}
+                        t.assert_equals(col.index[name]:select(key, opts),
+                                        row.index[name]:select(key, opts))
+                    end
+                end
+            end
+            for k = 1, 500 do
+                t.assert_equals(col:get(k), row:get(k))
+            end
+        end)
+    end
+    check()
+    cg.server:exec(function()
+        for _, name in ipairs({'row', 'col'}) do
+            for _, index in ipairs({'pk', 'sk'}) do
+                box.space[name].index[index]:compact()
+            end
+        end
+        t.helpers.retrying({}, function()
+            for _, name in ipairs({'row', 'col'}) do
+                for _, index in ipairs({'pk', 'sk'}) do
+                    t.assert_equals(
+                        box.space[name].index[index]:stat().run_count, 1)
+                end
+            end
+        end)
+    end)
+    check()
+    cg.server:restart()
+    check()
+end
+
+-- Checks that a lookup of a key missing in a columnar run doesn't read
+-- pages that can't contain the key and reads only key fields of the rest.
+g.test_read = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {
+            layout = 'columnar', page_size = 512, bloom_fpr = 1,
+        })
+        box.begin()
+        for k = 2, 2000, 2 do
+            s:insert({k, string.rep('x', 100)})
+        end
+        box.commit()
+        box.snapshot()
+
+        local function read_stat()
+            return s.index.pk:stat().disk.iterator.read
+        end
+        local skipped = 0
+        local miss_bytes = 0
+        local misses = 0
+        for k = 1, 1999, 2 do
+            local stat = read_stat()
+            t.assert_equals(s:get(k), nil)
+            local new_stat = read_stat()
+            if new_stat.pages == stat.pages then
+                skipped = skipped + 1
+            else
+                misses = misses + 1
+                miss_bytes = miss_bytes + new_stat.bytes - stat.bytes
+            end
+        end
+        -- Lookups of keys between pages don't read pages.
+        t.assert_gt(skipped, 0)
+        t.assert_gt(misses, 0)
+
+        local stat = read_stat()
+        for k = 2, 200, 2 do
+            t.assert_equals(s:get(k), {k, string.rep('x', 100)})
+        end
+        local hit_bytes = read_stat().bytes - stat.bytes
+        -- A miss reads only the key column of a page.
+        t.assert_lt(miss_bytes / misses, hit_bytes / 100 / 2)
+    end)
+end
+
+-- Checks that a scan by equality stops without reading a page of a columnar
+-- run that can't contain the key.
+g.test_eq_scan = function(cg)
+    cg.server:exec(function()
+        for _, layout in ipairs({'row', 'col'}) do
+            local s = box.schema.space.create(layout, {engine = 'vinyl'})
+            local opts = {
+                layout = layout == 'col' and 'columnar' or 'row',
+                page_size = 256, bloom_fpr = 1,
+            }
+            s:create_index('pk', opts)
+            s:create_index('sk', table.merge(opts, {
+                parts = {{2, 'unsigned'}}, unique = false,
+            }))
+            box.begin()
+            for k = 1, 1000 do
+                s:insert({k, k * 2})
+            end
+            box.commit()
+        end
+        box.snapshot()
+        local pages = {}
+        for _, name in ipairs({'row', 'col'}) do
+            local s = box.space[name]
+            for k = 1, 1000 do
+                t.assert_equals(s.index.sk:select({k * 2}), {{k, k * 2}})
+            end
+            pages[name] = s.index.sk:stat().disk.iterator.read.pages
+        end
+        t.assert_lt(pages.col, pages.row)
+    end)
+end
+
+-- Checks that the index file of a columnar run can be rebuilt.
+g.test_rebuild_index = function(cg)
+    local result = cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {
+            layout = 'columnar', page_size = 256, bloom_fpr = 1,
+        })
+        s:create_index('sk', {
+            layout = 'columnar', page_size = 256, unique = false,
+            parts = {{2, 'string'}},
+        })
+        for k = 1, 500 do
+            s:insert({k, 'v' .. k % 10, k % 3 == 0 and box.NULL or k})
+        end
+        for k = 1, 500, 7 do
+            s:delete({k})
+        end
+        box.snapshot()
+        return {
+            pk = s.index.pk:select(),
+            sk = s.index.sk:select({'v3'}),
+            index_size = s.index.pk:stat().disk.index_size,
+        }
+    end)
+    cg.server:exec(function()
+        local fio = require('fio')
+        local dir = fio.pathjoin(box.cfg.vinyl_dir,
+                                 tostring(box.space.test.id))
+        local files = fio.glob(fio.pathjoin(dir, '*', '*.index'))
+        t.assert_equals(#files, 2)
+        for _, f in ipairs(files) do
+            fio.unlink(f)
+        end
+    end)
+    -- Index files are rebuilt only in the force recovery mode.
+    cg.server:restart({
+        box_cfg = table.merge(common.default_box_cfg(),
+                              {force_recovery = true}),
+    })
+    cg.server:exec(function(result)
+        local s = box.space.test
+        t.assert_equals(s.index.pk:select(), result.pk)
+        t.assert_equals(s.index.sk:select({'v3'}), result.sk)
+        -- Index size accounts min/max stats of field chunks.
+        t.assert_equals(s.index.pk:stat().disk.index_size,
+                        result.index_size)
+    end, {result})
+end
+
+-- Checks that the layout can be changed without rebuilding an index.
+g.test_alter = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {layout = 'columnar'})
+        t.assert_equals(s.index.pk.layout, 'columnar')
+        for k = 1, 100 do
+            s:insert({k, k})
+        end
+        box.snapshot()
+        s.index.pk:alter({layout = 'row'})
+        t.assert_equals(s.index.pk.layout, 'row')
+        t.assert_equals(s.index.pk:stat().run_count, 1)
+        for k = 101, 200 do
+            s:insert({k, k})
+        end
+        box.snapshot()
+        t.assert_equals(s.index.pk:stat().run_count, 2)
+        t.assert_equals(s:count(), 200)
+        t.assert_equals(s:get(50), {50, 50})
+        t.assert_equals(s:get(150), {150, 150})
+
+        t.assert_error_covers({
+            type = 'ClientError',
+            name = 'UNSUPPORTED',
+            message = "vinyl does not support layout 'test'",
+        }, s.index.pk.alter, s.index.pk, {layout = 'test'})
+    end)
+end
@@ -0,0 +1,99 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local common = require('test.vinyl-luatest.common')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    local box_cfg = common.default_box_cfg()
+    -- Disable the tuple cache so that all lookups go to disk.
+    box_cfg.vinyl_cache = 0
+    box_cfg.vinyl_page_cache = 1024 * 1024
+    cg.server = server:new({box_cfg = box_cfg})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {page_size = 1024})
+        box.begin()
+        for k = 1, 100 do
+            s:insert({k, string.rep('x', 100)})
+        end
+        box.commit()
+        box.snapshot()
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+        box.cfg{vinyl_page_cache = 1024 * 1024}
+    end)
+end)
+
+-- Checks that a page is read from disk only once if it fits in the cache.
+g.test_hit = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local stat = s.index.pk:stat().disk.iterator
+        for _ = 1, 3 do
+            for k = 1, 100 do
+                t.assert_equals(s:get(k), {k, string.rep('x', 100)})
+            end
+        end
+        local new_stat = s.index.pk:stat().disk.iterator
+        local hits = new_stat.page_cache.hit - stat.page_cache.hit
+        local misses = new_stat.page_cache.miss - stat.page_cache.miss
+        t.assert_gt(hits, 0)
+        t.assert_gt(misses, 0)
+        t.assert_equals(new_stat.read.pages - stat.read.pages, misses)
+        t.assert_le(misses, s.index.pk:stat().disk.pages)
+        t.assert_gt(box.stat.vinyl().memory.page_cache, 0)
+
+        -- Pages of a deleted run are dropped from the cache.
+        s:drop()
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.stat.vinyl().memory.page_cache, 0)
+        end)
+    end)
+end
+
+-- Checks that the cache size is bounded by the configured quota.
+g.test_quota = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local function read_all()
+            local stat = s.index.pk:stat().disk.iterator
+            for k = 1, 100 do
+                t.assert_equals(s:get(k), {k, string.rep('x', 100)})
+            end
+            return s.index.pk:stat().disk.iterator.read.pages -
+                   stat.read.pages
+        end
+        read_all()
+        t.assert_equals(read_all(), 0)
+        t.assert_gt(box.stat.vinyl().memory.page_cache, 4000)
+
+        box.cfg{vinyl_page_cache = 4000}
+        t.assert_equals(box.cfg.vinyl_page_cache, 4000)
+        t.assert_le(box.stat.vinyl().memory.page_cache, 4000)
+        t.assert_gt(read_all(), 0)
+        t.assert_le(box.stat.vinyl().memory.page_cache, 4000)
+
+        box.cfg{vinyl_page_cache = 0}
+        t.assert_equals(box.stat.vinyl().memory.page_cache, 0)
+        local stat = s.index.pk:stat().disk.iterator
+        t.assert_equals(read_all(), 100)
+        local new_stat = s.index.pk:stat().disk.iterator
+        t.assert_equals(new_stat.page_cache, stat.page_cache)
+    end)
+end
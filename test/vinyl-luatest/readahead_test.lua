@@ -0,0 +1,97 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local common = require('test.vinyl-luatest.common')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    local box_cfg = common.default_box_cfg()
+    -- Disable the tuple cache so that all reads go to disk.
+    box_cfg.vinyl_cache = 0
+    box_cfg.vinyl_readahead = 16
+    cg.server = server:new({box_cfg = box_cfg})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {page_size = 1024})
+        box.begin()
+        for k = 1, 1000 do
+            s:insert({k, string.rep('x', 100)})
+        end
+        box.commit()
+        box.snapshot()
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+        box.cfg{vinyl_readahead = 16}
+    end)
+end)
+
+-- Checks that pages are read ahead by a range scan.
+g.test_scan = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local page_count = s.index.pk:stat().disk.pages
+        t.assert_gt(page_count, 50)
+        for _, iterator in ipairs({'ge', 'le'}) do
+            local stat = s.index.pk:stat().disk.iterator
+            local result = s:select({}, {iterator = iterator})
+            t.assert_equals(#result, 1000)
+            for i, tuple in ipairs(result) do
+                local k = iterator == 'ge' and i or 1001 - i
+                t.assert_equals(tuple, {k, string.rep('x', 100)})
+            end
+            local new_stat = s.index.pk:stat().disk.iterator
+            local pages = new_stat.readahead.pages - stat.readahead.pages
+            local hits = new_stat.readahead.hit - stat.readahead.hit
+            t.assert_gt(hits, page_count / 2)
+            t.assert_le(hits, pages)
+            t.assert_equals(new_stat.read.pages - stat.read.pages,
+                            page_count)
+        end
+    end)
+end
+
+-- Checks that point lookups don't trigger readahead.
+g.test_lookup = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local stat = s.index.pk:stat().disk.iterator
+        for k = 1, 1000, 100 do
+            t.assert_equals(s:get(k), {k, string.rep('x', 100)})
+        end
+        local new_stat = s.index.pk:stat().disk.iterator
+        t.assert_equals(new_stat.readahead, stat.readahead)
+    end)
+end
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'vinyl_readahead': " ..
+            "must be greater than or equal to 0, less than or equal to 256",
+            box.cfg, {vinyl_readahead = 257})
+        t.assert_equals(box.cfg.vinyl_readahead, 16)
+
+        box.cfg{vinyl_readahead = 0}
+        t.assert_equals(box.cfg.vinyl_readahead, 0)
+        local s = box.space.test
+        local stat = s.index.pk:stat().disk.iterator
+        t.assert_equals(#s:select(), 1000)
+        local new_stat = s.index.pk:stat().disk.iterator
+        t.assert_equals(new_stat.readahead, stat.readahead)
+    end)
+end
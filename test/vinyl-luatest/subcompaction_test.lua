@@ -0,0 +1,178 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local common = require('test.vinyl-luatest.common')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    local box_cfg = common.default_box_cfg()
+    -- 3 compaction threads.
+    box_cfg.vinyl_write_threads = 4
+    box_cfg.vinyl_max_subcompactions = 3
+    cg.server = server:new({box_cfg = box_cfg})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+local function define_helpers(server)
+    server:exec(function()
+        rawset(_G, 'check_data', function()
+            local s = box.space.test
+            t.assert_equals(s:count(), 2000)
+            for k = 1, 2000 do
+                t.assert_equals(s:get(k), {k, k % 2, string.rep('x', 200)})
+            end
+        end)
+        rawset(_G, 'wait_compaction', function()
+            t.helpers.retrying({timeout = 60}, function()
+                t.assert_covers(box.stat.vinyl(), {
+                    scheduler = {
+                        tasks_inprogress = 0,
+                        compaction_queue = 0,
+                    },
+                })
+            end)
+        end)
+    end)
+end
+
+g.before_each(function(cg)
+    define_helpers(cg.server)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {run_count_per_level = 10})
+        box.begin()
+        for k = 1, 2000 do
+            s:insert({k, 0, string.rep('x', 200)})
+        end
+        box.commit()
+        box.snapshot()
+        box.begin()
+        for k = 1, 2000, 2 do
+            s:update({k}, {{'+', 2, 1}})
+        end
+        box.commit()
+        box.snapshot()
+        t.assert_covers(s.index.pk:stat(), {range_count = 1, run_count = 2})
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Checks that compaction of a big range is split into parts, each of
+-- which becomes a separate range.
+g.test_split = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local stat = s.index.pk:stat()
+        s.index.pk:compact()
+        _G.wait_compaction()
+        local new_stat = s.index.pk:stat()
+        t.assert_equals(new_stat.range_count, 3)
+        t.assert_equals(new_stat.run_count, 3)
+        t.assert_equals(new_stat.disk.compaction.count -
+                        stat.disk.compaction.count, 1)
+        t.assert_equals(new_stat.disk.compaction.input.rows, 3000)
+        t.assert_equals(new_stat.disk.compaction.output.rows, 2000)
+        _G.check_data()
+
+        -- Ranges are compacted separately as usual.
+        box.begin()
+        for k = 1, 2000, 2 do
+            s:update({k}, {{'-', 2, 1}})
+        end
+        box.commit()
+        box.snapshot()
+        box.begin()
+        for k = 1, 2000, 2 do
+            s:update({k}, {{'+', 2, 1}})
+        end
+        box.commit()
+        box.snapshot()
+        s.index.pk:compact()
+        _G.wait_compaction()
+        t.assert_ge(s.index.pk:stat().range_count, 3)
+        _G.check_data()
+    end)
+    cg.server:restart()
+    define_helpers(cg.server)
+    cg.server:exec(function()
+        t.assert_ge(box.space.test.index.pk:stat().range_count, 3)
+        _G.check_data()
+    end)
+end
+
+-- Checks that progress of running tasks is reported by box.stat.vinyl().
+g.test_progress = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local s = box.space.test
+        box.error.injection.set('ERRINJ_VY_COMPACTION_DELAY', true)
+        s.index.pk:compact()
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.stat.vinyl().scheduler.tasks_inprogress, 3)
+        end)
+        local tasks = box.stat.vinyl().scheduler.tasks
+        local input_rows = 0
+        for name, task in pairs(tasks) do
+            t.assert_str_contains(name, 'vinyl.compaction.')
+            t.assert_covers(task, {
+                type = 'compaction',
+                space_id = s.id,
+                index_id = 0,
+                output_rows = 0,
+            })
+            t.assert_gt(task.input_rows, 0)
+            t.assert_ge(task.time, 0)
+            input_rows = input_rows + task.input_rows
+        end
+        t.assert_equals(input_rows, 3000)
+        box.error.injection.set('ERRINJ_VY_COMPACTION_DELAY', false)
+        _G.wait_compaction()
+        t.assert_equals(box.stat.vinyl().scheduler.tasks, {})
+    end)
+end
+
+-- Checks that the range is left intact if any part fails.
+g.test_error = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local s = box.space.test
+        box.error.injection.set('ERRINJ_VY_RUN_WRITE', true)
+        s.index.pk:compact()
+        t.helpers.retrying({}, function()
+            t.assert_ge(box.stat.vinyl().scheduler.tasks_failed, 3)
+        end)
+        t.assert_covers(s.index.pk:stat(), {range_count = 1, run_count = 2})
+        _G.check_data()
+        box.error.injection.set('ERRINJ_VY_RUN_WRITE', false)
+        -- Manual compaction request is dropped on failure.
+        s.index.pk:compact()
+        _G.wait_compaction()
+        t.assert_covers(s.index.pk:stat(), {range_count = 3, run_count = 3})
+        _G.check_data()
+    end)
+end
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'vinyl_max_subcompactions': " ..
+            "must be greater than 0, less than or equal to 16",
+            box.cfg, {vinyl_max_subcompactions = 0})
+        t.assert_equals(box.cfg.vinyl_max_subcompactions, 3)
+        box.cfg{vinyl_max_subcompactions = 1}
+        t.assert_equals(box.cfg.vinyl_max_subcompactions, 1)
+        box.cfg{vinyl_max_subcompactions = 3}
+    end)
+end
@@ -34,15 +34,18 @@ box.snapshot()
 -- There are 1000 unique tuples in the index. The cardinality of the
 -- first key part is 100, of the first two key parts is 500, of the
 -- first three key parts is 1000. With the default bloom fpr of 0.05,
--- we use 5 hash functions or 5 / ln(2) ~= 7.3 bits per tuple.If we
--- allocated a full sized bloom filter per each sub key, we would need
--- to allocate at least (100 + 500 + 1000 + 1000) * 7 bits or 2275
--- bytes. However, since we adjust the fpr of bloom filters of higher
--- ranks (because a full key lookup checks all its sub keys as well),
--- we use 5, 4, 3, and 1 hash functions for each sub key respectively.
--- This leaves us only (100*5 + 500*4 + 1000*3 + 1000*1) / ln(2) bits
--- or 1172 bytes, and after rounding up to the block size (128 byte)
--- we have 1280 bytes plus the header overhead.
+-- a ribbon filter stores a 5 bit fingerprint per key. If we allocated
+-- a full sized filter per each sub key, we would need to allocate at
+-- least (100 + 500 + 1000 + 1000) * 5 bits or 1625 bytes. However,
+-- since we adjust the fpr of filters of higher ranks (because a full
+-- key lookup checks all its sub keys as well), we would use 5, 5, 3, and 1
+-- bit fingerprints for each sub key respectively. This leaves us only
+-- 100*5 + 500*5 + 1000*3 + 1000*1 bits or 875 bytes. After adding a few
+-- per cent of spare slots and rounding up to the block size (64 slots)
+-- and the table size to 64 bytes, the spare space is spent on extra
+-- fingerprint bits, which gives 8 bits for the first key part. This
+-- makes the next filter need only 4 bits, so we have 960 bytes plus the
+-- header overhead.
 --
 s.index.pk:stat().disk.bloom_size
 
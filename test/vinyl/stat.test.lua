@@ -85,13 +85,14 @@ end;
 -- Note, checking correctness of the load regulator logic is beyond
 -- the scope of this test so we just filter out related statistics.
 --
--- Filter dump/compaction time as we need error injection to
--- test them properly.
+-- Filter dump/compaction time and active tasks as we need error
+-- injection to test them properly.
 function gstat()
     local st = box.stat.vinyl()
     st.regulator = nil
     st.scheduler.dump_time = nil
     st.scheduler.compaction_time = nil
+    st.scheduler.tasks = nil
     st.memory.level0 = nil
     return st
 end;